@@ -0,0 +1,788 @@
+/*                       R T B E N C H . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ *
+ */
+/** @file rtbench.c
+ *
+ * Microbenchmarks for the librt hot paths.
+ *
+ * Where the benchmark suite times whole images, this times the pieces
+ * individually so a regression can be pinned on one of them:
+ *
+ *   db_dirbuild	building the directory of the .g file
+ *   db_walk_tree	walking the named trees, importing every leaf
+ *   rt_prep		rt_prep() of the named trees on one CPU
+ *   cut_traverse	stepping a ray through every cut-tree cell
+ *   rt_shootray	whole rays, one CPU
+ *   boolweave		rt_boolweave() and rt_boolfinal() on the segments
+ *			the rays above produced
+ *   shot, vshot	(-S) ft_shot() and ft_vshot() on every solid in
+ *			the file, e.g. db/prim.g
+ *
+ * Each benchmark is calibrated so one sample runs for at least -t
+ * seconds and then sampled -n times.  Progress goes to stderr and the
+ * results, with every sample and their mean, standard deviation,
+ * minimum, median and maximum, are written as JSON to stdout or the
+ * -o file.  Times are in nanoseconds per operation; "unit" says what
+ * the operation is.
+ *
+ * Usage: rtbench [-S] [-n samples] [-t seconds] [-s grid] [-o file.json] file.g [objects...]
+ */
+
+#include "common.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bu/app.h"
+#include "bu/bitv.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "bu/log.h"
+#include "bu/malloc.h"
+#include "bu/parallel.h"
+#include "bu/ptbl.h"
+#include "bu/sort.h"
+#include "bu/vls.h"
+#include "vmath.h"
+#include "raytrace.h"
+#include "rt/boolweave.h"
+
+
+struct bench_result {
+    char group[32];
+    char name[128];
+    char type[32];
+    const char *unit;
+    size_t ops;		/* operations per sample */
+    size_t nsamples;
+    double *samples;	/* ns per operation */
+};
+
+/* Timed section of a benchmark: runs it iters times and returns the
+ * microseconds spent in the part being measured */
+typedef int64_t (*bench_fn)(void *data, size_t iters);
+
+static struct bench_result *bench_results = NULL;
+static size_t bench_nresults = 0;
+static size_t bench_nsamples = 10;
+static double bench_seconds = 0.05;
+
+
+static int
+bench_cmp_double(const void *a, const void *b, void *UNUSED(arg))
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+static void
+bench_stats(const struct bench_result *r, double *mean, double *stddev, double *min, double *median, double *max)
+{
+    double *sorted;
+    double sum = 0.0, sq = 0.0;
+    size_t i;
+
+    for (i = 0; i < r->nsamples; i++)
+	sum += r->samples[i];
+    *mean = sum / (double)r->nsamples;
+    for (i = 0; i < r->nsamples; i++)
+	sq += (r->samples[i] - *mean) * (r->samples[i] - *mean);
+    *stddev = (r->nsamples > 1) ? sqrt(sq / (double)(r->nsamples - 1)) : 0.0;
+
+    sorted = (double *)bu_malloc(r->nsamples * sizeof(double), "bench sorted");
+    memcpy(sorted, r->samples, r->nsamples * sizeof(double));
+    bu_sort(sorted, r->nsamples, sizeof(double), bench_cmp_double, NULL);
+    *min = sorted[0];
+    *max = sorted[r->nsamples - 1];
+    if (r->nsamples % 2)
+	*median = sorted[r->nsamples / 2];
+    else
+	*median = 0.5 * (sorted[r->nsamples / 2 - 1] + sorted[r->nsamples / 2]);
+    bu_free(sorted, "bench sorted");
+}
+
+
+/* Calibrate, sample and record one benchmark; ops_per_iter is how
+ * many operations (rays, opens, ...) one iteration of fn does */
+static void
+bench_run(const char *group, const char *name, const char *type, const char *unit,
+	  size_t ops_per_iter, bench_fn fn, void *data)
+{
+    int64_t target = (int64_t)(bench_seconds * 1.0e6);
+    int64_t elapsed;
+    size_t iters = 1;
+    struct bench_result *r;
+    double mean, stddev, min, median, max;
+    size_t i;
+
+    if (!ops_per_iter)
+	return;
+
+    /* warm the caches, then grow iters until a sample is long enough */
+    (void)fn(data, 1);
+    while ((elapsed = fn(data, iters)) < target) {
+	size_t grow = (elapsed > 0) ? (size_t)((double)target * 1.2 / (double)elapsed) + 1 : 10;
+	if (grow > 10)
+	    grow = 10;
+	if (grow < 2)
+	    grow = 2;
+	if (iters > SIZE_MAX / grow)
+	    break;
+	iters *= grow;
+    }
+
+    bench_results = (struct bench_result *)bu_realloc(bench_results, (bench_nresults + 1) * sizeof(struct bench_result), "bench results");
+    r = &bench_results[bench_nresults++];
+    memset(r, 0, sizeof(struct bench_result));
+    bu_strlcpy(r->group, group, sizeof(r->group));
+    bu_strlcpy(r->name, name, sizeof(r->name));
+    bu_strlcpy(r->type, type ? type : "", sizeof(r->type));
+    r->unit = unit;
+    r->ops = iters * ops_per_iter;
+    r->nsamples = bench_nsamples;
+    r->samples = (double *)bu_calloc(bench_nsamples, sizeof(double), "bench samples");
+
+    for (i = 0; i < bench_nsamples; i++)
+	r->samples[i] = (double)fn(data, iters) * 1000.0 / (double)r->ops;
+
+    bench_stats(r, &mean, &stddev, &min, &median, &max);
+    bu_log("%-13s %-24s %12.1f %-9s +/- %5.1f%%  (min %.1f, %zu ops x %zu)\n",
+	   group, name, median, unit, mean > 0.0 ? 100.0 * stddev / mean : 0.0, min, r->ops, r->nsamples);
+}
+
+
+static void
+bench_json_string(struct bu_vls *out, const char *str)
+{
+    const char *cp;
+
+    bu_vls_putc(out, '"');
+    for (cp = str; cp && *cp; cp++) {
+	if (*cp == '"' || *cp == '\\')
+	    bu_vls_printf(out, "\\%c", *cp);
+	else if ((unsigned char)*cp < 0x20)
+	    bu_vls_printf(out, "\\u%04x", (unsigned int)(unsigned char)*cp);
+	else
+	    bu_vls_putc(out, *cp);
+    }
+    bu_vls_putc(out, '"');
+}
+
+
+static void
+bench_json(struct bu_vls *out, const char *gfile)
+{
+    size_t i, j;
+
+    bu_vls_printf(out, "{\n  \"file\": ");
+    bench_json_string(out, gfile);
+    bu_vls_printf(out, ",\n  \"librt\": ");
+    bench_json_string(out, rt_version());
+    bu_vls_printf(out, ",\n  \"time\": %lld,\n  \"cpus\": %zu,\n", (long long)time(NULL), bu_avail_cpus());
+    bu_vls_printf(out, "  \"samples\": %zu,\n  \"sample_seconds\": %g,\n  \"benchmarks\": [", bench_nsamples, bench_seconds);
+
+    for (i = 0; i < bench_nresults; i++) {
+	const struct bench_result *r = &bench_results[i];
+	double mean, stddev, min, median, max;
+
+	bench_stats(r, &mean, &stddev, &min, &median, &max);
+	bu_vls_printf(out, "%s\n    {\"group\": ", i ? "," : "");
+	bench_json_string(out, r->group);
+	bu_vls_printf(out, ", \"name\": ");
+	bench_json_string(out, r->name);
+	if (r->type[0]) {
+	    bu_vls_printf(out, ", \"type\": ");
+	    bench_json_string(out, r->type);
+	}
+	bu_vls_printf(out, ", \"unit\": ");
+	bench_json_string(out, r->unit);
+	bu_vls_printf(out, ", \"ops\": %zu,\n     \"mean\": %.6g, \"stddev\": %.6g, \"min\": %.6g, \"median\": %.6g, \"max\": %.6g,\n     \"samples\": [",
+		      r->ops, mean, stddev, min, median, max);
+	for (j = 0; j < r->nsamples; j++)
+	    bu_vls_printf(out, "%s%.6g", j ? ", " : "", r->samples[j]);
+	bu_vls_printf(out, "]}");
+    }
+    bu_vls_printf(out, "\n  ]\n}\n");
+}
+
+
+/* A grid x grid bundle of parallel rays covering the sphere at center,
+ * looking down from azimuth 35, elevation 25 */
+static struct xray *
+bench_rays(const point_t center, fastf_t radius, size_t grid)
+{
+    struct xray *rays = (struct xray *)bu_calloc(grid * grid, sizeof(struct xray), "bench rays");
+    vect_t dir, u, v, zaxis = {0.0, 0.0, 1.0};
+    fastf_t az = 35.0 * DEG2RAD, el = 25.0 * DEG2RAD;
+    size_t x, y;
+
+    VSET(dir, -cos(el) * cos(az), -cos(el) * sin(az), -sin(el));
+    VCROSS(u, dir, zaxis);
+    VUNITIZE(u);
+    VCROSS(v, u, dir);
+
+    for (y = 0; y < grid; y++) {
+	for (x = 0; x < grid; x++) {
+	    struct xray *rp = &rays[y * grid + x];
+	    fastf_t a = radius * (2.0 * ((fastf_t)x + 0.5) / (fastf_t)grid - 1.0);
+	    fastf_t b = radius * (2.0 * ((fastf_t)y + 0.5) / (fastf_t)grid - 1.0);
+	    rp->magic = RT_RAY_MAGIC;
+	    rp->index = (int)(y * grid + x);
+	    VJOIN3(rp->r_pt, center, a, u, b, v, -2.0 * radius, dir);
+	    VMOVE(rp->r_dir, dir);
+	}
+    }
+    return rays;
+}
+
+
+/* db_dirbuild */
+
+static int64_t
+bench_dirbuild(void *data, size_t iters)
+{
+    const char *gfile = (const char *)data;
+    int64_t spent = 0;
+    size_t i;
+
+    for (i = 0; i < iters; i++) {
+	struct db_i *dbip = db_open(gfile, DB_OPEN_READONLY);
+	int64_t start;
+	if (dbip == DBI_NULL)
+	    bu_exit(1, "rtbench: unable to open %s\n", gfile);
+	start = bu_gettime();
+	if (db_dirbuild(dbip) < 0)
+	    bu_exit(1, "rtbench: db_dirbuild of %s failed\n", gfile);
+	spent += bu_gettime() - start;
+	db_close(dbip);
+    }
+    return spent;
+}
+
+
+/* db_walk_tree */
+
+struct bench_walk {
+    struct db_i *dbip;
+    int argc;
+    const char **argv;
+    size_t leaves;
+};
+
+
+static union tree *
+bench_walk_leaf(struct db_tree_state *UNUSED(tsp), const struct db_full_path *UNUSED(pathp), struct rt_db_internal *UNUSED(ip), void *client_data)
+{
+    struct bench_walk *w = (struct bench_walk *)client_data;
+    w->leaves++;
+    return TREE_NULL;
+}
+
+
+static int64_t
+bench_walk(void *data, size_t iters)
+{
+    struct bench_walk *w = (struct bench_walk *)data;
+    struct db_tree_state state;
+    int64_t start = bu_gettime();
+    size_t i;
+
+    RT_DBTS_INIT(&state);
+    state.ts_dbip = w->dbip;
+
+    for (i = 0; i < iters; i++) {
+	w->leaves = 0;
+	(void)db_walk_tree(w->dbip, w->argc, w->argv, 1, &state, NULL, NULL, bench_walk_leaf, w);
+    }
+    return bu_gettime() - start;
+}
+
+
+/* rt_prep */
+
+static int64_t
+bench_prep(void *data, size_t iters)
+{
+    struct bench_walk *w = (struct bench_walk *)data;
+    int64_t spent = 0;
+    size_t i;
+
+    for (i = 0; i < iters; i++) {
+	struct rt_i *rtip = rt_i_create(w->dbip);
+	int64_t start;
+	if (rt_gettrees(rtip, w->argc, w->argv, 1) < 0)
+	    bu_exit(1, "rtbench: rt_gettrees failed\n");
+	start = bu_gettime();
+	rt_prep_parallel(rtip, 1);
+	spent += bu_gettime() - start;
+	rt_i_destroy(rtip);
+    }
+    return spent;
+}
+
+
+/* cut tree traversal, whole rays and the boolean weave */
+
+struct bench_seg {
+    struct soltab *stp;
+    struct hit in;
+    struct hit out;
+};
+
+struct bench_shoot {
+    struct application ap;
+    struct xray *rays;
+    size_t nrays;
+    /* segments of each hitting ray, from one rt_shootray() pass */
+    struct bench_seg *segs;
+    size_t nsegs, maxsegs;
+    size_t *ray_first;	/* [nrays + 1] into segs */
+    struct bu_bitv *solidbits;
+    struct bu_ptbl regionbits;
+};
+
+
+static int
+bench_shoot_hit(struct application *UNUSED(ap), struct partition *UNUSED(part_head), struct seg *UNUSED(segs))
+{
+    return 1;
+}
+
+
+static int
+bench_shoot_miss(struct application *UNUSED(ap))
+{
+    return 0;
+}
+
+
+static int
+bench_record_hit(struct application *ap, struct partition *UNUSED(part_head), struct seg *segs)
+{
+    struct bench_shoot *s = (struct bench_shoot *)ap->a_uptr;
+    struct seg *segp;
+
+    for (BU_LIST_FOR(segp, seg, &segs->l)) {
+	if (s->nsegs == s->maxsegs) {
+	    s->maxsegs = s->maxsegs ? 2 * s->maxsegs : 1024;
+	    s->segs = (struct bench_seg *)bu_realloc(s->segs, s->maxsegs * sizeof(struct bench_seg), "bench segs");
+	}
+	s->segs[s->nsegs].stp = segp->seg_stp;
+	s->segs[s->nsegs].in = segp->seg_in;
+	s->segs[s->nsegs].out = segp->seg_out;
+	s->nsegs++;
+    }
+    return 1;
+}
+
+
+static int64_t
+bench_cut(void *data, size_t iters)
+{
+    struct bench_shoot *s = (struct bench_shoot *)data;
+    int64_t start = bu_gettime();
+    size_t i, r;
+
+    for (i = 0; i < iters; i++) {
+	for (r = 0; r < s->nrays; r++) {
+	    s->ap.a_ray = s->rays[r];
+	    (void)rt_cell_n_on_ray(&s->ap, INT_MAX);
+	}
+    }
+    return bu_gettime() - start;
+}
+
+
+static int64_t
+bench_shootray(void *data, size_t iters)
+{
+    struct bench_shoot *s = (struct bench_shoot *)data;
+    int64_t start = bu_gettime();
+    size_t i, r;
+
+    s->ap.a_hit = bench_shoot_hit;
+    for (i = 0; i < iters; i++) {
+	for (r = 0; r < s->nrays; r++) {
+	    s->ap.a_ray = s->rays[r];
+	    (void)rt_shootray(&s->ap);
+	}
+    }
+    return bu_gettime() - start;
+}
+
+
+static void
+bench_part_head(struct partition *head)
+{
+    memset(head, 0, sizeof(struct partition));
+    head->pt_magic = PT_HD_MAGIC;
+    head->pt_forw = head->pt_back = head;
+}
+
+
+/* Weave and evaluate the recorded segments of every ray that hit.
+ * Getting and freeing the segs and partitions is part of the time,
+ * as it is in rt_shootray(). */
+static int64_t
+bench_boolweave(void *data, size_t iters)
+{
+    struct bench_shoot *s = (struct bench_shoot *)data;
+    struct resource *resp = s->ap.a_resource;
+    int64_t start = bu_gettime();
+    size_t i, r, k;
+
+    for (i = 0; i < iters; i++) {
+	for (r = 0; r < s->nrays; r++) {
+	    struct seg waiting, finished;
+	    struct partition initial, final;
+
+	    if (s->ray_first[r] == s->ray_first[r + 1])
+		continue;
+
+	    s->ap.a_ray = s->rays[r];
+	    BU_LIST_INIT(&waiting.l);
+	    BU_LIST_INIT(&finished.l);
+	    bench_part_head(&initial);
+	    bench_part_head(&final);
+	    bu_ptbl_reset(&s->regionbits);
+
+	    for (k = s->ray_first[r]; k < s->ray_first[r + 1]; k++) {
+		struct seg *segp;
+		RT_GET_SEG(segp, resp);
+		segp->seg_stp = s->segs[k].stp;
+		segp->seg_in = s->segs[k].in;
+		segp->seg_out = s->segs[k].out;
+		segp->seg_in.hit_rayp = segp->seg_out.hit_rayp = &s->ap.a_ray;
+		BU_LIST_INSERT(&waiting.l, &segp->l);
+	    }
+
+	    rt_boolweave(&finished, &waiting, &initial, &s->ap);
+	    (void)rt_boolfinal(&initial, &final, BACKING_DIST, INFINITY, &s->regionbits, &s->ap, s->solidbits);
+
+	    RT_FREE_PT_LIST(&final, resp);
+	    RT_FREE_PT_LIST(&initial, resp);
+	    RT_FREE_SEG_LIST(&finished, resp);
+	}
+    }
+    return bu_gettime() - start;
+}
+
+
+static void
+bench_model(struct db_i *dbip, int argc, const char **argv, size_t grid)
+{
+    struct bench_walk w;
+    struct bench_shoot s;
+    struct rt_i *rtip;
+    struct resource res;
+    point_t center;
+    size_t r, nsolids, hitrays = 0;
+
+    w.dbip = dbip;
+    w.argc = argc;
+    w.argv = argv;
+    w.leaves = 0;
+    (void)bench_walk(&w, 1);
+    bench_run("db_walk_tree", argv[0], NULL, "ns/leaf", w.leaves, bench_walk, &w);
+    bench_run("rt_prep", argv[0], NULL, "ns/prep", 1, bench_prep, &w);
+
+    rtip = rt_i_create(dbip);
+    if (rt_gettrees(rtip, argc, argv, 1) < 0)
+	bu_exit(1, "rtbench: rt_gettrees failed\n");
+    rt_prep_parallel(rtip, 1);
+    /* rt_uniresource is never entered in rti_resources */
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    memset(&s, 0, sizeof(s));
+    RT_APPLICATION_INIT(&s.ap);
+    s.ap.a_rt_i = rtip;
+    s.ap.a_resource = &res;
+    s.ap.a_onehit = 0;
+    s.ap.a_hit = bench_shoot_hit;
+    s.ap.a_miss = bench_shoot_miss;
+    s.ap.a_logoverlap = rt_silent_logoverlap;
+    s.ap.a_uptr = (void *)&s;
+
+    VADD2SCALE(center, rtip->mdl_min, rtip->mdl_max, 0.5);
+    s.rays = bench_rays(center, 0.5 * DIST_PNT_PNT(rtip->mdl_min, rtip->mdl_max), grid);
+    s.nrays = grid * grid;
+
+    bench_run("cut_traverse", argv[0], NULL, "ns/ray", s.nrays, bench_cut, &s);
+    bench_run("rt_shootray", argv[0], NULL, "ns/ray", s.nrays, bench_shootray, &s);
+
+    /* record every ray's segments once for the boolweave replay */
+    s.ray_first = (size_t *)bu_calloc(s.nrays + 1, sizeof(size_t), "bench ray segs");
+    s.ap.a_hit = bench_record_hit;
+    for (r = 0; r < s.nrays; r++) {
+	s.ray_first[r] = s.nsegs;
+	s.ap.a_ray = s.rays[r];
+	(void)rt_shootray(&s.ap);
+	if (s.nsegs > s.ray_first[r])
+	    hitrays++;
+    }
+    s.ray_first[s.nrays] = s.nsegs;
+
+    /* every solid counts as shot, as it is at the end of a ray */
+    nsolids = rtip->stats.nsolids;
+    s.solidbits = bu_bitv_new(nsolids ? nsolids : 1);
+    for (r = 0; r < nsolids; r++)
+	BU_BITSET(s.solidbits, r);
+    bu_ptbl_init(&s.regionbits, 8, "bench regionbits");
+
+    bench_run("boolweave", argv[0], NULL, "ns/ray", hitrays, bench_boolweave, &s);
+
+    bu_ptbl_free(&s.regionbits);
+    bu_bitv_free(s.solidbits);
+    bu_free(s.ray_first, "bench ray segs");
+    bu_free(s.segs, "bench segs");
+    bu_free(s.rays, "bench rays");
+    rt_i_destroy(rtip);
+}
+
+
+/* ft_shot and ft_vshot on one solid */
+
+struct bench_solid {
+    struct application ap;
+    struct soltab *stp;
+    struct xray *rays;
+    size_t nrays;
+    struct soltab **stpp;
+    struct xray **rpp;
+    struct seg *segs;
+};
+
+
+static int64_t
+bench_shot(void *data, size_t iters)
+{
+    struct bench_solid *b = (struct bench_solid *)data;
+    struct resource *resp = b->ap.a_resource;
+    int64_t start = bu_gettime();
+    size_t i, r;
+
+    for (i = 0; i < iters; i++) {
+	for (r = 0; r < b->nrays; r++) {
+	    struct seg seghead;
+	    BU_LIST_INIT(&seghead.l);
+	    if (b->stp->st_meth->ft_shot(b->stp, &b->rays[r], &b->ap, &seghead) > 0)
+		RT_FREE_SEG_LIST(&seghead, resp);
+	}
+    }
+    return bu_gettime() - start;
+}
+
+
+static int64_t
+bench_vshot(void *data, size_t iters)
+{
+    struct bench_solid *b = (struct bench_solid *)data;
+    int64_t start = bu_gettime();
+    size_t i;
+
+    for (i = 0; i < iters; i++)
+	b->stp->st_meth->ft_vshot(b->stpp, b->rpp, b->segs, (int)b->nrays, &b->ap);
+    return bu_gettime() - start;
+}
+
+
+static void
+bench_solids(struct db_i *dbip, size_t grid)
+{
+    struct directory *dp;
+
+    FOR_ALL_DIRECTORY_START(dp, dbip) {
+	struct bench_solid b;
+	struct soltab *stp;
+	struct rt_i *rtip;
+	struct resource res;
+	const char *type;
+	size_t r;
+
+	if (!(dp->d_flags & RT_DIR_SOLID) || (dp->d_flags & RT_DIR_HIDDEN))
+	    continue;
+
+	rtip = rt_i_create(dbip);
+	if (rt_gettree(rtip, dp->d_namep) < 0) {
+	    rt_i_destroy(rtip);
+	    continue;
+	}
+	rt_prep_parallel(rtip, 1);
+	memset(&res, 0, sizeof(res));
+	rt_init_resource(&res, 0, rtip);
+
+	memset(&b, 0, sizeof(b));
+	RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
+	    if (!b.stp)
+		b.stp = stp;
+	} RT_VISIT_ALL_SOLTABS_END;
+
+	/* infinite solids have no bounding sphere to aim at */
+	if (!b.stp || !b.stp->st_meth->ft_shot || b.stp->st_aradius >= INFINITY) {
+	    rt_i_destroy(rtip);
+	    continue;
+	}
+	type = OBJ[b.stp->st_id].ft_label;
+
+	RT_APPLICATION_INIT(&b.ap);
+	b.ap.a_rt_i = rtip;
+	b.ap.a_resource = &res;
+	b.rays = bench_rays(b.stp->st_center, b.stp->st_aradius, grid);
+	b.nrays = grid * grid;
+
+	bench_run("shot", dp->d_namep, type, "ns/ray", b.nrays, bench_shot, &b);
+
+	if (b.stp->st_meth->ft_vshot) {
+	    b.stpp = (struct soltab **)bu_malloc(b.nrays * sizeof(struct soltab *), "bench vshot stp");
+	    b.rpp = (struct xray **)bu_malloc(b.nrays * sizeof(struct xray *), "bench vshot rays");
+	    b.segs = (struct seg *)bu_calloc(b.nrays, sizeof(struct seg), "bench vshot segs");
+	    for (r = 0; r < b.nrays; r++) {
+		b.stpp[r] = b.stp;
+		b.rpp[r] = &b.rays[r];
+	    }
+	    bench_run("vshot", dp->d_namep, type, "ns/ray", b.nrays, bench_vshot, &b);
+	    bu_free(b.stpp, "bench vshot stp");
+	    bu_free(b.rpp, "bench vshot rays");
+	    bu_free(b.segs, "bench vshot segs");
+	}
+
+	bu_free(b.rays, "bench rays");
+	rt_i_destroy(rtip);
+    } FOR_ALL_DIRECTORY_END;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-S] [-n samples] [-t seconds] [-s grid] [-o file.json] file.g [objects...]\n";
+    const char *outfile = NULL;
+    const char *gfile;
+    const char **objs;
+    struct directory **tops = NULL;
+    struct db_i *dbip;
+    struct bu_vls json = BU_VLS_INIT_ZERO;
+    size_t grid = 64;
+    size_t nobjs;
+    int solids = 0;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "Sn:t:s:o:h?")) != -1) {
+	switch (c) {
+	    case 'S':
+		solids = 1;
+		break;
+	    case 'n':
+		bench_nsamples = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 't':
+		bench_seconds = strtod(bu_optarg, NULL);
+		break;
+	    case 's':
+		grid = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'o':
+		outfile = bu_optarg;
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (bu_optind >= argc)
+	bu_exit(1, USAGE, argv[0]);
+    if (bench_nsamples < 1)
+	bench_nsamples = 1;
+    if (bench_seconds <= 0.0)
+	bench_seconds = 0.001;
+    if (grid < 1)
+	grid = 1;
+
+    gfile = argv[bu_optind++];
+    rt_init_resource(&rt_uniresource, 0, NULL);
+
+    /* before the file is held open, so every open rebuilds */
+    bench_run("db_dirbuild", gfile, NULL, "ns/dirbuild", 1, bench_dirbuild, (void *)gfile);
+
+    dbip = db_open(gfile, DB_OPEN_READONLY);
+    if (dbip == DBI_NULL)
+	bu_exit(1, "rtbench: unable to open %s\n", gfile);
+    if (db_dirbuild(dbip) < 0)
+	bu_exit(1, "rtbench: db_dirbuild of %s failed\n", gfile);
+    db_update_nref(dbip);
+
+    if (solids)
+	bench_solids(dbip, grid);
+
+    if (bu_optind < argc) {
+	nobjs = (size_t)(argc - bu_optind);
+	objs = (const char **)bu_calloc(nobjs, sizeof(char *), "bench objects");
+	memcpy((void *)objs, &argv[bu_optind], nobjs * sizeof(char *));
+    } else {
+	size_t i;
+	nobjs = (size_t)db_ls(dbip, DB_LS_TOPS, NULL, &tops);
+	objs = (const char **)bu_calloc(nobjs ? nobjs : 1, sizeof(char *), "bench objects");
+	for (i = 0; i < nobjs; i++)
+	    objs[i] = tops[i]->d_namep;
+    }
+
+    /* per-solid runs are usually all that's wanted from prim.g */
+    if (nobjs && (!solids || bu_optind < argc))
+	bench_model(dbip, (int)nobjs, objs, grid);
+
+    bench_json(&json, gfile);
+    if (outfile) {
+	FILE *fp = fopen(outfile, "wb");
+	if (!fp)
+	    bu_exit(1, "rtbench: unable to write %s\n", outfile);
+	fputs(bu_vls_cstr(&json), fp);
+	fclose(fp);
+    } else {
+	fputs(bu_vls_cstr(&json), stdout);
+    }
+
+    bu_vls_free(&json);
+    bu_free((void *)objs, "bench objects");
+    if (tops)
+	bu_free(tops, "rtbench tops");
+    db_close(dbip);
+    for (c = 0; c < (int)bench_nresults; c++)
+	bu_free(bench_results[c].samples, "bench samples");
+    bu_free(bench_results, "bench results");
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -49,9 +49,10 @@ enum op_type {
  * @param brepA [in]
  * @param brepB [in]
  * @param operation [in]
+ * @param ncpu [in] threads for the face intersections, 0 for all available
  */
 extern BREP_EXPORT int
-ON_Boolean(ON_Brep *brepO, const ON_Brep *brepA, const ON_Brep *brepB, op_type operation);
+ON_Boolean(ON_Brep *brepO, const ON_Brep *brepA, const ON_Brep *brepB, op_type operation, size_t ncpu = 0);
 
 /**
  * Classify a point known not to lie on the boundary of a valid closed BRep.
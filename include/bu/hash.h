@@ -170,6 +170,113 @@ BU_EXPORT extern void *bu_hash_value(bu_hash_entry *e, void *nval);
 /** @} */
 
 
+/** @addtogroup bu_hash
+ * @brief
+ * Open addressing hash tables, for lookups on hot paths.
+ *
+ * Entries live in flat arrays probed sixteen slots at a time against a
+ * one byte tag per slot (with SSE2 where available), so a lookup that
+ * misses usually touches one cache line of tags and no entries.  Byte
+ * string keys and 64-bit integer keys may be mixed in one table; the
+ * integer key functions skip the byte hashing entirely.
+ *
+ * Values are stored as given and may not be NULL.  Keys are copied
+ * unless the table is created with BU_OHASH_BORROW_KEYS, in which case
+ * the caller keeps each key's memory valid and unchanged while it is
+ * in the table (e.g. a name stored in the value itself).
+ *
+ * A table created with BU_OHASH_CONCURRENT is split into shards, each
+ * with its own reader/writer lock: any number of threads may call the
+ * get functions while others set and remove, and writers only block
+ * each other within a shard.  Without the flag no locking is done, and
+ * concurrent gets are safe only while nothing modifies the table.
+ */
+/** @{ */
+
+typedef struct bu_ohash bu_ohash;
+
+#define BU_OHASH_BORROW_KEYS 0x1 /**< @brief do not copy keys; the caller keeps them valid */
+#define BU_OHASH_CONCURRENT  0x2 /**< @brief sharded with reader/writer locks */
+
+/**
+ * Create a table sized to hold nelem entries before growing.  flags
+ * is zero or an OR of the BU_OHASH_* flags.
+ */
+BU_EXPORT extern bu_ohash *bu_ohash_create(size_t nelem, int flags);
+
+/**
+ * Free the table and its key copies.  Values are not freed.
+ */
+BU_EXPORT extern void bu_ohash_destroy(bu_ohash *t);
+
+/**
+ * Remove every entry, keeping the table's storage.
+ */
+BU_EXPORT extern void bu_ohash_clear(bu_ohash *t);
+
+/**
+ * Number of entries in the table.
+ */
+BU_EXPORT extern size_t bu_ohash_count(const bu_ohash *t);
+
+/**
+ * Return the value stored for key, or NULL if it isn't in the table.
+ */
+BU_EXPORT extern void *bu_ohash_get(const bu_ohash *t, const uint8_t *key, size_t key_len);
+
+/**
+ * Associate val with key.  Null or zero length keys and NULL values are
+ * not supported.
+ * @return
+ * 1 if a new entry is created, 0 if an existing value was updated, -1 on error.
+ */
+BU_EXPORT extern int bu_ohash_set(bu_ohash *t, const uint8_t *key, size_t key_len, void *val);
+
+/**
+ * Remove key from the table.
+ * @return
+ * 1 if an entry was removed, 0 if key was not in the table.
+ */
+BU_EXPORT extern int bu_ohash_rm(bu_ohash *t, const uint8_t *key, size_t key_len);
+
+/** Integer key versions of bu_ohash_get(), bu_ohash_set() and bu_ohash_rm() */
+BU_EXPORT extern void *bu_ohash_get_int(const bu_ohash *t, uint64_t key);
+BU_EXPORT extern int bu_ohash_set_int(bu_ohash *t, uint64_t key, void *val);
+BU_EXPORT extern int bu_ohash_rm_int(bu_ohash *t, uint64_t key);
+
+/**
+ * The hash bu_ohash_get() and friends compute for a byte string key.
+ * Callers that keep it next to the key (e.g. to bucket the same
+ * objects elsewhere) can pass it to the _hashed versions below, which
+ * skip hashing the key again.  The value is stable for the life of
+ * the process, but should not be stored in files.
+ */
+BU_EXPORT extern uint64_t bu_ohash_hash(const uint8_t *key, size_t key_len);
+
+/** bu_ohash_get(), bu_ohash_set() and bu_ohash_rm() with hash = bu_ohash_hash(key, key_len) */
+BU_EXPORT extern void *bu_ohash_get_hashed(const bu_ohash *t, uint64_t hash, const uint8_t *key, size_t key_len);
+BU_EXPORT extern int bu_ohash_set_hashed(bu_ohash *t, uint64_t hash, const uint8_t *key, size_t key_len, void *val);
+BU_EXPORT extern int bu_ohash_rm_hashed(bu_ohash *t, uint64_t hash, const uint8_t *key, size_t key_len);
+
+/**
+ * Iterate over the entries.  Start with *pos set to zero; each call
+ * returns 1 and fills in the next entry, or returns 0 when there are
+ * no more.  For integer keys *key is set to NULL and the key is
+ * returned in *ikey.  Any of the outputs may be NULL.  The table must
+ * not be modified during an iteration.
+ *
+ * @code
+ * size_t pos = 0;
+ * void *val;
+ * while (bu_ohash_next(t, &pos, NULL, NULL, NULL, &val))
+ *     bu_log("Value: %p\n", val);
+ * @endcode
+ */
+BU_EXPORT extern int bu_ohash_next(const bu_ohash *t, size_t *pos, const uint8_t **key, size_t *key_len, uint64_t *ikey, void **val);
+
+/** @} */
+
+
 
 /***************************************************************************
  * Given data, return an unsigned long long value based on a hashing
@@ -200,6 +200,73 @@ BU_EXPORT extern void *bu_pool_alloc(struct bu_pool *pool, size_t nelem, size_t
 BU_EXPORT extern void bu_pool_delete(struct bu_pool *pool);
 
 
+/**
+ * Slab allocators.  A slab hands out objects of one fixed size,
+ * carved from large chunks, to code that gets and releases many
+ * structures of the same type.  There is no locking: a slab belongs
+ * to one thread at a time (e.g. one per CPU resource).
+ *
+ * Released objects are kept on a stack of pointers rather than an
+ * intrusive list and keep their contents, so the optional
+ * constructor runs only the first time a slot is handed out and the
+ * destructor only when its chunk is released.  Objects can thereby
+ * cache their own allocations (a bu_ptbl, say) between uses.
+ */
+struct bu_slab;
+
+/** Constructor/destructor callback, given the object and the slab's data pointer */
+typedef void (*bu_slab_obj_t)(void *obj, void *data);
+
+struct bu_slab_stats {
+    size_t objsize;	/**< @brief bytes per object, after alignment */
+    size_t chunks;	/**< @brief chunks currently held */
+    size_t bytes;	/**< @brief bytes currently held in chunks */
+    size_t live;	/**< @brief objects handed out and not yet returned */
+    size_t peak;	/**< @brief most objects live at once since the last bu_slab_trim() */
+    size_t gets;	/**< @brief bu_slab_get() calls since the counters were last cleared */
+    size_t puts;	/**< @brief bu_slab_put() calls since the counters were last cleared */
+};
+
+/**
+ * Create a slab of objsize byte objects, allocated nper at a time (0
+ * picks a chunk of about 64KB).  ctor, dtor and data may be NULL.
+ */
+BU_EXPORT extern struct bu_slab *bu_slab_create(size_t objsize, size_t nper,
+						bu_slab_obj_t ctor, bu_slab_obj_t dtor,
+						void *data);
+
+/** Run the destructor on every constructed object and release all memory. */
+BU_EXPORT extern void bu_slab_destroy(struct bu_slab *slab);
+
+/** Get an object.  Never returns NULL. */
+BU_EXPORT extern void *bu_slab_get(struct bu_slab *slab);
+
+/** Return an object obtained from bu_slab_get() on the same slab. */
+BU_EXPORT extern void bu_slab_put(struct bu_slab *slab, void *obj);
+
+/**
+ * Return every outstanding object at once, e.g. at the end of a ray
+ * or frame.  The caller must not touch any of them afterwards.
+ * Memory is kept for reuse.
+ */
+BU_EXPORT extern void bu_slab_reset(struct bu_slab *slab);
+
+/**
+ * Release the chunks that weren't needed to hold the peak number of
+ * live objects since the previous trim, then start a new peak
+ * period.  If no objects are outstanding the slab is reset first, so
+ * a trim between frames shrinks it to the last frame's high-water
+ * mark.  Returns the number of bytes released.
+ */
+BU_EXPORT extern size_t bu_slab_trim(struct bu_slab *slab);
+
+/**
+ * Fill in stats for the slab.  If clear is non-zero the get and put
+ * counters are zeroed afterwards.
+ */
+BU_EXPORT extern void bu_slab_stats(struct bu_slab *slab, struct bu_slab_stats *stats, int clear);
+
+
 /**
  * Attempt to get shared memory - returns -1 if new memory was
  * created, 0 if successfully returning existing memory, and 1
@@ -145,6 +145,15 @@ BU_EXPORT extern size_t bu_avail_cpus(void);
  * This function will not return control until all invocations of the
  * subroutine are finished.
  *
+ * The invocations run on the libbu thread pool (see bu_task_spawn()),
+ * which is started with enough workers for all 'ncpu' of them to run
+ * at once; the calling thread runs one of them itself.  With ncpu=0
+ * in a nested call, the invocations share whatever workers are free.
+ * A pool worker is given the same CPU id it had in the previous call
+ * whenever that id is free and within 'ncpu', so per-cpu state that
+ * is allocated lazily by the thread using it stays with that thread
+ * (and its NUMA node, see bu_numa_nodes()) from call to call.
+ *
  * In following is a working stand-alone example demonstrating how to
  * call the bu_parallel() interface.
  *
@@ -183,6 +192,128 @@ BU_EXPORT extern size_t bu_avail_cpus(void);
  */
 BU_EXPORT extern void bu_parallel(void (*func)(int func_cpu_id, void *func_data), size_t ncpu, void *data);
 
+/**
+ * Select whether bu_parallel() runs its callbacks on the libbu thread
+ * pool (enable non-zero, the default) or creates and joins its own
+ * threads on every call as it used to (enable zero), e.g. to compare
+ * the two.  The task routines always use the pool.  Returns the
+ * previous setting.
+ */
+BU_EXPORT extern int bu_parallel_pool(int enable);
+
+
+/**
+ * @brief
+ * NUMA placement
+ *
+ * On machines with more than one NUMA node (Linux only, from sysfs),
+ * the workers of the libbu thread pool are spread round-robin over
+ * the nodes and each is bound to the CPUs of its node, so memory a
+ * worker allocates and first touches is local to where it runs.  Only
+ * CPUs this process may run on are counted; nodes with none of them
+ * are left out.  LIBBU_AFFINITY, which binds each worker to a single
+ * core, takes precedence.
+ *
+ * bu_numa_set_nodes() can turn this off, or pretend there are more
+ * nodes than the machine has.
+ */
+
+/**
+ * Override the NUMA topology: nodes == 1 turns NUMA placement off and
+ * makes every routine here report a single node, nodes > 1 splits the
+ * usable CPUs into that many nodes (for testing on machines that have
+ * only one), and nodes == 0 goes back to the real topology.  It must
+ * be called before anything in libbu first looks at the topology,
+ * i.e. before the first bu_numa_*() or bu_parallel() call; returns -1
+ * and changes nothing after that, 0 otherwise.
+ */
+BU_EXPORT extern int bu_numa_set_nodes(size_t nodes);
+
+/**
+ * Return the number of NUMA nodes work is spread over, at least 1.
+ */
+BU_EXPORT extern size_t bu_numa_nodes(void);
+
+/**
+ * Return the node, in [0, bu_numa_nodes()), of the calling thread:
+ * the node it is bound to if it is a pool worker or inside
+ * bu_numa_run(), otherwise the node of the CPU it is running on.
+ */
+BU_EXPORT extern int bu_numa_node(void);
+
+/**
+ * Call func(node, data) once for each NUMA node, on a thread bound to
+ * that node, and return when all of the calls are done.  The calls
+ * may run at the same time.  Memory allocated and filled by func(node)
+ * is placed on that node, which is how per-node copies of read-mostly
+ * data are made.  With a single node this is just func(0, data) on
+ * the calling thread.
+ */
+BU_EXPORT extern void bu_numa_run(void (*func)(int node, void *data), void *data);
+
+
+/**
+ * @brief
+ * tasks on the libbu thread pool
+ *
+ * bu_parallel(), bu_task_spawn() and bu_parallel_for() all run on one
+ * persistent pool of worker threads.  Workers are started the first
+ * time they are needed and are reused by every later call, so code
+ * that goes parallel many times (per frame, per tree walk) doesn't
+ * pay for thread creation each time.
+ *
+ * Tasks are grouped so they can be waited on together.  A task may
+ * spawn and wait on groups of its own; the waiting thread runs queued
+ * tasks of the group it waits on rather than blocking, so nesting
+ * doesn't tie up workers.  Unlike bu_parallel() callbacks, tasks are
+ * not given a CPU id and must not index per-cpu tables with
+ * bu_parallel_id().
+ *
+ * bu_parallel_pool(0) makes bu_parallel() create and join its own
+ * threads on every call as it used to; the task routines always use
+ * the pool.
+ *
+ * @code
+ * struct bu_task_group *group = bu_task_group_create();
+ * for (i = 0; i < nparts; i++)
+ *     bu_task_spawn(group, process_part, &parts[i]);
+ * bu_task_group_destroy(group); // waits for all of them
+ * @endcode
+ */
+struct bu_task_group;
+
+/**
+ * Create an empty task group.
+ */
+BU_EXPORT extern struct bu_task_group *bu_task_group_create(void);
+
+/**
+ * Queue func(data) on the thread pool as part of group.  It may run
+ * at any time from now until bu_task_wait(group) returns, on any
+ * thread, including the one that waits.
+ */
+BU_EXPORT extern void bu_task_spawn(struct bu_task_group *group, void (*func)(void *data), void *data);
+
+/**
+ * Return once every task spawned in group so far has finished.
+ */
+BU_EXPORT extern void bu_task_wait(struct bu_task_group *group);
+
+/**
+ * Wait for the tasks of group and release it.
+ */
+BU_EXPORT extern void bu_task_group_destroy(struct bu_task_group *group);
+
+/**
+ * Call func over [begin, end) split into ranges of at most chunk
+ * items, in parallel on the thread pool, and return when all of them
+ * are done.  Each call gets one [start, end) range; ranges are handed
+ * out in increasing order but may run in any order.  A chunk of 0
+ * picks a size that gives each thread several ranges.  func may itself
+ * call bu_parallel_for().
+ */
+BU_EXPORT extern void bu_parallel_for(size_t begin, size_t end, size_t chunk, void (*func)(size_t start, size_t end, void *data), void *data);
+
 
 /**
  * @brief
@@ -63,6 +63,9 @@ typedef enum {
  * kernels normalized at image edges and on images smaller than the
  * kernel. ICV_FILTER_NULL is a pass-through.
  *
+ * Large images are filtered in row-parallel chunks using all available
+ * CPUs.
+ *
  * @param img Image to be filtered.
  * @param filter_type Type of filter to be used.
  *
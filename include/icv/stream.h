@@ -0,0 +1,202 @@
+/*                        S T R E A M . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup icv_stream
+ *
+ * @brief
+ * Scanline streaming of images too large to hold in memory.
+ *
+ * A stream produces one row at a time on request.  Streams are opened
+ * on a file (or wrap an in-memory image) and chained through stages
+ * such as cropping, resizing and color conversion, then drained into
+ * an encoder with icv_stream_write().  Every stage keeps only the few
+ * rows it needs, so converting a multi-gigapixel mosaic takes a
+ * bounded amount of memory regardless of the image size.
+ *
+ * Rows are numbered like icv_image_t rows: y=0 is the bottom row.
+ * Some sources can only deliver rows in file order (a pix file on a
+ * pipe is bottom-up, a PNG is top-down).  Stages and encoders that
+ * need a different order transparently spool the rows to an anonymous
+ * temporary file, trading disk for memory.
+ *
+ * Each stage takes ownership of its upstream stream; destroying the
+ * last stage of a chain releases the whole chain.
+ *
+ * @code
+ * icv_stream_t *s = icv_stream_open(in, BU_MIME_IMAGE_PIX, 20000, 20000);
+ * s = icv_stream_resize(s, ICV_RESIZE_SHRINK, 5000, 5000);
+ * icv_stream_write(s, out, BU_MIME_IMAGE_PNG);
+ * icv_stream_destroy(s);
+ * @endcode
+ */
+
+#ifndef ICV_STREAM_H
+#define ICV_STREAM_H
+
+#include "common.h"
+#include <stddef.h> /* for size_t */
+#include <stdio.h> /* for FILE */
+#include "bu/mime.h"
+#include "icv/defines.h"
+#include "icv/ops.h"
+
+__BEGIN_DECLS
+
+/** @{ */
+/** @file icv/stream.h */
+
+typedef struct icv_stream icv_stream_t;
+
+/**
+ * Order in which a stream is able to deliver its rows.
+ */
+typedef enum {
+    ICV_STREAM_ANY_ORDER,	/**< @brief rows may be requested in any order */
+    ICV_STREAM_BOTTOM_UP,	/**< @brief rows must be requested with increasing y */
+    ICV_STREAM_TOP_DOWN		/**< @brief rows must be requested with decreasing y */
+} ICV_STREAM_ORDER;
+
+/**
+ * Open a stream reading an image from fp.
+ *
+ * PIX and BW data is read a row at a time, with random access when fp
+ * is seekable; width and height give the image dimensions.  PNG data
+ * is decoded a row at a time (interlaced PNGs must be decoded in
+ * full).  Other formats are read into memory with the regular libicv
+ * readers and then streamed.
+ *
+ * The caller keeps ownership of fp, which must stay open until the
+ * stream is destroyed.
+ *
+ * @return the new stream, or NULL on error.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_open(FILE *fp, bu_mime_image_t format, size_t width, size_t height);
+
+/**
+ * Stream the rows of an in-memory image.  The image is not copied and
+ * must outlive the stream.  Alpha channels are dropped.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_image(const icv_image_t *img);
+
+/**
+ * Crop a xnum by ynum rectangle with lower left corner (xorig, yorig)
+ * out of src.  Same semantics as icv_crop_rect().
+ *
+ * @return the new stream, or NULL (destroying src) on invalid input.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_crop_rect(icv_stream_t *src, size_t xorig, size_t yorig, size_t xnum, size_t ynum);
+
+/**
+ * Map the quadrilateral with the given corners of src onto a xnum by
+ * ynum image, taking the nearest source pixel for each output pixel
+ * (corners falling outside src are clamped to its edges).  This needs
+ * random access to src, which is spooled if necessary.
+ *
+ * @return the new stream, or NULL (destroying src) on invalid input.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_crop_quad(icv_stream_t *src,
+						     double ulx, double uly,
+						     double urx, double ury,
+						     double lrx, double lry,
+						     double llx, double lly,
+						     size_t xnum, size_t ynum);
+
+/**
+ * Resize src to out_width by out_height.
+ *
+ * ICV_RESIZE_NINTERP and ICV_RESIZE_BINTERP interpolate exactly like
+ * icv_resize().  ICV_RESIZE_SHRINK averages the area of the source
+ * covered by each output pixel and, unlike icv_resize(), accepts any
+ * (not only integral) reduction.  ICV_RESIZE_UNDERSAMPLE takes the
+ * source pixel at the lower left of that area.
+ *
+ * @return the new stream, or NULL (destroying src) on invalid input.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_resize(icv_stream_t *src, ICV_RESIZE_METHOD method, size_t out_width, size_t out_height);
+
+/**
+ * Convert src to a single channel stream.  The weights have the same
+ * meaning as those of icv_rgb2gray() with ICV_COLOR_RGB; all zero
+ * averages the three channels.  A gray src is returned unchanged.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_rgb2gray(icv_stream_t *src, double rweight, double gweight, double bweight);
+
+/**
+ * Convert src to a three channel stream by replicating the gray
+ * channel.  An RGB src is returned unchanged.
+ */
+ICV_EXPORT extern icv_stream_t *icv_stream_gray2rgb(icv_stream_t *src);
+
+/**
+ * Report the dimensions, color space and native row order of s.  Any
+ * of the output pointers may be NULL.
+ */
+ICV_EXPORT extern void icv_stream_info(const icv_stream_t *s, size_t *width, size_t *height, ICV_COLOR_SPACE *color_space, ICV_STREAM_ORDER *order);
+
+/**
+ * Return row y of s as width*channels doubles in the 0..1 range, or
+ * NULL on error (including requesting a row out of order from a
+ * stream that is not ICV_STREAM_ANY_ORDER).  The row remains valid
+ * until the next call on s.
+ */
+ICV_EXPORT extern const double *icv_stream_read_row(icv_stream_t *s, size_t y);
+
+/**
+ * Encode every row of s into fp in the given format.  PIX, BW and PNG
+ * are written a row at a time, converting between gray and RGB as the
+ * format requires; other formats are assembled in memory and written
+ * with the regular libicv writers.
+ *
+ * @return BRLCAD_OK on success, BRLCAD_ERROR on failure.
+ */
+ICV_EXPORT extern int icv_stream_write(icv_stream_t *s, FILE *fp, bu_mime_image_t format);
+
+/**
+ * Encode s as a PNG with a zlib compression level (0-9, negative for
+ * the libpng default) and, when gamma is positive, a gAMA chunk.
+ *
+ * @return BRLCAD_OK on success, BRLCAD_ERROR on failure.
+ */
+ICV_EXPORT extern int icv_stream_write_png(icv_stream_t *s, FILE *fp, int compression, double gamma);
+
+/**
+ * Read every row of s into a new in-memory image.
+ */
+ICV_EXPORT extern icv_image_t *icv_stream_to_image(icv_stream_t *s);
+
+/**
+ * Release s and every stream upstream of it.
+ */
+ICV_EXPORT extern void icv_stream_destroy(icv_stream_t *s);
+
+/** @} */
+
+__END_DECLS
+
+#endif /* ICV_STREAM_H */
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -37,7 +37,9 @@
 #include "vmath.h"
 #include "bu/list.h"
 #include "bu/parallel.h"
+#include "bu/ptbl.h"
 #include "nmg/defines.h"
+#include "nmg/topology.h"
 //#include "nmg/model.h"
 
 __BEGIN_DECLS
@@ -268,6 +270,18 @@ struct nmg_ray_data {
      * functions should not be called.
      */
     int                 classifying_ray;
+
+    /**
+     * Optional face culling for nmg_isect_ray_shell().  When set, it
+     * is called for each shell the ray reaches and may store in
+     * "faces" (an initialized table) the faceuses whose bounding
+     * boxes the ray line passes within tolerance of, in the order
+     * they appear on the shell's fu_hd list, and return 1; only those
+     * faces are then intersected.  Returning 0 intersects every face
+     * of the shell.  Wire loops, edges and vertices are always
+     * checked.
+     */
+    int (*rd_shell_faces)(struct nmg_ray_data *rd, const struct shell *s, struct bu_ptbl *faces);
 };
 
 int
@@ -217,6 +217,34 @@ RT_EXPORT extern int rt_poly_roots(bn_poly_t *eqn,
 				   bn_complex_t roots[],
 				   const char *name);
 
+/**
+ * Find the roots of n polynomials of degree at most four: roots[i]
+ * gets the roots of eqns[i] and nroots[i] their number, or a negative
+ * count where the solver gave up, as from rt_poly_roots().
+ *
+ * Where SSE2 is available, cubics and quartics are solved several at
+ * a time in closed form, two to a vector register, and their roots
+ * are polished with a Newton step.  The roots are not those
+ * rt_poly_roots() would find, only as good: each leaves a residual of
+ * at most RT_ROOT_TOL in the polynomial scaled to a leading
+ * coefficient of one, the check rt_poly_roots() puts its own closed
+ * form roots to, and a quartic's roots also sum to its cubic
+ * coefficient.  Any that fail, and the other degrees, are handed to
+ * rt_poly_roots(), as every polynomial is without SSE2.
+ *
+ * The roots of a polynomial do not depend on the others solved with
+ * it, so shooting a primitive one ray at a time through
+ * rt_poly_roots_n() gives the same hits as shooting it in batches.
+ *
+ * WARNING: as with rt_poly_roots(), the polynomials given as input
+ * may be destroyed.
+ */
+RT_EXPORT extern void rt_poly_roots_n(size_t n,
+				      bn_poly_t eqns[],
+				      bn_complex_t roots[][4],
+				      int nroots[],
+				      const char *name);
+
 /** @} */
 
 
@@ -140,6 +140,29 @@ RT_EXPORT extern int db5_realloc(struct db_i *dbip,
 				 struct bu_external *ep);
 
 
+/**
+ * Compact a v5 database file in place.  Every object is slid down
+ * toward the start of the file, in file order, so that the holes
+ * left by deleted and resized objects end up as one block at the end,
+ * which is then cut off the file.  Directory entries are updated as
+ * objects move, so the open database stays usable; this reclaims the
+ * same space as a "keep" copy without a second file.
+ *
+ * After each object is moved the space behind it is rewritten as a
+ * free object, so an interrupted compaction leaves a valid file.
+ * Where the file can't be truncated the reclaimed space is left as
+ * a single free object at the end.
+ *
+ * The database must be open read-write, on disk, with no write batch
+ * open.  If reclaimed is non-NULL it is set to the number of bytes
+ * removed from the file.
+ *
+ * @return 0 OK
+ * @return -1 Failure
+ */
+RT_EXPORT extern int db_compact(struct db_i *dbip, size_t *reclaimed);
+
+
 /**
  * A routine for merging together the three optional parts of an
  * object into the final on-disk format.  Results in extra data
@@ -511,6 +534,35 @@ RT_EXPORT extern int db_put(struct db_i *,
 			    union record *where,
 			    b_off_t offset, size_t len);
 
+/**
+ * Open a write batch on a writable, on-disk database.  Until the
+ * matching db_batch_commit(), every object created or grown is laid
+ * out contiguously at the end of the file and its records are held
+ * in memory instead of being written (and flushed) one at a time.
+ * Reads see the buffered records, so the database can be used
+ * normally while the batch is open.  Batches nest; only the
+ * outermost commit writes.  Very large batches spill to the file
+ * every 64MB.  db_close() commits any batch still open.
+ *
+ * Writers must be single threaded while a batch is open.
+ *
+ * Returns -
+ * 0 batch opened
+ * -1 the database is read-only or in memory (nothing to batch)
+ */
+RT_EXPORT extern int db_batch_begin(struct db_i *dbip);
+
+/**
+ * Close the innermost write batch opened with db_batch_begin(),
+ * writing out the buffered records with a single write when it is
+ * the outermost one.
+ *
+ * Returns -
+ * 0 success
+ * -1 no batch was open, or the write failed
+ */
+RT_EXPORT extern int db_batch_commit(struct db_i *dbip);
+
 /**
  * Obtains a object from the database, leaving it in external
  * (on-disk) format.
@@ -529,6 +581,32 @@ RT_EXPORT extern int db_get_external(struct bu_external *ep,
 				     const struct directory *dp,
 				     const struct db_i *dbip);
 
+/**
+ * Like db_get_external(), but when dbip is a read-only (memory
+ * mapped) v5 database and the object is not compressed, no copy is
+ * made: ep->ext_buf points straight into the mapping, which stays
+ * valid until the database is closed.  Otherwise this is exactly
+ * db_get_external().
+ *
+ * The buffer must be treated as read-only and released with
+ * db_free_external(), never bu_free_external().
+ *
+ * Returns -
+ * -1 error
+ * 0 success
+ */
+RT_EXPORT extern int db_get_external_view(struct bu_external *ep,
+					  const struct directory *dp,
+					  const struct db_i *dbip);
+
+/**
+ * Release an external obtained with db_get_external_view() (or
+ * db_get_external()) from dbip.  Views into dbip's memory map are
+ * just cleared, anything else goes to bu_free_external().
+ */
+RT_EXPORT extern void db_free_external(struct bu_external *ep,
+				       const struct db_i *dbip);
+
 /**
  * Given that caller already has an external representation of the
  * database object, update it to have a new name (taken from
@@ -731,8 +809,9 @@ RT_EXPORT extern void db_ck_directory(const struct db_i *dbip);
 RT_EXPORT extern int db_is_directory_non_empty(const struct db_i *dbip);
 
 /**
- * Returns a hash index for a given string that corresponds with the
- * head of that string's hash chain.
+ * Returns a hash index in [0, RT_DBNHASH) for a given string.  The
+ * directory itself buckets names by their bu_ohash_hash(), see
+ * d_namehash.
  */
 RT_EXPORT extern int db_dirhash(const char *str);
 
@@ -920,11 +999,11 @@ DEPRECATED RT_EXPORT extern void db_alloc_directory_block(struct resource *res);
 RT_EXPORT extern void db_alloc_dir_block(struct db_i *dbip);
 
 /**
- * This routine is called by the GET_SEG macro when the freelist is
- * exhausted.  Rather than simply getting one additional structure, we
- * get a whole batch, saving overhead.  When this routine is called,
- * the seg resource must already be locked.  malloc() locking is done
- * in bu_malloc.
+ * Create the per-thread slabs that the RT_GET_SEG and GET_PT macros
+ * allocate segments and partitions from, if the resource doesn't
+ * have them yet.  The macros call this on first use, so resources
+ * that never went through rt_init_resource() still work.  The slabs
+ * belong to the resource and are not locked.
  */
 RT_EXPORT extern void rt_alloc_seg_block(struct resource *res);
 
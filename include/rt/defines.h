@@ -152,7 +152,9 @@
  * access database objects.
  *
  * The directory is organized as forward linked lists hanging off of
- * one of RT_DBNHASH headers in the db_i structure.
+ * one of RT_DBNHASH headers in the db_i structure, for iteration.
+ * Lookups by name go through a separate index that grows with the
+ * directory.
  *
  * FIXME: this should not be public API, push container and iteration
  * down into LIBRT.  External applications should not use this.
@@ -193,6 +195,22 @@
 #define RT_PART_NUBSPT  0       /**< @brief Non-uniform binary space partitioning tree */
 #define RT_PART_NULL    1       /**< @brief No-op spatial partitioning: one model-sized leaf */
 
+#define RT_TESS_PREP_EXACT  0   /**< @brief Shoot every primitive analytically */
+#define RT_TESS_PREP_OPTIN  1   /**< @brief Shoot a BoT only for objects whose tess_prep attribute asks for one */
+#define RT_TESS_PREP_AUTO   2   /**< @brief Also shoot a BoT for eligible types where measured to be faster */
+
+#define RT_TESS_PREP_TYPES_DEFAULT "extrude" /**< @brief Default rti_tess_prep_types: the types RT_TESS_PREP_AUTO considers */
+#define RT_TESS_PREP_NS_DEFAULT 1500.0  /**< @brief Default rti_tess_prep_ns: cheapest analytic ns/ray worth tessellating */
+
+#define RT_INSTANCE_TYPES_DEFAULT "bot,brep,nmg,dsp,ebm,vol,ars,pipe,extrude,revolve,metaball,hf" /**< @brief Default rti_instance_types: types slow to prep or big once prepped */
+#define RT_LAZY_PREP_TYPES_DEFAULT "bot,brep,nmg,dsp,ebm,vol,ars,pipe,extrude,revolve,metaball,hf" /**< @brief Default rti_lazy_prep_types: types slow to prep */
+
+#define RT_PIPE_MINBVH_DEFAULT  8       /**< @brief Default rti_pipe_minbvh: pipes with fewer segments walk them */
+#define RT_BOT_PIECE_TRIS_DEFAULT 4096  /**< @brief Default rti_bot_piece_tris: triangles per BoT piece */
+#define RT_PIPE_PIECE_SEGS_DEFAULT 16   /**< @brief Default rti_pipe_piece_segs: segments per pipe piece */
+#define RT_METABALL_MININDEX_DEFAULT 16 /**< @brief Default rti_metaball_minindex: metaballs with fewer points sum them all */
+#define RT_VOXEL_MINPYRAMID_DEFAULT 4096 /**< @brief Default rti_voxel_minpyramid: VOL and EBM grids with fewer cells step through them all */
+
 #endif /* RT_DEFINES_H */
 
 /** @} */
@@ -54,7 +54,10 @@ __BEGIN_DECLS
  * The in-memory name of an object should only be changed using
  * db_rename(), so that it can be requeued on the correct linked list,
  * based on new hash.  This should be followed by rt_db_put_internal()
- * on the object to modify the on-disk name.
+ * on the object to modify the on-disk name.  The hash is cached in
+ * d_namehash when the entry goes into the directory, and picks both
+ * its linked list and its slot in the database's name index.
+ * d_prevp lets the entry be taken off its list without walking it.
  *
  * Note that d_minor_type and the corresponding idb_minor_type of an
  * rt_db_internal associated with a given directory structure should match.
@@ -77,6 +80,8 @@ struct directory {
     struct bu_list d_use_hd;    /**< @brief heads list of uses (struct soltab l2) */
     char d_shortname[16];       /**< @brief Stash short names locally */
     void *u_data;		/**< @brief void pointer hook for user data. user is responsible for freeing. */
+    uint64_t d_namehash;        /**< @brief bu_ohash_hash() of d_namep, while in a directory */
+    struct directory ** d_prevp; /**< @brief the pointer to this entry on its list, while in a directory */
 };
 #define RT_DIR_NULL     ((struct directory *)0)
 #define RT_CK_DIR(_dp) BU_CKMAG(_dp, RT_DIR_MAGIC, "(librt)directory")
@@ -123,6 +123,12 @@ struct ray_data {
      * functions should not be called.
      */
     int                 classifying_ray;
+
+    /**
+     * Optional face culling hook, see struct nmg_ray_data.  Callers
+     * that zero this structure get the exhaustive face loop.
+     */
+    int (*rd_shell_faces)(struct nmg_ray_data *rd, const struct shell *s, struct bu_ptbl *faces);
 };
 
 #define NMG_PCA_EDGE    1
@@ -27,11 +27,14 @@
 #include "common.h"
 #include "vmath.h"
 #include "bu/list.h"
+#include "bu/ptbl.h"
 #include "bn/tol.h"
 #include "nmg.h"
 #include "rt/defines.h"
 #include "rt/geom.h"
+#include "rt/soltab.h"
 #include "rt/tree.h"
+#include "rt/xray.h"
 
 __BEGIN_DECLS
 
@@ -51,6 +54,16 @@ rt_nmg_do_bool(
 	union tree *tp, union tree *tl, union tree *tr,
 	int op, struct bu_list *vlfree, const struct bn_tol *tol, void *data);
 
+/**
+ * Append to faces, in fu_hd order, the faceuses of shell s of the
+ * prepped NMG solid stp that the face index built at prep time picks
+ * as candidates for the ray rp.  Every faceuse whose bounding box the
+ * ray line crosses is among them.  Returns 0, leaving faces alone,
+ * when s has no face index and all of its faceuses must be checked.
+ */
+RT_EXPORT extern int
+rt_nmg_shell_faces(struct soltab *stp, const struct shell *s, struct xray *rp, struct bu_ptbl *faces);
+
 /** @} */
 
 __END_DECLS
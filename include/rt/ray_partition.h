@@ -89,24 +89,24 @@ struct partition {
 	GET_PT(ip, p, res); \
 	memset(((char *) &(p)->RT_PT_MIDDLE_START), 0, RT_PT_MIDDLE_LEN(p)); }
 
+/**
+ * Partitions come from the resource's per-thread slab, and keep their
+ * pt_seglist storage while on it.
+ */
 #define GET_PT(ip, p, res) { \
-	if (BU_LIST_NON_EMPTY_P(p, partition, &res->re_parthead)) { \
-	    BU_LIST_DEQUEUE((struct bu_list *)(p)); \
-	    bu_ptbl_reset(&(p)->pt_seglist); \
-	} else { \
-	    BU_ALLOC((p), struct partition); \
-	    (p)->pt_magic = PT_MAGIC; \
-	    bu_ptbl_init(&(p)->pt_seglist, 42, "pt_seglist ptbl"); \
-	    (res)->re_partlen++; \
-	} \
+	if (!(res)->re_part_slab) \
+	    rt_alloc_seg_block(res); \
+	(p) = (struct partition *)bu_slab_get((res)->re_part_slab); \
+	(p)->pt_magic = PT_MAGIC; \
+	bu_ptbl_reset(&(p)->pt_seglist); \
 	res->re_partget++; }
 
 #define FREE_PT(p, res) { \
-	BU_LIST_APPEND(&(res->re_parthead), (struct bu_list *)(p)); \
 	if ((p)->pt_overlap_reg) { \
 	    bu_free((void *)((p)->pt_overlap_reg), "pt_overlap_reg");\
 	    (p)->pt_overlap_reg = NULL; \
 	} \
+	bu_slab_put((res)->re_part_slab, (p)); \
 	res->re_partfree++; }
 
 #define RT_FREE_PT_LIST(_headp, _res) { \
@@ -30,6 +30,7 @@
 #include "common.h"
 #include "vmath.h"
 #include "bu/list.h"
+#include "bu/malloc.h"
 #include "bu/ptbl.h"
 #include "rt/defines.h"
 #include "rt/global.h" // for rt_uniresource
@@ -68,12 +69,11 @@ __BEGIN_DECLS
 struct resource {
     uint32_t            re_magic;       /**< @brief  PUBLIC: Magic number */
     int                 re_cpu;         /**< @brief  PUBLIC: processor number, for ID */
-    struct bu_list      re_seg;         /**< @brief  Head of segment freelist */
-    struct bu_ptbl      re_seg_blocks;  /**< @brief  Table of malloc'ed blocks of segs */
+    struct bu_slab *    re_seg_slab;    /**< @brief  Slab of struct seg */
     long                re_seglen;
     long                re_segget;
     long                re_segfree;
-    struct bu_list      re_parthead;    /**< @brief  Head of freelist */
+    struct bu_slab *    re_part_slab;   /**< @brief  Slab of struct partition */
     long                re_partlen;
     long                re_partget;
     long                re_partfree;
@@ -110,7 +110,7 @@ struct resource {
 
 #define RESOURCE_NULL   ((struct resource *)0)
 #define RT_CK_RESOURCE(_p) BU_CKMAG(_p, RESOURCE_MAGIC, "struct resource")
-#define RT_RESOURCE_INIT_ZERO { RESOURCE_MAGIC, 0, BU_LIST_INIT_ZERO, BU_PTBL_INIT_ZERO, 0, 0, 0, BU_LIST_INIT_ZERO, 0, 0, 0, BU_LIST_INIT_ZERO, BU_LIST_INIT_ZERO, BU_LIST_INIT_ZERO, NULL, 0, NULL, 0, 0, 0, 0, 0, 0, 0, 0, NULL, 0, 0, 0, 0, BU_PTBL_INIT_ZERO, NULL, 0, 0, 0 }
+#define RT_RESOURCE_INIT_ZERO { RESOURCE_MAGIC, 0, NULL, 0, 0, 0, NULL, 0, 0, 0, BU_LIST_INIT_ZERO, BU_LIST_INIT_ZERO, BU_LIST_INIT_ZERO, NULL, 0, NULL, 0, 0, 0, 0, 0, 0, 0, 0, NULL, 0, 0, 0, 0, BU_PTBL_INIT_ZERO, NULL, 0, 0, 0 }
 
 /**
  * Definition of global parallel-processing semaphores.
@@ -68,6 +68,9 @@ struct rt_i_stats {
     /* Geometry counts (set during rt_prep) */
     size_t  nregions;       /**< @brief  total # of regions participating */
     size_t  nsolids;        /**< @brief  total # of solids participating */
+    size_t  ninstances;     /**< @brief  solids shooting another's prepped geometry */
+    size_t  instance_bytes; /**< @brief  prepped BoT bytes those would have duplicated */
+    size_t  ndeferred;      /**< @brief  solids left to prep on their first hit */
 
     /* Ray-shooting counters (accumulated during rt_shootray / rt_shootrays) */
     size_t  rti_nrays;      /**< @brief  # calls to rt_shootray() */
@@ -79,6 +82,14 @@ struct rt_i_stats {
     size_t  nmiss_solid;    /**< @brief  shots missed solid RPP */
     size_t  ndup;           /**< @brief  duplicate shots at a given solid */
     size_t  nempty_cells;   /**< @brief  number of empty spatial partition cells passed through */
+    size_t  ndeferred_prepped; /**< @brief  deferred solids a ray has reached, and prepped */
+
+    /* Per-thread seg/partition allocator counters (accumulated by rt_add_res_stats) */
+    size_t  nseg_get;       /**< @brief  segments handed out */
+    size_t  npart_get;      /**< @brief  partitions handed out */
+    size_t  nseg_peak;      /**< @brief  most segments live at once in any one resource */
+    size_t  npart_peak;     /**< @brief  most partitions live at once in any one resource */
+    size_t  res_slab_bytes; /**< @brief  bytes kept by the resource slabs after trimming */
 
     /* Space-partition (cut tree) statistics (set during rt_cut_it) */
     size_t  rti_cut_maxlen;             /**< @brief  max len RPP list in 1 cut bin */
@@ -98,9 +109,8 @@ struct rt_i_stats {
  * During gettree processing, the most time consuming step is
  * searching the list of existing solids to see if a new solid is
  * actually an identical instance of a previous solid.  Therefore, the
- * list has been divided into several lists.  The same macros & hash
- * value that accesses the dbi_Head[] array are used here.  The hash
- * value is computed by db_dirhash().
+ * list has been divided into RT_DBNHASH lists, picked by the hash
+ * value computed by db_dirhash().
  */
 struct rt_i {
     uint32_t            rti_magic;      /**< @brief  magic # for integrity check */
@@ -109,6 +119,19 @@ struct rt_i {
     int                 rti_save_overlaps; /**< @brief  1=fill in pt_overlap_reg, change boolweave behavior */
     int                 rti_dont_instance; /**< @brief  1=Don't compress instances of solids into 1 while prepping */
     int                 rti_hasty_prep; /**< @brief  1=hasty prep, slower ray-trace */
+    int                 rti_tess_prep;  /**< @brief  RT_TESS_PREP_*: when slow primitives are shot as tessellated BoTs */
+    const char *        rti_tess_prep_types; /**< @brief  ft_labels RT_TESS_PREP_AUTO considers, space or comma separated */
+    double              rti_tess_prep_ns; /**< @brief  analytic ns/ray below which "auto" leaves a primitive alone */
+    int                 rti_instance;   /**< @brief  1=rigidly moved copies of a solid shoot one prepped prototype */
+    const char *        rti_instance_types; /**< @brief  ft_labels rti_instance applies to, space or comma separated */
+    int                 rti_lazy_prep;  /**< @brief  1=prep slow primitives on their first hit, not in rt_prep() */
+    const char *        rti_lazy_prep_types; /**< @brief  ft_labels rti_lazy_prep defers, space or comma separated */
+    int                 rti_numa_replicate; /**< @brief  1=copy prepped BoT data to every NUMA node in rt_prep() */
+    size_t              rti_pipe_minbvh; /**< @brief  fewest pipe segments that get a segment BVH */
+    size_t              rti_bot_piece_tris; /**< @brief  triangles per BoT piece in the space partitioning, 0=BoTs stay whole */
+    size_t              rti_pipe_piece_segs; /**< @brief  segments per pipe piece in the space partitioning, 0=pipes stay whole */
+    size_t              rti_metaball_minindex; /**< @brief  fewest metaball points that get a point index */
+    size_t              rti_voxel_minpyramid; /**< @brief  fewest VOL or EBM cells that get an occupancy pyramid */
     size_t              rti_nlights;    /**< @brief  number of light sources */
     int                 rti_prismtrace; /**< @brief  add support for pixel prism trace */
     char *              rti_region_fix_file; /**< @brief  rt_regionfix() file or NULL */
@@ -273,7 +296,10 @@ RT_EXPORT extern struct soltab *rt_find_solid(const struct rt_i *rtip,
  *
  * This routine should initialize all the same resources that
  * rt_clean_resource() releases.  It shouldn't (but currently does for
- * ptbl) allocate any dynamic memory, just init pointers & lists.
+ * ptbl) allocate any dynamic memory, just init pointers & lists.  The
+ * per-CPU storage is allocated later by the thread that uses the
+ * resource, which on NUMA machines puts it on that thread's node; an
+ * application may call this for every CPU from its main thread.
  */
 
 struct rt_i; /* forward declaration */
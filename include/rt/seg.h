@@ -40,6 +40,7 @@
 #include "common.h"
 #include "vmath.h"
 #include "bu/list.h"
+#include "bu/malloc.h"
 #include "bu/vls.h"
 #include "rt/defines.h"
 #include "rt/hit.h"
@@ -67,10 +68,15 @@ struct seg {
 #define RT_CHECK_SEG(_p) BU_CKMAG(_p, RT_SEG_MAGIC, "struct seg")
 #define RT_CK_SEG(_p) BU_CKMAG(_p, RT_SEG_MAGIC, "struct seg")
 
+/**
+ * Segments come from the resource's per-thread slab (see bu_slab_get()),
+ * which rt_alloc_seg_block() creates on first use.
+ */
 #define RT_GET_SEG(p, res) { \
-	while (!BU_LIST_WHILE((p), seg, &((res)->re_seg)) || !(p)) \
+	if (!(res)->re_seg_slab) \
 	    rt_alloc_seg_block(res); \
-	BU_LIST_DEQUEUE(&((p)->l)); \
+	(p) = (struct seg *)bu_slab_get((res)->re_seg_slab); \
+	(p)->l.magic = RT_SEG_MAGIC; \
 	(p)->l.forw = (p)->l.back = BU_LIST_NULL; \
 	(p)->seg_in.hit_magic = (p)->seg_out.hit_magic = RT_HIT_MAGIC; \
 	res->re_segget++; \
@@ -79,15 +85,14 @@ struct seg {
 
 #define RT_FREE_SEG(p, res) { \
 	RT_CHECK_SEG(p); \
-	BU_LIST_INSERT(&((res)->re_seg), &((p)->l)); \
+	bu_slab_put((res)->re_seg_slab, (p)); \
 	res->re_segfree++; \
     }
 
 
 /**
- * This could be
- *      BU_LIST_INSERT_LIST(&((_res)->re_seg), &((_segheadp)->l))
- * except for security of checking & counting each element this way.
+ * Return every segment on a list to the resource, checking and
+ * counting each one.
  */
 #define RT_FREE_SEG_LIST(_segheadp, _res) { \
 	register struct seg *_a; \
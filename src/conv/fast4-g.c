@@ -2868,6 +2868,9 @@ main(int argc, char **argv)
 	bu_exit(1, "Cannot open file for output (%s)\n", argv[bu_optind+1]);
     }
 
+    /* lay the output out in one batched write, committed by db_close() */
+    (void)db_batch_begin(s.fpout->dbip);
+
     if (plot_file) {
 	if ((s.fp_plot=fopen(plot_file, "wb")) == NULL) {
 	    bu_log("Cannot open plot file (%s)\n", plot_file);
@@ -3510,6 +3510,9 @@ main(int argc, char **argv)
 	bu_exit(1, NULL);
     }
 
+    /* lay the output out in one batched write, committed by db_close() */
+    (void)db_batch_begin(fd_out->dbip);
+
     if ((ret_val = obj_parser_create(&ga.parser)) != 0) {
 	if (ret_val == ENOMEM) {
 	    bu_log("Can not allocate an obj_parser_t object, Out of Memory.\n");
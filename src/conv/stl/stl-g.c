@@ -634,6 +634,9 @@ main(int argc, char *argv[])
 	bu_exit(1, NULL);
     }
 
+    /* lay the output out in one batched write, committed by db_close() */
+    (void)db_batch_begin(fd_out->dbip);
+
     mk_id_units(fd_out, "Conversion from Stereolithography format", "mm");
 
     BU_LIST_INIT(&all_head.l);
@@ -28,6 +28,7 @@
 #include "common.h"
 
 #include <assert.h>
+#include <exception>
 #include <vector>
 #include <stack>
 #include <queue>
@@ -39,6 +40,7 @@
 
 #include "vmath.h"
 #include "bu/log.h"
+#include "bu/parallel.h"
 #include "brep/defines.h"
 #include "brep/boolean.h"
 #include "brep/intersect.h"
@@ -49,12 +51,17 @@
 #include "debug_plot.h"
 #include "brep_except.h"
 #include "brep_defines.h"
+#include "../libbg/RTree.h"
 
 //DebugPlot *dplot = NULL;
 
 // Whether to output the debug messages about b-rep booleans.
 #define DEBUG_BREP_BOOLEAN 0
 
+// Fewer candidate face pairs than this are intersected serially; a
+// handful of SSI calls doesn't pay for starting the threads.
+#define BOOLEAN_PARALLEL_MIN_PAIRS 4
+
 
 struct IntersectPoint {
     ON_3dPoint m_pt;	// 3D intersection point
@@ -3457,13 +3464,265 @@ face_brep_location(const TrimmedFace *tface, const ON_Brep *brep, ON_SimpleArray
 }
 
 
+typedef RTree<int, double, 3> FaceBoxTree;
+
+
+static void
+face_box_tree_build(FaceBoxTree &tree, const ON_Brep *brep, const std::set<int> &unused, const std::set<int> &finalform)
+{
+    for (int i = 0; i < brep->m_F.Count(); i++) {
+	if (unused.find(i) != unused.end() || finalform.find(i) != finalform.end())
+	    continue;
+	ON_BoundingBox bbox = brep->m_F[i].BoundingBox();
+	double fmin[3], fmax[3];
+	for (int k = 0; k < 3; k++) {
+	    fmin[k] = bbox.m_min[k] - INTERSECTION_TOL;
+	    fmax[k] = bbox.m_max[k] + INTERSECTION_TOL;
+	}
+	tree.Insert(fmin, fmax, i);
+    }
+}
+
+
+// Find the face pairs (brep1 face, brep2 face) whose bounding boxes are
+// within INTERSECTION_TOL of each other - only those can be a source of
+// events.  The faces already known to be unused or intact are left out.
+static std::set<std::pair<int, int> >
+get_intersection_candidates(
+    const ON_Brep *brep1,
+    const ON_Brep *brep2,
+    const std::set<int> &unused1,
+    const std::set<int> &finalform1,
+    const std::set<int> &unused2,
+    const std::set<int> &finalform2)
+{
+    FaceBoxTree tree1, tree2;
+    std::set<std::pair<int, int> > overlaps, candidates;
+
+    face_box_tree_build(tree1, brep1, unused1, finalform1);
+    face_box_tree_build(tree2, brep2, unused2, finalform2);
+    tree1.Overlaps(tree2, &overlaps);
+
+    // The grown boxes overlap whenever the real ones are close enough,
+    // but not only then - apply the exact distance test to what's left.
+    for (std::set<std::pair<int, int> >::iterator it = overlaps.begin(); it != overlaps.end(); ++it) {
+	fastf_t face_dist = brep1->m_F[it->first].BoundingBox().MinimumDistanceTo(brep2->m_F[it->second].BoundingBox());
+	if (face_dist <= INTERSECTION_TOL) {
+	    candidates.insert(*it);
+	}
+    }
+
+    return candidates;
+}
+
+
+// The clipped intersection curves of one candidate face pair.
+struct FacePairCurves {
+    int m_i;	// face of brep1
+    int m_j;	// face of brep2
+    ON_SimpleArray<ON_Curve *> m_on1;	// curves on brep1->m_F[m_i]
+    ON_SimpleArray<ON_Curve *> m_on2;	// curves on brep2->m_F[m_j]
+
+    FacePairCurves(int i, int j) : m_i(i), m_j(j) {}
+};
+
+
+static void
+intersect_face_pair(
+    FacePairCurves &pair,
+    const ON_Brep *brep1,
+    const ON_Brep *brep2,
+    Subsurface *tree1,
+    Subsurface *tree2)
+{
+    int i = pair.m_i;
+    int j = pair.m_j;
+    ON_Surface *surf1, *surf2;
+    ON_ClassArray<ON_SSX_EVENT> events;
+    int results = 0;
+    surf1 = brep1->m_S[brep1->m_F[i].m_si];
+    surf2 = brep2->m_S[brep2->m_F[j].m_si];
+    if (is_same_surface(surf1, surf2)) {
+	return;
+    }
+
+    // Possible enhancement: Some faces may share the same surface.
+    // We can store the result of SSI to avoid re-computation.
+    results = ON_Intersect(surf1,
+			   surf2,
+			   events,
+			   INTERSECTION_TOL,
+			   0.0,
+			   0.0,
+			   NULL,
+			   NULL,
+			   NULL,
+			   NULL,
+			   tree1,
+			   tree2);
+    if (results <= 0) {
+	return;
+    }
+
+    for (int k = 0; k < events.Count(); k++) {
+	if (events[k].m_type == ON_SSX_EVENT::ssx_tangent ||
+	    events[k].m_type == ON_SSX_EVENT::ssx_transverse ||
+	    events[k].m_type == ON_SSX_EVENT::ssx_overlap)
+	{
+	    get_subcurves_inside_faces(pair.m_on1,
+				       pair.m_on2, brep1, brep2, i, j, &events[k]);
+	}
+    }
+
+    if (DEBUG_BREP_BOOLEAN) {
+	// Look for coplanar faces
+	ON_Plane surf1_plane, surf2_plane;
+	if (surf1->IsPlanar(&surf1_plane) && surf2->IsPlanar(&surf2_plane)) {
+	    /* We already checked for disjoint above, so the only remaining question is the normals */
+	    if (surf1_plane.Normal().IsParallelTo(surf2_plane.Normal())) {
+		bu_log("Faces brep1->%d and brep2->%d are coplanar and intersecting\n", i, j);
+	    }
+	}
+    }
+}
+
+
+// Subsurface trees split lazily as ON_Intersect() walks them, so a tree
+// can't be shared between threads.  The pairs are grouped by the brep1
+// surface they use: each group owns that surface's tree outright and
+// builds private trees for the brep2 surfaces it meets.  Groups are the
+// same however many threads run them, so the curves are too.
+struct FacePairJob {
+    const ON_Brep *brep1;
+    const ON_Brep *brep2;
+    std::vector<FacePairCurves> *pairs;
+    std::vector<Subsurface *> *st1;
+    std::vector<std::vector<size_t> > groups;
+    std::vector<std::exception_ptr> errors;
+    size_t next;
+};
+
+
+static void
+intersect_face_pair_group(struct FacePairJob *job, size_t g)
+{
+    std::map<int, Subsurface *> st2;
+    const std::vector<size_t> &group = job->groups[g];
+
+    try {
+	for (size_t k = 0; k < group.size(); k++) {
+	    FacePairCurves &pair = (*job->pairs)[group[k]];
+	    int si1 = job->brep1->m_F[pair.m_i].m_si;
+	    int si2 = job->brep2->m_F[pair.m_j].m_si;
+	    if (st2.find(si2) == st2.end()) {
+		st2[si2] = new Subsurface(job->brep2->m_S[si2]->Duplicate());
+	    }
+	    intersect_face_pair(pair, job->brep1, job->brep2, (*job->st1)[si1], st2[si2]);
+	}
+    } catch (...) {
+	job->errors[g] = std::current_exception();
+    }
+
+    for (std::map<int, Subsurface *>::iterator it = st2.begin(); it != st2.end(); ++it) {
+	delete it->second;
+    }
+}
+
+
+static void
+intersect_face_pair_worker(int UNUSED(cpu), void *arg)
+{
+    struct FacePairJob *job = (struct FacePairJob *)arg;
+
+    while (1) {
+	size_t g;
+
+	bu_semaphore_acquire(BU_SEM_GENERAL);
+	g = job->next++;
+	bu_semaphore_release(BU_SEM_GENERAL);
+
+	if (g >= job->groups.size())
+	    break;
+	intersect_face_pair_group(job, g);
+    }
+}
+
+
+static size_t
+boolean_ncpu(size_t ncpu)
+{
+    if (!ncpu)
+	ncpu = bu_avail_cpus();
+    if (ncpu > MAX_PSW)
+	ncpu = MAX_PSW;
+    if (ncpu < 1)
+	ncpu = 1;
+
+    return ncpu;
+}
+
+
+// Fill in the curves of every pair, in parallel where it's worth it.
+// st1 holds the brep1 surface trees, which are split in place.
+static void
+intersect_face_pairs(
+    std::vector<FacePairCurves> &pairs,
+    const ON_Brep *brep1,
+    const ON_Brep *brep2,
+    std::vector<Subsurface *> &st1,
+    size_t ncpu)
+{
+    struct FacePairJob job;
+    std::map<int, size_t> group_of_surface;
+
+    job.brep1 = brep1;
+    job.brep2 = brep2;
+    job.pairs = &pairs;
+    job.st1 = &st1;
+    job.next = 0;
+    for (size_t k = 0; k < pairs.size(); k++) {
+	int si1 = brep1->m_F[pairs[k].m_i].m_si;
+	if (group_of_surface.find(si1) == group_of_surface.end()) {
+	    group_of_surface[si1] = job.groups.size();
+	    job.groups.push_back(std::vector<size_t>());
+	}
+	job.groups[group_of_surface[si1]].push_back(k);
+    }
+    job.errors.resize(job.groups.size());
+
+    ncpu = boolean_ncpu(ncpu);
+    if (ncpu > job.groups.size())
+	ncpu = job.groups.size();
+
+    if (ncpu < 2 || pairs.size() < BOOLEAN_PARALLEL_MIN_PAIRS) {
+	intersect_face_pair_worker(0, &job);
+    } else {
+	bu_parallel(intersect_face_pair_worker, ncpu, &job);
+    }
+
+    // Report the first failure in group order, as a serial run would.
+    for (size_t g = 0; g < job.errors.size(); g++) {
+	if (job.errors[g]) {
+	    for (size_t k = 0; k < pairs.size(); k++) {
+		for (int l = 0; l < pairs[k].m_on1.Count(); ++l)
+		    delete pairs[k].m_on1[l];
+		for (int l = 0; l < pairs[k].m_on2.Count(); ++l)
+		    delete pairs[k].m_on2[l];
+	    }
+	    std::rethrow_exception(job.errors[g]);
+	}
+    }
+}
+
+
 static ON_ClassArray<ON_SimpleArray<SSICurve> >
 get_face_intersection_curves(
     ON_SimpleArray<Subsurface *> &surf_tree1,
     ON_SimpleArray<Subsurface *> &surf_tree2,
     const ON_Brep *brep1,
     const ON_Brep *brep2,
-    op_type operation)
+    op_type operation,
+    size_t ncpu)
 {
     std::vector<Subsurface *> st1, st2;
     std::set<int> unused1, unused2;
@@ -3523,21 +3782,8 @@ get_face_intersection_curves(
     //
     // We won't be able to distinguish between 1 and 3 at this stage, but we can narrow in
     // on which faces might fall into category 2 and what faces they might interact with.
-    std::set<std::pair<int, int> > intersection_candidates;
-    for (int i = 0; i < face_count1; i++) {
-	if (unused1.find(i) == unused1.end() && finalform1.find(i) == finalform1.end()) {
-	    for (int j = 0; j < face_count2; j++) {
-		if (unused2.find(j) == unused2.end() &&  finalform2.find(j) == finalform2.end()) {
-		    // If the two faces don't interact according to their bounding boxes,
-		    // they won't be a source of events - otherwise, they must be checked.
-		    fastf_t face_dist = brep1->m_F[i].BoundingBox().MinimumDistanceTo(brep2->m_F[j].BoundingBox());
-		    if (face_dist <= INTERSECTION_TOL) {
-			intersection_candidates.insert(std::pair<int, int>(i, j));
-		    }
-		}
-	    }
-	}
-    }
+    std::set<std::pair<int, int> > intersection_candidates =
+	get_intersection_candidates(brep1, brep2, unused1, finalform1, unused2, finalform2);
 
     // For those not in category 2 an inside/outside test on the breps combined with the boolean op
     // should be enough to decide the issue, but there is a problem.  If *all* faces of a brep are
@@ -3581,88 +3827,26 @@ get_face_intersection_curves(
     curves_array.SetCount(curves_array.Capacity());
 
     // calculate intersection curves
-    for (int i = 0; i < face_count1; i++) {
-
-	if ((int)st1.size() < brep1->m_F[i].m_si + 1)
+    std::vector<FacePairCurves> pairs;
+    for (std::set<std::pair<int, int> >::iterator it = intersection_candidates.begin(); it != intersection_candidates.end(); ++it) {
+	if ((int)st1.size() < brep1->m_F[it->first].m_si + 1)
 	    continue;
+	// surf_tree2 is only filled in below, so the brep2 side has to be
+	// checked against st2 or no pair would ever be intersected
+	if ((int)st2.size() < brep2->m_F[it->second].m_si + 1)
+	    continue;
+	pairs.push_back(FacePairCurves(it->first, it->second));
+    }
+    intersect_face_pairs(pairs, brep1, brep2, st1, ncpu);
 
-	for (int j = 0; j < face_count2; j++) {
-	    if (intersection_candidates.find(std::pair<int, int>(i, j)) != intersection_candidates.end()) {
-		ON_Surface *surf1, *surf2;
-		ON_ClassArray<ON_SSX_EVENT> events;
-		int results = 0;
-		surf1 = brep1->m_S[brep1->m_F[i].m_si];
-		surf2 = brep2->m_S[brep2->m_F[j].m_si];
-		if (is_same_surface(surf1, surf2)) {
-		    continue;
-		}
-
-		if (surf_tree2.Count() < brep2->m_F[j].m_si + 1)
-		    continue;
-
-		// Possible enhancement: Some faces may share the same surface.
-		// We can store the result of SSI to avoid re-computation.
-		results = ON_Intersect(surf1,
-				       surf2,
-				       events,
-				       INTERSECTION_TOL,
-				       0.0,
-				       0.0,
-				       NULL,
-				       NULL,
-				       NULL,
-				       NULL,
-				       st1[brep1->m_F[i].m_si],
-				       st2[brep2->m_F[j].m_si]);
-		if (results <= 0) {
-		    continue;
-		}
-
-		//dplot->SSX(events, brep1, brep1->m_F[i].m_si, brep2, brep2->m_F[j].m_si);
-		//dplot->WriteLog();
-
-		ON_SimpleArray<ON_Curve *> face1_curves, face2_curves;
-		for (int k = 0; k < events.Count(); k++) {
-		    if (events[k].m_type == ON_SSX_EVENT::ssx_tangent ||
-			events[k].m_type == ON_SSX_EVENT::ssx_transverse ||
-			events[k].m_type == ON_SSX_EVENT::ssx_overlap)
-		    {
-			ON_SimpleArray<ON_Curve *> subcurves_on1, subcurves_on2;
-
-			get_subcurves_inside_faces(subcurves_on1,
-						   subcurves_on2, brep1, brep2, i, j, &events[k]);
-
-			for (int l = 0; l < subcurves_on1.Count(); ++l) {
-			    SSICurve ssi_on1;
-			    ssi_on1.m_curve = subcurves_on1[l];
-			    curves_array[i].Append(ssi_on1);
-
-			    face1_curves.Append(subcurves_on1[l]);
-			}
-			for (int l = 0; l < subcurves_on2.Count(); ++l) {
-			    SSICurve ssi_on2;
-			    ssi_on2.m_curve = subcurves_on2[l];
-			    curves_array[face_count1 + j].Append(ssi_on2);
-
-			    face2_curves.Append(subcurves_on2[l]);
-			}
-		    }
-		}
-		//dplot->ClippedFaceCurves(surf1, surf2, face1_curves, face2_curves);
-		//dplot->WriteLog();
-
-		if (DEBUG_BREP_BOOLEAN) {
-		    // Look for coplanar faces
-		    ON_Plane surf1_plane, surf2_plane;
-		    if (surf1->IsPlanar(&surf1_plane) && surf2->IsPlanar(&surf2_plane)) {
-			/* We already checked for disjoint above, so the only remaining question is the normals */
-			if (surf1_plane.Normal().IsParallelTo(surf2_plane.Normal())) {
-			    bu_log("Faces brep1->%d and brep2->%d are coplanar and intersecting\n", i, j);
-			}
-		    }
-		}
-
-	    }
+    // Merge in (i, j) order, which is the order the serial double loop
+    // appended the curves in, whatever order the pairs finished in.
+    for (size_t k = 0; k < pairs.size(); k++) {
+	for (int l = 0; l < pairs[k].m_on1.Count(); ++l) {
+	    curves_array[pairs[k].m_i].Append(SSICurve(pairs[k].m_on1[l]));
+	}
+	for (int l = 0; l < pairs[k].m_on2.Count(); ++l) {
+	    curves_array[face_count1 + pairs[k].m_j].Append(SSICurve(pairs[k].m_on2[l]));
 	}
     }
 
@@ -3841,7 +4025,7 @@ categorize_trimmed_faces(
 
 
 static ON_ClassArray<ON_SimpleArray<TrimmedFace *> >
-get_evaluated_faces(const ON_Brep *brep1, const ON_Brep *brep2, op_type operation)
+get_evaluated_faces(const ON_Brep *brep1, const ON_Brep *brep2, op_type operation, size_t ncpu)
 {
     ON_SimpleArray<Subsurface *> surf_tree1, surf_tree2;
 
@@ -3853,7 +4037,7 @@ get_evaluated_faces(const ON_Brep *brep1, const ON_Brep *brep2, op_type operatio
 	return ON_ClassArray<ON_SimpleArray<TrimmedFace *> > ();
 
     ON_ClassArray<ON_SimpleArray<SSICurve> > curves_array =
-	get_face_intersection_curves(surf_tree1, surf_tree2, brep1, brep2, operation);
+	get_face_intersection_curves(surf_tree1, surf_tree2, brep1, brep2, operation, ncpu);
 
     ON_SimpleArray<TrimmedFace *> brep1_faces, brep2_faces;
     brep1_faces = get_trimmed_faces(brep1);
@@ -3993,7 +4177,7 @@ standardize_loop_orientations(ON_Brep *brep)
 
 
 int
-ON_Boolean(ON_Brep *evaluated_brep, const ON_Brep *brep1, const ON_Brep *brep2, op_type operation)
+ON_Boolean(ON_Brep *evaluated_brep, const ON_Brep *brep1, const ON_Brep *brep2, op_type operation, size_t ncpu)
 {
     static int calls = 0;
     ++calls;
@@ -4026,7 +4210,7 @@ ON_Boolean(ON_Brep *evaluated_brep, const ON_Brep *brep1, const ON_Brep *brep2,
 	    //dplot->WriteLog();
 	    return 0;
 	}
-	trimmed_faces = get_evaluated_faces(brep1, brep2, operation);
+	trimmed_faces = get_evaluated_faces(brep1, brep2, operation, ncpu);
     } catch (InvalidBooleanOperation &e) {
 	bu_log("%s", e.what());
 	//dplot->WriteLog();
@@ -0,0 +1,204 @@
+/*                    B O O L E A N _ C S G . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file boolean_csg.cpp
+ *
+ * Check the shape ON_Boolean() builds for a few box and cylinder
+ * combinations whose answers are known: the result must be a valid
+ * closed BREP with the expected extent, the expected points inside
+ * and outside it, and a curved face wherever the cylinder cuts.
+ */
+
+#include "common.h"
+
+#include "bu/app.h"
+#include "bu/log.h"
+#include "brep/boolean.h"
+
+
+/* how far the result's extent may drift from the exact one */
+#define CSG_BBOX_TOL 1.0e-6
+
+
+struct csg_point {
+    ON_3dPoint pt;
+    bool inside;
+};
+
+
+static ON_Brep *
+make_box(const ON_3dPoint &min, const ON_3dPoint &max)
+{
+    ON_3dPoint corners[8] = {
+	ON_3dPoint(min.x, min.y, min.z), ON_3dPoint(max.x, min.y, min.z),
+	ON_3dPoint(max.x, max.y, min.z), ON_3dPoint(min.x, max.y, min.z),
+	ON_3dPoint(min.x, min.y, max.z), ON_3dPoint(max.x, min.y, max.z),
+	ON_3dPoint(max.x, max.y, max.z), ON_3dPoint(min.x, max.y, max.z)
+    };
+    return ON_BrepBox(corners);
+}
+
+
+/* A capped cylinder along z from z0 to z1 */
+static ON_Brep *
+make_cylinder(double radius, double z0, double z1)
+{
+    ON_Circle base(ON_Plane(ON_3dPoint(0, 0, z0), ON_3dVector::ZAxis), radius);
+    ON_Cylinder cyl(base, z1 - z0);
+    return ON_BrepCylinder(cyl, true, true);
+}
+
+
+static bool
+has_curved_face(const ON_Brep &brep)
+{
+    for (int i = 0; i < brep.m_F.Count(); i++) {
+	const ON_Surface *surf = brep.m_F[i].SurfaceOf();
+	if (surf && !surf->IsPlanar())
+	    return true;
+    }
+    return false;
+}
+
+
+static int
+check_case(const char *name, const ON_Brep *brep1, const ON_Brep *brep2, op_type op,
+	   const ON_BoundingBox &bbox, bool curved, const struct csg_point *pts, size_t npts)
+{
+    ON_Brep result;
+    int failed = 0;
+
+    if (ON_Boolean(&result, brep1, brep2, op) < 0) {
+	bu_log("%s: ON_Boolean failed\n", name);
+	return 1;
+    }
+    if (!result.IsValid() || !result.IsSolid()) {
+	bu_log("%s: result is not a valid closed BREP\n", name);
+	return 1;
+    }
+
+    ON_BoundingBox rbox = result.BoundingBox();
+    if (rbox.m_min.DistanceTo(bbox.m_min) > CSG_BBOX_TOL
+	|| rbox.m_max.DistanceTo(bbox.m_max) > CSG_BBOX_TOL) {
+	bu_log("%s: bounding box (%g %g %g) (%g %g %g), expected (%g %g %g) (%g %g %g)\n", name,
+	       rbox.m_min.x, rbox.m_min.y, rbox.m_min.z, rbox.m_max.x, rbox.m_max.y, rbox.m_max.z,
+	       bbox.m_min.x, bbox.m_min.y, bbox.m_min.z, bbox.m_max.x, bbox.m_max.y, bbox.m_max.z);
+	failed = 1;
+    }
+
+    if (has_curved_face(result) != curved) {
+	bu_log("%s: result %s a curved face\n", name, curved ? "lacks" : "has");
+	failed = 1;
+    }
+
+    for (size_t i = 0; i < npts; i++) {
+	if (ON_BrepPointInside(pts[i].pt, &result) != pts[i].inside) {
+	    bu_log("%s: (%g %g %g) should be %s\n", name, pts[i].pt.x, pts[i].pt.y, pts[i].pt.z,
+		   pts[i].inside ? "inside" : "outside");
+	    failed = 1;
+	}
+    }
+
+    bu_log("%-20s %2d x %2d faces -> %2d faces [%s]\n", name, brep1->m_F.Count(),
+	   brep2->m_F.Count(), result.m_F.Count(), failed ? "FAIL" : "PASS");
+    return failed;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int failed = 0;
+
+    bu_setprogname(argv[0]);
+
+    if (argc != 1)
+	bu_exit(1, "Usage: %s\n", argv[0]);
+
+    ON_Brep *box = make_box(ON_3dPoint(-4, -4, -4), ON_3dPoint(4, 4, 4));
+    ON_Brep *through = make_cylinder(2.0, -6.0, 6.0);
+    ON_Brep *blind = make_cylinder(2.0, 0.0, 6.0);
+    ON_Brep *offset = make_box(ON_3dPoint(2, 2, 2), ON_3dPoint(6, 6, 6));
+    ON_BoundingBox boxbb(ON_3dPoint(-4, -4, -4), ON_3dPoint(4, 4, 4));
+
+    /* a hole all the way through the box */
+    struct csg_point through_pts[] = {
+	{ON_3dPoint(0, 0, 0), false},
+	{ON_3dPoint(1, 1, 3.5), false},
+	{ON_3dPoint(0, 3, 0), true},
+	{ON_3dPoint(3, 3, -3), true},
+	{ON_3dPoint(5, 0, 0), false}
+    };
+    failed += check_case("box - through cyl", box, through, BOOLEAN_DIFF, boxbb, true,
+			 through_pts, sizeof(through_pts) / sizeof(through_pts[0]));
+
+    /* a hole down to the middle of the box */
+    struct csg_point blind_pts[] = {
+	{ON_3dPoint(0, 0, 2), false},
+	{ON_3dPoint(0, 0, -2), true},
+	{ON_3dPoint(0, 3, 2), true},
+	{ON_3dPoint(3, 3, 3), true}
+    };
+    failed += check_case("box - blind cyl", box, blind, BOOLEAN_DIFF, boxbb, true,
+			 blind_pts, sizeof(blind_pts) / sizeof(blind_pts[0]));
+
+    /* the slug the through hole removes */
+    struct csg_point slug_pts[] = {
+	{ON_3dPoint(0, 0, 0), true},
+	{ON_3dPoint(0, 0, 5), false},
+	{ON_3dPoint(0, 3, 0), false}
+    };
+    failed += check_case("box & through cyl", box, through, BOOLEAN_INTERSECT,
+			 ON_BoundingBox(ON_3dPoint(-2, -2, -4), ON_3dPoint(2, 2, 4)), true,
+			 slug_pts, sizeof(slug_pts) / sizeof(slug_pts[0]));
+
+    /* two boxes sharing a corner cube */
+    struct csg_point union_pts[] = {
+	{ON_3dPoint(0, 0, 0), true},
+	{ON_3dPoint(3, 3, 3), true},
+	{ON_3dPoint(5, 5, 5), true},
+	{ON_3dPoint(5, -3, 0), false},
+	{ON_3dPoint(-3, 5, 0), false}
+    };
+    failed += check_case("box u box", box, offset, BOOLEAN_UNION,
+			 ON_BoundingBox(ON_3dPoint(-4, -4, -4), ON_3dPoint(6, 6, 6)), false,
+			 union_pts, sizeof(union_pts) / sizeof(union_pts[0]));
+
+    delete box;
+    delete through;
+    delete blind;
+    delete offset;
+
+    if (failed)
+	return 1;
+
+    bu_log("All unit tests succeeded.\n");
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C++
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,194 @@
+/*                 B O O L E A N _ T I M I N G . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file boolean_timing.cpp
+ *
+ * Time ON_Boolean() on a few representative BREP pairs, once with the
+ * face pair intersections pinned to one thread and once with all
+ * available threads.  The two evaluations must give the same BREP.
+ *
+ * The pairs are two overlapping NURBS spheres, a box with a cylinder
+ * through it, and two faceted spheres of nlon x nlat triangles each -
+ * the many-small-planar-faces shape of an imported STEP assembly.
+ *
+ * Usage: boolean_timing [nlon nlat]
+ */
+
+#include "common.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/log.h"
+#include "bu/parallel.h"
+#include "brep/boolean.h"
+
+
+/* A sphere of nlon x nlat triangles, one planar face per triangle */
+static ON_Brep *
+faceted_sphere(const ON_3dPoint &center, double radius, int nlon, int nlat)
+{
+    ON_Mesh mesh((nlat - 1) * nlon * 2, (nlat - 1) * nlon + 2, false, false);
+    int north = (nlat - 1) * nlon;
+    int south = north + 1;
+
+    for (int j = 0; j < nlat - 1; j++) {
+	double phi = ON_PI * (j + 1) / nlat;
+	for (int i = 0; i < nlon; i++) {
+	    double theta = 2.0 * ON_PI * i / nlon;
+	    mesh.SetVertex(j * nlon + i, center + radius * ON_3dVector(sin(phi) * cos(theta), sin(phi) * sin(theta), cos(phi)));
+	}
+    }
+    mesh.SetVertex(north, center + ON_3dVector(0, 0, radius));
+    mesh.SetVertex(south, center - ON_3dVector(0, 0, radius));
+
+    int f = 0;
+    for (int i = 0; i < nlon; i++) {
+	int i1 = (i + 1) % nlon;
+	mesh.SetTriangle(f++, north, i, i1);
+	mesh.SetTriangle(f++, south, (nlat - 2) * nlon + i1, (nlat - 2) * nlon + i);
+	for (int j = 0; j < nlat - 2; j++) {
+	    mesh.SetTriangle(f++, j * nlon + i, (j + 1) * nlon + i, (j + 1) * nlon + i1);
+	    mesh.SetTriangle(f++, j * nlon + i, (j + 1) * nlon + i1, j * nlon + i1);
+	}
+    }
+    mesh.ComputeVertexNormals();
+
+    return ON_BrepFromMesh(mesh.Topology(), true);
+}
+
+
+/* Evaluate brep1 op brep2 with ncpu threads (0 for all of them) */
+static int
+timed_boolean(ON_Brep *out, const ON_Brep *brep1, const ON_Brep *brep2, op_type op, int ncpu, double *seconds)
+{
+    int64_t start = bu_gettime();
+    int ret = ON_Boolean(out, brep1, brep2, op, (size_t)ncpu);
+    *seconds = (double)(bu_gettime() - start) / 1.0e6;
+
+    return ret;
+}
+
+
+static bool
+same_brep(const ON_Brep &b1, const ON_Brep &b2)
+{
+    if (b1.m_F.Count() != b2.m_F.Count() || b1.m_L.Count() != b2.m_L.Count()
+	|| b1.m_T.Count() != b2.m_T.Count() || b1.m_E.Count() != b2.m_E.Count()
+	|| b1.m_V.Count() != b2.m_V.Count())
+	return false;
+
+    for (int i = 0; i < b1.m_V.Count(); i++) {
+	if (b1.m_V[i].point.DistanceTo(b2.m_V[i].point) > ON_ZERO_TOLERANCE)
+	    return false;
+    }
+
+    ON_BoundingBox bb1 = b1.BoundingBox();
+    ON_BoundingBox bb2 = b2.BoundingBox();
+    return bb1.m_min.DistanceTo(bb2.m_min) <= ON_ZERO_TOLERANCE
+	&& bb1.m_max.DistanceTo(bb2.m_max) <= ON_ZERO_TOLERANCE;
+}
+
+
+static int
+run_case(const char *name, const ON_Brep *brep1, const ON_Brep *brep2, op_type op)
+{
+    ON_Brep serial, parallel;
+    double t_serial, t_parallel;
+
+    int ret_serial = timed_boolean(&serial, brep1, brep2, op, 1, &t_serial);
+    int ret_parallel = timed_boolean(&parallel, brep1, brep2, op, 0, &t_parallel);
+
+    bu_log("%-16s %4d x %4d faces -> %4d faces, 1 thread %.4f sec, %zu threads %.4f sec\n",
+	   name, brep1->m_F.Count(), brep2->m_F.Count(), parallel.m_F.Count(),
+	   t_serial, bu_avail_cpus(), t_parallel);
+
+    if (ret_serial != ret_parallel || !same_brep(serial, parallel)) {
+	bu_log("%s: threaded evaluation differs from the single thread one\n", name);
+	return 1;
+    }
+    return 0;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int nlon = 16, nlat = 8;
+    int failed = 0;
+
+    bu_setprogname(argv[0]);
+
+    if (argc == 3) {
+	nlon = atoi(argv[1]);
+	nlat = atoi(argv[2]);
+    } else if (argc != 1) {
+	bu_exit(1, "Usage: %s [nlon nlat]\n", argv[0]);
+    }
+    if (nlon < 3 || nlat < 3)
+	bu_exit(1, "boolean_timing: need at least 3x3 facets\n");
+
+    ON_Sphere s1(ON_3dPoint(0, 0, 0), 5.0);
+    ON_Sphere s2(ON_3dPoint(3, 2, 1), 4.0);
+    ON_Brep *sph1 = ON_BrepSphere(s1);
+    ON_Brep *sph2 = ON_BrepSphere(s2);
+    failed += run_case("spheres", sph1, sph2, BOOLEAN_UNION);
+
+    ON_3dPoint corners[8] = {
+	ON_3dPoint(-4, -4, -4), ON_3dPoint(4, -4, -4), ON_3dPoint(4, 4, -4), ON_3dPoint(-4, 4, -4),
+	ON_3dPoint(-4, -4, 4), ON_3dPoint(4, -4, 4), ON_3dPoint(4, 4, 4), ON_3dPoint(-4, 4, 4)
+    };
+    ON_Circle base(ON_Plane(ON_3dPoint(0, 0, -6), ON_3dVector::ZAxis), 2.0);
+    ON_Cylinder cyl(base, 12.0);
+    ON_Brep *box = ON_BrepBox(corners);
+    ON_Brep *hole = ON_BrepCylinder(cyl, true, true);
+    failed += run_case("box - cylinder", box, hole, BOOLEAN_DIFF);
+
+    ON_Brep *fac1 = faceted_sphere(ON_3dPoint(0, 0, 0), 50.0, nlon, nlat);
+    ON_Brep *fac2 = faceted_sphere(ON_3dPoint(37, 23, 11), 40.0, nlon, nlat);
+    if (!fac1 || !fac2)
+	bu_exit(1, "boolean_timing: faceted sphere conversion failed\n");
+    failed += run_case("faceted spheres", fac1, fac2, BOOLEAN_INTERSECT);
+
+    delete sph1;
+    delete sph2;
+    delete box;
+    delete hole;
+    delete fac1;
+    delete fac2;
+
+    if (failed)
+	return 1;
+
+    bu_log("All unit tests succeeded.\n");
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C++
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
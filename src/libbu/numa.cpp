@@ -0,0 +1,291 @@
+/*                          N U M A . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file numa.cpp
+ *
+ * NUMA topology for the thread pool and bu_numa_*().
+ *
+ * The topology is read once, from /sys/devices/system/node on Linux,
+ * and only counts the CPUs in this process's affinity mask, so running
+ * under numactl or taskset narrows it as expected.  Nodes are numbered
+ * densely from 0 in the order the kernel lists them.  Elsewhere there
+ * is always a single node.
+ */
+
+#include "common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_SCHED_H
+#  include <sched.h>
+#endif
+
+#ifdef HAVE_PTHREAD_H
+#  include <pthread.h>
+#endif
+
+#include "bu/log.h"
+#include "bu/parallel.h"
+
+#include "./parallel.h"
+
+#if defined(__linux__) && defined(HAVE_PTHREAD_H) && defined(CPU_ZERO)
+#  define NUMA_LINUX 1
+#endif
+
+
+struct numa_topology {
+    /* CPUs of each node */
+    std::vector<std::vector<int>> cpus;
+    /* node of each CPU number, -1 for CPUs we can't use */
+    std::vector<int> cpu_node;
+};
+
+
+/* node count asked for by bu_numa_set_nodes(), 0 for the real
+ * topology, and whether the topology has been read yet */
+static std::atomic<size_t> numa_want(0);
+static std::atomic<bool> numa_read(false);
+
+
+/* node the calling thread is bound to, -1 if it isn't */
+static thread_local int numa_thread_node = -1;
+
+
+#ifdef NUMA_LINUX
+/* Parse a kernel CPU or node list such as "0-3,8-11" */
+static std::vector<int>
+numa_parse_list(const char *path)
+{
+    std::vector<int> ids;
+    char buf[4096];
+    FILE *fp = fopen(path, "r");
+
+    if (!fp)
+	return ids;
+    if (!fgets(buf, sizeof(buf), fp)) {
+	fclose(fp);
+	return ids;
+    }
+    fclose(fp);
+
+    char *cp = buf;
+    while (*cp >= '0' && *cp <= '9') {
+	long first = strtol(cp, &cp, 10);
+	long last = first;
+	if (*cp == '-')
+	    last = strtol(cp + 1, &cp, 10);
+	for (long i = first; i <= last; i++)
+	    ids.push_back((int)i);
+	if (*cp == ',')
+	    cp++;
+    }
+
+    return ids;
+}
+#endif
+
+
+static struct numa_topology
+numa_discover(void)
+{
+    struct numa_topology t;
+    size_t want;
+
+    numa_read = true;
+    want = numa_want;
+    if (want == 1)
+	return t;
+
+#ifdef NUMA_LINUX
+    cpu_set_t allowed;
+    std::vector<int> usable;
+
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed))
+	return t;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+	if (CPU_ISSET(cpu, &allowed))
+	    usable.push_back(cpu);
+    }
+    if (usable.empty())
+	return t;
+
+    if (want > 1) {
+	/* split the usable CPUs into 'want' pretend nodes, sharing
+	 * them out if there are fewer CPUs than nodes */
+	size_t n = want;
+	for (size_t i = 0; i < n; i++) {
+	    std::vector<int> node;
+	    if (usable.size() >= n) {
+		for (size_t j = i * usable.size() / n; j < (i + 1) * usable.size() / n; j++)
+		    node.push_back(usable[j]);
+	    } else {
+		node.push_back(usable[i % usable.size()]);
+	    }
+	    t.cpus.push_back(node);
+	}
+    } else {
+	std::vector<int> online = numa_parse_list("/sys/devices/system/node/online");
+	for (size_t i = 0; i < online.size(); i++) {
+	    char path[128];
+	    std::vector<int> node;
+	    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", online[i]);
+	    std::vector<int> listed = numa_parse_list(path);
+	    for (size_t j = 0; j < listed.size(); j++) {
+		if (listed[j] < CPU_SETSIZE && CPU_ISSET(listed[j], &allowed))
+		    node.push_back(listed[j]);
+	    }
+	    if (!node.empty())
+		t.cpus.push_back(node);
+	}
+    }
+
+    if (t.cpus.size() < 2) {
+	t.cpus.clear();
+	return t;
+    }
+
+    t.cpu_node.assign(CPU_SETSIZE, -1);
+    for (size_t i = 0; i < t.cpus.size(); i++) {
+	for (size_t j = 0; j < t.cpus[i].size(); j++) {
+	    if (t.cpu_node[t.cpus[i][j]] < 0)
+		t.cpu_node[t.cpus[i][j]] = (int)i;
+	}
+    }
+#endif
+
+    return t;
+}
+
+
+static const struct numa_topology &
+numa_get(void)
+{
+    static const struct numa_topology topology = numa_discover();
+    return topology;
+}
+
+
+extern "C" int
+bu_numa_set_nodes(size_t nodes)
+{
+    if (numa_read)
+	return -1;
+    numa_want = nodes;
+    return 0;
+}
+
+
+extern "C" size_t
+bu_numa_nodes(void)
+{
+    size_t n = numa_get().cpus.size();
+    return n ? n : 1;
+}
+
+
+extern "C" int
+bu_numa_node(void)
+{
+    const struct numa_topology &t = numa_get();
+
+    if (numa_thread_node >= 0)
+	return numa_thread_node;
+    if (t.cpus.empty())
+	return 0;
+
+#ifdef NUMA_LINUX
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && (size_t)cpu < t.cpu_node.size() && t.cpu_node[cpu] >= 0)
+	return t.cpu_node[cpu];
+#endif
+
+    return 0;
+}
+
+
+extern "C" int
+parallel_set_node_affinity(int node)
+{
+    const struct numa_topology &t = numa_get();
+
+    if (node < 0 || (size_t)node >= t.cpus.size())
+	return -1;
+
+#ifdef NUMA_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < t.cpus[node].size(); i++)
+	CPU_SET(t.cpus[node][i], &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+	return -1;
+    numa_thread_node = node;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+
+extern "C" void
+bu_numa_run(void (*func)(int node, void *data), void *data)
+{
+    size_t n = bu_numa_nodes();
+
+    if (!func)
+	return;
+
+    if (n < 2) {
+	(*func)(0, data);
+	return;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < n; i++) {
+	try {
+	    threads.emplace_back([func, data, i]() {
+		if (parallel_set_node_affinity((int)i))
+		    bu_log("WARNING: could not bind a thread to NUMA node %zu\n", i);
+		(*func)((int)i, data);
+	    });
+	} catch (...) {
+	    /* run it here instead; the memory lands wherever we are */
+	    bu_log("WARNING: could not start a thread for NUMA node %zu\n", i);
+	    (*func)((int)i, data);
+	}
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+	threads[i].join();
+}
+
+
+// Local Variables:
+// tab-width: 8
+// mode: C++
+// c-basic-offset: 4
+// indent-tabs-mode: t
+// c-file-style: "stroustrup"
+// End:
+// ex: shiftwidth=4 tabstop=8
@@ -0,0 +1,567 @@
+/*                      O H A S H . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file libbu/ohash.cpp
+ *
+ * Open addressing hash table.
+ *
+ * Each shard is an array of slots and a parallel array of control
+ * bytes, one per slot: OH_EMPTY, OH_DELETED, or the low seven bits of
+ * the entry's hash.  Probing goes a group of OH_GROUP slots at a
+ * time, matching all sixteen control bytes against the wanted tag at
+ * once, and stops at the first group holding an empty slot.  Groups
+ * are visited in triangular order, which covers every group of a
+ * power of two table.
+ */
+
+#include "common.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define OH_SSE2 1
+#endif
+
+#define XXH_INLINE_ALL
+#include "xxhash.h"
+
+#include "bu/hash.h"
+#include "bu/malloc.h"
+
+
+#define OH_GROUP 16
+#define OH_EMPTY ((int8_t)-128)
+#define OH_DELETED ((int8_t)-2)
+
+/* Shards of a concurrent table, a power of two; picked by the top
+ * bits of the hash so they're independent of the group bits. */
+#define OH_SHARDS 16
+#define OH_SHARD_SHIFT 60
+
+
+struct oh_slot {
+    uint64_t hash;
+    const uint8_t *key;	/* NULL for an integer key */
+    uint64_t klen;	/* key length, or the integer key */
+    void *val;
+};
+
+struct oh_shard {
+    int8_t *ctrl;
+    struct oh_slot *slots;
+    size_t cap;		/* slots, a multiple of OH_GROUP */
+    size_t count;
+    size_t deleted;
+    std::shared_mutex *lock;
+};
+
+struct bu_ohash {
+    int flags;
+    size_t nshards;
+    struct oh_shard *shards;
+};
+
+
+static inline uint64_t
+oh_hash_bytes(const uint8_t *key, size_t len)
+{
+    return (uint64_t)XXH3_64bits(key, len);
+}
+
+
+/* MurmurHash3 finalizer, so sequential integers spread out */
+static inline uint64_t
+oh_hash_int(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+
+/* Bit i set where control byte i of the group equals c */
+static inline uint32_t
+oh_match(const int8_t *g, int8_t c)
+{
+#ifdef OH_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(c)));
+#else
+    uint32_t m = 0;
+    for (int i = 0; i < OH_GROUP; i++)
+	m |= (uint32_t)(g[i] == c) << i;
+    return m;
+#endif
+}
+
+
+/* Bit i set where slot i of the group is empty or deleted */
+static inline uint32_t
+oh_match_free(const int8_t *g)
+{
+#ifdef OH_SSE2
+    /* tags are 0..127, only the two markers have the sign bit */
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+#else
+    uint32_t m = 0;
+    for (int i = 0; i < OH_GROUP; i++)
+	m |= (uint32_t)(g[i] < 0) << i;
+    return m;
+#endif
+}
+
+
+static inline int
+oh_lowbit(uint32_t m)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(m);
+#else
+    int i = 0;
+    while (!(m & 1)) {
+	m >>= 1;
+	i++;
+    }
+    return i;
+#endif
+}
+
+
+static inline struct oh_shard *
+oh_shard_of(const struct bu_ohash *t, uint64_t hash)
+{
+    return &t->shards[t->nshards == 1 ? 0 : (size_t)(hash >> OH_SHARD_SHIFT)];
+}
+
+
+static inline int
+oh_key_eq(const struct oh_slot *s, uint64_t hash, const uint8_t *key, uint64_t klen)
+{
+    if (s->hash != hash || s->klen != klen)
+	return 0;
+    if (!key)
+	return s->key == NULL;
+    return s->key && memcmp(s->key, key, (size_t)klen) == 0;
+}
+
+
+/* Index of the slot holding the key, or cap if it isn't there */
+static size_t
+oh_find(const struct oh_shard *sh, uint64_t hash, const uint8_t *key, uint64_t klen)
+{
+    size_t gmask = sh->cap / OH_GROUP - 1;
+    size_t g = (size_t)(hash >> 7) & gmask;
+    int8_t tag = (int8_t)(hash & 0x7f);
+
+    for (size_t step = 1; ; step++) {
+	const int8_t *ctrl = sh->ctrl + g * OH_GROUP;
+	uint32_t m = oh_match(ctrl, tag);
+	while (m) {
+	    size_t i = g * OH_GROUP + oh_lowbit(m);
+	    if (oh_key_eq(&sh->slots[i], hash, key, klen))
+		return i;
+	    m &= m - 1;
+	}
+	if (oh_match(ctrl, OH_EMPTY))
+	    return sh->cap;
+	g = (g + step) & gmask;
+    }
+}
+
+
+/* First empty or deleted slot on the key's probe sequence */
+static size_t
+oh_find_free(const struct oh_shard *sh, uint64_t hash)
+{
+    size_t gmask = sh->cap / OH_GROUP - 1;
+    size_t g = (size_t)(hash >> 7) & gmask;
+
+    for (size_t step = 1; ; step++) {
+	uint32_t m = oh_match_free(sh->ctrl + g * OH_GROUP);
+	if (m)
+	    return g * OH_GROUP + oh_lowbit(m);
+	g = (g + step) & gmask;
+    }
+}
+
+
+static void
+oh_shard_alloc(struct oh_shard *sh, size_t cap)
+{
+    sh->cap = cap;
+    sh->ctrl = (int8_t *)bu_malloc(cap, "bu_ohash ctrl");
+    memset(sh->ctrl, OH_EMPTY, cap);
+    sh->slots = (struct oh_slot *)bu_malloc(cap * sizeof(struct oh_slot), "bu_ohash slots");
+    sh->count = 0;
+    sh->deleted = 0;
+}
+
+
+/* Rebuild the shard with room for at least one more entry, dropping
+ * the tombstones.  Slots move but keys don't, so nothing is copied. */
+static void
+oh_shard_rehash(struct oh_shard *sh)
+{
+    int8_t *octrl = sh->ctrl;
+    struct oh_slot *oslots = sh->slots;
+    size_t ocap = sh->cap;
+    size_t cap = ocap;
+
+    /* grow when more than half the slots hold live entries, otherwise
+     * it was the tombstones that filled the shard */
+    while ((sh->count + 1) * 2 > cap)
+	cap *= 2;
+
+    oh_shard_alloc(sh, cap);
+    for (size_t i = 0; i < ocap; i++) {
+	if (octrl[i] < 0)
+	    continue;
+	size_t j = oh_find_free(sh, oslots[i].hash);
+	sh->ctrl[j] = octrl[i];
+	sh->slots[j] = oslots[i];
+	sh->count++;
+    }
+
+    bu_free(octrl, "bu_ohash ctrl");
+    bu_free(oslots, "bu_ohash slots");
+}
+
+
+static size_t
+oh_pow2_cap(size_t n)
+{
+    size_t cap = OH_GROUP;
+    while (cap < n)
+	cap *= 2;
+    return cap;
+}
+
+
+bu_ohash *
+bu_ohash_create(size_t nelem, int flags)
+{
+    struct bu_ohash *t;
+
+    BU_GET(t, struct bu_ohash);
+    t->flags = flags;
+    t->nshards = (flags & BU_OHASH_CONCURRENT) ? OH_SHARDS : 1;
+    t->shards = (struct oh_shard *)bu_calloc(t->nshards, sizeof(struct oh_shard), "bu_ohash shards");
+
+    /* room for nelem at the 7/8 load limit */
+    size_t per = (nelem / t->nshards) * 8 / 7 + 1;
+    for (size_t i = 0; i < t->nshards; i++) {
+	oh_shard_alloc(&t->shards[i], oh_pow2_cap(per));
+	if (flags & BU_OHASH_CONCURRENT)
+	    t->shards[i].lock = new std::shared_mutex;
+    }
+    return t;
+}
+
+
+static void
+oh_shard_free_keys(const struct bu_ohash *t, struct oh_shard *sh)
+{
+    if (t->flags & BU_OHASH_BORROW_KEYS)
+	return;
+    for (size_t i = 0; i < sh->cap; i++) {
+	if (sh->ctrl[i] >= 0 && sh->slots[i].key)
+	    bu_free((void *)sh->slots[i].key, "bu_ohash key");
+    }
+}
+
+
+void
+bu_ohash_destroy(bu_ohash *t)
+{
+    if (!t)
+	return;
+
+    for (size_t i = 0; i < t->nshards; i++) {
+	struct oh_shard *sh = &t->shards[i];
+	oh_shard_free_keys(t, sh);
+	bu_free(sh->ctrl, "bu_ohash ctrl");
+	bu_free(sh->slots, "bu_ohash slots");
+	delete sh->lock;
+    }
+    bu_free(t->shards, "bu_ohash shards");
+    BU_PUT(t, struct bu_ohash);
+}
+
+
+void
+bu_ohash_clear(bu_ohash *t)
+{
+    if (!t)
+	return;
+
+    for (size_t i = 0; i < t->nshards; i++) {
+	struct oh_shard *sh = &t->shards[i];
+	if (sh->lock)
+	    sh->lock->lock();
+	oh_shard_free_keys(t, sh);
+	memset(sh->ctrl, OH_EMPTY, sh->cap);
+	sh->count = 0;
+	sh->deleted = 0;
+	if (sh->lock)
+	    sh->lock->unlock();
+    }
+}
+
+
+size_t
+bu_ohash_count(const bu_ohash *t)
+{
+    size_t n = 0;
+
+    if (!t)
+	return 0;
+    for (size_t i = 0; i < t->nshards; i++)
+	n += t->shards[i].count;
+    return n;
+}
+
+
+static void *
+oh_get(const struct bu_ohash *t, uint64_t hash, const uint8_t *key, uint64_t klen)
+{
+    struct oh_shard *sh = oh_shard_of(t, hash);
+    void *val = NULL;
+
+    if (sh->lock)
+	sh->lock->lock_shared();
+    size_t i = oh_find(sh, hash, key, klen);
+    if (i < sh->cap)
+	val = sh->slots[i].val;
+    if (sh->lock)
+	sh->lock->unlock_shared();
+
+    return val;
+}
+
+
+static int
+oh_set(struct bu_ohash *t, uint64_t hash, const uint8_t *key, uint64_t klen, void *val)
+{
+    struct oh_shard *sh = oh_shard_of(t, hash);
+    int ret = 0;
+
+    if (sh->lock)
+	sh->lock->lock();
+
+    size_t i = oh_find(sh, hash, key, klen);
+    if (i < sh->cap) {
+	sh->slots[i].val = val;
+    } else {
+	if ((sh->count + sh->deleted + 1) * 8 > sh->cap * 7)
+	    oh_shard_rehash(sh);
+	i = oh_find_free(sh, hash);
+	if (sh->ctrl[i] == OH_DELETED)
+	    sh->deleted--;
+	sh->ctrl[i] = (int8_t)(hash & 0x7f);
+	sh->slots[i].hash = hash;
+	sh->slots[i].klen = klen;
+	sh->slots[i].val = val;
+	if (key && !(t->flags & BU_OHASH_BORROW_KEYS)) {
+	    uint8_t *kcopy = (uint8_t *)bu_malloc((size_t)klen, "bu_ohash key");
+	    memcpy(kcopy, key, (size_t)klen);
+	    key = kcopy;
+	}
+	sh->slots[i].key = key;
+	sh->count++;
+	ret = 1;
+    }
+
+    if (sh->lock)
+	sh->lock->unlock();
+    return ret;
+}
+
+
+static int
+oh_rm(struct bu_ohash *t, uint64_t hash, const uint8_t *key, uint64_t klen)
+{
+    struct oh_shard *sh = oh_shard_of(t, hash);
+    int ret = 0;
+
+    if (sh->lock)
+	sh->lock->lock();
+
+    size_t i = oh_find(sh, hash, key, klen);
+    if (i < sh->cap) {
+	if (sh->slots[i].key && !(t->flags & BU_OHASH_BORROW_KEYS))
+	    bu_free((void *)sh->slots[i].key, "bu_ohash key");
+
+	/* A probe only goes past a group with no empty slots, so if
+	 * this group has one no probe can depend on the slot staying
+	 * occupied, and it can go straight back to empty. */
+	if (oh_match(sh->ctrl + (i / OH_GROUP) * OH_GROUP, OH_EMPTY)) {
+	    sh->ctrl[i] = OH_EMPTY;
+	} else {
+	    sh->ctrl[i] = OH_DELETED;
+	    sh->deleted++;
+	}
+	sh->count--;
+	ret = 1;
+    }
+
+    if (sh->lock)
+	sh->lock->unlock();
+    return ret;
+}
+
+
+void *
+bu_ohash_get(const bu_ohash *t, const uint8_t *key, size_t key_len)
+{
+    if (!t || !key || !key_len)
+	return NULL;
+    return oh_get(t, oh_hash_bytes(key, key_len), key, key_len);
+}
+
+
+int
+bu_ohash_set(bu_ohash *t, const uint8_t *key, size_t key_len, void *val)
+{
+    if (!t || !key || !key_len || !val)
+	return -1;
+    return oh_set(t, oh_hash_bytes(key, key_len), key, key_len, val);
+}
+
+
+int
+bu_ohash_rm(bu_ohash *t, const uint8_t *key, size_t key_len)
+{
+    if (!t || !key || !key_len)
+	return 0;
+    return oh_rm(t, oh_hash_bytes(key, key_len), key, key_len);
+}
+
+
+uint64_t
+bu_ohash_hash(const uint8_t *key, size_t key_len)
+{
+    if (!key || !key_len)
+	return 0;
+    return oh_hash_bytes(key, key_len);
+}
+
+
+void *
+bu_ohash_get_hashed(const bu_ohash *t, uint64_t hash, const uint8_t *key, size_t key_len)
+{
+    if (!t || !key || !key_len)
+	return NULL;
+    return oh_get(t, hash, key, key_len);
+}
+
+
+int
+bu_ohash_set_hashed(bu_ohash *t, uint64_t hash, const uint8_t *key, size_t key_len, void *val)
+{
+    if (!t || !key || !key_len || !val)
+	return -1;
+    return oh_set(t, hash, key, key_len, val);
+}
+
+
+int
+bu_ohash_rm_hashed(bu_ohash *t, uint64_t hash, const uint8_t *key, size_t key_len)
+{
+    if (!t || !key || !key_len)
+	return 0;
+    return oh_rm(t, hash, key, key_len);
+}
+
+
+void *
+bu_ohash_get_int(const bu_ohash *t, uint64_t key)
+{
+    if (!t)
+	return NULL;
+    return oh_get(t, oh_hash_int(key), NULL, key);
+}
+
+
+int
+bu_ohash_set_int(bu_ohash *t, uint64_t key, void *val)
+{
+    if (!t || !val)
+	return -1;
+    return oh_set(t, oh_hash_int(key), NULL, key, val);
+}
+
+
+int
+bu_ohash_rm_int(bu_ohash *t, uint64_t key)
+{
+    if (!t)
+	return 0;
+    return oh_rm(t, oh_hash_int(key), NULL, key);
+}
+
+
+int
+bu_ohash_next(const bu_ohash *t, size_t *pos, const uint8_t **key, size_t *key_len, uint64_t *ikey, void **val)
+{
+    if (!t || !pos)
+	return 0;
+
+    /* *pos runs over the slots of all shards in turn */
+    size_t base = 0;
+    for (size_t s = 0; s < t->nshards; s++) {
+	const struct oh_shard *sh = &t->shards[s];
+	for (size_t p = (*pos > base) ? *pos - base : 0; p < sh->cap; p++) {
+	    if (sh->ctrl[p] < 0)
+		continue;
+	    const struct oh_slot *e = &sh->slots[p];
+	    if (key)
+		*key = e->key;
+	    if (key_len)
+		*key_len = e->key ? (size_t)e->klen : 0;
+	    if (ikey)
+		*ikey = e->key ? 0 : e->klen;
+	    if (val)
+		*val = e->val;
+	    *pos = base + p + 1;
+	    return 1;
+	}
+	base += sh->cap;
+    }
+    *pos = base;
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C++
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -133,7 +133,8 @@ int BU_SEM_THREAD = BU_SEM_ID_THREAD;
 
 typedef enum {
     PARALLEL_GET = 0,
-    PARALLEL_PUT = 1
+    PARALLEL_PUT = 1,
+    PARALLEL_CLAIM = 2	/* GET a given id, or NULL if it's taken */
 } parallel_action_t;
 
 
@@ -428,6 +429,18 @@ parallel_mapping(parallel_action_t action, int id, size_t max)
 	    }
 	    break;
 
+	case PARALLEL_CLAIM:
+	    if (id > 0 && id < MAX_PSW*MAX_PSW && mapping[id].id == 0) {
+		mapping[id].id = id;
+		mapping[id].started = 0;
+		mapping[id].finished = 0;
+		mapping[id].parent = bu_parallel_id();
+		if (mapping[id].lim == 0 && max > 0)
+		    mapping[id].lim = max;
+		result = &mapping[id];
+	    }
+	    break;
+
 	case PARALLEL_PUT:
 	    mapping[id].started = mapping[id].finished = mapping[id].lim = mapping[id].parent = 0;
 	    mapping[id].id = 0;
@@ -526,10 +539,104 @@ parallel_interface_arg_stub(struct thread_data *user_thread_data)
 }
 #endif
 
+/* One bu_parallel() call running on the thread pool */
+struct parallel_pool_call {
+    void (*func)(int, void *);
+    void *arg;
+    size_t ncpu;
+};
+
+
+/* The ID each pool worker (by deque slot) had in its last task.  Only
+ * a worker touches its own entry. */
+static int pool_last_id[MAX_PSW];
+
+
+static void
+parallel_pool_task(void *data)
+{
+    struct parallel_pool_call *call = (struct parallel_pool_call *)data;
+    int prev_id = bu_parallel_id();
+    size_t slot = parallel_pool_slot();
+    struct parallel_info *info = NULL;
+    int id;
+
+    /* Hand a worker back the ID it had last time if it's free, so
+     * per-cpu state that callers index by ID, and that was allocated
+     * by this thread on its NUMA node, keeps being used by it. */
+    if (slot > 0 && slot < MAX_PSW && pool_last_id[slot] > 0 && (size_t)pool_last_id[slot] <= call->ncpu)
+	info = parallel_mapping(PARALLEL_CLAIM, pool_last_id[slot], call->ncpu);
+    if (!info)
+	info = parallel_mapping(PARALLEL_GET, -1, call->ncpu);
+    id = info->id;
+    if (slot > 0 && slot < MAX_PSW)
+	pool_last_id[slot] = id;
+
+    /* Pool threads run tasks of many calls, and a waiting caller runs
+     * its own, so the ID is only ours for the duration of the task. */
+    thread_set_cpu(id);
+    (*call->func)(id, call->arg);
+    thread_set_cpu(prev_id);
+
+    parallel_mapping(PARALLEL_PUT, id, 0);
+}
+
+
+static void
+parallel_pool_run(void (*func)(int, void *), size_t ncpu, void *arg)
+{
+    struct parallel_pool_call call;
+    struct bu_task_group *group;
+    int throttle = 0;
+
+    if (ncpu < 1) {
+	/* inherit the limit of the enclosing bu_parallel() call, if any */
+	struct parallel_info *parent = NULL;
+
+	if (bu_parallel_id() > 0) {
+	    parent = parallel_mapping(PARALLEL_GET, bu_parallel_id(), 0);
+	    while (parent->lim == 0 && parent->id > 0)
+		parent = parallel_mapping(PARALLEL_GET, parent->parent, 0);
+	}
+	ncpu = (parent && parent->lim) ? parent->lim : bu_avail_cpus();
+	throttle = (parent != NULL);
+    }
+
+    if (ncpu == 1) {
+	(*func)(0, arg);
+	return;
+    }
+
+    call.func = func;
+    call.arg = arg;
+    call.ncpu = ncpu;
+
+    group = bu_task_group_create();
+    parallel_pool_spawn(group, parallel_pool_task, &call, ncpu, !throttle);
+    bu_task_group_destroy(group);
+
+    if (UNLIKELY(bu_debug & BU_DEBUG_PARALLEL))
+	bu_log("bu_parallel(%zd) complete on the thread pool\n", ncpu);
+}
+
 #endif /* !HAVE_THREAD_LOCAL || !CPP11THREAD */
 #endif /* PARALLEL */
 
 
+/* Whether bu_parallel() runs on the thread pool, see bu_parallel_pool() */
+static int parallel_use_pool = 1;
+
+
+int
+bu_parallel_pool(int enable)
+{
+    int prev = parallel_use_pool;
+
+    parallel_use_pool = (enable != 0);
+    return prev;
+}
+
+
 void
 bu_parallel(void (*func)(int, void *), size_t ncpu, void *arg)
 {
@@ -603,6 +710,11 @@ bu_parallel(void (*func)(int, void *), size_t ncpu, void *arg)
 	    bu_log("CPU affinity disabled.\n");
     }
 
+    if (parallel_use_pool) {
+	parallel_pool_run(func, ncpu, arg);
+	return;
+    }
+
     /*
      * Threads not created by bu_parallel() all have ID zero.  Give each
      * top-level invocation its own parent context instead of making unrelated
@@ -39,9 +39,23 @@ __BEGIN_DECLS
 
 extern int parallel_set_affinity(int cpu);
 
+/* Bind the calling thread to the CPUs of NUMA node 'node' and make it
+ * bu_numa_node()'s answer for this thread (numa.cpp).  0 on success. */
+extern int parallel_set_node_affinity(int node);
+
 extern void thread_set_cpu(int cpu);
 extern int thread_get_cpu(void);
 
+/* Queue ntasks copies of func(data) in group on the thread pool.  If
+ * concurrent is set, first start enough workers for all of them to
+ * run at once (parallel_pool.cpp). */
+struct bu_task_group;
+extern void parallel_pool_spawn(struct bu_task_group *group, void (*func)(void *), void *data, size_t ntasks, int concurrent);
+
+/* Deque slot of the calling thread: 1..n for pool workers, 0 for any
+ * other thread. */
+extern size_t parallel_pool_slot(void);
+
 __END_DECLS
 
 #endif /* LIBBU_PARALLEL_H */
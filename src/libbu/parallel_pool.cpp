@@ -0,0 +1,465 @@
+/*                 P A R A L L E L _ P O O L . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file parallel_pool.cpp
+ *
+ * The persistent libbu thread pool behind bu_task_spawn(),
+ * bu_parallel_for() and bu_parallel().
+ *
+ * Worker threads are started on demand and then live for the rest of
+ * the process, sleeping when there is nothing to do.  Every worker has
+ * its own task deque: tasks it spawns go on the back and it pops them
+ * from the back, while idle workers steal from the front of the
+ * others.  Threads outside the pool share deque 0.
+ *
+ * On NUMA machines the workers are bound round-robin to the nodes
+ * (numa.cpp).
+ *
+ * A thread waiting on a task group runs that group's queued tasks
+ * itself instead of sleeping, so nested waits always make progress
+ * and a wait with no workers at all (single CPU, or no PARALLEL
+ * support) still completes.  It does not pick up other groups' tasks,
+ * so a wait never ends up underneath unrelated, possibly blocking,
+ * work.
+ */
+
+#include "common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <stdlib.h>
+
+#ifdef HAVE_PTHREAD_H
+#  include <pthread.h>
+#endif
+
+#include "bu/log.h"
+#include "bu/parallel.h"
+
+#include "./parallel.h"
+
+
+struct bu_task_group {
+    std::atomic<size_t> pending{0};
+};
+
+
+struct pool_task {
+    void (*func)(void *);
+    void *data;
+    struct bu_task_group *group;
+};
+
+
+struct pool_queue {
+    std::mutex lock;
+    std::deque<struct pool_task> tasks;
+};
+
+
+struct thread_pool {
+    /* guards sleeping, waking and worker creation */
+    std::mutex lock;
+    std::condition_variable work;     /* idle workers sleep here */
+    std::condition_variable progress; /* bu_task_wait() sleeps here */
+
+    /* bumped (under lock) by every push and every finished group */
+    size_t epoch = 0;
+    size_t nwaiting = 0;
+
+    std::atomic<size_t> nworkers{0};
+    std::atomic<size_t> nbusy{0};   /* workers running a task */
+    std::atomic<size_t> nqueued{0}; /* tasks waiting in a deque */
+
+    /* [0] is shared by threads outside the pool, [1..nworkers] are
+     * the workers' own */
+    std::atomic<struct pool_queue *> queues[MAX_PSW];
+};
+
+
+/* deque slot of the calling thread, 0 outside the pool */
+static thread_local size_t pool_slot = 0;
+
+
+static struct thread_pool *
+pool_get(void)
+{
+    /* Never freed: workers may still be asleep on it at exit. */
+    static struct thread_pool *pool = []() {
+	struct thread_pool *p = new struct thread_pool;
+	for (size_t i = 0; i < MAX_PSW; i++)
+	    p->queues[i].store(NULL, std::memory_order_relaxed);
+	p->queues[0].store(new struct pool_queue, std::memory_order_release);
+	return p;
+    }();
+
+    return pool;
+}
+
+
+/* Take a task from deque q: from the back if it is our own, otherwise
+ * from the front.  If group is set only that group's tasks qualify. */
+static bool
+pool_take_from(struct pool_queue *q, bool own, struct bu_task_group *group, struct pool_task *task)
+{
+    std::lock_guard<std::mutex> guard(q->lock);
+
+    if (q->tasks.empty())
+	return false;
+
+    if (own) {
+	for (std::deque<struct pool_task>::reverse_iterator it = q->tasks.rbegin(); it != q->tasks.rend(); ++it) {
+	    if (group && it->group != group)
+		continue;
+	    *task = *it;
+	    q->tasks.erase(std::next(it).base());
+	    return true;
+	}
+    } else {
+	for (std::deque<struct pool_task>::iterator it = q->tasks.begin(); it != q->tasks.end(); ++it) {
+	    if (group && it->group != group)
+		continue;
+	    *task = *it;
+	    q->tasks.erase(it);
+	    return true;
+	}
+    }
+
+    return false;
+}
+
+
+static bool
+pool_take(struct thread_pool *pool, bool worker, struct bu_task_group *group, struct pool_task *task)
+{
+    size_t nqueues = pool->nworkers.load(std::memory_order_acquire) + 1;
+
+    for (size_t i = 0; i < nqueues; i++) {
+	size_t slot = (pool_slot + i) % nqueues;
+	struct pool_queue *q = pool->queues[slot].load(std::memory_order_acquire);
+	if (!q || !pool_take_from(q, i == 0 && pool_slot != 0, group, task))
+	    continue;
+
+	/* count ourselves busy before the task leaves the queue count,
+	 * so nbusy + nqueued never under-reports */
+	if (worker)
+	    pool->nbusy.fetch_add(1, std::memory_order_acq_rel);
+	pool->nqueued.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+    }
+
+    return false;
+}
+
+
+static void
+pool_run(struct thread_pool *pool, struct pool_task *task)
+{
+    (*task->func)(task->data);
+
+    /* The waiter may free the group as soon as pending hits zero, so it
+     * isn't touched after the decrement. */
+    if (task->group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+	std::lock_guard<std::mutex> guard(pool->lock);
+	pool->epoch++;
+	if (pool->nwaiting)
+	    pool->progress.notify_all();
+    }
+}
+
+
+static void
+pool_worker(size_t slot)
+{
+    struct thread_pool *pool = pool_get();
+    struct pool_task task;
+    const char *affinity = getenv("LIBBU_AFFINITY");
+
+    pool_slot = slot;
+    if (affinity && strtol(affinity, NULL, 0x10)) {
+	if (parallel_set_affinity((int)slot))
+	    bu_log("WARNING: encountered unexpected problem setting CPU affinity\n");
+    } else if (bu_numa_nodes() > 1) {
+	/* round-robin over the nodes, counting the threads outside the
+	 * pool as slot 0 */
+	if (parallel_set_node_affinity((int)(slot % bu_numa_nodes())))
+	    bu_log("WARNING: could not bind thread pool worker %zu to a NUMA node\n", slot);
+    }
+
+    while (1) {
+	if (pool_take(pool, true, NULL, &task)) {
+	    pool_run(pool, &task);
+	    pool->nbusy.fetch_sub(1, std::memory_order_acq_rel);
+	    continue;
+	}
+
+	std::unique_lock<std::mutex> guard(pool->lock);
+	pool->work.wait(guard, [pool]() {
+	    return pool->nqueued.load(std::memory_order_acquire) > 0;
+	});
+    }
+}
+
+
+#ifdef HAVE_PTHREAD_H
+static void *
+pool_worker_pthread(void *slot)
+{
+    pool_worker((size_t)slot);
+    return NULL;
+}
+#endif
+
+
+/* Start workers until there are n of them.  Called with pool->lock held. */
+static void
+pool_grow(struct thread_pool *pool, size_t n)
+{
+#ifdef PARALLEL
+    if (n > MAX_PSW - 1)
+	n = MAX_PSW - 1;
+
+    while (pool->nworkers.load(std::memory_order_acquire) < n) {
+	size_t slot = pool->nworkers.load(std::memory_order_acquire) + 1;
+
+	if (!pool->queues[slot].load(std::memory_order_acquire))
+	    pool->queues[slot].store(new struct pool_queue, std::memory_order_release);
+
+#  ifdef HAVE_PTHREAD_H
+	/* the same generous stack bu_parallel() always gave its threads */
+	pthread_t thread;
+	pthread_attr_t attrs;
+	int ret;
+	pthread_attr_init(&attrs);
+	pthread_attr_setstacksize(&attrs, 10*1024*1024);
+	pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+	ret = pthread_create(&thread, &attrs, pool_worker_pthread, (void *)slot);
+	pthread_attr_destroy(&attrs);
+	if (ret) {
+	    bu_log("ERROR: libbu thread pool could not start worker %zu (%d)\n", slot, ret);
+	    return;
+	}
+#  else
+	try {
+	    std::thread(pool_worker, slot).detach();
+	} catch (...) {
+	    bu_log("ERROR: libbu thread pool could not start worker %zu\n", slot);
+	    return;
+	}
+#  endif
+	pool->nworkers.store(slot, std::memory_order_release);
+    }
+#else
+    (void)pool;
+    (void)n;
+#endif
+}
+
+
+/* Queue ntasks copies of a task on the calling thread's deque.  With
+ * concurrent set, first start enough workers that every one of them
+ * but the one the caller will run itself can start right away. */
+static void
+pool_push(struct bu_task_group *group, void (*func)(void *), void *data, size_t ntasks, bool concurrent)
+{
+    struct thread_pool *pool = pool_get();
+    std::lock_guard<std::mutex> guard(pool->lock);
+
+    if (concurrent) {
+	size_t needed = pool->nbusy.load(std::memory_order_acquire)
+	    + pool->nqueued.load(std::memory_order_acquire) + ntasks - 1;
+	pool_grow(pool, needed);
+    } else if (!pool->nworkers.load(std::memory_order_acquire)) {
+	pool_grow(pool, bu_avail_cpus() - 1);
+    }
+
+    struct pool_queue *q = pool->queues[pool_slot].load(std::memory_order_acquire);
+    group->pending.fetch_add(ntasks, std::memory_order_acq_rel);
+    {
+	std::lock_guard<std::mutex> qguard(q->lock);
+	for (size_t i = 0; i < ntasks; i++)
+	    q->tasks.push_back({func, data, group});
+    }
+    pool->nqueued.fetch_add(ntasks, std::memory_order_acq_rel);
+    pool->epoch++;
+
+    if (ntasks == 1)
+	pool->work.notify_one();
+    else
+	pool->work.notify_all();
+
+    /* waiters look for tasks of their own group, which nested tasks
+     * may have spawned */
+    if (pool->nwaiting)
+	pool->progress.notify_all();
+}
+
+
+extern "C" void
+parallel_pool_spawn(struct bu_task_group *group, void (*func)(void *), void *data, size_t ntasks, int concurrent)
+{
+    if (!group || !func || !ntasks)
+	return;
+    pool_push(group, func, data, ntasks, concurrent != 0);
+}
+
+
+extern "C" size_t
+parallel_pool_slot(void)
+{
+    return pool_slot;
+}
+
+
+extern "C" struct bu_task_group *
+bu_task_group_create(void)
+{
+    return new struct bu_task_group;
+}
+
+
+extern "C" void
+bu_task_spawn(struct bu_task_group *group, void (*func)(void *data), void *data)
+{
+    if (!group || !func)
+	return;
+    pool_push(group, func, data, 1, false);
+}
+
+
+extern "C" void
+bu_task_wait(struct bu_task_group *group)
+{
+    struct thread_pool *pool = pool_get();
+    struct pool_task task;
+
+    if (!group)
+	return;
+
+    while (group->pending.load(std::memory_order_acquire) > 0) {
+	size_t epoch;
+
+	{
+	    std::lock_guard<std::mutex> guard(pool->lock);
+	    epoch = pool->epoch;
+	}
+
+	if (pool_take(pool, false, group, &task)) {
+	    pool_run(pool, &task);
+	    continue;
+	}
+
+	/* Nothing of ours is queued; sleep until something is pushed
+	 * or a group finishes, then look again. */
+	std::unique_lock<std::mutex> guard(pool->lock);
+	pool->nwaiting++;
+	pool->progress.wait(guard, [pool, group, epoch]() {
+	    return pool->epoch != epoch || group->pending.load(std::memory_order_acquire) == 0;
+	});
+	pool->nwaiting--;
+    }
+}
+
+
+extern "C" void
+bu_task_group_destroy(struct bu_task_group *group)
+{
+    if (!group)
+	return;
+    bu_task_wait(group);
+    delete group;
+}
+
+
+struct parallel_for_job {
+    void (*func)(size_t, size_t, void *);
+    void *data;
+    size_t end;
+    size_t chunk;
+    std::atomic<size_t> next;
+};
+
+
+static void
+parallel_for_task(void *data)
+{
+    struct parallel_for_job *job = (struct parallel_for_job *)data;
+
+    while (1) {
+	size_t start = job->next.fetch_add(job->chunk, std::memory_order_relaxed);
+	if (start >= job->end)
+	    break;
+	size_t stop = (job->end - start > job->chunk) ? start + job->chunk : job->end;
+	(*job->func)(start, stop, job->data);
+    }
+}
+
+
+/* Hand out this many chunks per thread by default so uneven chunks
+ * balance out. */
+#define PARALLEL_FOR_CHUNKS_PER_CPU 8
+
+
+extern "C" void
+bu_parallel_for(size_t begin, size_t end, size_t chunk, void (*func)(size_t start, size_t end, void *data), void *data)
+{
+    struct parallel_for_job job;
+    struct bu_task_group group;
+    size_t ncpu, nchunks, ntasks;
+
+    if (!func || begin >= end)
+	return;
+
+    ncpu = bu_avail_cpus();
+    if (ncpu > MAX_PSW)
+	ncpu = MAX_PSW;
+    if (!chunk) {
+	chunk = (end - begin) / (ncpu * PARALLEL_FOR_CHUNKS_PER_CPU);
+	if (chunk < 1)
+	    chunk = 1;
+    }
+
+    nchunks = (end - begin) / chunk + (((end - begin) % chunk) ? 1 : 0);
+    ntasks = (nchunks < ncpu) ? nchunks : ncpu;
+
+    job.func = func;
+    job.data = data;
+    job.end = end;
+    job.chunk = chunk;
+    job.next.store(begin, std::memory_order_relaxed);
+
+    /* the caller's own share is the last task, run right here */
+    if (ntasks > 1)
+	pool_push(&group, parallel_for_task, &job, ntasks - 1, false);
+    parallel_for_task(&job);
+    bu_task_wait(&group);
+}
+
+
+// Local Variables:
+// tab-width: 8
+// mode: C++
+// c-basic-offset: 4
+// indent-tabs-mode: t
+// c-file-style: "stroustrup"
+// End:
+// ex: shiftwidth=4 tabstop=8
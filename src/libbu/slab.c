@@ -0,0 +1,266 @@
+/*                          S L A B . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+
+#include "common.h"
+
+#include <string.h>
+
+#include "bu/malloc.h"
+
+
+/**
+ * Objects are aligned to this many bytes, enough for any of the
+ * scalar and vector types the libraries put in small structures.
+ */
+#define SLAB_ALIGN 16
+
+/** Default chunk size when the caller doesn't pick a count */
+#define SLAB_CHUNK_BYTES (64 * 1024)
+
+
+struct bu_slab {
+    size_t objsize;
+    size_t nper;		/* objects per chunk */
+
+    uint8_t **chunks;
+    size_t nchunks;
+    size_t maxchunks;
+
+    /* Slots are handed out in order: chunk cur, starting at next.
+     * bump counts them across chunks.  Every slot below constructed
+     * has had the constructor run on it. */
+    size_t cur;
+    uint8_t *next;
+    uint8_t *end;
+    size_t bump;
+    size_t constructed;
+
+    /* returned objects, most recent last */
+    void **free;
+    size_t nfree;
+
+    bu_slab_obj_t ctor;
+    bu_slab_obj_t dtor;
+    void *data;
+
+    size_t live;
+    size_t peak;
+    size_t gets;
+    size_t puts;
+};
+
+
+struct bu_slab *
+bu_slab_create(size_t objsize, size_t nper, bu_slab_obj_t ctor, bu_slab_obj_t dtor, void *data)
+{
+    struct bu_slab *slab;
+
+    if (objsize == 0)
+	objsize = 1;
+    objsize = (objsize + SLAB_ALIGN - 1) & ~((size_t)SLAB_ALIGN - 1);
+    if (nper == 0)
+	nper = SLAB_CHUNK_BYTES / objsize;
+    if (nper == 0)
+	nper = 1;
+
+    slab = (struct bu_slab *)bu_calloc(1, sizeof(struct bu_slab), "bu_slab");
+    slab->objsize = objsize;
+    slab->nper = nper;
+    slab->ctor = ctor;
+    slab->dtor = dtor;
+    slab->data = data;
+    return slab;
+}
+
+
+/* Run the destructor on the constructed slots of chunks [first, nchunks)
+ * and free them. */
+static void
+slab_release(struct bu_slab *slab, size_t first)
+{
+    size_t i;
+
+    for (i = first; i < slab->nchunks; i++) {
+	if (slab->dtor) {
+	    size_t base = i * slab->nper;
+	    size_t n = 0;
+	    size_t j;
+	    if (slab->constructed > base)
+		n = slab->constructed - base;
+	    if (n > slab->nper)
+		n = slab->nper;
+	    for (j = 0; j < n; j++)
+		slab->dtor(slab->chunks[i] + j * slab->objsize, slab->data);
+	}
+	bu_free(slab->chunks[i], "bu_slab chunk");
+	slab->chunks[i] = NULL;
+    }
+    if (first < slab->nchunks) {
+	slab->nchunks = first;
+	if (slab->constructed > first * slab->nper)
+	    slab->constructed = first * slab->nper;
+    }
+}
+
+
+void
+bu_slab_destroy(struct bu_slab *slab)
+{
+    if (!slab)
+	return;
+
+    slab_release(slab, 0);
+    if (slab->chunks)
+	bu_free(slab->chunks, "bu_slab chunks");
+    if (slab->free)
+	bu_free(slab->free, "bu_slab free stack");
+    bu_free(slab, "bu_slab");
+}
+
+
+/* Move the bump pointer to the next chunk, allocating it if needed */
+static void
+slab_next_chunk(struct bu_slab *slab)
+{
+    if (slab->next)
+	slab->cur++;
+
+    if (slab->cur >= slab->nchunks) {
+	if (slab->nchunks == slab->maxchunks) {
+	    slab->maxchunks = slab->maxchunks ? slab->maxchunks * 2 : 8;
+	    slab->chunks = (uint8_t **)bu_realloc(slab->chunks, slab->maxchunks * sizeof(uint8_t *), "bu_slab chunks");
+	}
+	slab->chunks[slab->nchunks++] = (uint8_t *)bu_malloc(slab->nper * slab->objsize, "bu_slab chunk");
+
+	/* the free stack can never hold more than every slot */
+	slab->free = (void **)bu_realloc(slab->free, slab->nchunks * slab->nper * sizeof(void *), "bu_slab free stack");
+    }
+
+    slab->next = slab->chunks[slab->cur];
+    slab->end = slab->next + slab->nper * slab->objsize;
+}
+
+
+void *
+bu_slab_get(struct bu_slab *slab)
+{
+    void *obj;
+
+    if (slab->nfree) {
+	obj = slab->free[--slab->nfree];
+    } else {
+	if (slab->next == slab->end)
+	    slab_next_chunk(slab);
+	obj = slab->next;
+	slab->next += slab->objsize;
+	if (slab->bump++ >= slab->constructed) {
+	    slab->constructed++;
+	    if (slab->ctor)
+		slab->ctor(obj, slab->data);
+	}
+    }
+
+    slab->gets++;
+    if (++slab->live > slab->peak)
+	slab->peak = slab->live;
+    return obj;
+}
+
+
+void
+bu_slab_put(struct bu_slab *slab, void *obj)
+{
+    if (!obj)
+	return;
+
+    slab->free[slab->nfree++] = obj;
+    slab->puts++;
+    if (slab->live)
+	slab->live--;
+}
+
+
+void
+bu_slab_reset(struct bu_slab *slab)
+{
+    if (!slab)
+	return;
+
+    slab->cur = 0;
+    slab->next = slab->end = NULL;
+    slab->bump = 0;
+    slab->nfree = 0;
+    slab->live = 0;
+}
+
+
+size_t
+bu_slab_trim(struct bu_slab *slab)
+{
+    size_t keep;
+    size_t before;
+
+    if (!slab)
+	return 0;
+
+    if (!slab->live)
+	bu_slab_reset(slab);
+
+    /* chunks in use by the bump pointer, or needed for the peak */
+    keep = (slab->peak + slab->nper - 1) / slab->nper;
+    if (slab->next && slab->cur + 1 > keep)
+	keep = slab->cur + 1;
+
+    before = slab->nchunks;
+    slab_release(slab, keep);
+    slab->peak = slab->live;
+
+    return (before - slab->nchunks) * slab->nper * slab->objsize;
+}
+
+
+void
+bu_slab_stats(struct bu_slab *slab, struct bu_slab_stats *stats, int clear)
+{
+    if (!slab || !stats)
+	return;
+
+    stats->objsize = slab->objsize;
+    stats->chunks = slab->nchunks;
+    stats->bytes = slab->nchunks * slab->nper * slab->objsize;
+    stats->live = slab->live;
+    stats->peak = slab->peak;
+    stats->gets = slab->gets;
+    stats->puts = slab->puts;
+
+    if (clear)
+	slab->gets = slab->puts = 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
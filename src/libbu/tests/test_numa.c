@@ -0,0 +1,184 @@
+/*                     T E S T _ N U M A . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file test_numa.c
+ *
+ * Tests the NUMA placement routines: bu_numa_run() visits every node
+ * once on a thread bound to it, pool workers report a node in range,
+ * and reports how many bu_parallel() CPU ids stayed on the same
+ * thread from one call to the next.  -n makes bu_numa_set_nodes()
+ * pretend the machine has that many nodes.
+ *
+ * Usage: test_numa [-n nodes] [-P cpus]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu.h"
+
+
+struct numa_visit {
+    int seen[MAX_PSW];
+    int bad;
+};
+
+struct numa_ids {
+    int thread[MAX_PSW];
+    int node[MAX_PSW];
+};
+
+
+static int
+numa_check(int ok, const char *what)
+{
+    bu_log("%s [%s]\n", what, ok ? "PASS" : "FAIL");
+    return !ok;
+}
+
+
+static void
+numa_visit_node(int node, void *data)
+{
+    struct numa_visit *v = (struct numa_visit *)data;
+    int *touch;
+
+    /* what a per-node copy would do: allocate and fill it here */
+    touch = (int *)bu_malloc(4096 * sizeof(int), "numa touch");
+    memset(touch, node, 4096 * sizeof(int));
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    if (node < 0 || node >= MAX_PSW || bu_numa_node() != node)
+	v->bad++;
+    else
+	v->seen[node]++;
+    bu_semaphore_release(BU_SEM_GENERAL);
+
+    bu_free(touch, "numa touch");
+}
+
+
+static void
+numa_record(int cpu, void *data)
+{
+    struct numa_ids *ids = (struct numa_ids *)data;
+
+    /* long enough that every invocation gets its own worker */
+    bu_snooze(BU_SEC2USEC(0.01));
+    if (cpu >= 0 && cpu < MAX_PSW) {
+	ids->thread[cpu] = bu_thread_id();
+	ids->node[cpu] = bu_numa_node();
+    }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n nodes] [-P cpus]\n";
+    struct numa_visit visit;
+    struct numa_ids *first, *second;
+    size_t want = 0;
+    size_t ncpu = 0;
+    size_t nodes, i, same = 0, ran = 0;
+    int failed = 0;
+    int c;
+
+    if (bu_getprogname()[0] == '\0')
+	bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:P:")) != -1) {
+	switch (c) {
+	    case 'n':
+		want = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'P':
+		ncpu = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (ncpu == 0 || ncpu > MAX_PSW)
+	ncpu = bu_avail_cpus();
+    if (ncpu < 2)
+	ncpu = 2;
+
+    /* must be set before anything in libbu reads the topology */
+    if (want && bu_numa_set_nodes(want) < 0) {
+	bu_log("bu_numa_set_nodes(%zu) refused before first use [FAIL]\n", want);
+	return 1;
+    }
+
+    nodes = bu_numa_nodes();
+    bu_log("%zu NUMA node(s)\n", nodes);
+#ifdef __linux__
+    if (want > 1)
+	failed += numa_check(nodes == want, "bu_numa_set_nodes sets the node count");
+#endif
+    failed += numa_check(nodes >= 1 && nodes < MAX_PSW, "node count in range");
+    failed += numa_check(bu_numa_node() >= 0 && (size_t)bu_numa_node() < nodes, "calling thread's node in range");
+
+    memset(&visit, 0, sizeof(visit));
+    bu_numa_run(numa_visit_node, &visit);
+    {
+	int ok = !visit.bad;
+	for (i = 0; i < nodes && ok; i++) {
+	    if (visit.seen[i] != 1)
+		ok = 0;
+	}
+	failed += numa_check(ok, "bu_numa_run visits each node once, bound to it");
+    }
+
+    first = (struct numa_ids *)bu_calloc(1, sizeof(struct numa_ids), "numa ids");
+    second = (struct numa_ids *)bu_calloc(1, sizeof(struct numa_ids), "numa ids");
+    bu_parallel(numa_record, ncpu, first);
+    bu_parallel(numa_record, ncpu, second);
+    {
+	int ok = 1;
+	for (i = 0; i < MAX_PSW; i++) {
+	    if (!first->thread[i])
+		continue;
+	    if (first->node[i] < 0 || (size_t)first->node[i] >= nodes)
+		ok = 0;
+	    ran++;
+	    if (first->thread[i] == second->thread[i])
+		same++;
+	}
+	failed += numa_check(ok && ran == ncpu, "bu_parallel threads report a node in range");
+    }
+    bu_log("%zu of %zu CPU ids ran on the same thread in both calls\n", same, ran);
+
+    bu_free(first, "numa ids");
+    bu_free(second, "numa ids");
+    return failed;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
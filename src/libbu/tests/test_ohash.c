@@ -0,0 +1,303 @@
+/*                   T E S T _ O H A S H . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file test_ohash.c
+ *
+ * Tests the bu_ohash open addressing table: string and integer keys in
+ * one table, removal churn, iteration, borrowed keys and concurrent
+ * readers and writers, then times lookups against bu_hash.
+ *
+ * Usage: test_ohash [-n keys] [-P cpus]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu.h"
+
+
+#define OHASH_VAL(i) ((void *)(uintptr_t)((i) + 1))
+
+
+struct ohash_par {
+    bu_ohash *t;
+    char **names;
+    size_t n;
+    size_t next;	/* work counter, under BU_SEM_GENERAL */
+    size_t bad;
+};
+
+
+static int
+ohash_check(int ok, const char *what)
+{
+    bu_log("%s [%s]\n", what, ok ? "PASS" : "FAIL");
+    return !ok;
+}
+
+
+/* Each thread looks up the names in its share and adds integer keys
+ * for them, so reads run alongside writes to the same shards. */
+static void
+ohash_reader(int UNUSED(cpu), void *data)
+{
+    struct ohash_par *p = (struct ohash_par *)data;
+    size_t bad = 0;
+
+    while (1) {
+	size_t i, end;
+	bu_semaphore_acquire(BU_SEM_GENERAL);
+	i = p->next;
+	p->next += 1024;
+	bu_semaphore_release(BU_SEM_GENERAL);
+	if (i >= p->n)
+	    break;
+	end = (i + 1024 < p->n) ? i + 1024 : p->n;
+	for (; i < end; i++) {
+	    if (bu_ohash_get(p->t, (const uint8_t *)p->names[i], strlen(p->names[i])) != OHASH_VAL(i))
+		bad++;
+	    if (bu_ohash_set_int(p->t, (uint64_t)i, OHASH_VAL(i)) != 1)
+		bad++;
+	}
+    }
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    p->bad += bad;
+    bu_semaphore_release(BU_SEM_GENERAL);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n keys] [-P cpus]\n";
+    size_t nkeys = 100000;
+    size_t ncpu = 0;
+    char **names;
+    bu_ohash *t;
+    size_t i;
+    int failed = 0;
+    int c;
+
+    if (bu_getprogname()[0] == '\0')
+	bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:P:")) != -1) {
+	switch (c) {
+	    case 'n':
+		nkeys = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'P':
+		ncpu = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (nkeys < 1000)
+	nkeys = 1000;
+    if (ncpu == 0 || ncpu > MAX_PSW)
+	ncpu = bu_avail_cpus();
+
+    /* names shaped like database object names */
+    names = (char **)bu_calloc(nkeys, sizeof(char *), "names");
+    for (i = 0; i < nkeys; i++) {
+	struct bu_vls v = BU_VLS_INIT_ZERO;
+	bu_vls_sprintf(&v, "%s%zu.%c", (i % 3) ? "part_" : "r", i, (i % 2) ? 's' : 'r');
+	names[i] = bu_vls_strdup(&v);
+	bu_vls_free(&v);
+    }
+
+    /* start small so the table has to grow several times */
+    t = bu_ohash_create(0, 0);
+    for (i = 0; i < nkeys; i++) {
+	if (bu_ohash_set(t, (const uint8_t *)names[i], strlen(names[i]), OHASH_VAL(i)) != 1)
+	    break;
+	if (bu_ohash_set_int(t, (uint64_t)i, OHASH_VAL(i + nkeys)) != 1)
+	    break;
+    }
+    {
+	int ok = (i == nkeys && bu_ohash_count(t) == 2 * nkeys);
+	for (i = 0; i < nkeys && ok; i++) {
+	    if (bu_ohash_get(t, (const uint8_t *)names[i], strlen(names[i])) != OHASH_VAL(i)
+		|| bu_ohash_get_int(t, (uint64_t)i) != OHASH_VAL(i + nkeys))
+		ok = 0;
+	}
+	ok = ok && !bu_ohash_get(t, (const uint8_t *)"missing", 7) && !bu_ohash_get_int(t, (uint64_t)nkeys);
+	ok = ok && bu_ohash_set(t, (const uint8_t *)names[0], strlen(names[0]), OHASH_VAL(0)) == 0;
+	ok = ok && bu_ohash_set(t, (const uint8_t *)"null", 4, NULL) == -1;
+	failed += ohash_check(ok, "string and integer keys in one table");
+    }
+
+    /* remove and re-add in waves, leaving tombstones everywhere */
+    {
+	int ok = 1;
+	size_t round;
+	for (round = 0; round < 4 && ok; round++) {
+	    for (i = round; i < nkeys; i += 4) {
+		if (bu_ohash_rm(t, (const uint8_t *)names[i], strlen(names[i])) != 1 || bu_ohash_rm_int(t, (uint64_t)i) != 1)
+		    ok = 0;
+	    }
+	    for (i = 0; i < nkeys && ok; i++) {
+		void *want = (i % 4 == round) ? NULL : OHASH_VAL(i);
+		if (bu_ohash_get(t, (const uint8_t *)names[i], strlen(names[i])) != want)
+		    ok = 0;
+	    }
+	    for (i = round; i < nkeys; i += 4) {
+		bu_ohash_set(t, (const uint8_t *)names[i], strlen(names[i]), OHASH_VAL(i));
+		bu_ohash_set_int(t, (uint64_t)i, OHASH_VAL(i + nkeys));
+	    }
+	}
+	ok = ok && bu_ohash_count(t) == 2 * nkeys && bu_ohash_rm(t, (const uint8_t *)"missing", 7) == 0;
+	failed += ohash_check(ok, "removal churn");
+    }
+
+    /* every entry comes out of the iteration exactly once */
+    {
+	size_t pos = 0, nstr = 0, nint = 0;
+	uint64_t isum = 0;
+	const uint8_t *key;
+	size_t klen;
+	uint64_t ikey;
+	void *val;
+	while (bu_ohash_next(t, &pos, &key, &klen, &ikey, &val)) {
+	    if (key) {
+		nstr++;
+	    } else {
+		nint++;
+		isum += ikey;
+	    }
+	}
+	failed += ohash_check(nstr == nkeys && nint == nkeys && isum == (uint64_t)nkeys * (nkeys - 1) / 2,
+			      "iteration visits every entry once");
+    }
+
+    bu_ohash_clear(t);
+    failed += ohash_check(bu_ohash_count(t) == 0 && !bu_ohash_get(t, (const uint8_t *)names[1], strlen(names[1])),
+			  "clear empties the table");
+    bu_ohash_destroy(t);
+
+    /* borrowed keys are compared in place */
+    t = bu_ohash_create(nkeys, BU_OHASH_BORROW_KEYS);
+    for (i = 0; i < nkeys; i++)
+	bu_ohash_set(t, (const uint8_t *)names[i], strlen(names[i]), names[i]);
+    {
+	size_t pos = 0;
+	const uint8_t *key;
+	void *val;
+	int ok = 1;
+	while (bu_ohash_next(t, &pos, &key, NULL, NULL, &val)) {
+	    if ((const void *)key != val)
+		ok = 0;
+	}
+	failed += ohash_check(ok, "borrowed keys are not copied");
+    }
+    bu_ohash_destroy(t);
+
+    /* concurrent readers and writers */
+    {
+	struct ohash_par p;
+	t = bu_ohash_create(nkeys, BU_OHASH_CONCURRENT);
+	for (i = 0; i < nkeys; i++)
+	    bu_ohash_set(t, (const uint8_t *)names[i], strlen(names[i]), OHASH_VAL(i));
+	p.t = t;
+	p.names = names;
+	p.n = nkeys;
+	p.next = 0;
+	p.bad = 0;
+	bu_parallel(ohash_reader, ncpu, &p);
+	for (i = 0; i < nkeys; i++) {
+	    if (bu_ohash_get_int(t, (uint64_t)i) != OHASH_VAL(i))
+		p.bad++;
+	}
+	failed += ohash_check(p.bad == 0, "concurrent readers and writers");
+	bu_ohash_destroy(t);
+    }
+
+    /* Lookup timing against bu_hash: string keys, then integer keys
+     * (bu_hash takes the integer's bytes as the key) */
+    {
+	bu_hash_tbl *h = bu_hash_create(nkeys);
+	int64_t start;
+	double t_oh, t_h, t_ohi, t_hi;
+	size_t round, hits = 0;
+
+	t = bu_ohash_create(nkeys, 0);
+	for (i = 0; i < nkeys; i++) {
+	    uint64_t k = (uint64_t)i * 2654435761ULL;
+	    bu_ohash_set(t, (const uint8_t *)names[i], strlen(names[i]), OHASH_VAL(i));
+	    bu_ohash_set_int(t, k, OHASH_VAL(i));
+	    bu_hash_set(h, (const uint8_t *)names[i], strlen(names[i]), OHASH_VAL(i));
+	    bu_hash_set(h, (const uint8_t *)&k, sizeof(k), OHASH_VAL(i));
+	}
+
+	start = bu_gettime();
+	for (round = 0; round < 10; round++)
+	    for (i = 0; i < nkeys; i++)
+		hits += (bu_ohash_get(t, (const uint8_t *)names[i], strlen(names[i])) != NULL);
+	t_oh = (double)(bu_gettime() - start) / 1.0e6;
+
+	start = bu_gettime();
+	for (round = 0; round < 10; round++)
+	    for (i = 0; i < nkeys; i++)
+		hits += (bu_hash_get(h, (const uint8_t *)names[i], strlen(names[i])) != NULL);
+	t_h = (double)(bu_gettime() - start) / 1.0e6;
+
+	start = bu_gettime();
+	for (round = 0; round < 10; round++)
+	    for (i = 0; i < nkeys; i++)
+		hits += (bu_ohash_get_int(t, (uint64_t)i * 2654435761ULL) != NULL);
+	t_ohi = (double)(bu_gettime() - start) / 1.0e6;
+
+	start = bu_gettime();
+	for (round = 0; round < 10; round++) {
+	    for (i = 0; i < nkeys; i++) {
+		uint64_t k = (uint64_t)i * 2654435761ULL;
+		hits += (bu_hash_get(h, (const uint8_t *)&k, sizeof(k)) != NULL);
+	    }
+	}
+	t_hi = (double)(bu_gettime() - start) / 1.0e6;
+
+	failed += ohash_check(hits == 40 * nkeys, "benchmark lookups all hit");
+	bu_log("%zu string lookups: bu_ohash %.4f sec, bu_hash %.4f sec\n", 10 * nkeys, t_oh, t_h);
+	bu_log("%zu integer lookups: bu_ohash %.4f sec, bu_hash %.4f sec\n", 10 * nkeys, t_ohi, t_hi);
+
+	bu_hash_destroy(h);
+	bu_ohash_destroy(t);
+    }
+
+    for (i = 0; i < nkeys; i++)
+	bu_free(names[i], "name");
+    bu_free(names, "names");
+
+    return failed;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
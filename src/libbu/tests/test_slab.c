@@ -0,0 +1,217 @@
+/*                    T E S T _ S L A B . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file test_slab.c
+ *
+ * Tests the bu_slab allocator: constructed state surviving reuse,
+ * reset, high-water trimming and the statistics, and times a
+ * get/put workload against bu_malloc()/bu_free().
+ *
+ * Usage: test_slab [-n objects]
+ */
+
+#include "common.h"
+
+#include <string.h>
+
+#include "bu.h"
+
+
+struct slab_obj {
+    uint32_t magic;
+    size_t serial;
+    struct bu_ptbl tbl;
+};
+
+#define SLAB_OBJ_MAGIC 0x51ab0b1e
+
+struct slab_counts {
+    size_t ctor;
+    size_t dtor;
+};
+
+
+static void
+slab_obj_ctor(void *obj, void *data)
+{
+    struct slab_obj *o = (struct slab_obj *)obj;
+    struct slab_counts *c = (struct slab_counts *)data;
+
+    o->magic = SLAB_OBJ_MAGIC;
+    o->serial = c->ctor++;
+    bu_ptbl_init(&o->tbl, 8, "slab_obj tbl");
+}
+
+
+static void
+slab_obj_dtor(void *obj, void *data)
+{
+    struct slab_obj *o = (struct slab_obj *)obj;
+    struct slab_counts *c = (struct slab_counts *)data;
+
+    if (o->magic != SLAB_OBJ_MAGIC)
+	bu_exit(1, "destructor called on an unconstructed object [FAIL]\n");
+    bu_ptbl_free(&o->tbl);
+    o->magic = 0;
+    c->dtor++;
+}
+
+
+static int
+slab_check(int ok, const char *what)
+{
+    bu_log("%s [%s]\n", what, ok ? "PASS" : "FAIL");
+    return !ok;
+}
+
+
+/* Seconds to do rounds of n gets followed by n puts */
+static double
+slab_time(struct bu_slab *slab, void **objs, size_t n, size_t rounds)
+{
+    int64_t start = bu_gettime();
+    size_t r, i;
+
+    for (r = 0; r < rounds; r++) {
+	for (i = 0; i < n; i++) {
+	    objs[i] = slab ? bu_slab_get(slab) : bu_malloc(sizeof(struct slab_obj), "slab_obj");
+	    ((struct slab_obj *)objs[i])->serial = i;
+	}
+	for (i = n; i > 0; i--) {
+	    if (slab)
+		bu_slab_put(slab, objs[i-1]);
+	    else
+		bu_free(objs[i-1], "slab_obj");
+	}
+    }
+
+    return (double)(bu_gettime() - start) / 1.0e6;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n objects]\n";
+    struct slab_counts counts = {0, 0};
+    struct bu_slab_stats st;
+    struct bu_slab *slab;
+    struct slab_obj *a, *b;
+    size_t nobj = 10000;
+    size_t i;
+    void **objs;
+    double t_slab, t_malloc;
+    int failed = 0;
+    int c;
+
+    if (bu_getprogname()[0] == '\0')
+	bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		nobj = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (nobj < 100)
+	nobj = 100;
+    objs = (void **)bu_calloc(nobj, sizeof(void *), "slab objs");
+
+    slab = bu_slab_create(sizeof(struct slab_obj), 32, slab_obj_ctor, slab_obj_dtor, &counts);
+
+    /* a returned object comes back first, still constructed */
+    a = (struct slab_obj *)bu_slab_get(slab);
+    bu_ptbl_ins(&a->tbl, (long *)a);
+    bu_slab_put(slab, a);
+    b = (struct slab_obj *)bu_slab_get(slab);
+    failed += slab_check(a == b && counts.ctor == 1 && BU_PTBL_LEN(&b->tbl) == 1,
+			 "returned object reused with its contents");
+    bu_ptbl_reset(&b->tbl);
+    bu_slab_put(slab, b);
+
+    /* objects are distinct and aligned */
+    for (i = 0; i < nobj; i++)
+	objs[i] = bu_slab_get(slab);
+    {
+	int ok = (counts.ctor == nobj);
+	for (i = 0; i < nobj && ok; i++) {
+	    struct slab_obj *o = (struct slab_obj *)objs[i];
+	    if (((uintptr_t)o & 15) || o->magic != SLAB_OBJ_MAGIC)
+		ok = 0;
+	    o->serial = i;
+	}
+	for (i = 0; i < nobj && ok; i++) {
+	    if (((struct slab_obj *)objs[i])->serial != i)
+		ok = 0;
+	}
+	failed += slab_check(ok, "objects distinct, aligned and constructed once");
+    }
+
+    bu_slab_stats(slab, &st, 1);
+    failed += slab_check(st.live == nobj && st.peak == nobj && st.gets == nobj + 2 && st.puts == 2,
+			 "statistics count gets, puts and the peak");
+
+    /* a trim with objects outstanding must not release any of them */
+    (void)bu_slab_trim(slab);
+    failed += slab_check(counts.dtor == 0, "trim keeps chunks in use");
+
+    /* reset returns everything; the next round reuses constructed
+     * slots.  The trim closes the period whose peak was nobj. */
+    bu_slab_reset(slab);
+    (void)bu_slab_trim(slab);
+    for (i = 0; i < nobj / 10; i++)
+	objs[i] = bu_slab_get(slab);
+    failed += slab_check(counts.ctor == nobj, "reset reuses constructed objects");
+    for (i = 0; i < nobj / 10; i++)
+	bu_slab_put(slab, objs[i]);
+
+    /* the last peak was a tenth of the first; trimming with nothing
+     * live should give back most of the chunks */
+    (void)bu_slab_trim(slab);
+    bu_slab_stats(slab, &st, 0);
+    failed += slab_check(st.chunks == (nobj / 10 + 31) / 32 && counts.dtor == nobj - st.chunks * 32,
+			 "trim shrinks to the high-water mark");
+
+    bu_slab_destroy(slab);
+    failed += slab_check(counts.ctor == counts.dtor, "destroy runs every destructor");
+
+    /* timing, with no constructor so only the allocation is measured */
+    slab = bu_slab_create(sizeof(struct slab_obj), 0, NULL, NULL, NULL);
+    t_slab = slab_time(slab, objs, nobj, 100);
+    t_malloc = slab_time(NULL, objs, nobj, 100);
+    bu_slab_destroy(slab);
+    bu_log("%zu x %zu get/put: slab %.4f sec, bu_malloc %.4f sec\n", (size_t)100, nobj, t_slab, t_malloc);
+
+    bu_free(objs, "slab objs");
+    return failed;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,234 @@
+/*                    T E S T _ T A S K . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file test_task.c
+ *
+ * Tests the libbu thread pool task routines, and times repeated
+ * bu_parallel() calls on the pool against bu_parallel_pool(0).
+ *
+ * Usage: test_task [-P ncpu] [-n calls]
+ */
+
+#include "common.h"
+
+#include <string.h>
+
+#include "bu.h"
+
+
+#define TASK_RANGE 100003
+
+
+struct task_range_data {
+    unsigned char *seen;
+    size_t calls;
+    size_t nested;
+};
+
+
+static void
+task_range_mark(size_t start, size_t end, void *data)
+{
+    struct task_range_data *d = (struct task_range_data *)data;
+    size_t i;
+
+    for (i = start; i < end; i++)
+	d->seen[i]++;
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    d->calls++;
+    bu_semaphore_release(BU_SEM_GENERAL);
+}
+
+
+/* Marks [start, end) through a nested bu_parallel_for() */
+static void
+task_range_nested(size_t start, size_t end, void *data)
+{
+    struct task_range_data *d = (struct task_range_data *)data;
+
+    bu_parallel_for(start, end, 3, task_range_mark, d);
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    d->nested++;
+    bu_semaphore_release(BU_SEM_GENERAL);
+}
+
+
+static int
+task_check_range(const char *what, size_t chunk, void (*func)(size_t, size_t, void *))
+{
+    struct task_range_data d;
+    size_t i;
+
+    d.seen = (unsigned char *)bu_calloc(TASK_RANGE, 1, "task seen");
+    d.calls = d.nested = 0;
+
+    bu_parallel_for(7, TASK_RANGE, chunk, func, &d);
+
+    for (i = 0; i < TASK_RANGE; i++) {
+	if (d.seen[i] != (i >= 7 ? 1 : 0)) {
+	    bu_log("%s: index %zu visited %d times [FAIL]\n", what, i, d.seen[i]);
+	    bu_free(d.seen, "task seen");
+	    return 1;
+	}
+    }
+    if (chunk && func == task_range_mark && d.calls != (TASK_RANGE - 7 + chunk - 1) / chunk) {
+	bu_log("%s: %zu ranges for chunk %zu [FAIL]\n", what, d.calls, chunk);
+	bu_free(d.seen, "task seen");
+	return 1;
+    }
+
+    bu_free(d.seen, "task seen");
+    bu_log("%s [PASS]\n", what);
+    return 0;
+}
+
+
+struct task_tree {
+    int depth;
+    size_t *count;
+};
+
+
+/* Each node spawns two children until depth runs out, waiting on
+ * them from inside a task. */
+static void
+task_tree_node(void *data)
+{
+    struct task_tree *node = (struct task_tree *)data;
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    (*node->count)++;
+    bu_semaphore_release(BU_SEM_GENERAL);
+
+    if (node->depth > 0) {
+	struct bu_task_group *group = bu_task_group_create();
+	struct task_tree left, right;
+	left.depth = right.depth = node->depth - 1;
+	left.count = right.count = node->count;
+	bu_task_spawn(group, task_tree_node, &left);
+	bu_task_spawn(group, task_tree_node, &right);
+	bu_task_group_destroy(group);
+    }
+}
+
+
+static void
+task_noop(int UNUSED(cpu), void *data)
+{
+    size_t *calls = (size_t *)data;
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    (*calls)++;
+    bu_semaphore_release(BU_SEM_GENERAL);
+}
+
+
+/* Seconds taken by n back to back bu_parallel() calls */
+static double
+task_time_parallel(size_t ncpu, size_t n, size_t *calls)
+{
+    int64_t start = bu_gettime();
+    size_t i;
+
+    for (i = 0; i < n; i++)
+	bu_parallel(task_noop, ncpu, calls);
+
+    return (double)(bu_gettime() - start) / 1.0e6;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-P ncpu] [-n calls]\n";
+    size_t ncpu = bu_avail_cpus();
+    size_t ncalls = 200;
+    size_t calls = 0;
+    size_t count = 0;
+    struct task_tree root;
+    double t_pool, t_threads;
+    int c;
+
+    if (bu_getprogname()[0] == '\0')
+	bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "P:n:")) != -1) {
+	switch (c) {
+	    case 'P':
+		ncpu = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'n':
+		ncalls = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (ncpu < 2)
+	ncpu = 2;
+    if (ncpu >= MAX_PSW)
+	ncpu = MAX_PSW - 1;
+
+    if (task_check_range("bu_parallel_for automatic chunks", 0, task_range_mark)
+	|| task_check_range("bu_parallel_for chunk 1", 1, task_range_mark)
+	|| task_check_range("bu_parallel_for chunk 1000", 1000, task_range_mark)
+	|| task_check_range("bu_parallel_for chunk larger than range", 2 * TASK_RANGE, task_range_mark)
+	|| task_check_range("nested bu_parallel_for", 101, task_range_nested))
+	return 1;
+
+    root.depth = 10;
+    root.count = &count;
+    {
+	struct bu_task_group *group = bu_task_group_create();
+	bu_task_spawn(group, task_tree_node, &root);
+	bu_task_wait(group);
+	bu_task_group_destroy(group);
+    }
+    if (count != (1 << 11) - 1) {
+	bu_log("nested task groups ran %zu of %d tasks [FAIL]\n", count, (1 << 11) - 1);
+	return 1;
+    }
+    bu_log("nested task groups [PASS]\n");
+
+    t_pool = task_time_parallel(ncpu, ncalls, &calls);
+    (void)bu_parallel_pool(0);
+    t_threads = task_time_parallel(ncpu, ncalls, &calls);
+    (void)bu_parallel_pool(1);
+    if (calls != 2 * ncpu * ncalls) {
+	bu_log("bu_parallel made %zu of %zu calls [FAIL]\n", calls, 2 * ncpu * ncalls);
+	return 1;
+    }
+    bu_log("%zu bu_parallel(%zu) calls: pool %.4f sec, thread per call %.4f sec [PASS]\n",
+	   ncalls, ncpu, t_pool, t_threads);
+
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -482,7 +482,7 @@ ged_concat_core(struct ged *gedp, int argc, const char *argv[])
 	copy_object(gedp, dp, &cc_data);
     } FOR_ALL_DIRECTORY_END;
 
-    rt_mempurge(&(cc_data.incoming_dbip->i->dbi_freep));
+    db_freemap_clear(cc_data.incoming_dbip->i->dbi_freemap);
 
     /* Free all the directory entries, and close the incoming database */
     db_close(cc_data.incoming_dbip);
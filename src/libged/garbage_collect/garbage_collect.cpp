@@ -42,7 +42,7 @@
 
 void print_help_msg(struct bu_vls *str)
 {
-    bu_vls_printf(str, "Usage: garbage_collect [-c|--confirm] [-h|--help]\n");
+    bu_vls_printf(str, "Usage: garbage_collect [-c|--confirm] [-i|--in-place] [-h|--help]\n");
     bu_vls_printf(str, "\n");
     bu_vls_printf(str, "garbage_collect reclaims any available free space in the currently\n");
     bu_vls_printf(str, "open geometry database file.  As objects are deleted and created,\n");
@@ -53,6 +53,10 @@ void print_help_msg(struct bu_vls *str)
     bu_vls_printf(str, "verifying that all objects were successfully saved, will replace\n");
     bu_vls_printf(str, "the currently open geometry database with the new file.\n");
     bu_vls_printf(str, "\n");
+    bu_vls_printf(str, "With -i, objects are instead moved down over the free space within\n");
+    bu_vls_printf(str, "the open file and the file is truncated, without a second copy of\n");
+    bu_vls_printf(str, "the database and without closing it.\n");
+    bu_vls_printf(str, "\n");
     bu_vls_printf(str, "DUE TO THE POTENTIAL FOR DATA CORRUPTION, PLEASE MANUALLY BACK UP\n");
     bu_vls_printf(str, "YOUR GEOMETRY FILE BEFORE RUNNING 'garbage_collect'.\n");
 }
@@ -63,6 +67,7 @@ ged_garbage_collect_core(struct ged *gedp, int argc, const char *argv[])
     const char *av[10] = {NULL};
     fastf_t fs_percent = 0.0;
     int confirmed = 0;
+    int in_place = 0;
     int new_file_size = 0;
     int old_file_size = 0;
     int path_cnt = 0;
@@ -90,10 +95,11 @@ ged_garbage_collect_core(struct ged *gedp, int argc, const char *argv[])
     std::ifstream cfile;
     std::ofstream ofile;
 
-    struct bu_opt_desc d[3];
+    struct bu_opt_desc d[4];
     BU_OPT(d[0], "h", "help",      "",             NULL,        &print_help,   "Print help and exit");
     BU_OPT(d[1], "c", "confirm",   "",             NULL,        &confirmed,    "Execute garbage collect operation");
-    BU_OPT_NULL(d[2]);
+    BU_OPT(d[2], "i", "in-place",  "",             NULL,        &in_place,     "Compact the open database file in place");
+    BU_OPT_NULL(d[3]);
 
     GED_CHECK_DATABASE_OPEN(gedp, BRLCAD_ERROR);
     GED_CHECK_READ_ONLY(gedp, BRLCAD_ERROR);
@@ -122,10 +128,26 @@ ged_garbage_collect_core(struct ged *gedp, int argc, const char *argv[])
     }
 
     if (!confirmed || opt_ret) {
-	bu_vls_printf(gedp->ged_result_str, "Usage: garbage_collect [-c|--confirm] [-h|--help]");
+	bu_vls_printf(gedp->ged_result_str, "Usage: garbage_collect [-c|--confirm] [-i|--in-place] [-h|--help]");
 	return BRLCAD_ERROR;
     }
 
+    if (in_place) {
+	size_t reclaimed = 0;
+	old_file_size = bu_file_size(gedp->dbip->dbi_filename);
+	if (db_compact(gedp->dbip, &reclaimed) < 0) {
+	    bu_vls_printf(gedp->ged_result_str, "ERROR: unable to compact %s in place.\n", gedp->dbip->dbi_filename);
+	    return BRLCAD_ERROR;
+	}
+	if (!reclaimed) {
+	    bu_vls_printf(gedp->ged_result_str, "Database size did NOT change.\n");
+	    return BRLCAD_OK;
+	}
+	fs_percent = (fastf_t)reclaimed/(fastf_t)old_file_size * 100;
+	bu_vls_printf(gedp->ged_result_str, "Reduced by %zu bytes (%g%% savings)\n", reclaimed, fs_percent);
+	return BRLCAD_OK;
+    }
+
     /* See if we have a stale backup file */
     bu_path_component(&fdir, gedp->dbip->dbi_filename, BU_PATH_DIRNAME);
     bu_path_component(&fname, gedp->dbip->dbi_filename, BU_PATH_BASENAME);
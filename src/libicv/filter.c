@@ -24,6 +24,11 @@
  * images are taken care.
  */
 
+#include "common.h"
+
+#include <math.h>
+#include <string.h>
+
 #include "bu/log.h"
 #include "bu/malloc.h"
 #include "icv_private.h"
@@ -302,17 +307,109 @@ clamped_index(ptrdiff_t coord, size_t limit)
     return (size_t)coord;
 }
 
+
+/* Upper bound on the taps of one output sample: three temporal planes
+ * of a KERN_DEFAULT x KERN_DEFAULT kernel. */
+#define KERN_MAX_TAPS (3*KERN_DEFAULT*KERN_DEFAULT)
+
+
+/* State shared by the row workers of a convolution.  Kernels are laid
+ * out plane-major, k_dim x k_dim per plane. */
+struct conv_job {
+    const double *planes[3];
+    size_t nplanes;
+    double *out;
+    size_t width;
+    size_t height;
+    size_t channels;
+    size_t k_dim;
+    const double *kern;
+    double offset;
+};
+
+
+/* Evaluate one output pixel with border clamping. */
+static void
+conv_pixel_clamped(const struct conv_job *job, size_t y, size_t x)
+{
+    size_t c, ky, kx, p;
+    size_t k2 = job->k_dim * job->k_dim;
+    ptrdiff_t r = (ptrdiff_t)(job->k_dim / 2);
+
+    for (c = 0; c < job->channels; c++) {
+	double c_val = 0.0;
+	for (ky = 0; ky < job->k_dim; ky++) {
+	    size_t sy = clamped_index((ptrdiff_t)y + (ptrdiff_t)ky - r, job->height);
+	    for (kx = 0; kx < job->k_dim; kx++) {
+		size_t sx = clamped_index((ptrdiff_t)x + (ptrdiff_t)kx - r, job->width);
+		size_t pidx = (sy * job->width + sx) * job->channels + c;
+		for (p = 0; p < job->nplanes; p++)
+		    c_val += job->kern[p * k2 + ky * job->k_dim + kx] * job->planes[p][pidx];
+	    }
+	}
+	job->out[(y * job->width + x) * job->channels + c] = c_val + job->offset;
+    }
+}
+
+
+/* Full 2D convolution of rows [y_start, y_end).  Border columns are
+ * clamped per pixel; the interior of each row is one contiguous run of
+ * samples accumulated tap by tap without any index clamping. */
+static void
+conv_rows_2d(size_t y_start, size_t y_end, void *data)
+{
+    const struct conv_job *job = (const struct conv_job *)data;
+    const double *srcs[KERN_MAX_TAPS];
+    double weights[KERN_MAX_TAPS];
+    size_t k2 = job->k_dim * job->k_dim;
+    size_t r = job->k_dim / 2;
+    size_t rowstep = job->width * job->channels;
+    size_t y, x, ky, kx, p;
+
+    for (y = y_start; y < y_end; y++) {
+	size_t ntaps = 0;
+
+	if (job->width <= 2 * r) {
+	    for (x = 0; x < job->width; x++)
+		conv_pixel_clamped(job, y, x);
+	    continue;
+	}
+
+	for (x = 0; x < r; x++) {
+	    conv_pixel_clamped(job, y, x);
+	    conv_pixel_clamped(job, y, job->width - 1 - x);
+	}
+
+	for (ky = 0; ky < job->k_dim; ky++) {
+	    size_t sy = clamped_index((ptrdiff_t)y + (ptrdiff_t)ky - (ptrdiff_t)r, job->height);
+	    for (kx = 0; kx < job->k_dim; kx++) {
+		for (p = 0; p < job->nplanes; p++) {
+		    double w = job->kern[p * k2 + ky * job->k_dim + kx];
+		    if (ZERO(w))
+			continue;
+		    weights[ntaps] = w;
+		    srcs[ntaps] = job->planes[p] + sy * rowstep + kx * job->channels;
+		    ntaps++;
+		}
+	    }
+	}
+	icv_taps_accumulate(job->out + y * rowstep + r * job->channels, srcs, weights, ntaps,
+			    (job->width - 2 * r) * job->channels, job->offset);
+    }
+}
+
+
 /* begin public functions */
 
 int
 icv_filter(icv_image_t *img, ICV_FILTER filter_type)
 {
+    struct conv_job job;
     double *kern = NULL;
-    double *out_data, *in_data;
+    double *out_data;
     double offset = 0;
     size_t k_dim = KERN_DEFAULT;
     size_t size;
-    size_t y, x, c, ky, kx;
 
     /* TODO A new Functionality. Update the get_kernel function to
      * accommodate the generalized kernel length. This can be based
@@ -330,7 +427,6 @@ icv_filter(icv_image_t *img, ICV_FILTER filter_type)
     if (!kern)
 	return -1;
 
-    in_data = img->data;
     size = img->height*img->width*img->channels;
 
     if (size == 0) {
@@ -349,22 +445,19 @@ icv_filter(icv_image_t *img, ICV_FILTER filter_type)
      * valid edge pixel.  This avoids scalar row-wrap artifacts and keeps
      * normalized kernels, such as boxcar and low-pass, normalized on image
      * borders and on images smaller than the kernel. */
-    for (y = 0; y < img->height; y++) {
-	for (x = 0; x < img->width; x++) {
-	    for (c = 0; c < img->channels; c++) {
-		double c_val = 0.0;
-		for (ky = 0; ky < k_dim; ky++) {
-		    size_t sy = clamped_index((ptrdiff_t)y + (ptrdiff_t)ky - (ptrdiff_t)(k_dim / 2), img->height);
-		    for (kx = 0; kx < k_dim; kx++) {
-			size_t sx = clamped_index((ptrdiff_t)x + (ptrdiff_t)kx - (ptrdiff_t)(k_dim / 2), img->width);
-			size_t in_idx = (sy * img->width + sx) * img->channels + c;
-			c_val += kern[ky * k_dim + kx] * in_data[in_idx];
-		    }
-		}
-		out_data[(y * img->width + x) * img->channels + c] = c_val + offset;
-	    }
-	}
-    }
+    memset(&job, 0, sizeof(job));
+    job.planes[0] = img->data;
+    job.nplanes = 1;
+    job.out = out_data;
+    job.width = img->width;
+    job.height = img->height;
+    job.channels = img->channels;
+    job.k_dim = k_dim;
+    job.kern = kern;
+    job.offset = offset;
+
+    icv_rows_parallel(img->height, img->width * img->channels * k_dim * k_dim, conv_rows_2d, &job);
+
     bu_free(kern, "icv_filter : Kernel Allocation");
     icv_image_data_free(img, "icv:filter Input Image Data");
     icv_image_data_set_bu(img, out_data);
@@ -374,14 +467,12 @@ icv_filter(icv_image_t *img, ICV_FILTER filter_type)
 icv_image_t *
 icv_filter3(icv_image_t *old_img, icv_image_t *curr_img, icv_image_t *new_img, ICV_FILTER3 filter_type)
 {
+    struct conv_job job;
     icv_image_t *out_img;
     double *kern = NULL;
-    double *out_data;
-    double *old_data, *curr_data, *new_data;
     double offset = 0;
     size_t k_dim = KERN_DEFAULT;
     size_t size;
-    size_t y, x, c, ky, kx;
 
     ICV_IMAGE_VAL_PTR(old_img);
     ICV_IMAGE_VAL_PTR(curr_img);
@@ -407,10 +498,6 @@ icv_filter3(icv_image_t *old_img, icv_image_t *curr_img, icv_image_t *new_img, I
     if (!kern)
 	return NULL;
 
-    old_data = old_img->data;
-    curr_data = curr_img->data;
-    new_data = new_img->data;
-
     size = old_img->height*old_img->width*old_img->channels;
     if (size == 0) {
 	bu_free(kern, "icv_filter3 : Kernel Allocation");
@@ -423,39 +510,55 @@ icv_filter3(icv_image_t *old_img, icv_image_t *curr_img, icv_image_t *new_img, I
 	return NULL;
     }
 
-    out_data = out_img->data;
-
     /* Temporal filtering uses the same edge policy as icv_filter for each
      * frame.  Kernels are laid out as old/current/new 3x3 planes. */
-    for (y = 0; y < curr_img->height; y++) {
-	for (x = 0; x < curr_img->width; x++) {
-	    for (c = 0; c < curr_img->channels; c++) {
-		double c_val = 0.0;
-		for (ky = 0; ky < k_dim; ky++) {
-		    size_t sy = clamped_index((ptrdiff_t)y + (ptrdiff_t)ky - (ptrdiff_t)(k_dim / 2), curr_img->height);
-		    for (kx = 0; kx < k_dim; kx++) {
-			size_t sx = clamped_index((ptrdiff_t)x + (ptrdiff_t)kx - (ptrdiff_t)(k_dim / 2), curr_img->width);
-			size_t pidx = (sy * curr_img->width + sx) * curr_img->channels + c;
-			size_t kidx = ky * k_dim + kx;
-			c_val += kern[kidx] * old_data[pidx];
-			c_val += kern[k_dim * k_dim + kidx] * curr_data[pidx];
-			c_val += kern[2 * k_dim * k_dim + kidx] * new_data[pidx];
-		    }
-		}
-		out_data[(y * curr_img->width + x) * curr_img->channels + c] = c_val + offset;
-	    }
-	}
-    }
+    memset(&job, 0, sizeof(job));
+    job.planes[0] = old_img->data;
+    job.planes[1] = curr_img->data;
+    job.planes[2] = new_img->data;
+    job.nplanes = 3;
+    job.out = out_img->data;
+    job.width = curr_img->width;
+    job.height = curr_img->height;
+    job.channels = curr_img->channels;
+    job.k_dim = k_dim;
+    job.kern = kern;
+    job.offset = offset;
+
+    icv_rows_parallel(curr_img->height, curr_img->width * curr_img->channels * 3 * k_dim * k_dim, conv_rows_2d, &job);
+
     bu_free(kern, "icv_filter3 : Kernel Allocation");
     return out_img;
 }
 
 
+struct fade_job {
+    double *data;
+    size_t rowstep;
+    double fraction;
+};
+
+
+static void
+fade_rows(size_t y_start, size_t y_end, void *data)
+{
+    const struct fade_job *job = (const struct fade_job *)data;
+    double *p = job->data + y_start * job->rowstep;
+    size_t n = (y_end - y_start) * job->rowstep;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+	double v = p[i] * job->fraction;
+	p[i] = (v > 1.0) ? 1.0 : v;
+    }
+}
+
+
 int
 icv_fade(icv_image_t *img, double fraction)
 {
+    struct fade_job job;
     size_t size;
-    double *data;
 
     ICV_IMAGE_VAL_INT(img);
 
@@ -469,14 +572,11 @@ icv_fade(icv_image_t *img, double fraction)
 	return -1;
     }
 
-    data = img->data;
+    job.data = img->data;
+    job.rowstep = img->width*img->channels;
+    job.fraction = fraction;
+    icv_rows_parallel(img->height, job.rowstep, fade_rows, &job);
 
-    while (size--) {
-	*data = *data*fraction;
-	if (*data > 1)
-	    *data= 1.0;
-	data++;
-    }
     return 0;
 }
 /*
@@ -40,6 +40,24 @@ extern void icv_image_data_set_bu(icv_image_t *img, double *data);
 extern void icv_image_data_set_stdlib(icv_image_t *img, double *data);
 extern int icv_image_data_realloc(icv_image_t *img, size_t size, const char *label);
 
+/* defined in rows.c */
+
+/* Process rows [y_start, y_end) of an image operation */
+typedef void (*icv_rows_func_t)(size_t y_start, size_t y_end, void *data);
+
+/* Number of threads used for row-parallel operations */
+extern size_t icv_rows_ncpu(void);
+
+/* Run func over nrows rows, in parallel chunks when the image
+ * (nrows * row_elements doubles) is large enough to benefit.  func must
+ * only write rows in its own range. */
+extern void icv_rows_parallel(size_t nrows, size_t row_elements, icv_rows_func_t func, void *data);
+
+/* out[i] = offset + sum(weights[t] * src[t][i]) for i in [0, n), using
+ * SIMD lanes where available.  Tap order is the same for every lane so
+ * vector and scalar results are bitwise identical. */
+extern void icv_taps_accumulate(double *out, const double **src, const double *weights, size_t ntaps, size_t n, double offset);
+
 /* defined in bw.c */
 extern icv_image_t *bw_read(FILE *fp, size_t width, size_t height);
 extern icv_image_t *bw_read_mem(const unsigned char *buffer, size_t size, size_t width, size_t height);
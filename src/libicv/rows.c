@@ -0,0 +1,164 @@
+/*                          R O W S . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file libicv/rows.c
+ *
+ * Row-parallel execution and vectorized tap accumulation shared by the
+ * image filtering and resampling routines.
+ *
+ * Work is handed out in chunks of rows from a shared counter, so the
+ * row callbacks only ever write to their own output rows and need no
+ * further locking.
+ */
+
+#include "common.h"
+
+#if defined(__SSE2__) && defined(__GNUC__) && defined(HAVE_EMMINTRIN_H) && defined(HAVE_EMMINTRIN)
+#  include <emmintrin.h>
+#  define ICV_ROWS_SSE2 1
+#endif
+
+#include "bu/parallel.h"
+#include "icv_private.h"
+
+/* Images smaller than this many doubles are processed serially; below
+ * it, thread start-up costs more than the row work itself. */
+#define ICV_PARALLEL_MIN_ELEMENTS (1 << 18)
+
+/* Aim for this many row chunks per thread so uneven rows balance out. */
+#define ICV_CHUNKS_PER_CPU 8
+
+
+struct icv_rows_job {
+    icv_rows_func_t func;
+    void *data;
+    size_t nrows;
+    size_t chunk;
+    size_t next;
+};
+
+
+static void
+icv_rows_worker(int UNUSED(cpu), void *arg)
+{
+    struct icv_rows_job *job = (struct icv_rows_job *)arg;
+
+    while (1) {
+	size_t start, end;
+
+	bu_semaphore_acquire(BU_SEM_GENERAL);
+	start = job->next;
+	job->next += job->chunk;
+	bu_semaphore_release(BU_SEM_GENERAL);
+
+	if (start >= job->nrows)
+	    break;
+	end = (start + job->chunk > job->nrows) ? job->nrows : start + job->chunk;
+	job->func(start, end, job->data);
+    }
+}
+
+
+size_t
+icv_rows_ncpu(void)
+{
+    static size_t ncpu = 0;
+
+    if (ncpu)
+	return ncpu;
+
+    ncpu = bu_avail_cpus();
+    if (ncpu > MAX_PSW)
+	ncpu = MAX_PSW;
+    if (ncpu < 1)
+	ncpu = 1;
+
+    return ncpu;
+}
+
+
+void
+icv_rows_parallel(size_t nrows, size_t row_elements, icv_rows_func_t func, void *data)
+{
+    struct icv_rows_job job;
+    size_t ncpu;
+
+    if (!func || !nrows)
+	return;
+
+    ncpu = icv_rows_ncpu();
+    if (ncpu > nrows)
+	ncpu = nrows;
+
+    if (ncpu < 2 || nrows * row_elements < ICV_PARALLEL_MIN_ELEMENTS) {
+	func(0, nrows, data);
+	return;
+    }
+
+    job.func = func;
+    job.data = data;
+    job.nrows = nrows;
+    job.next = 0;
+    job.chunk = nrows / (ncpu * ICV_CHUNKS_PER_CPU);
+    if (job.chunk < 1)
+	job.chunk = 1;
+
+    bu_parallel(icv_rows_worker, ncpu, &job);
+}
+
+
+void
+icv_taps_accumulate(double *out, const double **src, const double *weights, size_t ntaps, size_t n, double offset)
+{
+    size_t i = 0;
+    size_t t;
+
+#ifdef ICV_ROWS_SSE2
+    __m128d voff = _mm_set1_pd(offset);
+    for (; i + 4 <= n; i += 4) {
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+	for (t = 0; t < ntaps; t++) {
+	    __m128d w = _mm_set1_pd(weights[t]);
+	    acc0 = _mm_add_pd(acc0, _mm_mul_pd(w, _mm_loadu_pd(src[t] + i)));
+	    acc1 = _mm_add_pd(acc1, _mm_mul_pd(w, _mm_loadu_pd(src[t] + i + 2)));
+	}
+	_mm_storeu_pd(out + i, _mm_add_pd(acc0, voff));
+	_mm_storeu_pd(out + i + 2, _mm_add_pd(acc1, voff));
+    }
+#endif
+
+    for (; i < n; i++) {
+	double acc = 0.0;
+	for (t = 0; t < ntaps; t++)
+	    acc += weights[t] * src[t][i];
+	out[i] = acc + offset;
+    }
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
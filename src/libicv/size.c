@@ -30,6 +30,7 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
 
 #include "icv.h"
@@ -293,14 +294,67 @@ icv_image_size(const char *name, size_t udpi, size_t file_size, bu_mime_image_t
     return      0;
 }
 
+/* State shared by the row workers of the resampling routines.  Output
+ * is always written to a separate buffer, so rows can be produced in
+ * any order. */
+struct resample_job {
+    const double *in;
+    double *out;
+    size_t in_width;
+    size_t in_height;
+    size_t out_width;
+    size_t out_height;
+    size_t channels;
+    size_t factor;
+
+    /* per-column source lookup for the interpolating methods */
+    size_t *x_low;
+    size_t *x_upp;
+    double *x_frac;
+};
+
+
+static void
+shrink_rows(size_t y_start, size_t y_end, void *data)
+{
+    const struct resample_job *job = (const struct resample_job *)data;
+    size_t in_step = job->in_width * job->channels;
+    size_t out_step = job->out_width * job->channels;
+    size_t blk = job->factor * job->channels;
+    double facsq = (double)(job->factor * job->factor);
+    size_t y, py, px, x, c, i;
+
+    for (y = y_start; y < y_end; y++) {
+	double *res_p = job->out + y * out_step;
+
+	for (i = 0; i < out_step; i++)
+	    res_p[i] = 0.0;
+
+	/* Sum each factor x factor block, one contiguous input row span
+	 * per py, accumulating straight into the output row. */
+	for (py = 0; py < job->factor; py++) {
+	    const double *data_p = job->in + (y * job->factor + py) * in_step;
+	    for (x = 0; x < job->out_width; x++) {
+		const double *blk_p = data_p + x * blk;
+		double *o = res_p + x * job->channels;
+		for (px = 0; px < job->factor; px++, blk_p += job->channels)
+		    for (c = 0; c < job->channels; c++)
+			o[c] += blk_p[c];
+	    }
+	}
+
+	for (i = 0; i < out_step; i++)
+	    res_p[i] /= facsq;
+    }
+}
+
+
 static int
 shrink_image(icv_image_t* bif, size_t factor)
 {
-    double *data_p, *res_p; /**< input and output pointers */
-    double *p;
-    size_t facsq, py, px;
-    size_t x, y, c;
-    size_t widthstep =  bif->width*bif->channels;
+    struct resample_job job;
+    double *out_data;
+
     if (UNLIKELY(factor < 1)) {
 	bu_log("Cannot shrink image to 0 factor, factor should be a positive value.");
 	return -1;
@@ -314,55 +368,56 @@ shrink_image(icv_image_t* bif, size_t factor)
 	return -1;
     }
 
-    facsq = factor*factor;
-    res_p = bif->data;
-    p = (double *)bu_malloc(bif->channels*sizeof(double), "shrink_image : Pixel Values Temp Buffer");
-
     size_t out_w = bif->width / factor;
     size_t out_h = bif->height / factor;
-    if (out_w == 0 || out_h == 0) {
-	bu_free(p, "shrink_image : Pixel Values Temp Buffer");
+    if (out_w == 0 || out_h == 0)
 	return -1;
-    }
 
-    for (y = 0; y < out_h * factor; y += factor)
-	for (x = 0; x < out_w * factor; x += factor) {
+    out_data = (double *)bu_malloc(out_w*out_h*bif->channels*sizeof(double), "shrink_image : out_data");
 
-	    for (c = 0; c < bif->channels; c++) {
-		p[c]= 0;
-	    }
+    memset(&job, 0, sizeof(job));
+    job.in = bif->data;
+    job.out = out_data;
+    job.in_width = bif->width;
+    job.in_height = bif->height;
+    job.out_width = out_w;
+    job.out_height = out_h;
+    job.channels = bif->channels;
+    job.factor = factor;
+    icv_rows_parallel(out_h, bif->width * bif->channels * factor, shrink_rows, &job);
 
-	    for (py = 0; py < factor; py++) {
-		data_p = bif->data + (y+py)*widthstep + x*bif->channels;
-		for (px = 0; px < factor; px++) {
-		    for (c = 0; c < bif->channels; c++) {
-			p[c] += *data_p++;
-		    }
-		}
-	    }
+    icv_image_data_free(bif, "shrink_image : in_data");
+    icv_image_data_set_bu(bif, out_data);
+    bif->width = out_w;
+    bif->height = out_h;
 
-	    for (c = 0; c < bif->channels; c++)
-		*res_p++ = p[c]/facsq;
-	}
+    return 0;
 
-    bif->width = (int)bif->width/factor;
-    bif->height = (int)bif->height/factor;
-    if (icv_image_data_realloc(bif, (size_t)(bif->width*bif->height*bif->channels)*sizeof(double), "shrink_image : Reallocation") != 0) {
-	bu_free(p, "shrink_image : Pixel Values Temp Buffer");
-	return -1;
-    }
-    bu_free(p, "shrink_image : Pixel Values Temp Buffer");
+}
 
-    return 0;
 
+static void
+under_sample_rows(size_t y_start, size_t y_end, void *data)
+{
+    const struct resample_job *job = (const struct resample_job *)data;
+    size_t in_step = job->in_width * job->channels;
+    size_t y, x;
+
+    for (y = y_start; y < y_end; y++) {
+	const double *data_p = job->in + y * job->factor * in_step;
+	double *res_p = job->out + y * job->out_width * job->channels;
+	for (x = 0; x < job->out_width;
+	     x++, res_p += job->channels, data_p += job->factor * job->channels)
+	    VMOVEN(res_p, data_p, job->channels);
+    }
 }
 
 
 static int
 under_sample(icv_image_t* bif, size_t factor)
 {
-    double *data_p, *res_p;
-    size_t x, y, widthstep;
+    struct resample_job job;
+    double *out_data;
 
     if (UNLIKELY(factor < 1)) {
 	bu_log("Cannot shrink image to 0 factor, factor should be a positive value.");
@@ -373,29 +428,33 @@ under_sample(icv_image_t* bif, size_t factor)
 	return -1;
     }
 
-    widthstep = bif->width*bif->channels;
-    res_p = bif->data;
-
     size_t out_w = bif->width / factor;
     size_t out_h = bif->height / factor;
     if (out_w == 0 || out_h == 0)
 	return -1;
 
-    for (y = 0; y < out_h * factor; y += factor) {
-	data_p = bif->data + widthstep*y;
-	for (x = 0; x < out_w * factor;
-	     x += factor, res_p += bif->channels, data_p += factor * bif->channels)
-	    VMOVEN(res_p, data_p, bif->channels);
-    }
+    out_data = (double *)bu_malloc(out_w*out_h*bif->channels*sizeof(double), "under_sample : out_data");
 
-    bif->width = (int)bif->width/factor;
-    bif->height = (int)bif->height/factor;
-    if (icv_image_data_realloc(bif, (size_t)(bif->width*bif->height*bif->channels)*sizeof(double), "under_sample : Reallocation") != 0)
-	return -1;
+    memset(&job, 0, sizeof(job));
+    job.in = bif->data;
+    job.out = out_data;
+    job.in_width = bif->width;
+    job.in_height = bif->height;
+    job.out_width = out_w;
+    job.out_height = out_h;
+    job.channels = bif->channels;
+    job.factor = factor;
+    icv_rows_parallel(out_h, out_w * bif->channels, under_sample_rows, &job);
+
+    icv_image_data_free(bif, "under_sample : in_data");
+    icv_image_data_set_bu(bif, out_data);
+    bif->width = out_w;
+    bif->height = out_h;
 
     return 0;
 }
 
+
 static int
 resize_output_valid(const icv_image_t *bif, size_t out_width, size_t out_height)
 {
@@ -418,40 +477,64 @@ mapped_coord(size_t out_index, size_t out_size, size_t in_size)
     return ((double)out_index * (double)(in_size - 1)) / (double)(out_size - 1);
 }
 
-static int
-ninterp(icv_image_t* bif, size_t out_width, size_t out_height)
+static void
+ninterp_rows(size_t y_start, size_t y_end, void *data)
 {
-    size_t i, j;
-    size_t x, y;
-    size_t widthstep;
-    double *in_r, *in_c; /* Pointer to row and col of input buffers */
-    double *out_data, *out_p;
+    const struct resample_job *job = (const struct resample_job *)data;
+    size_t widthstep = job->in_width * job->channels;
+    size_t i, j, y;
 
-    if (!resize_output_valid(bif, out_width, out_height))
-	return -1;
+    for (j = y_start; j < y_end; j++) {
+	double yc = mapped_coord(j, job->out_height, job->in_height);
+	const double *in_r;
+	double *out_p = job->out + j * job->out_width * job->channels;
 
-    out_p = out_data = (double *)bu_malloc(out_width*out_height*bif->channels*sizeof(double), "ninterp : out_data");
+	y = (size_t)(yc + 0.5);
+	if (y >= job->in_height) y = job->in_height - 1;
+	in_r = job->in + y*widthstep;
 
-    widthstep= bif->width*bif->channels;
+	for (i = 0; i < job->out_width; i++) {
+	    VMOVEN(out_p, in_r + job->x_low[i]*job->channels, job->channels);
+	    out_p += job->channels;
+	}
+    }
+}
 
-    for (j = 0; j < out_height; j++) {
-	double yc = mapped_coord(j, out_height, bif->height);
-	y = (size_t)(yc + 0.5);
-	if (y >= bif->height) y = bif->height - 1;
-	in_r = bif->data + y*widthstep;
 
-	for (i = 0; i < out_width; i++) {
-	    double xc = mapped_coord(i, out_width, bif->width);
-	    x = (size_t)(xc + 0.5);
-	    if (x >= bif->width) x = bif->width - 1;
+static int
+ninterp(icv_image_t* bif, size_t out_width, size_t out_height)
+{
+    struct resample_job job;
+    size_t i, x;
+    double *out_data;
 
-	    in_c = in_r + x*bif->channels;
+    if (!resize_output_valid(bif, out_width, out_height))
+	return -1;
 
-	    VMOVEN(out_p, in_c, bif->channels);
-	    out_p += bif->channels;
-	}
+    out_data = (double *)bu_malloc(out_width*out_height*bif->channels*sizeof(double), "ninterp : out_data");
+
+    memset(&job, 0, sizeof(job));
+    job.in = bif->data;
+    job.out = out_data;
+    job.in_width = bif->width;
+    job.in_height = bif->height;
+    job.out_width = out_width;
+    job.out_height = out_height;
+    job.channels = bif->channels;
+
+    /* column lookups are the same for every row, compute them once */
+    job.x_low = (size_t *)bu_malloc(out_width*sizeof(size_t), "ninterp : x_low");
+    for (i = 0; i < out_width; i++) {
+	double xc = mapped_coord(i, out_width, bif->width);
+	x = (size_t)(xc + 0.5);
+	if (x >= bif->width) x = bif->width - 1;
+	job.x_low[i] = x;
     }
 
+    icv_rows_parallel(out_height, out_width * bif->channels, ninterp_rows, &job);
+
+    bu_free(job.x_low, "ninterp : x_low");
+
     icv_image_data_free(bif, "ninterp : in_data");
     icv_image_data_set_bu(bif, out_data);
 
@@ -463,63 +546,86 @@ ninterp(icv_image_t* bif, size_t out_width, size_t out_height)
 }
 
 
-static int
-binterp(icv_image_t *bif, size_t out_width, size_t out_height)
+static void
+binterp_rows(size_t y_start, size_t y_end, void *data)
 {
-    size_t i, j;
-    size_t c;
-    double x, y, dx, dy, mid1, mid2;
-    double *out_data, *out_p;
-    double *upp_r, *low_r; /* upper and lower row */
-    double *upp_c, *low_c;
-    size_t widthstep;
-
-    if (!resize_output_valid(bif, out_width, out_height))
-	return -1;
-
-    out_p = out_data = (double *)bu_malloc(out_width*out_height*bif->channels*sizeof(double), "binterp : out data");
+    const struct resample_job *job = (const struct resample_job *)data;
+    size_t widthstep = job->in_width * job->channels;
+    size_t i, j, c;
 
-    widthstep = bif->width*bif->channels;
+    for (j = y_start; j < y_end; j++) {
+	double y, y_floor, dy;
+	const double *upp_r, *low_r; /* upper and lower row */
+	double *out_p = job->out + j * job->out_width * job->channels;
 
-    for (j = 0; j < out_height; j++) {
-	double y_floor;
-	y = mapped_coord(j, out_height, bif->height);
+	y = mapped_coord(j, job->out_height, job->in_height);
 	y_floor = floor(y);
 	dy = y - y_floor;
 
 	size_t y_low = (size_t)y_floor;
 	size_t y_upp = y_low + 1;
-	if (y_upp >= bif->height) y_upp = bif->height - 1;
-
-	low_r = bif->data + widthstep * y_low;
-	upp_r = bif->data + widthstep * y_upp;
+	if (y_upp >= job->in_height) y_upp = job->in_height - 1;
 
-	for (i = 0; i < out_width; i++) {
-	    double x_floor;
-	    x = mapped_coord(i, out_width, bif->width);
-	    x_floor = floor(x);
-	    dx = x - x_floor;
+	low_r = job->in + widthstep * y_low;
+	upp_r = job->in + widthstep * y_upp;
 
-	    size_t x_low = (size_t)x_floor;
-	    size_t x_upp = x_low + 1;
-	    if (x_upp >= bif->width) x_upp = bif->width - 1;
+	for (i = 0; i < job->out_width; i++) {
+	    double dx = job->x_frac[i];
+	    const double *upp_c = upp_r + job->x_low[i] * job->channels;
+	    const double *low_c = low_r + job->x_low[i] * job->channels;
+	    const double *upp_c_next = upp_r + job->x_upp[i] * job->channels;
+	    const double *low_c_next = low_r + job->x_upp[i] * job->channels;
 
-	    upp_c = upp_r + x_low * bif->channels;
-	    low_c = low_r + x_low * bif->channels;
-	    double *upp_c_next = upp_r + x_upp * bif->channels;
-	    double *low_c_next = low_r + x_upp * bif->channels;
-
-	    for (c = 0; c < bif->channels; c++) {
-		mid1 = low_c[0] + dx * (low_c_next[0] - low_c[0]);
-		mid2 = upp_c[0] + dx * (upp_c_next[0] - upp_c[0]);
+	    for (c = 0; c < job->channels; c++) {
+		double mid1 = low_c[c] + dx * (low_c_next[c] - low_c[c]);
+		double mid2 = upp_c[c] + dx * (upp_c_next[c] - upp_c[c]);
 		*out_p++ = mid1 + dy * (mid2 - mid1);
-		upp_c++;
-		low_c++;
-		upp_c_next++;
-		low_c_next++;
 	    }
 	}
     }
+}
+
+
+static int
+binterp(icv_image_t *bif, size_t out_width, size_t out_height)
+{
+    struct resample_job job;
+    size_t i;
+    double *out_data;
+
+    if (!resize_output_valid(bif, out_width, out_height))
+	return -1;
+
+    out_data = (double *)bu_malloc(out_width*out_height*bif->channels*sizeof(double), "binterp : out data");
+
+    memset(&job, 0, sizeof(job));
+    job.in = bif->data;
+    job.out = out_data;
+    job.in_width = bif->width;
+    job.in_height = bif->height;
+    job.out_width = out_width;
+    job.out_height = out_height;
+    job.channels = bif->channels;
+
+    /* column lookups are the same for every row, compute them once */
+    job.x_low = (size_t *)bu_malloc(out_width*sizeof(size_t), "binterp : x_low");
+    job.x_upp = (size_t *)bu_malloc(out_width*sizeof(size_t), "binterp : x_upp");
+    job.x_frac = (double *)bu_malloc(out_width*sizeof(double), "binterp : x_frac");
+    for (i = 0; i < out_width; i++) {
+	double x = mapped_coord(i, out_width, bif->width);
+	double x_floor = floor(x);
+	job.x_frac[i] = x - x_floor;
+	job.x_low[i] = (size_t)x_floor;
+	job.x_upp[i] = job.x_low[i] + 1;
+	if (job.x_upp[i] >= bif->width) job.x_upp[i] = bif->width - 1;
+    }
+
+    icv_rows_parallel(out_height, out_width * bif->channels * 4, binterp_rows, &job);
+
+    bu_free(job.x_low, "binterp : x_low");
+    bu_free(job.x_upp, "binterp : x_upp");
+    bu_free(job.x_frac, "binterp : x_frac");
+
     icv_image_data_free(bif, "binterp : Input Data");
     icv_image_data_set_bu(bif, out_data);
     bif->width = out_width;
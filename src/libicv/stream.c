@@ -0,0 +1,1535 @@
+/*                        S T R E A M . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file libicv/stream.c
+ *
+ * Scanline streaming sources, stages and encoders.
+ *
+ * Every stream produces rows on demand through its fill callback and
+ * remembers the last few rows it produced, so that stages needing two
+ * neighboring rows (bilinear interpolation, area averaging) can pull
+ * them from upstream without keeping buffers of their own.  Sources
+ * that can only be read forward report their order; anything needing
+ * another order goes through a spool stage backed by a temporary file.
+ */
+
+#include "common.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "png.h"
+#include "bio.h"
+
+#include "bu/app.h"
+#include "bu/file.h"
+#include "bu/log.h"
+#include "bu/malloc.h"
+#include "vmath.h"
+#include "icv_private.h"
+#include "icv/stream.h"
+
+
+/* rows remembered by default by every stream */
+#define STREAM_CACHE_ROWS 2
+
+/* upper bound on the rows a skewed crop keeps cached upstream */
+#define STREAM_QUAD_MAX_ROWS 256
+
+#define STREAM_NO_ROW ((size_t)-1)
+
+typedef int (*stream_fill_t)(icv_stream_t *s, size_t y, double *row);
+typedef void (*stream_release_t)(icv_stream_t *s);
+
+struct icv_stream {
+    size_t width;
+    size_t height;
+    size_t channels;
+    ICV_COLOR_SPACE color_space;
+    ICV_STREAM_ORDER order;
+
+    stream_fill_t fill;		/* produce row y */
+    stream_release_t release;	/* free state (may be NULL) */
+    void *state;
+
+    icv_stream_t *src;		/* upstream stream */
+    int owns_src;		/* destroy src along with this stream */
+
+    /* least recently used row cache */
+    size_t ncache;
+    size_t *cache_y;
+    size_t *cache_tick;
+    double **cache_row;
+    size_t tick;
+};
+
+
+static icv_stream_t *
+stream_create(size_t width, size_t height, size_t channels, ICV_COLOR_SPACE color_space,
+	      ICV_STREAM_ORDER order, icv_stream_t *src)
+{
+    icv_stream_t *s;
+    size_t i;
+
+    if (!width || !height) {
+	bu_log("icv_stream: image dimensions must be non-zero\n");
+	return NULL;
+    }
+    if (width > (size_t)-1 / channels / sizeof(double)) {
+	bu_log("icv_stream: image width excessively large, causing integer overflow\n");
+	return NULL;
+    }
+
+    BU_GET(s, icv_stream_t);
+    s->width = width;
+    s->height = height;
+    s->channels = channels;
+    s->color_space = color_space;
+    s->order = order;
+    s->fill = NULL;
+    s->release = NULL;
+    s->state = NULL;
+    s->src = src;
+    s->owns_src = 1;
+    s->ncache = STREAM_CACHE_ROWS;
+    s->cache_y = (size_t *)bu_malloc(s->ncache * sizeof(size_t), "icv_stream cache_y");
+    s->cache_tick = (size_t *)bu_calloc(s->ncache, sizeof(size_t), "icv_stream cache_tick");
+    s->cache_row = (double **)bu_malloc(s->ncache * sizeof(double *), "icv_stream cache_row");
+    for (i = 0; i < s->ncache; i++) {
+	s->cache_y[i] = STREAM_NO_ROW;
+	s->cache_row[i] = (double *)bu_malloc(width * channels * sizeof(double), "icv_stream row");
+    }
+    s->tick = 0;
+
+    return s;
+}
+
+
+/* Make sure s remembers at least nrows rows. */
+static void
+stream_reserve(icv_stream_t *s, size_t nrows)
+{
+    size_t i;
+
+    if (nrows <= s->ncache)
+	return;
+
+    s->cache_y = (size_t *)bu_realloc(s->cache_y, nrows * sizeof(size_t), "icv_stream cache_y");
+    s->cache_tick = (size_t *)bu_realloc(s->cache_tick, nrows * sizeof(size_t), "icv_stream cache_tick");
+    s->cache_row = (double **)bu_realloc(s->cache_row, nrows * sizeof(double *), "icv_stream cache_row");
+    for (i = s->ncache; i < nrows; i++) {
+	s->cache_y[i] = STREAM_NO_ROW;
+	s->cache_tick[i] = 0;
+	s->cache_row[i] = (double *)bu_malloc(s->width * s->channels * sizeof(double), "icv_stream row");
+    }
+    s->ncache = nrows;
+}
+
+
+/* Convert a row to 8 bit samples the way icv_data2uchar() does. */
+static void
+stream_row_to_bytes(const double *row, unsigned char *out, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+	long longval = lrint(row[i] * 255.0);
+	if (longval > 255)
+	    out[i] = 255;
+	else if (longval < 0)
+	    out[i] = 0;
+	else
+	    out[i] = (unsigned char)longval;
+    }
+}
+
+
+static void
+stream_bytes_to_row(const unsigned char *in, double *row, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+	row[i] = ICV_CONV_8BIT(in[i]);
+}
+
+
+/* Is fp positioned in a seekable file?  Leaves the position unchanged. */
+static int
+stream_seekable(FILE *fp, b_off_t *pos)
+{
+    b_off_t here = bu_ftell(fp);
+
+    if (here < 0)
+	return 0;
+    if (bu_fseek(fp, 0, SEEK_END) != 0)
+	return 0;
+    if (bu_fseek(fp, here, SEEK_SET) != 0)
+	return 0;
+    if (pos)
+	*pos = here;
+    return 1;
+}
+
+
+/* First row of s in its natural order, and the step to the next. */
+static void
+stream_walk(const icv_stream_t *s, size_t *first, int *step)
+{
+    if (s->order == ICV_STREAM_TOP_DOWN) {
+	*first = s->height - 1;
+	*step = -1;
+    } else {
+	*first = 0;
+	*step = 1;
+    }
+}
+
+
+/* ---------------------------------------------------------------- */
+/* raw pix / bw files */
+
+struct raw_source {
+    FILE *fp;
+    b_off_t start;		/* file offset of row 0 */
+    int seekable;
+    size_t next;		/* row the file is positioned at */
+    size_t rowbytes;
+    unsigned char *buf;
+};
+
+
+static int
+raw_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct raw_source *rs = (struct raw_source *)s->state;
+
+    if (rs->seekable) {
+	if (rs->next != y && bu_fseek(rs->fp, rs->start + (b_off_t)y * (b_off_t)rs->rowbytes, SEEK_SET) != 0) {
+	    bu_log("icv_stream: unable to seek to row %zu\n", y);
+	    return -1;
+	}
+    } else {
+	if (y < rs->next) {
+	    bu_log("icv_stream: row %zu requested out of order from a sequential file\n", y);
+	    return -1;
+	}
+	while (rs->next < y) {
+	    if (fread(rs->buf, rs->rowbytes, 1, rs->fp) != 1) {
+		bu_log("icv_stream: short read at row %zu\n", rs->next);
+		return -1;
+	    }
+	    rs->next++;
+	}
+    }
+
+    if (fread(rs->buf, rs->rowbytes, 1, rs->fp) != 1) {
+	bu_log("icv_stream: short read at row %zu\n", y);
+	rs->next = STREAM_NO_ROW;
+	return -1;
+    }
+    rs->next = y + 1;
+
+    stream_bytes_to_row(rs->buf, row, rs->rowbytes);
+    return 0;
+}
+
+
+static void
+raw_release(icv_stream_t *s)
+{
+    struct raw_source *rs = (struct raw_source *)s->state;
+    bu_free(rs->buf, "icv_stream raw row");
+    BU_PUT(rs, struct raw_source);
+}
+
+
+static icv_stream_t *
+raw_open(FILE *fp, size_t width, size_t height, ICV_COLOR_SPACE color_space, size_t channels)
+{
+    struct raw_source *rs;
+    icv_stream_t *s;
+
+    BU_GET(rs, struct raw_source);
+    rs->fp = fp;
+    rs->start = 0;
+    rs->seekable = stream_seekable(fp, &rs->start);
+    rs->next = 0;
+
+    s = stream_create(width, height, channels, color_space,
+		      rs->seekable ? ICV_STREAM_ANY_ORDER : ICV_STREAM_BOTTOM_UP, NULL);
+    if (!s) {
+	BU_PUT(rs, struct raw_source);
+	return NULL;
+    }
+
+    rs->rowbytes = width * channels;
+    rs->buf = (unsigned char *)bu_malloc(rs->rowbytes, "icv_stream raw row");
+    s->state = rs;
+    s->fill = raw_fill;
+    s->release = raw_release;
+
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* PNG files */
+
+struct png_source {
+    png_structp png;
+    png_infop info;
+    size_t next;		/* rows decoded so far, top down */
+    size_t rowbytes;
+    unsigned char *buf;
+    unsigned char *image;	/* whole image, interlaced files only */
+};
+
+
+static int
+png_source_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct png_source *ps = (struct png_source *)s->state;
+    size_t k = s->height - 1 - y;	/* PNG rows are stored top down */
+
+    if (ps->image) {
+	stream_bytes_to_row(ps->image + k * ps->rowbytes, row, ps->rowbytes);
+	return 0;
+    }
+
+    if (k < ps->next) {
+	bu_log("icv_stream: row %zu requested out of order from a PNG stream\n", y);
+	return -1;
+    }
+
+    if (setjmp(png_jmpbuf(ps->png))) {
+	bu_log("icv_stream: error decoding PNG row %zu\n", y);
+	ps->next = s->height;
+	return -1;
+    }
+    while (ps->next <= k) {
+	png_read_row(ps->png, (png_bytep)ps->buf, NULL);
+	ps->next++;
+    }
+
+    stream_bytes_to_row(ps->buf, row, ps->rowbytes);
+    return 0;
+}
+
+
+static void
+png_source_release(icv_stream_t *s)
+{
+    struct png_source *ps = (struct png_source *)s->state;
+
+    png_destroy_read_struct(&ps->png, &ps->info, NULL);
+    if (ps->image)
+	bu_free(ps->image, "icv_stream png image");
+    bu_free(ps->buf, "icv_stream png row");
+    BU_PUT(ps, struct png_source);
+}
+
+
+static icv_stream_t *
+png_open(FILE *fp)
+{
+    struct png_source *ps;
+    icv_stream_t * volatile s = NULL;	/* set after setjmp() */
+    unsigned char header[8];
+    png_color_16p input_backgrd;
+    double gammaval;
+    size_t width, height, channels, i;
+    int color_type, interlaced;
+
+    if (fread(header, 8, 1, fp) != 1) {
+	bu_log("icv_stream: unable to read PNG header\n");
+	return NULL;
+    }
+    if (png_sig_cmp((png_bytep)header, 0, 8)) {
+	bu_log("icv_stream: not a PNG file\n");
+	return NULL;
+    }
+
+    BU_GET(ps, struct png_source);
+    ps->buf = NULL;
+    ps->image = NULL;
+    ps->next = 0;
+    ps->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    ps->info = ps->png ? png_create_info_struct(ps->png) : NULL;
+    if (!ps->png || !ps->info) {
+	bu_log("icv_stream: unable to create PNG read structures\n");
+	png_destroy_read_struct(&ps->png, &ps->info, NULL);
+	BU_PUT(ps, struct png_source);
+	return NULL;
+    }
+
+    if (setjmp(png_jmpbuf(ps->png))) {
+	bu_log("icv_stream: error reading PNG file\n");
+	if (s) {
+	    icv_stream_destroy(s);
+	} else {
+	    png_destroy_read_struct(&ps->png, &ps->info, NULL);
+	    if (ps->buf)
+		bu_free(ps->buf, "icv_stream png row");
+	    BU_PUT(ps, struct png_source);
+	}
+	return NULL;
+    }
+
+    png_init_io(ps->png, fp);
+    png_set_sig_bytes(ps->png, 8);
+    png_read_info(ps->png, ps->info);
+
+    /* Same transformations as png_read(), except that gray images stay
+     * gray: the stream has a color space and gray2rgb is a stage. */
+    color_type = png_get_color_type(ps->png, ps->info);
+    png_set_expand(ps->png);
+    if (png_get_bit_depth(ps->png, ps->info) == 16)
+	png_set_strip_16(ps->png);
+
+    if (png_get_bKGD(ps->png, ps->info, &input_backgrd)) {
+	png_set_background(ps->png, input_backgrd, PNG_BACKGROUND_GAMMA_FILE, 1, 1.0);
+    } else {
+	png_color_16 def_backgrd = { 0, 0, 0, 0, 0 };
+	png_set_background(ps->png, &def_backgrd, PNG_BACKGROUND_GAMMA_FILE, 0, 1.0);
+    }
+    if (png_get_gAMA(ps->png, ps->info, &gammaval))
+	png_set_gAMA(ps->png, ps->info, gammaval);
+
+    interlaced = (png_get_interlace_type(ps->png, ps->info) != PNG_INTERLACE_NONE);
+    if (interlaced)
+	(void)png_set_interlace_handling(ps->png);
+
+    png_read_update_info(ps->png, ps->info);
+
+    width = png_get_image_width(ps->png, ps->info);
+    height = png_get_image_height(ps->png, ps->info);
+    channels = png_get_channels(ps->png, ps->info);
+    if (channels != 1 && channels != 3) {
+	bu_log("icv_stream: unsupported PNG channel layout (%zu channels)\n", channels);
+	png_destroy_read_struct(&ps->png, &ps->info, NULL);
+	BU_PUT(ps, struct png_source);
+	return NULL;
+    }
+
+    s = stream_create(width, height, channels,
+		      (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) ? ICV_COLOR_SPACE_GRAY : ICV_COLOR_SPACE_RGB,
+		      interlaced ? ICV_STREAM_ANY_ORDER : ICV_STREAM_TOP_DOWN, NULL);
+    if (!s) {
+	png_destroy_read_struct(&ps->png, &ps->info, NULL);
+	BU_PUT(ps, struct png_source);
+	return NULL;
+    }
+    ps->rowbytes = width * channels;
+    ps->buf = (unsigned char *)bu_malloc(ps->rowbytes, "icv_stream png row");
+    s->state = ps;
+    s->fill = png_source_fill;
+    s->release = png_source_release;
+
+    /* Interlaced rows are only complete after the last pass, so those
+     * files have to be decoded in full. */
+    if (interlaced) {
+	unsigned char **rows;
+	if (height > (size_t)-1 / ps->rowbytes) {
+	    bu_log("icv_stream: PNG dimensions excessively large, causing integer overflow\n");
+	    icv_stream_destroy(s);
+	    return NULL;
+	}
+	ps->image = (unsigned char *)bu_malloc(height * ps->rowbytes, "icv_stream png image");
+	rows = (unsigned char **)bu_malloc(height * sizeof(unsigned char *), "icv_stream png rows");
+	for (i = 0; i < height; i++)
+	    rows[i] = ps->image + i * ps->rowbytes;
+	png_read_image(ps->png, rows);
+	bu_free(rows, "icv_stream png rows");
+    }
+
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* in-memory images */
+
+struct image_source {
+    const icv_image_t *img;
+    icv_image_t *owned;		/* image to destroy with the stream */
+};
+
+
+static int
+image_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct image_source *is = (struct image_source *)s->state;
+    const double *in = is->img->data + y * s->width * is->img->channels;
+    size_t x;
+
+    if (is->img->channels == s->channels) {
+	memcpy(row, in, s->width * s->channels * sizeof(double));
+	return 0;
+    }
+
+    /* drop the alpha channel */
+    for (x = 0; x < s->width; x++, in += is->img->channels, row += s->channels)
+	VMOVEN(row, in, s->channels);
+    return 0;
+}
+
+
+static void
+image_release(icv_stream_t *s)
+{
+    struct image_source *is = (struct image_source *)s->state;
+    if (is->owned)
+	icv_destroy(is->owned);
+    BU_PUT(is, struct image_source);
+}
+
+
+icv_stream_t *
+icv_stream_image(const icv_image_t *img)
+{
+    struct image_source *is;
+    icv_stream_t *s;
+    size_t channels;
+
+    ICV_IMAGE_VAL_PTR(img);
+    if (!img->data)
+	return NULL;
+
+    channels = (img->color_space == ICV_COLOR_SPACE_GRAY) ? 1 : 3;
+    if (img->channels < channels) {
+	bu_log("icv_stream_image: image has too few channels (%zu)\n", img->channels);
+	return NULL;
+    }
+
+    s = stream_create(img->width, img->height, channels, img->color_space, ICV_STREAM_ANY_ORDER, NULL);
+    if (!s)
+	return NULL;
+
+    BU_GET(is, struct image_source);
+    is->img = img;
+    is->owned = NULL;
+    s->state = is;
+    s->fill = image_fill;
+    s->release = image_release;
+
+    return s;
+}
+
+
+icv_stream_t *
+icv_stream_open(FILE *fp, bu_mime_image_t format, size_t width, size_t height)
+{
+    icv_image_t *img = NULL;
+    icv_stream_t *s;
+
+    if (!fp)
+	return NULL;
+
+    switch (format) {
+	case BU_MIME_IMAGE_PIX:
+	    return raw_open(fp, width, height, ICV_COLOR_SPACE_RGB, 3);
+	case BU_MIME_IMAGE_BW:
+	    return raw_open(fp, width, height, ICV_COLOR_SPACE_GRAY, 1);
+	case BU_MIME_IMAGE_PNG:
+	    return png_open(fp);
+	case BU_MIME_IMAGE_DPIX:
+	    img = dpix_read(fp, width, height);
+	    break;
+	case BU_MIME_IMAGE_PPM:
+	    img = ppm_read(fp);
+	    break;
+	case BU_MIME_IMAGE_RLE:
+	    img = rle_read(fp);
+	    break;
+	case BU_MIME_IMAGE_JPEG:
+	    img = jpeg_read(fp);
+	    break;
+	default:
+	    bu_log("icv_stream_open: format not supported\n");
+	    return NULL;
+    }
+
+    /* no row access for these formats, stream the decoded image */
+    if (!img)
+	return NULL;
+    s = icv_stream_image(img);
+    if (!s) {
+	icv_destroy(img);
+	return NULL;
+    }
+    ((struct image_source *)s->state)->owned = img;
+
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* spooling to a temporary file */
+
+struct spool_stage {
+    FILE *fp;
+    int filled;
+    size_t rowbytes;
+    unsigned char *buf;
+};
+
+
+/* The spool stores 8 bit samples, the precision of every streamed
+ * file format, to keep the temporary file as small as the image. */
+static int
+spool_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct spool_stage *sp = (struct spool_stage *)s->state;
+
+    if (!sp->filled) {
+	size_t i, yy;
+	int step;
+
+	stream_walk(s->src, &yy, &step);
+	for (i = 0; i < s->height; i++, yy += step) {
+	    const double *r = icv_stream_read_row(s->src, yy);
+	    if (!r)
+		return -1;
+	    stream_row_to_bytes(r, sp->buf, sp->rowbytes);
+	    if (bu_fseek(sp->fp, (b_off_t)yy * (b_off_t)sp->rowbytes, SEEK_SET) != 0 ||
+		fwrite(sp->buf, sp->rowbytes, 1, sp->fp) != 1) {
+		bu_log("icv_stream: unable to write spool file\n");
+		return -1;
+	    }
+	}
+	sp->filled = 1;
+    }
+
+    if (bu_fseek(sp->fp, (b_off_t)y * (b_off_t)sp->rowbytes, SEEK_SET) != 0 ||
+	fread(sp->buf, sp->rowbytes, 1, sp->fp) != 1) {
+	bu_log("icv_stream: unable to read spool file\n");
+	return -1;
+    }
+    stream_bytes_to_row(sp->buf, row, sp->rowbytes);
+    return 0;
+}
+
+
+static void
+spool_release(icv_stream_t *s)
+{
+    struct spool_stage *sp = (struct spool_stage *)s->state;
+    fclose(sp->fp);
+    bu_free(sp->buf, "icv_stream spool row");
+    BU_PUT(sp, struct spool_stage);
+}
+
+
+static icv_stream_t *
+stream_spool(icv_stream_t *src)
+{
+    struct spool_stage *sp;
+    icv_stream_t *s;
+    FILE *fp;
+
+    fp = bu_temp_file(NULL, 0);
+    if (!fp) {
+	bu_log("icv_stream: unable to create spool file\n");
+	return NULL;
+    }
+    s = stream_create(src->width, src->height, src->channels, src->color_space, ICV_STREAM_ANY_ORDER, src);
+    if (!s) {
+	fclose(fp);
+	return NULL;
+    }
+
+    BU_GET(sp, struct spool_stage);
+    sp->fp = fp;
+    sp->filled = 0;
+    sp->rowbytes = src->width * src->channels;
+    sp->buf = (unsigned char *)bu_malloc(sp->rowbytes, "icv_stream spool row");
+    s->state = sp;
+    s->fill = spool_fill;
+    s->release = spool_release;
+
+    return s;
+}
+
+
+/* Return a stream serving src in any order, spooling if needed. */
+static icv_stream_t *
+stream_random_access(icv_stream_t *src)
+{
+    icv_stream_t *s;
+
+    if (src->order == ICV_STREAM_ANY_ORDER)
+	return src;
+    s = stream_spool(src);
+    if (!s)
+	icv_stream_destroy(src);
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* cropping */
+
+struct rect_stage {
+    size_t xorig;
+    size_t yorig;
+};
+
+
+static int
+rect_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct rect_stage *rc = (struct rect_stage *)s->state;
+    const double *in = icv_stream_read_row(s->src, rc->yorig + y);
+
+    if (!in)
+	return -1;
+    memcpy(row, in + rc->xorig * s->channels, s->width * s->channels * sizeof(double));
+    return 0;
+}
+
+
+static void
+rect_release(icv_stream_t *s)
+{
+    BU_PUT(s->state, struct rect_stage);
+}
+
+
+icv_stream_t *
+icv_stream_crop_rect(icv_stream_t *src, size_t xorig, size_t yorig, size_t xnum, size_t ynum)
+{
+    struct rect_stage *rc;
+    icv_stream_t *s;
+
+    if (!src)
+	return NULL;
+
+    if (xorig >= src->width || yorig >= src->height ||
+	xnum == 0 || ynum == 0 ||
+	xnum > src->width - xorig || ynum > src->height - yorig) {
+	bu_log("icv_stream_crop_rect: crop rectangle is outside of the image\n");
+	icv_stream_destroy(src);
+	return NULL;
+    }
+
+    s = stream_create(xnum, ynum, src->channels, src->color_space, src->order, src);
+    if (!s) {
+	icv_stream_destroy(src);
+	return NULL;
+    }
+
+    BU_GET(rc, struct rect_stage);
+    rc->xorig = xorig;
+    rc->yorig = yorig;
+    s->state = rc;
+    s->fill = rect_fill;
+    s->release = rect_release;
+
+    return s;
+}
+
+
+struct quad_stage {
+    double ulx, uly, urx, ury, lrx, lry, llx, lly;
+};
+
+
+static size_t
+quad_clamp(double v, size_t n)
+{
+    double r = floor(v + 0.5);
+
+    if (r < 0.0)
+	return 0;
+    if (r > (double)(n - 1))
+	return n - 1;
+    return (size_t)r;
+}
+
+
+static int
+quad_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct quad_stage *q = (struct quad_stage *)s->state;
+    double t = (s->height > 1) ? (double)y / (double)(s->height - 1) : 0.0;
+    double px1, py1, px2, py2;
+    size_t x;
+
+    /* left and right ends of this row in the source */
+    px1 = q->llx + (q->ulx - q->llx) * t;
+    py1 = q->lly + (q->uly - q->lly) * t;
+    px2 = q->lrx + (q->urx - q->lrx) * t;
+    py2 = q->lry + (q->ury - q->lry) * t;
+
+    for (x = 0; x < s->width; x++, row += s->channels) {
+	double u = (s->width > 1) ? (double)x / (double)(s->width - 1) : 0.0;
+	size_t ix = quad_clamp(px1 + (px2 - px1) * u, s->src->width);
+	size_t iy = quad_clamp(py1 + (py2 - py1) * u, s->src->height);
+	const double *in = icv_stream_read_row(s->src, iy);
+
+	if (!in)
+	    return -1;
+	VMOVEN(row, in + ix * s->channels, s->channels);
+    }
+    return 0;
+}
+
+
+static void
+quad_release(icv_stream_t *s)
+{
+    BU_PUT(s->state, struct quad_stage);
+}
+
+
+icv_stream_t *
+icv_stream_crop_quad(icv_stream_t *src,
+		     double ulx, double uly,
+		     double urx, double ury,
+		     double lrx, double lry,
+		     double llx, double lly,
+		     size_t xnum, size_t ynum)
+{
+    struct quad_stage *q;
+    icv_stream_t *s;
+    double span;
+
+    if (!src)
+	return NULL;
+    if (!xnum || !ynum) {
+	bu_log("icv_stream_crop_quad: output dimensions must be non-zero\n");
+	icv_stream_destroy(src);
+	return NULL;
+    }
+
+    src = stream_random_access(src);
+    if (!src)
+	return NULL;
+
+    s = stream_create(xnum, ynum, src->channels, src->color_space, ICV_STREAM_ANY_ORDER, src);
+    if (!s) {
+	icv_stream_destroy(src);
+	return NULL;
+    }
+
+    /* an output row crosses as many source rows as the quadrilateral
+     * is skewed; keep them all cached when that is reasonable */
+    span = FMAX(fabs(ury - uly), fabs(lry - lly)) + 2.0;
+    stream_reserve(src, (span > STREAM_QUAD_MAX_ROWS) ? STREAM_QUAD_MAX_ROWS : (size_t)span);
+
+    BU_GET(q, struct quad_stage);
+    q->ulx = ulx;
+    q->uly = uly;
+    q->urx = urx;
+    q->ury = ury;
+    q->lrx = lrx;
+    q->lry = lry;
+    q->llx = llx;
+    q->lly = lly;
+    s->state = q;
+    s->fill = quad_fill;
+    s->release = quad_release;
+
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* resizing */
+
+struct resize_stage {
+    ICV_RESIZE_METHOD method;
+
+    /* per-column source lookup (NINTERP, BINTERP, UNDERSAMPLE) */
+    size_t *x_low;
+    size_t *x_upp;
+    double *x_frac;
+
+    /* per-column source span (SHRINK): columns [x_low, x_upp) with the
+     * first and last column partially covered */
+    double *x_first;
+    double *x_last;
+    double xlen;
+    double ylen;
+};
+
+
+static double
+stream_mapped_coord(size_t out_index, size_t out_size, size_t in_size)
+{
+    if (out_size <= 1 || in_size <= 1)
+	return 0.0;
+    return ((double)out_index * (double)(in_size - 1)) / (double)(out_size - 1);
+}
+
+
+/* Add weight times the horizontal area average of in to row. */
+static void
+shrink_accumulate(const icv_stream_t *s, const struct resize_stage *rz, const double *in, double weight, double *row)
+{
+    size_t ch = s->channels;
+    size_t x, k, c;
+
+    for (x = 0; x < s->width; x++) {
+	double *o = row + x * ch;
+	for (k = rz->x_low[x]; k < rz->x_upp[x]; k++) {
+	    double w = weight;
+	    if (k == rz->x_low[x])
+		w *= rz->x_first[x];
+	    else if (k == rz->x_upp[x] - 1)
+		w *= rz->x_last[x];
+	    for (c = 0; c < ch; c++)
+		o[c] += w * in[k * ch + c];
+	}
+    }
+}
+
+
+static int
+resize_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct resize_stage *rz = (struct resize_stage *)s->state;
+    icv_stream_t *src = s->src;
+    size_t ch = s->channels;
+    size_t x, c;
+
+    switch (rz->method) {
+	case ICV_RESIZE_UNDERSAMPLE:
+	case ICV_RESIZE_NINTERP: {
+	    const double *in;
+	    size_t sy;
+	    if (rz->method == ICV_RESIZE_NINTERP) {
+		sy = (size_t)(stream_mapped_coord(y, s->height, src->height) + 0.5);
+	    } else {
+		sy = (size_t)((double)y * rz->ylen);
+	    }
+	    if (sy >= src->height)
+		sy = src->height - 1;
+	    in = icv_stream_read_row(src, sy);
+	    if (!in)
+		return -1;
+	    for (x = 0; x < s->width; x++)
+		VMOVEN(row + x * ch, in + rz->x_low[x] * ch, ch);
+	    return 0;
+	}
+	case ICV_RESIZE_BINTERP: {
+	    const double *low_r, *upp_r;
+	    double yc = stream_mapped_coord(y, s->height, src->height);
+	    double y_floor = floor(yc);
+	    double dy = yc - y_floor;
+	    size_t y_low = (size_t)y_floor;
+	    size_t y_upp = (y_low + 1 < src->height) ? y_low + 1 : src->height - 1;
+
+	    /* fetch in the order src delivers rows; both stay cached */
+	    if (src->order == ICV_STREAM_TOP_DOWN) {
+		upp_r = icv_stream_read_row(src, y_upp);
+		low_r = icv_stream_read_row(src, y_low);
+	    } else {
+		low_r = icv_stream_read_row(src, y_low);
+		upp_r = icv_stream_read_row(src, y_upp);
+	    }
+	    if (!low_r || !upp_r)
+		return -1;
+
+	    for (x = 0; x < s->width; x++) {
+		double dx = rz->x_frac[x];
+		const double *low_c = low_r + rz->x_low[x] * ch;
+		const double *upp_c = upp_r + rz->x_low[x] * ch;
+		const double *low_c_next = low_r + rz->x_upp[x] * ch;
+		const double *upp_c_next = upp_r + rz->x_upp[x] * ch;
+
+		for (c = 0; c < ch; c++) {
+		    double mid1 = low_c[c] + dx * (low_c_next[c] - low_c[c]);
+		    double mid2 = upp_c[c] + dx * (upp_c_next[c] - upp_c[c]);
+		    *row++ = mid1 + dy * (mid2 - mid1);
+		}
+	    }
+	    return 0;
+	}
+	case ICV_RESIZE_SHRINK: {
+	    double ystart = (double)y * rz->ylen;
+	    double yend = ystart + rz->ylen;
+	    size_t l_first = (size_t)ystart;
+	    size_t l_end = (size_t)ceil(yend);
+	    size_t l, i, n;
+	    int step;
+
+	    if (l_end > src->height)
+		l_end = src->height;
+	    if (l_end <= l_first)
+		l_end = l_first + 1;
+
+	    memset(row, 0, s->width * ch * sizeof(double));
+
+	    /* visit the covered rows in the order src delivers them */
+	    n = l_end - l_first;
+	    if (src->order == ICV_STREAM_TOP_DOWN) {
+		l = l_end - 1;
+		step = -1;
+	    } else {
+		l = l_first;
+		step = 1;
+	    }
+	    for (i = 0; i < n; i++, l += step) {
+		double lo = ((double)l < ystart) ? ystart : (double)l;
+		double hi = ((double)(l + 1) > yend) ? yend : (double)(l + 1);
+		const double *in = icv_stream_read_row(src, l);
+		if (!in)
+		    return -1;
+		if (hi > lo)
+		    shrink_accumulate(s, rz, in, hi - lo, row);
+	    }
+
+	    for (i = 0; i < s->width * ch; i++)
+		row[i] /= rz->xlen * rz->ylen;
+	    return 0;
+	}
+	default:
+	    return -1;
+    }
+}
+
+
+static void
+resize_release(icv_stream_t *s)
+{
+    struct resize_stage *rz = (struct resize_stage *)s->state;
+
+    bu_free(rz->x_low, "icv_stream x_low");
+    bu_free(rz->x_upp, "icv_stream x_upp");
+    bu_free(rz->x_frac, "icv_stream x_frac");
+    bu_free(rz->x_first, "icv_stream x_first");
+    bu_free(rz->x_last, "icv_stream x_last");
+    BU_PUT(rz, struct resize_stage);
+}
+
+
+icv_stream_t *
+icv_stream_resize(icv_stream_t *src, ICV_RESIZE_METHOD method, size_t out_width, size_t out_height)
+{
+    struct resize_stage *rz;
+    icv_stream_t *s;
+    size_t x;
+
+    if (!src)
+	return NULL;
+
+    if (method != ICV_RESIZE_UNDERSAMPLE && method != ICV_RESIZE_SHRINK &&
+	method != ICV_RESIZE_NINTERP && method != ICV_RESIZE_BINTERP) {
+	bu_log("icv_stream_resize: invalid resize method\n");
+	icv_stream_destroy(src);
+	return NULL;
+    }
+
+    s = stream_create(out_width, out_height, src->channels, src->color_space, src->order, src);
+    if (!s) {
+	icv_stream_destroy(src);
+	return NULL;
+    }
+
+    BU_GET(rz, struct resize_stage);
+    rz->method = method;
+    rz->xlen = (double)src->width / (double)out_width;
+    rz->ylen = (double)src->height / (double)out_height;
+    rz->x_low = (size_t *)bu_calloc(out_width, sizeof(size_t), "icv_stream x_low");
+    rz->x_upp = (size_t *)bu_calloc(out_width, sizeof(size_t), "icv_stream x_upp");
+    rz->x_frac = (double *)bu_calloc(out_width, sizeof(double), "icv_stream x_frac");
+    rz->x_first = (double *)bu_calloc(out_width, sizeof(double), "icv_stream x_first");
+    rz->x_last = (double *)bu_calloc(out_width, sizeof(double), "icv_stream x_last");
+
+    /* column lookups are the same for every row, compute them once */
+    for (x = 0; x < out_width; x++) {
+	switch (method) {
+	    case ICV_RESIZE_NINTERP:
+		rz->x_low[x] = (size_t)(stream_mapped_coord(x, out_width, src->width) + 0.5);
+		break;
+	    case ICV_RESIZE_UNDERSAMPLE:
+		rz->x_low[x] = (size_t)((double)x * rz->xlen);
+		break;
+	    case ICV_RESIZE_BINTERP: {
+		double xc = stream_mapped_coord(x, out_width, src->width);
+		double x_floor = floor(xc);
+		rz->x_frac[x] = xc - x_floor;
+		rz->x_low[x] = (size_t)x_floor;
+		rz->x_upp[x] = rz->x_low[x] + 1;
+		break;
+	    }
+	    default: {
+		double xstart = (double)x * rz->xlen;
+		double xend = xstart + rz->xlen;
+		rz->x_low[x] = (size_t)xstart;
+		rz->x_upp[x] = (size_t)ceil(xend);
+		if (rz->x_upp[x] > src->width)
+		    rz->x_upp[x] = src->width;
+		if (rz->x_upp[x] <= rz->x_low[x])
+		    rz->x_upp[x] = rz->x_low[x] + 1;
+		rz->x_first[x] = FMIN((double)(rz->x_low[x] + 1), xend) - xstart;
+		rz->x_last[x] = xend - (double)(rz->x_upp[x] - 1);
+		if (rz->x_last[x] > 1.0)
+		    rz->x_last[x] = 1.0;
+		break;
+	    }
+	}
+	if (rz->x_low[x] >= src->width)
+	    rz->x_low[x] = src->width - 1;
+	if (method != ICV_RESIZE_SHRINK && rz->x_upp[x] >= src->width)
+	    rz->x_upp[x] = src->width - 1;
+    }
+
+    s->state = rz;
+    s->fill = resize_fill;
+    s->release = resize_release;
+
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* color conversion */
+
+struct gray_stage {
+    double rweight;
+    double gweight;
+    double bweight;
+};
+
+
+static int
+rgb2gray_fill(icv_stream_t *s, size_t y, double *row)
+{
+    struct gray_stage *g = (struct gray_stage *)s->state;
+    const double *in = icv_stream_read_row(s->src, y);
+    size_t x;
+
+    if (!in)
+	return -1;
+    for (x = 0; x < s->width; x++, in += 3) {
+	double value = g->rweight*in[0] + g->gweight*in[1] + g->bweight*in[2];
+	row[x] = (value > 1.0) ? 1.0 : ((value < 0.0) ? 0.0 : value);
+    }
+    return 0;
+}
+
+
+static int
+gray2rgb_fill(icv_stream_t *s, size_t y, double *row)
+{
+    const double *in = icv_stream_read_row(s->src, y);
+    size_t x;
+
+    if (!in)
+	return -1;
+    for (x = 0; x < s->width; x++, row += 3)
+	row[0] = row[1] = row[2] = in[x];
+    return 0;
+}
+
+
+static void
+gray_release(icv_stream_t *s)
+{
+    if (s->state) {
+	BU_PUT(s->state, struct gray_stage);
+    }
+}
+
+
+static icv_stream_t *
+stream_rgb2gray(icv_stream_t *src, double rweight, double gweight, double bweight)
+{
+    struct gray_stage *g;
+    icv_stream_t *s;
+
+    s = stream_create(src->width, src->height, 1, ICV_COLOR_SPACE_GRAY, src->order, src);
+    if (!s)
+	return NULL;
+
+    /* as icv_rgb2gray() with ICV_COLOR_RGB: all zero weights average
+     * the three planes */
+    BU_GET(g, struct gray_stage);
+    if (ZERO(rweight) && ZERO(gweight) && ZERO(bweight)) {
+	rweight = gweight = bweight = 1.0 / 3.0;
+    }
+    g->rweight = rweight;
+    g->gweight = gweight;
+    g->bweight = bweight;
+    s->state = g;
+    s->fill = rgb2gray_fill;
+    s->release = gray_release;
+
+    return s;
+}
+
+
+static icv_stream_t *
+stream_gray2rgb(icv_stream_t *src)
+{
+    icv_stream_t *s;
+
+    s = stream_create(src->width, src->height, 3, ICV_COLOR_SPACE_RGB, src->order, src);
+    if (!s)
+	return NULL;
+    s->fill = gray2rgb_fill;
+    s->release = gray_release;
+
+    return s;
+}
+
+
+icv_stream_t *
+icv_stream_rgb2gray(icv_stream_t *src, double rweight, double gweight, double bweight)
+{
+    icv_stream_t *s;
+
+    if (!src || src->color_space == ICV_COLOR_SPACE_GRAY)
+	return src;
+    s = stream_rgb2gray(src, rweight, gweight, bweight);
+    if (!s)
+	icv_stream_destroy(src);
+    return s;
+}
+
+
+icv_stream_t *
+icv_stream_gray2rgb(icv_stream_t *src)
+{
+    icv_stream_t *s;
+
+    if (!src || src->color_space == ICV_COLOR_SPACE_RGB)
+	return src;
+    s = stream_gray2rgb(src);
+    if (!s)
+	icv_stream_destroy(src);
+    return s;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* row access */
+
+void
+icv_stream_info(const icv_stream_t *s, size_t *width, size_t *height, ICV_COLOR_SPACE *color_space, ICV_STREAM_ORDER *order)
+{
+    if (!s)
+	return;
+    if (width)
+	*width = s->width;
+    if (height)
+	*height = s->height;
+    if (color_space)
+	*color_space = s->color_space;
+    if (order)
+	*order = s->order;
+}
+
+
+const double *
+icv_stream_read_row(icv_stream_t *s, size_t y)
+{
+    size_t i, slot = 0;
+
+    if (!s || y >= s->height)
+	return NULL;
+
+    s->tick++;
+    for (i = 0; i < s->ncache; i++) {
+	if (s->cache_y[i] == y) {
+	    s->cache_tick[i] = s->tick;
+	    return s->cache_row[i];
+	}
+	if (s->cache_tick[i] < s->cache_tick[slot])
+	    slot = i;
+    }
+
+    s->cache_y[slot] = STREAM_NO_ROW;
+    if (s->fill(s, y, s->cache_row[slot]) < 0)
+	return NULL;
+    s->cache_y[slot] = y;
+    s->cache_tick[slot] = s->tick;
+
+    return s->cache_row[slot];
+}
+
+
+void
+icv_stream_destroy(icv_stream_t *s)
+{
+    size_t i;
+
+    if (!s)
+	return;
+
+    if (s->release)
+	s->release(s);
+    if (s->src && s->owns_src)
+	icv_stream_destroy(s->src);
+
+    for (i = 0; i < s->ncache; i++)
+	bu_free(s->cache_row[i], "icv_stream row");
+    bu_free(s->cache_row, "icv_stream cache_row");
+    bu_free(s->cache_tick, "icv_stream cache_tick");
+    bu_free(s->cache_y, "icv_stream cache_y");
+    BU_PUT(s, icv_stream_t);
+}
+
+
+icv_image_t *
+icv_stream_to_image(icv_stream_t *s)
+{
+    icv_image_t *img;
+    size_t i, y, rowlen;
+    int step;
+
+    if (!s)
+	return NULL;
+    if (s->height > (size_t)-1 / s->width / s->channels / sizeof(double)) {
+	bu_log("icv_stream_to_image: image dimensions excessively large, causing integer overflow\n");
+	return NULL;
+    }
+
+    img = icv_create_with_channels(s->width, s->height, s->color_space, s->channels);
+    if (!img)
+	return NULL;
+
+    rowlen = s->width * s->channels;
+    stream_walk(s, &y, &step);
+    for (i = 0; i < s->height; i++, y += step) {
+	const double *r = icv_stream_read_row(s, y);
+	if (!r) {
+	    icv_destroy(img);
+	    return NULL;
+	}
+	memcpy(img->data + y * rowlen, r, rowlen * sizeof(double));
+    }
+
+    return img;
+}
+
+
+/* ---------------------------------------------------------------- */
+/* encoders */
+
+/* Wrap s for an encoder: convert to the required color space (when
+ * color_space is not -1) and spool when the rows cannot be delivered
+ * in the required order.  The wrappers borrow s, so destroying the
+ * returned stream (when it differs from s) leaves s alone. */
+static icv_stream_t *
+stream_for_writer(icv_stream_t *s, int color_space, ICV_STREAM_ORDER order)
+{
+    icv_stream_t *w = s;
+    icv_stream_t *n;
+
+    if (color_space == ICV_COLOR_SPACE_GRAY && w->color_space != ICV_COLOR_SPACE_GRAY) {
+	n = stream_rgb2gray(w, 0.0, 0.0, 0.0);
+	if (!n)
+	    return NULL;
+	n->owns_src = (w != s);
+	w = n;
+    } else if (color_space == ICV_COLOR_SPACE_RGB && w->color_space != ICV_COLOR_SPACE_RGB) {
+	n = stream_gray2rgb(w);
+	if (!n)
+	    return NULL;
+	n->owns_src = (w != s);
+	w = n;
+    }
+
+    if (w->order != ICV_STREAM_ANY_ORDER && w->order != order) {
+	n = stream_spool(w);
+	if (!n) {
+	    if (w != s)
+		icv_stream_destroy(w);
+	    return NULL;
+	}
+	n->owns_src = (w != s);
+	w = n;
+    }
+
+    return w;
+}
+
+
+static int
+raw_write(icv_stream_t *s, FILE *fp, ICV_COLOR_SPACE color_space)
+{
+    b_off_t start = 0;
+    int seekable = stream_seekable(fp, &start);
+    int ret = BRLCAD_OK;
+    icv_stream_t *w;
+    unsigned char *buf;
+    size_t i, y, rowbytes;
+    int step;
+
+    /* Raw files are stored bottom up; on a seekable output rows can
+     * be written wherever they come from. */
+    w = stream_for_writer(s, color_space, seekable ? s->order : ICV_STREAM_BOTTOM_UP);
+    if (!w)
+	return BRLCAD_ERROR;
+
+    rowbytes = w->width * w->channels;
+    buf = (unsigned char *)bu_malloc(rowbytes, "icv_stream_write row");
+    stream_walk(w, &y, &step);
+    for (i = 0; i < w->height; i++, y += step) {
+	const double *r = icv_stream_read_row(w, y);
+	if (!r) {
+	    ret = BRLCAD_ERROR;
+	    break;
+	}
+	stream_row_to_bytes(r, buf, rowbytes);
+	if (step < 0 && bu_fseek(fp, start + (b_off_t)y * (b_off_t)rowbytes, SEEK_SET) != 0) {
+	    bu_log("icv_stream_write: unable to seek output\n");
+	    ret = BRLCAD_ERROR;
+	    break;
+	}
+	if (fwrite(buf, rowbytes, 1, fp) != 1) {
+	    bu_log("icv_stream_write: short write\n");
+	    ret = BRLCAD_ERROR;
+	    break;
+	}
+    }
+    if (step < 0 && ret == BRLCAD_OK)
+	(void)bu_fseek(fp, start + (b_off_t)w->height * (b_off_t)rowbytes, SEEK_SET);
+
+    bu_free(buf, "icv_stream_write row");
+    if (w != s)
+	icv_stream_destroy(w);
+    return ret;
+}
+
+
+int
+icv_stream_write_png(icv_stream_t *s, FILE *fp, int compression, double gamma)
+{
+    png_structp png_ptr;
+    png_infop info_ptr;
+    icv_stream_t *w;
+    unsigned char *buf;
+    size_t y, rowbytes;
+    int ret = BRLCAD_OK;
+
+    if (UNLIKELY(!s || !fp))
+	return BRLCAD_ERROR;
+
+    w = stream_for_writer(s, -1, ICV_STREAM_TOP_DOWN);
+    if (!w)
+	return BRLCAD_ERROR;
+
+    rowbytes = w->width * w->channels;
+    buf = (unsigned char *)bu_malloc(rowbytes, "icv_stream_write_png row");
+
+    png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    info_ptr = png_ptr ? png_create_info_struct(png_ptr) : NULL;
+    if (!png_ptr || !info_ptr || setjmp(png_jmpbuf(png_ptr))) {
+	bu_log("icv_stream_write_png: error writing PNG\n");
+	png_destroy_write_struct(&png_ptr, info_ptr ? &info_ptr : NULL);
+	bu_free(buf, "icv_stream_write_png row");
+	if (w != s)
+	    icv_stream_destroy(w);
+	return BRLCAD_ERROR;
+    }
+
+    png_init_io(png_ptr, fp);
+    if (compression >= 0)
+	png_set_compression_level(png_ptr, (compression > 9) ? 9 : compression);
+    png_set_IHDR(png_ptr, info_ptr, (png_uint_32)w->width, (png_uint_32)w->height, 8,
+		 (w->channels == 1) ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB,
+		 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    if (gamma > 0.0)
+	png_set_gAMA(png_ptr, info_ptr, gamma);
+    png_write_info(png_ptr, info_ptr);
+
+    /* PNG rows are stored top down */
+    for (y = w->height; y-- > 0;) {
+	const double *r = icv_stream_read_row(w, y);
+	if (!r) {
+	    ret = BRLCAD_ERROR;
+	    break;
+	}
+	stream_row_to_bytes(r, buf, rowbytes);
+	png_write_row(png_ptr, (png_bytep)buf);
+    }
+    if (ret == BRLCAD_OK) {
+	png_write_end(png_ptr, NULL);
+	png_write_flush(png_ptr);
+    }
+
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    bu_free(buf, "icv_stream_write_png row");
+    if (w != s)
+	icv_stream_destroy(w);
+    return ret;
+}
+
+
+int
+icv_stream_write(icv_stream_t *s, FILE *fp, bu_mime_image_t format)
+{
+    icv_image_t *img;
+    int ret;
+
+    if (UNLIKELY(!s || !fp))
+	return BRLCAD_ERROR;
+
+    switch (format) {
+	case BU_MIME_IMAGE_PNG:
+	    return icv_stream_write_png(s, fp, -1, -1.0);
+	case BU_MIME_IMAGE_BW:
+	    return raw_write(s, fp, ICV_COLOR_SPACE_GRAY);
+	case BU_MIME_IMAGE_DPIX:
+	case BU_MIME_IMAGE_PPM:
+	case BU_MIME_IMAGE_RLE:
+	case BU_MIME_IMAGE_JPEG:
+	    break;
+	default:
+	    /* like icv_write(), anything else is written as pix */
+	    return raw_write(s, fp, ICV_COLOR_SPACE_RGB);
+    }
+
+    /* these encoders need the whole image */
+    img = icv_stream_to_image(s);
+    if (!img)
+	return BRLCAD_ERROR;
+    switch (format) {
+	case BU_MIME_IMAGE_DPIX:
+	    ret = dpix_write(img, fp);
+	    break;
+	case BU_MIME_IMAGE_PPM:
+	    ret = ppm_write(img, fp);
+	    break;
+	case BU_MIME_IMAGE_RLE:
+	    ret = rle_write(img, fp);
+	    break;
+	default:
+	    ret = jpeg_write(img, fp, 90);
+	    break;
+    }
+    icv_destroy(img);
+    return ret;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
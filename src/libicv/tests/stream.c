@@ -0,0 +1,254 @@
+/*                   I C V _ S T R E A M _ T E S T . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file stream.c
+ *
+ * Tests for LIBICV's scanline streams: file round trips, and stages
+ * checked against the equivalent in-memory image operations.
+ */
+
+#include "common.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bu/app.h"
+#include "bu/log.h"
+#include "bu/malloc.h"
+#include "icv.h"
+
+#define WIDTH 37
+#define HEIGHT 26
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define CHECK(_cond, _msg) do { \
+    tests_run++; \
+    if (_cond) { \
+	tests_passed++; \
+    } else { \
+	bu_log("FAIL [%s:%d]: %s\n", __FILE__, __LINE__, _msg); \
+    } \
+} while (0)
+
+
+static icv_image_t *
+make_image(void)
+{
+    icv_image_t *img = icv_create(WIDTH, HEIGHT, ICV_COLOR_SPACE_RGB);
+    size_t i;
+
+    /* 8 bit values, so every file format round trips exactly */
+    for (i = 0; i < WIDTH * HEIGHT * 3; i++)
+	img->data[i] = ICV_CONV_8BIT((i * 7919 + i / 3) % 256);
+    return img;
+}
+
+
+static icv_image_t *
+copy_image(const icv_image_t *src)
+{
+    icv_image_t *img = icv_create(src->width, src->height, src->color_space);
+    memcpy(img->data, src->data, src->width * src->height * src->channels * sizeof(double));
+    return img;
+}
+
+
+static int
+same_image(const icv_image_t *a, const icv_image_t *b, double tol)
+{
+    size_t i;
+
+    if (!a || !b || a->width != b->width || a->height != b->height || a->channels != b->channels)
+	return 0;
+    for (i = 0; i < a->width * a->height * a->channels; i++) {
+	if (fabs(a->data[i] - b->data[i]) > tol)
+	    return 0;
+    }
+    return 1;
+}
+
+
+/* Write orig to a temporary file in the given format and reopen it as
+ * a stream. */
+static icv_stream_t *
+file_stream(const icv_image_t *orig, bu_mime_image_t format, FILE **fpp)
+{
+    icv_stream_t *s = icv_stream_image(orig);
+    FILE *fp = bu_temp_file(NULL, 0);
+
+    *fpp = fp;
+    if (!s || !fp)
+	return NULL;
+    if (icv_stream_write(s, fp, format) != BRLCAD_OK) {
+	icv_stream_destroy(s);
+	return NULL;
+    }
+    icv_stream_destroy(s);
+    rewind(fp);
+
+    return icv_stream_open(fp, format, orig->width, orig->height);
+}
+
+
+static void
+test_round_trips(const icv_image_t *orig)
+{
+    FILE *pixfp, *pngfp, *outfp;
+    icv_stream_t *s;
+    icv_image_t *img;
+
+    s = file_stream(orig, BU_MIME_IMAGE_PIX, &pixfp);
+    CHECK(s != NULL, "PIX stream opens");
+    img = icv_stream_to_image(s);
+    CHECK(same_image(orig, img, 0.0), "PIX round trip is exact");
+    icv_destroy(img);
+    icv_stream_destroy(s);
+    fclose(pixfp);
+
+    /* PNG rows come top down, PIX rows are written bottom up */
+    s = file_stream(orig, BU_MIME_IMAGE_PNG, &pngfp);
+    CHECK(s != NULL, "PNG stream opens");
+    outfp = bu_temp_file(NULL, 0);
+    CHECK(icv_stream_write(s, outfp, BU_MIME_IMAGE_PIX) == BRLCAD_OK, "PNG stream writes PIX");
+    icv_stream_destroy(s);
+    rewind(outfp);
+    s = icv_stream_open(outfp, BU_MIME_IMAGE_PIX, WIDTH, HEIGHT);
+    img = icv_stream_to_image(s);
+    CHECK(same_image(orig, img, 0.0), "PNG to PIX round trip is exact");
+    icv_destroy(img);
+    icv_stream_destroy(s);
+    fclose(outfp);
+
+    /* out of order reads of a sequential source fail */
+    rewind(pngfp);
+    s = icv_stream_open(pngfp, BU_MIME_IMAGE_PNG, 0, 0);
+    CHECK(icv_stream_read_row(s, 0) != NULL, "PNG stream reads its bottom row");
+    CHECK(icv_stream_read_row(s, HEIGHT - 1) == NULL, "PNG stream refuses to rewind");
+    icv_stream_destroy(s);
+    fclose(pngfp);
+}
+
+
+static void
+test_resize(const icv_image_t *orig, ICV_RESIZE_METHOD method, size_t w, size_t h, size_t factor, const char *msg)
+{
+    icv_image_t *ref = copy_image(orig);
+    icv_stream_t *s;
+    icv_image_t *img;
+    FILE *fp;
+
+    icv_resize(ref, method, w, h, factor);
+
+    /* resize the top down PNG stream to exercise the reverse walk;
+     * the block methods only use whole factor x factor blocks */
+    s = file_stream(orig, BU_MIME_IMAGE_PNG, &fp);
+    if (factor)
+	s = icv_stream_crop_rect(s, 0, 0, ref->width * factor, ref->height * factor);
+    s = icv_stream_resize(s, method, ref->width, ref->height);
+    img = icv_stream_to_image(s);
+    CHECK(same_image(ref, img, 1.0e-12), msg);
+
+    icv_destroy(img);
+    icv_stream_destroy(s);
+    icv_destroy(ref);
+    fclose(fp);
+}
+
+
+static void
+test_stages(const icv_image_t *orig)
+{
+    icv_image_t *ref, *img;
+    icv_stream_t *s;
+    FILE *fp;
+
+    ref = copy_image(orig);
+    icv_crop_rect(ref, 5, 3, 20, 11);
+    s = icv_stream_crop_rect(icv_stream_image(orig), 5, 3, 20, 11);
+    img = icv_stream_to_image(s);
+    CHECK(same_image(ref, img, 0.0), "rectangular crop matches icv_crop_rect");
+    icv_destroy(img);
+    icv_stream_destroy(s);
+    icv_destroy(ref);
+
+    /* the quadrilateral crop spools the top down PNG stream */
+    s = file_stream(orig, BU_MIME_IMAGE_PNG, &fp);
+    s = icv_stream_crop_quad(s, 0, HEIGHT - 1, WIDTH - 1, HEIGHT - 1, WIDTH - 1, 0, 0, 0, WIDTH, HEIGHT);
+    img = icv_stream_to_image(s);
+    CHECK(same_image(orig, img, 0.0), "identity quadrilateral crop reproduces the image");
+    icv_destroy(img);
+    icv_stream_destroy(s);
+    fclose(fp);
+
+    ref = copy_image(orig);
+    icv_rgb2gray(ref, ICV_COLOR_RGB, 0.3, 0, 0);
+    s = icv_stream_rgb2gray(icv_stream_image(orig), 0.3, 0, 0);
+    img = icv_stream_to_image(s);
+    CHECK(same_image(ref, img, 1.0e-12), "gray conversion matches icv_rgb2gray");
+    icv_destroy(img);
+    icv_stream_destroy(s);
+
+    icv_gray2rgb(ref);
+    s = icv_stream_gray2rgb(icv_stream_rgb2gray(icv_stream_image(orig), 0.3, 0, 0));
+    img = icv_stream_to_image(s);
+    CHECK(same_image(ref, img, 1.0e-12), "RGB conversion matches icv_gray2rgb");
+    icv_destroy(img);
+    icv_stream_destroy(s);
+    icv_destroy(ref);
+}
+
+
+int
+main(int argc, char **argv)
+{
+    icv_image_t *orig;
+
+    (void)argc;
+
+    bu_setprogname(argv[0]);
+
+    orig = make_image();
+
+    test_round_trips(orig);
+    test_resize(orig, ICV_RESIZE_NINTERP, 80, 61, 0, "nearest enlargement matches icv_resize");
+    test_resize(orig, ICV_RESIZE_BINTERP, 80, 61, 0, "bilinear enlargement matches icv_resize");
+    test_resize(orig, ICV_RESIZE_BINTERP, 19, 9, 0, "bilinear reduction matches icv_resize");
+    test_resize(orig, ICV_RESIZE_SHRINK, 0, 0, 2, "area shrink matches icv_resize");
+    test_resize(orig, ICV_RESIZE_UNDERSAMPLE, 0, 0, 3, "undersample matches icv_resize");
+    test_stages(orig);
+
+    icv_destroy(orig);
+
+    bu_log("icv_stream_test: %d/%d checks passed\n", tests_passed, tests_run);
+
+    return (tests_run == tests_passed) ? BRLCAD_OK : BRLCAD_ERROR;
+}
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
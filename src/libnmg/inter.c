@@ -60,11 +60,14 @@
 #include "bio.h"
 
 #include "vmath.h"
+#include "bu/datetime.h"
 #include "bu/malloc.h"
+#include "bu/parallel.h"
 #include "bn/mat.h"
 #include "bg/plane.h"
 #include "bv/plot3.h"
 #include "nmg.h"
+#include "./nmg_private.h"
 
 #define ISECT_NONE 0
 #define ISECT_SHARED_V 1
@@ -6384,12 +6387,125 @@ out:
 }
 
 
+/*
+ * nmg_face_bb_pairs is defined in inter_rtree.cpp so that it can use
+ * libbg's C++ R-tree.
+ */
+__BEGIN_DECLS
+extern size_t nmg_face_bb_pairs(long **pairs, const struct bu_ptbl *faces1,
+				const struct bu_ptbl *faces2, fastf_t margin);
+__END_DECLS
+
+/* Shell pairs with fewer face pairs than this use the plain double loop */
+#define NMG_CRACK_RTREE_MIN_PAIRS 256
+
+/* Screening candidate pairs only pays off across threads for this many */
+#define NMG_CRACK_PARALLEL_MIN_PAIRS 1024
+
+/* Candidate pairs handed to each screening thread at a time */
+#define NMG_CRACK_SCREEN_CHUNK 64
+
+
+struct crack_screen_job {
+    const struct bu_ptbl *faces1;
+    const struct bu_ptbl *faces2;
+    const long *pairs;
+    char *skip;
+    size_t npairs;
+    size_t next;
+    struct bn_tol tol;
+};
+
+
+static struct faceuse *
+crack_face_fu(const struct bu_ptbl *faces, long i)
+{
+    struct face *fp = (struct face *)BU_PTBL_GET(faces, i);
+    struct faceuse *fu = fp->fu_p;
+
+    if (fu->orientation == OT_OPPOSITE)
+	fu = fu->fumate_p;
+    return fu;
+}
+
+
+static void
+crack_screen_worker(int UNUSED(cpu), void *arg)
+{
+    struct crack_screen_job *job = (struct crack_screen_job *)arg;
+
+    while (1) {
+	size_t start, end, p;
+
+	bu_semaphore_acquire(BU_SEM_GENERAL);
+	start = job->next;
+	job->next += NMG_CRACK_SCREEN_CHUNK;
+	bu_semaphore_release(BU_SEM_GENERAL);
+
+	if (start >= job->npairs)
+	    break;
+	end = (start + NMG_CRACK_SCREEN_CHUNK > job->npairs) ? job->npairs : start + NMG_CRACK_SCREEN_CHUNK;
+	for (p = start; p < end; p++) {
+	    struct faceuse *fu1 = crack_face_fu(job->faces1, job->pairs[p * 2]);
+	    struct faceuse *fu2 = crack_face_fu(job->faces2, job->pairs[p * 2 + 1]);
+
+	    job->skip[p] = (char)(nmg_no_isect_fu_pl(fu1, fu2, &job->tol) ||
+				  nmg_no_isect_fu_pl(fu2, fu1, &job->tol));
+	}
+    }
+}
+
+
+/**
+ * Flag the candidate face pairs that nmg_isect_two_generic_faces()
+ * is certain to reject because one face lies entirely on one side of
+ * the other's plane.  This only reads the shells, so it runs in
+ * parallel before any topology is changed.
+ *
+ * The faces gain vertices as earlier pairs are intersected, but those
+ * lie within the faces, and vertex fusing moves them by at most the
+ * distance tolerance; testing against a few times that tolerance
+ * keeps every flagged pair one that the serial intersector would also
+ * have rejected.
+ */
+static char *
+crack_screen_pairs(const long *pairs, size_t npairs, const struct bu_ptbl *faces1, const struct bu_ptbl *faces2, const struct bn_tol *tol)
+{
+    struct crack_screen_job job;
+    size_t ncpu = bu_avail_cpus();
+
+    job.faces1 = faces1;
+    job.faces2 = faces2;
+    job.pairs = pairs;
+    job.skip = (char *)bu_calloc(npairs, sizeof(char), "nmg_crackshells skip");
+    job.npairs = npairs;
+    job.next = 0;
+    job.tol = *tol; /* struct copy */
+    job.tol.dist = 4.0 * tol->dist;
+    job.tol.dist_sq = job.tol.dist * job.tol.dist;
+
+    if (ncpu > MAX_PSW)
+	ncpu = MAX_PSW;
+    if (ncpu < 2 || npairs < NMG_CRACK_PARALLEL_MIN_PAIRS) {
+	crack_screen_worker(0, &job);
+    } else {
+	bu_parallel(crack_screen_worker, ncpu, &job);
+    }
+
+    return job.skip;
+}
+
+
 /**
  * Split the components of two shells wherever they may intersect,
  * in preparation for performing boolean operations on the shells.
+ *
+ * Unless exhaustive is set (or the shells have few faces), only face
+ * pairs whose bounding boxes overlap (found with an R-tree) are
+ * intersected, in the same order as the exhaustive double loop.
  */
-void
-nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, const struct bn_tol *tol)
+static void
+crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, const struct bn_tol *tol, int exhaustive)
 {
     struct bu_ptbl faces1, faces2;
     struct bu_ptbl vert_list1, vert_list2;
@@ -6401,9 +6517,14 @@ nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, cons
     struct shell_a *sa1, *sa2;
     size_t i, j;
     point_t isect_min_pt, isect_max_pt;
+    long *pairs = NULL;
+    char *skip = NULL;
+    size_t npairs = 0, p = 0, ntested = 0;
+    int64_t start_time = 0;
 
     if (UNLIKELY(nmg_debug & NMG_DEBUG_POLYSECT)) {
 	bu_log("nmg_crackshells(s1=%p, s2=%p)\n", (void *)s1, (void *)s2);
+	start_time = bu_gettime();
     }
 
     /* initialize 'is' structure */
@@ -6464,6 +6585,19 @@ nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, cons
 	nmg_vshell(&s2->r_p->s_hd, s2->r_p);
     }
 
+    /* Gather the face pairs whose boxes come within a couple of
+     * tolerances of each other (faces only grow by fused vertices as
+     * they are cut), and screen out those that cannot touch while the
+     * shells are still unmodified.
+     */
+    if (BU_PTBL_LEN(&faces1) * BU_PTBL_LEN(&faces2) < NMG_CRACK_RTREE_MIN_PAIRS)
+	exhaustive = 1;
+    if (!exhaustive) {
+	npairs = nmg_face_bb_pairs(&pairs, &faces1, &faces2, 2.0 * tol->dist);
+	if (npairs)
+	    skip = crack_screen_pairs(pairs, npairs, &faces1, &faces2, tol);
+    }
+
     for (i = 0; i < (size_t)BU_PTBL_LEN(&faces1); i++) {
 	fp1 = (struct face *)BU_PTBL_GET(&faces1, i);
 	NMG_CK_FACE(fp1);
@@ -6478,6 +6612,14 @@ nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, cons
 	}
 
 	for (j = 0; j < (size_t)BU_PTBL_LEN(&faces2); j++) {
+	    if (!exhaustive) {
+		/* advance to the next candidate partner of fp1 */
+		while (p < npairs && (pairs[p * 2] < (long)i || (pairs[p * 2] == (long)i && (skip[p] || pairs[p * 2 + 1] < (long)j))))
+		    p++;
+		if (p >= npairs || pairs[p * 2] != (long)i)
+		    break;
+		j = (size_t)pairs[p * 2 + 1];
+	    }
 	    fp2 = (struct face *)BU_PTBL_GET(&faces2, j);
 	    NMG_CK_FACE(fp2);
 	    fu2 = fp2->fu_p;
@@ -6489,6 +6631,7 @@ nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, cons
 	    if (V3RPP_DISJOINT_TOL(fp2->min_pt, fp2->max_pt, isect_min_pt, isect_max_pt, tol->dist)) {
 		continue;
 	    }
+	    ntested++;
 	    nmg_isect_two_generic_faces(fu1, fu2, vlfree, tol);
 	}
 
@@ -6529,6 +6672,17 @@ nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, cons
 	}
     }
 
+    if (UNLIKELY(nmg_debug & NMG_DEBUG_POLYSECT)) {
+	bu_log("nmg_crackshells(): %s, %zu x %zu faces, %zu candidate pairs, %zu intersected, %g sec\n",
+	       exhaustive ? "exhaustive" : "rtree",
+	       BU_PTBL_LEN(&faces1), BU_PTBL_LEN(&faces2), npairs, ntested,
+	       (double)(bu_gettime() - start_time) / 1.0e6);
+    }
+
+    if (pairs)
+	bu_free(pairs, "nmg face bb pairs");
+    if (skip)
+	bu_free(skip, "nmg_crackshells skip");
     bu_ptbl_free(&faces1);
     bu_ptbl_free(&faces2);
 
@@ -6602,6 +6756,20 @@ nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, cons
 }
 
 
+void
+nmg_crackshells(struct shell *s1, struct shell *s2, struct bu_list *vlfree, const struct bn_tol *tol)
+{
+    crackshells(s1, s2, vlfree, tol, 0);
+}
+
+
+void
+nmg_crackshells_exhaustive(struct shell *s1, struct shell *s2, struct bu_list *vlfree, const struct bn_tol *tol)
+{
+    crackshells(s1, s2, vlfree, tol, 1);
+}
+
+
 int
 nmg_fu_touchingloops(const struct faceuse *fu)
 {
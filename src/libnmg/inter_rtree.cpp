@@ -0,0 +1,114 @@
+/*                 I N T E R _ R T R E E . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup nmg */
+/** @{ */
+/** @file libnmg/inter_rtree.cpp
+ *
+ * Find the pairs of faces from two shells whose bounding boxes
+ * overlap, using libbg's R-tree, so nmg_crackshells() only intersects
+ * faces that can touch.
+ *
+ * This file is separate from inter.c so that it can use the C++ R-tree
+ * template.
+ *
+ * Entry point (C linkage):
+ *   size_t nmg_face_bb_pairs(long **pairs,
+ *                            const struct bu_ptbl *faces1,
+ *                            const struct bu_ptbl *faces2,
+ *                            fastf_t margin)
+ *
+ * faces1 and faces2 are tables of struct face pointers.  Every face
+ * box is grown by margin before the overlap test.  The (i, j) index
+ * pairs come back in *pairs as 2*n longs, sorted by i and then j
+ * (the order of the exhaustive double loop), and the return value is
+ * n.  *pairs is NULL if n is zero; otherwise the caller frees it with
+ * bu_free().
+ */
+/** @} */
+
+#include "common.h"
+
+#include <set>
+#include <utility>
+
+#include "vmath.h"
+#include "bu/malloc.h"
+#include "bu/ptbl.h"
+#include "nmg.h"
+#include "../libbg/RTree.h"
+
+
+typedef RTree<long, fastf_t, 3> FaceTree;
+
+
+static void
+face_tree_build(FaceTree &tree, const struct bu_ptbl *faces, fastf_t margin)
+{
+    for (size_t i = 0; i < BU_PTBL_LEN(faces); i++) {
+	const struct face *fp = (const struct face *)BU_PTBL_GET(faces, i);
+	fastf_t fmin[3], fmax[3];
+
+	NMG_CK_FACE(fp);
+	VSETALL(fmin, -margin);
+	VADD2(fmin, fmin, fp->min_pt);
+	VSETALL(fmax, margin);
+	VADD2(fmax, fmax, fp->max_pt);
+	tree.Insert(fmin, fmax, (long)i);
+    }
+}
+
+
+extern "C" size_t
+nmg_face_bb_pairs(long **pairs, const struct bu_ptbl *faces1, const struct bu_ptbl *faces2, fastf_t margin)
+{
+    FaceTree tree1, tree2;
+    std::set<std::pair<long, long>> overlaps;
+    size_t n = 0;
+
+    *pairs = NULL;
+    if (!BU_PTBL_LEN(faces1) || !BU_PTBL_LEN(faces2))
+	return 0;
+
+    face_tree_build(tree1, faces1, margin);
+    face_tree_build(tree2, faces2, margin);
+    tree1.Overlaps(tree2, &overlaps);
+    if (overlaps.empty())
+	return 0;
+
+    *pairs = (long *)bu_malloc(overlaps.size() * 2 * sizeof(long), "nmg face bb pairs");
+    for (const std::pair<long, long> &p : overlaps) {
+	(*pairs)[n * 2] = p.first;
+	(*pairs)[n * 2 + 1] = p.second;
+	n++;
+    }
+
+    return n;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C++
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
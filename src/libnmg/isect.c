@@ -2319,6 +2319,7 @@ nmg_isect_ray_shell(struct nmg_ray_data *rd, const struct shell *s_p, struct bu_
     struct faceuse *fu_p;
     struct loopuse *lu_p;
     struct edgeuse *eu_p;
+    int culled = 0;
 
     if (nmg_debug & NMG_DEBUG_RT_ISECT)
 	bu_log("nmg_isect_ray_shell(%p, %p)\n", (void *)rd, (void *)s_p);
@@ -2339,8 +2340,23 @@ nmg_isect_ray_shell(struct nmg_ray_data *rd, const struct shell *s_p, struct bu_
 
     /* ray intersects shell, check sub-objects */
 
-    for (BU_LIST_FOR(fu_p, faceuse, &(s_p->fu_hd)))
-	isect_ray_faceuse(rd, fu_p, vlfree);
+    if (rd->rd_shell_faces) {
+	struct bu_ptbl faces;
+	size_t i;
+
+	/* the caller has a spatial index of the shell's faces; every
+	 * face it leaves out would be rejected by the bounding box test
+	 * in isect_ray_faceuse() anyway */
+	bu_ptbl_init(&faces, 64, "nmg_isect_ray_shell faces");
+	culled = rd->rd_shell_faces(rd, s_p, &faces);
+	for (i = 0; culled && i < BU_PTBL_LEN(&faces); i++)
+	    isect_ray_faceuse(rd, (struct faceuse *)BU_PTBL_GET(&faces, i), vlfree);
+	bu_ptbl_free(&faces);
+    }
+    if (!culled) {
+	for (BU_LIST_FOR(fu_p, faceuse, &(s_p->fu_hd)))
+	    isect_ray_faceuse(rd, fu_p, vlfree);
+    }
 
     for (BU_LIST_FOR(lu_p, loopuse, &(s_p->lu_hd)))
 	isect_ray_loopuse(rd, lu_p, vlfree);
@@ -2741,6 +2757,7 @@ nmg_class_ray_vs_shell(struct nmg_ray *rp, const struct shell *s, const int in_o
     rd.hitmiss = (struct nmg_hitmiss **)bu_calloc(rd.rd_m->maxindex,
 					      sizeof(struct nmg_hitmiss *), "nmg geom hit list");
     rd.classifying_ray = 1;
+    rd.rd_shell_faces = NULL;
 
     /* initialize the lists of things that have been hit/missed */
     BU_LIST_INIT(&rd.rd_hit);
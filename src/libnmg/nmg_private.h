@@ -30,8 +30,12 @@
 
 #include "common.h"
 #include "vmath.h"
+#include "bu/list.h"
+#include "bn/tol.h"
 #include "nmg/defines.h"
 
+__BEGIN_DECLS
+
 /**
  * @brief Internal routine to kill an edge geometry structure (of either
  * type), if all the edgeuses on its list have vanished.  Regardless,
@@ -58,6 +62,19 @@ NMG_EXPORT extern double nmg_vu_angle_measure(struct vertexuse   *vu,
                                               int in);
 
 
+/**
+ * nmg_crackshells() without the R-tree face pair culling: every face
+ * of s1 is intersected with every face of s2.  The culled crack must
+ * produce the same model, so the unit tests compare the two.
+ */
+NMG_EXPORT extern void nmg_crackshells_exhaustive(struct shell *s1,
+						  struct shell *s2,
+						  struct bu_list *vlfree,
+						  const struct bn_tol *tol);
+
+__END_DECLS
+
+
 /*
  * Local Variables:
  * tab-width: 8
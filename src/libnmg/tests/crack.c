@@ -0,0 +1,226 @@
+/*                       C R A C K . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file crack.c
+ *
+ * nmg_crackshells() on two overlapping faceted spheres, once with the
+ * R-tree face pair culling and once with the exhaustive double loop
+ * (nmg_crackshells_exhaustive()).  Both must produce the same model; the
+ * time taken by each is reported.
+ *
+ * Usage: crack [nlon nlat]
+ */
+
+#include "common.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/malloc.h"
+#include "nmg.h"
+#include "../nmg_private.h"
+
+
+/* Make a UV sphere shell of nlon x nlat facets in a new region of m */
+static void
+crack_mk_sphere(struct model *m, const point_t center, fastf_t radius, int nlon, int nlat, struct bu_list *vlfree, const struct bn_tol *tol)
+{
+    struct nmgregion *r = nmg_mrsv(m);
+    struct shell *s = BU_LIST_FIRST(shell, &r->s_hd);
+    struct vertex **v = (struct vertex **)bu_calloc((size_t)(nlat + 1) * nlon, sizeof(struct vertex *), "crack verts");
+    struct vertex **north = &v[(nlat - 1) * nlon];
+    struct vertex **south = &v[nlat * nlon];
+    struct bu_ptbl faces;
+    struct faceuse *fu;
+    int i, j;
+
+    bu_ptbl_init(&faces, 64, "crack faces");
+
+    /* bands of quads, then the triangle fans at the poles */
+    for (j = 0; j < nlat - 2; j++) {
+	for (i = 0; i < nlon; i++) {
+	    struct vertex **q[4];
+	    q[0] = &v[j * nlon + i];
+	    q[1] = &v[j * nlon + (i + 1) % nlon];
+	    q[2] = &v[(j + 1) * nlon + (i + 1) % nlon];
+	    q[3] = &v[(j + 1) * nlon + i];
+	    bu_ptbl_ins(&faces, (long *)nmg_cmface(s, q, 4));
+	}
+    }
+    for (i = 0; i < nlon; i++) {
+	struct vertex **t[3];
+	t[0] = north;
+	t[1] = &v[(i + 1) % nlon];
+	t[2] = &v[i];
+	bu_ptbl_ins(&faces, (long *)nmg_cmface(s, t, 3));
+	t[0] = south;
+	t[1] = &v[(nlat - 2) * nlon + i];
+	t[2] = &v[(nlat - 2) * nlon + (i + 1) % nlon];
+	bu_ptbl_ins(&faces, (long *)nmg_cmface(s, t, 3));
+    }
+
+    for (j = 0; j < nlat - 1; j++) {
+	fastf_t phi = M_PI * (j + 1) / nlat;
+	for (i = 0; i < nlon; i++) {
+	    fastf_t theta = M_2PI * i / nlon;
+	    point_t pt;
+	    VSET(pt, radius * sin(phi) * cos(theta), radius * sin(phi) * sin(theta), radius * cos(phi));
+	    VADD2(pt, pt, center);
+	    nmg_vertex_gv(v[j * nlon + i], pt);
+	}
+    }
+    {
+	point_t pt;
+	VSET(pt, center[X], center[Y], center[Z] + radius);
+	nmg_vertex_gv(*north, pt);
+	VSET(pt, center[X], center[Y], center[Z] - radius);
+	nmg_vertex_gv(*south, pt);
+    }
+
+    for (BU_LIST_FOR(fu, faceuse, &s->fu_hd)) {
+	if (fu->orientation == OT_SAME)
+	    nmg_fu_planeeqn(fu, tol);
+    }
+    nmg_gluefaces((struct faceuse **)BU_PTBL_BASEADDR(&faces), BU_PTBL_LEN(&faces), vlfree, tol);
+    nmg_region_a(r, tol);
+    nmg_fix_normals(s, vlfree, tol);
+
+    bu_ptbl_free(&faces);
+    bu_free(v, "crack verts");
+}
+
+
+/* Crack the two shells of m, with or without the face pair culling,
+ * returning the elapsed seconds */
+static double
+crack_run(struct model *m, int exhaustive, struct bu_list *vlfree, const struct bn_tol *tol)
+{
+    struct nmgregion *r1 = BU_LIST_FIRST(nmgregion, &m->r_hd);
+    struct nmgregion *r2 = BU_LIST_NEXT(nmgregion, &r1->l);
+    int64_t start = bu_gettime();
+
+    if (exhaustive)
+	nmg_crackshells_exhaustive(BU_LIST_FIRST(shell, &r1->s_hd), BU_LIST_FIRST(shell, &r2->s_hd), vlfree, tol);
+    else
+	nmg_crackshells(BU_LIST_FIRST(shell, &r1->s_hd), BU_LIST_FIRST(shell, &r2->s_hd), vlfree, tol);
+
+    return (double)(bu_gettime() - start) / 1.0e6;
+}
+
+
+/* Models cracked in the same order have the same structures, indices
+ * and vertex coordinates. */
+static int
+crack_same_model(const struct model *m1, const struct model *m2)
+{
+    struct nmg_struct_counts c1, c2;
+    uint32_t **p1, **p2;
+    long i;
+    int ret = 1;
+
+    if (m1->maxindex != m2->maxindex) {
+	bu_log("crack: maxindex %ld != %ld\n", m1->maxindex, m2->maxindex);
+	return 0;
+    }
+
+    p1 = nmg_m_struct_count(&c1, m1);
+    p2 = nmg_m_struct_count(&c2, m2);
+    if (c1.face != c2.face || c1.loop != c2.loop || c1.edge != c2.edge || c1.vertex != c2.vertex) {
+	bu_log("crack: %ld/%ld faces, %ld/%ld loops, %ld/%ld edges, %ld/%ld vertices\n",
+	       c1.face, c2.face, c1.loop, c2.loop, c1.edge, c2.edge, c1.vertex, c2.vertex);
+	ret = 0;
+    }
+    for (i = 0; ret && i < m1->maxindex; i++) {
+	if (!p1[i] != !p2[i] || (p1[i] && *p1[i] != *p2[i])) {
+	    bu_log("crack: structure %ld differs\n", i);
+	    ret = 0;
+	} else if (p1[i] && *p1[i] == NMG_VERTEX_G_MAGIC
+		   && !VNEAR_EQUAL(((struct vertex_g *)p1[i])->coord, ((struct vertex_g *)p2[i])->coord, SMALL_FASTF)) {
+	    bu_log("crack: vertex_g %ld moved\n", i);
+	    ret = 0;
+	}
+    }
+
+    bu_free(p1, "nmg_m_struct_count");
+    bu_free(p2, "nmg_m_struct_count");
+    return ret;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    struct bn_tol tol = BN_TOL_INIT_TOL;
+    struct bu_list vlfree;
+    struct model *m, *mref;
+    int nlon = 24, nlat = 12;
+    point_t c1 = VINIT_ZERO;
+    point_t c2 = {37.0, 23.0, 11.0};
+    double t_rtree, t_exhaustive;
+
+    // the program name is still unset.
+    if (bu_getprogname()[0] == '\0')
+	bu_setprogname(argv[0]);
+
+    if (argc == 3) {
+	nlon = atoi(argv[1]);
+	nlat = atoi(argv[2]);
+    } else if (argc != 1) {
+	bu_exit(1, "Usage: %s [nlon nlat]\n", argv[0]);
+    }
+    if (nlon < 3 || nlat < 3)
+	bu_exit(1, "crack: need at least 3x3 facets\n");
+
+    BU_LIST_INIT(&vlfree);
+    if (!BU_LIST_IS_INITIALIZED(&re_nmgfree))
+	BU_LIST_INIT(&re_nmgfree);
+
+    m = nmg_mm();
+    crack_mk_sphere(m, c1, 50.0, nlon, nlat, &vlfree, &tol);
+    crack_mk_sphere(m, c2, 40.0, nlon, nlat, &vlfree, &tol);
+    mref = nmg_clone_model(m);
+
+    t_rtree = crack_run(m, 0, &vlfree, &tol);
+    t_exhaustive = crack_run(mref, 1, &vlfree, &tol);
+
+    bu_log("crack: %dx%d facet spheres, exhaustive %.4f sec, rtree %.4f sec\n",
+	   nlon, nlat, t_exhaustive, t_rtree);
+
+    if (!crack_same_model(m, mref))
+	bu_exit(1, "crack: R-tree culled crack differs from exhaustive crack\n");
+
+    nmg_km(m);
+    nmg_km(mref);
+    BV_FREE_VLIST(&vlfree, &vlfree);
+
+    bu_log("All unit tests succeeded.\n");
+    return 0;
+}
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
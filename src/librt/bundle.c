@@ -83,7 +83,7 @@ rt_shootray_bundle(struct application *ap, struct xray *rays, int nrays)
     const char *status;
     struct partition InitialPart;	/* Head of Initial Partitions */
     struct partition FinalPart;	/* Head of Final Partitions */
-    struct soltab **stpp;
+    size_t nsol;
     register const union cutter *cutp;
     struct resource *resp;
     struct rt_i *rtip;
@@ -139,7 +139,7 @@ rt_shootray_bundle(struct application *ap, struct xray *rays, int nrays)
     BU_LIST_INIT(&finished_segs.l);
     ap->a_finished_segs_hdp = &finished_segs;
 
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_parthead)) {
+    if (!BU_LIST_IS_INITIALIZED(&resp->re_solid_bitv)) {
 	/* XXX This shouldn't happen any more */
 	bu_log("rt_shootray_bundle() resp=%p uninitialized, fixing it\n", (void *)resp);
 	/*
@@ -284,19 +284,26 @@ rt_shootray_bundle(struct application *ap, struct xray *rays, int nrays)
 	    rt_pr_cut(cutp, 0);
 	}
 
-	if (cutp->bn.bn_len <= 0) {
+	if (cutp->bn.bn_len <= 0 && cutp->bn.bn_piecelen <= 0) {
 	    /* Push ray onwards to next box */
 	    ss.box_start = ss.box_end;
 	    resp->re_nempty_cells++;
 	    continue;
 	}
 
-	/* Consider all objects within the box */
-	stpp = &(cutp->bn.bn_list[cutp->bn.bn_len-1]);
-	for (; stpp >= cutp->bn.bn_list; stpp--) {
-	    register struct soltab *stp = *stpp;
+	/* Consider all objects within the box.  Solids listed by
+	 * pieces are shot whole, there is no piece state per ray of a
+	 * bundle.
+	 */
+	for (nsol = cutp->bn.bn_len + cutp->bn.bn_piecelen; nsol-- > 0;) {
+	    register struct soltab *stp;
 	    int ray;
 
+	    if (nsol < cutp->bn.bn_len)
+		stp = cutp->bn.bn_list[nsol];
+	    else
+		stp = cutp->bn.bn_piecelist[nsol - cutp->bn.bn_len].stp;
+
 	    if (BU_BITTEST(solidbits, stp->st_bit)) {
 		resp->re_ndup++;
 		continue;	/* already shot */
@@ -315,7 +322,7 @@ rt_shootray_bundle(struct application *ap, struct xray *rays, int nrays)
 		VJOIN1(ss2_newray.r_pt, rays[ray].r_pt, ss.dist_corr, ss2_newray.r_dir);
 
 		/* Check against bounding RPP, if desired by solid */
-		if (OBJ[stp->st_id].ft_use_rpp) {
+		if (stp->st_meth->ft_use_rpp) {
 		    if (!rt_in_rpp(&ss2_newray, ss.inv_dir,
 				   stp->st_min, stp->st_max)) {
 			if (debug_shoot)bu_log("rpp miss %s by ray %d\n", stp->st_name, ray);
@@ -335,8 +342,8 @@ rt_shootray_bundle(struct application *ap, struct xray *rays, int nrays)
 		BU_LIST_INIT(&(new_segs.l));
 
 		ret = -1;
-		if (OBJ[stp->st_id].ft_shot) {
-		    ret = OBJ[stp->st_id].ft_shot(stp, &ss2_newray, ap, &new_segs);
+		if (stp->st_meth->ft_shot) {
+		    ret = stp->st_meth->ft_shot(stp, &ss2_newray, ap, &new_segs);
 		}
 		if (ret <= 0) {
 		    resp->re_shot_miss++;
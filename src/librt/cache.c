@@ -75,7 +75,7 @@ struct rt_cache {
     int semaphore;
     int (*log)(const char *format, ...);
     int (*debug)(const char *format, ...);
-    struct bu_hash_tbl *entry_hash;
+    bu_ohash *entry_hash;
 };
 #define CACHE_INIT {{0}, 0, 0, bu_log, NULL, NULL}
 
@@ -221,7 +221,7 @@ cache_generate_name(char name[STATIC_ARRAY(37)], const struct soltab *stp)
     if (bu_uuid_create(namespace_uuid, sizeof(mat_buffer), mat_buffer, base_namespace_uuid) != 5)
 	return 0; /*bu_bomb("bu_uuid_create() failed");*/
 
-    if (db_get_external(&raw_external, stp->st_dp, stp->st_rtip->rti_dbip))
+    if (db_get_external_view(&raw_external, stp->st_dp, stp->st_rtip->rti_dbip))
 	return 0; /*bu_bomb("db_get_external() failed");*/
 
     if (db5_get_raw_internal_ptr(&raw_internal, raw_external.ext_buf) == NULL)
@@ -233,7 +233,7 @@ cache_generate_name(char name[STATIC_ARRAY(37)], const struct soltab *stp)
     if (bu_uuid_encode(uuid, (uint8_t *)name))
 	return 0; /*bu_bomb("bu_uuid_encode() failed");*/
 
-    bu_free_external(&raw_external);
+    db_free_external(&raw_external, stp->st_rtip->rti_dbip);
     return 1;
 }
 
@@ -333,7 +333,8 @@ cache_init(struct rt_cache *cache)
     }
 
     /* initialize database instance pointer storage */
-    cache->entry_hash = bu_hash_create(1024);
+    /* concurrent, so cache hits don't need the cache semaphore */
+    cache->entry_hash = bu_ohash_create(1024, BU_OHASH_CONCURRENT);
 
     cache->semaphore = bu_semaphore_register("SEM_CACHE");
 
@@ -416,9 +417,14 @@ cache_read_entry(const struct rt_cache *cache, const char *name)
     if (!cache || !name)
 	return NULL;
 
+    e = (struct rt_cache_entry *)bu_ohash_get(cache->entry_hash, (const uint8_t *)name, strlen(name));
+    if (e)
+	return e;
+
     bu_semaphore_acquire(cache->semaphore);
 
-    e = (struct rt_cache_entry *)bu_hash_get(cache->entry_hash, (const uint8_t *)name, strlen(name));
+    /* another thread may have read it while we waited */
+    e = (struct rt_cache_entry *)bu_ohash_get(cache->entry_hash, (const uint8_t *)name, strlen(name));
     if (e) {
 	bu_semaphore_release(cache->semaphore);
 	return e;
@@ -432,6 +438,7 @@ cache_read_entry(const struct rt_cache *cache, const char *name)
 
     fbytes = bu_file_size(path);
     if (fbytes <= 0) {
+	bu_semaphore_release(cache->semaphore);
 	return NULL;
     }
     BU_GET(e, struct rt_cache_entry);
@@ -449,7 +456,7 @@ cache_read_entry(const struct rt_cache *cache, const char *name)
 	return NULL;
     }
     e->ext->ext_buf = (uint8_t *)(e->mfp->buf);
-    bu_hash_set(cache->entry_hash, (const uint8_t *)name, strlen(name), e);
+    bu_ohash_set(cache->entry_hash, (const uint8_t *)name, strlen(name), e);
 
     bu_semaphore_release(cache->semaphore);
 
@@ -466,7 +473,7 @@ cache_create_dir(const struct rt_cache *cache, const char *name)
     if (!cache || !name)
 	return 0;
 
-    e = (struct rt_cache_entry *)bu_hash_get(cache->entry_hash, (const uint8_t *)name, strlen(name));
+    e = (struct rt_cache_entry *)bu_ohash_get(cache->entry_hash, (const uint8_t *)name, strlen(name));
     if (e) {
 	return 1;
     }
@@ -737,22 +744,21 @@ rt_cache_prep(struct rt_cache *cache, struct soltab *stp, struct rt_db_internal
 void
 rt_cache_close(struct rt_cache *cache)
 {
-    struct bu_hash_entry *entry;
+    size_t pos = 0;
+    void *val;
 
     if (!cache)
 	return;
 
     CACHE_DEBUG("++ [%lu.%lu] Closing cache at %s\n", bu_pid(), bu_parallel_id(), cache->dir);
 
-    entry = bu_hash_next(cache->entry_hash, NULL);
-    while (entry) {
-	struct rt_cache_entry *e = (struct rt_cache_entry *)bu_hash_value(entry, NULL);
+    while (bu_ohash_next(cache->entry_hash, &pos, NULL, NULL, NULL, &val)) {
+	struct rt_cache_entry *e = (struct rt_cache_entry *)val;
 	bu_close_mapped_file(e->mfp);
 	BU_PUT(e->ext, struct bu_external);
 	BU_PUT(e, struct rt_cache);
-	entry = bu_hash_next(cache->entry_hash, entry);
     }
-    bu_hash_destroy(cache->entry_hash);
+    bu_ohash_destroy(cache->entry_hash);
 
     cache->debug = NULL;
     cache->log = NULL;
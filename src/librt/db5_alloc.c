@@ -161,7 +161,7 @@ db5_realloc(struct db_i *dbip, struct directory *dp, struct bu_external *ep)
 	if (db5_write_free(dbip, dp, dp->d_len) < 0) return -1;
 
 	/* Finally, update tables */
-	rt_memfree(&(dbip->i->dbi_freep), dp->d_len, dp->d_addr);
+	(void)db_freemap_free(dbip->i->dbi_freemap, dp->d_len, dp->d_addr);
 	dp->d_addr = baseaddr;
 	dp->d_len = ep->ext_nbytes;
 	return 0;
@@ -175,42 +175,41 @@ db5_realloc(struct db_i *dbip, struct directory *dp, struct bu_external *ep)
 	    bu_log("db5_realloc(%s) releasing storage at %jd, len=%zu\n",
 		   dp->d_namep, (intmax_t)dp->d_addr, dp->d_len);
 
-	rt_memfree(&(dbip->i->dbi_freep), dp->d_len, dp->d_addr);
+	(void)db_freemap_free(dbip->i->dbi_freemap, dp->d_len, dp->d_addr);
 	if (db5_write_free(dbip, dp, dp->d_len) < 0) return -1;
 	dp->d_addr = RT_DIR_PHONY_ADDR;	/* sanity */
     }
 
     /*
      * Can we obtain a free block somewhere else?  Keep in mind that
-     * free blocks may be very large (e.g. 50 MBytes).
+     * free blocks may be very large (e.g. 50 MBytes).  While a write
+     * batch is open, skip this so the batch stays one contiguous run
+     * at the end of the file.
      */
-    {
-	struct mem_map *mmp;
+    if (!dbip->i->dbi_batch_depth) {
 	b_off_t newaddr;
+	size_t blksize;
 
-	if ((mmp = rt_memalloc_nosplit(&(dbip->i->dbi_freep), ep->ext_nbytes)) != MAP_NULL) {
+	if (db_freemap_alloc_block(dbip->i->dbi_freemap, ep->ext_nbytes, &newaddr, &blksize) == 0) {
 	    if (RT_G_DEBUG&RT_DEBUG_DB)
 		bu_log("db5_realloc(%s) obtained free block at %jd, len=%zu\n",
-		       dp->d_namep, (intmax_t)mmp->m_addr, mmp->m_size);
-	    BU_ASSERT((size_t)mmp->m_size >= (size_t)ep->ext_nbytes);
-	    if ((size_t)mmp->m_size == (size_t)ep->ext_nbytes) {
+		       dp->d_namep, (intmax_t)newaddr, blksize);
+	    BU_ASSERT(blksize >= (size_t)ep->ext_nbytes);
+	    if (blksize == (size_t)ep->ext_nbytes) {
 		/* No need to reformat, existing free object is perfect */
-		dp->d_addr = mmp->m_addr;
+		dp->d_addr = newaddr;
 		dp->d_len = ep->ext_nbytes;
 		return 0;
 	    }
-	    newaddr = mmp->m_addr;
-	    if ((size_t)mmp->m_size > (size_t)ep->ext_nbytes) {
-		/* Reformat and free the surplus */
-		dp->d_addr = mmp->m_addr + (b_off_t)ep->ext_nbytes;
-		dp->d_len = mmp->m_size - ep->ext_nbytes;
-		if (RT_G_DEBUG&RT_DEBUG_DB)
-		    bu_log("db5_realloc(%s) returning surplus at %jd, len=%zu\n",
-			   dp->d_namep, (intmax_t)dp->d_addr, dp->d_len);
-		if (db5_write_free(dbip, dp, dp->d_len) < 0) return -1;
-		rt_memfree(&(dbip->i->dbi_freep), dp->d_len, dp->d_addr);
-		/* mmp is invalid beyond here! */
-	    }
+	    /* Reformat and free the surplus */
+	    dp->d_addr = newaddr + (b_off_t)ep->ext_nbytes;
+	    dp->d_len = blksize - ep->ext_nbytes;
+	    if (RT_G_DEBUG&RT_DEBUG_DB)
+		bu_log("db5_realloc(%s) returning surplus at %jd, len=%zu\n",
+		       dp->d_namep, (intmax_t)dp->d_addr, dp->d_len);
+	    if (db5_write_free(dbip, dp, dp->d_len) < 0) return -1;
+	    (void)db_freemap_free(dbip->i->dbi_freemap, dp->d_len, dp->d_addr);
+
 	    dp->d_addr = newaddr;
 	    dp->d_len = ep->ext_nbytes;
 	    /* Erase the new place */
@@ -233,6 +232,145 @@ db5_realloc(struct db_i *dbip, struct directory *dp, struct bu_external *ep)
 }
 
 
+
+static int
+db_compact_cmp(const void *a, const void *b)
+{
+    const struct directory *da = *(const struct directory * const *)a;
+    const struct directory *db = *(const struct directory * const *)b;
+
+    if (da->d_addr < db->d_addr)
+	return -1;
+    return (da->d_addr > db->d_addr);
+}
+
+
+int
+db_compact(struct db_i *dbip, size_t *reclaimed)
+{
+    struct directory **dirs;
+    struct directory *dp;
+    struct directory hole;
+    b_off_t cursor = (b_off_t)8;	/* end of the v5 header object */
+    b_off_t eof;
+    size_t count = 0;
+    size_t i;
+    int ret = 0;
+
+    RT_CK_DBI(dbip);
+
+    if (reclaimed)
+	*reclaimed = 0;
+
+    if (db_version(dbip) != 5) {
+	bu_log("db_compact(%s) only v5 databases can be compacted\n", dbip->dbi_filename);
+	return -1;
+    }
+    if (dbip->dbi_read_only || !dbip->i->dbi_fp || dbip->i->dbi_inmem) {
+	bu_log("db_compact(%s) database is not writable\n", dbip->dbi_filename);
+	return -1;
+    }
+    if (dbip->i->dbi_batch_depth) {
+	bu_log("db_compact(%s) a write batch is open\n", dbip->dbi_filename);
+	return -1;
+    }
+    if (dbip->i->dbi_eof == RT_DIR_PHONY_ADDR && db_dirbuild(dbip))
+	return -1;
+
+    FOR_ALL_DIRECTORY_START(dp, dbip) {
+	count++;
+    } FOR_ALL_DIRECTORY_END;
+    dirs = (struct directory **)bu_calloc(count + 1, sizeof(struct directory *), "db_compact dirs");
+
+    count = 0;
+    FOR_ALL_DIRECTORY_START(dp, dbip) {
+	if (dp->d_flags & RT_DIR_INMEM || dp->d_addr == RT_DIR_PHONY_ADDR || dp->d_len == 0)
+	    continue;
+	dirs[count++] = dp;
+    } FOR_ALL_DIRECTORY_END;
+    qsort(dirs, count, sizeof(struct directory *), db_compact_cmp);
+
+    memset(&hole, 0, sizeof(hole));
+    hole.d_magic = RT_DIR_MAGIC;
+
+    for (i = 0; i < count; i++) {
+	struct bu_external ext;
+	b_off_t oldaddr;
+
+	dp = dirs[i];
+	if (dp->d_addr < cursor) {
+	    bu_log("db_compact(%s) %s at %jd overlaps the object before it\n",
+		   dbip->dbi_filename, dp->d_namep, (intmax_t)dp->d_addr);
+	    ret = -1;
+	    break;
+	}
+	if (dp->d_addr == cursor) {
+	    cursor += (b_off_t)dp->d_len;
+	    continue;
+	}
+
+	if (db_get_external(&ext, dp, dbip) < 0) {
+	    ret = -1;
+	    break;
+	}
+	if (db_write(dbip, ext.ext_buf, ext.ext_nbytes, cursor) < 0) {
+	    bu_free_external(&ext);
+	    ret = -1;
+	    break;
+	}
+	bu_free_external(&ext);
+
+	/* Everything from the end of the new copy to the end of the
+	 * old one is now garbage; keep the file scannable. */
+	oldaddr = dp->d_addr;
+	dp->d_addr = cursor;
+	hole.d_addr = cursor + (b_off_t)dp->d_len;
+	hole.d_len = (size_t)(oldaddr - cursor);
+	if (db5_write_free(dbip, &hole, hole.d_len) < 0) {
+	    ret = -1;
+	    break;
+	}
+	cursor += (b_off_t)dp->d_len;
+    }
+    bu_free(dirs, "db_compact dirs");
+
+    /* Whatever lies past the cursor is free, whether or not every
+     * object could be moved; the map is rebuilt to match. */
+    db_freemap_clear(dbip->i->dbi_freemap);
+    if (ret < 0) {
+	bu_log("db_compact(%s) stopped at %jd, the rest of the file was not compacted\n",
+	       dbip->dbi_filename, (intmax_t)cursor);
+	return -1;
+    }
+
+    eof = dbip->i->dbi_eof;
+    if (cursor >= eof)
+	return 0;
+
+    fflush(dbip->i->dbi_fp);
+#if defined(HAVE_FTRUNCATE) && defined(HAVE_FILENO)
+    bu_semaphore_acquire(BU_SEM_SYSCALL);
+    ret = ftruncate(fileno(dbip->i->dbi_fp), (off_t)cursor);
+    bu_semaphore_release(BU_SEM_SYSCALL);
+    if (ret == 0) {
+	dbip->i->dbi_eof = cursor;
+	dbip->i->dbi_nrec = count;
+	if (reclaimed)
+	    *reclaimed = (size_t)(eof - cursor);
+	return 0;
+    }
+    bu_log("db_compact(%s) unable to truncate the file, leaving the space free\n", dbip->dbi_filename);
+#endif
+
+    hole.d_addr = cursor;
+    hole.d_len = (size_t)(eof - cursor);
+    if (db5_write_free(dbip, &hole, hole.d_len) < 0)
+	return -1;
+    (void)db_freemap_free(dbip->i->dbi_freemap, hole.d_len, hole.d_addr);
+    dbip->i->dbi_nrec = count + 1;
+    return 0;
+}
+
 /** @} */
 /*
  * Local Variables:
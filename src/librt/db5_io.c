@@ -1002,11 +1002,11 @@ rt_db_get_internal5(
 
     BU_ASSERT(dbip->i->dbi_version == 5);
 
-    if (db_get_external(&ext, dp, dbip) < 0)
+    if (db_get_external_view(&ext, dp, dbip) < 0)
 	return -2;		/* FAIL */
 
     ret = rt_db_external5_to_internal5(ip, &ext, dp->d_namep, dbip, mat);
-    bu_free_external(&ext);
+    db_free_external(&ext, dbip);
     return ret;
 }
 
@@ -1069,22 +1069,22 @@ db5_get_attributes(const struct db_i *dbip, struct bu_attribute_value_set *avs,
 
     BU_AVS_INIT(avs);
 
-    if (db_get_external(&ext, dp, dbip) < 0)
+    if (db_get_external_view(&ext, dp, dbip) < 0)
 	return -1;		/* FAIL */
 
     if (db5_get_raw_internal_ptr(&raw, ext.ext_buf) == NULL) {
-	bu_free_external(&ext);
+	db_free_external(&ext, dbip);
 	return -2;
     }
 
     if (raw.attributes.ext_buf) {
 	if (db5_import_attributes(avs, &raw.attributes) < 0) {
-	    bu_free_external(&ext);
+	    db_free_external(&ext, dbip);
 	    return -3;
 	}
     }
 
-    bu_free_external(&ext);
+    db_free_external(&ext, dbip);
     return 0;
 }
 
@@ -225,8 +225,7 @@ db_diradd5(
     dp->d_animate = NULL;
     dp->d_nref = 0;
     dp->d_uses = 0;
-    dp->d_forw = *headp;
-    *headp = dp;
+    db_dirlink(dbip, dp);
 
     if (BU_PTBL_IS_INITIALIZED(&dbip->i->dbi_changed_clbks)) {
 	for (size_t i = 0; i < BU_PTBL_LEN(&dbip->i->dbi_changed_clbks); i++) {
@@ -312,8 +311,7 @@ db5_diradd(struct db_i *dbip,
     dp->d_animate = NULL;
     dp->d_nref = 0;
     dp->d_uses = 0;
-    dp->d_forw = *headp;
-    *headp = dp;
+    db_dirlink(dbip, dp);
 
     if (BU_PTBL_IS_INITIALIZED(&dbip->i->dbi_changed_clbks)) {
 	for (size_t i = 0; i < BU_PTBL_LEN(&dbip->i->dbi_changed_clbks); i++) {
@@ -343,7 +341,7 @@ db5_diradd_handler(
     if (rip->h_dli == DB5HDR_HFLAGS_DLI_HEADER_OBJECT) return;
     if (rip->h_dli == DB5HDR_HFLAGS_DLI_FREE_STORAGE) {
 	/* Record available free storage */
-	rt_memfree(&(dbip->i->dbi_freep), rip->object_length, laddr);
+	(void)db_freemap_free(dbip->i->dbi_freemap, rip->object_length, laddr);
 	return;
     }
 
@@ -46,8 +46,7 @@
 int
 db_alloc(register struct db_i *dbip, register struct directory *dp, size_t count)
 {
-    size_t len;
-    union record rec;
+    b_off_t addr;
 
     RT_CK_DBI(dbip);
     RT_CK_DIR(dp);
@@ -73,29 +72,18 @@ db_alloc(register struct db_i *dbip, register struct directory *dp, size_t count
 	bu_log("db_alloc on READ-ONLY file\n");
 	return -1;
     }
-    while (1) {
-	len = rt_memalloc(&(dbip->i->dbi_freep), (unsigned)count);
-	if (len == 0L) {
-	    /* No contiguous free block, append to file */
-	    if ((dp->d_addr = dbip->i->dbi_eof) == RT_DIR_PHONY_ADDR) {
-		bu_log("db_alloc: bad EOF\n");
-		return -1;
-	    }
-	    dp->d_len = count;
-	    dbip->i->dbi_eof += (b_off_t)(count * sizeof(union record));
-	    dbip->i->dbi_nrec += count;
-	    break;
-	}
-	dp->d_addr = (b_off_t)(len * sizeof(union record));
-	dp->d_len = count;
-	if (db_get(dbip, dp, &rec, 0, 1) < 0)
+    if (db_freemap_alloc(dbip->i->dbi_freemap, count, &addr) < 0) {
+	/* No contiguous free block, append to file */
+	if ((dp->d_addr = dbip->i->dbi_eof) == RT_DIR_PHONY_ADDR) {
+	    bu_log("db_alloc: bad EOF\n");
 	    return -1;
-	if (rec.u_id != ID_FREE) {
-	    bu_log("db_alloc():  len %zu non-FREE (id %d), skipping\n",
-		   len, rec.u_id);
-	    continue;
 	}
+	dbip->i->dbi_eof += (b_off_t)(count * sizeof(union record));
+	dbip->i->dbi_nrec += count;
+    } else {
+	dp->d_addr = (b_off_t)(addr * sizeof(union record));
     }
+    dp->d_len = count;
 
     /* Clear out ALL the granules, for safety */
     return db_zapper(dbip, dp, 0);
@@ -148,10 +136,10 @@ db_delete(struct db_i *dbip, struct directory *dp)
 
     if (db_version(dbip) == 4) {
 	i = db_zapper(dbip, dp, 0);
-	rt_memfree(&(dbip->i->dbi_freep), (unsigned)dp->d_len, dp->d_addr/(sizeof(union record)));
+	(void)db_freemap_free(dbip->i->dbi_freemap, dp->d_len, dp->d_addr/(sizeof(union record)));
     } else if (db_version(dbip) == 5) {
 	i = db5_write_free(dbip, dp, dp->d_len);
-	rt_memfree(&(dbip->i->dbi_freep), dp->d_len, dp->d_addr);
+	(void)db_freemap_free(dbip->i->dbi_freemap, dp->d_len, dp->d_addr);
     } else {
 	bu_bomb("db_delete() unsupported database version\n");
     }
@@ -239,31 +227,63 @@ db_alloc_dir_block(struct db_i *dbip)
     }
 }
 
+/* Slab constructors and destructors for the ray resource structures.
+ * Counts of constructed structures are kept in re_seglen/re_partlen,
+ * which rt reports in its resource summary. */
+static void
+rt_seg_ctor(void *obj, void *data)
+{
+    struct seg *sp = (struct seg *)obj;
+    struct resource *res = (struct resource *)data;
+
+    sp->l.magic = RT_SEG_MAGIC;
+    res->re_seglen++;
+}
+
+
+static void
+rt_seg_dtor(void *UNUSED(obj), void *data)
+{
+    struct resource *res = (struct resource *)data;
+
+    res->re_seglen--;
+}
+
+
+static void
+rt_part_ctor(void *obj, void *data)
+{
+    struct partition *pp = (struct partition *)obj;
+    struct resource *res = (struct resource *)data;
+
+    pp->pt_magic = PT_MAGIC;
+    bu_ptbl_init(&pp->pt_seglist, 42, "pt_seglist ptbl");
+    res->re_partlen++;
+}
+
+
+static void
+rt_part_dtor(void *obj, void *data)
+{
+    struct partition *pp = (struct partition *)obj;
+    struct resource *res = (struct resource *)data;
+
+    bu_ptbl_free(&pp->pt_seglist);
+    res->re_partlen--;
+}
+
+
 void
 rt_alloc_seg_block(register struct resource *res)
 {
-    register struct seg *sp;
-    size_t bytes;
-
     RT_CK_RESOURCE(res);
 
-    if (!BU_LIST_IS_INITIALIZED(&res->re_seg)) {
-	BU_LIST_INIT(&(res->re_seg));
-	bu_ptbl_init(&res->re_seg_blocks, 64, "re_seg_blocks ptbl");
-    }
-    bytes = bu_malloc_len_roundup(64*sizeof(struct seg));
-    sp = (struct seg *)bu_malloc(bytes, "rt_alloc_seg_block()");
-    bu_ptbl_ins(&res->re_seg_blocks, (long *)sp);
-    while (bytes >= sizeof(struct seg)) {
-	sp->l.magic = RT_SEG_MAGIC;
-	BU_LIST_INSERT(&(res->re_seg), &(sp->l));
-	res->re_seglen++;
-	sp++;
-	bytes -= sizeof(struct seg);
-    }
+    if (!res->re_seg_slab)
+	res->re_seg_slab = bu_slab_create(sizeof(struct seg), 0, rt_seg_ctor, rt_seg_dtor, res);
+    if (!res->re_part_slab)
+	res->re_part_slab = bu_slab_create(sizeof(struct partition), 0, rt_part_ctor, rt_part_dtor, res);
 }
 
-
 /** @} */
 
 /*
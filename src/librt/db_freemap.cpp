@@ -0,0 +1,178 @@
+/*                   D B _ F R E E M A P . C P P
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/db_freemap.cpp
+ *
+ * Free space index of a database file.
+ *
+ * Free blocks are kept twice: keyed by address, for coalescing with
+ * their neighbors when space is returned, and keyed by (size,
+ * address), for best fit allocation.  Both operations are O(log n)
+ * in the number of free blocks, where the mem_map list used before
+ * walked every block.  The units are whatever the caller uses (bytes
+ * for v5 databases, granules for v4).
+ */
+
+#include "common.h"
+
+#include <iterator>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "bu/log.h"
+#include "raytrace.h"
+#include "librt_private.h"
+
+
+struct db_freemap {
+    std::map<b_off_t, size_t> by_addr;
+    std::set<std::pair<size_t, b_off_t> > by_size;
+};
+
+
+struct db_freemap *
+db_freemap_create(void)
+{
+    return new db_freemap;
+}
+
+
+void
+db_freemap_destroy(struct db_freemap *fm)
+{
+    delete fm;
+}
+
+
+void
+db_freemap_clear(struct db_freemap *fm)
+{
+    if (!fm)
+	return;
+    fm->by_addr.clear();
+    fm->by_size.clear();
+}
+
+
+int
+db_freemap_free(struct db_freemap *fm, size_t size, b_off_t addr)
+{
+    if (!fm || size == 0)
+	return 0;
+
+    std::map<b_off_t, size_t>::iterator next = fm->by_addr.lower_bound(addr);
+    std::map<b_off_t, size_t>::iterator prev = fm->by_addr.end();
+    if (next != fm->by_addr.begin())
+	prev = std::prev(next);
+
+    /* Freeing space that is already free means the caller's idea of
+     * the file is wrong; refuse rather than hand the space out twice. */
+    if ((prev != fm->by_addr.end() && prev->first + (b_off_t)prev->second > addr)
+	|| (next != fm->by_addr.end() && addr + (b_off_t)size > next->first)) {
+	bu_log("db_freemap_free(addr=%jd, size=%zu) ERROR overlaps free space\n",
+	       (intmax_t)addr, size);
+	return -1;
+    }
+
+    if (prev != fm->by_addr.end() && prev->first + (b_off_t)prev->second == addr) {
+	fm->by_size.erase(std::make_pair(prev->second, prev->first));
+	addr = prev->first;
+	size += prev->second;
+	fm->by_addr.erase(prev);
+    }
+    if (next != fm->by_addr.end() && addr + (b_off_t)size == next->first) {
+	fm->by_size.erase(std::make_pair(next->second, next->first));
+	size += next->second;
+	fm->by_addr.erase(next);
+    }
+
+    fm->by_addr[addr] = size;
+    fm->by_size.insert(std::make_pair(size, addr));
+    return 0;
+}
+
+
+int
+db_freemap_alloc_block(struct db_freemap *fm, size_t size, b_off_t *addr, size_t *blksize)
+{
+    if (!fm || size == 0)
+	return -1;
+
+    /* smallest block that fits, lowest address among equals */
+    std::set<std::pair<size_t, b_off_t> >::iterator it = fm->by_size.lower_bound(std::make_pair(size, (b_off_t)0));
+    if (it == fm->by_size.end())
+	return -1;
+
+    *addr = it->second;
+    *blksize = it->first;
+    fm->by_addr.erase(it->second);
+    fm->by_size.erase(it);
+    return 0;
+}
+
+
+int
+db_freemap_alloc(struct db_freemap *fm, size_t size, b_off_t *addr)
+{
+    size_t blksize;
+
+    if (db_freemap_alloc_block(fm, size, addr, &blksize) < 0)
+	return -1;
+
+    /* hand back the tail */
+    if (blksize > size) {
+	b_off_t rest = *addr + (b_off_t)size;
+	fm->by_addr[rest] = blksize - size;
+	fm->by_size.insert(std::make_pair(blksize - size, rest));
+    }
+    return 0;
+}
+
+
+size_t
+db_freemap_stats(const struct db_freemap *fm, size_t *total, size_t *largest)
+{
+    if (total)
+	*total = 0;
+    if (largest)
+	*largest = 0;
+    if (!fm)
+	return 0;
+
+    if (total) {
+	for (std::map<b_off_t, size_t>::const_iterator it = fm->by_addr.begin(); it != fm->by_addr.end(); ++it)
+	    *total += it->second;
+    }
+    if (largest && !fm->by_size.empty())
+	*largest = fm->by_size.rbegin()->first;
+    return fm->by_addr.size();
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C++
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -27,6 +27,7 @@
 
 #include "common.h"
 
+#include <errno.h>
 #include <string.h>
 #ifdef HAVE_SYS_TYPES_H
 #  include <sys/types.h>
@@ -37,12 +38,46 @@
 #include "bu/interrupt.h"
 #include "vmath.h"
 #include "rt/db4.h"
+#include "rt/db5.h"
 #include "rt/db_internal.h"
 #include "rt/db_io.h"
 #include "raytrace.h"
 #include "librt_private.h"
 
 
+/* Bytes an open write batch may hold before spilling to the file */
+#define DB_BATCH_SPILL (64 * 1024 * 1024)
+
+
+#if defined(HAVE_PREAD) && defined(HAVE_FILENO)
+/**
+ * Positional read of 'count' bytes at 'offset' from the file under
+ * dbip's FILE.  pread() leaves the shared file position alone, so
+ * concurrent readers need neither BU_SEM_SYSCALL nor a seek.  Any
+ * stdio buffering is bypassed, which is safe because db_write()
+ * flushes after every write.
+ *
+ * Returns the number of bytes read.
+ */
+static size_t
+db_pread(const struct db_i *dbip, void *addr, size_t count, b_off_t offset)
+{
+    int fd = fileno(dbip->i->dbi_fp);
+    size_t got = 0;
+
+    while (got < count) {
+	ssize_t ret = pread(fd, (char *)addr + got, count - got, (off_t)offset + (off_t)got);
+	if (ret < 0 && errno == EINTR)
+	    continue;
+	if (ret <= 0)
+	    break;
+	got += (size_t)ret;
+    }
+    return got;
+}
+#endif
+
+
 /**
  * Reads 'count' bytes at file offset 'offset' into buffer at 'addr'.
  * A wrapper for the UNIX read() sys-call that takes into account
@@ -58,7 +93,6 @@ db_read(const struct db_i *dbip, void *addr, size_t count, b_off_t offset)
 /* byte offset from start of file */
 {
     size_t got;
-    int ret;
 
     RT_CK_DBI(dbip);
 
@@ -81,14 +115,35 @@ db_read(const struct db_i *dbip, void *addr, size_t count, b_off_t offset)
 	memcpy(addr, ((char *)dbip->i->dbi_inmem) + offset, count);
 	return 0;
     }
+    if (dbip->i->dbi_batch_depth && offset + (b_off_t)count > dbip->i->dbi_batch_addr) {
+	/* the tail (or all) of this range is still in the write batch */
+	size_t head = 0;
+	size_t rel, avail;
+
+	if (offset < dbip->i->dbi_batch_addr) {
+	    head = (size_t)(dbip->i->dbi_batch_addr - offset);
+	    if (db_read(dbip, addr, head, offset) < 0)
+		return -1;
+	}
+	rel = (size_t)(offset + (b_off_t)head - dbip->i->dbi_batch_addr);
+	avail = (rel < dbip->i->dbi_batch_len) ? dbip->i->dbi_batch_len - rel : 0;
+	if (avail > count - head)
+	    avail = count - head;
+	memcpy((char *)addr + head, dbip->i->dbi_batch_buf + rel, avail);
+	memset((char *)addr + head + avail, 0, count - head - avail);
+	return 0;
+    }
+#if defined(HAVE_PREAD) && defined(HAVE_FILENO)
+    got = db_pread(dbip, addr, count, offset);
+#else
     bu_semaphore_acquire(BU_SEM_SYSCALL);
 
-    ret = bu_fseek(dbip->i->dbi_fp, offset, 0);
-    if (ret)
+    if (bu_fseek(dbip->i->dbi_fp, offset, 0))
 	bu_bomb("db_read: fseek error\n");
     got = (size_t)fread(addr, 1, count, dbip->i->dbi_fp);
 
     bu_semaphore_release(BU_SEM_SYSCALL);
+#endif
 
     if (got != count) {
 	perror(dbip->dbi_filename);
@@ -175,11 +230,90 @@ db_get(const struct db_i *dbip, const struct directory *dp, union record *where,
 }
 
 
+/**
+ * Write 'count' bytes at 'offset' straight to the file, flushing.
+ */
+static int
+db_write_file(struct db_i *dbip, const void *addr, size_t count, b_off_t offset)
+{
+    size_t got;
+
+    bu_semaphore_acquire(BU_SEM_SYSCALL);
+    bu_interrupt_suspend();
+
+    (void)bu_fseek(dbip->i->dbi_fp, offset, 0);
+    got = fwrite(addr, 1, count, dbip->i->dbi_fp);
+    fflush(dbip->i->dbi_fp);
+
+    bu_interrupt_restore();
+    bu_semaphore_release(BU_SEM_SYSCALL);
+    if (got != count) {
+	perror("db_write");
+	bu_log("db_write(%s):  write error.  Wanted %zu, got %zu bytes.\nFile forced read-only.\n",
+	       dbip->dbi_filename, count, got);
+	dbip->dbi_read_only = 1;
+	return -1;
+    }
+    return 0;			/* OK */
+}
+
+
+/**
+ * Write out everything buffered by the open batch in one go, leaving
+ * the batch open (and empty) at the new end of its records.
+ */
+static int
+db_batch_flush(struct db_i *dbip)
+{
+    struct db_i_internal *i = dbip->i;
+    int ret = 0;
+
+    if (i->dbi_batch_len) {
+	if (RT_G_DEBUG&RT_DEBUG_DB)
+	    bu_log("db_batch_flush(%s) %zu bytes at %jd\n",
+		   dbip->dbi_filename, i->dbi_batch_len, (intmax_t)i->dbi_batch_addr);
+	ret = db_write_file(dbip, i->dbi_batch_buf, i->dbi_batch_len, i->dbi_batch_addr);
+	i->dbi_batch_addr += (b_off_t)i->dbi_batch_len;
+	i->dbi_batch_len = 0;
+    }
+    return ret;
+}
+
+
+/**
+ * Copy a write at or past the start of the open batch into its
+ * buffer.  Unwritten gaps (e.g. the middle of a large free object)
+ * are zero filled.
+ */
+static int
+db_batch_write(struct db_i *dbip, const void *addr, size_t count, b_off_t offset)
+{
+    struct db_i_internal *i = dbip->i;
+    size_t rel = (size_t)(offset - i->dbi_batch_addr);
+
+    if (rel + count > i->dbi_batch_cap) {
+	size_t cap = i->dbi_batch_cap ? i->dbi_batch_cap : 64 * 1024;
+	while (cap < rel + count)
+	    cap *= 2;
+	i->dbi_batch_buf = (uint8_t *)bu_realloc(i->dbi_batch_buf, cap, "db_batch buf");
+	i->dbi_batch_cap = cap;
+    }
+    if (rel > i->dbi_batch_len)
+	memset(i->dbi_batch_buf + i->dbi_batch_len, 0, rel - i->dbi_batch_len);
+    memcpy(i->dbi_batch_buf + rel, addr, count);
+    if (rel + count > i->dbi_batch_len)
+	i->dbi_batch_len = rel + count;
+
+    /* bound the memory held by very large conversions */
+    if (i->dbi_batch_len >= DB_BATCH_SPILL && i->dbi_batch_addr + (b_off_t)i->dbi_batch_len >= i->dbi_eof)
+	return db_batch_flush(dbip);
+    return 0;
+}
+
+
 int
 db_write(struct db_i *dbip, const void *addr, size_t count, b_off_t offset)
 {
-    register size_t got;
-
     RT_CK_DBI(dbip);
 
     if (RT_G_DEBUG&RT_DEBUG_DB) {
@@ -198,23 +332,66 @@ db_write(struct db_i *dbip, const void *addr, size_t count, b_off_t offset)
 	bu_log("db_write() in memory?\n");
 	return -1;
     }
-    bu_semaphore_acquire(BU_SEM_SYSCALL);
-    bu_interrupt_suspend();
 
-    (void)bu_fseek(dbip->i->dbi_fp, offset, 0);
-    got = fwrite(addr, 1, count, dbip->i->dbi_fp);
-    fflush(dbip->i->dbi_fp);
+    if (dbip->i->dbi_batch_depth && offset + (b_off_t)count > dbip->i->dbi_batch_addr) {
+	if (offset < dbip->i->dbi_batch_addr) {
+	    size_t head = (size_t)(dbip->i->dbi_batch_addr - offset);
+	    if (db_write_file(dbip, addr, head, offset) < 0)
+		return -1;
+	    addr = (const char *)addr + head;
+	    count -= head;
+	    offset += (b_off_t)head;
+	}
+	return db_batch_write(dbip, addr, count, offset);
+    }
 
-    bu_interrupt_restore();
-    bu_semaphore_release(BU_SEM_SYSCALL);
-    if (got != count) {
-	perror("db_write");
-	bu_log("db_write(%s):  write error.  Wanted %zu, got %zu bytes.\nFile forced read-only.\n",
-	       dbip->dbi_filename, count, got);
-	dbip->dbi_read_only = 1;
+    return db_write_file(dbip, addr, count, offset);
+}
+
+
+int
+db_batch_begin(struct db_i *dbip)
+{
+    RT_CK_DBI(dbip);
+
+    if (dbip->dbi_read_only || dbip->i->dbi_inmem || !dbip->i->dbi_fp)
+	return -1;
+
+    if (dbip->i->dbi_batch_depth++ > 0)
+	return 0;
+
+    /* new records go at the end of the file, so it must be known */
+    if (dbip->i->dbi_eof == RT_DIR_PHONY_ADDR && db_dirbuild(dbip)) {
+	dbip->i->dbi_batch_depth = 0;
 	return -1;
     }
-    return 0;			/* OK */
+
+    dbip->i->dbi_batch_addr = dbip->i->dbi_eof;
+    dbip->i->dbi_batch_len = 0;
+    if (RT_G_DEBUG&RT_DEBUG_DB)
+	bu_log("db_batch_begin(%s) at %jd\n", dbip->dbi_filename, (intmax_t)dbip->i->dbi_batch_addr);
+    return 0;
+}
+
+
+int
+db_batch_commit(struct db_i *dbip)
+{
+    int ret;
+
+    RT_CK_DBI(dbip);
+
+    if (dbip->i->dbi_batch_depth <= 0)
+	return -1;
+    if (--dbip->i->dbi_batch_depth > 0)
+	return 0;
+
+    ret = db_batch_flush(dbip);
+
+    bu_free(dbip->i->dbi_batch_buf, "db_batch buf");
+    dbip->i->dbi_batch_buf = NULL;
+    dbip->i->dbi_batch_cap = 0;
+    return ret;
 }
 
 
@@ -288,6 +465,56 @@ db_get_external(register struct bu_external *ep, const struct directory *dp, con
 }
 
 
+int
+db_get_external_view(struct bu_external *ep, const struct directory *dp, const struct db_i *dbip)
+{
+    const struct db5_ondisk_header *odp;
+
+    RT_CK_DBI(dbip);
+    RT_CK_DIR(dp);
+
+    /* Only a read-only mapping is guaranteed not to change or move
+     * under the caller, and only v5 headers say whether the object
+     * is compressed.
+     */
+    if (!dbip->i->dbi_mf || db_version(dbip) < 5
+	|| (dp->d_flags & RT_DIR_INMEM) || dp->d_addr == RT_DIR_PHONY_ADDR
+	|| dp->d_len < sizeof(struct db5_ondisk_header)
+	|| dp->d_addr + (b_off_t)dp->d_len > (b_off_t)dbip->i->dbi_mf->buflen)
+	return db_get_external(ep, dp, dbip);
+
+    odp = (const struct db5_ondisk_header *)((const uint8_t *)dbip->i->dbi_mf->buf + dp->d_addr);
+    if ((odp->db5h_aflags & DB5HDR_AFLAGS_ZZZ_MASK) != DB5_ZZZ_UNCOMPRESSED
+	|| (odp->db5h_bflags & DB5HDR_BFLAGS_ZZZ_MASK) != DB5_ZZZ_UNCOMPRESSED)
+	return db_get_external(ep, dp, dbip);
+
+    if (RT_G_DEBUG&RT_DEBUG_DB) bu_log("db_get_external_view(%s) ep=%p, dbip=%p, dp=%p\n",
+				    dp->d_namep, (void *)ep, (void *)dbip, (void *)dp);
+
+    BU_EXTERNAL_INIT(ep);
+    ep->ext_nbytes = dp->d_len;
+    ep->ext_buf = (uint8_t *)odp;	/* discard const */
+    return 0;
+}
+
+
+void
+db_free_external(struct bu_external *ep, const struct db_i *dbip)
+{
+    BU_CK_EXTERNAL(ep);
+
+    if (dbip && dbip->i->dbi_mf && ep->ext_buf) {
+	const uint8_t *buf = (const uint8_t *)dbip->i->dbi_mf->buf;
+	if (ep->ext_buf >= buf && ep->ext_buf < buf + dbip->i->dbi_mf->buflen) {
+	    ep->ext_buf = NULL;
+	    ep->ext_nbytes = 0;
+	    return;
+	}
+    }
+    bu_free_external(ep);
+}
+
+
 int
 db_put_external(struct bu_external *ep, struct directory *dp, struct db_i *dbip)
 {
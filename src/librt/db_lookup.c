@@ -106,55 +106,93 @@ db_dircheck(struct db_i *dbip,
 {
     struct directory *dp;
     char *cp = bu_vls_addr(ret_name);
-    char n0 = cp[0];
-    char n1 = cp[1];
+    size_t len = strlen(cp);
+    uint64_t hash = bu_ohash_hash((const uint8_t *)cp, len);
 
     /* Compute hash only once (almost always the case) */
-    *headp = &(dbip->i->dbi_Head[db_dirhash(cp)]);
-
-    for (dp = **headp; dp != RT_DIR_NULL; dp=dp->d_forw) {
-	char *this_obj;
-	if (n0 == *(this_obj=dp->d_namep)  &&	/* speed */
-	    n1 == this_obj[1]  &&			/* speed */
-	    BU_STR_EQUAL(cp, this_obj)) {
-	    /* Name exists in directory already */
-	    int c;
-
-	    bu_vls_strcpy(ret_name, "A_");
-	    bu_vls_strcat(ret_name, this_obj);
-	    cp = bu_vls_addr(ret_name);
-
-	    for (c = 'A'; c <= 'Z'; c++) {
-		*cp = c;
-		if (db_lookup(dbip, cp, noisy) == RT_DIR_NULL)
-		    break;
-	    }
-	    if (c > 'Z') {
-		bu_log("db_dircheck: Duplicate of name '%s', ignored\n",
-		       cp);
-		return -1;	/* fail */
-	    }
-	    bu_log("db_dircheck: Duplicate of '%s', given temporary name '%s'\n",
-		   cp+2, cp);
+    *headp = DB_DIRCHAIN(dbip, hash);
+
+    dp = (struct directory *)bu_ohash_get_hashed(dbip->i->dbi_names, hash, (const uint8_t *)cp, len);
+    if (dp != RT_DIR_NULL) {
+	/* Name exists in directory already */
+	int c;
+
+	bu_vls_strcpy(ret_name, "A_");
+	bu_vls_strcat(ret_name, dp->d_namep);
+	cp = bu_vls_addr(ret_name);
 
-	    /* no need to recurse, simply recompute the hash and break */
-	    *headp = &(dbip->i->dbi_Head[db_dirhash(cp)]);
-	    break;
+	for (c = 'A'; c <= 'Z'; c++) {
+	    *cp = c;
+	    if (db_lookup(dbip, cp, noisy) == RT_DIR_NULL)
+		break;
 	}
+	if (c > 'Z') {
+	    bu_log("db_dircheck: Duplicate of name '%s', ignored\n",
+		   cp);
+	    return -1;	/* fail */
+	}
+	bu_log("db_dircheck: Duplicate of '%s', given temporary name '%s'\n",
+	       cp+2, cp);
+
+	/* no need to recurse, simply recompute the hash */
+	*headp = DB_DIRCHAIN(dbip, bu_ohash_hash((const uint8_t *)cp, strlen(cp)));
     }
 
     return 0;	/* success */
 }
 
 
+/* Take dp off its dbi_Head chain through d_prevp.  Returns -1 if dp
+ * isn't on a chain. */
+static int
+db_dirunlink(struct directory *dp)
+{
+    if (!dp->d_prevp || *dp->d_prevp != dp)
+	return -1;
+
+    *dp->d_prevp = dp->d_forw;
+    if (dp->d_forw)
+	dp->d_forw->d_prevp = dp->d_prevp;
+    dp->d_prevp = NULL;
+    return 0;
+}
+
+
+/* Drop dp's dbi_names entry, unless its name has been taken over by
+ * another entry (db_rename() doesn't refuse an existing name). */
+static void
+db_dirunindex(struct db_i *dbip, struct directory *dp)
+{
+    size_t len = strlen(dp->d_namep);
+
+    if (bu_ohash_get_hashed(dbip->i->dbi_names, dp->d_namehash, (const uint8_t *)dp->d_namep, len) == dp)
+	bu_ohash_rm_hashed(dbip->i->dbi_names, dp->d_namehash, (const uint8_t *)dp->d_namep, len);
+}
+
+
+void
+db_dirlink(struct db_i *dbip, struct directory *dp)
+{
+    struct directory **headp;
+    size_t len = strlen(dp->d_namep);
+
+    dp->d_namehash = bu_ohash_hash((const uint8_t *)dp->d_namep, len);
+    headp = DB_DIRCHAIN(dbip, dp->d_namehash);
+    dp->d_forw = *headp;
+    if (*headp)
+	(*headp)->d_prevp = &dp->d_forw;
+    dp->d_prevp = headp;
+    *headp = dp;
+    bu_ohash_set_hashed(dbip->i->dbi_names, dp->d_namehash, (const uint8_t *)dp->d_namep, len, dp);
+}
+
+
 struct directory *
 db_lookup(const struct db_i *dbip, const char *name, int noisy)
 {
     int is_path = 0;
     const char *pc = name;
     struct directory *dp = RT_DIR_NULL;
-    char n0;
-    char n1;
 
     /* No string, no lookup */
     if (UNLIKELY(!name || name[0] == '\0')) {
@@ -168,22 +206,14 @@ db_lookup(const struct db_i *dbip, const char *name, int noisy)
     }
 
 
-    n0 = name[0];
-    n1 = name[1];
-
     RT_CK_DBI(dbip);
 
-    dp = dbip->i->dbi_Head[db_dirhash(name)];
-    for (; dp != RT_DIR_NULL; dp=dp->d_forw) {
-	char *this_obj;
-
-	/* first two checks are for speed */
-	if ((n0 == *(this_obj=dp->d_namep)) && (n1 == this_obj[1]) && (BU_STR_EQUAL(name, this_obj))) {
-	    if (UNLIKELY(RT_G_DEBUG&RT_DEBUG_DB)) {
-		bu_log("db_lookup(%s) %p\n", name, (void *)dp);
-	    }
-	    return dp;
+    dp = (struct directory *)bu_ohash_get(dbip->i->dbi_names, (const uint8_t *)name, strlen(name));
+    if (dp != RT_DIR_NULL) {
+	if (UNLIKELY(RT_G_DEBUG&RT_DEBUG_DB)) {
+	    bu_log("db_lookup(%s) %p\n", name, (void *)dp);
 	}
+	return dp;
     }
 
     /* Anything with a forward slash is potentially a path, rather than an object
@@ -289,9 +319,8 @@ db_diradd(struct db_i *dbip, const char *name, b_off_t laddr, size_t len, int fl
      */
     dp->d_flags = flags & ~(RT_DIR_INMEM);
     dp->d_len = len;
-    dp->d_forw = *headp;
     BU_LIST_INIT(&dp->d_use_hd);
-    *headp = dp;
+    db_dirlink(dbip, dp);
     dp->d_animate = NULL;
     dp->d_nref = 0;
     dp->d_uses = 0;
@@ -324,99 +353,56 @@ db_diradd(struct db_i *dbip, const char *name, b_off_t laddr, size_t len, int fl
 int
 db_dirdelete(struct db_i *dbip, struct directory *dp)
 {
-    struct directory *findp;
-    struct directory **headp;
-
     RT_CK_DBI(dbip);
     RT_CK_DIR(dp);
 
-    headp = &(dbip->i->dbi_Head[db_dirhash(dp->d_namep)]);
-
     if (dp->d_flags & RT_DIR_INMEM) {
 	if (dp->d_un.ptr != NULL)
 	    bu_free(dp->d_un.ptr, "db_dirdelete() inmem ptr");
     }
 
-    if (*headp == dp) {
+    if (!dp->d_prevp || *dp->d_prevp != dp)
+	return -1;
 
-	// If we've gotten this far, the dp is on its way out - call the change
-	// callback first if defined, so the app can get information from the
-	// dp before it is cleared.
-	if (BU_PTBL_IS_INITIALIZED(&dbip->i->dbi_changed_clbks)) {
-	    for (size_t i = 0; i < BU_PTBL_LEN(&dbip->i->dbi_changed_clbks); i++) {
-		struct dbi_changed_clbk *cb = (struct dbi_changed_clbk *)BU_PTBL_GET(&dbip->i->dbi_changed_clbks, i);
-		(*cb->f)(dbip, dp, 2, cb->u_data);
-	    }
+    // If we've gotten this far, the dp is on its way out - call the change
+    // callback first if defined, so the app can get information from the
+    // dp before it is cleared.
+    if (BU_PTBL_IS_INITIALIZED(&dbip->i->dbi_changed_clbks)) {
+	for (size_t i = 0; i < BU_PTBL_LEN(&dbip->i->dbi_changed_clbks); i++) {
+	    struct dbi_changed_clbk *cb = (struct dbi_changed_clbk *)BU_PTBL_GET(&dbip->i->dbi_changed_clbks, i);
+	    (*cb->f)(dbip, dp, 2, cb->u_data);
 	}
-
-	RT_DIR_FREE_NAMEP(dp);	/* frees d_namep */
-	*headp = dp->d_forw;
-
-	/* Put 'dp' back on the freelist */
-	dp->d_forw = dbip->i->dbi_directory_hd;
-	dbip->i->dbi_directory_hd = dp;
-	return 0;
     }
-    for (findp = *headp; findp != RT_DIR_NULL; findp = findp->d_forw) {
-	if (findp->d_forw != dp)
-	    continue;
-
-	// If we've gotten this far, the dp is on its way out - call the change
-	// callback first if defined, so the app can get information from the
-	// dp before it is cleared.
-	if (BU_PTBL_IS_INITIALIZED(&dbip->i->dbi_changed_clbks)) {
-	    for (size_t i = 0; i < BU_PTBL_LEN(&dbip->i->dbi_changed_clbks); i++) {
-		struct dbi_changed_clbk *cb = (struct dbi_changed_clbk *)BU_PTBL_GET(&dbip->i->dbi_changed_clbks, i);
-		(*cb->f)(dbip, dp, 2, cb->u_data);
-	    }
-	}
 
-	RT_DIR_FREE_NAMEP(dp);	/* frees d_namep */
-	findp->d_forw = dp->d_forw;
+    db_dirunindex(dbip, dp);
+    RT_DIR_FREE_NAMEP(dp);	/* frees d_namep */
+    (void)db_dirunlink(dp);
 
-	/* Put 'dp' back on the freelist */
-	dp->d_forw = dbip->i->dbi_directory_hd;
-	dbip->i->dbi_directory_hd = dp;
-	return 0;
-    }
-    return -1;
+    /* Put 'dp' back on the freelist */
+    dp->d_forw = dbip->i->dbi_directory_hd;
+    dbip->i->dbi_directory_hd = dp;
+    return 0;
 }
 
 
 int
 db_rename(struct db_i *dbip, struct directory *dp, const char *newname)
 {
-    struct directory *findp;
-    struct directory **headp;
-
     RT_CK_DBI(dbip);
     RT_CK_DIR(dp);
 
     /* Remove from linked list */
-    headp = &(dbip->i->dbi_Head[db_dirhash(dp->d_namep)]);
-    if (*headp == dp) {
-	/* Was first on list, dequeue */
-	*headp = dp->d_forw;
-    } else {
-	for (findp = *headp; findp != RT_DIR_NULL; findp = findp->d_forw) {
-	    if (findp->d_forw != dp)
-		continue;
-	    /* Dequeue */
-	    findp->d_forw = dp->d_forw;
-	    goto out;
-	}
+    if (db_dirunlink(dp) < 0)
 	return -1;		/* ERROR: can't find */
-    }
 
-out:
+    db_dirunindex(dbip, dp);
+
     /* Effect new name */
     RT_DIR_FREE_NAMEP(dp);			/* frees d_namep */
     RT_DIR_SET_NAMEP(dp, newname);	/* sets d_namep */
 
     /* Add to new linked list */
-    headp = &(dbip->i->dbi_Head[db_dirhash(newname)]);
-    dp->d_forw = *headp;
-    *headp = dp;
+    db_dirlink(dbip, dp);
     return 0;
 }
 
@@ -413,6 +413,12 @@ db_close(register struct db_i *dbip)
     bu_free_mapped_files(0);
     dbip->i->dbi_mf = (struct bu_mapped_file *)NULL;
 
+    /* write out anything still held by an open batch */
+    if (dbip->i->dbi_batch_depth > 0) {
+	dbip->i->dbi_batch_depth = 1;
+	(void)db_batch_commit(dbip);
+    }
+
     /* try to ensure/encourage that the file is written out */
     db_sync(dbip);
 
@@ -429,8 +435,7 @@ db_close(register struct db_i *dbip)
     db_mater_free(dbip);		/* Free per-db material/color table */
 
     /* Release map of database holes */
-    rt_mempurge(&(dbip->i->dbi_freep));
-    rt_memclose();
+    db_freemap_clear(dbip->i->dbi_freemap);
 
     dbip->i->dbi_inmem = NULL;		/* sanity */
 
@@ -441,6 +446,7 @@ db_close(register struct db_i *dbip)
 	bu_ptbl_free(&dbip->i->dbi_update_nref_clbks);
 
     /* Free all directory entries */
+    bu_ohash_clear(dbip->i->dbi_names);
     for (i = 0; i < RT_DBNHASH; i++) {
 	for (dp = dbip->i->dbi_Head[i]; dp != RT_DIR_NULL;) {
 	    RT_CK_DIR(dp);
@@ -455,6 +461,7 @@ db_close(register struct db_i *dbip)
 
 	    /* Put 'dp' back on the freelist */
 	    dp->d_forw = dbip->i->dbi_directory_hd;
+	    dp->d_prevp = NULL;
 	    dbip->i->dbi_directory_hd = dp;
 
 	    /* null'ing the forward pointer here is a huge
@@ -518,6 +525,7 @@ db_dump(struct rt_wdb *wdbp, struct db_i *dbip)
     register struct directory *dp;
     struct bu_external ext;
     int append_only = 0;
+    int batch;
     struct directory *out_global = RT_DIR_NULL;
 
     RT_CK_DBI(dbip);
@@ -535,6 +543,10 @@ db_dump(struct rt_wdb *wdbp, struct db_i *dbip)
     if (append_only)
 	out_global = db_lookup(wdbp->dbip, DB5_GLOBAL_OBJECT_NAME, LOOKUP_QUIET);
 
+    /* Lay the copies out in one contiguous write.  In-memory and
+     * read-only targets refuse the batch and are written directly. */
+    batch = (db_batch_begin(wdbp->dbip) == 0);
+
     /* Output all directory entries */
     FOR_ALL_DIRECTORY_START(dp, dbip)
 	RT_CK_DIR(dp);
@@ -548,10 +560,17 @@ db_dump(struct rt_wdb *wdbp, struct db_i *dbip)
 	if (wdb_export_external(wdbp, &ext, dp->d_namep, dp->d_flags & ~(RT_DIR_INMEM), dp->d_minor_type) < 0) {
 	    bu_log("db_dump() write failed on %s, aborting\n", dp->d_namep);
 	    bu_free_external(&ext);
+	    if (batch)
+		(void)db_batch_commit(wdbp->dbip);
 	    return -1;
 	}
 	bu_free_external(&ext);
     FOR_ALL_DIRECTORY_END;
+
+    if (batch && db_batch_commit(wdbp->dbip) < 0) {
+	bu_log("db_dump() write failed on %s\n", wdbp->dbip->dbi_filename);
+	return -1;
+    }
     return 0;
 }
 
@@ -609,6 +628,8 @@ db_i_internal_create(void)
     i->material_head = MATER_NULL;
     i->dbi_directory_hd = NULL;
     bu_ptbl_init(&i->dbi_directory_blocks, 8, "dbi_directory_blocks");
+    i->dbi_freemap = db_freemap_create();
+    i->dbi_names = bu_ohash_create(1024, BU_OHASH_BORROW_KEYS);
 
     return i;
 }
@@ -622,6 +643,9 @@ db_i_internal_destroy(struct db_i_internal *i)
     if (i->mesh_c)
 	bv_mesh_lod_context_destroy(i->mesh_c);
 
+    db_freemap_destroy(i->dbi_freemap);
+    bu_ohash_destroy(i->dbi_names);
+
     /* Free any directory blocks */
     for (size_t ii = 0; ii < BU_PTBL_LEN(&i->dbi_directory_blocks); ii++)
 	bu_free(BU_PTBL_GET(&i->dbi_directory_blocks, ii), "directory block");
@@ -137,7 +137,7 @@ db_scan(struct db_i *dbip, int (*handler) (struct db_i *, const char *, b_off_t,
 		break;
 	    case ID_FREE:
 		/* Inform db manager of avail. space */
-		rt_memfree(&(dbip->i->dbi_freep), 1, addr/sizeof(union record));
+		(void)db_freemap_free(dbip->i->dbi_freemap, 1, addr/sizeof(union record));
 		break;
 	    case ID_ARS_A:
 		while (1) {
@@ -0,0 +1,508 @@
+/*                      I N S T A N C E . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup ray */
+/** @{ */
+/** @file librt/instance.c
+ *
+ * Shooting one prepped copy of a solid placed many times.
+ *
+ * A solid referenced under the same matrix more than once is already
+ * prepped only once, by _rt_find_identical_solid().  A solid placed
+ * under different matrices, a bolt repeated around a flange for one,
+ * is prepped once per placement, although all the placements but the
+ * scale are the same shape.  For the primitives whose prep is slow or
+ * whose prepped form is large (a BoT's BVH and triangles), that is a
+ * great deal of time and memory spent on duplicates.
+ *
+ * Here the first placement of such a solid to be prepped becomes the
+ * prototype.  Every later placement whose matrix differs from the
+ * prototype's only by a rotation, reflection and translation is not
+ * prepped at all: its soltab gets the prototype's bounds moved into
+ * place, and methods that move each ray into the prototype's frame,
+ * shoot the prototype there, and move the hits back.  The scene's own
+ * space partitioning sorts the placements by their bounds, and each
+ * prototype's acceleration structure (the BVH, for a BoT) is walked
+ * from inside them, so the two levels need nothing new.
+ *
+ * This is only done with rti_instance set, for the types whose
+ * ft_labels are listed in rti_instance_types.  Setting
+ * rti_dont_instance turns it off along with the sharing of identical
+ * placements.
+ */
+/** @} */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/hash.h"
+#include "vmath.h"
+#include "bn/mat.h"
+#include "raytrace.h"
+#include "librt_private.h"
+
+
+#define INSTANCE_RIGID_TOL 1.0e-9
+
+
+/* The prepped geometry a prototype and its instances share.  stp is a
+ * copy of the prototype's soltab, so the geometry outlives whichever
+ * of them is freed first.
+ */
+struct instance_proto {
+    struct soltab stp;
+    mat_t mat;		/* stp.st_matp points here, if it is not identity */
+    long uses;		/* the prototype and its instances */
+    struct instance_proto *next;	/* prototypes of the same solid at other scales */
+};
+
+struct instance_specific {
+    struct instance_proto *proto;
+    mat_t to_proto;	/* model space to the prototype's */
+    mat_t from_proto;
+};
+
+
+static struct rt_functab instance_meth[ID_MAX_SOLID+1];
+static char instance_meth_ready[ID_MAX_SOLID+1];
+
+
+static struct instance_proto *
+instance_proto_get(struct rt_i *rtip, const struct directory *dp)
+{
+    return (struct instance_proto *)bu_hash_get(rtip->i->rti_instance_protos, (const uint8_t *)&dp, sizeof(dp));
+}
+
+
+/* Drop one use of proto, and free the geometry with the last one */
+static void
+instance_proto_release(struct instance_proto *proto)
+{
+    struct rt_i *rtip = proto->stp.st_rtip;
+    const struct directory *dp = proto->stp.st_dp;
+    struct instance_proto *prev;
+    long uses;
+
+    bu_semaphore_acquire(RT_SEM_MODEL);
+    uses = --proto->uses;
+    if (!uses) {
+	prev = instance_proto_get(rtip, dp);
+	if (prev == proto) {
+	    if (proto->next)
+		bu_hash_set(rtip->i->rti_instance_protos, (const uint8_t *)&dp, sizeof(dp), (void *)proto->next);
+	    else
+		bu_hash_rm(rtip->i->rti_instance_protos, (const uint8_t *)&dp, sizeof(dp));
+	} else {
+	    while (prev && prev->next != proto)
+		prev = prev->next;
+	    if (prev)
+		prev->next = proto->next;
+	}
+    }
+    bu_semaphore_release(RT_SEM_MODEL);
+
+    if (uses)
+	return;
+    if (proto->stp.st_meth->ft_free)
+	proto->stp.st_meth->ft_free(&proto->stp);
+    BU_PUT(proto, struct instance_proto);
+}
+
+
+/* Move ray rp into the frame of mat, as rt_shootray() would have set
+ * it up there, with the matching inverse direction in inv_dir.
+ */
+static void
+instance_ray(struct xray *out, vect_t inv_dir, const struct xray *rp, const mat_t mat)
+{
+    int i;
+
+    *out = *rp;
+    MAT4X3PNT(out->r_pt, mat, rp->r_pt);
+    MAT4X3VEC(out->r_dir, mat, rp->r_dir);
+    for (i = X; i <= Z; i++) {
+	if (out->r_dir[i] < -SQRT_SMALL_FASTF || out->r_dir[i] > SQRT_SMALL_FASTF) {
+	    inv_dir[i] = 1.0 / out->r_dir[i];
+	} else {
+	    out->r_dir[i] = 0.0;
+	    inv_dir[i] = INFINITY;
+	}
+    }
+}
+
+
+static void
+instance_hit(struct hit *hitp, const mat_t mat)
+{
+    point_t pt;
+    vect_t norm;
+
+    MAT4X3PNT(pt, mat, hitp->hit_point);
+    MAT4X3VEC(norm, mat, hitp->hit_normal);
+    VMOVE(hitp->hit_point, pt);
+    VMOVE(hitp->hit_normal, norm);
+}
+
+
+static int
+instance_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct seg *seghead)
+{
+    struct instance_specific *inst = (struct instance_specific *)stp->st_specific;
+    struct soltab *proto = &inst->proto->stp;
+    struct xray ray;
+    struct seg head;
+    struct seg *segp;
+    vect_t inv_dir;
+    int ret;
+
+    /* a few primitives bound the ray with a_inv_dir */
+    instance_ray(&ray, inv_dir, rp, inst->to_proto);
+    VSWAP(inv_dir, ap->a_inv_dir);
+
+    BU_LIST_INIT(&(head.l));
+    ret = proto->st_meth->ft_shot(proto, &ray, ap, &head);
+
+    VSWAP(inv_dir, ap->a_inv_dir);
+
+    while (BU_LIST_WHILE(segp, seg, &(head.l))) {
+	BU_LIST_DEQUEUE(&(segp->l));
+	segp->seg_stp = stp;
+	instance_hit(&segp->seg_in, inst->from_proto);
+	instance_hit(&segp->seg_out, inst->from_proto);
+	segp->seg_in.hit_rayp = segp->seg_out.hit_rayp = rp;
+	BU_LIST_INSERT(&(seghead->l), &(segp->l));
+    }
+    return ret;
+}
+
+
+static void
+instance_print(const struct soltab *stp)
+{
+    const struct instance_specific *inst = (const struct instance_specific *)stp->st_specific;
+
+    bu_log("instance of %s\n", inst->proto->stp.st_name);
+    bn_mat_print("model to prototype", inst->to_proto);
+    if (inst->proto->stp.st_meth->ft_print)
+	inst->proto->stp.st_meth->ft_print(&inst->proto->stp);
+}
+
+
+/* The hit moved into the prototype's frame, with the ray it is on */
+static void
+instance_proto_hit(struct hit *out, struct xray *ray, const struct hit *hitp, const struct xray *rp, const struct instance_specific *inst)
+{
+    vect_t inv_dir;
+
+    *out = *hitp;
+    instance_hit(out, inst->to_proto);
+    if (rp) {
+	instance_ray(ray, inv_dir, rp, inst->to_proto);
+	out->hit_rayp = ray;
+    }
+}
+
+
+static void
+instance_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
+{
+    struct instance_specific *inst = (struct instance_specific *)stp->st_specific;
+    struct soltab *proto = &inst->proto->stp;
+    struct xray ray;
+    struct hit hit;
+
+    instance_proto_hit(&hit, &ray, hitp, rp, inst);
+    proto->st_meth->ft_norm(&hit, proto, rp ? &ray : NULL);
+    instance_hit(&hit, inst->from_proto);
+    hit.hit_rayp = hitp->hit_rayp;
+    *hitp = hit;
+}
+
+
+static void
+instance_uv(struct application *ap, struct soltab *stp, struct hit *hitp, struct uvcoord *uvp)
+{
+    struct instance_specific *inst = (struct instance_specific *)stp->st_specific;
+    struct soltab *proto = &inst->proto->stp;
+    struct xray ray;
+    struct hit hit;
+
+    instance_proto_hit(&hit, &ray, hitp, hitp->hit_rayp, inst);
+    proto->st_meth->ft_uv(ap, proto, &hit, uvp);
+}
+
+
+static void
+instance_curve(struct curvature *cvp, struct hit *hitp, struct soltab *stp)
+{
+    struct instance_specific *inst = (struct instance_specific *)stp->st_specific;
+    struct soltab *proto = &inst->proto->stp;
+    struct xray ray;
+    struct hit hit;
+    vect_t pdir;
+
+    instance_proto_hit(&hit, &ray, hitp, hitp->hit_rayp, inst);
+    proto->st_meth->ft_curve(cvp, &hit, proto);
+    MAT4X3VEC(pdir, inst->from_proto, cvp->crv_pdir);
+    VMOVE(cvp->crv_pdir, pdir);
+}
+
+
+static void
+instance_free(struct soltab *stp)
+{
+    struct instance_specific *inst = (struct instance_specific *)stp->st_specific;
+
+    instance_proto_release(inst->proto);
+    BU_PUT(inst, struct instance_specific);
+    stp->st_specific = NULL;
+}
+
+
+/* The methods of an instance of a solid of type id */
+static const struct rt_functab *
+instance_meth_get(int id)
+{
+    struct rt_functab *ft = &instance_meth[id];
+
+    if (instance_meth_ready[id])
+	return ft;
+
+    rt_functab_wrap(ft, id, instance_shot, instance_print, instance_norm, instance_uv, instance_curve, instance_free);
+    instance_meth_ready[id] = 1;
+    return ft;
+}
+
+
+/* 1 if the upper 3x3 of mat is orthonormal and it has no perspective */
+static int
+instance_mat_is_rigid(const mat_t mat)
+{
+    int i, j;
+
+    if (!NEAR_ZERO(mat[12], INSTANCE_RIGID_TOL) || !NEAR_ZERO(mat[13], INSTANCE_RIGID_TOL) || !NEAR_ZERO(mat[14], INSTANCE_RIGID_TOL)
+	|| !NEAR_EQUAL(mat[15], 1.0, INSTANCE_RIGID_TOL))
+	return 0;
+    for (i = 0; i < 3; i++) {
+	for (j = i; j < 3; j++) {
+	    fastf_t d = VDOT(&mat[4*i], &mat[4*j]);
+	    if (!NEAR_EQUAL(d, (i == j) ? 1.0 : 0.0, INSTANCE_RIGID_TOL))
+		return 0;
+	}
+    }
+    return 1;
+}
+
+
+/* The inverse of a soltab's st_matp.  Returns 0 if it has none */
+static int
+instance_mat_inv(mat_t inv, const matp_t matp)
+{
+    if (!matp) {
+	MAT_IDN(inv);
+	return 1;
+    }
+    return bn_mat_inverse(inv, matp);
+}
+
+
+/* From the model space of a placement, given the inverse of its matrix,
+ * to that of proto.  Returns 1 if that is a rigid motion.
+ */
+static int
+instance_to_proto(mat_t to_proto, const mat_t inv, const struct instance_proto *proto)
+{
+    if (proto->stp.st_matp)
+	bn_mat_mul(to_proto, proto->stp.st_matp, inv);
+    else
+	MAT_COPY(to_proto, inv);
+    return instance_mat_is_rigid(to_proto);
+}
+
+
+int
+rt_instance_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
+{
+    struct instance_proto *proto;
+    struct instance_specific *inst;
+    mat_t inst_inv;
+    point_t corner, pt;
+    int i;
+
+    RT_CK_SOLTAB(stp);
+    RT_CK_DB_INTERNAL(ip);
+    RT_CK_RTI(rtip);
+
+    if (!rtip->rti_instance || rtip->rti_dont_instance || ip->idb_major_type != DB5_MAJORTYPE_BRLCAD)
+	return -1;
+    if (ip->idb_minor_type <= 0 || ip->idb_minor_type > ID_MAX_SOLID
+	|| !rt_functab_listed(rtip->rti_instance_types, OBJ[ip->idb_minor_type].ft_label))
+	return -1;
+
+    if (!instance_mat_inv(inst_inv, stp->st_matp))
+	return -1;
+
+    BU_GET(inst, struct instance_specific);
+    bu_semaphore_acquire(RT_SEM_MODEL);
+    for (proto = instance_proto_get(rtip, stp->st_dp); proto; proto = proto->next) {
+	if (instance_to_proto(inst->to_proto, inst_inv, proto))
+	    break;
+    }
+    if (proto) {
+	proto->uses++;
+	stp->st_meth = instance_meth_get(proto->stp.st_id);
+    }
+    bu_semaphore_release(RT_SEM_MODEL);
+    if (!proto) {
+	BU_PUT(inst, struct instance_specific);
+	return -1;
+    }
+    inst->proto = proto;
+    bn_mat_inverse(inst->from_proto, inst->to_proto);
+    stp->st_id = proto->stp.st_id;
+    stp->st_specific = (void *)inst;
+
+    /* the prototype's bounds, moved into place */
+    MAT4X3PNT(stp->st_center, inst->from_proto, proto->stp.st_center);
+    stp->st_aradius = proto->stp.st_aradius;
+    stp->st_bradius = proto->stp.st_bradius;
+    VSETALL(stp->st_max, -INFINITY);
+    VSETALL(stp->st_min,  INFINITY);
+    for (i = 0; i < 8; i++) {
+	VSET(corner,
+	     (i & 1) ? proto->stp.st_max[X] : proto->stp.st_min[X],
+	     (i & 2) ? proto->stp.st_max[Y] : proto->stp.st_min[Y],
+	     (i & 4) ? proto->stp.st_max[Z] : proto->stp.st_min[Z]);
+	MAT4X3PNT(pt, inst->from_proto, corner);
+	VMINMAX(stp->st_min, stp->st_max, pt);
+    }
+    stp->st_npieces = 0;
+
+    if (RT_G_DEBUG&RT_DEBUG_SOLIDS)
+	bu_log("%s: instancing the prepped %s\n", stp->st_name, stp->st_meth->ft_label);
+    return 0;
+}
+
+
+void
+rt_instance_register(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
+{
+    struct instance_proto *proto, *p;
+    const struct directory *dp;
+    mat_t inv, to_proto;
+
+    RT_CK_SOLTAB(stp);
+    RT_CK_DB_INTERNAL(ip);
+    RT_CK_RTI(rtip);
+
+    if (!rtip->rti_instance || rtip->rti_dont_instance || ip->idb_major_type != DB5_MAJORTYPE_BRLCAD)
+	return;
+    if (ip->idb_minor_type <= 0 || ip->idb_minor_type > ID_MAX_SOLID
+	|| !rt_functab_listed(rtip->rti_instance_types, OBJ[ip->idb_minor_type].ft_label))
+	return;
+    if (!(stp->st_aradius > 0) || stp->st_aradius >= INFINITY || stp->st_id <= 0 || stp->st_id > ID_MAX_SOLID)
+	return;
+    if (!stp->st_meth->ft_shot || stp->st_meth != &OBJ[stp->st_id])
+	return;
+    if (!instance_mat_inv(inv, stp->st_matp))
+	return;
+
+    BU_GET(proto, struct instance_proto);
+    proto->stp = *stp;	/* struct copy */
+    proto->stp.l.forw = proto->stp.l.back = NULL;
+    proto->stp.l2.forw = proto->stp.l2.back = NULL;
+    proto->stp.st_uses = 1;
+    memset(&proto->stp.st_regions, 0, sizeof(struct bu_ptbl));
+    memset(&proto->stp.st_path, 0, sizeof(struct db_full_path));
+    proto->stp.st_npieces = 0;
+    proto->stp.st_piece_rpps = NULL;
+    if (stp->st_matp) {
+	MAT_COPY(proto->mat, stp->st_matp);
+	proto->stp.st_matp = proto->mat;
+    }
+    proto->uses = 1;
+
+    /* The first placement prepped at each scale is the prototype.  If
+     * another thread prepped one at this scale first, stp just keeps
+     * its own geometry.
+     */
+    dp = stp->st_dp;
+    bu_semaphore_acquire(RT_SEM_MODEL);
+    proto->next = instance_proto_get(rtip, dp);
+    for (p = proto->next; p; p = p->next) {
+	if (instance_to_proto(to_proto, inv, p))
+	    break;
+    }
+    if (p) {
+	bu_semaphore_release(RT_SEM_MODEL);
+	BU_PUT(proto, struct instance_proto);
+	return;
+    }
+    bu_hash_set(rtip->i->rti_instance_protos, (const uint8_t *)&dp, sizeof(dp), (void *)proto);
+    bu_semaphore_release(RT_SEM_MODEL);
+}
+
+
+int
+rt_instance_unshare(struct soltab *stp)
+{
+    struct instance_proto *proto;
+    struct rt_i *rtip = stp->st_rtip;
+
+    if (!rtip || !stp->st_dp || !rtip->i->rti_instance_protos)
+	return 0;
+
+    bu_semaphore_acquire(RT_SEM_MODEL);
+    for (proto = instance_proto_get(rtip, stp->st_dp); proto; proto = proto->next) {
+	if (proto->stp.st_specific == stp->st_specific && proto->stp.st_meth == stp->st_meth)
+	    break;
+    }
+    bu_semaphore_release(RT_SEM_MODEL);
+    if (!proto)
+	return 0;
+
+    instance_proto_release(proto);
+    return 1;
+}
+
+
+const struct soltab *
+rt_instance_proto(const struct soltab *stp)
+{
+    const struct instance_specific *inst;
+
+    if (!stp->st_meth || stp->st_meth < &instance_meth[0] || stp->st_meth > &instance_meth[ID_MAX_SOLID])
+	return NULL;
+    inst = (const struct instance_specific *)stp->st_specific;
+    return inst ? &inst->proto->stp : NULL;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
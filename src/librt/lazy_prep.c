@@ -0,0 +1,389 @@
+/*                     L A Z Y _ P R E P . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup ray */
+/** @{ */
+/** @file librt/lazy_prep.c
+ *
+ * Prepping solids when the first ray reaches them.
+ *
+ * rt_prep() preps every solid in the trees asked for before the first
+ * ray is shot.  For a single nirt shotline, a narrow view or the area
+ * of one region of a large model, most of that time goes into BVHs,
+ * surface trees and pyramids for solids no ray comes near.
+ *
+ * With rti_lazy_prep set (or LIBRT_LAZY_PREP=1), a solid of one of the
+ * types listed in rti_lazy_prep_types gets only its bounding box from
+ * ft_bbox while the trees are walked, which is all the space
+ * partitioning needs.  Its soltab shoots through methods that, on the
+ * first ray to reach it, read the solid back from the database, prep
+ * it as _rt_gettree_leaf() would have, and shoot that from then on.
+ *
+ * The full prep goes into a copy of the soltab, so nothing the other
+ * threads read of the soltab itself changes under them.  Each deferred
+ * solid has its own lock, taken only until it is prepped: a thread
+ * waits only if it reaches a solid another thread is still prepping,
+ * and afterwards the cost is one flag read with acquire semantics.  A
+ * solid whose prep fails is missed by every ray, where prepping it up
+ * front would have dropped it from its tree.
+ */
+/** @} */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if !defined(_WIN32) || defined(__CYGWIN__)
+#  include <stdatomic.h>
+#endif
+
+#include "bu/str.h"
+#include "bu/tc.h"
+#include "vmath.h"
+#include "raytrace.h"
+#include "librt_private.h"
+
+
+#define LAZY_WAITING 0	/* bounds only, so far */
+#define LAZY_READY 1
+#define LAZY_FAILED 2
+
+
+struct lazy_specific {
+    struct soltab stp;	/* the solid prepped in full, once state is LAZY_READY */
+    bu_mtx_t mtx;	/* held while it is being prepped */
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    LONG state;
+#else
+    atomic_int state;
+#endif
+};
+
+
+static struct rt_functab lazy_meth[ID_MAX_SOLID+1];
+static char lazy_meth_ready[ID_MAX_SOLID+1];
+
+
+/*
+ * The state is the publication point of the full prep: everything it
+ * wrote happens before the release store of LAZY_READY, and a thread
+ * that loads LAZY_READY with acquire semantics sees all of it.  As in
+ * libbu's semaphores, MSVC gets the interlocked API, whose operations
+ * are full barriers.
+ */
+#if defined(_WIN32) && !defined(__CYGWIN__)
+static int
+lazy_state(struct lazy_specific *lz)
+{
+    return (int)InterlockedCompareExchange(&lz->state, 0, 0);
+}
+
+
+static void
+lazy_state_set(struct lazy_specific *lz, int state)
+{
+    (void)InterlockedExchange(&lz->state, (LONG)state);
+}
+#else
+static int
+lazy_state(struct lazy_specific *lz)
+{
+    return atomic_load_explicit(&lz->state, memory_order_acquire);
+}
+
+
+static void
+lazy_state_set(struct lazy_specific *lz, int state)
+{
+    atomic_store_explicit(&lz->state, state, memory_order_release);
+}
+#endif
+
+
+void
+rt_lazy_prep_select_from_env(struct rt_i *rtip)
+{
+    const char *mode = getenv("LIBRT_LAZY_PREP");
+
+    RT_CK_RTI(rtip);
+
+    if (!mode || !mode[0])
+	return;
+    if (BU_STR_EQUIV(mode, "on") || BU_STR_EQUIV(mode, "yes") || BU_STR_EQUAL(mode, "1"))
+	rtip->rti_lazy_prep = 1;
+    else if (BU_STR_EQUIV(mode, "off") || BU_STR_EQUIV(mode, "no") || BU_STR_EQUAL(mode, "0"))
+	rtip->rti_lazy_prep = 0;
+    else
+	bu_log("WARNING: unknown LIBRT_LAZY_PREP value '%s', ignored\n", mode);
+}
+
+
+/* Prep lz->stp in full, from the solid as it is in the database */
+static int
+lazy_prep_full(struct lazy_specific *lz)
+{
+    struct soltab *stp = &lz->stp;
+    struct rt_i *rtip = stp->st_rtip;
+    struct rt_db_internal intern;
+    int ret;
+
+    if (rt_db_get_internal(&intern, stp->st_dp, rtip->rti_dbip, stp->st_matp) < 0)
+	return -1;
+    if (intern.idb_major_type != DB5_MAJORTYPE_BRLCAD || intern.idb_minor_type != stp->st_id) {
+	rt_db_free_internal(&intern);
+	return -1;
+    }
+
+    VSETALL(stp->st_max, -INFINITY);
+    VSETALL(stp->st_min,  INFINITY);
+    ret = rt_obj_prep(stp, &intern, rtip);
+    if (!ret) {
+	/* no timing "auto" in the middle of the ray trace */
+	(void)rt_tess_prep(stp, &intern, rtip, 0);
+
+	/* the space partitioning was built on the bounds alone */
+	if (stp->st_piece_rpps) {
+	    bu_free((char *)stp->st_piece_rpps, "st_piece_rpps[]");
+	    stp->st_piece_rpps = NULL;
+	}
+	stp->st_npieces = 0;
+    }
+    rt_db_free_internal(&intern);
+    return ret;
+}
+
+
+/* 1 once stp is prepped in full, prepping it first if no thread has */
+static int
+lazy_ready(struct soltab *stp)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+    struct rt_i *rtip = stp->st_rtip;
+    int state = lazy_state(lz);
+
+    if (state != LAZY_WAITING)
+	return state == LAZY_READY;
+
+    /* Only the threads that reach this solid before it is prepped wait
+     * here, and only for this solid.
+     */
+    bu_mtx_lock(&lz->mtx);
+    state = lazy_state(lz);
+    if (state == LAZY_WAITING) {
+	if (lazy_prep_full(lz) == 0) {
+	    state = LAZY_READY;
+	} else {
+	    bu_log("%s: prep failure on first hit, it will be missed\n", stp->st_name);
+	    state = LAZY_FAILED;
+	}
+	bu_semaphore_acquire(BU_SEM_GENERAL);
+	rtip->stats.ndeferred_prepped++;
+	bu_semaphore_release(BU_SEM_GENERAL);
+	lazy_state_set(lz, state);
+    }
+    bu_mtx_unlock(&lz->mtx);
+
+    return state == LAZY_READY;
+}
+
+
+static int
+lazy_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct seg *seghead)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+    struct soltab *full = &lz->stp;
+    struct seg head;
+    struct seg *segp;
+    int ret;
+
+    if (!lazy_ready(stp))
+	return 0;
+
+    BU_LIST_INIT(&(head.l));
+    ret = full->st_meth->ft_shot(full, rp, ap, &head);
+
+    while (BU_LIST_WHILE(segp, seg, &(head.l))) {
+	BU_LIST_DEQUEUE(&(segp->l));
+	segp->seg_stp = stp;
+	BU_LIST_INSERT(&(seghead->l), &(segp->l));
+    }
+    return ret;
+}
+
+
+/* The hits of a deferred solid only come from lazy_shot(), by which
+ * time it is prepped.
+ */
+static void
+lazy_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+
+    if (lz->stp.st_meth->ft_norm)
+	lz->stp.st_meth->ft_norm(hitp, &lz->stp, rp);
+}
+
+
+static void
+lazy_uv(struct application *ap, struct soltab *stp, struct hit *hitp, struct uvcoord *uvp)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+
+    if (lz->stp.st_meth->ft_uv)
+	lz->stp.st_meth->ft_uv(ap, &lz->stp, hitp, uvp);
+}
+
+
+static void
+lazy_curve(struct curvature *cvp, struct hit *hitp, struct soltab *stp)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+
+    if (lz->stp.st_meth->ft_curve)
+	lz->stp.st_meth->ft_curve(cvp, hitp, &lz->stp);
+}
+
+
+static void
+lazy_print(const struct soltab *stp)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+
+    switch (lazy_state(lz)) {
+	case LAZY_READY:
+	    if (lz->stp.st_meth->ft_print)
+		lz->stp.st_meth->ft_print(&lz->stp);
+	    break;
+	case LAZY_FAILED:
+	    bu_log("prep failed on first hit\n");
+	    break;
+	default:
+	    bu_log("prep deferred until first hit\n");
+    }
+}
+
+
+static void
+lazy_free(struct soltab *stp)
+{
+    struct lazy_specific *lz = (struct lazy_specific *)stp->st_specific;
+
+    /* as with any solid, a failed prep is not freed */
+    if (lazy_state(lz) == LAZY_READY && lz->stp.st_meth->ft_free)
+	lz->stp.st_meth->ft_free(&lz->stp);
+    bu_mtx_destroy(&lz->mtx);
+    BU_PUT(lz, struct lazy_specific);
+    stp->st_specific = NULL;
+}
+
+
+/* The methods of a deferred solid of type id; call with RT_SEM_MODEL */
+static const struct rt_functab *
+lazy_meth_get(int id)
+{
+    struct rt_functab *ft = &lazy_meth[id];
+
+    if (lazy_meth_ready[id])
+	return ft;
+
+    rt_functab_wrap(ft, id, lazy_shot, lazy_print, lazy_norm, lazy_uv, lazy_curve, lazy_free);
+    lazy_meth_ready[id] = 1;
+    return ft;
+}
+
+
+int
+rt_lazy_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
+{
+    struct lazy_specific *lz;
+    point_t min, max;
+    int id, i;
+
+    RT_CK_SOLTAB(stp);
+    RT_CK_DB_INTERNAL(ip);
+    RT_CK_RTI(rtip);
+
+    if (!rtip->rti_lazy_prep || ip->idb_major_type != DB5_MAJORTYPE_BRLCAD)
+	return -1;
+    id = ip->idb_minor_type;
+    if (id <= 0 || id > ID_MAX_SOLID || stp->st_id != id || !rt_functab_listed(rtip->rti_lazy_prep_types, OBJ[id].ft_label))
+	return -1;
+    if (!OBJ[id].ft_bbox || !OBJ[id].ft_prep || !OBJ[id].ft_shot)
+	return -1;
+
+    /* the bounds must be finite, and known without prepping */
+    if (OBJ[id].ft_bbox(ip, &min, &max, &rtip->rti_tol) != 0)
+	return -1;
+    for (i = X; i <= Z; i++) {
+	if (!(min[i] <= max[i]) || min[i] <= -INFINITY || max[i] >= INFINITY)
+	    return -1;
+    }
+
+    BU_GET(lz, struct lazy_specific);
+    lz->stp = *stp;	/* struct copy */
+    lz->stp.l.forw = lz->stp.l.back = NULL;
+    lz->stp.l2.forw = lz->stp.l2.back = NULL;
+    memset(&lz->stp.st_regions, 0, sizeof(struct bu_ptbl));
+    memset(&lz->stp.st_path, 0, sizeof(struct db_full_path));
+    lz->stp.st_meth = &OBJ[id];
+    lz->stp.st_specific = NULL;
+    lz->stp.st_npieces = 0;
+    lz->stp.st_piece_rpps = NULL;
+    bu_mtx_init(&lz->mtx);
+    lazy_state_set(lz, LAZY_WAITING);
+
+    /* the box, with the slack of the solid's own prepped bounds */
+    VMOVE(stp->st_min, min);
+    VMOVE(stp->st_max, max);
+    for (i = X; i <= Z; i++) {
+	stp->st_min[i] -= rtip->rti_tol.dist;
+	stp->st_max[i] += rtip->rti_tol.dist;
+    }
+    VADD2SCALE(stp->st_center, stp->st_min, stp->st_max, 0.5);
+    stp->st_aradius = stp->st_bradius = 0.5 * DIST_PNT_PNT(stp->st_min, stp->st_max);
+    stp->st_npieces = 0;
+    stp->st_specific = (void *)lz;
+
+    bu_semaphore_acquire(RT_SEM_MODEL);
+    stp->st_meth = lazy_meth_get(id);
+    bu_semaphore_release(RT_SEM_MODEL);
+
+    if (RT_G_DEBUG&RT_DEBUG_SOLIDS)
+	bu_log("%s: %s prep deferred until first hit\n", stp->st_name, stp->st_meth->ft_label);
+    return 0;
+}
+
+
+int
+rt_lazy_prep_deferred(const struct soltab *stp)
+{
+    return stp->st_meth >= &lazy_meth[0] && stp->st_meth <= &lazy_meth[ID_MAX_SOLID];
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
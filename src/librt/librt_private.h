@@ -83,12 +83,13 @@ struct db_i_internal {
 
     /* PRIVATE fields previously in struct db_i (LIBRT ONLY, MAY CHANGE) */
     struct directory * dbi_Head[RT_DBNHASH]; /**< @brief object hash table */
+    bu_ohash * dbi_names;               /**< @brief d_namep to directory index, grows with the directory */
     FILE * dbi_fp;                      /**< @brief standard file pointer */
     b_off_t dbi_eof;                    /**< @brief End+1 pos after db_scan() */
     size_t dbi_nrec;                    /**< @brief # records after db_scan() */
     int dbi_dir_built;                  /**< @brief set to 1 when db_dirbuild() has completed */
     int dbi_uses;                       /**< @brief # of uses of this struct */
-    struct mem_map * dbi_freep;         /**< @brief map of free granules */
+    struct db_freemap * dbi_freemap;    /**< @brief index of free granules/bytes */
     void *dbi_inmem;                    /**< @brief ptr to in-memory copy */
     struct animate * dbi_anroot;        /**< @brief heads list of anim at root lvl */
     struct bu_mapped_file * dbi_mf;     /**< @brief Only in read-only mode */
@@ -104,11 +105,67 @@ struct db_i_internal {
 
     struct directory *dbi_directory_hd;         /**< @brief directory entry freelist */
     struct bu_ptbl   dbi_directory_blocks;      /**< @brief Table of malloc'ed blocks */
+
+    /* Write batch, see db_batch_begin() */
+    int dbi_batch_depth;                /**< @brief nesting depth of open batches, 0 if none */
+    b_off_t dbi_batch_addr;             /**< @brief file offset of dbi_batch_buf[0] */
+    uint8_t *dbi_batch_buf;             /**< @brief records not yet written to the file */
+    size_t dbi_batch_len;               /**< @brief bytes used in dbi_batch_buf */
+    size_t dbi_batch_cap;               /**< @brief bytes allocated for dbi_batch_buf */
 };
 
 struct db_i_internal * db_i_internal_create(void);
 void db_i_internal_destroy(struct db_i_internal *i);
 
+/**
+ * Hash d_namep into d_namehash, and put the entry on its dbi_Head
+ * chain and in the dbi_names index.  Entries leave both through
+ * db_dirdelete() and db_rename(), in constant time.
+ */
+void db_dirlink(struct db_i *dbip, struct directory *dp);
+
+/** dbi_Head chain for a d_namehash value */
+#define DB_DIRCHAIN(_dbip, _hash) (&(_dbip)->i->dbi_Head[(size_t)(_hash) & (RT_DBNHASH-1)])
+
+
+/**
+ * Free space index of a database file (db_freemap.cpp).  Blocks are
+ * coalesced with their neighbors as they are freed, and allocation
+ * is best fit, in O(log n) of the number of free blocks.  Units are
+ * the caller's: bytes for v5, granules for v4.
+ */
+struct db_freemap;
+
+struct db_freemap *db_freemap_create(void);
+void db_freemap_destroy(struct db_freemap *fm);
+
+/** Forget all free space, e.g. after a directory that was never built. */
+RT_EXPORT extern void db_freemap_clear(struct db_freemap *fm);
+
+/**
+ * Return [addr, addr+size) to the map.  Returns -1 without changing
+ * the map if any of it is already free.
+ */
+int db_freemap_free(struct db_freemap *fm, size_t size, b_off_t addr);
+
+/**
+ * Take size units from the smallest free block that holds them,
+ * returning the remainder of the block to the map.  Returns -1 if no
+ * block is large enough.
+ */
+int db_freemap_alloc(struct db_freemap *fm, size_t size, b_off_t *addr);
+
+/**
+ * Like db_freemap_alloc() but removes the whole block, reporting its
+ * size in blksize, for callers that must cover the block themselves
+ * (v5 free objects have a minimum size, so tails can't be split off
+ * blindly).
+ */
+int db_freemap_alloc_block(struct db_freemap *fm, size_t size, b_off_t *addr, size_t *blksize);
+
+/** Number of free blocks, and optionally their total and largest size. */
+size_t db_freemap_stats(const struct db_freemap *fm, size_t *total, size_t *largest);
+
 
 /**
  * Private internal state for struct rt_i.  All fields listed under
@@ -150,6 +207,11 @@ struct rt_i_internal {
     struct resource *   rti_submodel_resources[MAX_PSW]; /**< @brief private per-cpu resources for rt_submodel */
     size_t              rti_submodel_resource_refs;       /**< @brief number of rt_submodel users sharing the resource cache */
 
+    /* Instanced geometry */
+    struct bu_hash_tbl *rti_instance_protos;    /**< @brief  st_dp -> prepped geometry its rigid copies shoot */
+
+    /* Deferred prep */
+
     /* Dynamic geometry */
     int                 rti_add_to_new_solids_list;
     struct bu_ptbl      rti_new_solids;
@@ -375,6 +437,29 @@ extern void plot_ellipse(
 extern int _rt_tcl_list_to_int_array(const char *list, int **array, int *array_len);
 extern int _rt_tcl_list_to_fastf_array(const char *list, fastf_t **array, int *array_len);
 
+/**
+ * 1 if label is one of the ft_label names in list, which are separated
+ * by spaces or commas and matched without regard to case.  A NULL list
+ * names no types.
+ */
+extern int rt_functab_listed(const char *list, const char *label);
+
+/**
+ * Fill ft with the methods of a solid of type id that is shot through
+ * another soltab: OBJ[id]'s, with the given shot, print and release
+ * (as ft_free), and the given norm, uv and curve where OBJ[id] has
+ * them.  The methods
+ * that only make sense for a solid prepped in place (prep, pieces,
+ * classify, vshot and prep serialization) are left NULL.
+ */
+extern void rt_functab_wrap(struct rt_functab *ft, int id,
+	int (*shot)(struct soltab *stp, struct xray *rp, struct application *ap, struct seg *seghead),
+	void (*print)(const struct soltab *stp),
+	void (*norm)(struct hit *hitp, struct soltab *stp, struct xray *rp),
+	void (*uv)(struct application *ap, struct soltab *stp, struct hit *hitp, struct uvcoord *uvp),
+	void (*curve)(struct curvature *cvp, struct hit *hitp, struct soltab *stp),
+	void (*release)(struct soltab *stp));
+
 /* view.c */
 extern fastf_t solid_point_spacing(const struct bview *gvp, fastf_t solid_width);
 extern fastf_t view_avg_sample_spacing(const struct bview *gvp);
@@ -432,6 +517,83 @@ RT_EXPORT extern void _res_pieces_clean(struct resource *resp,
 RT_EXPORT extern void _res_pieces_init(struct resource *resp,
 					 struct rt_i *rtip);
 
+/**
+ * Give every NUMA node but the one each BoT in rtip was prepped on its
+ * own copy of the BoT's BVH and triangles, made by a thread bound to
+ * that node, for rt_bot_shot() and rt_bot_vshot() to read there.
+ * Returns the number of bytes the copies take (bot.c).
+ */
+extern size_t rt_bot_replicate(struct rt_i *rtip);
+
+/**
+ * The number of bytes a BoT's BVH, triangles and normals take once it
+ * has been prepped (bot.c).
+ */
+extern size_t rt_bot_prepped_bytes(const struct soltab *stp);
+
+/**
+ * Set rti_tess_prep from LIBRT_TESS_PREP ("exact", "optin" or "auto",
+ * or 0, 1 or 2), if it is set (tess_prep.c).
+ */
+extern void rt_tess_prep_select_from_env(struct rt_i *rtip);
+
+/**
+ * After stp has been prepped from ip, swap in a BoT prepped from its
+ * tessellation if rti_tess_prep, the object's tess_prep attribute and,
+ * in "auto", timing the two say to.  The timing is wall clock, so
+ * "auto" need not decide the same way twice; with measure 0 it is not
+ * done and "auto" keeps the analytic solid.  Returns 1 if stp is now a
+ * BoT, 0 if it was left as it was (tess_prep.c).
+ */
+extern int rt_tess_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip, int measure);
+
+/**
+ * Before the new soltab stp is prepped from ip, make it an instance of
+ * the prototype prepped for the same solid, if there is one and their
+ * matrices differ only by a rigid motion.  Returns 0 if stp is now an
+ * instance and needs no prep, -1 if it must be prepped (instance.c).
+ */
+extern int rt_instance_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip);
+
+/**
+ * Once stp has been prepped from ip, make it the prototype later
+ * placements of the same solid are instanced from, if there is none
+ * yet and its type may be instanced (instance.c).
+ */
+extern void rt_instance_register(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip);
+
+/**
+ * Called as the prototype stp is freed.  Returns 1 if its instances
+ * keep its prepped geometry, which ft_free must then be left alone,
+ * and 0 if stp is not a prototype (instance.c).
+ */
+extern int rt_instance_unshare(struct soltab *stp);
+
+/**
+ * The prototype the instance stp shoots, or NULL if stp is not an
+ * instance (instance.c).
+ */
+extern const struct soltab *rt_instance_proto(const struct soltab *stp);
+
+/**
+ * Set rti_lazy_prep from LIBRT_LAZY_PREP ("on" or "off", or 1 or 0), if
+ * it is set (lazy_prep.c).
+ */
+extern void rt_lazy_prep_select_from_env(struct rt_i *rtip);
+
+/**
+ * With rti_lazy_prep, give the new soltab stp only the bounds of ip and
+ * methods that prep it in full on the first ray to reach it.  Returns 0
+ * if its prep is deferred, -1 if it must be prepped now (lazy_prep.c).
+ */
+extern int rt_lazy_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip);
+
+/**
+ * 1 if the prep of stp was deferred by rt_lazy_prep(), whether or not
+ * it has been prepped since (lazy_prep.c).
+ */
+extern int rt_lazy_prep_deferred(const struct soltab *stp);
+
 
 /**
  * Generic flat-array ft_vshot() built on a scalar ft_shot().
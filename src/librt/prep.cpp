@@ -39,6 +39,7 @@
 #include "bio.h"
 
 
+#include "bu/hash.h"
 #include "bu/parallel.h"
 #include "vmath.h"
 #include "bn.h"
@@ -83,6 +84,9 @@ rt_i_internal_create(void)
     /* list of invisible light regions to be deleted after light_init() */
     bu_ptbl_init(&ip->delete_regs, 8, "rt_i delete regions list");
 
+    /* prototypes of the instanced solids, by directory entry */
+    ip->rti_instance_protos = bu_hash_create(64);
+
     VSETALL(ip->rti_inf_box.bn.bn_min, -0.1);
     VSETALL(ip->rti_inf_box.bn.bn_max,  0.1);
     ip->rti_inf_box.bn.bn_type = CUT_BOXNODE;
@@ -102,6 +106,7 @@ rt_i_internal_destroy(struct rt_i_internal *i)
 	return;
 
     bu_ptbl_free(&i->delete_regs);
+    bu_hash_destroy(i->rti_instance_protos);
 
     BU_PUT(i, struct rt_i_internal);
 }
@@ -163,6 +168,37 @@ rt_i_init(struct rt_i *rtip, struct db_i *dbip)
      */
     rtip->rti_space_partition = RT_PART_NUBSPT;
 
+    /* Primitives are only swapped for their tessellations when they
+     * ask for it, unless LIBRT_TESS_PREP says otherwise.
+     */
+    rtip->rti_tess_prep = RT_TESS_PREP_OPTIN;
+    rt_tess_prep_select_from_env(rtip);
+    rtip->rti_tess_prep_types = RT_TESS_PREP_TYPES_DEFAULT;
+    rtip->rti_tess_prep_ns = RT_TESS_PREP_NS_DEFAULT;
+
+    /* Rigidly moved copies of a solid are each prepped unless the
+     * application asks for them to shoot one prepped prototype.
+     */
+    rtip->rti_instance = 0;
+    rtip->rti_instance_types = RT_INSTANCE_TYPES_DEFAULT;
+
+    /* Every solid is prepped in rt_prep() unless LIBRT_LAZY_PREP or
+     * the application asks for the slow ones to wait for a ray.
+     */
+    rtip->rti_lazy_prep = 0;
+    rt_lazy_prep_select_from_env(rtip);
+    rtip->rti_lazy_prep_types = RT_LAZY_PREP_TYPES_DEFAULT;
+
+    /* Prepped data is only copied per NUMA node when asked for */
+    rtip->rti_numa_replicate = 0;
+
+    /* Per-primitive acceleration thresholds */
+    rtip->rti_pipe_minbvh = RT_PIPE_MINBVH_DEFAULT;
+    rtip->rti_bot_piece_tris = RT_BOT_PIECE_TRIS_DEFAULT;
+    rtip->rti_pipe_piece_segs = RT_PIPE_PIECE_SEGS_DEFAULT;
+    rtip->rti_metaball_minindex = RT_METABALL_MININDEX_DEFAULT;
+    rtip->rti_voxel_minpyramid = RT_VOXEL_MINPYRAMID_DEFAULT;
+
     /*
      * Zero the solid instancing counters in dbip database instance.
      * Done here because the same dbip could be used by multiple
@@ -449,6 +485,38 @@ rt_prep_parallel(struct rt_i *rtip, int ncpu)
     for (i=1; i<=CUT_MAXIMUM; i++) rtip->stats.rti_ncut_by_type[i] = 0;
     rt_cut_it(rtip, ncpu);
 
+    /* Per-NUMA-node copies of the read-mostly BoT data, if asked for */
+    if (rtip->rti_numa_replicate && bu_numa_nodes() > 1) {
+	size_t bytes = rt_bot_replicate(rtip);
+	if (bytes)
+	    bu_log("rt_prep_parallel: %.1f MB of BoT data replicated on %zu NUMA nodes\n",
+		   (double)bytes / (1024.0 * 1024.0), bu_numa_nodes());
+    }
+
+    /* What instancing saved */
+    rtip->stats.ninstances = 0;
+    rtip->stats.instance_bytes = 0;
+    RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
+	const struct soltab *proto = rt_instance_proto(stp);
+	if (proto) {
+	    rtip->stats.ninstances++;
+	    if (proto->st_id == ID_BOT)
+		rtip->stats.instance_bytes += rt_bot_prepped_bytes(proto);
+	}
+    } RT_VISIT_ALL_SOLTABS_END;
+    if ((RT_G_DEBUG&RT_DEBUG_SOLIDS) && rtip->stats.ninstances)
+	bu_log("rt_prep_parallel: %zu solids instanced, %.1f MB of BoT data not duplicated\n",
+	       rtip->stats.ninstances, (double)rtip->stats.instance_bytes / (1024.0 * 1024.0));
+
+    /* What is left to prep when rays reach it */
+    rtip->stats.ndeferred = 0;
+    RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
+	if (rt_lazy_prep_deferred(stp))
+	    rtip->stats.ndeferred++;
+    } RT_VISIT_ALL_SOLTABS_END;
+    if ((RT_G_DEBUG&RT_DEBUG_SOLIDS) && rtip->stats.ndeferred)
+	bu_log("rt_prep_parallel: %zu solids left to prep on their first hit\n", rtip->stats.ndeferred);
+
     /* Release storage used for bounding RPPs of solid "pieces" */
     RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
 	if (stp->st_piece_rpps) {
@@ -891,15 +959,6 @@ rt_init_resource(struct resource *resp, int cpu_num, struct rt_i *rtip)
      */
     bn_rand_init(resp->re_randptr, MAX_PSW*cpu_num);
 
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_seg))
-	BU_LIST_INIT(&resp->re_seg);
-
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_seg_blocks.l))
-	bu_ptbl_init(&resp->re_seg_blocks, 64, "re_seg_blocks ptbl");
-
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_parthead))
-	BU_LIST_INIT(&resp->re_parthead);
-
     if (!BU_LIST_IS_INITIALIZED(&resp->re_solid_bitv))
 	BU_LIST_INIT(&resp->re_solid_bitv);
 
@@ -917,6 +976,12 @@ rt_init_resource(struct resource *resp, int cpu_num, struct rt_i *rtip)
     resp->re_cpu = cpu_num;
     resp->re_magic = RESOURCE_MAGIC;
 
+    /* The segment and partition slabs, like the rest of the per-CPU
+     * storage, are created by the first RT_GET_SEG()/GET_PT() on the
+     * thread that uses the resource, not here, so that on NUMA
+     * machines their memory is first touched on that thread's node.
+     */
+
     if (rtip == NULL)
 	return;	/* only in rt_uniresource case */
 
@@ -950,20 +1015,13 @@ rt_clean_resource_basic(struct rt_i *rtip, struct resource *resp)
 
     RT_CK_RESOURCE(resp);
 
-    /* The 'struct seg' guys are malloc()ed in blocks, not
-     * individually, so they're kept track of two different ways.
+    /* The 'struct seg' and 'struct partition' guys live in the
+     * resource's slabs, which run the destructors as they go.
      */
-    BU_LIST_INIT(&resp->re_seg);	/* abandon the list of individuals */
-    if (BU_LIST_IS_INITIALIZED(&resp->re_seg_blocks.l)) {
-	struct seg **spp;
-	BU_CK_PTBL(&resp->re_seg_blocks);
-	for (BU_PTBL_FOR(spp, (struct seg **), &resp->re_seg_blocks)) {
-	    RT_CK_SEG(*spp);	/* Head of block will be a valid seg */
-	    bu_free((void *)(*spp), "struct seg block");
-	}
-	bu_ptbl_free(&resp->re_seg_blocks);
-	resp->re_seg_blocks.l.forw = BU_LIST_NULL;
-    }
+    bu_slab_destroy(resp->re_seg_slab);
+    resp->re_seg_slab = NULL;
+    bu_slab_destroy(resp->re_part_slab);
+    resp->re_part_slab = NULL;
 
     /* The "struct hitmiss' guys are individually malloc()ed */
     if (BU_LIST_IS_INITIALIZED(&re_nmgfree)) {
@@ -976,18 +1034,6 @@ rt_clean_resource_basic(struct rt_i *rtip, struct resource *resp)
 	re_nmgfree.forw = BU_LIST_NULL;
     }
 
-    /* The 'struct partition' guys are individually malloc()ed */
-    if (BU_LIST_IS_INITIALIZED(&resp->re_parthead)) {
-	struct partition *pp;
-	while (BU_LIST_WHILE(pp, partition, &resp->re_parthead)) {
-	    RT_CK_PT(pp);
-	    BU_LIST_DEQUEUE((struct bu_list *)pp);
-	    bu_ptbl_free(&pp->pt_seglist);
-	    bu_free((void *)pp, "struct partition");
-	}
-	resp->re_parthead.forw = BU_LIST_NULL;
-    }
-
     /* The 'struct bu_bitv' guys on re_solid_bitv are individually malloc()ed */
     if (BU_LIST_IS_INITIALIZED(&resp->re_solid_bitv)) {
 	struct bu_list *bl;
@@ -1177,6 +1223,10 @@ rt_clean(struct rt_i *rtip)
 	}
     }
     rtip->stats.nsolids = 0;
+    rtip->stats.ninstances = 0;
+    rtip->stats.instance_bytes = 0;
+    rtip->stats.ndeferred = 0;
+    rtip->stats.ndeferred_prepped = 0;
 
     /* Clean out the array of pointers to regions, if any */
     if (rtip->i->Regions) {
@@ -1881,6 +1931,18 @@ rt_reprep(struct rt_i *rtip, struct rt_reprep_obj_list *objs)
     }
     bu_free((char *)argv, "argv");
 
+    /* rt_gettrees() renumbered st_piecestate_num, so every resource's
+     * piece state is indexed wrong now.  rt_shootray() makes it again
+     * on the next ray. */
+    {
+	struct resource **rpp;
+	for (BU_PTBL_FOR(rpp, (struct resource **), &rtip->rti_resources)) {
+	    if (*rpp)
+		_res_pieces_clean(*rpp, rtip);
+	}
+	_res_pieces_clean(&rt_uniresource, rtip);
+    }
+
     rtip->needprep = 0;
 
     rtip->i->Regions = (struct region **)bu_realloc(rtip->i->Regions,
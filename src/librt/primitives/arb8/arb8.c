@@ -68,6 +68,7 @@
 #include "raytrace.h"
 
 #include "../../librt_private.h"
+#include "../plane_slab.h"
 
 
 #define RT_SLOPPY_DOT_TOL 0.0087 /* inspired by RT_DOT_TOL, but less tight (.5 deg) */
@@ -94,6 +95,7 @@ struct aface {
 struct arb_specific {
     int arb_nmfaces;		/* number of faces */
     struct oface *arb_opt;	/* pointer to optional info */
+    struct plane_slab arb_slab;	/* face planes, laid out to shoot */
     struct aface arb_face[6];	/* May really be up to [6] faces */
 };
 
@@ -1366,7 +1368,8 @@ rt_arb_setup(struct soltab *stp, struct rt_arb_internal *aip, struct rt_i *rtip,
 {
     register int i;
     struct prep_arb pa;
-    struct arb_specific *arbp = NULL;;
+    struct arb_specific *arbp = NULL;
+    int new_arbp = 0;
 
     RT_ARB_CK_MAGIC(aip);
 
@@ -1396,6 +1399,7 @@ rt_arb_setup(struct soltab *stp, struct rt_arb_internal *aip, struct rt_i *rtip,
 		sizeof(struct aface) * (pa.pa_faces - 4),
 		"arb_specific");
 	    stp->st_specific = (void *)arbp;
+	    new_arbp = 1;
 	}
 	arbp->arb_nmfaces = pa.pa_faces;
 	memcpy((char *)arbp->arb_face, (char *)pa.pa_face,
@@ -1439,6 +1443,15 @@ rt_arb_setup(struct soltab *stp, struct rt_arb_internal *aip, struct rt_i *rtip,
 
 	return rt_obj_prep(stp, &internal, rtip);
     }
+    /* the faces only change with the solid, so a second setup for
+     * UV's (which other threads may be shooting meanwhile) keeps the
+     * planes it has */
+    if (new_arbp) {
+	plane_slab_init(&arbp->arb_slab, pa.pa_faces);
+	for (i = 0; i < pa.pa_faces; i++)
+	    plane_slab_set(&arbp->arb_slab, i, arbp->arb_face[i].peqn, i);
+    }
+
     if (UNLIKELY(RT_G_DEBUG & RT_DEBUG_ARB8)) {
 	if (pa.pa_faces == 6 && !arb_is_planar(aip, NULL)) {
 	    bu_log("ARB8(%s) IS NON-PLANAR\n", stp->st_dp?stp->st_name:"_unnamed_");
@@ -1511,59 +1524,31 @@ rt_arb_shot(struct soltab *stp, register struct xray *rp, struct application *ap
     struct arb_specific *arbp = (struct arb_specific *)stp->st_specific;
     int iplane, oplane;
     fastf_t in, out;	/* ray in/out distances */
-    register struct aface *afp;
-    register int j;
-
-    in = -INFINITY;
-    out = INFINITY;
-    iplane = oplane = -1;
 
     if (RT_G_DEBUG & RT_DEBUG_ARB8) {
+	register struct aface *afp;
+	register int j;
+
 	bu_log("\n\n------------\n arb: ray point %g %g %g -> %g %g %g\n",
 	       V3ARGS(rp->r_pt),
 	       V3ARGS(rp->r_dir));
-    }
-
-    /* consider each face */
-    for (afp = &arbp->arb_face[j=arbp->arb_nmfaces-1]; j >= 0; j--, afp--) {
-	fastf_t dn;		/* Direction dot Normal */
-	fastf_t dxbdn;
-	fastf_t s;
+	for (afp = &arbp->arb_face[j=arbp->arb_nmfaces-1]; j >= 0; j--, afp--) {
+	    fastf_t dxbdn = VDOT(afp->peqn, rp->r_pt) - afp->peqn[W];
+	    fastf_t dn = -VDOT(afp->peqn, rp->r_dir);
 
-	/* XXX some of this math should be prep work
-	 * (including computing dxbdn/dn ?) *$*/
-	dxbdn = VDOT(afp->peqn, rp->r_pt) - afp->peqn[W];
-	dn = -VDOT(afp->peqn, rp->r_dir);
-
-	if (RT_G_DEBUG & RT_DEBUG_ARB8) {
 	    HPRINT("arb: Plane Equation", afp->peqn);
 	    bu_log("arb: dn=%g dxbdn=%g s=%g\n", dn, dxbdn, dxbdn/dn);
 	}
-
-	if (dn < -SQRT_SMALL_FASTF) {
-	    /* exit point, when dir.N < 0.  out = min(out, s) */
-	    if (out > (s = dxbdn/dn)) {
-		out = s;
-		oplane = j;
-	    }
-	} else if (dn > SQRT_SMALL_FASTF) {
-	    /* entry point, when dir.N > 0.  in = max(in, s) */
-	    if (in < (s = dxbdn/dn)) {
-		in = s;
-		iplane = j;
-	    }
-	} else {
-	    /* ray is parallel to plane when dir.N == 0.
-	     * If it is outside the solid, stop now.
-	     * Allow very small amount of slop, to catch
-	     * rays that lie very nearly in the plane of a face.
-	     */
-	    if (dxbdn > SQRT_SMALL_FASTF)
-		return 0;	/* MISS */
-	}
-	if (in > out)
-	    return 0;	/* MISS */
     }
+
+    /* consider each face: entering where dir.N < 0, leaving where
+     * dir.N > 0, and missing when parallel to and outside one, with a
+     * very small amount of slop to catch rays that lie very nearly in
+     * the plane of a face.
+     */
+    if (!plane_slab_shot(&arbp->arb_slab, rp->r_pt, rp->r_dir, SQRT_SMALL_FASTF, &in, &out, &iplane, &oplane))
+	return 0;	/* MISS */
+
     /* Validate */
     if (iplane == -1 || oplane == -1) {
 	const char *name = NULL;
@@ -1595,7 +1580,8 @@ rt_arb_shot(struct soltab *stp, register struct xray *rp, struct application *ap
 
 #define RT_ARB8_SEG_MISS(SEG)	(SEG).seg_stp=RT_SOLTAB_NULL
 /**
- * This is the Becker vector version
+ * Vectorized counterpart to rt_arb_shot().  Consecutive rays against
+ * the same ARB are tested two at a time against each of its faces.
  */
 C_DECL void
 rt_arb_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, struct application *ap)
@@ -1605,78 +1591,45 @@ rt_arb_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 /* Number of ray/object pairs */
 
 {
-    register int j, i;
+    register int i, k;
     register struct arb_specific *arbp;
-    fastf_t dn;		/* Direction dot Normal */
-    fastf_t dxbdn;
-    fastf_t s;
+    int iplane[2], oplane[2], hit[2];
+    fastf_t in[2], out[2];	/* ray in/out distances */
+    int npair;
 
     if (ap) RT_CK_APPLICATION(ap);
 
-    /* Initialize return values */
     for (i = 0; i < n; i++) {
-	segp[i].seg_stp = stp[i];	/* Assume hit, if 0 then miss */
-	segp[i].seg_in.hit_dist = -INFINITY;    /* used as in */
-	segp[i].seg_in.hit_surfno = -1;		/* used as iplane */
-	segp[i].seg_out.hit_dist = INFINITY;    /* used as out */
-	segp[i].seg_out.hit_surfno = -1;	/* used as oplane */
-/* segp[i].seg_next = SEG_NULL;*/
-    }
+	if (stp[i] == 0) continue;	/* skip this ray */
 
-    /* consider each face */
-    for (j = 0; j < 6; j++) {
-	/* for each ray/arb_face pair */
-	for (i = 0; i < n; i++) {
-	    if (stp[i] == 0) continue;	/* skip this ray */
-	    if (segp[i].seg_stp == 0) continue;	/* miss */
-
-	    arbp= (struct arb_specific *) stp[i]->st_specific;
-	    if (arbp->arb_nmfaces <= j)
-		continue; /* faces of this ARB are done */
-
-	    dxbdn = VDOT(arbp->arb_face[j].peqn, rp[i]->r_pt) -
-		arbp->arb_face[j].peqn[W];
-	    if ((dn = -VDOT(arbp->arb_face[j].peqn, rp[i]->r_dir)) < -SQRT_SMALL_FASTF) {
-		/* exit point, when dir.N < 0.  out = min(out, s) */
-		if (segp[i].seg_out.hit_dist > (s = dxbdn/dn)) {
-		    segp[i].seg_out.hit_dist = s;
-		    segp[i].seg_out.hit_surfno = j;
-		}
-	    } else if (dn > SQRT_SMALL_FASTF) {
-		/* entry point, when dir.N > 0.  in = max(in, s) */
-		if (segp[i].seg_in.hit_dist < (s = dxbdn/dn)) {
-		    segp[i].seg_in.hit_dist = s;
-		    segp[i].seg_in.hit_surfno = j;
-		}
-	    } else {
-		/* ray is parallel to plane when dir.N == 0.
-		 * If it is outside the solid, stop now */
-		if (dxbdn > SQRT_SMALL_FASTF) {
-		    RT_ARB8_SEG_MISS(segp[i]);		/* MISS */
-		}
-	    }
-	    if (segp[i].seg_in.hit_dist > segp[i].seg_out.hit_dist) {
-		RT_ARB8_SEG_MISS(segp[i]);		/* MISS */
-	    }
-	} /* for each ray/arb_face pair */
-    } /* for each arb_face */
+	arbp = (struct arb_specific *)stp[i]->st_specific;
 
-    /*
-     * Validate for each ray/arb_face pair
-     * Segment was initialized as "good" (seg_stp set valid);
-     * that is revoked here on misses.
-     */
-    for (i = 0; i < n; i++) {
-	if (stp[i] == 0) continue;		/* skip this ray */
-	if (segp[i].seg_stp == 0) continue;	/* missed */
-
-	if (segp[i].seg_in.hit_surfno == -1 ||
-	    segp[i].seg_out.hit_surfno == -1) {
-	    RT_ARB8_SEG_MISS(segp[i]);		/* MISS */
-	} else if (segp[i].seg_in.hit_dist >= segp[i].seg_out.hit_dist ||
-		   segp[i].seg_out.hit_dist >= INFINITY) {
-	    RT_ARB8_SEG_MISS(segp[i]);		/* MISS */
+	if (i + 1 < n && stp[i + 1] == stp[i]) {
+	    plane_slab_shot2(&arbp->arb_slab, rp[i]->r_pt, rp[i]->r_dir, rp[i + 1]->r_pt, rp[i + 1]->r_dir,
+			     SQRT_SMALL_FASTF, in, out, iplane, oplane, hit);
+	    npair = 2;
+	} else {
+	    hit[0] = plane_slab_shot(&arbp->arb_slab, rp[i]->r_pt, rp[i]->r_dir, SQRT_SMALL_FASTF,
+				     &in[0], &out[0], &iplane[0], &oplane[0]);
+	    npair = 1;
+	}
+
+	/*
+	 * Validate for each ray/arb pair
+	 */
+	for (k = 0; k < npair; k++) {
+	    if (!hit[k] || iplane[k] == -1 || oplane[k] == -1 ||
+		in[k] >= out[k] || out[k] >= INFINITY) {
+		RT_ARB8_SEG_MISS(segp[i + k]);		/* MISS */
+		continue;
+	    }
+	    segp[i + k].seg_stp = stp[i + k];
+	    segp[i + k].seg_in.hit_dist = in[k];
+	    segp[i + k].seg_in.hit_surfno = iplane[k];
+	    segp[i + k].seg_out.hit_dist = out[k];
+	    segp[i + k].seg_out.hit_surfno = oplane[k];
 	}
+	i += npair - 1;
     }
 }
 
@@ -1810,6 +1763,7 @@ rt_arb_free(register struct soltab *stp)
 
     if (arbp->arb_opt)
 	bu_free((void *)arbp->arb_opt, "arb_opt");
+    plane_slab_free(&arbp->arb_slab);
     bu_free((char *)arbp, "arb_specific");
 }
 
@@ -47,6 +47,14 @@
 #include "rt/nmg_conv.h"
 #include "raytrace.h"
 #include "../../librt_private.h"
+#include "../plane_slab.h"
+
+
+/* the internal form, stolen at prep, and its planes laid out to shoot */
+struct arbn_specific {
+    struct rt_arbn_internal *arbn;
+    struct plane_slab slab;
+};
 
 #ifdef USE_OPENCL
 /* largest data members first */
@@ -61,7 +69,7 @@ size_t
 clt_arbn_pack(struct bu_pool *pool, struct soltab *stp)
 {
     struct rt_arbn_internal *arb =
-	(struct rt_arbn_internal *)stp->st_specific;
+	((struct arbn_specific *)stp->st_specific)->arbn;
     struct clt_arbn_specific *args;
 
     cl_int j;
@@ -139,10 +147,55 @@ rt_arbn_bbox(struct rt_db_internal *ip, point_t *min, point_t *max, const struct
  *  0 OK
  * !0 failure
  */
+/**
+ * Lay the planes of aip out to be shot, in an order where each plane
+ * faces as far from those before it as it can.  A ray that misses
+ * usually finds itself behind one plane and in front of another
+ * facing away from it, so spreading the first few planes around the
+ * solid lets plane_slab_shot() give up early on most misses.
+ */
+static void
+arbn_slab_build(struct plane_slab *slab, const struct rt_arbn_internal *aip)
+{
+    fastf_t *near_dot;	/* largest dot with a normal already placed */
+    int *placed;
+    size_t i, j, k, next;
+
+    plane_slab_init(slab, aip->neqn);
+    near_dot = (fastf_t *)bu_malloc(aip->neqn * sizeof(fastf_t), "arbn near_dot[]");
+    placed = (int *)bu_calloc(aip->neqn, sizeof(int), "arbn placed[]");
+    for (i = 0; i < aip->neqn; i++)
+	near_dot[i] = -INFINITY;
+
+    next = 0;
+    for (i = 0; i < aip->neqn; i++) {
+	plane_slab_set(slab, i, aip->eqn[next], (int)next);
+	placed[next] = 1;
+
+	j = next;
+	next = aip->neqn;
+	for (k = 0; k < aip->neqn; k++) {
+	    fastf_t dot;
+	    if (placed[k])
+		continue;
+	    dot = VDOT(aip->eqn[k], aip->eqn[j]);
+	    if (dot > near_dot[k])
+		near_dot[k] = dot;
+	    if (next == aip->neqn || near_dot[k] < near_dot[next])
+		next = k;
+	}
+    }
+
+    bu_free(near_dot, "arbn near_dot[]");
+    bu_free(placed, "arbn placed[]");
+}
+
+
 C_DECL int
 rt_arbn_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
 {
     struct rt_arbn_internal *aip;
+    struct arbn_specific *arbn;
     vect_t work;
     fastf_t f;
     size_t i;
@@ -228,7 +281,10 @@ rt_arbn_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     }
     bu_free((char *)used, "arbn used[]");
 
-    stp->st_specific = (void *)aip;
+    BU_GET(arbn, struct arbn_specific);
+    arbn->arbn = aip;
+    arbn_slab_build(&arbn->slab, aip);
+    stp->st_specific = (void *)arbn;
     ip->idb_ptr = ((void *)0);	/* indicate we stole it */
 
     VADD2SCALE(stp->st_center, stp->st_min, stp->st_max, 0.5);
@@ -247,7 +303,7 @@ C_DECL void
 rt_arbn_print(const struct soltab *stp)
 {
     size_t i;
-    struct rt_arbn_internal *arbp = (struct rt_arbn_internal *)stp->st_specific;
+    struct rt_arbn_internal *arbp = ((struct arbn_specific *)stp->st_specific)->arbn;
 
     RT_ARBN_CK_MAGIC(arbp);
     bu_log("arbn bounded by %zu planes\n", arbp->neqn);
@@ -275,46 +331,17 @@ rt_arbn_print(const struct soltab *stp)
 C_DECL int
 rt_arbn_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct seg *seghead)
 {
-    struct rt_arbn_internal *aip =
-	(struct rt_arbn_internal *)stp->st_specific;
-    int i;
+    struct arbn_specific *arbn =
+	(struct arbn_specific *)stp->st_specific;
     int iplane, oplane;
     fastf_t in, out;	/* ray in/out distances */
 
-    in = -INFINITY;
-    out = INFINITY;
-    iplane = oplane = -1;
-
-    for (i = aip->neqn-1; i >= 0; i--) {
-	fastf_t slant_factor;	/* Direction dot Normal */
-	fastf_t norm_dist;
-	fastf_t s;
-
-	norm_dist = VDOT(aip->eqn[i], rp->r_pt) - aip->eqn[i][3];
-	if ((slant_factor = -VDOT(aip->eqn[i], rp->r_dir)) < -1.0e-10) {
-	    /* exit point, when dir.N < 0.  out = min(out, s) */
-	    if (out > (s = norm_dist/slant_factor)) {
-		out = s;
-		oplane = i;
-	    }
-	} else if (slant_factor > 1.0e-10) {
-	    /* entry point, when dir.N > 0.  in = max(in, s) */
-	    if (in < (s = norm_dist/slant_factor)) {
-		in = s;
-		iplane = i;
-	    }
-	} else {
-	    /* ray is parallel to plane when dir.N == 0.
-	     * If it is outside the solid, stop now
-	     * Allow very small amount of slop, to catch
-	     * rays that lie very nearly in the plane of a face.
-	     */
-	    if (norm_dist > SQRT_SMALL_FASTF)
-		return 0;	/* MISS */
-	}
-	if (in > out)
-	    return 0;	/* MISS */
-    }
+    /* planes with |dir.N| <= 1e-10 are parallel to the ray; if it is
+     * outside one of those it misses, allowing a very small amount of
+     * slop to catch rays that lie very nearly in the plane of a face.
+     */
+    if (!plane_slab_shot(&arbn->slab, rp->r_pt, rp->r_dir, 1.0e-10, &in, &out, &iplane, &oplane))
+	return 0;	/* MISS */
 
     /* Validate */
     if (iplane == -1 || oplane == -1) {
@@ -350,10 +377,10 @@ rt_arbn_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct
  *
  * Unlike the scalar shot, no seg is acquired from the resource free list
  * and no seg-list linkage is performed: results stream directly into the
- * contiguous segp[] array.  Eliminating that per-hit allocation and list
- * traffic is the data-coherency benefit of batching.  The per-ray
- * arithmetic is a verbatim copy of rt_arbn_shot() so the two paths agree
- * to the bit; hit_surfno is preserved for rt_arbn_norm().
+ * contiguous segp[] array.  Consecutive rays against the same soltab with
+ * few enough planes are tested two at a time against each plane with
+ * plane_slab_shot2(), which gives the same answers as rt_arbn_shot()
+ * does ray by ray; hit_surfno is preserved for rt_arbn_norm().
  */
 C_DECL void
 rt_arbn_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, struct application *ap)
@@ -367,69 +394,43 @@ rt_arbn_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, st
     if (ap) RT_CK_APPLICATION(ap);
 
     for (j = 0; j < n; j++) {
-	struct rt_arbn_internal *aip;
-	int i;
-	int iplane, oplane;
-	fastf_t in, out;	/* ray in/out distances */
+	struct arbn_specific *arbn;
+	int iplane[2], oplane[2], hit[2];
+	fastf_t in[2], out[2];	/* ray in/out distances */
+	int k, npair;
 
 	if (stp[j] == 0) continue;		/* skip this ray */
-	segp[j].seg_stp = (struct soltab *)0;	/* assume MISS */
-
-	aip = (struct rt_arbn_internal *)stp[j]->st_specific;
 
-	in = -INFINITY;
-	out = INFINITY;
-	iplane = oplane = -1;
+	arbn = (struct arbn_specific *)stp[j]->st_specific;
 
-	for (i = aip->neqn-1; i >= 0; i--) {
-	    fastf_t slant_factor;	/* Direction dot Normal */
-	    fastf_t norm_dist;
-	    fastf_t s;
-
-	    norm_dist = VDOT(aip->eqn[i], rp[j]->r_pt) - aip->eqn[i][3];
-	    if ((slant_factor = -VDOT(aip->eqn[i], rp[j]->r_dir)) < -1.0e-10) {
-		/* exit point, when dir.N < 0.  out = min(out, s) */
-		if (out > (s = norm_dist/slant_factor)) {
-		    out = s;
-		    oplane = i;
-		}
-	    } else if (slant_factor > 1.0e-10) {
-		/* entry point, when dir.N > 0.  in = max(in, s) */
-		if (in < (s = norm_dist/slant_factor)) {
-		    in = s;
-		    iplane = i;
-		}
-	    } else {
-		/* ray is parallel to plane when dir.N == 0.
-		 * If it is outside the solid, stop now
-		 * Allow very small amount of slop, to catch
-		 * rays that lie very nearly in the plane of a face.
-		 */
-		if (norm_dist > SQRT_SMALL_FASTF)
-		    goto miss;	/* MISS */
-	    }
-	    if (in > out)
-		goto miss;	/* MISS */
+	if (j + 1 < n && stp[j + 1] == stp[j] && arbn->slab.n <= PLANE_SLAB_PAIR_MAX) {
+	    plane_slab_shot2(&arbn->slab, rp[j]->r_pt, rp[j]->r_dir, rp[j + 1]->r_pt, rp[j + 1]->r_dir,
+			     1.0e-10, in, out, iplane, oplane, hit);
+	    npair = 2;
+	} else {
+	    hit[0] = plane_slab_shot(&arbn->slab, rp[j]->r_pt, rp[j]->r_dir, 1.0e-10,
+				     &in[0], &out[0], &iplane[0], &oplane[0]);
+	    npair = 1;
 	}
 
-	/* Validate */
-	if (iplane == -1 || oplane == -1) {
-	    /*bu_log("rt_arbn_shoot(%s): 1 hit => MISS\n", stp[j]->st_name);*/
-	    goto miss;	/* MISS */
-	}
-	if (in >= out || out >= INFINITY)
-	    goto miss;	/* MISS */
+	for (k = 0; k < npair; k++) {
+	    struct seg *sp = &segp[j + k];
 
-	segp[j].seg_stp = stp[j];
-	segp[j].seg_in.hit_dist = in;
-	segp[j].seg_in.hit_surfno = iplane;
+	    /* Validate */
+	    if (!hit[k] || iplane[k] == -1 || oplane[k] == -1
+		|| in[k] >= out[k] || out[k] >= INFINITY) {
+		sp->seg_stp = (struct soltab *)0;	/* MISS */
+		continue;
+	    }
 
-	segp[j].seg_out.hit_dist = out;
-	segp[j].seg_out.hit_surfno = oplane;
-	continue;
+	    sp->seg_stp = stp[j + k];
+	    sp->seg_in.hit_dist = in[k];
+	    sp->seg_in.hit_surfno = iplane[k];
 
-    miss:
-	segp[j].seg_stp = (struct soltab *)0;	/* MISS */
+	    sp->seg_out.hit_dist = out[k];
+	    sp->seg_out.hit_surfno = oplane[k];
+	}
+	j += npair - 1;
     }
 }
 
@@ -441,7 +442,7 @@ C_DECL void
 rt_arbn_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
 {
     struct rt_arbn_internal *aip =
-	(struct rt_arbn_internal *)stp->st_specific;
+	((struct arbn_specific *)stp->st_specific)->arbn;
     size_t h;
 
     VJOIN1(hitp->hit_point, rp->r_pt, hitp->hit_dist, rp->r_dir);
@@ -463,7 +464,7 @@ rt_arbn_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
 C_DECL void
 rt_arbn_curve(struct curvature *cvp, struct hit *hitp, struct soltab *stp)
 {
-    struct rt_arbn_internal *arbn = (struct rt_arbn_internal *)stp->st_specific;
+    struct rt_arbn_internal *arbn = ((struct arbn_specific *)stp->st_specific)->arbn;
 
     RT_ARBN_CK_MAGIC(arbn);
 
@@ -481,7 +482,7 @@ rt_arbn_curve(struct curvature *cvp, struct hit *hitp, struct soltab *stp)
 C_DECL void
 rt_arbn_uv(struct application *ap, struct soltab *stp, struct hit *hitp, struct uvcoord *uvp)
 {
-    struct rt_arbn_internal *arbn = (struct rt_arbn_internal *)stp->st_specific;
+    struct rt_arbn_internal *arbn = ((struct arbn_specific *)stp->st_specific)->arbn;
 
     if (ap) RT_CK_APPLICATION(ap);
     RT_ARBN_CK_MAGIC(arbn);
@@ -497,11 +498,13 @@ rt_arbn_uv(struct application *ap, struct soltab *stp, struct hit *hitp, struct
 C_DECL void
 rt_arbn_free(struct soltab *stp)
 {
-    struct rt_arbn_internal *aip =
-	(struct rt_arbn_internal *)stp->st_specific;
+    struct arbn_specific *arbn =
+	(struct arbn_specific *)stp->st_specific;
 
-    bu_free((char *)aip->eqn, "rt_arbn_internal eqn[]");
-    bu_free((char *)aip, "rt_arbn_internal");
+    plane_slab_free(&arbn->slab);
+    bu_free((char *)arbn->arbn->eqn, "rt_arbn_internal eqn[]");
+    bu_free((char *)arbn->arbn, "rt_arbn_internal");
+    BU_PUT(arbn, struct arbn_specific);
 }
 
 
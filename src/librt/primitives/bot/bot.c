@@ -45,6 +45,7 @@
 #define BOT_MIN_DN 1.0e-9
 #define HLBVH_STACK_SIZE 256
 #define RT_DEFAULT_MAX_PRIMS_IN_NODE 8
+#define BOT_MIN_PIECES 4		/* fewer than this, shoot it whole */
 
 static uint32_t
 bot_get_uint32(const unsigned char *cp)
@@ -370,8 +371,30 @@ struct spatial_partition_s {
     triangle_s *tris;
     fastf_t *vertex_normals; /* for deallocation, access normals
 				through triangle_s */
+    long nnodes;	/* BVH nodes in root[] */
+    int home;		/* NUMA node the prep ran on */
+    /* per-NUMA-node copies, NULL for home (see rt_bot_replicate()) */
+    struct spatial_partition_s **replicas;
+    size_t nreplicas;
+    /* root[] index of the subtree that is each of the soltab's
+     * st_npieces pieces, home copy only */
+    long *pieces;
 };
 
+
+/* The copy of sps the calling thread should read: its own node's, if
+ * the BoT has been replicated */
+static inline struct spatial_partition_s *
+bot_sps_local(struct spatial_partition_s *sps)
+{
+    if (sps->replicas) {
+	int node = bu_numa_node();
+	if (node >= 0 && (size_t)node < sps->nreplicas && sps->replicas[node])
+	    return sps->replicas[node];
+    }
+    return sps;
+}
+
 static int
 validate_bot_face(fastf_t centroid_out[3], fastf_t bounds_out[6], const struct rt_bot_internal *bot_ip, size_t face_index, const struct bn_tol *tolp)
 {
@@ -474,6 +497,68 @@ copy_bot_tri(triangle_s* tris, fastf_t* tri_norms, const struct rt_bot_internal
     tris[i].face_id = bot_ip_index;
 }
 
+/* Add to pieces[] the largest subtrees under node with at most
+ * per_piece triangles, or that are leaves.  Returns the number of
+ * triangles under node.
+ */
+static size_t
+bot_pieces_collect(const struct bvh_flat_node *root, long node, size_t per_piece, long *pieces, long *npieces)
+{
+    const struct bvh_flat_node *np = &root[node];
+    long left, right;
+    size_t nleft, nright;
+
+    if (np->n_primitives > 0)
+	return (size_t)np->n_primitives;
+
+    left = node + 1;
+    right = np->data.other_child - root;
+    nleft = bot_pieces_collect(root, left, per_piece, pieces, npieces);
+    nright = bot_pieces_collect(root, right, per_piece, pieces, npieces);
+    if (nleft + nright > per_piece) {
+	if (nleft <= per_piece || root[left].n_primitives > 0)
+	    pieces[(*npieces)++] = left;
+	if (nright <= per_piece || root[right].n_primitives > 0)
+	    pieces[(*npieces)++] = right;
+    }
+    return nleft + nright;
+}
+
+
+/* Hand big BoTs to the space partitioning as pieces, each a subtree
+ * of the BVH, so a cell only costs a ray the triangles near it and a
+ * first-hit ray stops before the far side of the mesh.  Plate mode
+ * segments reach past their hits, so those stay whole.
+ */
+static void
+bot_prep_pieces(struct soltab *stp, const struct bot_specific *bot, struct spatial_partition_s *sps, const struct rt_i *rtip)
+{
+    size_t per_piece = rtip ? rtip->rti_bot_piece_tris : RT_BOT_PIECE_TRIS_DEFAULT;
+    long npieces = 0;
+
+    if (!per_piece || bot->bot_ntri < BOT_MIN_PIECES * per_piece)
+	return;
+    if (bot->bot_mode == RT_BOT_PLATE || bot->bot_mode == RT_BOT_PLATE_NOCOS)
+	return;
+
+    sps->pieces = (long *)bu_malloc(sps->nnodes * sizeof(long), "bot pieces");
+    (void)bot_pieces_collect(sps->root, 0, per_piece, sps->pieces, &npieces);
+    if (npieces < BOT_MIN_PIECES) {
+	bu_free(sps->pieces, "bot pieces");
+	sps->pieces = NULL;
+	return;
+    }
+
+    stp->st_npieces = npieces;
+    stp->st_piece_rpps = (struct bound_rpp *)bu_malloc(npieces * sizeof(struct bound_rpp), "st_piece_rpps[]");
+    for (long i = 0; i < npieces; i++) {
+	const struct bvh_flat_node *np = &sps->root[sps->pieces[i]];
+	VMOVE(stp->st_piece_rpps[i].min, &np->bounds[0]);
+	VMOVE(stp->st_piece_rpps[i].max, &np->bounds[3]);
+    }
+}
+
+
 /**
  * Given a pointer to a GED database record, and a transformation
  * matrix, determine if this is a valid BOT, and if so, precompute
@@ -676,6 +761,11 @@ rt_bot_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     sps->root = flat_root;
     sps->tris = tris;
     sps->vertex_normals = tri_norms;
+    sps->nnodes = nodes_created;
+    sps->home = bu_numa_node();
+    sps->replicas = NULL;
+    sps->nreplicas = 0;
+    sps->pieces = NULL;
 
     bot->tie = (void *)sps;
 
@@ -695,6 +785,8 @@ rt_bot_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     stp->st_aradius = FMAX(dist_vec[0], FMAX(dist_vec[1], dist_vec[2]));
     stp->st_bradius = MAGNITUDE(dist_vec);
 
+    bot_prep_pieces(stp, bot, sps, rtip);
+
 #ifdef USE_OPENCL
     clt_bot_prep(stp, bot_ip, rtip);
 #endif
@@ -708,6 +800,20 @@ rt_bot_print(const struct soltab *UNUSED(stp))
 }
 
 
+/* Distance along rp to where it enters the BoT's bounding sphere (or
+ * a little before).  Shootray only sets r_min for solids that ask for
+ * the RPP check, which a BoT does not, so the walk can't trust it.
+ */
+static inline fastf_t
+bot_sphere_rmin(const struct soltab *stp, const struct xray *rp)
+{
+    vect_t to_center;
+
+    VSUB2(to_center, stp->st_center, rp->r_pt);
+    return VDOT(to_center, rp->r_dir) - stp->st_bradius;
+}
+
+
 /* Forward declare for rt_bot_shot */
 int
 rt_bot_makesegs(hit_da *hits,
@@ -878,6 +984,29 @@ bot_shot_hlbvh_flat(struct bvh_flat_node *root, struct xray* rp, triangle_s *tri
 THREADLOCAL hit_da hits_per_cpu = {0, 0, NULL};
 
 
+/* insertion sort by distance; there are rarely many */
+static void
+bot_sort_hits(hit_da *hits_da)
+{
+    size_t nhits = hits_da->count;
+    struct hit *hits = hits_da->items;
+
+    for (size_t i = 1; i < nhits; i++) {
+	fastf_t i_dist = hits[i].hit_dist;
+	struct hit swap = hits[i];
+	int j;
+	for (j = i-1; j >= 0; j--) {
+	    fastf_t j_dist = hits[j].hit_dist;
+	    if (j_dist < i_dist) {
+		break;
+	    }
+	    hits[j+1] = hits[j];
+	}
+	hits[j+1] = swap;
+    }
+}
+
+
 /**
  * Intersect a ray with a bot.  If an intersection occurs, a struct
  * seg will be acquired and filled in.
@@ -905,6 +1034,7 @@ rt_bot_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct
     struct spatial_partition_s *sps = (struct spatial_partition_s *)bot->tie;
     if (UNLIKELY(!sps))
 	return 0;
+    sps = bot_sps_local(sps);
 
     hits_per_cpu.count = 0; // New ray, new result count
 
@@ -916,32 +1046,117 @@ rt_bot_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct
 	toldist = (DBL_EPSILON * stp->st_aradius * 10);
     }
 
+    rp->r_min = bot_sphere_rmin(stp, rp);
     bot_shot_hlbvh_flat(sps->root, rp, sps->tris, bot->bot_ntri, &hits_per_cpu, toldist);
 
     if (hits_per_cpu.count == 0) {
 	return 0;
     }
-    // sort the hits
-    // insertion sort
-    {
-	size_t nhits = hits_per_cpu.count;
-	struct hit *hits = hits_per_cpu.items;
-	for (size_t i = 1; i < nhits; i++) {
-	    fastf_t i_dist = hits[i].hit_dist;
-	    struct hit swap = hits[i];
-	    int j;
-	    for (j = i-1; j >= 0; j--) {
-		fastf_t j_dist = hits[j].hit_dist;
-		if (j_dist < i_dist) {
-		    break;
-		}
-		hits[j+1] = hits[j];
-	    }
-	    hits[j+1] = swap;
+    bot_sort_hits(&hits_per_cpu);
+
+    return rt_bot_makesegs(&hits_per_cpu, stp, rp, ap, seghead, NULL);
+}
+
+
+/* A hit_da view of a piece state's hit table, so the BVH walk can
+ * append to it directly.  bot_da_to_htbl() hands the storage back.
+ */
+static inline void
+bot_htbl_to_da(struct rt_htbl *htab, hit_da *da)
+{
+    da->count = htab->end;
+    da->capacity = htab->blen;
+    da->items = htab->hits;
+}
+
+static inline void
+bot_da_to_htbl(hit_da *da, struct rt_htbl *htab)
+{
+    htab->end = da->count;
+    htab->blen = da->capacity;
+    htab->hits = da->items;
+}
+
+
+/**
+ * Intersect a ray with the pieces of a BoT listed in one space
+ * partitioning cell, skipping those already shot by this ray.  Each
+ * piece is a BVH subtree, walked whole, so its hits beyond the cell
+ * are kept too.  The hits go into psp->htab at their distances along
+ * the original ray and are made into segments by
+ * rt_bot_piece_hitsegs() once the ray has left the BoT's box.
+ *
+ * Returns the number of hits added.
+ */
+C_DECL int
+rt_bot_piece_shot(struct rt_piecestate *psp, struct rt_piecelist *plp, double dist_corr, struct xray *rp, struct application *ap, struct seg *UNUSED(seghead))
+{
+    struct soltab *stp;
+    struct bot_specific *bot;
+    struct spatial_partition_s *home, *sps;
+    struct xray ray;
+    hit_da hits;
+    size_t starting_hits;
+    fastf_t toldist = 0.0;
+
+    RT_CK_PIECESTATE(psp);
+    RT_CK_PIECELIST(plp);
+    stp = psp->stp;
+    RT_CK_SOLTAB(stp);
+    bot = (struct bot_specific *)stp->st_specific;
+    home = (struct spatial_partition_s *)bot->tie;
+    if (UNLIKELY(!home || !home->pieces))
+	return 0;
+    sps = bot_sps_local(home);
+
+    if (bot->bot_orientation != RT_BOT_UNORIENTED && bot->bot_mode == RT_BOT_SOLID)
+	toldist = (DBL_EPSILON * stp->st_aradius * 10);
+
+    /* Pieces are walked whole, not just past this cell, so start the
+     * culling back where the ray enters the BoT's box. */
+    ray = *rp;	/* struct copy */
+    ray.r_min = psp->mindist - dist_corr;
+    ray.r_max = psp->maxdist - dist_corr;
+
+    starting_hits = psp->htab.end;
+    bot_htbl_to_da(&psp->htab, &hits);
+    for (long i = (long)plp->npieces - 1; i >= 0; i--) {
+	long piecenum = plp->pieces[i];
+
+	if (BU_BITTEST(psp->shot, piecenum)) {
+	    ap->a_resource->re_piece_ndup++;
+	    continue;	/* this piece already shot */
 	}
+	BU_BITSET(psp->shot, piecenum);
+
+	bot_shot_hlbvh_flat(&sps->root[home->pieces[piecenum]], &ray, sps->tris, bot->bot_ntri, &hits, toldist);
     }
+    bot_da_to_htbl(&hits, &psp->htab);
 
-    return rt_bot_makesegs(&hits_per_cpu, stp, rp, ap, seghead, NULL);
+    for (size_t i = starting_hits; i < psp->htab.end; i++) {
+	psp->htab.hits[i].hit_dist += dist_corr;
+	psp->htab.hits[i].hit_rayp = &ap->a_ray;
+    }
+
+    return (int)(psp->htab.end - starting_hits);
+}
+
+
+/**
+ * Make segments from the hits rt_bot_piece_shot() gathered for one
+ * ray over all the cells it crossed.
+ */
+C_DECL void
+rt_bot_piece_hitsegs(struct rt_piecestate *psp, struct seg *seghead, struct application *ap)
+{
+    hit_da hits;
+
+    RT_CK_PIECESTATE(psp);
+    RT_CK_AP(ap);
+
+    bot_htbl_to_da(&psp->htab, &hits);
+    bot_sort_hits(&hits);
+    (void)rt_bot_makesegs(&hits, psp->stp, &ap->a_ray, ap, seghead, psp);
 }
 
 
@@ -1013,7 +1228,7 @@ bot_vshot_packet(struct soltab *stp, struct bot_specific *bot,
 	inv_dir[k][0] = bot_vshot_rdinv(rp[k]->r_dir[0]);
 	inv_dir[k][1] = bot_vshot_rdinv(rp[k]->r_dir[1]);
 	inv_dir[k][2] = bot_vshot_rdinv(rp[k]->r_dir[2]);
-	backout = FMAX(0.0, -rp[k]->r_min);
+	backout = FMAX(0.0, -bot_sphere_rmin(stp, rp[k]));
 	b_pt[k][X] = rp[k]->r_pt[X] - backout * rp[k]->r_dir[X];
 	b_pt[k][Y] = rp[k]->r_pt[Y] - backout * rp[k]->r_dir[Y];
 	b_pt[k][Z] = rp[k]->r_pt[Z] - backout * rp[k]->r_dir[Z];
@@ -1217,6 +1432,7 @@ rt_bot_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 	if (bot->bot_orientation != RT_BOT_UNORIENTED && bot->bot_mode == RT_BOT_SOLID)
 	    toldist = (DBL_EPSILON * stp[i]->st_aradius * 10);
 
+	sps = bot_sps_local(sps);
 	for (base = i; base < j; base += BOT_VSHOT_PACKET) {
 	    int pk = (j - base < BOT_VSHOT_PACKET) ? (j - base) : BOT_VSHOT_PACKET;
 	    bot_vshot_packet(stp[i], bot, sps, &rp[base], &segp[base], pk, ap, toldist);
@@ -1226,6 +1442,113 @@ rt_bot_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 }
 
 
+/* Copy a BoT's BVH and triangles; the calling thread allocates and
+ * fills the copy, so it lands on that thread's NUMA node. */
+static struct spatial_partition_s *
+bot_sps_copy(const struct spatial_partition_s *sps, size_t ntri)
+{
+    struct spatial_partition_s *rep;
+
+    BU_GET(rep, struct spatial_partition_s);
+    rep->nnodes = sps->nnodes;
+    rep->home = sps->home;
+    rep->replicas = NULL;
+    rep->nreplicas = 0;
+    rep->pieces = NULL;
+
+    rep->root = (struct bvh_flat_node *)bu_malloc(sps->nnodes * sizeof(struct bvh_flat_node), "bot bvh flat nodes");
+    memcpy(rep->root, sps->root, sps->nnodes * sizeof(struct bvh_flat_node));
+    for (long i = 0; i < sps->nnodes; i++) {
+	if (sps->root[i].n_primitives == 0)
+	    rep->root[i].data.other_child = rep->root + (sps->root[i].data.other_child - sps->root);
+    }
+
+    rep->tris = (triangle_s *)bu_malloc(ntri * sizeof(triangle_s), "bot triangles");
+    memcpy(rep->tris, sps->tris, ntri * sizeof(triangle_s));
+
+    rep->vertex_normals = NULL;
+    if (sps->vertex_normals) {
+	rep->vertex_normals = (fastf_t *)bu_malloc(ntri * 9 * sizeof(fastf_t), "bot norms");
+	memcpy(rep->vertex_normals, sps->vertex_normals, ntri * 9 * sizeof(fastf_t));
+	for (size_t i = 0; i < ntri; i++) {
+	    if (sps->tris[i].norms)
+		rep->tris[i].norms = rep->vertex_normals + (sps->tris[i].norms - sps->vertex_normals);
+	}
+    }
+
+    return rep;
+}
+
+
+size_t
+rt_bot_prepped_bytes(const struct soltab *stp)
+{
+    const struct bot_specific *bot = (const struct bot_specific *)stp->st_specific;
+    const struct spatial_partition_s *sps = bot ? (const struct spatial_partition_s *)bot->tie : NULL;
+
+    if (!sps)
+	return 0;
+    return sps->nnodes * sizeof(struct bvh_flat_node) + bot->bot_ntri * sizeof(triangle_s)
+	+ (sps->vertex_normals ? bot->bot_ntri * 9 * sizeof(fastf_t) : 0);
+}
+
+
+static void
+bot_replicate_node(int node, void *data)
+{
+    struct rt_i *rtip = (struct rt_i *)data;
+
+    for (size_t i = 0; i < rtip->i->rti_nsol_by_type[ID_BOT]; i++) {
+	struct soltab *stp = rtip->i->rti_sol_by_type[ID_BOT][i];
+
+	/* instances have their prototype's BoT replicated */
+	if (stp->st_meth != &OBJ[ID_BOT])
+	    continue;
+
+	struct bot_specific *bot = (struct bot_specific *)stp->st_specific;
+	struct spatial_partition_s *sps = bot ? (struct spatial_partition_s *)bot->tie : NULL;
+
+	if (!sps || !sps->replicas || node == sps->home || sps->replicas[node])
+	    continue;
+	sps->replicas[node] = bot_sps_copy(sps, bot->bot_ntri);
+    }
+}
+
+
+size_t
+rt_bot_replicate(struct rt_i *rtip)
+{
+    size_t nodes = bu_numa_nodes();
+    size_t bytes = 0;
+
+    RT_CK_RTI(rtip);
+
+    if (nodes < 2 || !rtip->i->rti_nsol_by_type[ID_BOT])
+	return 0;
+
+    /* the tables are set up here, so each node's thread only writes
+     * its own slot */
+    for (size_t i = 0; i < rtip->i->rti_nsol_by_type[ID_BOT]; i++) {
+	struct soltab *stp = rtip->i->rti_sol_by_type[ID_BOT][i];
+
+	if (stp->st_meth != &OBJ[ID_BOT])
+	    continue;
+
+	struct bot_specific *bot = (struct bot_specific *)stp->st_specific;
+	struct spatial_partition_s *sps = bot ? (struct spatial_partition_s *)bot->tie : NULL;
+
+	if (!sps || sps->replicas)
+	    continue;
+	sps->replicas = (struct spatial_partition_s **)bu_calloc(nodes, sizeof(struct spatial_partition_s *), "bot replicas");
+	sps->nreplicas = nodes;
+	bytes += (nodes - 1) * rt_bot_prepped_bytes(stp);
+    }
+
+    bu_numa_run(bot_replicate_node, rtip);
+    return bytes;
+}
+
+
 /**
  * Given ONE ray distance, return the normal and entry/exit point.
  */
@@ -1351,6 +1674,19 @@ rt_bot_free(struct soltab *stp)
 
     if (bot && bot->tie) {
 	struct spatial_partition_s *sps = (struct spatial_partition_s*)bot->tie;
+	for (size_t i = 0; i < sps->nreplicas; i++) {
+	    struct spatial_partition_s *rep = sps->replicas[i];
+	    if (!rep)
+		continue;
+	    bu_free(rep->root, "bot bvh flat nodes");
+	    bu_free(rep->tris, "bot triangles");
+	    bu_free(rep->vertex_normals, "bot normals");
+	    BU_PUT(rep, struct spatial_partition_s);
+	}
+	if (sps->replicas)
+	    bu_free(sps->replicas, "bot replicas");
+	if (sps->pieces)
+	    bu_free(sps->pieces, "bot pieces");
 	bu_free(sps->root, "bot bvh flat nodes");
 	bu_free(sps->tris, "bot triangles");
 	bu_free(sps->vertex_normals, "bot normals");
@@ -131,6 +131,13 @@ struct dsp_rpp {
  * This structure contains a bounding box for a portion of the DSP
  * along with information about sub-bounding boxes, and what layer
  * (resolution) of the DSP this box bounds
+ *
+ * The children of a box are stored next to each other, a row of
+ * dspb_ch_dim[X] at a time from its low corner, and the groups of
+ * children follow the order of their parents.  Each 4x4 block of a
+ * layer is therefore one contiguous run, and the blocks nest the same
+ * way up the tree, so a ray walking down through the boxes touches a
+ * handful of cache lines rather than rows of a large grid.
  */
 struct dsp_bb {
     uint32_t magic;
@@ -140,24 +147,33 @@ struct dsp_bb {
      * sub-bounding rpps.
      *
      * dsp_b_ch_dim is typically DIM_BB_CHILDREN, DIM_BB_CHILDREN
-     * except for "border" areas of the array
+     * except for "border" areas of the array, and 0, 0 on layer 0
      */
-    unsigned short dspb_subcell_size;/* XXX This is not yet computed */
+    unsigned short dspb_subcell_size;
     unsigned short dspb_ch_dim[2];	/* dimensions of children[] */
-    struct dsp_bb *dspb_children[NUM_BB_CHILDREN];
+    unsigned short dspb_cut;	/* layer 0: the cell's DSP_CUT_DIR_* */
+    union {
+	struct dsp_bb *children;	/* first of dspb_ch_dim[X] * dspb_ch_dim[Y] */
+	unsigned short elev[4];	/* layer 0: elevations at corners A, B, C, D */
+    } dspb_u;
 };
+#define dspb_children dspb_u.children
+#define dspb_elev dspb_u.elev
 
 
 #define MAGIC_dsp_bb 234
 #define DSP_BB_CK(_p) BU_CKMAG(_p, MAGIC_dsp_bb, "dsp_bb")
+
+/* deepest bounding box tree, enough for 2^32 posts on a side */
+#define DSP_MAX_LAYERS 17
+
 /*
  * This structure provides a handle to all of the bounding boxes for
  * the DSP at a particular resolution.
  */
-#define LAYER(l, x, y) l->p[l->dim[1]*y+x]
 struct dsp_bb_layer {
     unsigned int dim[2]; /* the dimensions of the array at element p */
-    struct dsp_bb *p; /* array of dsp_bb's for this level */
+    struct dsp_bb *p; /* array of dsp_bb's for this level, parent by parent */
 };
 
 # define XCNT(_p) (((struct rt_dsp_internal *)_p)->dsp_xcnt)
@@ -441,8 +457,8 @@ static void
 plot_layers(struct dsp_specific *dsp_sp)
 {
     FILE *fp;
-    int l, n;
-    unsigned int x, y;
+    int l;
+    unsigned int n;
     char buf[32];
     static int colors[7][3] = {
 	{255, 0, 0},
@@ -474,13 +490,10 @@ plot_layers(struct dsp_specific *dsp_sp)
 	g = colors[c][1];
 	b = colors[c][2];
 
-	for (y = 0; y < dsp_sp->layer[l].dim[Y]; y+= 2) {
-	    for (x = 0; x < dsp_sp->layer[l].dim[X]; x+= 2) {
-		n = y * dsp_sp->layer[l].dim[X] + x;
-		d_bb = &dsp_sp->layer[l].p[n];
-		plot_dsp_bb(fp, d_bb, dsp_sp, r, g, b, 0);
-
-	    }
+	/* every other box, to keep the plot readable */
+	for (n = 0; n < dsp_sp->layer[l].dim[X] * dsp_sp->layer[l].dim[Y]; n += 2) {
+	    d_bb = &dsp_sp->layer[l].p[n];
+	    plot_dsp_bb(fp, d_bb, dsp_sp, r, g, b, 0);
 	}
 	fclose(fp);
     }
@@ -572,10 +585,13 @@ rt_dsp_print(register const struct soltab *stp)
  * compute bounding boxes for each cell, then compute bounding boxes
  * for collections of bounding boxes
  *
+ * The boxes are laid out top down, each parent handing its children
+ * the next run of the layer below (see struct dsp_bb), and then
+ * filled in bottom up.  Layer 0 keeps the four corner elevations of
+ * its cell and the way it is cut into triangles, so the intersection
+ * code never has to go back to the row-major elevation array.
+ *
  * Performance notes:
- * - bu_calloc is used so that leaf-cell children[] pointers start as
- *   NULL without a per-cell initialization loop, saving significant
- *   work for large DSPs (a 4096x4096 terrain has ~16.7M leaf cells).
  * - The DIM_BB_CHILDREN^curr_layer multiplier (n) is computed once per
  *   layer rather than once per cell, avoiding a pow() call in the
  *   inner loop.
@@ -584,14 +600,14 @@ static void
 dsp_layers(struct dsp_specific *dsp, unsigned short *d_min, unsigned short *d_max)
 {
     int idx, curr_layer, xs, ys, xv, yv, tot, n;
-    unsigned int x, y, i, j;
+    unsigned int x, y, i, j, k, nbb, nkids;
+    unsigned int *pos, *kid_pos;
     unsigned short dsp_min, dsp_max;
-    unsigned short elev;
+    unsigned short elev[4];
     struct dsp_bb *dsp_bb;
     struct dsp_rpp *t;
-	int tot2, xp, yp;
+    int xp, yp;
     struct dsp_bb_layer *curr, *prev;
-    unsigned short subcell_size;
 
     /* First we compute the total number of struct dsp_bb's we will need */
     xs = dsp->xsiz;
@@ -625,162 +641,158 @@ dsp_layers(struct dsp_specific *dsp, unsigned short *d_min, unsigned short *d_ma
 	bu_log("%d layers total\n", dsp->layers);
 #endif
 
-    /* allocate the struct dsp_bb's we will need.
-     * bu_calloc zeros all children[] pointers to NULL up front, avoiding
-     * the O(16*N) initialization loop that was previously in the leaf
-     * cell fill pass below.
-     */
+    /* allocate the struct dsp_bb's we will need */
     dsp->layer = (struct dsp_bb_layer *)bu_calloc(dsp->layers, sizeof(struct dsp_bb_layer),
 			   "dsp_bb_layers array");
     dsp->bb_array = (struct dsp_bb *)bu_calloc(tot, sizeof(struct dsp_bb), "dsp_bb array");
 
-    /* now we fill in the "lowest" layer of struct dsp_bb's from the
-     * raw data
-     */
+    /* size each layer and set the start of its array */
     dsp->layer[0].dim[X] = dsp->xsiz;
     dsp->layer[0].dim[Y] = dsp->ysiz;
     dsp->layer[0].p = dsp->bb_array;
 
-    dsp_min = 0xffff;
-    dsp_max = 0;
-
-    for (y = 0; y < YSIZ(dsp); y++) {
-
-	unsigned short cell_min = 0xffff;
-	unsigned short cell_max = 0;
+    for (curr_layer = 1; curr_layer < dsp->layers; curr_layer++) {
+	prev = &dsp->layer[curr_layer-1];
+	curr = &dsp->layer[curr_layer];
 
-	for (x = 0; x < XSIZ(dsp); x++) {
+	curr->dim[X] = prev->dim[X] / DIM_BB_CHILDREN;
+	if (prev->dim[X] % DIM_BB_CHILDREN)
+	    curr->dim[X]++;
+	curr->dim[Y] = prev->dim[Y] / DIM_BB_CHILDREN;
+	if (prev->dim[Y] % DIM_BB_CHILDREN)
+	    curr->dim[Y]++;
 
-	    elev = DSP(&dsp->dsp_i, x, y);
-	    cell_min = cell_max = elev;
+	curr->p = &prev->p[prev->dim[X] * prev->dim[Y]];
+    }
 
-	    elev = DSP(&dsp->dsp_i, x+1, y);
-	    V_MIN(cell_min, elev);
-	    V_MAX(cell_max, elev);
+    /* lay out the layers from the top down.  pos[] holds the grid
+     * position (y * dim[X] + x) of each box of the current layer in
+     * the order they are stored, and kid_pos[] collects the same for
+     * the layer below as each box claims its children.
+     */
+    pos = (unsigned int *)bu_malloc(sizeof(unsigned int), "dsp_bb positions");
+    pos[0] = 0;
 
-	    elev = DSP(&dsp->dsp_i, x, y+1);
-	    V_MIN(cell_min, elev);
-	    V_MAX(cell_max, elev);
+    for (curr_layer = dsp->layers - 1; curr_layer > 0; curr_layer--) {
+	curr = &dsp->layer[curr_layer];
+	prev = &dsp->layer[curr_layer-1];
 
-	    elev = DSP(&dsp->dsp_i, x+1, y+1);
-	    V_MIN(cell_min, elev);
-	    V_MAX(cell_max, elev);
+	/* n = DIM_BB_CHILDREN^curr_layer, computed with integer arithmetic */
+	n = 1;
+	for (idx = 0; idx < curr_layer; idx++)
+	    n *= DIM_BB_CHILDREN;
 
-	    /* factor the cell min/max into the overall min/max */
-	    V_MIN(dsp_min, cell_min);
-	    V_MAX(dsp_max, cell_max);
+	if (RT_G_DEBUG & RT_DEBUG_HF)
+	    bu_log("layer %d  subcell size %d\n", curr_layer, n / DIM_BB_CHILDREN);
 
-	    /* fill in the dsp_rpp cell min/max */
-	    i = y*XSIZ(dsp) + x;
-	    dsp_bb = &dsp->layer[0].p[i];
-	    VSET(dsp_bb->dspb_rpp.dsp_min, x, y, cell_min);
-	    VSET(dsp_bb->dspb_rpp.dsp_max, x+1, y+1, cell_max);
+	kid_pos = (unsigned int *)bu_malloc(prev->dim[X] * prev->dim[Y] * sizeof(unsigned int),
+					    "dsp_bb positions");
+	nkids = 0;
+	nbb = curr->dim[X] * curr->dim[Y];
 
-	    /* dspb_subcell_size, dspb_ch_dim[X/Y], and dspb_children[]
-	     * are already 0/NULL from the bu_calloc above.
-	     * There are no children of a layer 0 element.
+	for (k = 0; k < nbb; k++) {
+	    /* x, y are in the coordinates in the current
+	     * layer.  xp, yp are the coordinates of the
+	     * same area in the previous (lower) layer.
 	     */
+	    x = pos[k] % curr->dim[X];
+	    y = pos[k] / curr->dim[X];
+	    xp = x * DIM_BB_CHILDREN;
+	    yp = y * DIM_BB_CHILDREN;
+
+	    /* initialize the current dsp_bb cell */
+	    dsp_bb = &curr->p[k];
 	    dsp_bb->magic = MAGIC_dsp_bb;
+	    VSET(dsp_bb->dspb_rpp.dsp_min,
+		 x * n, y * n, 0x0ffff);
+	    VSET(dsp_bb->dspb_rpp.dsp_max,
+		 x * n, y * n, 0);
+	    dsp_bb->dspb_subcell_size = n / DIM_BB_CHILDREN;
+	    dsp_bb->dspb_children = &prev->p[nkids];
+
+	    i = 0;
+	    for (j = 0; j < DIM_BB_CHILDREN && (yp+j)<prev->dim[Y]; j++) {
+		for (i = 0; i < DIM_BB_CHILDREN && (xp+i)<prev->dim[X]; i++)
+		    kid_pos[nkids++] = (yp+j) * prev->dim[X] + xp+i;
+	    }
 
-	    /* XXX should we compute the triangle orientation and
-	     * save it here too?
-	     */
+	    /* record the dimensions of our children */
+	    dsp_bb->dspb_ch_dim[X] = i;
+	    dsp_bb->dspb_ch_dim[Y] = j;
 	}
+
+	bu_free(pos, "dsp_bb positions");
+	pos = kid_pos;
     }
 
-    *d_min = dsp_min;
-    *d_max = dsp_max;
+    /* now we fill in the "lowest" layer of struct dsp_bb's from the
+     * raw data, in the order it was laid out above
+     */
+    dsp_min = 0xffff;
+    dsp_max = 0;
 
+    nbb = dsp->layer[0].dim[X] * dsp->layer[0].dim[Y];
+    for (k = 0; k < nbb; k++) {
+	unsigned short cell_min, cell_max;
 
-    if (RT_G_DEBUG & RT_DEBUG_HF)
-	bu_log("layer 0 filled\n");
+	x = pos[k] % dsp->layer[0].dim[X];
+	y = pos[k] / dsp->layer[0].dim[X];
 
-    subcell_size = 1;
+	elev[0] = DSP(&dsp->dsp_i, x, y);
+	elev[1] = DSP(&dsp->dsp_i, x+1, y);
+	elev[2] = DSP(&dsp->dsp_i, x, y+1);
+	elev[3] = DSP(&dsp->dsp_i, x+1, y+1);
 
-    /* now we compute successive layers from the initial layer.
-     * n (= DIM_BB_CHILDREN^curr_layer) is computed once per layer
-     * to avoid a pow() call inside the inner x/y loop.
-     */
-    for (curr_layer = 1; curr_layer < dsp->layers; curr_layer++) {
-	/* compute the number of cells in each direction for this layer */
+	cell_min = cell_max = elev[0];
+	for (i = 1; i < 4; i++) {
+	    V_MIN(cell_min, elev[i]);
+	    V_MAX(cell_max, elev[i]);
+	}
 
-	/* n = DIM_BB_CHILDREN^curr_layer, computed with integer arithmetic */
-	n = 1;
-	for (idx = 0; idx < curr_layer; idx++)
-	    n *= DIM_BB_CHILDREN;
+	/* factor the cell min/max into the overall min/max */
+	V_MIN(dsp_min, cell_min);
+	V_MAX(dsp_max, cell_max);
 
-	xs = dsp->layer[curr_layer-1].dim[X];
-	if (xs % DIM_BB_CHILDREN)
-	    dsp->layer[curr_layer].dim[X] =
-		xs / DIM_BB_CHILDREN + 1;
-	else
-	    dsp->layer[curr_layer].dim[X] =
-		xs / DIM_BB_CHILDREN;
+	/* fill in the dsp_rpp cell min/max.  dspb_subcell_size and
+	 * dspb_ch_dim[X/Y] are already 0 from the bu_calloc above.
+	 * There are no children of a layer 0 element.
+	 */
+	dsp_bb = &dsp->layer[0].p[k];
+	dsp_bb->magic = MAGIC_dsp_bb;
+	VSET(dsp_bb->dspb_rpp.dsp_min, x, y, cell_min);
+	VSET(dsp_bb->dspb_rpp.dsp_max, x+1, y+1, cell_max);
+	for (i = 0; i < 4; i++)
+	    dsp_bb->dspb_elev[i] = elev[i];
+	dsp_bb->dspb_cut = rt_dsp_cell_cut(&dsp->dsp_i, x, y,
+					   (size_t)dsp->xsiz, (size_t)dsp->ysiz);
+    }
+    bu_free(pos, "dsp_bb positions");
 
-	ys = dsp->layer[curr_layer-1].dim[Y];
-	if (ys % DIM_BB_CHILDREN)
-	    dsp->layer[curr_layer].dim[Y] =
-		ys / DIM_BB_CHILDREN + 1;
-	else
-	    dsp->layer[curr_layer].dim[Y] =
-		ys / DIM_BB_CHILDREN;
+    *d_min = dsp_min;
+    *d_max = dsp_max;
 
-	/* set the start of the array for this layer */
-	dsp->layer[curr_layer].p =
-	    &dsp->layer[curr_layer-1].p[dsp->layer[curr_layer-1].dim[X] * dsp->layer[curr_layer-1].dim[Y] ];
 
+    if (RT_G_DEBUG & RT_DEBUG_HF)
+	bu_log("layer 0 filled\n");
+
+    /* now we compute successive layers from the initial layer */
+    for (curr_layer = 1; curr_layer < dsp->layers; curr_layer++) {
 	curr = &dsp->layer[curr_layer];
-	prev = &dsp->layer[curr_layer-1];
+	nbb = curr->dim[X] * curr->dim[Y];
 
-	if (RT_G_DEBUG & RT_DEBUG_HF)
-	    bu_log("layer %d  subcell size %d\n", curr_layer, subcell_size);
-
-	/* walk the grid and fill in the values for this layer */
-	for (y = 0; y < curr->dim[Y]; y++) {
-	    for (x = 0; x < curr->dim[X]; x++) {
-		/* x, y are in the coordinates in the current
-		 * layer.  xp, yp are the coordinates of the
-		 * same area in the previous (lower) layer.
-		 */
-		xp = x * DIM_BB_CHILDREN;
-		yp = y * DIM_BB_CHILDREN;
-
-		/* initialize the current dsp_bb cell */
-		dsp_bb = &curr->p[y*curr->dim[X]+x];
-		dsp_bb->magic = MAGIC_dsp_bb;
-		VSET(dsp_bb->dspb_rpp.dsp_min,
-		     x * n, y * n, 0x0ffff);
-		VSET(dsp_bb->dspb_rpp.dsp_max,
-		     x * n, y * n, 0);
-
-		/* record the dimensions of our children */
-		dsp_bb->dspb_subcell_size = subcell_size;
-
-		/* dspb_children[] already NULL from bu_calloc */
-		tot2 = 0;
-		i = 0;
-		for (j = 0; j < DIM_BB_CHILDREN && (yp+j)<prev->dim[Y]; j++) {
-		    for (i = 0; i < DIM_BB_CHILDREN && (xp+i)<prev->dim[X]; i++) {
-
-			idx = (yp+j) * prev->dim[X] + xp+i;
-
-			t = &prev->p[ idx ].dspb_rpp;
-
-			VMINMAX(dsp_bb->dspb_rpp.dsp_min,
-				dsp_bb->dspb_rpp.dsp_max, t->dsp_min);
-			VMINMAX(dsp_bb->dspb_rpp.dsp_min,
-				dsp_bb->dspb_rpp.dsp_max, t->dsp_max);
-
-			dsp_bb->dspb_children[tot2++] = &prev->p[ idx ];
-
-		    }
-		}
+	for (k = 0; k < nbb; k++) {
+	    dsp_bb = &curr->p[k];
+	    nkids = dsp_bb->dspb_ch_dim[X] * dsp_bb->dspb_ch_dim[Y];
+
+	    for (i = 0; i < nkids; i++) {
+		t = &dsp_bb->dspb_children[i].dspb_rpp;
 
-		dsp_bb->dspb_ch_dim[X] = i;
-		dsp_bb->dspb_ch_dim[Y] = j;
+		VMINMAX(dsp_bb->dspb_rpp.dsp_min,
+			dsp_bb->dspb_rpp.dsp_max, t->dsp_min);
+		VMINMAX(dsp_bb->dspb_rpp.dsp_min,
+			dsp_bb->dspb_rpp.dsp_max, t->dsp_max);
 	    }
 	}
-	subcell_size *= DIM_BB_CHILDREN;
     }
 
 #ifdef PLOT_LAYERS
@@ -1541,10 +1553,8 @@ permute_cell(point_t A,
 	     point_t C,
 	     point_t D,
 	     struct dsp_specific *dsp,
-	     struct dsp_rpp *dsp_rpp)
+	     struct dsp_bb *dsp_bb)
 {
-    int x, y;
-
 
 #ifdef FULL_DSP_DEBUGGING
     if (RT_G_DEBUG & RT_DEBUG_HF) {
@@ -1562,13 +1572,11 @@ permute_cell(point_t A,
 
 	case DSP_CUT_DIR_ADAPT: {
 	    point_t tmp;
-	    size_t cx = (size_t)dsp_rpp->dsp_min[X];
-	    size_t cy = (size_t)dsp_rpp->dsp_min[Y];
 
 	    if (RT_G_DEBUG & RT_DEBUG_HF)
 		bu_log("cell %d, %d adaptive triangulation... ",
-		       dsp_rpp->dsp_min[X],
-		       dsp_rpp->dsp_min[Y]);
+		       dsp_bb->dspb_rpp.dsp_min[X],
+		       dsp_bb->dspb_rpp.dsp_min[Y]);
 
 	    /*
 	     * We look at the points in the diagonal next cells to
@@ -1589,16 +1597,10 @@ permute_cell(point_t A,
 	     *	*  *  *	 *
 	     */
 
-	    /* leaf-cell precondition: the rpp spans exactly one grid unit, so
-	     * (cx, cy) plus the cell counts fully describe the curvature
-	     * stencil that rt_dsp_cell_cut() recomputes.
+	    /* dsp_layers() ran rt_dsp_cell_cut() on each cell ahead
+	     * of time
 	     */
-	    BU_ASSERT(dsp_rpp->dsp_max[X] == dsp_rpp->dsp_min[X] + 1);
-	    BU_ASSERT(dsp_rpp->dsp_max[Y] == dsp_rpp->dsp_min[Y] + 1);
-
-	    if (rt_dsp_cell_cut(&dsp->dsp_i, cx, cy,
-			     (size_t)dsp->xsiz, (size_t)dsp->ysiz)
-		== DSP_CUT_DIR_llUR) {
+	    if (dsp_bb->dspb_cut == DSP_CUT_DIR_llUR) {
 		/* A-D cut is fine, no need to permute */
 		if (RT_G_DEBUG & RT_DEBUG_HF)
 		    bu_log("A-D cut\n");
@@ -1620,30 +1622,29 @@ permute_cell(point_t A,
 
 	    break;
 	}
-	case DSP_CUT_DIR_ULlr:
-	    /* assign the values for the corner points
+	case DSP_CUT_DIR_ULlr: {
+	    point_t tmp;
+
+	    /* relabel the corner points, turning the cell a quarter
+	     * turn as the adaptive B-C cut does.  Mirroring them
+	     * instead would reverse the triangles' winding, and their
+	     * normals would point down into the terrain.
 	     *
-	     *  D----C
+	     *  D----B
 	     *  |    |
 	     *  |    |
 	     *  |    |
-	     *  B----A
+	     *  C----A
 	     */
-	    x = dsp_rpp->dsp_min[X];
-	    y = dsp_rpp->dsp_min[Y];
-	    VSET(B, x, y, DSP(&dsp->dsp_i, x, y));
-
-	    x = dsp_rpp->dsp_max[X];
-	    VSET(A, x, y, DSP(&dsp->dsp_i, x, y));
-
-	    y = dsp_rpp->dsp_max[Y];
-	    VSET(C, x, y, DSP(&dsp->dsp_i, x, y));
-
-	    x = dsp_rpp->dsp_min[X];
-	    VSET(D, x, y, DSP(&dsp->dsp_i, x, y));
+	    VMOVE(tmp, A);
+	    VMOVE(A, B);
+	    VMOVE(B, D);
+	    VMOVE(D, C);
+	    VMOVE(C, tmp);
 
 	    return DSP_CUT_DIR_ULlr;
 	    break;
+	}
     }
     bu_log("%s:%d Unknown DSP cut direction: %d\n",
 	   __FILE__, __LINE__, dsp->dsp_i.dsp_cuttype);
@@ -1805,16 +1806,16 @@ isect_ray_cell_top(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
      */
     x = dsp_bb->dspb_rpp.dsp_min[X];
     y = dsp_bb->dspb_rpp.dsp_min[Y];
-    VSET(A, x, y, DSP(&isect->dsp->dsp_i, x, y));
+    VSET(A, x, y, dsp_bb->dspb_elev[0]);
 
     x = dsp_bb->dspb_rpp.dsp_max[X];
-    VSET(B, x, y, DSP(&isect->dsp->dsp_i, x, y));
+    VSET(B, x, y, dsp_bb->dspb_elev[1]);
 
     y = dsp_bb->dspb_rpp.dsp_max[Y];
-    VSET(D, x, y, DSP(&isect->dsp->dsp_i, x, y));
+    VSET(D, x, y, dsp_bb->dspb_elev[3]);
 
     x = dsp_bb->dspb_rpp.dsp_min[X];
-    VSET(C, x, y, DSP(&isect->dsp->dsp_i, x, y));
+    VSET(C, x, y, dsp_bb->dspb_elev[2]);
 
     /* Compute entry/exit points in solid space */
     VJOIN1(minpt, isect->r.r_pt, isect->r.r_min, isect->r.r_dir);
@@ -1837,7 +1838,7 @@ isect_ray_cell_top(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
 	 entry_solid, isect->dmin, isect->dmax);
 
     /* Possibly reorder corners for the B–C diagonal cut */
-    (void)permute_cell(A, B, C, D, isect->dsp, &dsp_bb->dspb_rpp);
+    (void)permute_cell(A, B, C, D, isect->dsp, dsp_bb);
 
     /* Test both cell triangles; collect hits inside the BB interval */
     if (isect_ray_triangle(isect, B, D, A, &tri_hit[n_tri], ab_first) > 0.0) {
@@ -2118,189 +2119,25 @@ dsp_in_rpp(struct isect_stuff *isect,
 }
 
 
-#ifdef ORDERED_ISECT
-static int
-isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb);
+/* what dsp_bb_hit() found; MISS and STOP match the add_seg() returns */
+#define DSP_BB_MISS 0
+#define DSP_BB_STOP 1
+#define DSP_BB_CHILDREN 2
 
 
 /**
- * Return
- * 0 continue intersection calculations
- * 1 Terminate intersection computation
- */
-static int
-recurse_dsp_bb(struct isect_stuff *isect,
-	       struct dsp_bb *dsp_bb,
-	       point_t minpt, /* entry point of dsp_bb */
-	       point_t UNUSED(maxpt), /* exit point of dsp_bb */
-	       point_t bbmin, /* min point of bb (Z=0) */
-	       point_t UNUSED(bbmax)) /* max point of bb */
-{
-    fastf_t tDX;		/* dist along ray to span 1 cell in X dir */
-    fastf_t tDY;		/* dist along ray to span 1 cell in Y dir */
-    fastf_t tX, tY;	/* dist from hit pt. to next cell boundary */
-    fastf_t curr_dist;
-    short cX, cY;	/* coordinates of current cell */
-    short cs;		/* cell X, Y dimension */
-    short stepX, stepY;	/* dist to step in child array for each dir */
-    short stepPX, stepPY;
-    fastf_t out_dist;
-    struct dsp_bb **p;
-    fastf_t *stom = &isect->dsp->dsp_i.dsp_stom[0];
-    point_t pt, v;
-    int loop = 0;
-
-    DSP_BB_CK(dsp_bb);
-
-    /* compute the size of a cell in each direction */
-    cs = dsp_bb->dspb_subcell_size;
-
-    /* compute current cell */
-    cX = (minpt[X] - bbmin[X]) / cs;
-    cY = (minpt[Y] - bbmin[Y]) / cs;
-
-
-    /* bounds checking: a hit on XMAX or YMAX looks like it should be
-     * in the next cell outside the box; similarly a floating-point
-     * entry point very slightly outside the bounding box (due to
-     * precision) can produce a negative cell index.  Clamp both ends
-     * to prevent out-of-bounds access into dspb_children[].
-     */
-    if (cX >= dsp_bb->dspb_ch_dim[X]) cX = dsp_bb->dspb_ch_dim[X] - 1;
-    if (cY >= dsp_bb->dspb_ch_dim[Y]) cY = dsp_bb->dspb_ch_dim[Y] - 1;
-    if (cX < 0) cX = 0;
-    if (cY < 0) cY = 0;
-
-#ifdef FULL_DSP_DEBUGGING
-    dlog("recurse_dsp_bb  cell size: %d  current cell: %d %d\n",
-	 cs, cX, cY);
-    dlog("dspb_ch_dim x:%d  y:%d\n",
-	 dsp_bb->dspb_ch_dim[X], dsp_bb->dspb_ch_dim[Y]);
-#endif
-
-    tX = tY = curr_dist = isect->r.r_min;
-
-    if (isect->r.r_dir[X] < 0.0) {
-	stepPX = stepX = -1;
-	/* tDX is the distance along the ray we have to travel to
-	 * traverse a cell (travel a unit distance) along the X axis
-	 * of the grid
-	 */
-	tDX = -cs / isect->r.r_dir[X];
-
-	/* tX is the distance along the ray to the first cell boundary
-	 * in the X direction beyond our hit point (minpt)
-	 */
-	tX += ((bbmin[X] + (cX * cs)) - minpt[X]) / isect->r.r_dir[X];
-    } else {
-	stepPX = stepX = 1;
-	tDX = cs / isect->r.r_dir[X];
-
-	if (isect->r.r_dir[X] > 0.0)
-	    tX += ((bbmin[X] + ((cX+1) * cs)) - minpt[X]) / isect->r.r_dir[X];
-	else
-	    tX = MAX_FASTF; /* infinite distance to next X boundary */
-    }
-
-    if (isect->r.r_dir[Y] < 0) {
-	/* distance in dspb_children we have to move to step in Y dir
-	 */
-	stepY = -1;
-	stepPY = -dsp_bb->dspb_ch_dim[X];
-	tDY = -cs / isect->r.r_dir[Y];
-	tY += ((bbmin[Y] + (cY * cs)) - minpt[Y]) / isect->r.r_dir[Y];
-    } else {
-	stepY = 1;
-	stepPY = dsp_bb->dspb_ch_dim[X];
-	tDY = cs / isect->r.r_dir[Y];
-
-	if (isect->r.r_dir[Y] > 0.0)
-	    tY += ((bbmin[Y] + ((cY+1) * cs)) - minpt[Y]) / isect->r.r_dir[Y];
-	else
-	    tY = MAX_FASTF;
-    }
-
-    /* factor in the tolerance to the out-distance */
-    out_dist = isect->r.r_max - isect->tol->dist;
-
-    p = &dsp_bb->dspb_children[dsp_bb->dspb_ch_dim[X] * cY + cX];
-#ifdef FULL_DSP_DEBUGGING
-    dlog("tX:%g tY:%g\n", tX, tY);
-
-#endif
-
-    do {
-	/* intersect with the current cell */
-	if (RT_G_DEBUG & RT_DEBUG_HF) {
-	    if (loop)
-		bu_log("\nisect sub-cell %d %d  curr_dist:%g out_dist: %g",
-		       cX, cY, curr_dist, out_dist);
-	    else {
-		bu_log("isect sub-cell %d %d  curr_dist:%g out_dist %g",
-		       cX, cY, curr_dist, out_dist);
-		loop = 1;
-	    }
-	    VJOIN1(pt, isect->r.r_pt, curr_dist, isect->r.r_dir);
-	    MAT4X3PNT(v, stom, pt);
-	    bu_log("pt %g %g %g\n", V3ARGS(v));
-	}
-
-	/* get pointer to the current child cell.  Note the extra
-	 * level of indirection.  We want to march p through
-	 * dspb_children using pointer addition, but dspb_children
-	 * contains pointers.  We need to be sure to increment the
-	 * offset in the array, not the child pointer.
-	 */
-
-	if (RT_G_DEBUG & RT_DEBUG_HF)
-	    bu_log_indent_delta(4);
-
-	if (isect_ray_dsp_bb(isect, *p)) return 1;
-
-	if (RT_G_DEBUG & RT_DEBUG_HF)
-	    bu_log_indent_delta(-4);
-
-	/* figure out which cell is next */
-	if (tX < tY) {
-	    cX += stepX;  /* track cell offset for debugging */
-	    p += stepPX;
-#ifdef FULL_DSP_DEBUGGING
-	    dlog("stepping X to %d because %g < %g\n", cX, tX, tY);
-#endif
-	    curr_dist = tX;
-	    tX += tDX;
-	} else {
-	    cY += stepY;  /* track cell offset for debugging */
-	    p += stepPY;
-#ifdef FULL_DSP_DEBUGGING
-	    dlog("stepping Y to %d because %g >= %g\n", cY, tX, tY);
-#endif
-	    curr_dist = tY;
-	    tY += tDY;
-	}
-#ifdef FULL_DSP_DEBUGGING
-	dlog("curr_dist %g, out_dist %g\n", curr_dist, out_dist);
-#endif
-    } while (curr_dist < out_dist &&
-	     cX < dsp_bb->dspb_ch_dim[X] && cX >= 0 &&
-	     cY < dsp_bb->dspb_ch_dim[Y] && cY >= 0);
-
-    return 0;
-}
-
-
-#endif
-
-/**
- * Intersect a ray with a DSP bounding box.  This is the primary child
- * of rt_dsp_shot()
+ * Intersect a ray with a DSP bounding box: check the box, take the
+ * "foundation" pillar shortcut, and do the cell intersections when it
+ * is a layer 0 cell.  Walking the ray through the children of a
+ * higher box is left to the caller.
  *
  * Return
- * 0 continue intersection calculations
- * 1 Terminate intersection computation
+ * DSP_BB_MISS continue intersection calculations
+ * DSP_BB_STOP Terminate intersection computation
+ * DSP_BB_CHILDREN the children have to be intersected
  */
 static int
-isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
+dsp_bb_hit(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
 {
     point_t bbmin, bbmax;
     point_t minpt, maxpt;
@@ -2341,7 +2178,7 @@ isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
 	    fclose(draw_dsp_bb(&plotnum, dsp_bb, isect->dsp, 0, 150, 0));
 	}
 
-	return 0;
+	return DSP_BB_MISS;
     }
 
     /* At this point we know that we've hit the overall bounding box
@@ -2420,26 +2257,8 @@ isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
     /* We've hit something where we might be going through the
      * boundary.  We've got to intersect the children
      */
-    if (dsp_bb->dspb_ch_dim[0]) {
-#ifdef ORDERED_ISECT
-	return recurse_dsp_bb(isect, dsp_bb, minpt, maxpt, bbmin, bbmax);
-#else
-	int i;
-	/* there are children, so we recurse */
-	i = dsp_bb->dspb_ch_dim[X] * dsp_bb->dspb_ch_dim[Y] - 1;
-	if (RT_G_DEBUG & RT_DEBUG_HF)
-	    bu_log_indent_delta(4);
-
-	for (; i >= 0; i--)
-	    isect_ray_dsp_bb(isect, dsp_bb->dspb_children[i]);
-
-	if (RT_G_DEBUG & RT_DEBUG_HF)
-	    bu_log_indent_delta(-4);
-
-	return 0;
-
-#endif
-    }
+    if (dsp_bb->dspb_ch_dim[0])
+	return DSP_BB_CHILDREN;
 
     /***********************************************************************
      *
@@ -2480,7 +2299,7 @@ isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
 	    VMOVE(out_hit.hit_normal, dsp_pl[isect->dmax]);
 
 	    if (add_seg(isect, &in_hit, &out_hit, bbmin, bbmax, 255, 255, 0))
-		return 1;
+		return DSP_BB_STOP;
 	}
 
 	/* then cell-top triangulated zone */
@@ -2533,7 +2352,217 @@ isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
 	}
     }
 
-    return 0;
+    return DSP_BB_MISS;
+}
+
+
+/**
+ * The state of a ray being walked through the children of one
+ * bounding box, in the order it crosses them.  rt_dsp_shot() keeps
+ * one of these for each layer it is down in the tree instead of
+ * recursing.
+ */
+struct dsp_walk {
+    struct dsp_bb *bb;		/* the box whose children are walked */
+    struct dsp_bb *p;		/* the current child */
+    fastf_t tDX;		/* dist along ray to span 1 cell in X dir */
+    fastf_t tDY;		/* dist along ray to span 1 cell in Y dir */
+    fastf_t tX, tY;		/* dist from hit pt. to next cell boundary */
+    fastf_t curr_dist;
+    fastf_t out_dist;
+    short cX, cY;		/* coordinates of current cell */
+    short stepX, stepY;		/* dist to step in child array for each dir */
+    short stepPY;
+};
+
+
+/**
+ * Set up the walk through the children of dsp_bb, which the ray has
+ * just been found to hit between isect->r.r_min and r_max.
+ */
+static void
+dsp_walk_start(struct isect_stuff *isect, struct dsp_bb *dsp_bb, struct dsp_walk *w)
+{
+    point_t minpt;	/* entry point of dsp_bb */
+    point_t bbmin;	/* min point of bb (Z=0) */
+    short cs;		/* cell X, Y dimension */
+
+    DSP_BB_CK(dsp_bb);
+
+    VJOIN1(minpt, isect->r.r_pt, isect->r.r_min, isect->r.r_dir);
+    VSET(bbmin, dsp_bb->dspb_rpp.dsp_min[X], dsp_bb->dspb_rpp.dsp_min[Y], 0.0);
+
+    w->bb = dsp_bb;
+
+    /* compute the size of a cell in each direction */
+    cs = dsp_bb->dspb_subcell_size;
+
+    /* compute current cell */
+    w->cX = (minpt[X] - bbmin[X]) / cs;
+    w->cY = (minpt[Y] - bbmin[Y]) / cs;
+
+    /* bounds checking: a hit on XMAX or YMAX looks like it should be
+     * in the next cell outside the box; similarly a floating-point
+     * entry point very slightly outside the bounding box (due to
+     * precision) can produce a negative cell index.  Clamp both ends
+     * to prevent out-of-bounds access into dspb_children[].
+     */
+    if (w->cX >= dsp_bb->dspb_ch_dim[X]) w->cX = dsp_bb->dspb_ch_dim[X] - 1;
+    if (w->cY >= dsp_bb->dspb_ch_dim[Y]) w->cY = dsp_bb->dspb_ch_dim[Y] - 1;
+    if (w->cX < 0) w->cX = 0;
+    if (w->cY < 0) w->cY = 0;
+
+#ifdef FULL_DSP_DEBUGGING
+    dlog("dsp_walk_start  cell size: %d  current cell: %d %d\n",
+	 cs, w->cX, w->cY);
+    dlog("dspb_ch_dim x:%d  y:%d\n",
+	 dsp_bb->dspb_ch_dim[X], dsp_bb->dspb_ch_dim[Y]);
+#endif
+
+    w->tX = w->tY = w->curr_dist = isect->r.r_min;
+
+    if (isect->r.r_dir[X] < 0.0) {
+	w->stepX = -1;
+	/* tDX is the distance along the ray we have to travel to
+	 * traverse a cell (travel a unit distance) along the X axis
+	 * of the grid
+	 */
+	w->tDX = -cs / isect->r.r_dir[X];
+
+	/* tX is the distance along the ray to the first cell boundary
+	 * in the X direction beyond our hit point (minpt)
+	 */
+	w->tX += ((bbmin[X] + (w->cX * cs)) - minpt[X]) / isect->r.r_dir[X];
+    } else {
+	w->stepX = 1;
+	w->tDX = cs / isect->r.r_dir[X];
+
+	if (isect->r.r_dir[X] > 0.0)
+	    w->tX += ((bbmin[X] + ((w->cX+1) * cs)) - minpt[X]) / isect->r.r_dir[X];
+	else
+	    w->tX = MAX_FASTF; /* infinite distance to next X boundary */
+    }
+
+    if (isect->r.r_dir[Y] < 0) {
+	/* distance in dspb_children we have to move to step in Y dir
+	 */
+	w->stepY = -1;
+	w->stepPY = -dsp_bb->dspb_ch_dim[X];
+	w->tDY = -cs / isect->r.r_dir[Y];
+	w->tY += ((bbmin[Y] + (w->cY * cs)) - minpt[Y]) / isect->r.r_dir[Y];
+    } else {
+	w->stepY = 1;
+	w->stepPY = dsp_bb->dspb_ch_dim[X];
+	w->tDY = cs / isect->r.r_dir[Y];
+
+	if (isect->r.r_dir[Y] > 0.0)
+	    w->tY += ((bbmin[Y] + ((w->cY+1) * cs)) - minpt[Y]) / isect->r.r_dir[Y];
+	else
+	    w->tY = MAX_FASTF;
+    }
+
+    /* factor in the tolerance to the out-distance */
+    w->out_dist = isect->r.r_max - isect->tol->dist;
+
+    w->p = &dsp_bb->dspb_children[dsp_bb->dspb_ch_dim[X] * w->cY + w->cX];
+
+#ifdef FULL_DSP_DEBUGGING
+    dlog("tX:%g tY:%g\n", w->tX, w->tY);
+#endif
+}
+
+
+/**
+ * Move the walk on to the next child the ray crosses.
+ *
+ * Return
+ * 0 the ray has left the box
+ * 1 w->p is the next child to intersect
+ */
+static int
+dsp_walk_step(struct dsp_walk *w)
+{
+    /* figure out which cell is next */
+    if (w->tX < w->tY) {
+	w->cX += w->stepX;
+	w->p += w->stepX;
+#ifdef FULL_DSP_DEBUGGING
+	dlog("stepping X to %d because %g < %g\n", w->cX, w->tX, w->tY);
+#endif
+	w->curr_dist = w->tX;
+	w->tX += w->tDX;
+    } else {
+	w->cY += w->stepY;
+	w->p += w->stepPY;
+#ifdef FULL_DSP_DEBUGGING
+	dlog("stepping Y to %d because %g >= %g\n", w->cY, w->tX, w->tY);
+#endif
+	w->curr_dist = w->tY;
+	w->tY += w->tDY;
+    }
+#ifdef FULL_DSP_DEBUGGING
+    dlog("curr_dist %g, out_dist %g\n", w->curr_dist, w->out_dist);
+#endif
+
+    return w->curr_dist < w->out_dist &&
+	w->cX < w->bb->dspb_ch_dim[X] && w->cX >= 0 &&
+	w->cY < w->bb->dspb_ch_dim[Y] && w->cY >= 0;
+}
+
+
+/**
+ * Intersect a ray with the tree of DSP bounding boxes under dsp_bb.
+ * This is the primary child of rt_dsp_shot()
+ *
+ * The tree is walked with an explicit stack of the boxes the ray is
+ * in, so the children of each box are still visited in the order
+ * the ray crosses them, and the segments come out in order along the
+ * ray for add_seg() to join up.
+ *
+ * Return
+ * 0 continue intersection calculations
+ * 1 Terminate intersection computation
+ */
+static int
+isect_ray_dsp_bb(struct isect_stuff *isect, struct dsp_bb *dsp_bb)
+{
+    struct dsp_walk stack[DSP_MAX_LAYERS];
+    struct dsp_walk *w = NULL;
+    int depth = 0;
+
+    for (;;) {
+	switch (dsp_bb_hit(isect, dsp_bb)) {
+	    case DSP_BB_STOP:
+		if (RT_G_DEBUG & RT_DEBUG_HF)
+		    bu_log_indent_delta(-4 * depth);
+		return 1;
+	    case DSP_BB_CHILDREN:
+		w = &stack[depth++];
+		dsp_walk_start(isect, dsp_bb, w);
+		if (RT_G_DEBUG & RT_DEBUG_HF)
+		    bu_log_indent_delta(4);
+		dsp_bb = w->p;
+		continue;
+	}
+
+	/* done with this box, on to the next one the ray crosses in
+	 * the lowest box it has not left yet
+	 */
+	while (depth > 0) {
+	    w = &stack[depth-1];
+	    if (dsp_walk_step(w))
+		break;
+	    depth--;
+	    if (RT_G_DEBUG & RT_DEBUG_HF)
+		bu_log_indent_delta(-4);
+	}
+	if (!depth)
+	    return 0;
+
+	dlog("isect sub-cell %d %d  curr_dist:%g out_dist %g\n",
+	     w->cX, w->cY, w->curr_dist, w->out_dist);
+	dsp_bb = w->p;
+    }
 }
 
 
@@ -2655,7 +2684,7 @@ rt_dsp_shot(struct soltab *stp, register struct xray *rp, struct application *ap
 	    /* Inside-out segment: swap in/out as a safety net.
 	     * The primary fixes are the incomplete-segment fallback in
 	     * isect_ray_cell_top and the upward-ray ordering fix in
-	     * isect_ray_dsp_bb.
+	     * dsp_bb_hit.
 	     */
 	    struct hit tmp_hit;
 	    if (RT_G_DEBUG & RT_DEBUG_HF) {
@@ -43,6 +43,7 @@
 #include "rt/geom.h"
 #include "raytrace.h"
 #include "../fixpt.h"
+#include "../occupancy.h"
 #include "../../librt_private.h"
 
 struct rt_ebm_specific {
@@ -54,6 +55,7 @@ struct rt_ebm_specific {
     vect_t ebm_origin;	/* local coords of grid origin (0, 0, 0) for now */
     vect_t ebm_large;	/* local coords of XYZ max */
     mat_t ebm_mat;	/* model to ideal space */
+    struct occ_pyramid ebm_occ;	/* solid/empty bricks, for skipping */
 };
 
 
@@ -470,6 +472,21 @@ rt_ebm_dda(register struct xray *rp, struct soltab *stp, struct application *ap,
 	int val;
 	struct seg *segp;
 
+	/* Jump over a brick of cells that are all like this one */
+	if (ebmp->ebm_occ.nlevels) {
+	    long g[3], lo[3], hi[3];
+
+	    g[X] = (long)igrid[X];
+	    g[Y] = (long)igrid[Y];
+	    g[Z] = 0;
+	    if (occ_pyramid_find(&ebmp->ebm_occ, g, inside, lo, hi)) {
+		t0 = occ_pyramid_skip(2, g, t, delta, rp->r_dir, lo, hi, tmax, &in_index);
+		igrid[X] = (size_t)g[X];
+		igrid[Y] = (size_t)g[Y];
+		continue;
+	    }
+	}
+
 	/* find minimum exit t value */
 	out_index = t[X] < t[Y] ? X : Y;
 
@@ -1138,6 +1155,19 @@ rt_ebm_bbox(struct rt_db_internal *ip, point_t *min, point_t *max, const struct
 }
 
 
+/* occ_row_func for the pyramid: a row of set bits */
+static void
+ebm_occ_row(const void *data, size_t y, size_t UNUSED(z), unsigned char *solid)
+{
+    struct rt_ebm_internal *eip = (struct rt_ebm_internal *)data;
+    const unsigned char *row = bit(eip, 0, y);
+    size_t x;
+
+    for (x = 0; x < eip->xdim; x++)
+	solid[x] = row[x] > 0;
+}
+
+
 /**
  * Returns -
  * 0 OK
@@ -1155,6 +1185,7 @@ rt_ebm_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     vect_t norm;
     vect_t radvec;
     vect_t diam;
+    size_t dim[3];
 
     if (rtip) RT_CK_RTI(rtip);
 
@@ -1196,6 +1227,14 @@ rt_ebm_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     VSCALE(radvec, diam, 0.5);
     stp->st_aradius = stp->st_bradius = MAGNITUDE(radvec);
 
+    /* the bitmap is extruded, so the pyramid is one cell deep */
+    dim[X] = ebmp->ebm_i.xdim;
+    dim[Y] = ebmp->ebm_i.ydim;
+    dim[Z] = 1;
+    (void)occ_pyramid_build(&ebmp->ebm_occ, dim,
+			    rtip ? rtip->rti_voxel_minpyramid : RT_VOXEL_MINPYRAMID_DEFAULT,
+			    ebm_occ_row, &ebmp->ebm_i);
+
     return 0;		/* OK */
 }
 
@@ -1343,6 +1382,7 @@ rt_ebm_free(struct soltab *stp)
 	(struct rt_ebm_specific *)stp->st_specific;
 
     bu_close_mapped_file(ebmp->ebm_i.mp);
+    occ_pyramid_free(&ebmp->ebm_occ);
 
     BU_PUT(ebmp, struct rt_ebm_specific);
 }
@@ -485,9 +485,12 @@ rt_eto_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct
     /* NOTE: End of ERIM based code */
 
     /* It is known that the equation is 4th order.  Therefore, if the
-     * root finder returns other than 4 roots, error.
+     * root finder returns other than 4 roots, error.  The roots come
+     * from rt_poly_roots_n(), as they do in rt_eto_vshot(), so a ray
+     * hits the same way whichever of the two shoots it.
      */
-    if ((i = rt_poly_roots(&C, val, stp->st_dp->d_namep)) != 4) {
+    rt_poly_roots_n(1, &C, &val, &i, stp->st_dp->d_namep);
+    if (i != 4) {
 	if (i > 0) {
 	    bu_log("eto:  rt_poly_roots() 4!=%d\n", i);
 	    bn_pr_roots(stp->st_name, val, i);
@@ -607,37 +610,64 @@ rt_eto_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 /* array of segs (results returned) */
 /* Number of ray/object pairs */
 {
+    bn_poly_t *C;		/* The final equations */
+    bn_complex_t (*val)[4];	/* The complex roots */
+    int *nroots;		/* root counts of the polys in C */
+    int *ray;			/* the ray each poly in C belongs to */
+    fastf_t *cor_proj;
+    int npoly = 0;
     int idx;
 
     if (ap) RT_CK_APPLICATION(ap);
+    if (n <= 0)
+	return;
+
+    C = (bn_poly_t *)bu_malloc(n * sizeof(bn_poly_t), "eto bn_poly_t");
+    val = (bn_complex_t (*)[4])bu_malloc(n * sizeof(bn_complex_t) * 4, "eto bn_complex_t");
+    nroots = (int *)bu_malloc(n * sizeof(int), "eto nroots");
+    ray = (int *)bu_malloc(n * sizeof(int), "eto ray");
+    cor_proj = (fastf_t *)bu_malloc(n * sizeof(fastf_t), "eto proj");
 
+    /* Set up the quartic of each ray that gets near its eto */
     for (idx = 0; idx < n; idx++) {
 	struct eto_specific *eto;
 	vect_t dprime;		/* D' */
 	vect_t pprime;		/* P' */
 	vect_t work;		/* temporary vector */
-	bn_poly_t C;		/* The final equation */
-	bn_complex_t val[4];	/* The complex roots */
-	double k[4];		/* The real roots */
-	int i, j;
 	vect_t cor_pprime;	/* new ray origin */
-	fastf_t cor_proj;
 	fastf_t A1, A2, A3, A4, A5, A6, A7, A8, B1, B2, B3, C1, C2, C3, D1, term;
+	fastf_t b, r;
 
 	if (stp[idx] == 0) continue;			/* skip this ray */
 	segp[idx].seg_stp = (struct soltab *)0;		/* assume MISS */
 
 	eto = (struct eto_specific *)stp[idx]->st_specific;
 
+	/* Nothing culls the pairs handed to a vshot, so rays that
+	 * miss the sphere around the eto are dropped before a quartic
+	 * is built for them.
+	 */
+	VSUB2(work, rp[idx]->r_pt, eto->eto_V);
+	b = VDOT(work, rp[idx]->r_dir);
+	r = eto->eto_r + eto->eto_rc;
+	if (ap)
+	    r += ap->a_rt_i->rti_tol.dist;
+	if (b * b < MAGSQ(work) - r * r)
+	    continue;
+
 	/* Convert vector into the space of the unit eto */
 	MAT4X3VEC(dprime, eto->eto_R, rp[idx]->r_dir);
 	VUNITIZE(dprime);
 
-	VSUB2(work, rp[idx]->r_pt, eto->eto_V);
 	MAT4X3VEC(pprime, eto->eto_R, work);
 
-	cor_proj = VDOT(pprime, dprime);
-	VSCALE(cor_pprime, dprime, cor_proj);
+	/* seg_in/seg_out.hit_normal hold dprime and pprime until the
+	 * roots are back */
+	VMOVE(segp[idx].seg_in.hit_normal, dprime);
+	VMOVE(segp[idx].seg_out.hit_normal, pprime);
+
+	cor_proj[idx] = VDOT(pprime, dprime);
+	VSCALE(cor_pprime, dprime, cor_proj[idx]);
 	VSUB2(cor_pprime, pprime, cor_pprime);
 
 	A1 = eto->eto_rd * eto->eu;
@@ -658,27 +688,39 @@ rt_eto_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 	A8 = 2*(A1*A3 + B1*B3);
 	term = A6*A6 - A8*A8*C3;
 
-	C.dgr=4;
-	C.cf[4] = (A4*A4 - A7*A7*C1);			/* t^0 */
-	C.cf[3] = (2*A4*A5 - A7*A7*C2 - 2*A7*A8*C1);	/* t^1 */
-	C.cf[2] = (2*A4*A6 + A5*A5 - A7*A7*C3 - 2*A7*A8*C2 - A8*A8*C1);	/* t^2 */
-	C.cf[1] = (2*A5*A6 - 2*A7*A8*C3 - A8*A8*C2);	/* t^3 */
-	C.cf[0] = term;					/* t^4 */
+	ray[npoly] = idx;
+	C[npoly].dgr=4;
+	C[npoly].cf[4] = (A4*A4 - A7*A7*C1);			/* t^0 */
+	C[npoly].cf[3] = (2*A4*A5 - A7*A7*C2 - 2*A7*A8*C1);	/* t^1 */
+	C[npoly].cf[2] = (2*A4*A6 + A5*A5 - A7*A7*C3 - 2*A7*A8*C2 - A8*A8*C1);	/* t^2 */
+	C[npoly].cf[1] = (2*A5*A6 - 2*A7*A8*C3 - A8*A8*C2);	/* t^3 */
+	C[npoly].cf[0] = term;					/* t^4 */
+	npoly++;
+    }
+
+    if (npoly)
+	rt_poly_roots_n((size_t)npoly, C, val, nroots, stp[ray[0]]->st_dp->d_namep);
+
+    for (idx = 0; idx < npoly; idx++) {
+	int s = ray[idx];
+	vect_t dprime, pprime;
+	double k[4];		/* The real roots */
+	int i, j;
 
-	if ((i = rt_poly_roots(&C, val, stp[idx]->st_dp->d_namep)) != 4) {
+	if (nroots[idx] != 4) {
 	    /* root finder failed / degenerate; treat as MISS (scalar logs) */
 	    continue;
 	}
 
 	/* Only real roots indicate an intersection in real space. */
 	for (j = 0, i = 0; j < 4; j++) {
-	    if (NEAR_ZERO(val[j].im, 0.0001))
-		k[i++] = val[j].re;
+	    if (NEAR_ZERO(val[idx][j].im, 0.0001))
+		k[i++] = val[idx][j].re;
 	}
 
 	/* reverse above translation by adding distance to all 'k' values. */
 	for (j = 0; j < i; ++j)
-	    k[j] -= cor_proj;
+	    k[j] -= cor_proj[s];
 
 	if (i != 2 && i != 4)
 	    continue;		/* 0 (or reduced) roots -> MISS */
@@ -697,17 +739,26 @@ rt_eto_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 	    }
 	}
 
+	VMOVE(dprime, segp[s].seg_in.hit_normal);
+	VMOVE(pprime, segp[s].seg_out.hit_normal);
+
 	/* Outer span: nearest entry k[i-1], farthest exit k[0]. */
-	segp[idx].seg_stp = stp[idx];
-	segp[idx].seg_in.hit_magic = RT_HIT_MAGIC;
-	segp[idx].seg_in.hit_dist = k[i-1];
-	segp[idx].seg_in.hit_surfno = 0;
-	VJOIN1(segp[idx].seg_in.hit_vpriv, pprime, k[i-1], dprime);
-	segp[idx].seg_out.hit_magic = RT_HIT_MAGIC;
-	segp[idx].seg_out.hit_dist = k[0];
-	segp[idx].seg_out.hit_surfno = 0;
-	VJOIN1(segp[idx].seg_out.hit_vpriv, pprime, k[0], dprime);
+	segp[s].seg_stp = stp[s];
+	segp[s].seg_in.hit_magic = RT_HIT_MAGIC;
+	segp[s].seg_in.hit_dist = k[i-1];
+	segp[s].seg_in.hit_surfno = 0;
+	VJOIN1(segp[s].seg_in.hit_vpriv, pprime, k[i-1], dprime);
+	segp[s].seg_out.hit_magic = RT_HIT_MAGIC;
+	segp[s].seg_out.hit_dist = k[0];
+	segp[s].seg_out.hit_surfno = 0;
+	VJOIN1(segp[s].seg_out.hit_vpriv, pprime, k[0], dprime);
     }
+
+    bu_free(C, "eto bn_poly_t");
+    bu_free(val, "eto bn_complex_t");
+    bu_free(nroots, "eto nroots");
+    bu_free(ray, "eto ray");
+    bu_free(cor_proj, "eto proj");
 }
 
 
@@ -39,6 +39,14 @@
  * value, then a basic binary search is done to refine the
  * approximated hit point.
  *
+ * Isopotential and blob metaballs with many points get an index at
+ * prep: every point has a radius beyond which it adds little to the
+ * field, and a BVH over those spheres finds the points a ray passes
+ * near.  The walk only sums those; the rest are bounded, along with
+ * how fast they can change, and summed exactly only when the bounds
+ * can't tell which side of the threshold a sample is on.  The same
+ * bounds let the walk step over runs of samples that can't cross it.
+ *
  * THIS PRIMITIVE IS INCOMPLETE AND SHOULD BE CONSIDERED EXPERIMENTAL.
  *
  */
@@ -64,6 +72,7 @@
 #include "../../librt_private.h"
 
 #include "metaball.h"
+#include "../../cut_hlbvh.h" /* for hlbvh functions */
 
 #define SQ(a) ((a)*(a))
 
@@ -78,6 +87,62 @@ const char *metaballnames[] =
 };
 
 
+#define METABALL_BVH_MAX_PRIMS_IN_NODE 4
+#define METABALL_BVH_STACK_SIZE 256
+#define METABALL_FAR_FRACTION 0.125	/* of the threshold, shared by far points */
+#define METABALL_MAX_SKIP 256		/* most walk steps stepped over at once */
+#define METABALL_LOCAL_CANDS 64
+#define METABALL_ROUNDOFF 1.0e-12	/* relative slack on the far field bounds */
+
+
+/* A control point as the indexed walk sees it.  Its contribution at
+ * squared distance r2 is w/r2 for isopotentials, or 1/exp(k*r2 - b)
+ * for blobs, which peaks at amp.  Beyond radius that is no more than
+ * the far share in magnitude and changes no faster than grad.
+ */
+struct metaball_point {
+    point_t coord;
+    fastf_t w;
+    fastf_t k, b, amp;
+    fastf_t radius;
+    fastf_t grad;
+};
+
+
+/* This is the solid information specific to a metaball solid. */
+struct metaball_specific {
+    struct rt_metaball_internal *mb;	/* prep copy of the points */
+    size_t npts;
+    struct metaball_point *pts;		/* NULL if not indexed */
+    struct bvh_flat_node *bvh;
+    long *bvh_prims;
+    fastf_t far_hi, far_lo;		/* bounds on the points a ray misses */
+    fastf_t far_grad;			/* and on their rate of change */
+};
+
+
+/* A point whose radius a ray passes within, at its closest approach */
+struct metaball_cand {
+    const struct metaball_point *pt;
+    fastf_t proj;	/* ray distance of the closest approach */
+    fastf_t d2;		/* squared distance from the ray line */
+};
+
+
+/* One ray's walk through an indexed metaball.  After a sample is
+ * summed in full, the far points' share of it anchors tighter bounds
+ * on their share at nearby samples.
+ */
+struct metaball_walk {
+    const struct metaball_specific *ms;
+    const struct xray *rp;
+    struct metaball_cand *cand;
+    size_t ncand, maxcand;
+    int anchored;
+    fastf_t anchor_t, anchor_far;
+};
+
+
 int rt_metaball_lookup_type_id(const char *name)
 {
     int i = 0;
@@ -181,6 +246,143 @@ rt_metaball_bbox(struct rt_db_internal *ip, point_t *min, point_t *max, const st
 }
 
 
+static void
+metaball_index_free(struct metaball_specific *ms)
+{
+    if (ms->bvh)
+	bu_free(ms->bvh, "metaball bvh flat nodes");
+    if (ms->bvh_prims)
+	bu_free(ms->bvh_prims, "metaball bvh prims");
+    if (ms->pts)
+	bu_free(ms->pts, "metaball points");
+    ms->bvh = NULL;
+    ms->bvh_prims = NULL;
+    ms->pts = NULL;
+}
+
+
+/**
+ * Index the points of ms->mb for the ray walk, if there are enough of
+ * them.  rti_metaball_minindex sets how many a metaball needs to get
+ * one.
+ *
+ * The points a ray line doesn't pass within their radius of share
+ * METABALL_FAR_FRACTION of the threshold between them, so each one's
+ * radius is where it falls to 1/npts of that.  Strict metaballs have
+ * no field to bound, and blobs with no blobbiness don't fall off, so
+ * neither is indexed.
+ */
+static void
+metaball_index_build(struct metaball_specific *ms, const struct rt_i *rtip)
+{
+    const struct rt_metaball_internal *mb = ms->mb;
+    size_t min_pts = rtip->rti_metaball_minindex;
+    struct wdb_metaball_pnt *mbpt;
+    fastf_t *centroids, *bounds;
+    fastf_t share, margin, scale = 0.0;
+    long *ordered = NULL;
+    long nodes_created = 0;
+    struct bu_pool *pool;
+    struct bvh_build_node *build_root;
+    size_t i;
+
+    ms->npts = 0;
+    for (BU_LIST_FOR(mbpt, wdb_metaball_pnt, &mb->metaball_ctrl_head))
+	ms->npts++;
+
+    if (ms->npts < min_pts || ms->npts < 2 || !(mb->threshold > 0.0))
+	return;
+    if (mb->method != METABALL_ISOPOTENTIAL && mb->method != METABALL_BLOB)
+	return;
+
+    share = mb->threshold * METABALL_FAR_FRACTION / (fastf_t)ms->npts;
+    ms->pts = (struct metaball_point *)bu_calloc(ms->npts, sizeof(struct metaball_point), "metaball points");
+    ms->far_hi = ms->far_lo = ms->far_grad = 0.0;
+
+    i = 0;
+    for (BU_LIST_FOR(mbpt, wdb_metaball_pnt, &mb->metaball_ctrl_head)) {
+	struct metaball_point *pt = &ms->pts[i++];
+	fastf_t s = mbpt->field_strength;
+
+	VMOVE(pt->coord, mbpt->coord);
+	if (mb->method == METABALL_ISOPOTENTIAL) {
+	    /* |w|/r^2 falls to the share at the radius, and its slope
+	     * 2|w|/r^3 is 2*share/radius there and less beyond */
+	    pt->w = fabs(s) * s;
+	    if (ZERO(pt->w))
+		continue;
+	    pt->radius = sqrt(fabs(pt->w) / share);
+	    pt->grad = 2.0 * share / pt->radius;
+	    if (pt->w > 0.0)
+		ms->far_hi += share;
+	    else
+		ms->far_lo -= share;
+	} else {
+	    fastf_t peak;
+
+	    if (ZERO(s) || !(mbpt->blobbiness > 0.0)) {
+		metaball_index_free(ms);
+		return;
+	    }
+	    pt->b = mbpt->blobbiness;
+	    pt->k = pt->b / (s * s);
+	    pt->amp = exp(pt->b);
+	    if (!(pt->amp < MAX_FASTF)) {
+		metaball_index_free(ms);
+		return;
+	    }
+	    /* amp*e^(-k*r^2), whose slope 2*k*r*f peaks at this r */
+	    peak = 1.0 / sqrt(2.0 * pt->k);
+	    if (pt->amp > share) {
+		pt->radius = sqrt((pt->b - log(share)) / pt->k);
+		ms->far_hi += share;
+	    } else {
+		ms->far_hi += pt->amp;
+	    }
+	    if (pt->radius >= peak)
+		pt->grad = 2.0 * pt->k * pt->radius * FMIN(share, pt->amp);
+	    else
+		pt->grad = sqrt(2.0 * pt->k) * pt->amp * exp(-0.5);
+	}
+	ms->far_grad += pt->grad;
+    }
+
+    centroids = (fastf_t *)bu_malloc(ms->npts * 3 * sizeof(fastf_t), "metaball bvh centroids");
+    bounds = (fastf_t *)bu_malloc(ms->npts * 6 * sizeof(fastf_t), "metaball bvh bounds");
+    for (i = 0; i < ms->npts; i++) {
+	const struct metaball_point *pt = &ms->pts[i];
+	VMOVE(&centroids[i * 3], pt->coord);
+	VSET(&bounds[i * 6], pt->coord[X] - pt->radius, pt->coord[Y] - pt->radius, pt->coord[Z] - pt->radius);
+	VSET(&bounds[i * 6 + 3], pt->coord[X] + pt->radius, pt->coord[Y] + pt->radius, pt->coord[Z] + pt->radius);
+	scale = FMAX(scale, FMAX(fabs(pt->coord[X]), FMAX(fabs(pt->coord[Y]), fabs(pt->coord[Z]))) + pt->radius);
+    }
+
+    /* allow for roundoff in the slab test */
+    margin = scale * 1.0e-9 + SMALL_FASTF;
+    for (i = 0; i < ms->npts; i++) {
+	fastf_t *b = &bounds[i * 6];
+	b[0] -= margin;
+	b[1] -= margin;
+	b[2] -= margin;
+	b[3] += margin;
+	b[4] += margin;
+	b[5] += margin;
+    }
+
+    pool = hlbvh_init_pool(ms->npts);
+    build_root = hlbvh_create(METABALL_BVH_MAX_PRIMS_IN_NODE, pool, centroids, bounds, &nodes_created,
+			      (long)ms->npts, &ordered);
+    ms->bvh = hlbvh_flatten(build_root, nodes_created);
+    bu_pool_delete(pool);
+
+    /* leaf slots -> pts[] */
+    ms->bvh_prims = ordered;
+
+    bu_free(bounds, "metaball bvh bounds");
+    bu_free(centroids, "metaball bvh centroids");
+}
+
+
 /**
  * prep and build bounding volumes... unfortunately, generating the
  * bounding sphere is too 'loose' (I think) and O(n^2).
@@ -189,6 +391,7 @@ C_DECL int
 rt_metaball_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
 {
     struct rt_metaball_internal *mb, *nmb;
+    struct metaball_specific *ms;
     struct wdb_metaball_pnt *mbpt, *nmbpt;
     fastf_t minfstr = +INFINITY;
 
@@ -230,7 +433,11 @@ rt_metaball_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rti
     /* generate a bounding box around the sphere...
      * XXX this can be optimized greatly to reduce the BSP presence... */
     if (rt_metaball_bbox(ip, &(stp->st_min), &(stp->st_max), &rtip->rti_tol)) return 1;
-    stp->st_specific = (void *)nmb;
+
+    BU_GET(ms, struct metaball_specific);
+    ms->mb = nmb;
+    metaball_index_build(ms, rtip);
+    stp->st_specific = (void *)ms;
     return 0;
 }
 
@@ -242,7 +449,7 @@ rt_metaball_print(register const struct soltab *stp)
     struct rt_metaball_internal *mb;
     struct wdb_metaball_pnt *mbpt;
 
-    mb = (struct rt_metaball_internal *)stp->st_specific;
+    mb = ((struct metaball_specific *)stp->st_specific)->mb;
     RT_METABALL_CK_MAGIC(mb);
     for (BU_LIST_FOR(mbpt, wdb_metaball_pnt, &mb->metaball_ctrl_head)) ++metaball_count;
     bu_log("Metaball with %d points and a threshold of %g (%s rendering)\n", metaball_count, mb->threshold, rt_metaball_lookup_type_name(mb->method));
@@ -363,10 +570,322 @@ rt_metaball_find_intersection(point_t *intersect, const struct rt_metaball_inter
 }
 
 
+/* contribution of pt at squared distance r2 */
+static inline fastf_t
+metaball_point_contrib(int method, const struct metaball_point *pt, fastf_t r2)
+{
+    if (method == METABALL_ISOPOTENTIAL)
+	return pt->w / r2;
+    return 1.0 / exp(pt->k * r2 - pt->b);
+}
+
+
+/**
+ * Find the points whose radius the ray line passes within.  The rest
+ * are at least their radius from every point on the line.
+ */
+static void
+metaball_walk_init(struct metaball_walk *w, const struct metaball_specific *ms, const struct xray *rp, struct metaball_cand *local, size_t nlocal)
+{
+    const struct bvh_flat_node *stack_node[METABALL_BVH_STACK_SIZE];
+    unsigned char stack_child_index[METABALL_BVH_STACK_SIZE];
+    int stack_ind = 0;
+    vect_t inverse_r_dir;
+
+    w->ms = ms;
+    w->rp = rp;
+    w->cand = local;
+    w->ncand = 0;
+    w->maxcand = nlocal;
+    w->anchored = 0;
+    w->anchor_t = w->anchor_far = 0.0;
+
+    /* same inf/NaN free inverse as bot_shot_hlbvh_flat() */
+#define RAYDIR_INV(d) (1.0 / ((d) + copysign((1.0 / MAX_FASTF), (d))))
+    inverse_r_dir[X] = RAYDIR_INV(rp->r_dir[X]);
+    inverse_r_dir[Y] = RAYDIR_INV(rp->r_dir[Y]);
+    inverse_r_dir[Z] = RAYDIR_INV(rp->r_dir[Z]);
+#undef RAYDIR_INV
+
+    stack_node[0] = ms->bvh;
+    stack_child_index[0] = 0;
+    while (stack_ind >= 0) {
+	const struct bvh_flat_node *node;
+
+	if (UNLIKELY(stack_ind >= METABALL_BVH_STACK_SIZE)) {
+	    bu_bomb("Stack size exceeded in metaball point bvh");
+	}
+	if (stack_child_index[stack_ind] >= 2) {
+	    stack_ind--;
+	    continue;
+	}
+	node = stack_node[stack_ind];
+	if (!stack_child_index[stack_ind]) {
+	    vect_t t_to_min, t_to_max, t_enter, t_exit;
+	    fastf_t entry_t, exit_t;
+
+	    VSUB2(t_to_min, &node->bounds[0], rp->r_pt);
+	    VSUB2(t_to_max, &node->bounds[3], rp->r_pt);
+	    VELMUL(t_to_min, t_to_min, inverse_r_dir);
+	    VELMUL(t_to_max, t_to_max, inverse_r_dir);
+	    VMOVE(t_enter, t_to_min);
+	    VMOVE(t_exit, t_to_min);
+	    VMINMAX(t_enter, t_exit, t_to_max);
+	    entry_t = FMAX(t_enter[X], FMAX(t_enter[Y], t_enter[Z]));
+	    exit_t = FMIN(t_exit[X], FMIN(t_exit[Y], t_exit[Z]));
+
+	    if (entry_t > exit_t) {
+		stack_ind--;
+		continue;
+	    }
+	}
+	if (node->n_primitives > 0) {
+	    long p;
+	    for (p = node->data.first_prim_offset; p < node->data.first_prim_offset + node->n_primitives; p++) {
+		const struct metaball_point *pt = &ms->pts[ms->bvh_prims[p]];
+		vect_t v, c;
+		fastf_t d2;
+
+		/* the cross product keeps d2 accurate far along the ray */
+		VSUB2(v, pt->coord, rp->r_pt);
+		VCROSS(c, v, rp->r_dir);
+		d2 = MAGSQ(c);
+		if (!(d2 < SQ(pt->radius) * (1.0 + 1.0e-9)))
+		    continue;
+
+		if (w->ncand == w->maxcand) {
+		    w->maxcand *= 2;
+		    if (w->cand == local) {
+			w->cand = (struct metaball_cand *)bu_malloc(w->maxcand * sizeof(struct metaball_cand), "metaball candidates");
+			memcpy(w->cand, local, w->ncand * sizeof(struct metaball_cand));
+		    } else {
+			w->cand = (struct metaball_cand *)bu_realloc(w->cand, w->maxcand * sizeof(struct metaball_cand), "metaball candidates");
+		    }
+		}
+		w->cand[w->ncand].pt = pt;
+		w->cand[w->ncand].proj = VDOT(v, rp->r_dir);
+		w->cand[w->ncand].d2 = d2;
+		w->ncand++;
+	    }
+	    stack_ind--;
+	    continue;
+	}
+	stack_node[stack_ind + 1] = (stack_child_index[stack_ind]) ? (node->data.other_child) : (node + 1);
+	stack_child_index[stack_ind] += 1;
+	stack_child_index[stack_ind + 1] = 0;
+	stack_ind++;
+    }
+}
+
+
+static void
+metaball_walk_free(struct metaball_walk *w, struct metaball_cand *local)
+{
+    if (w->cand != local)
+	bu_free(w->cand, "metaball candidates");
+    w->cand = NULL;
+}
+
+
+/* Bound the far points' share of the field at ray distance t */
+static inline void
+metaball_walk_far(const struct metaball_walk *w, fastf_t t, fastf_t *lo, fastf_t *hi)
+{
+    *lo = w->ms->far_lo;
+    *hi = w->ms->far_hi;
+    if (w->anchored) {
+	fastf_t slack = w->ms->far_grad * fabs(t - w->anchor_t) + METABALL_ROUNDOFF * (fabs(w->anchor_far) + w->ms->mb->threshold);
+	*lo = FMAX(*lo, w->anchor_far - slack);
+	*hi = FMIN(*hi, w->anchor_far + slack);
+    }
+}
+
+
+/**
+ * Compare the field at ray distance t with the threshold: -1 below,
+ * 1 above and 0 on it, the same answer rt_metaball_point_value()
+ * would give.  It is only called when the near points can't decide.
+ */
+static int
+metaball_walk_cmp(struct metaball_walk *w, fastf_t t)
+{
+    const struct rt_metaball_internal *mb = w->ms->mb;
+    fastf_t near = 0.0, lo, hi, val;
+    point_t p;
+    size_t i;
+
+    for (i = 0; i < w->ncand; i++) {
+	const struct metaball_cand *c = &w->cand[i];
+	near += metaball_point_contrib(mb->method, c->pt, c->d2 + SQ(c->proj - t));
+    }
+
+    metaball_walk_far(w, t, &lo, &hi);
+    if (near + hi < mb->threshold)
+	return -1;
+    if (near + lo > mb->threshold)
+	return 1;
+
+    VJOIN1(p, w->rp->r_pt, t, w->rp->r_dir);
+    val = rt_metaball_point_value((const point_t *)&p, mb);
+    w->anchored = 1;
+    w->anchor_t = t;
+    w->anchor_far = val - near;
+
+    if (val > mb->threshold)
+	return 1;
+    return (val < mb->threshold) ? -1 : 0;
+}
+
+
+/* Bound the field over ray distances ta to tb */
+static void
+metaball_walk_bounds(const struct metaball_walk *w, fastf_t ta, fastf_t tb, fastf_t *lo, fastf_t *hi)
+{
+    int method = w->ms->mb->method;
+    fastf_t alo, ahi, blo, bhi;
+    size_t i;
+
+    *lo = *hi = 0.0;
+    for (i = 0; i < w->ncand; i++) {
+	const struct metaball_cand *c = &w->cand[i];
+	fastf_t closest = FMIN(FMAX(c->proj, ta), tb);
+	fastf_t dmin2 = c->d2 + SQ(c->proj - closest);
+	fastf_t dmax2 = c->d2 + FMAX(SQ(c->proj - ta), SQ(c->proj - tb));
+
+	/* every contribution falls off with distance */
+	if (method == METABALL_ISOPOTENTIAL && c->pt->w < 0.0) {
+	    *lo += (dmin2 > 0.0) ? metaball_point_contrib(method, c->pt, dmin2) : -INFINITY;
+	    *hi += metaball_point_contrib(method, c->pt, dmax2);
+	} else {
+	    *lo += metaball_point_contrib(method, c->pt, dmax2);
+	    *hi += (dmin2 > 0.0) ? metaball_point_contrib(method, c->pt, dmin2) : INFINITY;
+	}
+    }
+
+    metaball_walk_far(w, ta, &alo, &ahi);
+    metaball_walk_far(w, tb, &blo, &bhi);
+    *lo += FMIN(alo, blo);
+    *hi += FMAX(ahi, bhi);
+}
+
+
+/* rt_metaball_find_intersection() between ray distances a and b */
+static fastf_t
+metaball_walk_intersection(struct metaball_walk *w, fastf_t a, fastf_t b, fastf_t step, const fastf_t finalstep)
+{
+    int in_a = metaball_walk_cmp(w, a) >= 0;
+
+    for (;;) {
+	fastf_t mid = (a + b) * 0.5;
+	int in_mid;
+
+	if (finalstep > step)
+	    return mid;
+
+	in_mid = metaball_walk_cmp(w, mid) >= 0;
+	if (in_a != in_mid)
+	    b = a;
+	a = mid;
+	in_a = in_mid;
+	step *= 0.5;
+    }
+}
+
+
+/**
+ * The SHOOTALGO 3 walk of rt_metaball_shot() over an indexed
+ * metaball, taking the same steps from r_pt but stepping over runs of
+ * them the field bounds show can't cross the threshold.
+ */
+static int
+metaball_shot_indexed(struct soltab *stp, struct xray *rp, struct application *ap, struct seg *seghead, const struct metaball_specific *ms)
+{
+    const struct rt_metaball_internal *mb = ms->mb;
+    struct metaball_cand local[METABALL_LOCAL_CANDS];
+    struct metaball_walk w;
+    struct seg *segp = NULL;
+    int retval = 0;
+    int mb_stat = 0, segsleft = abs(ap->a_onehit);
+    long nskip = 2;
+    fastf_t step, distleft, t, lastt;
+
+    metaball_walk_init(&w, ms, rp, local, METABALL_LOCAL_CANDS);
+
+    step = mb->initstep;
+    distleft = (rp->r_max-rp->r_min) + step * 3.0;
+    t = 0.0;
+
+    /* walk back out of the solid */
+    while (metaball_walk_cmp(&w, t) >= 0) {
+	distleft += step;
+	t -= step;
+    }
+
+    while (distleft >= 0.0 || mb_stat == 1) {
+	if (nskip >= 2) {
+	    fastf_t lo, hi;
+
+	    metaball_walk_bounds(&w, t, t + nskip * step, &lo, &hi);
+	    if ((mb_stat == 0 && hi < mb->threshold) || (mb_stat == 1 && lo > mb->threshold)) {
+		/* none of those samples is on the other side */
+		distleft -= nskip * step;
+		t += nskip * step;
+		if (nskip < METABALL_MAX_SKIP)
+		    nskip *= 2;
+		continue;
+	    }
+	    nskip /= 2;
+	}
+
+	/* advance to the next point */
+	distleft -= step;
+	lastt = t;
+	t += step;
+	if (mb_stat == 1) {
+	    if (metaball_walk_cmp(&w, t) < 0) {
+		point_t delta;
+		fastf_t hit = metaball_walk_intersection(&w, lastt, t, step, mb->finalstep);
+		VJOIN1(segp->seg_out.hit_point, rp->r_pt, hit, rp->r_dir);
+		--segsleft;
+		++retval;
+		VSUB2(delta, segp->seg_out.hit_point, rp->r_pt);
+		segp->seg_out.hit_dist = MAGNITUDE(delta);
+		segp->seg_out.hit_surfno = 0;
+		mb_stat = 0;
+		if (ap->a_onehit != 0 && segsleft <= 0)
+		    break;
+	    }
+	} else {
+	    if (metaball_walk_cmp(&w, t) > 0) {
+		point_t delta;
+		fastf_t hit = metaball_walk_intersection(&w, lastt, t, step, mb->finalstep);
+		RT_GET_SEG(segp, ap->a_resource);
+		segp->seg_stp = stp;
+		--segsleft;
+		++retval;
+		VJOIN1(segp->seg_in.hit_point, rp->r_pt, hit, rp->r_dir);
+		VSUB2(delta, segp->seg_in.hit_point, rp->r_pt);
+		segp->seg_in.hit_dist = MAGNITUDE(delta);
+		segp->seg_in.hit_surfno = 0;
+		BU_LIST_INSERT(&(seghead->l), &(segp->l));
+
+		mb_stat = 1;
+	    }
+	}
+	if (nskip < 2)
+	    nskip++;
+    }
+
+    metaball_walk_free(&w, local);
+    return retval;
+}
+
+
 C_DECL int
 rt_metaball_shot(struct soltab *stp, register struct xray *rp, struct application *ap, struct seg *seghead)
 {
-    struct rt_metaball_internal *mb = (struct rt_metaball_internal *)stp->st_specific;
+    struct metaball_specific *ms = (struct metaball_specific *)stp->st_specific;
+    struct rt_metaball_internal *mb = ms->mb;
     struct seg *segp = NULL;
     int retval = 0;
     fastf_t step, distleft;
@@ -381,6 +900,9 @@ rt_metaball_shot(struct soltab *stp, register struct xray *rp, struct applicatio
     int fhin = 1;
 #endif
 
+    if (ms->pts)
+	return metaball_shot_indexed(stp, rp, ap, seghead, ms);
+
     step = mb->initstep;
     distleft = (rp->r_max-rp->r_min) + step * 3.0;
 
@@ -559,7 +1081,7 @@ C_DECL void
 rt_metaball_norm(register struct hit *hitp, struct soltab *stp, register struct xray *rp)
 {
     if (rp) RT_CK_RAY(rp);	/* unused. */
-    rt_metaball_norm_internal(&(hitp->hit_normal), &(hitp->hit_point), (struct rt_metaball_internal *)(stp->st_specific));
+    rt_metaball_norm_internal(&(hitp->hit_normal), &(hitp->hit_point), ((struct metaball_specific *)stp->st_specific)->mb);
     return;
 }
 
@@ -570,7 +1092,7 @@ rt_metaball_norm(register struct hit *hitp, struct soltab *stp, register struct
 C_DECL void
 rt_metaball_curve(struct curvature *cvp, struct hit *hitp, struct soltab *stp)
 {
-    struct rt_metaball_internal *metaball = (struct rt_metaball_internal *)stp->st_specific;
+    struct metaball_specific *metaball = (struct metaball_specific *)stp->st_specific;
 
     if (!metaball || !cvp) return;
     if (hitp) RT_CK_HIT(hitp);
@@ -590,7 +1112,7 @@ rt_metaball_curve(struct curvature *cvp, struct hit *hitp, struct soltab *stp)
 C_DECL void
 rt_metaball_uv(struct application *ap, struct soltab *stp, struct hit *hitp, struct uvcoord *uvp)
 {
-    struct rt_metaball_internal *metaball = (struct rt_metaball_internal *)stp->st_specific;
+    struct metaball_specific *metaball = (struct metaball_specific *)stp->st_specific;
     vect_t work, pprime;
     fastf_t r;
 
@@ -628,9 +1150,18 @@ rt_metaball_uv(struct application *ap, struct soltab *stp, struct hit *hitp, str
 C_DECL void
 rt_metaball_free(register struct soltab *stp)
 {
-    struct rt_metaball_internal *metaball = (struct rt_metaball_internal *)stp->st_specific;
+    struct metaball_specific *ms = (struct metaball_specific *)stp->st_specific;
+    struct wdb_metaball_pnt *mbpt;
 
-    bu_free((char *)metaball, "rt_metaball_internal");
+    if (!ms)
+	return;
+    while (BU_LIST_WHILE(mbpt, wdb_metaball_pnt, &ms->mb->metaball_ctrl_head)) {
+	BU_LIST_DEQUEUE(&mbpt->l);
+	bu_free(mbpt, "wdb_metaball_pnt");
+    }
+    bu_free((char *)ms->mb, "rt_metaball_internal");
+    metaball_index_free(ms);
+    BU_PUT(ms, struct metaball_specific);
 }
 
 
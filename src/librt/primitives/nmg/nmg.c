@@ -43,6 +43,7 @@
 #include "rt/primitives/nmg.h"
 #include "raytrace.h"
 #include "../../librt_private.h"
+#include "../../cut_hlbvh.h" /* for hlbvh functions */
 
 /* rt_nmg_internal is just "model", from nmg.h */
 
@@ -76,11 +77,34 @@ segs_error(const char *str) {
 }
 
 
+/* Shells with fewer planar faces than this are scanned linearly */
+#define NMG_SHELL_BVH_MIN_FACES 8
+#define NMG_SHELL_BVH_MAX_PRIMS_IN_NODE 4
+#define NMG_SHELL_BVH_STACK_SIZE 256
+
+/* Prep-time face BVH of one shell.  faces[] holds the faceuses that
+ * isect_ray_faceuse() would process (everything but OT_OPPOSITE), in
+ * fu_hd order.  The tree covers the planar ones, its leaves referring
+ * to faces[] through prims[]; non-planar faces are listed in always[]
+ * and handed back for every ray.
+ */
+struct nmg_shell_bvh {
+    const struct shell *s;
+    struct faceuse **faces;
+    size_t nfaces;
+    struct bvh_flat_node *root;
+    long *prims;
+    long *always;
+    size_t nalways;
+};
+
 /* This is the solid information specific to an nmg solid */
 struct nmg_specific {
     uint32_t nmg_smagic;	/* STRUCT START magic number */
     struct model *nmg_model;
     char *manifolds;		/* structure 1-3manifold table */
+    struct nmg_shell_bvh *shell_bvh;	/* sorted by shell index */
+    size_t nshell_bvh;
     uint32_t nmg_emagic;	/* STRUCT END magic number */
 };
 
@@ -91,6 +115,223 @@ struct tmp_v {
 };
 
 
+/**
+ * Build the face BVH of shell s into sb.  Returns 0 (leaving sb
+ * untouched) if the shell has too few faces to be worth indexing.
+ *
+ * isect_ray_faceuse() rejects a planar face when the ray line meets its
+ * plane outside the face bounding box grown by tol->dist, so boxes
+ * grown by a little more than that can only ever drop faces it would
+ * have rejected.
+ */
+static int
+nmg_shell_bvh_build(struct nmg_shell_bvh *sb, const struct shell *s, const struct bn_tol *tol)
+{
+    struct faceuse *fu;
+    size_t nfaces = 0, nplanar = 0, i, j, k;
+    fastf_t margin, scale = 0.0;
+    fastf_t *centroids, *bounds;
+    long *planar, *ordered = NULL;
+    long nodes_created = 0;
+    struct bu_pool *pool;
+    struct bvh_build_node *build_root;
+
+    for (BU_LIST_FOR(fu, faceuse, &s->fu_hd)) {
+	if (fu->orientation == OT_OPPOSITE)
+	    continue;
+	nfaces++;
+	if (*fu->f_p->g.magic_p == NMG_FACE_G_PLANE_MAGIC)
+	    nplanar++;
+    }
+    if (nplanar < NMG_SHELL_BVH_MIN_FACES)
+	return 0;
+
+    /* allow for roundoff in the plane intercept and the slab test */
+    for (i = 0; i < 3; i++) {
+	scale = FMAX(scale, fabs(s->sa_p->min_pt[i]));
+	scale = FMAX(scale, fabs(s->sa_p->max_pt[i]));
+    }
+    margin = 2.0 * tol->dist + scale * 1.0e-9;
+
+    sb->s = s;
+    sb->nfaces = nfaces;
+    sb->faces = (struct faceuse **)bu_malloc(nfaces * sizeof(struct faceuse *), "nmg bvh faces");
+    sb->nalways = nfaces - nplanar;
+    sb->always = sb->nalways ? (long *)bu_malloc(sb->nalways * sizeof(long), "nmg bvh non-planar faces") : NULL;
+
+    centroids = (fastf_t *)bu_malloc(nplanar * 3 * sizeof(fastf_t), "nmg bvh centroids");
+    bounds = (fastf_t *)bu_malloc(nplanar * 6 * sizeof(fastf_t), "nmg bvh bounds");
+    planar = (long *)bu_malloc(nplanar * sizeof(long), "nmg bvh planar faces");
+
+    i = j = k = 0;
+    for (BU_LIST_FOR(fu, faceuse, &s->fu_hd)) {
+	const struct face *fp = fu->f_p;
+
+	if (fu->orientation == OT_OPPOSITE)
+	    continue;
+	sb->faces[i] = fu;
+	if (*fp->g.magic_p == NMG_FACE_G_PLANE_MAGIC) {
+	    VSETALL(&bounds[j * 6], -margin);
+	    VADD2(&bounds[j * 6], &bounds[j * 6], fp->min_pt);
+	    VSETALL(&bounds[j * 6 + 3], margin);
+	    VADD2(&bounds[j * 6 + 3], &bounds[j * 6 + 3], fp->max_pt);
+	    VADD2SCALE(&centroids[j * 3], fp->min_pt, fp->max_pt, 0.5);
+	    planar[j++] = (long)i;
+	} else {
+	    sb->always[k++] = (long)i;
+	}
+	i++;
+    }
+
+    pool = hlbvh_init_pool(nplanar);
+    build_root = hlbvh_create(NMG_SHELL_BVH_MAX_PRIMS_IN_NODE, pool, centroids, bounds, &nodes_created,
+			      (long)nplanar, &ordered);
+    sb->root = hlbvh_flatten(build_root, nodes_created);
+    bu_pool_delete(pool);
+
+    /* leaf slots -> faces[] */
+    sb->prims = (long *)bu_malloc(nplanar * sizeof(long), "nmg bvh prims");
+    for (j = 0; j < nplanar; j++)
+	sb->prims[j] = planar[ordered[j]];
+
+    bu_free(ordered, "ordered faces");
+    bu_free(planar, "nmg bvh planar faces");
+    bu_free(bounds, "nmg bvh bounds");
+    bu_free(centroids, "nmg bvh centroids");
+
+    return 1;
+}
+
+
+static int
+nmg_shell_bvh_cmp(const void *a, const void *b)
+{
+    const struct nmg_shell_bvh *sa = (const struct nmg_shell_bvh *)a;
+    const struct nmg_shell_bvh *sb = (const struct nmg_shell_bvh *)b;
+
+    if (sa->s->index < sb->s->index)
+	return -1;
+    return (sa->s->index > sb->s->index);
+}
+
+
+static int
+nmg_faceslot_cmp(const void *a, const void *b)
+{
+    const struct faceuse * const *fa = *(const struct faceuse * const * const *)a;
+    const struct faceuse * const *fb = *(const struct faceuse * const * const *)b;
+
+    if (fa < fb)
+	return -1;
+    return (fa > fb);
+}
+
+
+/**
+ * rd_shell_faces hook: collect the faceuses of s whose (grown)
+ * bounding boxes the ray line crosses.  Like the exhaustive loop in
+ * nmg_isect_ray_shell() this works on the whole line, not just the
+ * part in front of r_pt, and hands the faces back in fu_hd order so
+ * the hit lists are built exactly as before.
+ */
+static int
+nmg_shell_faces(struct nmg_ray_data *rd, const struct shell *s, struct bu_ptbl *faces)
+{
+    const struct nmg_specific *nmg = (const struct nmg_specific *)((struct soltab *)rd->stp)->st_specific;
+    const struct bvh_flat_node *stack_node[NMG_SHELL_BVH_STACK_SIZE];
+    unsigned char stack_child_index[NMG_SHELL_BVH_STACK_SIZE];
+    int stack_ind = 0;
+    struct nmg_shell_bvh key;
+    const struct nmg_shell_bvh *sb;
+    vect_t inverse_r_dir;
+    size_t i;
+
+    key.s = s;
+    sb = (const struct nmg_shell_bvh *)bsearch(&key, nmg->shell_bvh, nmg->nshell_bvh,
+					       sizeof(struct nmg_shell_bvh), nmg_shell_bvh_cmp);
+    if (!sb)
+	return 0;
+
+    /* same inf/NaN free inverse as bot_shot_hlbvh_flat() */
+#define RAYDIR_INV(d) (1.0 / ((d) + copysign((1.0 / MAX_FASTF), (d))))
+    inverse_r_dir[X] = RAYDIR_INV(rd->rp->r_dir[X]);
+    inverse_r_dir[Y] = RAYDIR_INV(rd->rp->r_dir[Y]);
+    inverse_r_dir[Z] = RAYDIR_INV(rd->rp->r_dir[Z]);
+#undef RAYDIR_INV
+
+    stack_node[0] = sb->root;
+    stack_child_index[0] = 0;
+    while (stack_ind >= 0) {
+	const struct bvh_flat_node *node;
+
+	if (UNLIKELY(stack_ind >= NMG_SHELL_BVH_STACK_SIZE))
+	    bu_bomb("Stack size exceeded in nmg shell face bvh");
+	if (stack_child_index[stack_ind] >= 2) {
+	    stack_ind--;
+	    continue;
+	}
+	node = stack_node[stack_ind];
+	if (!stack_child_index[stack_ind]) {
+	    vect_t t_to_min, t_to_max, t_enter, t_exit;
+	    fastf_t entry_t, exit_t;
+
+	    VSUB2(t_to_min, &node->bounds[0], rd->rp->r_pt);
+	    VSUB2(t_to_max, &node->bounds[3], rd->rp->r_pt);
+	    VELMUL(t_to_min, t_to_min, inverse_r_dir);
+	    VELMUL(t_to_max, t_to_max, inverse_r_dir);
+	    VMOVE(t_enter, t_to_min);
+	    VMOVE(t_exit, t_to_min);
+	    VMINMAX(t_enter, t_exit, t_to_max);
+	    entry_t = FMAX(t_enter[X], FMAX(t_enter[Y], t_enter[Z]));
+	    exit_t = FMIN(t_exit[X], FMIN(t_exit[Y], t_exit[Z]));
+
+	    /* only the slab overlap matters, faces behind r_pt count */
+	    if (entry_t > exit_t) {
+		stack_ind--;
+		continue;
+	    }
+	}
+	if (node->n_primitives > 0) {
+	    long p;
+	    for (p = node->data.first_prim_offset; p < node->data.first_prim_offset + node->n_primitives; p++)
+		bu_ptbl_ins(faces, (long *)&sb->faces[sb->prims[p]]);
+	    stack_ind--;
+	    continue;
+	}
+	stack_node[stack_ind + 1] = (stack_child_index[stack_ind]) ? (node->data.other_child) : (node + 1);
+	stack_child_index[stack_ind] += 1;
+	stack_child_index[stack_ind + 1] = 0;
+	stack_ind++;
+    }
+
+    for (i = 0; i < sb->nalways; i++)
+	bu_ptbl_ins(faces, (long *)&sb->faces[sb->always[i]]);
+
+    /* slots of faces[] sort into fu_hd order */
+    qsort(faces->buffer, BU_PTBL_LEN(faces), sizeof(long *), nmg_faceslot_cmp);
+    for (i = 0; i < BU_PTBL_LEN(faces); i++)
+	faces->buffer[i] = (long *)*(struct faceuse **)faces->buffer[i];
+
+    return 1;
+}
+
+
+int
+rt_nmg_shell_faces(struct soltab *stp, const struct shell *s, struct xray *rp, struct bu_ptbl *faces)
+{
+    struct ray_data rd;
+
+    RT_CK_SOLTAB(stp);
+    NMG_CK_SHELL(s);
+    BU_CK_PTBL(faces);
+
+    memset(&rd, 0, sizeof(rd));
+    rd.rp = rp;
+    rd.stp = stp;
+    return nmg_shell_faces((struct nmg_ray_data *)&rd, s, faces);
+}
+
+
 /**
  * Calculate the bounding box for an N-Manifold Geometry
  */
@@ -146,6 +387,35 @@ rt_nmg_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
      */
     nmg_s->manifolds = nmg_manifolds(m);
 
+    /* index the faces of every shell big enough to benefit */
+    nmg_s->shell_bvh = NULL;
+    nmg_s->nshell_bvh = 0;
+    {
+	struct nmgregion *r;
+	struct shell *s;
+	size_t nshells = 0;
+
+	for (BU_LIST_FOR(r, nmgregion, &m->r_hd)) {
+	    for (BU_LIST_FOR(s, shell, &r->s_hd))
+		nshells++;
+	}
+	if (nshells) {
+	    nmg_s->shell_bvh = (struct nmg_shell_bvh *)bu_calloc(nshells, sizeof(struct nmg_shell_bvh), "nmg shell bvh");
+	    for (BU_LIST_FOR(r, nmgregion, &m->r_hd)) {
+		for (BU_LIST_FOR(s, shell, &r->s_hd)) {
+		    if (nmg_shell_bvh_build(&nmg_s->shell_bvh[nmg_s->nshell_bvh], s, &rtip->rti_tol))
+			nmg_s->nshell_bvh++;
+		}
+	    }
+	    if (nmg_s->nshell_bvh) {
+		qsort(nmg_s->shell_bvh, nmg_s->nshell_bvh, sizeof(struct nmg_shell_bvh), nmg_shell_bvh_cmp);
+	    } else {
+		bu_free(nmg_s->shell_bvh, "nmg shell bvh");
+		nmg_s->shell_bvh = NULL;
+	    }
+	}
+    }
+
     return 0;
 }
 
@@ -1372,6 +1642,7 @@ rt_nmg_shot(struct soltab *stp, struct xray *rp, struct application *ap, struct
     rd.stp = stp;
     rd.seghead = seghead;
     rd.classifying_ray = 0;
+    rd.rd_shell_faces = (nmg->nshell_bvh) ? nmg_shell_faces : NULL;
 
     /* create a table to keep track of which elements have been
      * processed before and which haven't.  Elements in this table
@@ -1473,6 +1744,19 @@ rt_nmg_free(struct soltab *stp)
     struct nmg_specific *nmg =
 	(struct nmg_specific *)stp->st_specific;
 
+    size_t i;
+
+    for (i = 0; i < nmg->nshell_bvh; i++) {
+	struct nmg_shell_bvh *sb = &nmg->shell_bvh[i];
+	bu_free(sb->root, "bvh flat nodes");
+	bu_free(sb->prims, "nmg bvh prims");
+	if (sb->always)
+	    bu_free(sb->always, "nmg bvh non-planar faces");
+	bu_free(sb->faces, "nmg bvh faces");
+    }
+    if (nmg->shell_bvh)
+	bu_free(nmg->shell_bvh, "nmg shell bvh");
+
     nmg_km(nmg->nmg_model);
     BU_PUT(nmg, struct nmg_specific);
     stp->st_specific = NULL; /* sanity */
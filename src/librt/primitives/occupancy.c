@@ -0,0 +1,123 @@
+/*                     O C C U P A N C Y . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup primitives */
+/** @{ */
+/** @file primitives/occupancy.c
+ *
+ * Prep-time construction of the brick occupancy pyramid shared by
+ * the EBM and VOL cell walkers.
+ *
+ */
+/** @} */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu/malloc.h"
+#include "vmath.h"
+#include "./occupancy.h"
+
+
+int
+occ_pyramid_build(struct occ_pyramid *p, const size_t dim[3], size_t min_cells, occ_row_func row, const void *data)
+{
+    unsigned char *solid;
+    size_t x, y, z;
+    int L, a;
+
+    memset(p, 0, sizeof(struct occ_pyramid));
+    VMOVE(p->dim, dim);
+
+    if (!dim[X] || !dim[Y] || !dim[Z] || dim[X] * dim[Y] * dim[Z] < min_cells)
+	return 0;
+
+    /* add levels until one brick covers the grid */
+    for (L = 1; L <= OCC_MAX_LEVELS; L++) {
+	int top = 1;
+
+	for (a = X; a <= Z; a++) {
+	    p->ldim[L][a] = ((dim[a] - 1) >> (OCC_SHIFT * L)) + 1;
+	    if (p->ldim[L][a] > 1)
+		top = 0;
+	}
+	p->lvl[L] = (unsigned char *)bu_calloc(p->ldim[L][X] * p->ldim[L][Y] * p->ldim[L][Z],
+					       sizeof(unsigned char), "occ_pyramid level");
+	p->nlevels = L;
+	if (top)
+	    break;
+    }
+
+    /* level 1 straight from the cells */
+    solid = (unsigned char *)bu_malloc(dim[X], "occ_pyramid row");
+    for (z = 0; z < dim[Z]; z++) {
+	for (y = 0; y < dim[Y]; y++) {
+	    unsigned char *brick = &p->lvl[1][((z >> OCC_SHIFT) * p->ldim[1][Y] + (y >> OCC_SHIFT)) * p->ldim[1][X]];
+
+	    row(data, y, z, solid);
+	    for (x = 0; x < dim[X]; x++)
+		brick[x >> OCC_SHIFT] |= solid[x] ? OCC_HAS_SOLID : OCC_HAS_EMPTY;
+	}
+    }
+    bu_free(solid, "occ_pyramid row");
+
+    /* and each level above from the one below */
+    for (L = 2; L <= p->nlevels; L++) {
+	const size_t *cd = p->ldim[L-1];
+	const size_t *pd = p->ldim[L];
+
+	for (z = 0; z < cd[Z]; z++) {
+	    for (y = 0; y < cd[Y]; y++) {
+		const unsigned char *child = &p->lvl[L-1][(z * cd[Y] + y) * cd[X]];
+		unsigned char *parent = &p->lvl[L][((z >> OCC_SHIFT) * pd[Y] + (y >> OCC_SHIFT)) * pd[X]];
+
+		for (x = 0; x < cd[X]; x++)
+		    parent[x >> OCC_SHIFT] |= child[x];
+	    }
+	}
+    }
+
+    return p->nlevels;
+}
+
+
+void
+occ_pyramid_free(struct occ_pyramid *p)
+{
+    int L;
+
+    for (L = 1; L <= p->nlevels; L++) {
+	bu_free(p->lvl[L], "occ_pyramid level");
+	p->lvl[L] = NULL;
+    }
+    p->nlevels = 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,207 @@
+/*                     O C C U P A N C Y . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup librt */
+/** @{ */
+/** @file occupancy.h
+ *
+ * Brick occupancy pyramid for the voxel primitives (EBM and VOL).
+ *
+ * Level L of the pyramid covers the voxel grid with bricks 4^L cells
+ * on a side and records whether each brick holds solid cells, empty
+ * cells or both.  A cell DDA asks for the largest brick around its
+ * current cell that is all empty (when outside) or all solid (when
+ * inside) and jumps the ray straight to the far side of that brick,
+ * since no segment can start or end within it.
+ *
+ * Setting LIBRT_VOXEL_PYRAMID=0 in the environment turns the pyramid
+ * off at prep time, so every cell is stepped through.
+ */
+/** @} */
+
+#ifndef LIBRT_PRIMITIVES_OCCUPANCY_H
+#define LIBRT_PRIMITIVES_OCCUPANCY_H seen
+
+#include "common.h"
+
+#include <math.h>
+
+#include "vmath.h"
+
+#define OCC_SHIFT 2		/* bricks are 1<<OCC_SHIFT bricks of the level below on a side */
+#define OCC_MAX_LEVELS 6
+#define OCC_HAS_SOLID 1
+#define OCC_HAS_EMPTY 2
+
+struct occ_pyramid {
+    size_t dim[3];		/* voxel grid size */
+    int nlevels;		/* 0 when there is no pyramid */
+    size_t ldim[OCC_MAX_LEVELS+1][3];	/* bricks per axis at each level */
+    unsigned char *lvl[OCC_MAX_LEVELS+1];	/* OCC_HAS_* flags, levels 1..nlevels */
+};
+
+/**
+ * Fill solid[0..dim[X]-1] with non-zero for the solid cells of row
+ * (y, z) of the grid.
+ */
+typedef void (*occ_row_func)(const void *data, size_t y, size_t z, unsigned char *solid);
+
+/**
+ * Build the pyramid over a dim[X] x dim[Y] x dim[Z] grid, reading it
+ * one row at a time through row().  Returns the number of levels, 0
+ * when the grid has fewer than min_cells cells.
+ */
+extern int occ_pyramid_build(struct occ_pyramid *p, const size_t dim[3], size_t min_cells, occ_row_func row, const void *data);
+
+extern void occ_pyramid_free(struct occ_pyramid *p);
+
+
+/**
+ * Find the largest brick containing cell g that is all solid (inside
+ * set) or all empty.  Returns its level and the inclusive cell range
+ * it spans in lo..hi, or 0 when g is off the grid or in a mixed
+ * level 1 brick.
+ */
+static inline int
+occ_pyramid_find(const struct occ_pyramid *p, const long g[3], int inside, long lo[3], long hi[3])
+{
+    unsigned char want = inside ? OCC_HAS_SOLID : OCC_HAS_EMPTY;
+    int found = 0;
+    int L, a;
+
+    for (a = X; a <= Z; a++) {
+	if (g[a] < 0 || (size_t)g[a] >= p->dim[a])
+	    return 0;
+    }
+
+    for (L = 1; L <= p->nlevels; L++) {
+	int s = OCC_SHIFT * L;
+	size_t i = ((((size_t)g[Z] >> s) * p->ldim[L][Y]) + ((size_t)g[Y] >> s)) * p->ldim[L][X]
+	    + ((size_t)g[X] >> s);
+
+	if (p->lvl[L][i] != want)
+	    break;
+	found = L;
+    }
+    if (!found)
+	return 0;
+
+    for (a = X; a <= Z; a++) {
+	int s = OCC_SHIFT * found;
+
+	lo[a] = (g[a] >> s) << s;
+	hi[a] = lo[a] + (1L << s) - 1;
+	if (hi[a] > (long)p->dim[a] - 1)
+	    hi[a] = (long)p->dim[a] - 1;
+    }
+    return found;
+}
+
+
+/**
+ * Count the crossings t + i*delta, 0 <= i < max, that come before
+ * limit (or at it too, if at is set).
+ */
+static inline long
+occ_crossings(fastf_t t, fastf_t delta, double limit, int at, long max)
+{
+    long k = (t > limit) ? 0 : (long)floor((limit - t) / delta);
+
+    if (k > max)
+	k = max;
+    while (k > 0 && (at ? t + (fastf_t)(k - 1) * delta > limit : t + (fastf_t)(k - 1) * delta >= limit))
+	k--;
+    while (k < max && (at ? t + (fastf_t)k * delta <= limit : t + (fastf_t)k * delta < limit))
+	k++;
+    return k;
+}
+
+
+/**
+ * Advance a cell DDA over the first naxes axes out of the brick
+ * lo..hi that holds its current cell g.  t[] is the next cell
+ * boundary crossing and delta[] the crossing spacing on each axis,
+ * with delta zero on axes the ray does not move along; dir[] is the
+ * ray direction.  g and t are left as the per-cell loop would have
+ * them on entering the first cell past the brick, *axis is set to the
+ * axis of that crossing, and its distance is returned.  When the walk
+ * ends at tmax inside the brick, it stops at the first crossing at or
+ * past tmax instead, as the loop would.
+ *
+ * Crossings at the same distance are taken in the order the EBM and
+ * VOL loops take them (Y, then X, then Z), so the cells visited at
+ * an exact corner are the ones the loop would have visited.
+ */
+static inline double
+occ_pyramid_skip(int naxes, long g[3], fastf_t t[3], const fastf_t delta[3], const fastf_t dir[3],
+		 const long lo[3], const long hi[3], double tmax, int *axis)
+{
+    static const int first[3] = {1, 2, 0};	/* higher goes first on a tie */
+    long steps[3] = {0, 0, 0};
+    double tb = INFINITY;
+    int e = -1;
+    int a;
+
+    /* the brick is left on the axis whose last crossing is soonest */
+    for (a = 0; a < naxes; a++) {
+	long m;
+	double ta;
+
+	if (!(delta[a] > 0.0))
+	    continue;
+	steps[a] = (dir[a] > 0) ? hi[a] - g[a] + 1 : g[a] - lo[a] + 1;
+	m = occ_crossings(t[a], delta[a], tmax, 0, steps[a]);
+	if (m < steps[a])
+	    steps[a] = m + 1;
+	ta = t[a] + (fastf_t)(steps[a] - 1) * delta[a];
+	if (ta < tb || (ta <= tb && e >= 0 && first[a] > first[e])) {
+	    tb = ta;
+	    e = a;
+	}
+    }
+
+    /* take the other axes' crossings that come before that one */
+    for (a = 0; a < naxes; a++) {
+	long k;
+
+	if (!(delta[a] > 0.0))
+	    continue;
+	if (a == e)
+	    k = steps[a];
+	else
+	    k = occ_crossings(t[a], delta[a], tb, first[a] > first[e], steps[a]);
+	t[a] += (fastf_t)k * delta[a];
+	g[a] += (dir[a] > 0) ? k : -k;
+    }
+
+    *axis = e;
+    return tb;
+}
+
+#endif /* LIBRT_PRIMITIVES_OCCUPANCY_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -47,6 +47,7 @@
 #include "raytrace.h"
 #include "wdb.h"
 #include "../../librt_private.h"
+#include "../../cut_hlbvh.h" /* for hlbvh functions */
 
 #if defined(HAVE_ISNAN) && !defined(HAVE_DECL_ISNAN) && !defined(isnan) && !defined(__cplusplus)
 extern int isnan(double x);
@@ -62,6 +63,24 @@ struct id_pipe {
 };
 
 
+/* This is the solid information specific to a pipe solid.  Segment
+ * numbers in hit_surfno count from 1 along pipe_segs, so segment n is
+ * pipe_seg[n - 1].  Pipes with more than a few segments also get a
+ * bounding volume hierarchy over them, its leaves referring to
+ * pipe_seg[] through pipe_bvh_prims[].  Long pipes are also handed to
+ * the space partitioning as pieces of pipe_piece_segs consecutive
+ * segments.
+ */
+struct pipe_specific {
+    struct bu_list pipe_segs;		/* id_pipe elements, start to end */
+    size_t pipe_nsegs;
+    struct id_pipe **pipe_seg;
+    struct bvh_flat_node *pipe_bvh;	/* NULL if not worth building */
+    long *pipe_bvh_prims;
+    size_t pipe_piece_segs;		/* 0 if not in pieces */
+};
+
+
 struct lin_pipe {
     struct bu_list l;
     int pipe_is_bend;
@@ -156,6 +175,11 @@ struct pipe_bend {
 
 #define RT_PIPE_MAXHITS 128
 
+#define PIPE_BVH_MAX_PRIMS_IN_NODE 2
+#define PIPE_BVH_STACK_SIZE 256
+#define PIPE_BVH_MAX_CANDIDATES 512	/* more than this, walk them all */
+#define PIPE_MIN_PIECES 4		/* fewer than this, shoot it whole */
+
 static fastf_t
 pipe_seg_bend_angle(const struct pipe_segment *seg)
 {
@@ -648,12 +672,241 @@ pipe_elements_free(struct bu_list *head)
 	while (BU_LIST_WHILE(p, id_pipe, head)) {
 	    BU_LIST_DEQUEUE(&(p->l));
 	    if (p->pipe_is_bend) {
-		BU_PUT(p, struct lin_pipe);
-	    } else {
 		BU_PUT(p, struct bend_pipe);
+	    } else {
+		BU_PUT(p, struct lin_pipe);
+	    }
+	}
+    }
+}
+
+
+/* The box around one segment the segment tests cull with */
+static void
+pipe_seg_bounds(const struct id_pipe *pipe_id, fastf_t b[6])
+{
+    if (!pipe_id->pipe_is_bend) {
+	const struct lin_pipe *lin = (const struct lin_pipe *)pipe_id;
+	VMOVE(&b[0], lin->pipe_min);
+	VMOVE(&b[3], lin->pipe_max);
+    } else {
+	const struct bend_pipe *bend = (const struct bend_pipe *)pipe_id;
+	fastf_t r = sqrt(bend->bend_bound_radius_sq);
+	VSETALL(&b[0], -r);
+	VADD2(&b[0], &b[0], bend->bend_bound_center);
+	VSETALL(&b[3], r);
+	VADD2(&b[3], &b[3], bend->bend_bound_center);
+    }
+}
+
+
+/**
+ * Number the segments of ps and, if there are enough of them, build
+ * the segment BVH.  rti_pipe_minbvh sets how many segments a pipe
+ * needs to get one.
+ *
+ * Each segment gets a box around the bound rt_pipe_shot() already
+ * tests it against: the RPP of a linear segment, or the bounding
+ * sphere of a bend, which includes the discontinuous radius surfaces
+ * at its ends.  A ray line that passes those tests crosses the box, so
+ * the tree never drops a segment the walk would have shot.
+ */
+static void
+pipe_bvh_build(struct pipe_specific *ps, const struct rt_i *rtip)
+{
+    struct id_pipe *pipe_id;
+    size_t min_segs = rtip ? rtip->rti_pipe_minbvh : RT_PIPE_MINBVH_DEFAULT;
+    fastf_t *centroids, *bounds;
+    fastf_t margin, scale = 0.0;
+    long *ordered = NULL;
+    long nodes_created = 0;
+    struct bu_pool *pool;
+    struct bvh_build_node *build_root;
+    size_t i;
+
+    for (BU_LIST_FOR(pipe_id, id_pipe, &ps->pipe_segs)) {
+	ps->pipe_nsegs++;
+    }
+    if (!ps->pipe_nsegs) {
+	return;
+    }
+
+    ps->pipe_seg = (struct id_pipe **)bu_malloc(ps->pipe_nsegs * sizeof(struct id_pipe *), "pipe segments");
+    i = 0;
+    for (BU_LIST_FOR(pipe_id, id_pipe, &ps->pipe_segs)) {
+	ps->pipe_seg[i++] = pipe_id;
+    }
+
+    if (ps->pipe_nsegs < min_segs || ps->pipe_nsegs < 2) {
+	return;
+    }
+
+    centroids = (fastf_t *)bu_malloc(ps->pipe_nsegs * 3 * sizeof(fastf_t), "pipe bvh centroids");
+    bounds = (fastf_t *)bu_malloc(ps->pipe_nsegs * 6 * sizeof(fastf_t), "pipe bvh bounds");
+
+    for (i = 0; i < ps->pipe_nsegs; i++) {
+	fastf_t *b = &bounds[i * 6];
+
+	pipe_seg_bounds(ps->pipe_seg[i], b);
+	VADD2SCALE(&centroids[i * 3], &b[0], &b[3], 0.5);
+	scale = FMAX(scale, FMAX(fabs(b[0]), FMAX(fabs(b[1]), fabs(b[2]))));
+	scale = FMAX(scale, FMAX(fabs(b[3]), FMAX(fabs(b[4]), fabs(b[5]))));
+    }
+
+    /* allow for roundoff in the slab test */
+    margin = scale * 1.0e-9 + SMALL_FASTF;
+    for (i = 0; i < ps->pipe_nsegs; i++) {
+	fastf_t *b = &bounds[i * 6];
+	b[0] -= margin;
+	b[1] -= margin;
+	b[2] -= margin;
+	b[3] += margin;
+	b[4] += margin;
+	b[5] += margin;
+    }
+
+    pool = hlbvh_init_pool(ps->pipe_nsegs);
+    build_root = hlbvh_create(PIPE_BVH_MAX_PRIMS_IN_NODE, pool, centroids, bounds, &nodes_created,
+			      (long)ps->pipe_nsegs, &ordered);
+    ps->pipe_bvh = hlbvh_flatten(build_root, nodes_created);
+    bu_pool_delete(pool);
+
+    /* leaf slots -> pipe_seg[] */
+    ps->pipe_bvh_prims = ordered;
+
+    bu_free(bounds, "pipe bvh bounds");
+    bu_free(centroids, "pipe bvh centroids");
+}
+
+
+static int
+pipe_seg_cmp(const void *a, const void *b)
+{
+    long sa = *(const long *)a;
+    long sb = *(const long *)b;
+
+    if (sa < sb)
+	return -1;
+    return (sa > sb);
+}
+
+
+/**
+ * Collect into segs[] the indices of the segments whose boxes the ray
+ * line crosses, in pipe order so the hits are gathered in the same
+ * order the full walk would gather them.  Like the per-segment tests
+ * this works on the whole line, not just the part in front of r_pt.
+ *
+ * Returns the number of segments found, or -1 if there are more than
+ * max, in which case the caller walks them all.
+ */
+static long
+pipe_bvh_segs(const struct pipe_specific *ps, const struct xray *rp, long *segs, long max)
+{
+    const struct bvh_flat_node *stack_node[PIPE_BVH_STACK_SIZE];
+    unsigned char stack_child_index[PIPE_BVH_STACK_SIZE];
+    int stack_ind = 0;
+    vect_t inverse_r_dir;
+    long nsegs = 0;
+
+    /* same inf/NaN free inverse as bot_shot_hlbvh_flat() */
+#define RAYDIR_INV(d) (1.0 / ((d) + copysign((1.0 / MAX_FASTF), (d))))
+    inverse_r_dir[X] = RAYDIR_INV(rp->r_dir[X]);
+    inverse_r_dir[Y] = RAYDIR_INV(rp->r_dir[Y]);
+    inverse_r_dir[Z] = RAYDIR_INV(rp->r_dir[Z]);
+#undef RAYDIR_INV
+
+    stack_node[0] = ps->pipe_bvh;
+    stack_child_index[0] = 0;
+    while (stack_ind >= 0) {
+	const struct bvh_flat_node *node;
+
+	if (UNLIKELY(stack_ind >= PIPE_BVH_STACK_SIZE)) {
+	    bu_bomb("Stack size exceeded in pipe segment bvh");
+	}
+	if (stack_child_index[stack_ind] >= 2) {
+	    stack_ind--;
+	    continue;
+	}
+	node = stack_node[stack_ind];
+	if (!stack_child_index[stack_ind]) {
+	    vect_t t_to_min, t_to_max, t_enter, t_exit;
+	    fastf_t entry_t, exit_t;
+
+	    VSUB2(t_to_min, &node->bounds[0], rp->r_pt);
+	    VSUB2(t_to_max, &node->bounds[3], rp->r_pt);
+	    VELMUL(t_to_min, t_to_min, inverse_r_dir);
+	    VELMUL(t_to_max, t_to_max, inverse_r_dir);
+	    VMOVE(t_enter, t_to_min);
+	    VMOVE(t_exit, t_to_min);
+	    VMINMAX(t_enter, t_exit, t_to_max);
+	    entry_t = FMAX(t_enter[X], FMAX(t_enter[Y], t_enter[Z]));
+	    exit_t = FMIN(t_exit[X], FMIN(t_exit[Y], t_exit[Z]));
+
+	    if (entry_t > exit_t) {
+		stack_ind--;
+		continue;
 	    }
 	}
+	if (node->n_primitives > 0) {
+	    long p;
+	    if (nsegs + node->n_primitives > max) {
+		return -1;
+	    }
+	    for (p = node->data.first_prim_offset; p < node->data.first_prim_offset + node->n_primitives; p++) {
+		segs[nsegs++] = ps->pipe_bvh_prims[p];
+	    }
+	    stack_ind--;
+	    continue;
+	}
+	stack_node[stack_ind + 1] = (stack_child_index[stack_ind]) ? (node->data.other_child) : (node + 1);
+	stack_child_index[stack_ind] += 1;
+	stack_child_index[stack_ind + 1] = 0;
+	stack_ind++;
+    }
+
+    qsort(segs, (size_t)nsegs, sizeof(long), pipe_seg_cmp);
+    return nsegs;
+}
+
+
+/* Hand long pipes to the space partitioning as runs of consecutive
+ * segments, which are never far apart, so a cell only costs a ray the
+ * segments near it.  The start cap goes with the first piece and the
+ * end cap with the last.
+ */
+static void
+pipe_prep_pieces(struct soltab *stp, struct pipe_specific *ps, const struct rt_i *rtip)
+{
+    size_t per_piece = rtip ? rtip->rti_pipe_piece_segs : RT_PIPE_PIECE_SEGS_DEFAULT;
+    size_t npieces, i;
+
+    if (!per_piece || ps->pipe_nsegs < PIPE_MIN_PIECES * per_piece) {
+	return;
+    }
+
+    npieces = (ps->pipe_nsegs + per_piece - 1) / per_piece;
+    stp->st_piece_rpps = (struct bound_rpp *)bu_malloc(npieces * sizeof(struct bound_rpp), "st_piece_rpps[]");
+    for (i = 0; i < npieces; i++) {
+	struct bound_rpp *rpp = &stp->st_piece_rpps[i];
+	size_t s;
+
+	VSETALL(rpp->min, INFINITY);
+	VSETALL(rpp->max, -INFINITY);
+	for (s = i * per_piece; s < (i + 1) * per_piece && s < ps->pipe_nsegs; s++) {
+	    fastf_t b[6];
+	    pipe_seg_bounds(ps->pipe_seg[s], b);
+	    VMINMAX(rpp->min, rpp->max, &b[0]);
+	    VMINMAX(rpp->min, rpp->max, &b[3]);
+	}
+
+	/* bend bounds are loose, nothing is outside the solid's box */
+	VMAX(rpp->min, stp->st_min);
+	VMIN(rpp->max, stp->st_max);
     }
+
+    ps->pipe_piece_segs = per_piece;
+    stp->st_npieces = (long)npieces;
 }
 
 
@@ -682,25 +935,32 @@ rt_pipe_bbox(
  * !0 if there is an error in the description
  *
  * Implicit return -
- * A struct bu_list is created, and its address is stored in
+ * A struct pipe_specific is created, and its address is stored in
  * stp->st_specific for use by pipe_shot().
  */
 C_DECL int
 rt_pipe_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
 {
-    struct bu_list *head;
+    struct pipe_specific *ps;
     fastf_t dx, dy, dz, f;
 
     if (rtip) {
 	RT_CK_RTI(rtip);
     }
 
-    BU_GET(head, struct bu_list);
-    BU_LIST_INIT(head);
+    BU_GET(ps, struct pipe_specific);
+    BU_LIST_INIT(&ps->pipe_segs);
+    ps->pipe_nsegs = 0;
+    ps->pipe_seg = NULL;
+    ps->pipe_bvh = NULL;
+    ps->pipe_bvh_prims = NULL;
+    ps->pipe_piece_segs = 0;
 
-    pipe_elements_calculate(head, ip, &(stp->st_min), &(stp->st_max));
+    pipe_elements_calculate(&ps->pipe_segs, ip, &(stp->st_min), &(stp->st_max));
+    pipe_bvh_build(ps, rtip);
+    pipe_prep_pieces(stp, ps, rtip);
 
-    stp->st_specific = (void *)head;
+    stp->st_specific = (void *)ps;
 
     VSET(stp->st_center,
 	 (stp->st_max[X] + stp->st_min[X]) / 2,
@@ -727,11 +987,12 @@ rt_pipe_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
 C_DECL void
 rt_pipe_print(const struct soltab *stp)
 {
-    struct bu_list *head = (struct bu_list *)stp->st_specific;
+    const struct pipe_specific *ps = (const struct pipe_specific *)stp->st_specific;
 
-    if (!head) {
+    if (!ps) {
 	return;
     }
+    bu_log("%zu segments%s\n", ps->pipe_nsegs, ps->pipe_bvh ? ", bounding volume hierarchy" : "");
 }
 
 
@@ -1588,7 +1849,7 @@ rt_pipe_elim_dups(
 C_DECL void
 rt_pipe_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
 {
-    struct bu_list *head = (struct bu_list *)stp->st_specific;
+    struct pipe_specific *ps = (struct pipe_specific *)stp->st_specific;
     struct id_pipe *pipe_id;
     struct lin_pipe *pipe_lin;
     struct bend_pipe *pipe_bend;
@@ -1596,15 +1857,15 @@ rt_pipe_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
     vect_t work;
     vect_t work1;
     int segno;
-    int i;
 
     segno = hitp->hit_surfno / 10;
-
-    pipe_id = BU_LIST_FIRST(id_pipe, head);
-    for (i = 1; i < segno; i++) {
-	pipe_id = BU_LIST_NEXT(id_pipe, &pipe_id->l);
+    if (segno < 1 || (size_t)segno > ps->pipe_nsegs) {
+	bu_log("rt_pipe_norm: Unrecognized surfno (%d)\n", hitp->hit_surfno);
+	return;
     }
 
+    pipe_id = ps->pipe_seg[segno - 1];
+
     pipe_lin = (struct lin_pipe *)pipe_id;
     pipe_bend = (struct bend_pipe *)pipe_id;
 
@@ -1668,57 +1929,55 @@ rt_pipe_norm(struct hit *hitp, struct soltab *stp, struct xray *rp)
 
 
 /**
- * Intersect a ray with a pipe.  If an intersection occurs, a struct
- * seg will be acquired and filled in.
+ * Shoot one segment, if the ray passes within its bounds.
+ */
+static void
+pipe_seg_shot(
+    struct soltab *stp,
+    struct xray *rp,
+    struct application *ap,
+    struct id_pipe *pipe_id,
+    struct hit *hits,
+    int *hit_count,
+    int seg_no)
+{
+    if (!pipe_id->pipe_is_bend) {
+	struct lin_pipe *lin = (struct lin_pipe *)pipe_id;
+	if (!rt_in_rpp(rp, ap->a_inv_dir, lin->pipe_min, lin->pipe_max)) {
+	    return;
+	}
+	linear_pipe_shot(stp, rp, lin, hits, hit_count, seg_no);
+    } else {
+	struct bend_pipe *bend = (struct bend_pipe *)pipe_id;
+	if (!rt_in_sph(rp, bend->bend_bound_center, bend->bend_bound_radius_sq)) {
+	    return;
+	}
+	bend_pipe_shot(stp, rp, bend, hits, hit_count, seg_no);
+    }
+}
+
+
+/**
+ * Turn the hits on a pipe, at their distances along rp, into
+ * segments: find their normals, sort them, and drop the duplicates
+ * where segments meet.
  *
  * Returns -
  *  0 MISS
  * >0 HIT
  */
-C_DECL int
-rt_pipe_shot(
+static int
+pipe_makesegs(
     struct soltab *stp,
     struct xray *rp,
     struct application *ap,
+    struct hit *hits,
+    int total_hits,
     struct seg *seghead)
 {
-    struct bu_list *head = (struct bu_list *)stp->st_specific;
-    struct id_pipe *pipe_id;
     struct seg *segp;
-    struct hit hits[RT_PIPE_MAXHITS];
-    int total_hits = 0;
-    int seg_no;
     int i;
 
-    pipe_start_shot(stp, rp, BU_LIST_FIRST(id_pipe, head), hits, &total_hits, 1);
-    seg_no = 0;
-    for (BU_LIST_FOR(pipe_id, id_pipe, head)) {
-	seg_no++;
-    }
-    pipe_end_shot(stp, rp, BU_LIST_LAST(id_pipe, head), hits, &total_hits, seg_no);
-
-    seg_no = 0;
-    for (BU_LIST_FOR(pipe_id, id_pipe, head)) {
-	seg_no++;
-
-	if (!pipe_id->pipe_is_bend) {
-	    struct lin_pipe *lin = (struct lin_pipe *)pipe_id;
-	    if (!rt_in_rpp(rp, ap->a_inv_dir, lin->pipe_min, lin->pipe_max)) {
-		continue;
-	    }
-	    linear_pipe_shot(stp, rp, lin, hits, &total_hits, seg_no);
-	} else {
-	    struct bend_pipe *bend = (struct bend_pipe *)pipe_id;
-	    if (!rt_in_sph(rp, bend->bend_bound_center, bend->bend_bound_radius_sq)) {
-		continue;
-	    }
-	    bend_pipe_shot(stp, rp, bend, hits, &total_hits, seg_no);
-	}
-    }
-    if (!total_hits) {
-	return 0;
-    }
-
     /* calculate hit points and normals */
     for (i = 0 ; i < total_hits ; i++) {
 	rt_pipe_norm(&hits[i], stp, rp);
@@ -1732,7 +1991,7 @@ rt_pipe_shot(
 
     /* Build segments */
     if (total_hits % 2) {
-	bu_log("rt_pipe_shot: bad number of hits on solid %s (%d)\n", stp->st_dp->d_namep, total_hits);
+	bu_log("pipe_makesegs: bad number of hits on solid %s (%d)\n", stp->st_dp->d_namep, total_hits);
 	bu_log("Ignoring this solid for this ray\n");
 	bu_log("\tray start = (%e %e %e), ray dir = (%e %e %e)\n", V3ARGS(rp->r_pt), V3ARGS(rp->r_dir));
 	for (i = 0 ; i < total_hits ; i++) {
@@ -1752,6 +2011,7 @@ rt_pipe_shot(
 	segp->seg_stp = stp;
 	segp->seg_in = hits[i];
 	segp->seg_out = hits[i + 1];
+	segp->seg_in.hit_rayp = segp->seg_out.hit_rayp = rp;
 
 	BU_LIST_INSERT(&(seghead->l), &(segp->l));
     }
@@ -1766,7 +2026,148 @@ rt_pipe_shot(
 
 
 /**
- * Baseline flat-array vshot: delegates to the scalar shot via rt_vshot_via_shot().
+ * Intersect a ray with a pipe.  If an intersection occurs, a struct
+ * seg will be acquired and filled in.
+ *
+ * Returns -
+ *  0 MISS
+ * >0 HIT
+ */
+C_DECL int
+rt_pipe_shot(
+    struct soltab *stp,
+    struct xray *rp,
+    struct application *ap,
+    struct seg *seghead)
+{
+    struct pipe_specific *ps = (struct pipe_specific *)stp->st_specific;
+    struct hit hits[RT_PIPE_MAXHITS];
+    long segs[PIPE_BVH_MAX_CANDIDATES];
+    long nsegs = -1;
+    int total_hits = 0;
+
+    if (!ps->pipe_nsegs) {
+	return 0;
+    }
+
+    pipe_start_shot(stp, rp, ps->pipe_seg[0], hits, &total_hits, 1);
+    pipe_end_shot(stp, rp, ps->pipe_seg[ps->pipe_nsegs - 1], hits, &total_hits, (int)ps->pipe_nsegs);
+
+    if (ps->pipe_bvh) {
+	nsegs = pipe_bvh_segs(ps, rp, segs, PIPE_BVH_MAX_CANDIDATES);
+    }
+    if (nsegs < 0) {
+	size_t s;
+	for (s = 0; s < ps->pipe_nsegs; s++) {
+	    pipe_seg_shot(stp, rp, ap, ps->pipe_seg[s], hits, &total_hits, (int)s + 1);
+	}
+    } else {
+	long s;
+	for (s = 0; s < nsegs; s++) {
+	    pipe_seg_shot(stp, rp, ap, ps->pipe_seg[segs[s]], hits, &total_hits, (int)segs[s] + 1);
+	}
+    }
+    if (!total_hits) {
+	return 0;
+    }
+
+    return pipe_makesegs(stp, rp, ap, hits, total_hits, seghead);
+}
+
+
+/**
+ * Intersect a ray with the pieces of a pipe listed in one space
+ * partitioning cell, skipping those already shot by this ray.  The
+ * hits go into psp->htab at their distances along the original ray,
+ * for rt_pipe_piece_hitsegs() to make segments from once the ray has
+ * left the pipe's box.
+ *
+ * Returns the number of hits added.
+ */
+C_DECL int
+rt_pipe_piece_shot(
+    struct rt_piecestate *psp,
+    struct rt_piecelist *plp,
+    double dist_corr,
+    struct xray *rp,
+    struct application *ap,
+    struct seg *UNUSED(seghead))
+{
+    struct soltab *stp;
+    struct pipe_specific *ps;
+    struct xray ray;
+    int total_hits = 0;
+    long i;
+
+    RT_CK_PIECESTATE(psp);
+    RT_CK_PIECELIST(plp);
+    stp = psp->stp;
+    RT_CK_SOLTAB(stp);
+    ps = (struct pipe_specific *)stp->st_specific;
+    if (!ps->pipe_piece_segs) {
+	return 0;
+    }
+
+    /* the segment tests set r_min and r_max */
+    ray = *rp;
+
+    for (i = (long)plp->npieces - 1; i >= 0; i--) {
+	long piecenum = plp->pieces[i];
+	struct hit hits[RT_PIPE_MAXHITS];
+	int nhits = 0;
+	size_t first, last, s;
+	int h;
+
+	if (BU_BITTEST(psp->shot, piecenum)) {
+	    ap->a_resource->re_piece_ndup++;
+	    continue;	/* this piece already shot */
+	}
+	BU_BITSET(psp->shot, piecenum);
+
+	first = (size_t)piecenum * ps->pipe_piece_segs;
+	last = first + ps->pipe_piece_segs;
+	if (last > ps->pipe_nsegs) {
+	    last = ps->pipe_nsegs;
+	}
+	if (first == 0) {
+	    pipe_start_shot(stp, &ray, ps->pipe_seg[0], hits, &nhits, 1);
+	}
+	if (last == ps->pipe_nsegs) {
+	    pipe_end_shot(stp, &ray, ps->pipe_seg[last - 1], hits, &nhits, (int)last);
+	}
+	for (s = first; s < last; s++) {
+	    pipe_seg_shot(stp, &ray, ap, ps->pipe_seg[s], hits, &nhits, (int)s + 1);
+	}
+
+	for (h = 0; h < nhits; h++) {
+	    struct hit *hitp = rt_htbl_get(&psp->htab);
+	    *hitp = hits[h];
+	    hitp->hit_dist += dist_corr;
+	}
+	total_hits += nhits;
+    }
+
+    return total_hits;
+}
+
+
+/**
+ * Make segments from the hits rt_pipe_piece_shot() gathered for one
+ * ray over all the cells it crossed.
+ */
+C_DECL void
+rt_pipe_piece_hitsegs(struct rt_piecestate *psp, struct seg *seghead, struct application *ap)
+{
+    RT_CK_PIECESTATE(psp);
+    RT_CK_AP(ap);
+
+    (void)pipe_makesegs(psp->stp, &ap->a_ray, ap, psp->htab.hits, (int)psp->htab.end, seghead);
+}
+
+
+/**
+ * Flat-array vshot: delegates to the scalar shot via rt_vshot_via_shot(),
+ * so each ray is culled by the segment BVH the same way.
  */
 C_DECL void
 rt_pipe_vshot(
@@ -1823,8 +2224,17 @@ C_DECL void
 rt_pipe_free(struct soltab *stp)
 {
     if (stp != NULL) {
-	pipe_elements_free((struct bu_list *)stp->st_specific);
-	BU_PUT(stp->st_specific, struct bu_list);
+	struct pipe_specific *ps = (struct pipe_specific *)stp->st_specific;
+
+	pipe_elements_free(&ps->pipe_segs);
+	if (ps->pipe_seg) {
+	    bu_free(ps->pipe_seg, "pipe segments");
+	}
+	if (ps->pipe_bvh) {
+	    bu_free(ps->pipe_bvh, "pipe bvh flat nodes");
+	    bu_free(ps->pipe_bvh_prims, "pipe bvh prims");
+	}
+	BU_PUT(ps, struct pipe_specific);
     }
 }
 
@@ -0,0 +1,88 @@
+/*                    P L A N E _ S L A B . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup primitives */
+/** @{ */
+/** @file primitives/plane_slab.c
+ *
+ * Prep-time layout of the plane lists shot by the ARB8 and ARBN.
+ *
+ */
+/** @} */
+
+#include "common.h"
+
+#include <string.h>
+
+#include "bu/malloc.h"
+#include "vmath.h"
+#include "./plane_slab.h"
+
+
+void
+plane_slab_init(struct plane_slab *s, size_t nplanes)
+{
+    size_t i;
+
+    s->n = (nplanes + PLANE_SLAB_LANES - 1) / PLANE_SLAB_LANES * PLANE_SLAB_LANES;
+    if (!s->n)
+	s->n = PLANE_SLAB_LANES;
+    s->pl = (fastf_t *)bu_calloc(4 * s->n, sizeof(fastf_t), "plane_slab planes");
+    s->face = (fastf_t *)bu_malloc(s->n * sizeof(fastf_t), "plane_slab faces");
+
+    /* a padding plane has no normal, so it is parallel to every ray,
+     * and every point is inside it */
+    for (i = 0; i < s->n; i++) {
+	s->pl[3 * s->n + i] = 1.0;
+	s->face[i] = -1.0;
+    }
+}
+
+
+void
+plane_slab_set(struct plane_slab *s, size_t i, const fastf_t *eqn, int face)
+{
+    s->pl[i] = eqn[X];
+    s->pl[s->n + i] = eqn[Y];
+    s->pl[2 * s->n + i] = eqn[Z];
+    s->pl[3 * s->n + i] = eqn[W];
+    s->face[i] = (fastf_t)face;
+}
+
+
+void
+plane_slab_free(struct plane_slab *s)
+{
+    if (s->pl)
+	bu_free(s->pl, "plane_slab planes");
+    if (s->face)
+	bu_free(s->face, "plane_slab faces");
+    memset(s, 0, sizeof(struct plane_slab));
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
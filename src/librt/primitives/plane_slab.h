@@ -0,0 +1,275 @@
+/*                    P L A N E _ S L A B . H
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup librt */
+/** @{ */
+/** @file plane_slab.h
+ *
+ * Ray against the planes of a convex polyhedron (ARB8 and ARBN).
+ *
+ * This is the Cyrus & Beck test of rt_arb_shot() and rt_arbn_shot():
+ * with outward normals, a ray enters a plane's halfspace where D.N < 0
+ * and leaves it where D.N > 0, and is inside the solid from the
+ * farthest entry to the nearest exit.  The planes are kept as arrays
+ * of normal X's, Y's, Z's and distances, padded to an even count with
+ * planes that never bound a ray, so that with SSE2 two planes are
+ * tested per instruction, or one plane against two rays.  The
+ * distances come out bit for bit as the scalar loops compute them.
+ *
+ * Those loops went from the last face to the first and only took a
+ * plane that was strictly farther in or nearer out, so where two
+ * faces tie the higher face number wins.  The slab is in no such
+ * order, so it breaks ties on the face number instead.
+ */
+/** @} */
+
+#ifndef LIBRT_PRIMITIVES_PLANE_SLAB_H
+#define LIBRT_PRIMITIVES_PLANE_SLAB_H seen
+
+#include "common.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) && defined(__GNUC__) && defined(HAVE_EMMINTRIN_H) && defined(HAVE_EMMINTRIN)
+#  include <emmintrin.h>
+#  define PLANE_SLAB_SSE2 1
+#endif
+
+#include "vmath.h"
+
+#define PLANE_SLAB_LANES 2
+
+/* Past this many planes a ray tested on its own gives up on a miss
+ * sooner than it does paired with another, which pays for the pair.
+ */
+#define PLANE_SLAB_PAIR_MAX 16
+
+struct plane_slab {
+    size_t n;		/* planes, padded to a multiple of PLANE_SLAB_LANES */
+    fastf_t *pl;	/* n normal X's, then n Y's, n Z's and n distances */
+    fastf_t *face;	/* face number of each plane, -1 for padding */
+};
+
+/**
+ * Make room for nplanes planes, all padding until set.
+ */
+extern void plane_slab_init(struct plane_slab *s, size_t nplanes);
+
+/**
+ * Make plane i the unit normal plane eqn, reported as face.
+ */
+extern void plane_slab_set(struct plane_slab *s, size_t i, const fastf_t *eqn, int face);
+
+extern void plane_slab_free(struct plane_slab *s);
+
+
+/**
+ * Find where the ray from pt along dir is inside all the planes.
+ * Planes with |D.N| no more than slant_tol count as parallel to the
+ * ray, and the ray misses if it is outside one of those by more than
+ * SQRT_SMALL_FASTF.  Returns 0 for a miss; otherwise sets in and out
+ * to the farthest entry and nearest exit, and iface and oface to their
+ * faces (-1 and +/-INFINITY where there are none), for the caller to
+ * validate as the scalar shots do.
+ */
+static inline int
+plane_slab_shot(const struct plane_slab *s, const fastf_t *pt, const fastf_t *dir, fastf_t slant_tol,
+		fastf_t *in, fastf_t *out, int *iface, int *oface)
+{
+    const fastf_t *nx = s->pl;
+    const fastf_t *ny = nx + s->n;
+    const fastf_t *nz = ny + s->n;
+    const fastf_t *nd = nz + s->n;
+    size_t i;
+
+#ifdef PLANE_SLAB_SSE2
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d px = _mm_set1_pd(pt[X]), py = _mm_set1_pd(pt[Y]), pz = _mm_set1_pd(pt[Z]);
+    const __m128d dx = _mm_set1_pd(dir[X]), dy = _mm_set1_pd(dir[Y]), dz = _mm_set1_pd(dir[Z]);
+    const __m128d tol = _mm_set1_pd(slant_tol), ntol = _mm_set1_pd(-slant_tol);
+    const __m128d par = _mm_set1_pd(SQRT_SMALL_FASTF);
+    __m128d vin = _mm_set1_pd(-INFINITY), vout = _mm_set1_pd(INFINITY);
+    __m128d vif = _mm_set1_pd(-1.0), vof = _mm_set1_pd(-1.0);
+    __m128d outside = _mm_setzero_pd();
+    double lin[2], lout[2], lif[2], lof[2];
+    int k;
+
+    for (i = 0; i < s->n; i += 2) {
+	__m128d a = _mm_loadu_pd(nx + i), b = _mm_loadu_pd(ny + i), c = _mm_loadu_pd(nz + i);
+	__m128d f = _mm_loadu_pd(s->face + i);
+	__m128d dist = _mm_sub_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(a, px), _mm_mul_pd(b, py)), _mm_mul_pd(c, pz)),
+				  _mm_loadu_pd(nd + i));
+	__m128d slant = _mm_xor_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(a, dx), _mm_mul_pd(b, dy)), _mm_mul_pd(c, dz)), sign);
+	__m128d t = _mm_div_pd(dist, slant);
+	__m128d leaves = _mm_cmplt_pd(slant, ntol);
+	__m128d enters = _mm_cmpgt_pd(slant, tol);
+	__m128d m;
+
+	outside = _mm_or_pd(outside, _mm_andnot_pd(_mm_or_pd(leaves, enters), _mm_cmpgt_pd(dist, par)));
+
+	m = _mm_and_pd(leaves, _mm_or_pd(_mm_cmplt_pd(t, vout),
+					 _mm_and_pd(_mm_cmpeq_pd(t, vout), _mm_cmpgt_pd(f, vof))));
+	vout = _mm_or_pd(_mm_and_pd(m, t), _mm_andnot_pd(m, vout));
+	vof = _mm_or_pd(_mm_and_pd(m, f), _mm_andnot_pd(m, vof));
+
+	m = _mm_and_pd(enters, _mm_or_pd(_mm_cmpgt_pd(t, vin),
+					 _mm_and_pd(_mm_cmpeq_pd(t, vin), _mm_cmpgt_pd(f, vif))));
+	vin = _mm_or_pd(_mm_and_pd(m, t), _mm_andnot_pd(m, vin));
+	vif = _mm_or_pd(_mm_and_pd(m, f), _mm_andnot_pd(m, vif));
+
+	/* on a long list of planes, give up as soon as the ray is
+	 * known to miss */
+	if ((i & 6) == 6 && i + 2 < s->n) {
+	    __m128d hin = _mm_max_pd(vin, _mm_unpackhi_pd(vin, vin));
+	    __m128d hout = _mm_min_pd(vout, _mm_unpackhi_pd(vout, vout));
+	    if (_mm_comigt_sd(hin, hout) || _mm_movemask_pd(outside))
+		return 0;
+	}
+    }
+    if (_mm_movemask_pd(outside))
+	return 0;
+
+    _mm_storeu_pd(lin, vin);
+    _mm_storeu_pd(lout, vout);
+    _mm_storeu_pd(lif, vif);
+    _mm_storeu_pd(lof, vof);
+    k = (lin[1] > lin[0] || (lin[1] >= lin[0] && lif[1] > lif[0]));
+    *in = lin[k];
+    *iface = (int)lif[k];
+    k = (lout[1] < lout[0] || (lout[1] <= lout[0] && lof[1] > lof[0]));
+    *out = lout[k];
+    *oface = (int)lof[k];
+#else
+    fastf_t lin = -INFINITY, lout = INFINITY;
+    size_t ip = s->n, op = s->n;
+
+    for (i = 0; i < s->n; i++) {
+	fastf_t dist = nx[i] * pt[X] + ny[i] * pt[Y] + nz[i] * pt[Z] - nd[i];
+	fastf_t slant = -(nx[i] * dir[X] + ny[i] * dir[Y] + nz[i] * dir[Z]);
+	fastf_t t;
+
+	if (slant < -slant_tol) {
+	    t = dist / slant;
+	    if (t < lout || (t <= lout && (op == s->n || s->face[i] > s->face[op]))) {
+		lout = t;
+		op = i;
+	    }
+	} else if (slant > slant_tol) {
+	    t = dist / slant;
+	    if (t > lin || (t >= lin && (ip == s->n || s->face[i] > s->face[ip]))) {
+		lin = t;
+		ip = i;
+	    }
+	} else if (dist > SQRT_SMALL_FASTF) {
+	    return 0;
+	}
+	if (lin > lout)
+	    return 0;
+    }
+    *in = lin;
+    *out = lout;
+    *iface = (ip < s->n) ? (int)s->face[ip] : -1;
+    *oface = (op < s->n) ? (int)s->face[op] : -1;
+#endif
+    return (*in > *out) ? 0 : 1;
+}
+
+
+/**
+ * plane_slab_shot() for two rays at once, each given by its start
+ * point and direction; hit[k] is what it would return for ray k.
+ * Worth it for slabs of up to PLANE_SLAB_PAIR_MAX planes.
+ */
+static inline void
+plane_slab_shot2(const struct plane_slab *s, const fastf_t *pt0, const fastf_t *dir0,
+		 const fastf_t *pt1, const fastf_t *dir1, fastf_t slant_tol,
+		 fastf_t in[2], fastf_t out[2], int iface[2], int oface[2], int hit[2])
+{
+#ifdef PLANE_SLAB_SSE2
+    const fastf_t *nx = s->pl;
+    const fastf_t *ny = nx + s->n;
+    const fastf_t *nz = ny + s->n;
+    const fastf_t *nd = nz + s->n;
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d px = _mm_set_pd(pt1[X], pt0[X]), py = _mm_set_pd(pt1[Y], pt0[Y]), pz = _mm_set_pd(pt1[Z], pt0[Z]);
+    const __m128d dx = _mm_set_pd(dir1[X], dir0[X]), dy = _mm_set_pd(dir1[Y], dir0[Y]), dz = _mm_set_pd(dir1[Z], dir0[Z]);
+    const __m128d tol = _mm_set1_pd(slant_tol), ntol = _mm_set1_pd(-slant_tol);
+    const __m128d par = _mm_set1_pd(SQRT_SMALL_FASTF);
+    __m128d vin = _mm_set1_pd(-INFINITY), vout = _mm_set1_pd(INFINITY);
+    __m128d vif = _mm_set1_pd(-1.0), vof = _mm_set1_pd(-1.0);
+    __m128d outside = _mm_setzero_pd();
+    double lif[2], lof[2];
+    size_t i;
+    int k, miss;
+
+    for (i = 0; i < s->n; i++) {
+	__m128d a = _mm_set1_pd(nx[i]), b = _mm_set1_pd(ny[i]), c = _mm_set1_pd(nz[i]);
+	__m128d f = _mm_set1_pd(s->face[i]);
+	__m128d dist = _mm_sub_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(a, px), _mm_mul_pd(b, py)), _mm_mul_pd(c, pz)),
+				  _mm_set1_pd(nd[i]));
+	__m128d slant = _mm_xor_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(a, dx), _mm_mul_pd(b, dy)), _mm_mul_pd(c, dz)), sign);
+	__m128d t = _mm_div_pd(dist, slant);
+	__m128d leaves = _mm_cmplt_pd(slant, ntol);
+	__m128d enters = _mm_cmpgt_pd(slant, tol);
+	__m128d m;
+
+	outside = _mm_or_pd(outside, _mm_andnot_pd(_mm_or_pd(leaves, enters), _mm_cmpgt_pd(dist, par)));
+
+	m = _mm_and_pd(leaves, _mm_or_pd(_mm_cmplt_pd(t, vout),
+					 _mm_and_pd(_mm_cmpeq_pd(t, vout), _mm_cmpgt_pd(f, vof))));
+	vout = _mm_or_pd(_mm_and_pd(m, t), _mm_andnot_pd(m, vout));
+	vof = _mm_or_pd(_mm_and_pd(m, f), _mm_andnot_pd(m, vof));
+
+	m = _mm_and_pd(enters, _mm_or_pd(_mm_cmpgt_pd(t, vin),
+					 _mm_and_pd(_mm_cmpeq_pd(t, vin), _mm_cmpgt_pd(f, vif))));
+	vin = _mm_or_pd(_mm_and_pd(m, t), _mm_andnot_pd(m, vin));
+	vif = _mm_or_pd(_mm_and_pd(m, f), _mm_andnot_pd(m, vif));
+
+	/* give up once both rays are known to miss */
+	if ((i & 3) == 3 && _mm_movemask_pd(_mm_or_pd(outside, _mm_cmpgt_pd(vin, vout))) == 3)
+	    break;
+    }
+
+    miss = _mm_movemask_pd(_mm_or_pd(outside, _mm_cmpgt_pd(vin, vout)));
+    _mm_storeu_pd(in, vin);
+    _mm_storeu_pd(out, vout);
+    _mm_storeu_pd(lif, vif);
+    _mm_storeu_pd(lof, vof);
+    for (k = 0; k < 2; k++) {
+	hit[k] = !(miss & (1 << k));
+	iface[k] = (int)lif[k];
+	oface[k] = (int)lof[k];
+    }
+#else
+    hit[0] = plane_slab_shot(s, pt0, dir0, slant_tol, &in[0], &out[0], &iface[0], &oface[0]);
+    hit[1] = plane_slab_shot(s, pt1, dir1, slant_tol, &in[1], &out[1], &iface[1], &oface[1]);
+#endif
+}
+
+#endif /* LIBRT_PRIMITIVES_PLANE_SLAB_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
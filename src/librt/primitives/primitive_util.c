@@ -25,11 +25,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "bu/log.h"
 #include "bu/malloc.h"
 #include "bu/opt.h"
 #include "bu/app.h"
+#include "bu/str.h"
 #include "vmath.h"
 #include "../librt_private.h"
 
@@ -583,6 +585,54 @@ _rt_tcl_list_to_fastf_array(const char *list, fastf_t **array, int *array_len)
 }
 
 
+int
+rt_functab_listed(const char *list, const char *label)
+{
+    const char *p;
+    size_t len = strlen(label);
+
+    if (!list)
+	return 0;
+
+    for (p = list; *p; ) {
+	size_t n;
+
+	while (*p == ' ' || *p == ',' || *p == '\t')
+	    p++;
+	n = strcspn(p, " ,\t");
+	if (n && n == len && bu_strncasecmp(p, label, n) == 0)
+	    return 1;
+	p += n;
+    }
+    return 0;
+}
+
+
+void
+rt_functab_wrap(struct rt_functab *ft, int id,
+	int (*shot)(struct soltab *stp, struct xray *rp, struct application *ap, struct seg *seghead),
+	void (*print)(const struct soltab *stp),
+	void (*norm)(struct hit *hitp, struct soltab *stp, struct xray *rp),
+	void (*uv)(struct application *ap, struct soltab *stp, struct hit *hitp, struct uvcoord *uvp),
+	void (*curve)(struct curvature *cvp, struct hit *hitp, struct soltab *stp),
+	void (*release)(struct soltab *stp))
+{
+    *ft = OBJ[id];
+    ft->ft_prep = NULL;
+    ft->ft_shot = shot;
+    ft->ft_print = print;
+    ft->ft_norm = OBJ[id].ft_norm ? norm : NULL;
+    ft->ft_piece_shot = NULL;
+    ft->ft_piece_hitsegs = NULL;
+    ft->ft_uv = OBJ[id].ft_uv ? uv : NULL;
+    ft->ft_curve = OBJ[id].ft_curve ? curve : NULL;
+    ft->ft_classify = NULL;
+    ft->ft_free = release;
+    ft->ft_vshot = NULL;
+    ft->ft_prep_serialize = NULL;
+}
+
+
 #ifdef USE_OPENCL
 
 #ifndef BRLCAD_OPENCL_DIR
@@ -258,6 +258,8 @@ rt_submodel_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rti
     /* Propagate some important settings downward */
     sub_rtip->useair = rtip->useair;
     sub_rtip->rti_dont_instance = rtip->rti_dont_instance;
+    sub_rtip->rti_instance = rtip->rti_instance;
+    sub_rtip->rti_instance_types = rtip->rti_instance_types;
     sub_rtip->rti_hasty_prep = rtip->rti_hasty_prep;
     sub_rtip->rti_tol = rtip->rti_tol;	/* struct copy */
     sub_rtip->rti_ttol = rtip->rti_ttol;	/* struct copy */
@@ -465,8 +465,8 @@ const struct rt_functab OBJ[] = {
 	RTFUNCTAB_FUNC_SHOT_CAST(rt_bot_shot),
 	RTFUNCTAB_FUNC_PRINT_CAST(rt_bot_print),
 	RTFUNCTAB_FUNC_NORM_CAST(rt_bot_norm),
-	NULL, /* piece_shot */
-	NULL, /* piece hitsegs */
+	RTFUNCTAB_FUNC_PIECE_SHOT_CAST(rt_bot_piece_shot),
+	RTFUNCTAB_FUNC_PIECE_HITSEGS_CAST(rt_bot_piece_hitsegs),
 	RTFUNCTAB_FUNC_UV_CAST(rt_bot_uv),
 	RTFUNCTAB_FUNC_CURVE_CAST(rt_bot_curve),
 	NULL, /* classify */
@@ -985,8 +985,8 @@ const struct rt_functab OBJ[] = {
 	RTFUNCTAB_FUNC_SHOT_CAST(rt_pipe_shot),
 	RTFUNCTAB_FUNC_PRINT_CAST(rt_pipe_print),
 	RTFUNCTAB_FUNC_NORM_CAST(rt_pipe_norm),
-	NULL, /* piece_shot */
-	NULL, /* piece_hitsegs */
+	RTFUNCTAB_FUNC_PIECE_SHOT_CAST(rt_pipe_piece_shot),
+	RTFUNCTAB_FUNC_PIECE_HITSEGS_CAST(rt_pipe_piece_hitsegs),
 	RTFUNCTAB_FUNC_UV_CAST(rt_pipe_uv),
 	RTFUNCTAB_FUNC_CURVE_CAST(rt_pipe_curve),
 	NULL, /* class */
@@ -1765,8 +1765,8 @@ const struct rt_functab OBJ[] = {
 	RTFUNCTAB_FUNC_SHOT_CAST(rt_bot_shot),
 	RTFUNCTAB_FUNC_PRINT_CAST(rt_bot_print),
 	RTFUNCTAB_FUNC_NORM_CAST(rt_bot_norm),
-	NULL, /* piece shot */
-	NULL, /* piece hitsegs */
+	RTFUNCTAB_FUNC_PIECE_SHOT_CAST(rt_bot_piece_shot),
+	RTFUNCTAB_FUNC_PIECE_HITSEGS_CAST(rt_bot_piece_hitsegs),
 	RTFUNCTAB_FUNC_UV_CAST(rt_bot_uv),
 	RTFUNCTAB_FUNC_CURVE_CAST(rt_bot_curve),
 	NULL, /* classify */
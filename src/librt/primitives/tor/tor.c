@@ -410,7 +410,7 @@ rt_tor_shot(struct soltab *stp, register struct xray *rp, struct application *ap
     bn_poly_t C;		/* The final equation */
     bn_complex_t val[4];		/* The complex roots */
     double k[4];		/* The real roots */
-    register int i;
+    int i;
     int j;
     bn_poly_t A, Asqr;
     bn_poly_t X2_Y2;		/* X**2 + Y**2 */
@@ -483,9 +483,12 @@ rt_tor_shot(struct soltab *stp, register struct xray *rp, struct application *ap
     C.cf[4] = Asqr.cf[4] - X2_Y2.cf[2] * 4.0;
 
     /* It is known that the equation is 4th order.  Therefore, if the
-     * root finder returns other than 4 roots, error.
+     * root finder returns other than 4 roots, error.  The roots come
+     * from rt_poly_roots_n(), as they do in rt_tor_vshot(), so a ray
+     * hits the same way whichever of the two shoots it.
      */
-    if ((i = rt_poly_roots(&C, val, stp->st_dp->d_namep)) != 4) {
+    rt_poly_roots_n(1, &C, &val, &i, stp->st_dp->d_namep);
+    if (i != 4) {
 	if (i > 0) {
 	    bu_log("tor:  rt_poly_roots() 4!=%d\n", i);
 	    bn_pr_roots(stp->st_name, val, i);
@@ -610,7 +613,7 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
     /* Number of ray/object pairs */
 
 {
-    register int i;
+    register int i, j;
     register struct tor_specific *tor;
     vect_t dprime;		/* D' */
     vect_t pprime;		/* P' */
@@ -623,6 +626,9 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
     bn_poly_t X2_Y2;		/* X**2 + Y**2 */
     vect_t cor_pprime;	/* new ray origin */
     fastf_t *cor_proj;
+    int *nroots;		/* root counts of the polys in C */
+    int *ray;			/* the ray each poly in C belongs to */
+    int npoly = 0;
 
     if (!stp || !(*stp) || !rp || !segp || !ap)
 	return;
@@ -632,6 +638,8 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
     val = (bn_complex_t (*)[4])bu_malloc(n * sizeof(bn_complex_t) * 4,
 					 "tor bn_complex_t");
     cor_proj = (fastf_t *)bu_malloc(n * sizeof(fastf_t), "tor proj");
+    nroots = (int *)bu_malloc(n * sizeof(int), "tor nroots");
+    ray = (int *)bu_malloc(n * sizeof(int), "tor ray");
 
     /* Initialize seg_stp to assume hit (zero will then flag miss) */
     for (i = 0; i < n; i++) segp[i].seg_stp = stp[i];
@@ -641,6 +649,21 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 	if (segp[i].seg_stp == 0) continue;	/* Skip */
 	tor = (struct tor_specific *)stp[i]->st_specific;
 
+	/* Nothing culls the pairs handed to a vshot, so rays that
+	 * miss the bounding sphere are dropped before a quartic is
+	 * built for them.
+	 */
+	VSUB2(work, rp[i]->r_pt, tor->tor_V);
+	{
+	    fastf_t b = VDOT(work, rp[i]->r_dir);
+	    fastf_t r = stp[i]->st_bradius + ap->a_rt_i->rti_tol.dist;
+
+	    if (b * b < MAGSQ(work) - r * r) {
+		RT_TOR_SEG_MISS(segp[i]);	/* MISS */
+		continue;
+	    }
+	}
+
 	/* Convert vector into the space of the unit torus */
 	MAT4X3VEC(dprime, tor->tor_SoR, rp[i]->r_dir);
 	VUNITIZE(dprime);
@@ -648,7 +671,6 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 	/* Use segp[i].seg_in.hit_normal as tmp to hold dprime */
 	VMOVE(segp[i].seg_in.hit_normal, dprime);
 
-	VSUB2(work, rp[i]->r_pt, tor->tor_V);
 	MAT4X3VEC(pprime, tor->tor_SoR, work);
 
 	/* Use segp[i].seg_out.hit_normal as tmp to hold pprime */
@@ -714,24 +736,43 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
 
 	/* Inline expansion of (void) bn_poly_sub(&C, &Asqr, &X2_Y2) */
 	/* offset is known to be 2 */
-	C[i].dgr	= 4;
-	C[i].cf[0] = Asqr.cf[0];
-	C[i].cf[1] = Asqr.cf[1];
-	C[i].cf[2] = Asqr.cf[2] - X2_Y2.cf[0];
-	C[i].cf[3] = Asqr.cf[3] - X2_Y2.cf[1];
-	C[i].cf[4] = Asqr.cf[4] - X2_Y2.cf[2];
+	/* The polys are packed at the front of C for the batch solve */
+	ray[npoly] = i;
+	C[npoly].dgr	= 4;
+	C[npoly].cf[0] = Asqr.cf[0];
+	C[npoly].cf[1] = Asqr.cf[1];
+	C[npoly].cf[2] = Asqr.cf[2] - X2_Y2.cf[0];
+	C[npoly].cf[3] = Asqr.cf[3] - X2_Y2.cf[1];
+	C[npoly].cf[4] = Asqr.cf[4] - X2_Y2.cf[2];
+	npoly++;
     }
 
     /* Unfortunately finding the 4th order roots are too ugly to
-     * expand the root solving manually.
+     * expand the root solving manually, but they can all be found in
+     * one batch.
+     */
+    if (npoly)
+	rt_poly_roots_n((size_t)npoly, C, val, nroots, (*stp)->st_dp->d_namep);
+
+    /* Put the roots back with their rays.  Poly j came from ray
+     * ray[j] >= j, so copying from the back never overwrites roots
+     * that are still to be moved.
      */
+    for (j = npoly - 1; j >= 0; j--) {
+	i = ray[j];
+	if (i != j) {
+	    memcpy(val[i], val[j], sizeof(val[0]));
+	    nroots[i] = nroots[j];
+	}
+    }
+
     for (i = 0; i < n; i++) {
 	if (segp[i].seg_stp == 0) continue;	/* Skip */
 
 	/* It is known that the equation is 4th order.  Therefore, if
 	 * the root finder returns other than 4 roots, error.
 	 */
-	if ((num_roots = rt_poly_roots(&(C[i]), &(val[i][0]), (*stp)->st_dp->d_namep)) != 4) {
+	if ((num_roots = nroots[i]) != 4) {
 	    if (num_roots > 0) {
 		bu_log("tor:  rt_poly_roots() 4!=%d\n", num_roots);
 		bn_pr_roots("tor", val[i], num_roots);
@@ -846,6 +887,8 @@ rt_tor_vshot(struct soltab **stp, struct xray **rp, struct seg *segp, int n, str
     bu_free((char *)C, "tor C");
     bu_free((char *)val, "tor val");
     bu_free((char *)cor_proj, "tor cor_proj");
+    bu_free((char *)nroots, "tor nroots");
+    bu_free((char *)ray, "tor ray");
 }
 
 
@@ -43,6 +43,7 @@
 #include "raytrace.h"
 
 #include "../fixpt.h"
+#include "../occupancy.h"
 #include "../../librt_private.h"
 
 
@@ -60,6 +61,7 @@ struct rt_vol_specific {
     mat_t vol_mat;	/* model to ideal space */
     vect_t vol_origin;	/* local coords of grid origin (0, 0, 0) for now */
     vect_t vol_large;	/* local coords of XYZ max */
+    struct occ_pyramid vol_occ;	/* solid/empty bricks, for skipping */
 };
 #define VOL_NULL ((struct rt_vol_specific *)0)
 
@@ -308,6 +310,18 @@ rt_vol_shot(struct soltab *stp, register struct xray *rp, struct application *ap
 	int val;
 	struct seg *segp;
 
+	/* Jump over a brick of cells that are all like this one */
+	if (volp->vol_occ.nlevels) {
+	    long g[3], lo[3], hi[3];
+
+	    VMOVE(g, igrid);
+	    if (occ_pyramid_find(&volp->vol_occ, g, inside, lo, hi)) {
+		t0 = occ_pyramid_skip(3, g, t, delta, rp->r_dir, lo, hi, tmax, &in_axis);
+		VMOVE(igrid, g);
+		continue;
+	    }
+	}
+
 	/* find minimum exit t value */
 	if (t[X] < t[Y]) {
 	    if (t[Z] < t[X]) {
@@ -977,6 +991,19 @@ rt_vol_bbox(struct rt_db_internal *ip, point_t *min, point_t *max, const struct
 }
 
 
+/* occ_row_func for the pyramid: a row of cells inside lo..hi */
+static void
+vol_occ_row(const void *data, size_t y, size_t z, unsigned char *solid)
+{
+    const struct rt_vol_internal *vip = (const struct rt_vol_internal *)data;
+    const unsigned char *row = &VOL(vip, 0, y, z);
+    size_t x;
+
+    for (x = 0; x < vip->xdim; x++)
+	solid[x] = OK(vip, row[x]);
+}
+
+
 /**
  * Returns -
  * 0 OK
@@ -994,6 +1021,7 @@ rt_vol_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     vect_t norm;
     vect_t radvec;
     vect_t diam;
+    size_t dim[3];
 
     RT_CK_SOLTAB(stp);
     RT_CK_DB_INTERNAL(ip);
@@ -1033,6 +1061,13 @@ rt_vol_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
     VSCALE(radvec, diam, 0.5);
     stp->st_aradius = stp->st_bradius = MAGNITUDE(radvec);
 
+    dim[X] = volp->vol_i.xdim;
+    dim[Y] = volp->vol_i.ydim;
+    dim[Z] = volp->vol_i.zdim;
+    (void)occ_pyramid_build(&volp->vol_occ, dim,
+			    rtip ? rtip->rti_voxel_minpyramid : RT_VOXEL_MINPYRAMID_DEFAULT,
+			    vol_occ_row, &volp->vol_i);
+
     return 0;		/* OK */
 }
 
@@ -1141,6 +1176,7 @@ rt_vol_free(struct soltab *stp)
 	bu_free((char *)volp->vol_i.map, "vol_map");
 	volp->vol_i.map = NULL; /* sanity */
     }
+    occ_pyramid_free(&volp->vol_occ);
     BU_PUT(volp, struct rt_vol_specific);
 }
 
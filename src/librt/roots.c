@@ -25,6 +25,11 @@
 #include "bio.h"
 
 
+#if defined(__SSE2__) && defined(__GNUC__) && defined(HAVE_EMMINTRIN_H) && defined(HAVE_EMMINTRIN)
+#  include <emmintrin.h>
+#  define RT_POLY_SSE2 1
+#endif
+
 #include "vmath.h"
 #include "bn.h"
 #include "raytrace.h"
@@ -352,6 +357,607 @@ rt_poly_roots(bn_poly_t *eqn,	/* equation to be solved */
 }
 
 
+/* Cubics and quartics are solved this many at a time, one per lane.
+ * Without SSE2 the lanes run one after another through the same
+ * arithmetic, so every platform finds the same roots.
+ */
+#define RT_POLY_LANES 8
+
+/* Newton steps taken on the roots of lanes that fail their check */
+#define RT_POLY_POLISH 2
+
+
+/**
+ * Roots of the monic cubics z^3 + b1*z^2 + b2*z + b3, one per lane,
+ * the way bn_poly_cubic_roots() finds them.  Lanes it cannot solve
+ * have ok[] cleared.
+ */
+static void
+poly_cubic_lanes(const double *b1, const double *b2, const double *b3,
+		 double zr[3][RT_POLY_LANES], double zi[3][RT_POLY_LANES], int *ok)
+{
+    const double third = 1.0 / 3.0;
+    const double twentyseventh = 1.0 / 27.0;
+    int l;
+
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	double c1 = b1[l];
+	double c1_3rd = c1 * third;
+	double a = b2[l] - c1 * c1_3rd;
+	double b = (2.0 * c1 * c1 * c1 - 9.0 * c1 * b2[l] + 27.0 * b3[l]) * twentyseventh;
+	double delta = a * a;
+
+	if (fabs(c1) > SQRT_MAX_FASTF || fabs(a) > SQRT_MAX_FASTF
+	    || fabs(b) > SQRT_MAX_FASTF || delta > SQRT_MAX_FASTF) {
+	    ok[l] = 0;
+	    continue;
+	}
+	delta = b * b * 0.25 + delta * a * twentyseventh;
+
+	if (delta > 0.0) {
+	    /* the product of the two cube roots is -a/3, so only the
+	     * one without cancellation in it is taken */
+	    double r_delta = sqrt(delta);
+	    double c = cbrt((b < 0.0) ? -0.5 * b + r_delta : -0.5 * b - r_delta);
+	    double other = -a * third / c;
+	    double A = (b < 0.0) ? c : other;
+	    double B = (b < 0.0) ? other : c;
+
+	    zr[0][l] = A + B;
+	    zr[1][l] = zr[2][l] = -0.5 * zr[0][l];
+	    zi[0][l] = 0.0;
+	    zi[1][l] = (A - B) * M_SQRT3 * 0.5;
+	    zi[2][l] = -zi[1][l];
+	} else if (ZERO(delta)) {
+	    zr[0][l] = 2.0 * cbrt(-0.5 * b);
+	    zr[1][l] = zr[2][l] = -0.5 * zr[0][l];
+	    zi[0][l] = zi[1][l] = zi[2][l] = 0.0;
+	} else {
+	    double fact = 0.0;
+	    double cs_phi = 1.0;
+	    double sn_phi_s3 = 0.0;
+
+	    if (a < 0.0) {
+		double f;
+
+		a *= -third;
+		fact = sqrt(a);
+		f = b * (-0.5) / (a * fact);
+		if (f < 1.0) {
+		    /* 0 <= phi <= pi/3, so sin(phi) is never negative */
+		    cs_phi = (f <= -1.0) ? 0.5 : cos(acos(f) * third);
+		    sn_phi_s3 = sqrt(1.0 - cs_phi * cs_phi) * M_SQRT3;
+		}
+	    }
+	    zr[0][l] = 2.0 * fact * cs_phi;
+	    zr[1][l] = fact * (sn_phi_s3 - cs_phi);
+	    zr[2][l] = fact * (-sn_phi_s3 - cs_phi);
+	    zi[0][l] = zi[1][l] = zi[2][l] = 0.0;
+	}
+	zr[0][l] -= c1_3rd;
+	zr[1][l] -= c1_3rd;
+	zr[2][l] -= c1_3rd;
+    }
+}
+
+
+/**
+ * Roots of the monic quadratics z^2 + b*z + c, one per lane, into
+ * (zr0, zi0) and (zr1, zi1), the way bn_poly_quadratic_roots() finds
+ * them.
+ */
+static void
+poly_quadratic_lanes(const double *b, const double *c, double *zr0, double *zi0, double *zr1, double *zi1)
+{
+    int l;
+#ifdef RT_POLY_SSE2
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d four = _mm_set1_pd(4.0);
+    const __m128d small = _mm_set1_pd(SMALL_FASTF);
+    const __m128d absmask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+
+    for (l = 0; l < RT_POLY_LANES; l += 2) {
+	__m128d vb = _mm_loadu_pd(&b[l]);
+	__m128d vc = _mm_loadu_pd(&c[l]);
+	__m128d discrim = _mm_sub_pd(_mm_mul_pd(vb, vb), _mm_mul_pd(four, vc));
+	__m128d rad = _mm_sqrt_pd(_mm_and_pd(discrim, absmask));
+	__m128d pos = _mm_cmpgt_pd(vb, zero);
+	__m128d srad = _mm_or_pd(_mm_and_pd(pos, rad), _mm_andnot_pd(pos, _mm_sub_pd(zero, rad)));
+	__m128d t = _mm_mul_pd(_mm_sub_pd(zero, half), _mm_add_pd(vb, srad));
+	__m128d r2 = _mm_div_pd(vc, t);
+	__m128d real = _mm_cmpgt_pd(discrim, zero);
+	__m128d repeated = _mm_cmplt_pd(_mm_and_pd(discrim, absmask), small);
+	__m128d mid = _mm_mul_pd(_mm_sub_pd(zero, half), vb);
+	__m128d im = _mm_andnot_pd(_mm_or_pd(real, repeated), _mm_mul_pd(half, rad));
+
+	_mm_storeu_pd(&zr0[l], _mm_or_pd(_mm_and_pd(real, _mm_min_pd(t, r2)), _mm_andnot_pd(real, mid)));
+	_mm_storeu_pd(&zr1[l], _mm_or_pd(_mm_and_pd(real, _mm_max_pd(t, r2)), _mm_andnot_pd(real, mid)));
+	_mm_storeu_pd(&zi0[l], im);
+	_mm_storeu_pd(&zi1[l], _mm_sub_pd(zero, im));
+    }
+#else
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	double discrim = b[l] * b[l] - 4.0 * c[l];
+	double rad = sqrt(fabs(discrim));
+	double t = -0.5 * (b[l] + ((b[l] > 0.0) ? rad : 0.0 - rad));
+	double r2 = c[l] / t;
+	int real = discrim > 0.0;
+	double mid = -0.5 * b[l];
+	double im = (real || fabs(discrim) < SMALL_FASTF) ? 0.0 : 0.5 * rad;
+
+	zr0[l] = real ? ((t < r2) ? t : r2) : mid;
+	zr1[l] = real ? ((t > r2) ? t : r2) : mid;
+	zi0[l] = im;
+	zi1[l] = 0.0 - im;
+    }
+#endif
+}
+
+
+/**
+ * p(z) and p'(z) for the monic polynomials cf[0..dgr] (cf[0] == 1) in
+ * every lane, by Horner's rule.
+ */
+static inline void
+poly_eval_lanes(int dgr, double cf[][RT_POLY_LANES], const double *zr, const double *zi,
+		double *pr, double *pi, double *dr, double *di)
+{
+    double br[RT_POLY_LANES], bi[RT_POLY_LANES], cr[RT_POLY_LANES], ci[RT_POLY_LANES];
+    int k, l;
+
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	br[l] = 1.0;
+	bi[l] = cr[l] = ci[l] = 0.0;
+    }
+    for (k = 1; k <= dgr; k++) {
+	for (l = 0; l < RT_POLY_LANES; l++) {
+	    double tr = cr[l] * zr[l] - ci[l] * zi[l] + br[l];
+	    double ti = cr[l] * zi[l] + ci[l] * zr[l] + bi[l];
+
+	    cr[l] = tr;
+	    ci[l] = ti;
+	    tr = br[l] * zr[l] - bi[l] * zi[l] + cf[k][l];
+	    ti = br[l] * zi[l] + bi[l] * zr[l];
+	    br[l] = tr;
+	    bi[l] = ti;
+	}
+    }
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	pr[l] = br[l];
+	pi[l] = bi[l];
+	dr[l] = cr[l];
+	di[l] = ci[l];
+    }
+}
+
+
+/**
+ * Check the dgr roots in every lane the way rt_poly_checkroots()
+ * does, clearing ok[] where any fails, and take one Newton step on
+ * those that pass when the step is a small correction.
+ */
+static void
+poly_polish_lanes(int dgr, double cf[][RT_POLY_LANES],
+		  double zr[][RT_POLY_LANES], double zi[][RT_POLY_LANES], int *ok)
+{
+    int r, l;
+#ifdef RT_POLY_SSE2
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d tol = _mm_set1_pd(RT_ROOT_TOL);
+    const __m128d steptol = _mm_set1_pd(1.0e-6);
+    const __m128d absmask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+
+    for (r = 0; r < dgr; r++) {
+	for (l = 0; l < RT_POLY_LANES; l += 2) {
+	    __m128d xr = _mm_loadu_pd(&zr[r][l]);
+	    __m128d xi = _mm_loadu_pd(&zi[r][l]);
+	    __m128d pr = one, pi = zero, dr = zero, di = zero;
+	    __m128d den, inv, sr, si, pass, step, mag;
+	    int k;
+
+	    /* p(z) and p'(z) by Horner's rule */
+	    for (k = 1; k <= dgr; k++) {
+		__m128d tr = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(dr, xr), _mm_mul_pd(di, xi)), pr);
+		__m128d ti = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dr, xi), _mm_mul_pd(di, xr)), pi);
+
+		dr = tr;
+		di = ti;
+		tr = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(pr, xr), _mm_mul_pd(pi, xi)), _mm_loadu_pd(&cf[k][l]));
+		ti = _mm_add_pd(_mm_mul_pd(pr, xi), _mm_mul_pd(pi, xr));
+		pr = tr;
+		pi = ti;
+	    }
+
+	    den = _mm_add_pd(_mm_mul_pd(dr, dr), _mm_mul_pd(di, di));
+	    inv = _mm_div_pd(one, den);
+	    sr = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(pr, dr), _mm_mul_pd(pi, di)), inv);
+	    si = _mm_mul_pd(_mm_sub_pd(_mm_mul_pd(pi, dr), _mm_mul_pd(pr, di)), inv);
+	    pass = _mm_and_pd(_mm_cmple_pd(_mm_and_pd(pr, absmask), tol),
+			      _mm_cmple_pd(_mm_and_pd(pi, absmask), tol));
+	    mag = _mm_add_pd(one, _mm_add_pd(_mm_mul_pd(xr, xr), _mm_mul_pd(xi, xi)));
+	    step = _mm_and_pd(_mm_and_pd(pass, _mm_cmpgt_pd(den, zero)),
+			      _mm_cmple_pd(_mm_add_pd(_mm_mul_pd(sr, sr), _mm_mul_pd(si, si)),
+					   _mm_mul_pd(steptol, mag)));
+
+	    _mm_storeu_pd(&zr[r][l], _mm_sub_pd(xr, _mm_and_pd(step, sr)));
+	    _mm_storeu_pd(&zi[r][l], _mm_sub_pd(xi, _mm_and_pd(step, si)));
+	    k = _mm_movemask_pd(pass);
+	    ok[l] &= k & 1;
+	    ok[l+1] &= (k >> 1) & 1;
+	}
+    }
+#else
+    for (r = 0; r < dgr; r++) {
+	for (l = 0; l < RT_POLY_LANES; l++) {
+	    double xr = zr[r][l];
+	    double xi = zi[r][l];
+	    double pr = 1.0, pi = 0.0, dr = 0.0, di = 0.0;
+	    double den, inv, sr, si;
+	    int pass, step, k;
+
+	    /* p(z) and p'(z) by Horner's rule */
+	    for (k = 1; k <= dgr; k++) {
+		double tr = dr * xr - di * xi + pr;
+		double ti = dr * xi + di * xr + pi;
+
+		dr = tr;
+		di = ti;
+		tr = pr * xr - pi * xi + cf[k][l];
+		ti = pr * xi + pi * xr;
+		pr = tr;
+		pi = ti;
+	    }
+
+	    den = dr * dr + di * di;
+	    inv = 1.0 / den;
+	    sr = (pr * dr + pi * di) * inv;
+	    si = (pi * dr - pr * di) * inv;
+	    pass = fabs(pr) <= RT_ROOT_TOL && fabs(pi) <= RT_ROOT_TOL;
+	    step = pass && den > 0.0
+		&& sr * sr + si * si <= 1.0e-6 * (1.0 + (xr * xr + xi * xi));
+
+	    zr[r][l] = xr - (step ? sr : 0.0);
+	    zi[r][l] = xi - (step ? si : 0.0);
+	    ok[l] &= pass;
+	}
+    }
+#endif
+}
+
+
+/**
+ * Take up to RT_POLY_POLISH Newton steps on the roots of the lanes
+ * that failed their check, keeping whichever iterate left the
+ * smallest residual, and check them again.
+ */
+static void
+poly_repair_lanes(int dgr, double cf[][RT_POLY_LANES],
+		  double zr[][RT_POLY_LANES], double zi[][RT_POLY_LANES], int *ok)
+{
+    int failed[RT_POLY_LANES];
+    int r, it, l;
+
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	failed[l] = !ok[l];
+	ok[l] = 1;
+    }
+
+    for (r = 0; r < dgr; r++) {
+	double xr[RT_POLY_LANES], xi[RT_POLY_LANES], best[RT_POLY_LANES];
+	double er[RT_POLY_LANES], ei[RT_POLY_LANES];
+
+	for (l = 0; l < RT_POLY_LANES; l++) {
+	    xr[l] = zr[r][l];
+	    xi[l] = zi[r][l];
+	    best[l] = er[l] = ei[l] = INFINITY;
+	}
+
+	for (it = 0; it <= RT_POLY_POLISH; it++) {
+	    double pr[RT_POLY_LANES], pi[RT_POLY_LANES], dr[RT_POLY_LANES], di[RT_POLY_LANES];
+
+	    poly_eval_lanes(dgr, cf, xr, xi, pr, pi, dr, di);
+	    for (l = 0; l < RT_POLY_LANES; l++) {
+		double m = pr[l] * pr[l] + pi[l] * pi[l];
+		double den = dr[l] * dr[l] + di[l] * di[l];
+		int better = m < best[l];
+
+		best[l] = better ? m : best[l];
+		zr[r][l] = (better && failed[l]) ? xr[l] : zr[r][l];
+		zi[r][l] = (better && failed[l]) ? xi[l] : zi[r][l];
+		er[l] = better ? pr[l] : er[l];
+		ei[l] = better ? pi[l] : ei[l];
+
+		/* z -= p / p' */
+		if (den > 0.0) {
+		    xr[l] -= (pr[l] * dr[l] + pi[l] * di[l]) / den;
+		    xi[l] -= (pi[l] * dr[l] - pr[l] * di[l]) / den;
+		}
+	    }
+	}
+
+	for (l = 0; l < RT_POLY_LANES; l++) {
+	    if (failed[l] && !(fabs(er[l]) <= RT_ROOT_TOL && fabs(ei[l]) <= RT_ROOT_TOL))
+		ok[l] = 0;
+	}
+    }
+}
+
+
+/**
+ * Split the monic quartics cf[] in every lane into the quadratic
+ * factors z^2 + qb[0]*z + qc[0] and z^2 + qb[1]*z + qc[1] by
+ * Ferrari's method, as bn_poly_quartic_roots() does, given the roots
+ * u of their resolvent cubics rc[].
+ *
+ * The largest real root of the resolvent gets one Newton step first,
+ * since the factoring is very sensitive to it.  Where
+ * bn_poly_quartic_roots() gives up because neither way of pairing the
+ * constant terms with the linear ones reproduces cf[3], the better of
+ * the two is taken and left to the polishing and the residual check.
+ */
+static void
+poly_ferrari_lanes(double cf[5][RT_POLY_LANES], double rc[4][RT_POLY_LANES],
+		   double u_r[3][RT_POLY_LANES], double u_i[3][RT_POLY_LANES],
+		   double qb[2][RT_POLY_LANES], double qc[2][RT_POLY_LANES], int *ok)
+{
+    /* something considerably larger than squared floating point fuss */
+    const double small = 1.0e-8;
+    int l;
+#ifdef RT_POLY_SSE2
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d nsmall = _mm_set1_pd(-small);
+    const __m128d tiny = _mm_set1_pd(SMALL_FASTF);
+    const __m128d absmask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+
+    for (l = 0; l < RT_POLY_LANES; l += 2) {
+	__m128d c1 = _mm_loadu_pd(&rc[1][l]);
+	__m128d c2 = _mm_loadu_pd(&rc[2][l]);
+	__m128d c3 = _mm_loadu_pd(&rc[3][l]);
+	__m128d a1 = _mm_loadu_pd(&cf[1][l]);
+	__m128d a2 = _mm_loadu_pd(&cf[2][l]);
+	__m128d a3 = _mm_loadu_pd(&cf[3][l]);
+	__m128d a4 = _mm_loadu_pd(&cf[4][l]);
+	__m128d u0 = _mm_loadu_pd(&u_r[0][l]);
+	__m128d cplx = _mm_cmpge_pd(_mm_and_pd(_mm_loadu_pd(&u_i[1][l]), absmask), tiny);
+	__m128d umax = _mm_max_pd(u0, _mm_max_pd(_mm_loadu_pd(&u_r[1][l]), _mm_loadu_pd(&u_r[2][l])));
+	__m128d U = _mm_or_pd(_mm_and_pd(cplx, u0), _mm_andnot_pd(cplx, umax));
+	__m128d r, dr, u, ru, p, q, bad, a1h, q1, q2, e1, e2, sel;
+	int m;
+
+	r = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(U, c1), U), c2), U), c3);
+	dr = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(3.0), U), _mm_add_pd(c1, c1)), U), c2);
+	u = _mm_sub_pd(U, _mm_div_pd(r, dr));
+	ru = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(u, c1), u), c2), u), c3);
+	sel = _mm_cmplt_pd(_mm_and_pd(ru, absmask), _mm_and_pd(r, absmask));
+	U = _mm_or_pd(_mm_and_pd(sel, u), _mm_andnot_pd(sel, U));
+
+	p = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(_mm_mul_pd(a1, a1), _mm_set1_pd(0.25)), U), a2);
+	U = _mm_mul_pd(U, half);
+	q = _mm_sub_pd(_mm_mul_pd(U, U), a4);
+	bad = _mm_or_pd(_mm_cmplt_pd(p, nsmall), _mm_cmplt_pd(q, nsmall));
+	m = _mm_movemask_pd(bad);
+	ok[l] &= !(m & 1);
+	ok[l+1] &= !(m & 2);
+	p = _mm_sqrt_pd(_mm_max_pd(p, zero));
+	q = _mm_sqrt_pd(_mm_max_pd(q, zero));
+
+	a1h = _mm_mul_pd(a1, half);
+	p = _mm_sub_pd(a1h, p);
+	_mm_storeu_pd(&qb[0][l], p);
+	a1h = _mm_sub_pd(_mm_add_pd(a1h, a1h), p);
+	_mm_storeu_pd(&qb[1][l], a1h);
+	q1 = _mm_sub_pd(U, q);
+	q2 = _mm_add_pd(U, q);
+
+	e1 = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(p, q2), _mm_mul_pd(a1h, q1)), a3);
+	e2 = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(p, q1), _mm_mul_pd(a1h, q2)), a3);
+	sel = _mm_cmple_pd(_mm_and_pd(e1, absmask), _mm_and_pd(e2, absmask));
+	_mm_storeu_pd(&qc[0][l], _mm_or_pd(_mm_and_pd(sel, q1), _mm_andnot_pd(sel, q2)));
+	_mm_storeu_pd(&qc[1][l], _mm_or_pd(_mm_and_pd(sel, q2), _mm_andnot_pd(sel, q1)));
+    }
+#else
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	double c1 = rc[1][l], c2 = rc[2][l], c3 = rc[3][l];
+	double a1 = cf[1][l], a2 = cf[2][l], a3 = cf[3][l], a4 = cf[4][l];
+	double u0 = u_r[0][l];
+	double umax = (u_r[1][l] > u_r[2][l]) ? u_r[1][l] : u_r[2][l];
+	double U = (fabs(u_i[1][l]) >= SMALL_FASTF) ? u0 : ((u0 > umax) ? u0 : umax);
+	double r, dr, u, ru, p, q, a1h, q1, q2, e1, e2;
+
+	r = ((U + c1) * U + c2) * U + c3;
+	dr = (3.0 * U + (c1 + c1)) * U + c2;
+	u = U - r / dr;
+	ru = ((u + c1) * u + c2) * u + c3;
+	if (fabs(ru) < fabs(r))
+	    U = u;
+
+	p = a1 * a1 * 0.25 + U - a2;
+	U = U * 0.5;
+	q = U * U - a4;
+	if (p < -small || q < -small)
+	    ok[l] = 0;
+	p = sqrt((p > 0.0) ? p : 0.0);
+	q = sqrt((q > 0.0) ? q : 0.0);
+
+	a1h = a1 * 0.5;
+	p = a1h - p;
+	qb[0][l] = p;
+	a1h = (a1h + a1h) - p;
+	qb[1][l] = a1h;
+	q1 = U - q;
+	q2 = U + q;
+
+	e1 = (p * q2 + a1h * q1) - a3;
+	e2 = (p * q1 + a1h * q2) - a3;
+	qc[0][l] = (fabs(e1) <= fabs(e2)) ? q1 : q2;
+	qc[1][l] = (fabs(e1) <= fabs(e2)) ? q2 : q1;
+    }
+#endif
+}
+
+
+/**
+ * Solve the quartics eqns[idx[0..nl-1]] in closed form by Ferrari's
+ * method, as bn_poly_quartic_roots() does, polish the roots, and hand
+ * whichever do not check out to rt_poly_roots().
+ */
+static void
+poly_quartic_batch(bn_poly_t eqns[], const size_t *idx, int nl, bn_complex_t roots[][4], int nroots[], const char *name)
+{
+    double cf[5][RT_POLY_LANES];
+    double rc[4][RT_POLY_LANES];	/* the resolvent cubic */
+    double u_r[3][RT_POLY_LANES], u_i[3][RT_POLY_LANES];
+    double qb[2][RT_POLY_LANES], qc[2][RT_POLY_LANES];
+    double zr[4][RT_POLY_LANES], zi[4][RT_POLY_LANES];
+    int ok[RT_POLY_LANES];
+    int k, l;
+
+    /* short batches repeat their last equation in the spare lanes */
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	const bn_poly_t *eqn = &eqns[idx[(l < nl) ? l : nl - 1]];
+	double factor = 1.0 / eqn->cf[0];
+
+	cf[0][l] = 1.0;
+	for (k = 1; k <= 4; k++)
+	    cf[k][l] = eqn->cf[k] * factor;
+	ok[l] = 1;
+    }
+
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	rc[0][l] = 1.0;
+	rc[1][l] = -cf[2][l];
+	rc[2][l] = cf[3][l] * cf[1][l] - 4.0 * cf[4][l];
+	rc[3][l] = -cf[3][l] * cf[3][l] - cf[4][l] * cf[1][l] * cf[1][l] + 4.0 * cf[4][l] * cf[2][l];
+    }
+    poly_cubic_lanes(rc[1], rc[2], rc[3], u_r, u_i, ok);
+
+    poly_ferrari_lanes(cf, rc, u_r, u_i, qb, qc, ok);
+
+    poly_quadratic_lanes(qb[0], qc[0], zr[0], zi[0], zr[1], zi[1]);
+    poly_quadratic_lanes(qb[1], qc[1], zr[2], zi[2], zr[3], zi[3]);
+    poly_polish_lanes(4, cf, zr, zi, ok);
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	if (!ok[l]) {
+	    poly_repair_lanes(4, cf, zr, zi, ok);
+	    break;
+	}
+    }
+
+    /* two starting points polished onto the same root would pass the
+     * residual check with another root missing; the roots have to sum
+     * to -cf[1] as well */
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	double sum = zr[0][l] + zr[1][l] + zr[2][l] + zr[3][l];
+	double mag = fabs(zr[0][l]) + fabs(zr[1][l]) + fabs(zr[2][l]) + fabs(zr[3][l]);
+
+	if (!(fabs(sum + cf[1][l]) <= RT_ROOT_TOL * (1.0 + mag)))
+	    ok[l] = 0;
+    }
+
+    for (l = 0; l < nl; l++) {
+	size_t i = idx[l];
+
+	if (!ok[l]) {
+	    nroots[i] = rt_poly_roots(&eqns[i], roots[i], name);
+	    continue;
+	}
+	for (k = 0; k < 4; k++) {
+	    roots[i][k].re = zr[k][l];
+	    roots[i][k].im = zi[k][l];
+	}
+	nroots[i] = 4;
+    }
+}
+
+
+/**
+ * Solve the cubics eqns[idx[0..nl-1]] in closed form, polish the
+ * roots, and hand whichever do not check out to rt_poly_roots().
+ */
+static void
+poly_cubic_batch(bn_poly_t eqns[], const size_t *idx, int nl, bn_complex_t roots[][4], int nroots[], const char *name)
+{
+    double cf[4][RT_POLY_LANES];
+    double zr[3][RT_POLY_LANES], zi[3][RT_POLY_LANES];
+    int ok[RT_POLY_LANES];
+    int k, l;
+
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	const bn_poly_t *eqn = &eqns[idx[(l < nl) ? l : nl - 1]];
+	double factor = 1.0 / eqn->cf[0];
+
+	cf[0][l] = 1.0;
+	for (k = 1; k <= 3; k++)
+	    cf[k][l] = eqn->cf[k] * factor;
+	ok[l] = 1;
+    }
+
+    poly_cubic_lanes(cf[1], cf[2], cf[3], zr, zi, ok);
+    poly_polish_lanes(3, cf, zr, zi, ok);
+    for (l = 0; l < RT_POLY_LANES; l++) {
+	if (!ok[l]) {
+	    poly_repair_lanes(3, cf, zr, zi, ok);
+	    break;
+	}
+    }
+
+    for (l = 0; l < nl; l++) {
+	size_t i = idx[l];
+
+	if (!ok[l]) {
+	    nroots[i] = rt_poly_roots(&eqns[i], roots[i], name);
+	    continue;
+	}
+	for (k = 0; k < 3; k++) {
+	    roots[i][k].re = zr[k][l];
+	    roots[i][k].im = zi[k][l];
+	}
+	nroots[i] = 3;
+    }
+}
+
+
+void
+rt_poly_roots_n(size_t n, bn_poly_t eqns[], bn_complex_t roots[][4], int nroots[], const char *name)
+{
+    size_t cubics[RT_POLY_LANES], quartics[RT_POLY_LANES];
+    int ncubics = 0, nquartics = 0;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+	bn_poly_t *eqn = &eqns[i];
+
+	/* the leading and trailing zero coefficients rt_poly_roots()
+	 * strips off, and other degrees, are left to it */
+	if (eqn->dgr < 3 || eqn->dgr > 4 || ZERO(eqn->cf[0]) || ZERO(eqn->cf[eqn->dgr])) {
+	    nroots[i] = rt_poly_roots(eqn, roots[i], name);
+	    continue;
+	}
+
+	if (eqn->dgr == 4) {
+	    quartics[nquartics++] = i;
+	    if (nquartics == RT_POLY_LANES) {
+		poly_quartic_batch(eqns, quartics, nquartics, roots, nroots, name);
+		nquartics = 0;
+	    }
+	} else {
+	    cubics[ncubics++] = i;
+	    if (ncubics == RT_POLY_LANES) {
+		poly_cubic_batch(eqns, cubics, ncubics, roots, nroots, name);
+		ncubics = 0;
+	    }
+	}
+    }
+    if (nquartics)
+	poly_quartic_batch(eqns, quartics, nquartics, roots, nroots, name);
+    if (ncubics)
+	poly_cubic_batch(eqns, cubics, ncubics, roots, nroots, name);
+}
+
+
 /*
  * Local Variables:
  * mode: C
@@ -43,6 +43,10 @@
      ((_step)[Z] >= 0 && (_pz) > (_hi)[Z]))
 
 
+/* The entry after the last rt_piecestate in re_pieces[] */
+#define PIECESTATE_END(_psp) ((_psp)->magic == 0 && (_psp)->ray_seqno == 0)
+
+
 static void
 shoot_setup_status(struct rt_shootray_status *ss, struct application *ap)
 {
@@ -53,12 +57,100 @@ shoot_setup_status(struct rt_shootray_status *ss, struct application *ap)
 }
 
 
+/* Shoot the current cell's ray at all of stp, adding any segments to
+ * waiting_segs at their distances along the original ray.
+ */
+static inline void
+shoot_solid(struct rt_shootray_status *ssp, struct soltab *stp, struct seg *waiting_segs)
+{
+    struct application *ap = ssp->ap;
+    struct resource *resp = ap->a_resource;
+    const int debug_shoot = RT_G_DEBUG & RT_DEBUG_SHOOT;
+    struct seg new_segs;
+    int ret;
+
+    /* Check against bounding RPP, if desired by solid */
+    if (stp->st_meth->ft_use_rpp) {
+	if (!rt_in_rpp(&ssp->newray, ssp->inv_dir,
+		       stp->st_min, stp->st_max)) {
+	    if (debug_shoot)bu_log("rpp miss %s\n", stp->st_name);
+	    resp->re_prune_solrpp++;
+	    return;	/* MISS */
+	}
+	if (ssp->dist_corr + ssp->newray.r_max < BACKING_DIST) {
+	    if (debug_shoot)bu_log("rpp skip %s, dist_corr=%g, r_max=%g\n", stp->st_name, ssp->dist_corr, ssp->newray.r_max);
+	    resp->re_prune_solrpp++;
+	    return;	/* MISS */
+	}
+    }
+
+    if (debug_shoot)bu_log("shooting %s\n", stp->st_name);
+    resp->re_shots++;
+    BU_LIST_INIT(&(new_segs.l));
+
+    ret = -1;
+    if (stp->st_meth->ft_shot) {
+	ret = stp->st_meth->ft_shot(stp, &ssp->newray, ap, &new_segs);
+    }
+    if (ret <= 0) {
+	resp->re_shot_miss++;
+	return;	/* MISS */
+    }
+
+    /* Add seg chain to list awaiting rt_boolweave() */
+    {
+	register struct seg *s2;
+	while (BU_LIST_WHILE(s2, seg, &(new_segs.l))) {
+	    BU_LIST_DEQUEUE(&(s2->l));
+	    /* Restore to original distance */
+	    s2->seg_in.hit_dist += ssp->dist_corr;
+	    s2->seg_out.hit_dist += ssp->dist_corr;
+	    s2->seg_in.hit_rayp = s2->seg_out.hit_rayp = &ap->a_ray;
+	    BU_LIST_INSERT(&(waiting_segs->l), &(s2->l));
+	}
+    }
+    resp->re_shot_hit++;
+}
+
+
 void
 _res_pieces_init(struct resource *resp, struct rt_i *rtip)
 {
+    struct soltab *stp;
+    struct rt_piecestate *psptab;
+    size_t npsp, i;
+
     RT_CK_RESOURCE(resp);
     RT_CK_RTI(rtip);
+
     resp->re_pieces = NULL;
+    npsp = rtip->i->rti_nsolids_with_pieces;
+    if (npsp == 0)
+	return;
+
+    /* one extra, zeroed entry ends the array so it can be released
+     * without knowing how many solids had pieces when it was made */
+    psptab = (struct rt_piecestate *)bu_calloc(npsp + 1, sizeof(struct rt_piecestate), "re_pieces[]");
+    for (i = 0; i < npsp; i++)
+	psptab[i].ray_seqno = -1;
+
+    RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
+	struct rt_piecestate *psp;
+
+	if (stp->st_npieces <= 1)
+	    continue;
+	if (stp->st_piecestate_num < 0 || (size_t)stp->st_piecestate_num >= npsp)
+	    continue;
+	psp = &psptab[stp->st_piecestate_num];
+	psp->magic = RT_PIECESTATE_MAGIC;
+	psp->ray_seqno = -1;
+	psp->stp = stp;
+	psp->shot = bu_bitv_new(stp->st_npieces);
+	rt_htbl_init(&psp->htab, 8, "psp->htab");
+	psp->cutp = CUTTER_NULL;
+    } RT_VISIT_ALL_SOLTABS_END;
+
+    resp->re_pieces = psptab;
 }
 
 void
@@ -71,7 +163,7 @@ void
 _res_pieces_clean(struct resource *resp, struct rt_i *rtip)
 {
     struct rt_piecestate *psp;
-    int i;
+    size_t i;
 
     RT_CK_RESOURCE(resp);
     if (rtip) {
@@ -83,43 +175,27 @@ _res_pieces_clean(struct resource *resp, struct rt_i *rtip)
 
     if (!resp->re_pieces) {
 	/* no pieces allocated, nothing to do */
-	if (rtip) {
-	    rtip->i->rti_nsolids_with_pieces = 0;
-	}
 	return;
     }
 
-    /* pieces allocated, need to clean up */
-    if (rtip) {
-	for (i = rtip->i->rti_nsolids_with_pieces-1; i >= 0; i--) {
-	    psp = &resp->re_pieces[i];
-
-	    /*
-	     * Skip uninitialized structures.
-	     *
-	     * Doing this until we figure out why all "struct
-	     * rt_piecestate" array members are NOT getting
-	     * initialized in _res_pieces_init() above.  Initial
-	     * glance looks like tree.c/rt_gettrees_muves() can be
-	     * called in such a way as to assign
-	     * stp->st_piecestate_num multiple times, each time with a
-	     * different value. This value is an index into the
-	     * resp->re_pieces array. When this happens, it causes all
-	     * but the last referenced "struct rt_piecestate" member
-	     * to be initialized.
-	     */
-	    if (psp->magic == 0)
-		continue;
+    /* Walk to the zeroed entry _res_pieces_init() left at the end
+     * rather than trusting rti_nsolids_with_pieces, which is only
+     * right for the first resource cleaned after a rt_gettrees().
+     */
+    for (i = 0; !PIECESTATE_END(&resp->re_pieces[i]); i++) {
+	psp = &resp->re_pieces[i];
 
-	    RT_CK_PIECESTATE(psp);
-	    rt_htbl_free(&psp->htab);
-	    bu_bitv_free(psp->shot);
-	    psp->shot = NULL;	/* sanity */
-	    psp->magic = 0;
-	}
+	/* slot nobody's st_piecestate_num pointed at */
+	if (psp->magic == 0)
+	    continue;
 
-	rtip->i->rti_nsolids_with_pieces = 0;
+	RT_CK_PIECESTATE(psp);
+	rt_htbl_free(&psp->htab);
+	bu_bitv_free(psp->shot);
+	psp->shot = NULL;	/* sanity */
+	psp->magic = 0;
     }
+
     bu_free((char *)resp->re_pieces, "re_pieces[]");
     resp->re_pieces = NULL;
 }
@@ -531,7 +607,6 @@ _BU_ATTR_FLATTEN int
 rt_shootray(register struct application *ap)
 {
     struct rt_shootray_status ss;
-    struct seg new_segs;	/* from solid intersections */
     struct seg waiting_segs;	/* awaiting rt_boolweave() */
     struct seg finished_segs;	/* processed by rt_boolweave() */
     fastf_t last_bool_start;
@@ -595,12 +670,11 @@ rt_shootray(register struct application *ap)
     FinalPart.pt_magic = PT_HD_MAGIC;
     ap->a_Final_Part_hdp = &FinalPart;
 
-    BU_LIST_INIT(&new_segs.l);
     BU_LIST_INIT(&waiting_segs.l);
     BU_LIST_INIT(&finished_segs.l);
     ap->a_finished_segs_hdp = &finished_segs;
 
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_parthead)) {
+    if (!BU_LIST_IS_INITIALIZED(&resp->re_solid_bitv)) {
 	/* XXX This shouldn't happen any more */
 	bu_log("rt_shootray() resp=%p uninitialized, fixing it\n", (void *)resp);
 	/*
@@ -616,6 +690,20 @@ rt_shootray(register struct application *ap)
     if (resp != &rt_uniresource)
 	BU_ASSERT(BU_PTBL_GET(&rtip->rti_resources, resp->re_cpu) != NULL);
 
+    if (!resp->re_pieces && rtip->i->rti_nsolids_with_pieces > 0) {
+	/* Initialize this processor's 'solid pieces' state */
+	_res_pieces_init(resp, rtip);
+    }
+    if (resp->re_pieces) {
+	if (UNLIKELY(!BU_PTBL_TEST(&resp->re_pieces_pending))) {
+	    /* only happens first time through */
+	    bu_ptbl_init(&resp->re_pieces_pending, 100, "re_pieces_pending");
+	}
+	/* left over if the last ray stopped at its first hit */
+	if (BU_PTBL_LEN(&resp->re_pieces_pending))
+	    bu_ptbl_trunc(&resp->re_pieces_pending, 0);
+    }
+
     solidbits = rt_get_solidbitv(rtip->stats.nsolids, resp);
 
     if (BU_LIST_IS_EMPTY(&resp->re_region_ptbl)) {
@@ -779,6 +867,27 @@ rt_shootray(register struct application *ap)
     last_bool_start = BACKING_DIST;
     shoot_setup_status(&ss, ap);
 
+    /* Cells inside a solid list none of its pieces, so a first hit
+     * ray starting inside a solid in pieces could stop before it
+     * reaches that solid's surface.  Shoot such solids whole here.
+     */
+    if (ap->a_onehit && resp->re_pieces && ss.model_start < BACKING_DIST) {
+	struct rt_piecestate *psp;
+
+	for (psp = resp->re_pieces; !PIECESTATE_END(psp); psp++) {
+	    struct soltab *stp = psp->stp;
+
+	    if (psp->magic != RT_PIECESTATE_MAGIC || BU_BITTEST(solidbits, stp->st_bit))
+		continue;
+	    if (!rt_in_rpp(&ss.newray, ss.inv_dir, stp->st_min, stp->st_max)
+		|| ss.newray.r_min >= BACKING_DIST - rtip->rti_tol.dist
+		|| ss.newray.r_max < BACKING_DIST)
+		continue;
+	    BU_BITSET(solidbits, stp->st_bit);
+	    shoot_solid(&ss, stp, &waiting_segs);
+	}
+    }
+
     /*
      * While the ray remains inside model space, push from box to box
      * until ray emerges from model space again (or first hit is
@@ -793,7 +902,7 @@ rt_shootray(register struct application *ap)
 	    rt_pr_cut(cutp, 0);
 	}
 
-	if (cutp->bn.bn_len <= 0) {
+	if (cutp->bn.bn_len <= 0 && cutp->bn.bn_piecelen <= 0) {
 	    /* Push ray onwards to next box */
 	    ss.box_start = ss.box_end;
 	    resp->re_nempty_cells++;
@@ -807,7 +916,6 @@ rt_shootray(register struct application *ap)
 	    stpp = &(cutp->bn.bn_list[cutp->bn.bn_len-1]);
 	    for (; stpp >= cutp->bn.bn_list; stpp--) {
 		register struct soltab *stp = *stpp;
-		int ret;
 
 		if (BU_BITTEST(solidbits, stp->st_bit)) {
 		    resp->re_ndup++;
@@ -816,48 +924,108 @@ rt_shootray(register struct application *ap)
 
 		/* Shoot a ray */
 		BU_BITSET(solidbits, stp->st_bit);
+		shoot_solid(&ss, stp, &waiting_segs);
+	    }
+	}
+
+	/* Consider all pieces of all solids within the box */
+	if (cutp->bn.bn_piecelen > 0 && ss.box_end >= BACKING_DIST) {
+	    register struct rt_piecelist *plp;
+
+	    plp = &(cutp->bn.bn_piecelist[cutp->bn.bn_piecelen-1]);
+	    for (; plp >= cutp->bn.bn_piecelist; plp--) {
+		struct rt_piecestate *psp;
+		struct soltab *stp;
+		int ret;
+		int had_hits_before;
+
+		RT_CK_PIECELIST(plp);
+		stp = plp->stp;
+		RT_CK_SOLTAB(stp);
 
-		/* Check against bounding RPP, if desired by solid */
-		if (stp->st_meth->ft_use_rpp) {
+		if (BU_BITTEST(solidbits, stp->st_bit)) {
+		    /* shot whole, or all its hits already made segs */
+		    resp->re_piece_ndup++;
+		    continue;
+		}
+
+		psp = &(resp->re_pieces[stp->st_piecestate_num]);
+		RT_CK_PIECESTATE(psp);
+		if (psp->ray_seqno != resp->re_nshootray) {
+		    /* state is from an earlier ray, scrub */
+		    BU_BITV_ZEROALL(psp->shot);
+		    psp->ray_seqno = resp->re_nshootray;
+		    rt_htbl_reset(&psp->htab);
+
+		    /* Compute ray entry and exit to entire solid's
+		     * bounding box.
+		     */
 		    if (!rt_in_rpp(&ss.newray, ss.inv_dir,
 				   stp->st_min, stp->st_max)) {
-			if (debug_shoot)bu_log("rpp miss %s\n", stp->st_name);
+			if (debug_shoot)bu_log("rpp miss %s (all pieces)\n", stp->st_name);
 			resp->re_prune_solrpp++;
+			BU_BITSET(solidbits, stp->st_bit);
 			continue;	/* MISS */
 		    }
-		    if (ss.dist_corr + ss.newray.r_max < BACKING_DIST) {
-			if (debug_shoot)bu_log("rpp skip %s, dist_corr=%g, r_max=%g\n", stp->st_name, ss.dist_corr, ss.newray.r_max);
-			resp->re_prune_solrpp++;
-			continue;	/* MISS */
+		    psp->mindist = ss.newray.r_min + ss.dist_corr;
+		    psp->maxdist = ss.newray.r_max + ss.dist_corr;
+		    if (debug_shoot)bu_log("%s mindist=%g, maxdist=%g\n", stp->st_name, psp->mindist, psp->maxdist);
+
+		    /* Every cell since the walk started has been seen,
+		     * so only a box reaching back past that start point
+		     * (a ray starting inside the solid's box) has pieces
+		     * that were never listed and needs the whole solid.
+		     */
+		    if (psp->mindist < FMAX(ss.model_start, BACKING_DIST) - rtip->rti_tol.dist
+			|| !stp->st_meth->ft_piece_shot) {
+			BU_BITSET(solidbits, stp->st_bit);
+			shoot_solid(&ss, stp, &waiting_segs);
+			continue;
 		    }
+		    had_hits_before = 0;
+		} else {
+		    had_hits_before = psp->htab.end;
 		}
 
-		if (debug_shoot)bu_log("shooting %s\n", stp->st_name);
-		resp->re_shots++;
-		BU_LIST_INIT(&(new_segs.l));
-
-		ret = -1;
-		if (stp->st_meth->ft_shot) {
-		    ret = stp->st_meth->ft_shot(stp, &ss.newray, ap, &new_segs);
-		}
+		/*
+		 * Allow this solid to shoot at all of its 'pieces' in
+		 * this cell, all at once.  'newray' has been
+		 * transformed to be near to this cell, and
+		 * 'dist_corr' is the additive correction factor that
+		 * ft_piece_shot() must apply to hits calculated using
+		 * 'newray'.
+		 */
+		resp->re_piece_shots++;
+		psp->cutp = cutp;
+
+		ret = stp->st_meth->ft_piece_shot(psp, plp, ss.dist_corr, &ss.newray, ap, &waiting_segs);
 		if (ret <= 0) {
-		    resp->re_shot_miss++;
-		    continue;	/* MISS */
+		    /* No hits at all */
+		    resp->re_piece_shot_miss++;
+		} else {
+		    resp->re_piece_shot_hit++;
 		}
-
-		/* Add seg chain to list awaiting rt_boolweave() */
-		{
-		    register struct seg *s2;
-		    while (BU_LIST_WHILE(s2, seg, &(new_segs.l))) {
-			BU_LIST_DEQUEUE(&(s2->l));
-			/* Restore to original distance */
-			s2->seg_in.hit_dist += ss.dist_corr;
-			s2->seg_out.hit_dist += ss.dist_corr;
-			s2->seg_in.hit_rayp = s2->seg_out.hit_rayp = &ap->a_ray;
-			BU_LIST_INSERT(&(waiting_segs.l), &(s2->l));
+		if (debug_shoot)bu_log("shooting %s pieces, nhit=%d\n", stp->st_name, ret);
+
+		/* See if this solid has been fully processed yet.  If
+		 * ray has passed through bounding volume, we're done.
+		 * ft_piece_hitsegs() will only be called once per ray.
+		 */
+		if (ss.box_end > psp->maxdist) {
+		    if (psp->htab.end > 0) {
+			/* Convert hits into segs; distance correction
+			 * was handled in ft_piece_shot().
+			 */
+			stp->st_meth->ft_piece_hitsegs(psp, &waiting_segs, ap);
+			rt_htbl_reset(&psp->htab);
 		    }
+		    BU_BITSET(solidbits, stp->st_bit);
+
+		    if (had_hits_before)
+			bu_ptbl_rm(&resp->re_pieces_pending, (long *)psp);
+		} else if (!had_hits_before && psp->htab.end > 0) {
+		    bu_ptbl_ins_unique(&resp->re_pieces_pending, (long *)psp);
 		}
-		resp->re_shot_hit++;
 	    }
 	}
 	if (RT_G_DEBUG & RT_DEBUG_ADVANCE)
@@ -893,6 +1061,19 @@ rt_shootray(register struct application *ap)
 		/* Weave these segments into partition list */
 		rt_boolweave(&finished_segs, &waiting_segs, &InitialPart, ap);
 
+		if (resp->re_pieces && BU_PTBL_LEN(&resp->re_pieces_pending) > 0) {
+		    /* Find the lowest pending mindist, that's as far
+		     * as boolfinal can progress to.
+		     */
+		    struct rt_piecestate **psp;
+		    for (BU_PTBL_FOR(psp, (struct rt_piecestate **), &resp->re_pieces_pending)) {
+			if ((*psp)->mindist < pending_hit) {
+			    pending_hit = (*psp)->mindist;
+			    if (debug_shoot) bu_log("pending_hit lowered to %g by %s\n", pending_hit, (*psp)->stp->st_name);
+			}
+		    }
+		}
+
 		/* Evaluate regions up to end of good segs */
 		if (ss.box_end < pending_hit) pending_hit = ss.box_end;
 		done = rt_boolfinal(&InitialPart, &FinalPart,
@@ -921,6 +1102,19 @@ weave:
     if (RT_G_DEBUG&RT_DEBUG_ADVANCE)
 	bu_log("rt_shootray: ray has left known space\n");
 
+    /* Process any pending hits into segs */
+    if (resp->re_pieces && BU_PTBL_LEN(&resp->re_pieces_pending) > 0) {
+	struct rt_piecestate **psp;
+	for (BU_PTBL_FOR(psp, (struct rt_piecestate **), &resp->re_pieces_pending)) {
+	    if ((*psp)->htab.end > 0) {
+		/* Distance correction was handled in ft_piece_shot */
+		(*psp)->stp->st_meth->ft_piece_hitsegs(*psp, &waiting_segs, ap);
+		rt_htbl_reset(&(*psp)->htab);
+	    }
+	}
+	bu_ptbl_trunc(&resp->re_pieces_pending, 0);
+    }
+
     if (BU_LIST_NON_EMPTY(&(waiting_segs.l))) {
 	rt_boolweave(&finished_segs, &waiting_segs, &InitialPart, ap);
     }
@@ -1056,7 +1250,7 @@ rt_cell_n_on_ray(register struct application *ap, int n)
     if (rtip->needprep)
 	rt_prep_parallel(rtip, 1);	/* Stay on our CPU */
 
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_parthead)) {
+    if (!BU_LIST_IS_INITIALIZED(&resp->re_solid_bitv)) {
 	/* XXX This shouldn't happen any more */
 	bu_log("rt_cell_n_on_ray() resp=%p uninitialized, fixing it\n", (void *)resp);
 	/*
@@ -1235,6 +1429,14 @@ rt_zero_res_stats(struct resource *resp)
     resp->re_piece_shot_hit = 0;
     resp->re_piece_shot_miss = 0;
     resp->re_piece_ndup = 0;
+
+    /* piece state is matched to a ray by re_nshootray, which just
+     * started over */
+    if (resp->re_pieces) {
+	struct rt_piecestate *psp;
+	for (psp = resp->re_pieces; !PIECESTATE_END(psp); psp++)
+	    psp->ray_seqno = -1;
+    }
 }
 
 
@@ -1260,6 +1462,30 @@ rt_add_res_stats(register struct rt_i *rtip, register struct resource *resp)
     rtip->stats.ndup += resp->re_ndup + resp->re_piece_ndup;
     rtip->stats.nempty_cells += resp->re_nempty_cells;
 
+    /* Allocator counters.  This is also where the slabs give back
+     * memory above the high-water mark of the frame just finished;
+     * nothing else is shooting on this resource now. */
+    if (resp->re_seg_slab) {
+	struct bu_slab_stats st;
+	bu_slab_stats(resp->re_seg_slab, &st, 1);
+	rtip->stats.nseg_get += st.gets;
+	if (st.peak > rtip->stats.nseg_peak)
+	    rtip->stats.nseg_peak = st.peak;
+	(void)bu_slab_trim(resp->re_seg_slab);
+	bu_slab_stats(resp->re_seg_slab, &st, 0);
+	rtip->stats.res_slab_bytes += st.bytes;
+    }
+    if (resp->re_part_slab) {
+	struct bu_slab_stats st;
+	bu_slab_stats(resp->re_part_slab, &st, 1);
+	rtip->stats.npart_get += st.gets;
+	if (st.peak > rtip->stats.npart_peak)
+	    rtip->stats.npart_peak = st.peak;
+	(void)bu_slab_trim(resp->re_part_slab);
+	bu_slab_stats(resp->re_part_slab, &st, 0);
+	rtip->stats.res_slab_bytes += st.bytes;
+    }
+
     /* Zero out resource totals, so repeated calls are not harmful */
     rt_zero_res_stats(resp);
 }
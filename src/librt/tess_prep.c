@@ -0,0 +1,358 @@
+/*                     T E S S _ P R E P . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @addtogroup ray */
+/** @{ */
+/** @file librt/tess_prep.c
+ *
+ * Shooting a tessellation in place of a slow primitive.
+ *
+ * Some primitives, an extrude of a detailed sketch for one, cost far
+ * more per ray than a BoT of the same shape.  Once such a primitive has
+ * been prepped, rt_tess_prep() may tessellate it to rti_ttol, prep the
+ * result as a BoT and swap that into the soltab, so every instance of
+ * the solid shoots the triangles instead.  The hits then are only as
+ * good as the tessellation tolerance, so this is for renders, never
+ * for analysis; rti_tess_prep picks how far it goes:
+ *
+ * RT_TESS_PREP_EXACT - every primitive is shot analytically.
+ *
+ * RT_TESS_PREP_OPTIN - only objects carrying a "tess_prep" attribute
+ * are considered: "always" (or "1", "yes") swaps in the BoT outright,
+ * "auto" does so only when it is measured to be faster.  The default.
+ *
+ * RT_TESS_PREP_AUTO - every primitive of an eligible type is also
+ * considered as "auto", unless its attribute is "never" (or "0",
+ * "no").  The eligible types are the ft_labels listed in
+ * rti_tess_prep_types, by default just extrude: revolve, superell and
+ * bspline are as slow, but cannot be tessellated yet.
+ *
+ * "auto" times a fixed set of rays through the primitive's bounding
+ * box.  Primitives cheaper per ray than rti_tess_prep_ns nanoseconds
+ * are left alone without tessellating them, and the BoT is kept only
+ * if it shoots the same rays clearly faster and hits nearly the same
+ * ones.  Those are wall clock times, so on a loaded or different
+ * machine the same model can come out the other way: "auto" trades
+ * reproducible hits for speed.  A solid left to a lazy prep is never
+ * timed, as its prep runs in the middle of the ray trace; only
+ * "always" swaps its BoT in.
+ */
+/** @} */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/avs.h"
+#include "bu/datetime.h"
+#include "bu/str.h"
+#include "vmath.h"
+#include "nmg.h"
+#include "raytrace.h"
+#include "rt/nmg_conv.h"
+#include "librt_private.h"
+
+
+#define TESS_PREP_ATTR "tess_prep"
+#define TESS_PREP_RAYS 64
+#define TESS_PREP_MIN_USEC 2000	/* how long a timing pass runs at least */
+#define TESS_PREP_MAX_PASSES 16
+#define TESS_PREP_GAIN 1.25	/* how much faster the BoT must be to be kept */
+
+#define TESS_NEVER 0
+#define TESS_MEASURE 1
+#define TESS_ALWAYS 2
+
+
+void
+rt_tess_prep_select_from_env(struct rt_i *rtip)
+{
+    const char *mode;
+
+    RT_CK_RTI(rtip);
+
+    mode = getenv("LIBRT_TESS_PREP");
+    if (!mode || !mode[0])
+	return;
+
+    if (BU_STR_EQUIV(mode, "exact") || BU_STR_EQUIV(mode, "off") || BU_STR_EQUAL(mode, "0"))
+	rtip->rti_tess_prep = RT_TESS_PREP_EXACT;
+    else if (BU_STR_EQUIV(mode, "optin") || BU_STR_EQUIV(mode, "opt-in") || BU_STR_EQUAL(mode, "1"))
+	rtip->rti_tess_prep = RT_TESS_PREP_OPTIN;
+    else if (BU_STR_EQUIV(mode, "auto") || BU_STR_EQUAL(mode, "2"))
+	rtip->rti_tess_prep = RT_TESS_PREP_AUTO;
+    else
+	bu_log("WARNING: unknown LIBRT_TESS_PREP value '%s', ignored\n", mode);
+}
+
+
+/* what the mode and the object's attribute ask for */
+static int
+tess_prep_wanted(const struct soltab *stp, const struct rt_db_internal *ip, const struct rt_i *rtip)
+{
+    const char *attr;
+    int mode = rtip->rti_tess_prep;
+
+    if (mode == RT_TESS_PREP_EXACT)
+	return TESS_NEVER;
+
+    attr = bu_avs_get(&ip->idb_avs, TESS_PREP_ATTR);
+    if (attr) {
+	if (BU_STR_EQUIV(attr, "always") || BU_STR_EQUIV(attr, "yes") || BU_STR_EQUAL(attr, "1"))
+	    return TESS_ALWAYS;
+	if (BU_STR_EQUIV(attr, "auto"))
+	    return TESS_MEASURE;
+	if (BU_STR_EQUIV(attr, "never") || BU_STR_EQUIV(attr, "no") || BU_STR_EQUAL(attr, "0"))
+	    return TESS_NEVER;
+	bu_log("WARNING: %s: unknown %s value '%s', ignored\n", stp->st_name, TESS_PREP_ATTR, attr);
+    }
+
+    if (mode == RT_TESS_PREP_AUTO && rt_functab_listed(rtip->rti_tess_prep_types, stp->st_meth->ft_label))
+	return TESS_MEASURE;
+    return TESS_NEVER;
+}
+
+
+/* a fixed spread of rays through stp's bounding box */
+static void
+tess_prep_rays(const struct soltab *stp, struct xray *rays, size_t n)
+{
+    fastf_t back = 2.0 * stp->st_bradius + 1.0;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+	struct xray *rp = &rays[i];
+	point_t target;
+	fastf_t u = (fastf_t)((i * 37) % n + 0.5) / (fastf_t)n;
+	fastf_t v = (fastf_t)((i * 59) % n + 0.5) / (fastf_t)n;
+	fastf_t w = (fastf_t)((i * 83) % n + 0.5) / (fastf_t)n;
+
+	VSET(target,
+	     stp->st_min[X] + u * (stp->st_max[X] - stp->st_min[X]),
+	     stp->st_min[Y] + v * (stp->st_max[Y] - stp->st_min[Y]),
+	     stp->st_min[Z] + w * (stp->st_max[Z] - stp->st_min[Z]));
+	VSET(rp->r_dir, v - 0.5, w - 0.5 + 0.0013, u - 0.5 + 0.0029);
+	VUNITIZE(rp->r_dir);
+	VJOIN1(rp->r_pt, target, -back, rp->r_dir);
+	rp->magic = RT_RAY_MAGIC;
+	rp->index = (int)i;
+	rp->r_min = 0.0;
+	rp->r_max = INFINITY;
+    }
+}
+
+
+/* nanoseconds per ray shooting rays at stp, and which of them hit */
+static double
+tess_prep_cost(struct soltab *stp, struct xray *rays, size_t n, struct application *ap, char *hit)
+{
+    int64_t start, elapsed;
+    size_t pass = 0;
+    size_t i;
+
+    start = bu_gettime();
+    do {
+	for (i = 0; i < n; i++) {
+	    struct seg seghead;
+	    struct seg *segp;
+	    struct xray ray = rays[i];
+
+	    BU_LIST_INIT(&(seghead.l));
+	    hit[i] = (stp->st_meth->ft_shot(stp, &ray, ap, &seghead) > 0);
+	    while (BU_LIST_WHILE(segp, seg, &(seghead.l))) {
+		BU_LIST_DEQUEUE(&(segp->l));
+		RT_FREE_SEG(segp, ap->a_resource);
+	    }
+	}
+	pass++;
+	elapsed = bu_gettime() - start;
+    } while (elapsed < TESS_PREP_MIN_USEC && pass < TESS_PREP_MAX_PASSES);
+
+    return 1000.0 * (double)elapsed / (double)(pass * n);
+}
+
+
+/* Tessellate the primitive to rti_ttol and prep the triangles as a
+ * BoT into bot_stp.  Returns 0 on success.
+ */
+static int
+tess_prep_bot(struct soltab *bot_stp, struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip)
+{
+    struct rt_db_internal intern;
+    struct rt_bot_internal *bot;
+    struct model *m;
+    struct nmgregion *r = NULL;
+    int ret;
+
+    m = nmg_mm();
+    if (stp->st_meth->ft_tessellate(&r, m, ip, &rtip->rti_ttol, &rtip->rti_tol) < 0) {
+	bu_log("%s: tessellation for tess_prep failed, shooting it analytically\n", stp->st_name);
+	nmg_km(m);
+	return -1;
+    }
+    bot = nmg_mdl_to_bot(m, &rt_vlfree, &rtip->rti_tol);
+    nmg_km(m);
+    if (!bot) {
+	bu_log("%s: tessellation for tess_prep did not make a BoT, shooting it analytically\n", stp->st_name);
+	return -1;
+    }
+
+    intern.idb_magic = RT_DB_INTERNAL_MAGIC;
+    intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+    intern.idb_minor_type = ID_BOT;
+    intern.idb_meth = &OBJ[ID_BOT];
+    intern.idb_ptr = (void *)bot;
+    bu_avs_init(&intern.idb_avs, 0, "tess_prep BoT");
+
+    bot_stp->l.magic = RT_SOLTAB_MAGIC;
+    bot_stp->st_rtip = rtip;
+    bot_stp->st_dp = stp->st_dp;
+    bot_stp->st_matp = stp->st_matp;
+    bot_stp->st_id = ID_BOT;
+    bot_stp->st_meth = &OBJ[ID_BOT];
+    VSETALL(bot_stp->st_max, -INFINITY);
+    VSETALL(bot_stp->st_min,  INFINITY);
+
+    ret = rt_obj_prep(bot_stp, &intern, rtip);
+    rt_obj_ifree(&intern);
+    bu_avs_free(&intern.idb_avs);
+    return ret;
+}
+
+
+static void
+tess_prep_free_bot(struct soltab *bot_stp)
+{
+    if (bot_stp->st_meth && bot_stp->st_meth->ft_free)
+	bot_stp->st_meth->ft_free(bot_stp);
+    if (bot_stp->st_piece_rpps)
+	bu_free(bot_stp->st_piece_rpps, "st_piece_rpps[]");
+}
+
+
+int
+rt_tess_prep(struct soltab *stp, struct rt_db_internal *ip, struct rt_i *rtip, int measure)
+{
+    struct soltab bot_stp = RT_SOLTAB_INIT_ZERO;
+    struct application ap;
+    struct resource res = RT_RESOURCE_INIT_ZERO;
+    struct xray rays[TESS_PREP_RAYS];
+    char hit[TESS_PREP_RAYS], bot_hit[TESS_PREP_RAYS];
+    double cost = 0.0, bot_cost = 0.0;
+    int want;
+    int swap = 1;
+    size_t i, differ = 0;
+
+    RT_CK_SOLTAB(stp);
+    RT_CK_DB_INTERNAL(ip);
+    RT_CK_RTI(rtip);
+
+    /* primitives that prepped into something else are left alone */
+    if (stp->st_id != ip->idb_minor_type || stp->st_id == ID_BOT)
+	return 0;
+    if (!stp->st_meth->ft_tessellate || !stp->st_meth->ft_shot)
+	return 0;
+    if (!(stp->st_aradius > 0) || stp->st_aradius >= INFINITY)
+	return 0;
+
+    want = tess_prep_wanted(stp, ip, rtip);
+    if (want == TESS_MEASURE && !measure)
+	want = TESS_NEVER;
+    if (want == TESS_NEVER)
+	return 0;
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_purpose = "tess_prep";
+
+    if (want == TESS_MEASURE) {
+	tess_prep_rays(stp, rays, TESS_PREP_RAYS);
+	cost = tess_prep_cost(stp, rays, TESS_PREP_RAYS, &ap, hit);
+	if (cost < rtip->rti_tess_prep_ns)
+	    swap = 0;
+    }
+
+    /* as with any solid, a failed prep is not freed */
+    if (swap && tess_prep_bot(&bot_stp, stp, ip, rtip) != 0)
+	swap = 0;
+
+    if (swap && want == TESS_MEASURE) {
+	bot_cost = tess_prep_cost(&bot_stp, rays, TESS_PREP_RAYS, &ap, bot_hit);
+	for (i = 0; i < TESS_PREP_RAYS; i++) {
+	    if (hit[i] != bot_hit[i])
+		differ++;
+	}
+	/* a grazing ray or two may go either way; more than that and
+	 * the tessellation is not the same shape */
+	if (bot_cost * TESS_PREP_GAIN >= cost || differ > TESS_PREP_RAYS / 16) {
+	    tess_prep_free_bot(&bot_stp);
+	    swap = 0;
+	}
+    }
+
+    if (res.re_seg_slab)
+	bu_slab_destroy(res.re_seg_slab);
+    if (res.re_part_slab)
+	bu_slab_destroy(res.re_part_slab);
+
+    if (RT_G_DEBUG&RT_DEBUG_SOLIDS) {
+	if (want == TESS_MEASURE && bot_cost > 0.0)
+	    bu_log("%s: %s %.0f ns/ray, BoT %.0f ns/ray, %zu rays differ: %s\n",
+		   stp->st_name, stp->st_meth->ft_label, cost, bot_cost, differ,
+		   swap ? "shooting the BoT" : "shooting it analytically");
+	else if (want == TESS_MEASURE)
+	    bu_log("%s: %s %.0f ns/ray: shooting it analytically\n",
+		   stp->st_name, stp->st_meth->ft_label, cost);
+	else
+	    bu_log("%s: %s\n", stp->st_name, swap ? "shooting the BoT" : "shooting it analytically");
+    }
+
+    if (!swap)
+	return 0;
+
+    /* free the analytic solid and put the BoT in its place */
+    stp->st_meth->ft_free(stp);
+    if (stp->st_piece_rpps)
+	bu_free(stp->st_piece_rpps, "st_piece_rpps[]");
+    stp->st_id = bot_stp.st_id;
+    stp->st_meth = bot_stp.st_meth;
+    stp->st_specific = bot_stp.st_specific;
+    VMOVE(stp->st_center, bot_stp.st_center);
+    stp->st_aradius = bot_stp.st_aradius;
+    stp->st_bradius = bot_stp.st_bradius;
+    VMOVE(stp->st_min, bot_stp.st_min);
+    VMOVE(stp->st_max, bot_stp.st_max);
+    stp->st_npieces = bot_stp.st_npieces;
+    stp->st_piece_rpps = bot_stp.st_piece_rpps;
+    return 1;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
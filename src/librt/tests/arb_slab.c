@@ -0,0 +1,468 @@
+/*                      A R B _ S L A B . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/arb_slab.c
+ *
+ * Make ARBNs with from 6 to 64 faces and ARB8 frusta, shoot them with
+ * rays from all directions (some parallel to faces) through ft_shot
+ * and through ft_vshot, both in runs against one solid and
+ * interleaved with another, and check every answer, faces included,
+ * against the plain Cyrus & Beck loop over the planes.  Some rays cross
+ * the edges of the boxes exactly, where two faces tie.  The time each
+ * of the three takes is reported.
+ *
+ * Usage: rt_arb_slab [-r rays_per_solid]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define AS_TOL 1.0e-6
+#define AS_NARBN 30
+#define AS_NARB8 24
+#define AS_MAXEQN 64
+
+struct as_solid {
+    char name[32];
+    size_t neqn;
+    plane_t eqn[AS_MAXEQN];	/* unit outward normals */
+    fastf_t slant_tol;		/* what the primitive takes as parallel */
+    point_t min, max;
+    int box;			/* eqn[0..5] bound the box lo, hi exactly */
+    point_t lo, hi;
+};
+
+struct as_hit {
+    int hit;
+    fastf_t in, out;
+    int iplane, oplane;
+};
+
+
+static double
+as_rand(unsigned long *seed)
+{
+    *seed = *seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (double)(*seed >> 11) / 9007199254740992.0;
+}
+
+
+/* The scalar loop rt_arbn_shot() and rt_arb_shot() used to run */
+static void
+as_reference(const struct as_solid *sp, const struct xray *rp, struct as_hit *h)
+{
+    fastf_t in = -INFINITY, out = INFINITY;
+    int iplane = -1, oplane = -1;
+    int i;
+
+    h->hit = 0;
+    for (i = (int)sp->neqn - 1; i >= 0; i--) {
+	fastf_t norm_dist = VDOT(sp->eqn[i], rp->r_pt) - sp->eqn[i][W];
+	fastf_t slant = -VDOT(sp->eqn[i], rp->r_dir);
+	fastf_t s;
+
+	if (slant < -sp->slant_tol) {
+	    if (out > (s = norm_dist / slant)) {
+		out = s;
+		oplane = i;
+	    }
+	} else if (slant > sp->slant_tol) {
+	    if (in < (s = norm_dist / slant)) {
+		in = s;
+		iplane = i;
+	    }
+	} else if (norm_dist > SQRT_SMALL_FASTF) {
+	    return;
+	}
+	if (in > out)
+	    return;
+    }
+    if (iplane == -1 || oplane == -1 || in >= out || out >= INFINITY)
+	return;
+    h->hit = 1;
+    h->in = in;
+    h->out = out;
+    h->iplane = iplane;
+    h->oplane = oplane;
+}
+
+
+static void
+as_check(const struct as_solid *sp, const char *how, size_t r, const struct as_hit *ref, const struct seg *segp)
+{
+    if (!ref->hit && !segp)
+	return;
+    if (ref->hit && segp
+	&& NEAR_EQUAL(ref->in, segp->seg_in.hit_dist, AS_TOL)
+	&& NEAR_EQUAL(ref->out, segp->seg_out.hit_dist, AS_TOL)
+	&& ref->iplane == segp->seg_in.hit_surfno
+	&& ref->oplane == segp->seg_out.hit_surfno)
+	return;
+    bu_exit(1, "%s ray %zu: %s gives %s %g,%g on faces %d,%d but the planes give %s %g,%g on faces %d,%d [FAIL]\n",
+	    sp->name, r, how, segp ? "hit" : "miss", segp ? segp->seg_in.hit_dist : 0.0, segp ? segp->seg_out.hit_dist : 0.0,
+	    segp ? segp->seg_in.hit_surfno : -1, segp ? segp->seg_out.hit_surfno : -1,
+	    ref->hit ? "hit" : "miss", ref->in, ref->out, ref->iplane, ref->oplane);
+}
+
+
+/* ARBN with n planes tangent to a sphere, their normals spread over
+ * it, or a box on the axes with whole numbers for its planes */
+static void
+as_make_arbn(struct rt_wdb *wdbp, struct as_solid *sp, size_t n, int axis_aligned, unsigned long *seed)
+{
+    point_t c;
+    fastf_t R = 20.0 + 80.0 * as_rand(seed);
+    size_t i;
+
+    VSET(c, 400.0 * as_rand(seed) - 200.0, 400.0 * as_rand(seed) - 200.0, 400.0 * as_rand(seed) - 200.0);
+    sp->neqn = n;
+    sp->slant_tol = 1.0e-10;
+    for (i = 0; i < n; i++) {
+	fastf_t z = 1.0 - (2.0 * i + 1.0) / (fastf_t)n;
+	fastf_t a = 2.399963229728653 * i + 0.3 * as_rand(seed);
+	fastf_t r = sqrt(1.0 - z * z);
+
+	VSET(sp->eqn[i], r * cos(a), r * sin(a), z);
+	VUNITIZE(sp->eqn[i]);
+	sp->eqn[i][W] = VDOT(sp->eqn[i], c) + R;
+    }
+    if (axis_aligned) {
+	VSET(c, floor(c[X]), floor(c[Y]), floor(c[Z]));
+	R = floor(R);
+	for (i = 0; i < 6; i++) {
+	    HSETALL(sp->eqn[i], 0.0);
+	    sp->eqn[i][i / 2] = (i & 1) ? -1.0 : 1.0;
+	    sp->eqn[i][W] = ((i & 1) ? -c[i / 2] : c[i / 2]) + R;
+	}
+	sp->box = 1;
+	VSETALL(sp->lo, -R);
+	VSETALL(sp->hi, R);
+	VADD2(sp->lo, sp->lo, c);
+	VADD2(sp->hi, sp->hi, c);
+    }
+    VSETALL(sp->min, -R * 1.8);
+    VSETALL(sp->max, R * 1.8);
+    VADD2(sp->min, sp->min, c);
+    VADD2(sp->max, sp->max, c);
+
+    if (mk_arbn(wdbp, sp->name, sp->neqn, (const plane_t *)sp->eqn))
+	bu_exit(1, "mk_arbn(%s) failed [FAIL]\n", sp->name);
+}
+
+
+/* ARB8 frustum of a random parallelepiped, with its planes worked out
+ * here independently of arb8.c, in the order arb8.c numbers its faces */
+static void
+as_make_arb8(struct rt_wdb *wdbp, struct as_solid *sp, int axis_aligned, unsigned long *seed)
+{
+    static const int faces[6][4] = {
+	{0, 1, 2, 3}, {4, 5, 6, 7}, {3, 0, 4, 7}, {1, 2, 6, 5}, {0, 1, 5, 4}, {2, 3, 7, 6}
+    };
+    fastf_t pts[24];
+    point_t c, ctr;
+    vect_t u, v, w;
+    fastf_t s = 0.3 + 0.7 * as_rand(seed);
+    size_t i, j;
+
+    VSET(c, 400.0 * as_rand(seed) - 200.0, 400.0 * as_rand(seed) - 200.0, 400.0 * as_rand(seed) - 200.0);
+    if (axis_aligned) {
+	VSET(u, 60.0, 0.0, 0.0);
+	VSET(v, 0.0, 40.0, 0.0);
+	VSET(w, 0.0, 0.0, 50.0);
+	s = 1.0;
+    } else {
+	for (i = 0; i < 3; i++) {
+	    u[i] = 100.0 * as_rand(seed) - 50.0;
+	    v[i] = 100.0 * as_rand(seed) - 50.0;
+	}
+	VCROSS(w, u, v);
+	VUNITIZE(w);
+	VSCALE(w, w, 20.0 + 60.0 * as_rand(seed));
+	w[X] += 10.0 * as_rand(seed);
+    }
+    for (i = 0; i < 4; i++) {
+	fastf_t a = (i == 1 || i == 2) ? 1.0 : -1.0;
+	fastf_t b = (i >= 2) ? 1.0 : -1.0;
+
+	VJOIN2(&pts[3 * i], c, a, u, b, v);
+	VJOIN2(&pts[3 * (i + 4)], c, a * s, u, b * s, v);
+	VADD2(&pts[3 * (i + 4)], &pts[3 * (i + 4)], w);
+    }
+
+    VSETALL(ctr, 0.0);
+    for (i = 0; i < 8; i++) {
+	VADD2(ctr, ctr, &pts[3 * i]);
+	VMINMAX(sp->min, sp->max, &pts[3 * i]);
+    }
+    VSCALE(ctr, ctr, 0.125);
+    sp->neqn = 6;
+    sp->slant_tol = SQRT_SMALL_FASTF;
+    for (i = 0; i < 6; i++) {
+	vect_t d1, d2;
+	fastf_t *p0 = &pts[3 * faces[i][0]];
+
+	VSUB2(d1, &pts[3 * faces[i][2]], p0);
+	VSUB2(d2, &pts[3 * faces[i][3]], &pts[3 * faces[i][1]]);
+	VCROSS(sp->eqn[i], d1, d2);
+	VUNITIZE(sp->eqn[i]);
+	sp->eqn[i][W] = VDOT(sp->eqn[i], p0);
+	if (VDOT(sp->eqn[i], ctr) > sp->eqn[i][W]) {
+	    HREVERSE(sp->eqn[i], sp->eqn[i]);
+	}
+    }
+    for (j = 0; j < 3; j++) {
+	fastf_t pad = 0.3 * (sp->max[j] - sp->min[j]);
+	sp->min[j] -= pad;
+	sp->max[j] += pad;
+    }
+
+    if (mk_arb8(wdbp, sp->name, pts))
+	bu_exit(1, "mk_arb8(%s) failed [FAIL]\n", sp->name);
+}
+
+
+static void
+as_make_rays(const struct as_solid *sp, struct xray *rays, size_t nrays, unsigned long *seed)
+{
+    size_t i;
+
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+	vect_t span;
+
+	VSUB2(span, sp->max, sp->min);
+	VSET(target,
+	     sp->min[X] + as_rand(seed) * span[X],
+	     sp->min[Y] + as_rand(seed) * span[Y],
+	     sp->min[Z] + as_rand(seed) * span[Z]);
+	if (i % 4 == 3) {
+	    /* down an axis, parallel to four faces of the boxes */
+	    VSETALL(rays[i].r_dir, 0.0);
+	    rays[i].r_dir[i % 3] = (i & 4) ? 1.0 : -1.0;
+	} else if (i % 8 == 5 && sp->box) {
+	    /* through an edge of the box on the diagonal between two
+	     * axes, where their faces tie going in and coming out */
+	    int a = (int)(i / 8) % 3;
+	    int b = (a + 1) % 3;
+	    fastf_t sa = (i & 8) ? 1.0 : -1.0;
+	    fastf_t sb = (i & 16) ? 1.0 : -1.0;
+
+	    VSETALL(rays[i].r_dir, 0.0);
+	    rays[i].r_dir[a] = sa;
+	    rays[i].r_dir[b] = sb;
+	    VUNITIZE(rays[i].r_dir);
+	    target[a] = (sa > 0.0) ? sp->lo[a] - 50.0 : sp->hi[a] + 50.0;
+	    target[b] = (sb > 0.0) ? sp->lo[b] - 50.0 : sp->hi[b] + 50.0;
+	    VMOVE(rays[i].r_pt, target);
+	    rays[i].magic = RT_RAY_MAGIC;
+	    rays[i].index = (int)i;
+	    continue;
+	} else {
+	    VSET(rays[i].r_dir, as_rand(seed) - 0.5, as_rand(seed) - 0.5, as_rand(seed) - 0.5);
+	    VUNITIZE(rays[i].r_dir);
+	}
+	VJOIN1(rays[i].r_pt, target, -2.0 * MAGNITUDE(span), rays[i].r_dir);
+	rays[i].magic = RT_RAY_MAGIC;
+	rays[i].index = (int)i;
+    }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-r rays_per_solid]\n";
+    static const size_t neqns[] = {6, 8, 12, 20, 32, 64};
+    struct as_solid *solids;
+    struct soltab **stps, **vstp;
+    struct xray *rays, **vrp;
+    struct as_hit *ref;
+    struct seg *vsegs;
+    struct application ap;
+    struct resource resource;
+    struct resource *res = &resource;
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct rt_i *rtip;
+    struct soltab *stp;
+    const char **names;
+    unsigned long seed = 4242;
+    size_t nsolids = AS_NARBN + AS_NARB8;
+    size_t nrays = 2000;
+    size_t i, r, hits = 0;
+    int64_t t_ref = 0, t_shot = 0, t_vshot = 0, start;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "r:")) != -1) {
+	switch (c) {
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (nrays < 2)
+	nrays = 2;
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+
+    solids = (struct as_solid *)bu_calloc(nsolids, sizeof(struct as_solid), "arb_slab solids");
+    names = (const char **)bu_calloc(nsolids, sizeof(char *), "arb_slab names");
+    for (i = 0; i < nsolids; i++) {
+	if (i < AS_NARBN) {
+	    snprintf(solids[i].name, sizeof(solids[i].name), "arbn.%zu", i);
+	    as_make_arbn(wdbp, &solids[i], neqns[i % (sizeof(neqns) / sizeof(neqns[0]))], i == 0, &seed);
+	} else {
+	    VSETALL(solids[i].min, INFINITY);
+	    VSETALL(solids[i].max, -INFINITY);
+	    snprintf(solids[i].name, sizeof(solids[i].name), "arb8.%zu", i);
+	    as_make_arb8(wdbp, &solids[i], i == AS_NARBN, &seed);
+	}
+	names[i] = solids[i].name;
+    }
+
+    rtip = rt_i_create(dbip);
+    if (rt_gettrees(rtip, (int)nsolids, names, 1) < 0)
+	bu_exit(1, "rt_gettrees failed [FAIL]\n");
+    rt_prep(rtip);
+    memset(res, 0, sizeof(struct resource));
+    rt_init_resource(res, 0, rtip);
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = res;
+
+    /* find each solid's soltab */
+    stps = (struct soltab **)bu_calloc(nsolids, sizeof(struct soltab *), "arb_slab soltabs");
+    RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
+	for (i = 0; i < nsolids; i++) {
+	    if (BU_STR_EQUAL(stp->st_name, solids[i].name))
+		stps[i] = stp;
+	}
+    } RT_VISIT_ALL_SOLTABS_END;
+
+    rays = (struct xray *)bu_calloc(nrays, sizeof(struct xray), "arb_slab rays");
+    ref = (struct as_hit *)bu_calloc(nrays, sizeof(struct as_hit), "arb_slab reference");
+    vsegs = (struct seg *)bu_calloc(nrays, sizeof(struct seg), "arb_slab segs");
+    vstp = (struct soltab **)bu_calloc(nrays, sizeof(struct soltab *), "arb_slab vshot soltabs");
+    vrp = (struct xray **)bu_calloc(nrays, sizeof(struct xray *), "arb_slab vshot rays");
+
+    for (i = 0; i < nsolids; i++) {
+	struct as_solid *sp = &solids[i];
+	size_t o = (i + 1) % nsolids;
+
+	if (!stps[i] || (stps[i]->st_id != ID_ARBN && stps[i]->st_id != ID_ARB8))
+	    bu_exit(1, "%s was not prepped as itself [FAIL]\n", sp->name);
+
+	as_make_rays(sp, rays, nrays, &seed);
+
+	start = bu_gettime();
+	for (r = 0; r < nrays; r++)
+	    as_reference(sp, &rays[r], &ref[r]);
+	t_ref += bu_gettime() - start;
+
+	for (r = 0; r < nrays; r++)
+	    hits += ref[r].hit;
+
+	/* one ray at a time */
+	start = bu_gettime();
+	for (r = 0; r < nrays; r++) {
+	    struct seg seghead;
+
+	    BU_LIST_INIT(&seghead.l);
+	    ap.a_ray = rays[r];
+	    if (stps[i]->st_meth->ft_shot(stps[i], &rays[r], &ap, &seghead)) {
+		as_check(sp, "ft_shot", r, &ref[r], BU_LIST_FIRST(seg, &seghead.l));
+		RT_FREE_SEG_LIST(&seghead, res);
+	    } else {
+		as_check(sp, "ft_shot", r, &ref[r], NULL);
+	    }
+	}
+	t_shot += bu_gettime() - start;
+
+	/* all the rays against this solid */
+	for (r = 0; r < nrays; r++) {
+	    vstp[r] = stps[i];
+	    vrp[r] = &rays[r];
+	}
+	start = bu_gettime();
+	stps[i]->st_meth->ft_vshot(vstp, vrp, vsegs, (int)nrays, &ap);
+	t_vshot += bu_gettime() - start;
+	for (r = 0; r < nrays; r++)
+	    as_check(sp, "ft_vshot", r, &ref[r], vsegs[r].seg_stp ? &vsegs[r] : NULL);
+
+	/* every other ray against another solid of the same type, and
+	 * one skipped */
+	if (stps[o]->st_id != stps[i]->st_id)
+	    continue;
+	for (r = 0; r < nrays; r++)
+	    vstp[r] = (r % 2) ? stps[o] : stps[i];
+	vstp[2] = NULL;
+	vsegs[2].seg_stp = stps[i];
+	stps[i]->st_meth->ft_vshot(vstp, vrp, vsegs, (int)nrays, &ap);
+	if (vsegs[2].seg_stp != stps[i])
+	    bu_exit(1, "%s: ft_vshot wrote the seg of a skipped ray [FAIL]\n", sp->name);
+	for (r = 0; r < nrays; r += 2) {
+	    if (r != 2)
+		as_check(sp, "interleaved ft_vshot", r, &ref[r], vsegs[r].seg_stp ? &vsegs[r] : NULL);
+	}
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit anything [FAIL]\n");
+
+    bu_free(solids, "arb_slab solids");
+    bu_free((void *)names, "arb_slab names");
+    bu_free(stps, "arb_slab soltabs");
+    bu_free(rays, "arb_slab rays");
+    bu_free(ref, "arb_slab reference");
+    bu_free(vsegs, "arb_slab segs");
+    bu_free(vstp, "arb_slab vshot soltabs");
+    bu_free(vrp, "arb_slab vshot rays");
+    rt_clean_resource_basic(rtip, res);
+    rt_i_destroy(rtip);
+    db_close(dbip);
+
+    bu_log("%zu solids, %zu of %zu rays hit: planes %.4f sec, ft_shot %.4f sec, ft_vshot %.4f sec [PASS]\n",
+	   nsolids, hits, nsolids * nrays, (double)t_ref / 1.0e6, (double)t_shot / 1.0e6, (double)t_vshot / 1.0e6);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,252 @@
+/*                      B O T _ N U M A . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/bot_numa.c
+ *
+ * Prep the same BoT twice, once with rti_numa_replicate set, and
+ * check that a grid of rays shot from a thread on every NUMA node
+ * gets the same hits from both.  bu_numa_set_nodes() pretends there
+ * are two nodes, so the per-node copies are made and read even on a machine
+ * with one.
+ *
+ * Usage: rt_bot_numa [-n sphere_segments]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/getopt.h"
+#include "bu/parallel.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define GRID 32
+#define NUMA_NODES 8	/* most nodes checked */
+
+struct numa_shots {
+    struct rt_i *rtip;
+    struct resource res[NUMA_NODES];
+    fastf_t in[NUMA_NODES][GRID * GRID];
+    fastf_t out[NUMA_NODES][GRID * GRID];
+};
+
+
+static int
+numa_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct partition *pp = part_head->pt_forw;
+    fastf_t *d = (fastf_t *)ap->a_uptr;
+
+    d[0] = pp->pt_inhit->hit_dist;
+    d[1] = part_head->pt_back->pt_outhit->hit_dist;
+    return 1;
+}
+
+
+static int
+numa_miss(struct application *ap)
+{
+    fastf_t *d = (fastf_t *)ap->a_uptr;
+
+    d[0] = d[1] = -1.0;
+    return 0;
+}
+
+
+/* Shoot the grid down -Z from a thread bound to node */
+static void
+numa_shoot(int node, void *data)
+{
+    struct numa_shots *s = (struct numa_shots *)data;
+    struct application ap;
+    int x, y;
+
+    if (node < 0 || node >= NUMA_NODES)
+	return;
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = s->rtip;
+    ap.a_resource = &s->res[node];
+    ap.a_hit = numa_hit;
+    ap.a_miss = numa_miss;
+    ap.a_onehit = 0;
+
+    for (y = 0; y < GRID; y++) {
+	for (x = 0; x < GRID; x++) {
+	    fastf_t d[2];
+	    VSET(ap.a_ray.r_pt, -1.2 + 2.4 * (x + 0.5) / GRID, -1.2 + 2.4 * (y + 0.5) / GRID, 10.0);
+	    VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+	    ap.a_uptr = (void *)d;
+	    (void)rt_shootray(&ap);
+	    s->in[node][y * GRID + x] = d[0];
+	    s->out[node][y * GRID + x] = d[1];
+	}
+    }
+}
+
+
+static struct numa_shots *
+numa_prep_and_shoot(struct db_i *dbip, int replicate)
+{
+    struct numa_shots *s;
+    size_t i;
+
+    BU_ALLOC(s, struct numa_shots);
+    s->rtip = rt_i_create(dbip);
+    s->rtip->rti_numa_replicate = replicate;
+    if (rt_gettree(s->rtip, "bot.r") < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(s->rtip);
+    for (i = 0; i < bu_numa_nodes() && i < NUMA_NODES; i++)
+	rt_init_resource(&s->res[i], (int)i, s->rtip);
+
+    bu_numa_run(numa_shoot, s);
+    return s;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n sphere_segments]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct wmember wm;
+    struct numa_shots *plain, *repl;
+    fastf_t *verts;
+    int *faces;
+    size_t nseg = 64;
+    size_t nverts, nfaces, i, j, f, node, hits = 0;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		nseg = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (nseg < 8)
+	nseg = 8;
+
+    /* must be set before libbu reads the topology */
+    if (bu_numa_set_nodes(2) < 0)
+	bu_exit(1, "bu_numa_set_nodes refused before first use [FAIL]\n");
+
+    /* a unit latitude/longitude sphere: two poles and nseg-1 rings */
+    nverts = 2 + (nseg - 1) * nseg;
+    nfaces = 2 * nseg * (nseg - 1);
+    verts = (fastf_t *)bu_calloc(nverts * 3, sizeof(fastf_t), "verts");
+    faces = (int *)bu_calloc(nfaces * 3, sizeof(int), "faces");
+    VSET(&verts[0], 0.0, 0.0, 1.0);
+    VSET(&verts[3], 0.0, 0.0, -1.0);
+    for (i = 1; i < nseg; i++) {
+	fastf_t phi = M_PI * (fastf_t)i / (fastf_t)nseg;
+	for (j = 0; j < nseg; j++) {
+	    fastf_t theta = 2.0 * M_PI * (fastf_t)j / (fastf_t)nseg;
+	    size_t v = 2 + (i - 1) * nseg + j;
+	    VSET(&verts[v*3], sin(phi) * cos(theta), sin(phi) * sin(theta), cos(phi));
+	}
+    }
+    f = 0;
+    for (j = 0; j < nseg; j++) {
+	size_t jn = (j + 1) % nseg;
+	/* caps */
+	faces[f*3+0] = 0;
+	faces[f*3+1] = (int)(2 + j);
+	faces[f*3+2] = (int)(2 + jn);
+	f++;
+	faces[f*3+0] = 1;
+	faces[f*3+1] = (int)(2 + (nseg - 2) * nseg + jn);
+	faces[f*3+2] = (int)(2 + (nseg - 2) * nseg + j);
+	f++;
+	/* bands */
+	for (i = 1; i + 1 < nseg; i++) {
+	    int a = (int)(2 + (i - 1) * nseg + j);
+	    int b = (int)(2 + (i - 1) * nseg + jn);
+	    int d = (int)(2 + i * nseg + j);
+	    int e = (int)(2 + i * nseg + jn);
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = d;
+	    faces[f*3+2] = e;
+	    f++;
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = e;
+	    faces[f*3+2] = b;
+	    f++;
+	}
+    }
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+    if (mk_bot(wdbp, "bot.s", RT_BOT_SOLID, RT_BOT_UNORIENTED, 0, nverts, f, verts, faces, NULL, NULL))
+	bu_exit(1, "mk_bot failed [FAIL]\n");
+    BU_LIST_INIT(&wm.l);
+    (void)mk_addmember("bot.s", &wm.l, NULL, WMOP_UNION);
+    if (mk_lcomb(wdbp, "bot.r", &wm, 1, NULL, NULL, NULL, 0))
+	bu_exit(1, "mk_lcomb failed [FAIL]\n");
+    bu_free(verts, "verts");
+    bu_free(faces, "faces");
+
+    plain = numa_prep_and_shoot(dbip, 0);
+    repl = numa_prep_and_shoot(dbip, 1);
+
+    for (node = 0; node < bu_numa_nodes() && node < NUMA_NODES; node++) {
+	for (i = 0; i < GRID * GRID; i++) {
+	    if (!EQUAL(plain->in[node][i], repl->in[node][i]) || !EQUAL(plain->out[node][i], repl->out[node][i]))
+		bu_exit(1, "node %zu ray %zu: %g,%g unreplicated but %g,%g replicated [FAIL]\n", node, i,
+			plain->in[node][i], plain->out[node][i], repl->in[node][i], repl->out[node][i]);
+	    if (!EQUAL(repl->in[node][i], repl->in[0][i]))
+		bu_exit(1, "node %zu ray %zu: differs from node 0 [FAIL]\n", node, i);
+	    if (repl->in[node][i] >= 0.0)
+		hits++;
+	}
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit the BoT [FAIL]\n");
+
+    rt_i_destroy(plain->rtip);
+    rt_i_destroy(repl->rtip);
+    bu_free(plain, "numa shots");
+    bu_free(repl, "numa shots");
+    db_close(dbip);
+
+    bu_log("%zu hits on %zu NUMA node(s), replicated BoT matches [PASS]\n", hits, bu_numa_nodes());
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
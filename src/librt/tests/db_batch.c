@@ -0,0 +1,186 @@
+/*                      D B _ B A T C H . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/db_batch.c
+ *
+ * Write the same set of objects into two databases, one object at a
+ * time and inside a db_batch_begin()/db_batch_commit() pair, and
+ * check that both hold identical objects.  Some objects are read
+ * back and rewritten larger while the batch is open, the way
+ * converters add attributes after the fact.
+ *
+ * Usage: rt_db_batch [-n objects]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/file.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+/* Write count spheres, tagging every tenth one with an attribute,
+ * returning the elapsed seconds or a negative value on failure. */
+static double
+db_batch_write(const char *gfile, size_t count, int batch)
+{
+    struct rt_wdb *wdbp;
+    int64_t start = bu_gettime();
+    size_t i;
+
+    wdbp = wdb_fopen(gfile);
+    if (!wdbp)
+	return -1.0;
+    if (batch && db_batch_begin(wdbp->dbip) < 0) {
+	wdb_close(wdbp);
+	return -1.0;
+    }
+
+    for (i = 0; i < count; i++) {
+	char name[64];
+	point_t center;
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	VSET(center, (fastf_t)i, (fastf_t)(i % 7), (fastf_t)(i % 13));
+	if (mk_sph(wdbp, name, center, 0.5 + (fastf_t)(i % 5)))
+	    break;
+	if (i % 10 == 0 && db5_update_attribute(name, "importer", "rt_db_batch", wdbp->dbip))
+	    break;
+    }
+
+    if (batch && db_batch_commit(wdbp->dbip) < 0)
+	i = 0;
+    wdb_close(wdbp);
+
+    if (i != count)
+	return -1.0;
+    return (double)(bu_gettime() - start) / 1.0e6;
+}
+
+
+static int
+db_batch_compare(const char *gfile1, const char *gfile2, size_t count)
+{
+    struct db_i *dbip1 = db_open(gfile1, DB_OPEN_READONLY);
+    struct db_i *dbip2 = db_open(gfile2, DB_OPEN_READONLY);
+    int failed = 0;
+    size_t i;
+
+    if (dbip1 == DBI_NULL || dbip2 == DBI_NULL || db_dirbuild(dbip1) < 0 || db_dirbuild(dbip2) < 0)
+	bu_exit(EXIT_FAILURE, "Unable to open the written databases\n");
+
+    for (i = 0; i < count && !failed; i++) {
+	char name[64];
+	struct directory *dp1, *dp2;
+	struct bu_external ext1, ext2;
+
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	dp1 = db_lookup(dbip1, name, LOOKUP_QUIET);
+	dp2 = db_lookup(dbip2, name, LOOKUP_QUIET);
+	if (dp1 == RT_DIR_NULL || dp2 == RT_DIR_NULL
+	    || db_get_external(&ext1, dp1, dbip1) < 0 || db_get_external(&ext2, dp2, dbip2) < 0) {
+	    bu_log("%s: missing from one of the databases\n", name);
+	    failed = 1;
+	    break;
+	}
+	if (ext1.ext_nbytes != ext2.ext_nbytes || memcmp(ext1.ext_buf, ext2.ext_buf, ext1.ext_nbytes) != 0) {
+	    bu_log("%s: batched object differs\n", name);
+	    failed = 1;
+	}
+	bu_free_external(&ext1);
+	bu_free_external(&ext2);
+    }
+
+    db_close(dbip1);
+    db_close(dbip2);
+    return failed;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n objects]\n";
+    char gfile1[MAXPATHLEN] = {0};
+    char gfile2[MAXPATHLEN] = {0};
+    size_t count = 10000;
+    double t_direct, t_batch;
+    int failed;
+    int c;
+    FILE *fp;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		count = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(EXIT_FAILURE, USAGE, argv[0]);
+	}
+    }
+
+    fp = bu_temp_file(gfile1, sizeof(gfile1));
+    if (!fp)
+	bu_exit(EXIT_FAILURE, "Unable to create temporary database\n");
+    fclose(fp);
+    bu_file_delete(gfile1);
+    fp = bu_temp_file(gfile2, sizeof(gfile2));
+    if (!fp)
+	bu_exit(EXIT_FAILURE, "Unable to create temporary database\n");
+    fclose(fp);
+    bu_file_delete(gfile2);
+
+    t_direct = db_batch_write(gfile1, count, 0);
+    t_batch = db_batch_write(gfile2, count, 1);
+    if (t_direct < 0.0 || t_batch < 0.0) {
+	bu_file_delete(gfile1);
+	bu_file_delete(gfile2);
+	bu_exit(EXIT_FAILURE, "Unable to write %zu objects\n", count);
+    }
+    bu_log("%zu objects: direct %.4f sec, batched %.4f sec\n", count, t_direct, t_batch);
+
+    failed = db_batch_compare(gfile1, gfile2, count);
+
+    bu_file_delete(gfile1);
+    bu_file_delete(gfile2);
+
+    if (failed)
+	return EXIT_FAILURE;
+
+    bu_log("All unit tests succeeded.\n");
+    return EXIT_SUCCESS;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
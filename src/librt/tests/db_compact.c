@@ -0,0 +1,243 @@
+/*                    D B _ C O M P A C T . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/db_compact.c
+ *
+ * Fragment a database by deleting some objects and growing others,
+ * refill part of the holes, then compact it in place with
+ * db_compact() and check that every object survived unchanged, both
+ * through the open directory and after reopening the file, and that
+ * no free space is left in it.
+ *
+ * Usage: rt_db_compact [-n objects]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/file.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+/* Compare every object left in dbip against its reference copy, and
+ * check the objects fill the file from the header to the end. */
+static int
+db_compact_check(struct db_i *dbip, const char *gfile, struct bu_external *ref, size_t count)
+{
+    size_t used = 8;	/* v5 header object */
+    size_t found = 0;
+    struct directory *dp;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+	char name[64];
+	struct bu_external ext;
+
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	if (!ref[i].ext_buf) {
+	    if (dp != RT_DIR_NULL) {
+		bu_log("%s: deleted object came back\n", name);
+		return 1;
+	    }
+	    continue;
+	}
+	if (dp == RT_DIR_NULL || db_get_external(&ext, dp, dbip) < 0) {
+	    bu_log("%s: missing after compaction\n", name);
+	    return 1;
+	}
+	if (ext.ext_nbytes != ref[i].ext_nbytes || memcmp(ext.ext_buf, ref[i].ext_buf, ext.ext_nbytes) != 0) {
+	    bu_log("%s: changed by compaction\n", name);
+	    bu_free_external(&ext);
+	    return 1;
+	}
+	bu_free_external(&ext);
+	found++;
+    }
+
+    FOR_ALL_DIRECTORY_START(dp, dbip) {
+	used += dp->d_len;
+    } FOR_ALL_DIRECTORY_END;
+    if ((int)used != bu_file_size(gfile)) {
+	bu_log("%s: %d bytes, objects only account for %zu\n", gfile, bu_file_size(gfile), used);
+	return 1;
+    }
+
+    bu_log("%zu objects, %zu bytes [PASS]\n", found, used);
+    return 0;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n objects]\n";
+    char gfile[MAXPATHLEN] = {0};
+    struct bu_external *ref;
+    struct rt_wdb *wdbp;
+    struct db_i *dbip;
+    size_t count = 10000;
+    size_t reclaimed = 0;
+    size_t i;
+    int before;
+    int failed = 0;
+    int64_t start;
+    int c;
+    FILE *fp;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		count = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(EXIT_FAILURE, USAGE, argv[0]);
+	}
+    }
+    if (count < 10)
+	count = 10;
+
+    fp = bu_temp_file(gfile, sizeof(gfile));
+    if (!fp)
+	bu_exit(EXIT_FAILURE, "Unable to create temporary database\n");
+    fclose(fp);
+    bu_file_delete(gfile);
+
+    wdbp = wdb_fopen(gfile);
+    if (!wdbp)
+	bu_exit(EXIT_FAILURE, "Unable to open temporary database\n");
+    for (i = 0; i < count; i++) {
+	char name[64];
+	point_t center;
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	VSET(center, (fastf_t)i, (fastf_t)(i % 7), (fastf_t)(i % 13));
+	if (mk_sph(wdbp, name, center, 0.5 + (fastf_t)(i % 5)))
+	    bu_exit(EXIT_FAILURE, "Unable to write %s\n", name);
+    }
+
+    /* Punch holes: delete every third object, and grow every fifth
+     * one so it moves, leaving its old space behind. */
+    dbip = wdbp->dbip;
+    for (i = 0; i < count; i++) {
+	char name[64];
+	struct directory *dp;
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	if (i % 3 == 0) {
+	    dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	    if (dp == RT_DIR_NULL || db_delete(dbip, dp) < 0 || db_dirdelete(dbip, dp) < 0)
+		bu_exit(EXIT_FAILURE, "Unable to delete %s\n", name);
+	} else if (i % 5 == 0) {
+	    if (db5_update_attribute(name, "comment", "moved to make room for a longer attribute value", dbip))
+		bu_exit(EXIT_FAILURE, "Unable to grow %s\n", name);
+	}
+    }
+
+    /* Reuse some of the holes */
+    for (i = 0; i < count / 10; i++) {
+	char name[64];
+	point_t center;
+	snprintf(name, sizeof(name), "refill%zu.s", i);
+	VSET(center, (fastf_t)i, 0.0, 0.0);
+	if (mk_sph(wdbp, name, center, 1.0))
+	    bu_exit(EXIT_FAILURE, "Unable to write %s\n", name);
+    }
+
+    ref = (struct bu_external *)bu_calloc(count, sizeof(struct bu_external), "db_compact ref");
+    for (i = 0; i < count; i++) {
+	char name[64];
+	struct directory *dp;
+	if (i % 3 == 0)
+	    continue;
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	if (dp == RT_DIR_NULL || db_get_external(&ref[i], dp, dbip) < 0)
+	    bu_exit(EXIT_FAILURE, "Unable to read %s\n", name);
+    }
+
+    fflush(NULL);
+    before = bu_file_size(gfile);
+    start = bu_gettime();
+    if (db_compact(dbip, &reclaimed) < 0) {
+	bu_log("db_compact() failed [FAIL]\n");
+	failed = 1;
+    }
+    bu_log("compacted %d bytes to %d in %.4f sec\n", before, bu_file_size(gfile),
+	   (double)(bu_gettime() - start) / 1.0e6);
+
+    if (!failed && (reclaimed == 0 || (int)reclaimed != before - bu_file_size(gfile))) {
+	bu_log("reported %zu bytes reclaimed, file shrank by %d [FAIL]\n", reclaimed, before - bu_file_size(gfile));
+	failed = 1;
+    }
+    if (!failed)
+	failed = db_compact_check(dbip, gfile, ref, count);
+
+    /* The open database must keep working after objects moved */
+    if (!failed) {
+	point_t center = VINIT_ZERO;
+	if (mk_sph(wdbp, "after.s", center, 2.0) || db_lookup(dbip, "after.s", LOOKUP_QUIET) == RT_DIR_NULL) {
+	    bu_log("unable to write after compaction [FAIL]\n");
+	    failed = 1;
+	}
+    }
+    wdb_close(wdbp);
+
+    /* and the file must scan cleanly from scratch */
+    if (!failed) {
+	dbip = db_open(gfile, DB_OPEN_READONLY);
+	if (dbip == DBI_NULL || db_dirbuild(dbip) < 0) {
+	    bu_log("unable to reopen %s [FAIL]\n", gfile);
+	    failed = 1;
+	} else {
+	    failed = db_compact_check(dbip, gfile, ref, count);
+	    db_close(dbip);
+	}
+    }
+
+    for (i = 0; i < count; i++) {
+	if (ref[i].ext_buf)
+	    bu_free_external(&ref[i]);
+    }
+    bu_free(ref, "db_compact ref");
+    bu_file_delete(gfile);
+
+    if (failed)
+	return EXIT_FAILURE;
+
+    bu_log("All unit tests succeeded.\n");
+    return EXIT_SUCCESS;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
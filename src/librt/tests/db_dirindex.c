@@ -0,0 +1,160 @@
+/*                   D B _ D I R I N D E X . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/db_dirindex.c
+ *
+ * Fill an in-memory database directory with many names, rename a
+ * third of them and delete a fifth, and check that db_lookup() and
+ * FOR_ALL_DIRECTORY agree on exactly the entries that should be left.
+ * Times the adds, the lookups and the renames and deletes.
+ *
+ * Usage: rt_db_dirindex [-n objects]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+
+
+/* Name entry i has after the renames and deletes, or NULL if it is gone */
+static const char *
+dirindex_name(char *buf, size_t len, size_t i, int edited)
+{
+    if (edited && i % 5 == 4)
+	return NULL;
+    snprintf(buf, len, "%s%zu.%c", (edited && i % 3 == 1) ? "moved_" : "part_", i, (i % 2) ? 's' : 'r');
+    return buf;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n objects]\n";
+    unsigned char minor = ID_SPH;
+    size_t count = 200000;
+    struct directory *dp;
+    struct db_i *dbip;
+    int64_t start;
+    double t_add, t_lookup, t_edit;
+    size_t i, found;
+    char name[64], newname[64];
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		count = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (count < 100)
+	count = 100;
+
+    dbip = db_open_inmem();
+    if (dbip == DBI_NULL)
+	bu_exit(1, "db_open_inmem failed\n");
+
+    start = bu_gettime();
+    for (i = 0; i < count; i++) {
+	dirindex_name(name, sizeof(name), i, 0);
+	if (db_diradd(dbip, name, RT_DIR_PHONY_ADDR, 0, RT_DIR_SOLID, &minor) == RT_DIR_NULL)
+	    bu_exit(1, "%s: db_diradd failed\n", name);
+    }
+    t_add = (double)(bu_gettime() - start) / 1.0e6;
+
+    start = bu_gettime();
+    for (i = 0; i < count; i++) {
+	dirindex_name(name, sizeof(name), i, 0);
+	dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	if (dp == RT_DIR_NULL || !BU_STR_EQUAL(dp->d_namep, name))
+	    bu_exit(1, "%s: not found after db_diradd [FAIL]\n", name);
+    }
+    t_lookup = (double)(bu_gettime() - start) / 1.0e6;
+
+    start = bu_gettime();
+    for (i = 0; i < count; i++) {
+	dirindex_name(name, sizeof(name), i, 0);
+	if (i % 5 == 4) {
+	    dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	    if (dp == RT_DIR_NULL || db_dirdelete(dbip, dp) < 0)
+		bu_exit(1, "%s: db_dirdelete failed [FAIL]\n", name);
+	} else if (i % 3 == 1) {
+	    dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	    dirindex_name(newname, sizeof(newname), i, 1);
+	    if (dp == RT_DIR_NULL || db_rename(dbip, dp, newname) < 0)
+		bu_exit(1, "%s: db_rename failed [FAIL]\n", name);
+	}
+    }
+    t_edit = (double)(bu_gettime() - start) / 1.0e6;
+
+    /* every survivor is found under its current name only */
+    found = 0;
+    for (i = 0; i < count; i++) {
+	if (!dirindex_name(name, sizeof(name), i, 1)) {
+	    dirindex_name(name, sizeof(name), i, 0);
+	    if (db_lookup(dbip, name, LOOKUP_QUIET) != RT_DIR_NULL)
+		bu_exit(1, "%s: found after db_dirdelete [FAIL]\n", name);
+	    continue;
+	}
+	dp = db_lookup(dbip, name, LOOKUP_QUIET);
+	if (dp == RT_DIR_NULL || !BU_STR_EQUAL(dp->d_namep, name))
+	    bu_exit(1, "%s: not found after the edits [FAIL]\n", name);
+	if (i % 3 == 1 && db_lookup(dbip, dirindex_name(name, sizeof(name), i, 0), LOOKUP_QUIET) != RT_DIR_NULL)
+	    bu_exit(1, "%s: old name still found after db_rename [FAIL]\n", name);
+	found++;
+    }
+
+    /* and the directory walk sees the same entries, each once */
+    i = 0;
+    FOR_ALL_DIRECTORY_START(dp, dbip) {
+	if (db_lookup(dbip, dp->d_namep, LOOKUP_QUIET) != dp)
+	    bu_exit(1, "%s: walked entry does not look up to itself [FAIL]\n", dp->d_namep);
+	i++;
+    } FOR_ALL_DIRECTORY_END;
+    if (i != found)
+	bu_exit(1, "directory walk saw %zu entries, expected %zu [FAIL]\n", i, found);
+
+    db_close(dbip);
+
+    bu_log("%zu objects: add %.4f sec, lookup %.4f sec, rename+delete %.4f sec [PASS]\n",
+	   count, t_add, t_lookup, t_edit);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,241 @@
+/*                       D B _ R E A D . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/db_read.c
+ *
+ * Read every object of a generated database from many threads at
+ * once, through both the read-write (file) and read-only (mapped)
+ * paths, and check each one against a serial read.  The read-only
+ * pass goes through db_get_external_view().
+ *
+ * Usage: rt_db_read [-P ncpu] [-n objects]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/file.h"
+#include "bu/getopt.h"
+#include "bu/parallel.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+struct db_read_state {
+    struct db_i *dbip;
+    struct directory **dirs;
+    struct bu_external *ref;
+    size_t count;
+    size_t next;
+    int view;
+    int failed;
+};
+
+
+static void
+db_read_worker(int UNUSED(cpu), void *data)
+{
+    struct db_read_state *s = (struct db_read_state *)data;
+
+    while (1) {
+	struct bu_external ext;
+	struct rt_db_internal intern;
+	size_t i;
+	int ret;
+
+	bu_semaphore_acquire(BU_SEM_GENERAL);
+	i = s->next++;
+	bu_semaphore_release(BU_SEM_GENERAL);
+	if (i >= s->count)
+	    break;
+
+	if (s->view)
+	    ret = db_get_external_view(&ext, s->dirs[i], s->dbip);
+	else
+	    ret = db_get_external(&ext, s->dirs[i], s->dbip);
+	if (ret < 0 || ext.ext_nbytes != s->ref[i].ext_nbytes
+	    || memcmp(ext.ext_buf, s->ref[i].ext_buf, ext.ext_nbytes) != 0) {
+	    bu_log("%s: external differs from the serial read\n", s->dirs[i]->d_namep);
+	    s->failed = 1;
+	}
+	if (ret == 0) {
+	    db_free_external(&ext, s->dbip);
+	    if (ext.ext_buf != NULL) {
+		bu_log("%s: db_free_external() left a buffer\n", s->dirs[i]->d_namep);
+		s->failed = 1;
+	    }
+	}
+
+	if (rt_db_get_internal(&intern, s->dirs[i], s->dbip, NULL) != ID_SPH) {
+	    bu_log("%s: import failed\n", s->dirs[i]->d_namep);
+	    s->failed = 1;
+	    continue;
+	}
+	rt_db_free_internal(&intern);
+    }
+}
+
+
+/* Read everything from ncpu threads, returning the elapsed seconds */
+static double
+db_read_run(struct db_read_state *s, size_t ncpu)
+{
+    int64_t start = bu_gettime();
+
+    s->next = 0;
+    bu_parallel(db_read_worker, ncpu, s);
+
+    return (double)(bu_gettime() - start) / 1.0e6;
+}
+
+
+static int
+db_read_pass(const char *gfile, const char *mode, struct bu_external *ref, size_t count, size_t ncpu)
+{
+    struct db_read_state s;
+    struct directory *dp;
+    double t_serial, t_parallel;
+    size_t i = 0;
+
+    s.dbip = db_open(gfile, mode);
+    if (s.dbip == DBI_NULL || db_dirbuild(s.dbip) < 0)
+	bu_exit(EXIT_FAILURE, "Unable to open %s with mode \"%s\"\n", gfile, mode);
+
+    s.dirs = (struct directory **)bu_calloc(count, sizeof(struct directory *), "db_read dirs");
+    FOR_ALL_DIRECTORY_START(dp, s.dbip) {
+	if (dp->d_flags & RT_DIR_SOLID && i < count)
+	    s.dirs[i++] = dp;
+    } FOR_ALL_DIRECTORY_END;
+    if (i != count)
+	bu_exit(EXIT_FAILURE, "Found %zu of %zu solids\n", i, count);
+
+    /* directory order differs from creation order, so fill in the
+     * reference externals on the first pass */
+    if (!ref[0].ext_buf) {
+	for (i = 0; i < count; i++) {
+	    if (db_get_external(&ref[i], s.dirs[i], s.dbip) < 0)
+		bu_exit(EXIT_FAILURE, "Unable to read %s\n", s.dirs[i]->d_namep);
+	}
+    }
+
+    s.ref = ref;
+    s.count = count;
+    s.view = (mode[0] == 'r' && mode[1] == '\0');
+    s.failed = 0;
+
+    t_serial = db_read_run(&s, 1);
+    t_parallel = db_read_run(&s, ncpu);
+
+    bu_log("mode \"%s\": %zu objects, 1 thread %.4f sec, %zu threads %.4f sec\n",
+	   mode, count, t_serial, ncpu, t_parallel);
+
+    bu_free(s.dirs, "db_read dirs");
+    db_close(s.dbip);
+    return s.failed;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-P ncpu] [-n objects]\n";
+    char gfile[MAXPATHLEN] = {0};
+    struct bu_external *ref;
+    struct rt_wdb *wdbp;
+    size_t ncpu = bu_avail_cpus();
+    size_t count = 10000;
+    size_t i;
+    int failed = 0;
+    int c;
+    FILE *fp;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "P:n:")) != -1) {
+	switch (c) {
+	    case 'P':
+		ncpu = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'n':
+		count = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(EXIT_FAILURE, USAGE, argv[0]);
+	}
+    }
+    if (ncpu < 1)
+	ncpu = 1;
+    if (ncpu > MAX_PSW)
+	ncpu = MAX_PSW;
+    if (count < 1)
+	count = 1;
+
+    fp = bu_temp_file(gfile, sizeof(gfile));
+    if (!fp)
+	bu_exit(EXIT_FAILURE, "Unable to create temporary database\n");
+    fclose(fp);
+    bu_file_delete(gfile);
+
+    wdbp = wdb_fopen(gfile);
+    if (!wdbp)
+	bu_exit(EXIT_FAILURE, "Unable to open temporary database\n");
+    for (i = 0; i < count; i++) {
+	char name[64];
+	point_t center;
+	snprintf(name, sizeof(name), "sph%zu.s", i);
+	VSET(center, (fastf_t)i, (fastf_t)(i % 7), (fastf_t)(i % 13));
+	if (mk_sph(wdbp, name, center, 0.5 + (fastf_t)(i % 5))) {
+	    wdb_close(wdbp);
+	    bu_file_delete(gfile);
+	    bu_exit(EXIT_FAILURE, "Unable to write %s\n", name);
+	}
+    }
+    wdb_close(wdbp);
+
+    ref = (struct bu_external *)bu_calloc(count, sizeof(struct bu_external), "db_read ref");
+
+    failed += db_read_pass(gfile, DB_OPEN_READWRITE, ref, count, ncpu);
+    failed += db_read_pass(gfile, DB_OPEN_READONLY, ref, count, ncpu);
+
+    for (i = 0; i < count; i++)
+	bu_free_external(&ref[i]);
+    bu_free(ref, "db_read ref");
+    bu_file_delete(gfile);
+
+    if (failed)
+	return EXIT_FAILURE;
+
+    bu_log("All unit tests succeeded.\n");
+    return EXIT_SUCCESS;
+}
+
+
+/*
+ * Local Variables:
+ * tab-width: 8
+ * mode: C
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,550 @@
+/*                      D S P _ S H O T . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/dsp_shot.c
+ *
+ * Shoot a rough DSP terrain with rt_dsp_shot(), which walks the
+ * bounding box pyramid, and check each segment's distances and
+ * normals against an exhaustive walk that intersects the ray with
+ * every triangle of the height field.  The grid is not a multiple of
+ * the pyramid's 4x4 blocks, so the partial blocks along its edges are
+ * walked too, and each cut direction is tried.
+ *
+ * Usage: rt_dsp_shot [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define DS_XCNT 67
+#define DS_YCNT 50
+#define DS_MAX_EVENTS 4096
+#define DS_MAX_SEGS 256
+#define DS_NORM_TOL 1.0e-6
+#define DS_EDGE_TOL 1.0e-3	/* closest a checked crossing comes to a triangle edge */
+
+/* solid space cell size in model space */
+#define DS_DX 2.0
+#define DS_DY 3.0
+#define DS_DZ 0.01
+
+struct ds_event {
+    fastf_t t;
+    vect_t norm;	/* solid space, outward */
+};
+
+struct ds_seg {
+    fastf_t in, out;
+    vect_t in_norm, out_norm;	/* model space, unit */
+};
+
+static unsigned short ds_buf[DS_XCNT * DS_YCNT];
+static unsigned long ds_seed = 12345;
+
+
+static double
+ds_rand(void)
+{
+    ds_seed = ds_seed * 1103515245UL + 12345UL;
+    return (double)((ds_seed >> 8) & 0xffffff) / (double)0x1000000;
+}
+
+
+#define DS_H(_x, _y) ((fastf_t)ds_buf[(_y) * DS_XCNT + (_x)])
+
+/* The cut of cell (x, y), as rt_dsp_cell_cut() chooses it */
+static int
+ds_cell_cut(int cuttype, int x, int y)
+{
+    int lo_x = (x > 0) ? x - 1 : 0;
+    int lo_y = (y > 0) ? y - 1 : 0;
+    int hi_x = (x + 2 < DS_XCNT) ? x + 2 : DS_XCNT - 1;
+    int hi_y = (y + 2 < DS_YCNT) ? y + 2 : DS_YCNT - 1;
+    fastf_t cAD, cBC;
+
+    if (cuttype != DSP_CUT_DIR_ADAPT)
+	return cuttype;
+
+    cAD = fabs(DS_H(x+1, y+1) + DS_H(lo_x, lo_y) - 2.0 * DS_H(x, y))
+	+ fabs(DS_H(hi_x, hi_y) + DS_H(x, y) - 2.0 * DS_H(x+1, y+1));
+    cBC = fabs(DS_H(x, y+1) + DS_H(hi_x, lo_y) - 2.0 * DS_H(x+1, y))
+	+ fabs(DS_H(lo_x, hi_y) + DS_H(x+1, y) - 2.0 * DS_H(x, y+1));
+
+    return (cAD < cBC) ? DSP_CUT_DIR_llUR : DSP_CUT_DIR_ULlr;
+}
+
+
+/* Triangle tri (0 or 1) of cell (x, y) as the plane
+ * z = p[0] + p[1] * fx + p[2] * fy over the cell's unit square.
+ * Returns how far (fx, fy) is inside the triangle, in cell widths,
+ * negative if it is outside.
+ */
+static fastf_t
+ds_tri(int cut, int x, int y, int tri, fastf_t fx, fastf_t fy, fastf_t p[3])
+{
+    fastf_t A = DS_H(x, y), B = DS_H(x+1, y);
+    fastf_t C = DS_H(x, y+1), D = DS_H(x+1, y+1);
+    fastf_t in = FMIN(FMIN(fx, 1.0 - fx), FMIN(fy, 1.0 - fy));
+
+    if (cut == DSP_CUT_DIR_llUR) {
+	if (!tri) {
+	    /* A B D */
+	    p[0] = A;
+	    p[1] = B - A;
+	    p[2] = D - B;
+	    return FMIN(in, (fx - fy) * M_SQRT1_2);
+	}
+	/* A D C */
+	p[0] = A;
+	p[1] = D - C;
+	p[2] = C - A;
+	return FMIN(in, (fy - fx) * M_SQRT1_2);
+    }
+    if (!tri) {
+	/* A B C */
+	p[0] = A;
+	p[1] = B - A;
+	p[2] = C - A;
+	return FMIN(in, (1.0 - fx - fy) * M_SQRT1_2);
+    }
+    /* B D C */
+    p[0] = B + C - D;
+    p[1] = D - C;
+    p[2] = D - B;
+    return FMIN(in, (fx + fy - 1.0) * M_SQRT1_2);
+}
+
+
+/* Elevation of the surface over solid space point (x, y) */
+static fastf_t
+ds_height(int cuttype, fastf_t x, fastf_t y)
+{
+    int cx = (int)x, cy = (int)y;
+    fastf_t p[3], fx, fy;
+
+    if (cx >= DS_XCNT - 1)
+	cx = DS_XCNT - 2;
+    if (cy >= DS_YCNT - 1)
+	cy = DS_YCNT - 2;
+    fx = x - cx;
+    fy = y - cy;
+    if (ds_tri(ds_cell_cut(cuttype, cx, cy), cx, cy, 0, fx, fy, p) < 0.0)
+	(void)ds_tri(ds_cell_cut(cuttype, cx, cy), cx, cy, 1, fx, fy, p);
+    return p[0] + p[1] * fx + p[2] * fy;
+}
+
+
+static int
+ds_event_cmp(const void *a, const void *b)
+{
+    const struct ds_event *ea = (const struct ds_event *)a;
+    const struct ds_event *eb = (const struct ds_event *)b;
+
+    if (ea->t < eb->t)
+	return -1;
+    return ea->t > eb->t;
+}
+
+
+/* The segments of the model space ray (pt, dir) through the height
+ * field, from every triangle it crosses and the walls of the box the
+ * grid stands in.  Returns the number of segments, or -1 if the ray
+ * meets the plane of a triangle within DS_EDGE_TOL of the triangle's
+ * edge: rt_dsp_shot() takes hits a tolerance outside a triangle, so
+ * whether it sees that crossing depends on the cell intersection, not
+ * on the walk that finds the cell.  The same goes for a ray that
+ * enters or leaves the box that close to where two of its walls meet,
+ * or to a cell boundary on a wall, where the cells on either side
+ * decide which wall it went through.
+ */
+static int
+ds_reference(int cuttype, fastf_t zmax, const point_t pt, const vect_t dir, struct ds_seg *segs)
+{
+    static struct ds_event ev[DS_MAX_EVENTS];
+    point_t P;
+    vect_t U;
+    fastf_t lo[3], hi[3], t0 = -INFINITY, t1 = INFINITY;
+    vect_t n0 = VINIT_ZERO, n1 = VINIT_ZERO;
+    int nev = 0, nseg = 0, in_solid = 0;
+    int a, x, y, tri, i;
+
+    /* solid space ray, with the same parameter */
+    VSET(P, pt[X] / DS_DX, pt[Y] / DS_DY, pt[Z] / DS_DZ);
+    VSET(U, dir[X] / DS_DX, dir[Y] / DS_DY, dir[Z] / DS_DZ);
+    VSET(lo, 0.0, 0.0, 0.0);
+    VSET(hi, DS_XCNT - 1, DS_YCNT - 1, zmax);
+
+    for (a = X; a <= Z; a++) {
+	fastf_t ta, tb;
+	vect_t na = VINIT_ZERO, nb = VINIT_ZERO;
+
+	if (ZERO(U[a])) {
+	    if (P[a] <= lo[a] || P[a] >= hi[a])
+		return 0;
+	    continue;
+	}
+	ta = (lo[a] - P[a]) / U[a];
+	tb = (hi[a] - P[a]) / U[a];
+	na[a] = -1.0;
+	nb[a] = 1.0;
+	if (ta > tb) {
+	    fastf_t tt = ta;
+	    ta = tb;
+	    tb = tt;
+	    na[a] = 1.0;
+	    nb[a] = -1.0;
+	}
+	if (ta > t0) {
+	    t0 = ta;
+	    VMOVE(n0, na);
+	}
+	if (tb < t1) {
+	    t1 = tb;
+	    VMOVE(n1, nb);
+	}
+    }
+    if (t0 >= t1)
+	return 0;
+    for (i = 0; i < 2; i++) {
+	fastf_t t = i ? t1 : t0;
+	int walls = 0;
+
+	for (a = X; a <= Z; a++) {
+	    fastf_t q = P[a] + t * U[a];
+	    fastf_t scale = a == X ? DS_DX : (a == Y ? DS_DY : DS_DZ);
+
+	    if (fabs(q - lo[a]) * scale < DS_EDGE_TOL || fabs(q - hi[a]) * scale < DS_EDGE_TOL
+		|| (a != Z && fabs(q - floor(q + 0.5)) * scale < DS_EDGE_TOL))
+		walls++;
+	}
+	if (walls > 1)
+	    return -1;
+    }
+
+    ev[nev].t = t0;
+    VMOVE(ev[nev].norm, n0);
+    nev++;
+    ev[nev].t = t1;
+    VMOVE(ev[nev].norm, n1);
+    nev++;
+
+    for (y = 0; y < DS_YCNT - 1; y++) {
+	for (x = 0; x < DS_XCNT - 1; x++) {
+	    int cut = ds_cell_cut(cuttype, x, y);
+
+	    for (tri = 0; tri < 2; tri++) {
+		fastf_t p[3], denom, t, fx, fy, inside;
+
+		(void)ds_tri(cut, x, y, tri, 0.0, 0.0, p);
+		denom = p[1] * U[X] + p[2] * U[Y] - U[Z];
+		if (ZERO(denom))
+		    continue;
+		t = (P[Z] - p[0] - p[1] * (P[X] - x) - p[2] * (P[Y] - y)) / denom;
+		if (t <= t0 || t >= t1)
+		    continue;
+		fx = P[X] + t * U[X] - x;
+		fy = P[Y] + t * U[Y] - y;
+		inside = ds_tri(cut, x, y, tri, fx, fy, p);
+		if (fabs(inside) < DS_EDGE_TOL)
+		    return -1;
+		if (inside < 0.0)
+		    continue;
+		if (nev >= DS_MAX_EVENTS)
+		    bu_exit(1, "more than %d reference crossings [FAIL]\n", DS_MAX_EVENTS);
+		ev[nev].t = t;
+		VSET(ev[nev].norm, -p[1], -p[2], 1.0);
+		nev++;
+	    }
+	}
+    }
+    qsort(ev, nev, sizeof(struct ds_event), ds_event_cmp);
+
+    /* inside between two crossings if the midpoint is under the surface */
+    for (i = 0; i < nev - 1; i++) {
+	fastf_t tm = 0.5 * (ev[i].t + ev[i+1].t);
+	fastf_t mz = P[Z] + tm * U[Z];
+	int in;
+
+	if (ev[i+1].t - ev[i].t < 1.0e-12)
+	    continue;
+	in = (mz > 0.0 && mz < ds_height(cuttype, P[X] + tm * U[X], P[Y] + tm * U[Y]));
+	if (in && !in_solid) {
+	    if (nseg >= DS_MAX_SEGS)
+		bu_exit(1, "more than %d reference segments [FAIL]\n", DS_MAX_SEGS);
+	    segs[nseg].in = ev[i].t;
+	    VSET(segs[nseg].in_norm, ev[i].norm[X] / DS_DX, ev[i].norm[Y] / DS_DY, ev[i].norm[Z] / DS_DZ);
+	    VUNITIZE(segs[nseg].in_norm);
+	} else if (!in && in_solid) {
+	    segs[nseg].out = ev[i].t;
+	    VSET(segs[nseg].out_norm, ev[i].norm[X] / DS_DX, ev[i].norm[Y] / DS_DY, ev[i].norm[Z] / DS_DZ);
+	    VUNITIZE(segs[nseg].out_norm);
+	    nseg++;
+	}
+	in_solid = in;
+    }
+    if (in_solid) {
+	segs[nseg].out = ev[nev-1].t;
+	VSET(segs[nseg].out_norm, ev[nev-1].norm[X] / DS_DX, ev[nev-1].norm[Y] / DS_DY, ev[nev-1].norm[Z] / DS_DZ);
+	VUNITIZE(segs[nseg].out_norm);
+	nseg++;
+    }
+    return nseg;
+}
+
+
+static struct soltab *
+ds_soltab(struct rt_i *rtip)
+{
+    struct soltab *stp;
+
+    RT_VISIT_ALL_SOLTABS_START(stp, rtip) {
+	if (stp->st_id == ID_DSP)
+	    return stp;
+    } RT_VISIT_ALL_SOLTABS_END;
+    return NULL;
+}
+
+
+/* The segments rt_obj_shot() gives the ray, with their normals.
+ * Where a ray skims past a cell corner inside the solid, the cells on
+ * either side can leave a gap of about the model's distance tolerance
+ * between their segments.  The reference has no seams, so segments
+ * that close to each other are joined.
+ */
+static int
+ds_shoot(struct soltab *stp, struct application *ap, struct ds_seg *segs)
+{
+    struct seg seghead;
+    struct seg *segp;
+    int nseg = 0;
+
+    BU_LIST_INIT(&seghead.l);
+    (void)rt_obj_shot(stp, &ap->a_ray, ap, &seghead);
+    for (BU_LIST_FOR(segp, seg, &seghead.l)) {
+	struct hit in = segp->seg_in;
+	struct hit out = segp->seg_out;
+
+	rt_obj_norm(&in, stp, &ap->a_ray);
+	rt_obj_norm(&out, stp, &ap->a_ray);
+	if (nseg && NEAR_EQUAL(segs[nseg-1].out, in.hit_dist, 4.0 * ap->a_rt_i->rti_tol.dist)) {
+	    segs[nseg-1].out = out.hit_dist;
+	    VMOVE(segs[nseg-1].out_norm, out.hit_normal);
+	    continue;
+	}
+	if (nseg >= DS_MAX_SEGS)
+	    bu_exit(1, "more than %d segments [FAIL]\n", DS_MAX_SEGS);
+	segs[nseg].in = in.hit_dist;
+	segs[nseg].out = out.hit_dist;
+	VMOVE(segs[nseg].in_norm, in.hit_normal);
+	VMOVE(segs[nseg].out_norm, out.hit_normal);
+	nseg++;
+    }
+    RT_FREE_SEG_LIST(&seghead, ap->a_resource);
+    return nseg;
+}
+
+
+static void
+ds_compare(struct db_i *dbip, const char *name, int cuttype, fastf_t zmax, size_t nrays)
+{
+    static struct ds_seg got[DS_MAX_SEGS], want[DS_MAX_SEGS];
+    struct application ap;
+    struct resource res;
+    struct soltab *stp;
+    struct rt_i *rtip;
+    fastf_t xlen = (DS_XCNT - 1) * DS_DX;
+    fastf_t ylen = (DS_YCNT - 1) * DS_DY;
+    size_t i, hits = 0, nsegs = 0, skipped = 0;
+    int j, ngot, nwant;
+
+    rtip = rt_i_create(dbip);
+    if (rt_gettree(rtip, name) < 0)
+	bu_exit(1, "rt_gettree(%s) failed [FAIL]\n", name);
+    rt_prep(rtip);
+    stp = ds_soltab(rtip);
+    if (!stp)
+	bu_exit(1, "%s was not prepped [FAIL]\n", name);
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_onehit = 0;
+
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+
+	VSET(target, (1.1 * ds_rand() - 0.05) * xlen, (1.1 * ds_rand() - 0.05) * ylen,
+	     ds_rand() * zmax * DS_DZ);
+	switch (i % 3) {
+	    case 0:
+		/* anywhere */
+		VSET(ap.a_ray.r_dir, ds_rand() - 0.5, ds_rand() - 0.5, ds_rand() - 0.5);
+		break;
+	    case 1:
+		/* skimming the terrain, across many cells */
+		VSET(ap.a_ray.r_dir, ds_rand() - 0.5, ds_rand() - 0.5, 0.01 * (ds_rand() - 0.5));
+		break;
+	    default:
+		/* looking down on it */
+		VSET(ap.a_ray.r_dir, 0.1 * (ds_rand() - 0.5), 0.1 * (ds_rand() - 0.5), -1.0);
+	}
+	VUNITIZE(ap.a_ray.r_dir);
+	VJOIN1(ap.a_ray.r_pt, target, -2.0 * rtip->rti_radius, ap.a_ray.r_dir);
+	ap.a_ray.magic = RT_RAY_MAGIC;
+
+	ngot = ds_shoot(stp, &ap, got);
+	nwant = ds_reference(cuttype, zmax, ap.a_ray.r_pt, ap.a_ray.r_dir, want);
+	if (nwant < 0) {
+	    /* too close to an edge to say what it should hit */
+	    skipped++;
+	    continue;
+	}
+	if (ngot != nwant)
+	    bu_exit(1, "%s ray %zu: %d segments but %d from the exhaustive walk [FAIL]\n",
+		    name, i, ngot, nwant);
+	for (j = 0; j < ngot; j++) {
+	    if (!NEAR_EQUAL(got[j].in, want[j].in, rtip->rti_tol.dist)
+		|| !NEAR_EQUAL(got[j].out, want[j].out, rtip->rti_tol.dist))
+		bu_exit(1, "%s ray %zu segment %d: %.9g,%.9g but %.9g,%.9g from the exhaustive walk [FAIL]\n",
+			name, i, j, got[j].in, got[j].out, want[j].in, want[j].out);
+	    if (VDOT(got[j].in_norm, want[j].in_norm) < 1.0 - DS_NORM_TOL
+		|| VDOT(got[j].out_norm, want[j].out_norm) < 1.0 - DS_NORM_TOL)
+		bu_exit(1, "%s ray %zu segment %d: normals (%g %g %g), (%g %g %g) but (%g %g %g), (%g %g %g) from the exhaustive walk [FAIL]\n",
+			name, i, j, V3ARGS(got[j].in_norm), V3ARGS(got[j].out_norm),
+			V3ARGS(want[j].in_norm), V3ARGS(want[j].out_norm));
+	}
+	if (ngot)
+	    hits++;
+	nsegs += ngot;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit %s [FAIL]\n", name);
+    if (skipped > nrays / 20)
+	bu_exit(1, "%zu of %zu rays on %s passed too close to an edge to check [FAIL]\n",
+		skipped, nrays, name);
+
+    rt_clean_resource(rtip, &res);
+    rt_i_destroy(rtip);
+
+    bu_log("%s: %zu of %zu rays hit, %zu segments, %zu skipped\n", name, hits, nrays, nsegs, skipped);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-r rays]\n";
+    static const struct {
+	const char *name;
+	int cuttype;
+    } cuts[3] = {
+	{"llUR.s", DSP_CUT_DIR_llUR},
+	{"ULlr.s", DSP_CUT_DIR_ULlr},
+	{"adapt.s", DSP_CUT_DIR_ADAPT}
+    };
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    size_t nrays = 3000;
+    unsigned short hmax = 0;
+    int x, y, k, c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "r:")) != -1) {
+	switch (c) {
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+
+    /* rolling hills with a rough surface and a flat plateau */
+    for (y = 0; y < DS_YCNT; y++) {
+	for (x = 0; x < DS_XCNT; x++) {
+	    double h = 2000.0 + 800.0 * sin(x * 0.21) * cos(y * 0.17) + 400.0 * ds_rand();
+
+	    if (x > 40 && x < 52 && y > 10 && y < 22)
+		h = 3000.0;
+	    ds_buf[y * DS_XCNT + x] = (unsigned short)h;
+	    V_MAX(hmax, ds_buf[y * DS_XCNT + x]);
+	}
+    }
+
+    dbip = db_open_inmem();
+    if (dbip == DBI_NULL)
+	bu_exit(1, "db_open_inmem failed [FAIL]\n");
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+    if (mk_binunif(wdbp, "terrain.data", (const void *)ds_buf, WDB_BINUNIF_UINT16,
+		   (long)(DS_XCNT * DS_YCNT)) < 0)
+	bu_exit(1, "mk_binunif failed [FAIL]\n");
+
+    for (k = 0; k < 3; k++) {
+	struct rt_dsp_internal *dsp;
+
+	BU_ALLOC(dsp, struct rt_dsp_internal);
+	dsp->magic = RT_DSP_INTERNAL_MAGIC;
+	dsp->dsp_xcnt = DS_XCNT;
+	dsp->dsp_ycnt = DS_YCNT;
+	dsp->dsp_smooth = 0;
+	dsp->dsp_cuttype = cuts[k].cuttype;
+	dsp->dsp_datasrc = RT_DSP_SRC_OBJ;
+	bu_vls_init(&dsp->dsp_name);
+	bu_vls_strcpy(&dsp->dsp_name, "terrain.data");
+	MAT_IDN(dsp->dsp_stom);
+	dsp->dsp_stom[0] = DS_DX;
+	dsp->dsp_stom[5] = DS_DY;
+	dsp->dsp_stom[10] = DS_DZ;
+	bn_mat_inv(dsp->dsp_mtos, dsp->dsp_stom);
+	dsp->dsp_bip = NULL;
+	dsp->dsp_mp = NULL;
+	if (wdb_export(wdbp, cuts[k].name, (void *)dsp, ID_DSP, 1.0) < 0)
+	    bu_exit(1, "wdb_export(%s) failed [FAIL]\n", cuts[k].name);
+    }
+    db_update_nref(dbip);
+
+    for (k = 0; k < 3; k++)
+	ds_compare(dbip, cuts[k].name, cuts[k].cuttype, hmax + 1.0, nrays);
+
+    db_close(dbip);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,311 @@
+/*                      I N S T A N C E . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/instance.c
+ *
+ * Place one lumpy BoT in a ring of regions, each turned a different
+ * way, and two more at twice the size.  Prep the ring with rti_instance
+ * set, where all but one BoT at each size must be an instance, and with
+ * rti_dont_instance set as well, where none may be, and check that a set of
+ * rays gets the same partitions, regions and normals from both.
+ *
+ * Usage: rt_instance [-p placements] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define IN_MAX_PARTS 8	/* partitions recorded per ray */
+#define IN_TOL 1.0e-6
+#define IN_NSEG 48
+#define IN_BIG 2	/* placements at twice the size */
+#define IN_EXTENT 250.0	/* half the width of the ring */
+
+struct in_ray {
+    int nparts;
+    long reg[IN_MAX_PARTS];
+    fastf_t in[IN_MAX_PARTS];
+    fastf_t out[IN_MAX_PARTS];
+    vect_t normal;	/* of the first hit */
+};
+
+
+static int
+in_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct in_ray *r = (struct in_ray *)ap->a_uptr;
+    struct partition *pp = part_head->pt_forw;
+
+    RT_HIT_NORMAL(r->normal, pp->pt_inhit, pp->pt_inseg->seg_stp, &ap->a_ray, pp->pt_inflip);
+    r->nparts = 0;
+    for (; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < IN_MAX_PARTS) {
+	    r->reg[r->nparts] = pp->pt_regionp->reg_bit;
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+in_miss(struct application *ap)
+{
+    struct in_ray *r = (struct in_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Prep all.g with instancing, or with rti_dont_instance overriding
+ * it, check how many instances it made, and shoot nrays rays from a
+ * fixed sequence across its bounds.
+ */
+static struct in_ray *
+in_prep_and_shoot(struct db_i *dbip, int dont_instance, size_t ninstances, size_t nrays, double *secs)
+{
+    struct in_ray *rays;
+    struct application ap;
+    struct resource res;
+    struct rt_i *rtip;
+    int64_t start;
+    size_t i;
+
+    rtip = rt_i_create(dbip);
+    rtip->rti_instance = 1;
+    rtip->rti_instance_types = "bot";
+    rtip->rti_dont_instance = dont_instance;
+    if (rt_gettree(rtip, "all.g") < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(rtip);
+    if (rtip->stats.ninstances != ninstances)
+	bu_exit(1, "%zu instances, not %zu [FAIL]\n", rtip->stats.ninstances, ninstances);
+    if (ninstances && !rtip->stats.instance_bytes)
+	bu_exit(1, "no BoT data counted as shared [FAIL]\n");
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_hit = in_hit;
+    ap.a_miss = in_miss;
+    ap.a_onehit = 0;
+
+    rays = (struct in_ray *)bu_calloc(nrays, sizeof(struct in_ray), "instance rays");
+    start = bu_gettime();
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+	fastf_t u = (fastf_t)((i * 7919) % nrays) / (fastf_t)nrays;
+	fastf_t v = (fastf_t)((i * 104729) % nrays) / (fastf_t)nrays;
+	fastf_t w = (fastf_t)((i * 1299709) % nrays) / (fastf_t)nrays;
+
+	/* not the model bounds, which are looser around instances */
+	VSET(target,
+	     (0.0123 + 0.97 * u - 0.5) * 2.0 * IN_EXTENT,
+	     (0.0371 + 0.93 * v - 0.5) * 2.0 * IN_EXTENT,
+	     (0.0457 + 0.91 * w - 0.5) * IN_EXTENT);
+	if (i % 2) {
+	    VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+	} else {
+	    VSET(ap.a_ray.r_dir, u - 0.5, v - 0.5 + 0.0017, w - 0.5 + 0.0029);
+	    VUNITIZE(ap.a_ray.r_dir);
+	}
+	VJOIN1(ap.a_ray.r_pt, target, -4.0 * IN_EXTENT, ap.a_ray.r_dir);
+	ap.a_uptr = (void *)&rays[i];
+	(void)rt_shootray(&ap);
+    }
+    *secs = (double)(bu_gettime() - start) / 1.0e6;
+
+    rt_i_destroy(rtip);
+    return rays;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-p placements] [-r rays]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct wmember all;
+    struct in_ray *inst, *plain;
+    fastf_t *verts;
+    int *faces;
+    double t_inst, t_plain;
+    size_t nplace = 12;
+    size_t nrays = 6000;
+    size_t nverts, i, j, f, hits = 0;
+    int k, c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "p:r:")) != -1) {
+	switch (c) {
+	    case 'p':
+		nplace = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (nplace < 2)
+	nplace = 2;
+    if (nrays < 1)
+	nrays = 1;
+
+    /* a latitude/longitude sphere, lumpy enough that every turn of it
+     * is a different shape in place */
+    nverts = 2 + (IN_NSEG - 1) * IN_NSEG;
+    verts = (fastf_t *)bu_calloc(nverts * 3, sizeof(fastf_t), "verts");
+    faces = (int *)bu_calloc(2 * IN_NSEG * (IN_NSEG - 1) * 3, sizeof(int), "faces");
+    VSET(&verts[0], 0.0, 0.0, 30.0);
+    VSET(&verts[3], 0.0, 0.0, -24.0);
+    for (i = 1; i < IN_NSEG; i++) {
+	fastf_t phi = M_PI * (fastf_t)i / (fastf_t)IN_NSEG;
+	for (j = 0; j < IN_NSEG; j++) {
+	    fastf_t theta = M_2PI * (fastf_t)j / (fastf_t)IN_NSEG;
+	    fastf_t r = 20.0 + 6.0 * sin(3.0 * theta) * sin(phi) + 3.0 * cos(2.0 * phi);
+	    size_t v = 2 + (i - 1) * IN_NSEG + j;
+	    VSET(&verts[v*3], 1.5 * r * sin(phi) * cos(theta), r * sin(phi) * sin(theta), r * cos(phi));
+	}
+    }
+    f = 0;
+    for (j = 0; j < IN_NSEG; j++) {
+	size_t jn = (j + 1) % IN_NSEG;
+	faces[f*3+0] = 0;
+	faces[f*3+1] = (int)(2 + j);
+	faces[f*3+2] = (int)(2 + jn);
+	f++;
+	faces[f*3+0] = 1;
+	faces[f*3+1] = (int)(2 + (IN_NSEG - 2) * IN_NSEG + jn);
+	faces[f*3+2] = (int)(2 + (IN_NSEG - 2) * IN_NSEG + j);
+	f++;
+	for (i = 1; i + 1 < IN_NSEG; i++) {
+	    int a = (int)(2 + (i - 1) * IN_NSEG + j);
+	    int b = (int)(2 + (i - 1) * IN_NSEG + jn);
+	    int d = (int)(2 + i * IN_NSEG + j);
+	    int e = (int)(2 + i * IN_NSEG + jn);
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = d;
+	    faces[f*3+2] = e;
+	    f++;
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = e;
+	    faces[f*3+2] = b;
+	    f++;
+	}
+    }
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+    if (mk_bot(wdbp, "lump.s", RT_BOT_SOLID, RT_BOT_CCW, 0, nverts, f, verts, faces, NULL, NULL))
+	bu_exit(1, "mk_bot failed [FAIL]\n");
+    bu_free(verts, "verts");
+    bu_free(faces, "faces");
+
+    /* a ring of regions, each turning the lump its own way, and a few
+     * more of them scaled up, which can only share with each other */
+    BU_LIST_INIT(&all.l);
+    for (i = 0; i < nplace + IN_BIG; i++) {
+	struct wmember wm;
+	struct bu_vls name = BU_VLS_INIT_ZERO;
+	fastf_t a = M_2PI * (fastf_t)i / (fastf_t)(nplace + IN_BIG);
+	mat_t m;
+
+	bn_mat_angles(m, 37.0 * (fastf_t)i, 23.0 * (fastf_t)i, 11.0 * (fastf_t)i);
+	if (i >= nplace) {
+	    for (k = 0; k < 11; k++) {
+		if (k % 4 != 3)
+		    m[k] *= 2.0;
+	    }
+	}
+	MAT_DELTAS(m, 140.0 * cos(a), 140.0 * sin(a), 5.0 * (fastf_t)i);
+
+	bu_vls_sprintf(&name, "p%zu.r", i);
+	BU_LIST_INIT(&wm.l);
+	(void)mk_addmember("lump.s", &wm.l, m, WMOP_UNION);
+	if (mk_lcomb(wdbp, bu_vls_cstr(&name), &wm, 1, NULL, NULL, NULL, 0))
+	    bu_exit(1, "mk_lcomb failed [FAIL]\n");
+	(void)mk_addmember(bu_vls_cstr(&name), &all.l, NULL, WMOP_UNION);
+	bu_vls_free(&name);
+    }
+    if (mk_lcomb(wdbp, "all.g", &all, 0, NULL, NULL, NULL, 0))
+	bu_exit(1, "mk_lcomb failed [FAIL]\n");
+
+    inst = in_prep_and_shoot(dbip, 0, nplace - 1 + IN_BIG - 1, nrays, &t_inst);
+    plain = in_prep_and_shoot(dbip, 1, 0, nrays, &t_plain);
+
+    for (i = 0; i < nrays; i++) {
+	if (inst[i].nparts != plain[i].nparts)
+	    bu_exit(1, "ray %zu: %d partitions instanced but %d prepped apart [FAIL]\n",
+		    i, inst[i].nparts, plain[i].nparts);
+	if (!inst[i].nparts)
+	    continue;
+	for (k = 0; k < inst[i].nparts && k < IN_MAX_PARTS; k++) {
+	    if (inst[i].reg[k] != plain[i].reg[k]
+		|| !NEAR_EQUAL(inst[i].in[k], plain[i].in[k], IN_TOL)
+		|| !NEAR_EQUAL(inst[i].out[k], plain[i].out[k], IN_TOL))
+		bu_exit(1, "ray %zu partition %d: region %ld %g,%g instanced but region %ld %g,%g prepped apart [FAIL]\n",
+			i, k, inst[i].reg[k], inst[i].in[k], inst[i].out[k],
+			plain[i].reg[k], plain[i].in[k], plain[i].out[k]);
+	}
+	if (!VNEAR_EQUAL(inst[i].normal, plain[i].normal, IN_TOL))
+	    bu_exit(1, "ray %zu: normal %g %g %g instanced but %g %g %g prepped apart [FAIL]\n",
+		    i, V3ARGS(inst[i].normal), V3ARGS(plain[i].normal));
+	hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit the lumps [FAIL]\n");
+
+    bu_free(inst, "instance rays");
+    bu_free(plain, "instance rays");
+    db_close(dbip);
+
+    bu_log("%zu placements, %zu of %zu rays hit: instanced %.4f sec, prepped apart %.4f sec [PASS]\n",
+	   nplace + IN_BIG, hits, nrays, t_inst, t_plain);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
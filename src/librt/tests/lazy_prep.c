@@ -0,0 +1,339 @@
+/*                     L A Z Y _ P R E P . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/lazy_prep.c
+ *
+ * Lay one lumpy BoT out in a grid of regions and shoot a strip of rays
+ * down through the first column only.  Prepped with rti_lazy_prep, no
+ * solid may be prepped before the rays, the ones off the strip must
+ * never be, and the rays must get the same partitions, regions and
+ * normals as with every solid prepped up front.  The rays are shot
+ * from several threads, which race to prep the same solids.
+ *
+ * Usage: rt_lazy_prep [-n grid size] [-r rays] [-P threads]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "bu/parallel.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define LP_MAX_PARTS 8	/* partitions recorded per ray */
+#define LP_TOL 1.0e-6
+#define LP_NSEG 40
+#define LP_SPACING 100.0
+#define LP_STRIP 20.0	/* half the width of the strip of rays */
+
+struct lp_ray {
+    int nparts;
+    long reg[LP_MAX_PARTS];
+    fastf_t in[LP_MAX_PARTS];
+    fastf_t out[LP_MAX_PARTS];
+    vect_t normal;	/* of the first hit */
+};
+
+struct lp_shoot {
+    struct rt_i *rtip;
+    struct resource *res;
+    struct lp_ray *rays;
+    size_t nrays;
+    size_t ngrid;
+    int ncpu;
+    int next;	/* the next worker to start */
+};
+
+
+static int
+lp_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct lp_ray *r = (struct lp_ray *)ap->a_uptr;
+    struct partition *pp = part_head->pt_forw;
+
+    RT_HIT_NORMAL(r->normal, pp->pt_inhit, pp->pt_inseg->seg_stp, &ap->a_ray, pp->pt_inflip);
+    r->nparts = 0;
+    for (; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < LP_MAX_PARTS) {
+	    r->reg[r->nparts] = pp->pt_regionp->reg_bit;
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+lp_miss(struct application *ap)
+{
+    struct lp_ray *r = (struct lp_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Each thread shoots every ncpu'th ray of the strip */
+static void
+lp_shoot_worker(int UNUSED(cpu), void *data)
+{
+    struct lp_shoot *s = (struct lp_shoot *)data;
+    struct application ap;
+    size_t i;
+    int w;
+
+    bu_semaphore_acquire(BU_SEM_GENERAL);
+    w = s->next++;
+    bu_semaphore_release(BU_SEM_GENERAL);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = s->rtip;
+    ap.a_resource = &s->res[w];
+    ap.a_hit = lp_hit;
+    ap.a_miss = lp_miss;
+    ap.a_onehit = 0;
+
+    for (i = (size_t)w; i < s->nrays; i += (size_t)s->ncpu) {
+	fastf_t u = (fastf_t)((i * 7919) % s->nrays) / (fastf_t)s->nrays;
+	fastf_t v = (fastf_t)((i * 104729) % s->nrays) / (fastf_t)s->nrays;
+
+	VSET(ap.a_ray.r_pt,
+	     (2.0 * u - 1.0) * LP_STRIP,
+	     (v - 0.5) * LP_SPACING * (fastf_t)s->ngrid + 0.0013,
+	     1000.0);
+	VSET(ap.a_ray.r_dir, 0.0017 * (u - 0.5), 0.0, -1.0);
+	VUNITIZE(ap.a_ray.r_dir);
+	ap.a_uptr = (void *)&s->rays[i];
+	(void)rt_shootray(&ap);
+    }
+}
+
+
+/* Prep all.g with or without deferring the BoTs, and shoot the strip */
+static struct lp_ray *
+lp_prep_and_shoot(struct db_i *dbip, int lazy, size_t ngrid, size_t nrays, int ncpu, double *secs)
+{
+    struct lp_shoot s;
+    struct rt_i *rtip;
+    int64_t start;
+    int i;
+
+    rtip = rt_i_create(dbip);
+    rtip->rti_lazy_prep = lazy;
+    rtip->rti_lazy_prep_types = "bot";
+    if (rt_gettree(rtip, "all.g") < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    start = bu_gettime();
+    rt_prep_parallel(rtip, ncpu);
+    if (rtip->stats.ndeferred != (lazy ? ngrid * ngrid : 0))
+	bu_exit(1, "%zu solids deferred, not %zu [FAIL]\n", rtip->stats.ndeferred, lazy ? ngrid * ngrid : 0);
+    if (rtip->stats.ndeferred_prepped)
+	bu_exit(1, "%zu deferred solids prepped before any ray [FAIL]\n", rtip->stats.ndeferred_prepped);
+
+    s.rtip = rtip;
+    s.res = (struct resource *)bu_calloc(ncpu, sizeof(struct resource), "lazy prep resources");
+    for (i = 0; i < ncpu; i++)
+	rt_init_resource(&s.res[i], i, rtip);
+    s.rays = (struct lp_ray *)bu_calloc(nrays, sizeof(struct lp_ray), "lazy prep rays");
+    s.nrays = nrays;
+    s.ngrid = ngrid;
+    s.ncpu = ncpu;
+    s.next = 0;
+    bu_parallel(lp_shoot_worker, (size_t)ncpu, &s);
+    *secs = (double)(bu_gettime() - start) / 1.0e6;
+
+    /* the strip crosses the first column of the grid, and nothing else */
+    if (lazy && (rtip->stats.ndeferred_prepped < ngrid || rtip->stats.ndeferred_prepped >= ngrid * ngrid))
+	bu_exit(1, "%zu deferred solids prepped by a strip across %zu of them [FAIL]\n",
+		rtip->stats.ndeferred_prepped, ngrid);
+
+    rt_i_destroy(rtip);
+    bu_free(s.res, "lazy prep resources");
+    return s.rays;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n grid size] [-r rays] [-P threads]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct wmember all;
+    struct lp_ray *lazy, *eager;
+    fastf_t *verts;
+    int *faces;
+    double t_lazy, t_eager;
+    size_t ngrid = 5;
+    size_t nrays = 4000;
+    size_t nverts, i, j, f, hits = 0;
+    int ncpu = 4;
+    int k, c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:P:")) != -1) {
+	switch (c) {
+	    case 'n':
+		ngrid = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'P':
+		ncpu = atoi(bu_optarg);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (ngrid < 2)
+	ngrid = 2;
+    if (nrays < 1)
+	nrays = 1;
+    if (ncpu < 1)
+	ncpu = 1;
+
+    /* a latitude/longitude sphere, lumpy enough to have a shape */
+    nverts = 2 + (LP_NSEG - 1) * LP_NSEG;
+    verts = (fastf_t *)bu_calloc(nverts * 3, sizeof(fastf_t), "verts");
+    faces = (int *)bu_calloc(2 * LP_NSEG * (LP_NSEG - 1) * 3, sizeof(int), "faces");
+    VSET(&verts[0], 0.0, 0.0, 30.0);
+    VSET(&verts[3], 0.0, 0.0, -24.0);
+    for (i = 1; i < LP_NSEG; i++) {
+	fastf_t phi = M_PI * (fastf_t)i / (fastf_t)LP_NSEG;
+	for (j = 0; j < LP_NSEG; j++) {
+	    fastf_t theta = M_2PI * (fastf_t)j / (fastf_t)LP_NSEG;
+	    fastf_t r = 20.0 + 6.0 * sin(3.0 * theta) * sin(phi) + 3.0 * cos(2.0 * phi);
+	    size_t v = 2 + (i - 1) * LP_NSEG + j;
+	    VSET(&verts[v*3], 1.5 * r * sin(phi) * cos(theta), r * sin(phi) * sin(theta), r * cos(phi));
+	}
+    }
+    f = 0;
+    for (j = 0; j < LP_NSEG; j++) {
+	size_t jn = (j + 1) % LP_NSEG;
+	faces[f*3+0] = 0;
+	faces[f*3+1] = (int)(2 + j);
+	faces[f*3+2] = (int)(2 + jn);
+	f++;
+	faces[f*3+0] = 1;
+	faces[f*3+1] = (int)(2 + (LP_NSEG - 2) * LP_NSEG + jn);
+	faces[f*3+2] = (int)(2 + (LP_NSEG - 2) * LP_NSEG + j);
+	f++;
+	for (i = 1; i + 1 < LP_NSEG; i++) {
+	    int a = (int)(2 + (i - 1) * LP_NSEG + j);
+	    int b = (int)(2 + (i - 1) * LP_NSEG + jn);
+	    int d = (int)(2 + i * LP_NSEG + j);
+	    int e = (int)(2 + i * LP_NSEG + jn);
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = d;
+	    faces[f*3+2] = e;
+	    f++;
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = e;
+	    faces[f*3+2] = b;
+	    f++;
+	}
+    }
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+    if (mk_bot(wdbp, "lump.s", RT_BOT_SOLID, RT_BOT_CCW, 0, nverts, f, verts, faces, NULL, NULL))
+	bu_exit(1, "mk_bot failed [FAIL]\n");
+    bu_free(verts, "verts");
+    bu_free(faces, "faces");
+
+    /* a grid of regions, each turning the lump a little its own way;
+     * the strip of rays runs along the column at x = 0
+     */
+    BU_LIST_INIT(&all.l);
+    for (i = 0; i < ngrid; i++) {
+	for (j = 0; j < ngrid; j++) {
+	    struct wmember wm;
+	    struct bu_vls name = BU_VLS_INIT_ZERO;
+	    mat_t m;
+
+	    bn_mat_angles(m, 0.0, 0.0, 7.0 * (fastf_t)(i * ngrid + j));
+	    MAT_DELTAS(m, LP_SPACING * (fastf_t)i, LP_SPACING * ((fastf_t)j - 0.5 * (fastf_t)(ngrid - 1)), 0.0);
+
+	    bu_vls_sprintf(&name, "g%zu_%zu.r", i, j);
+	    BU_LIST_INIT(&wm.l);
+	    (void)mk_addmember("lump.s", &wm.l, m, WMOP_UNION);
+	    if (mk_lcomb(wdbp, bu_vls_cstr(&name), &wm, 1, NULL, NULL, NULL, 0))
+		bu_exit(1, "mk_lcomb failed [FAIL]\n");
+	    (void)mk_addmember(bu_vls_cstr(&name), &all.l, NULL, WMOP_UNION);
+	    bu_vls_free(&name);
+	}
+    }
+    if (mk_lcomb(wdbp, "all.g", &all, 0, NULL, NULL, NULL, 0))
+	bu_exit(1, "mk_lcomb failed [FAIL]\n");
+
+    lazy = lp_prep_and_shoot(dbip, 1, ngrid, nrays, ncpu, &t_lazy);
+    eager = lp_prep_and_shoot(dbip, 0, ngrid, nrays, ncpu, &t_eager);
+
+    for (i = 0; i < nrays; i++) {
+	if (lazy[i].nparts != eager[i].nparts)
+	    bu_exit(1, "ray %zu: %d partitions prepped lazily but %d prepped up front [FAIL]\n",
+		    i, lazy[i].nparts, eager[i].nparts);
+	if (!lazy[i].nparts)
+	    continue;
+	for (k = 0; k < lazy[i].nparts && k < LP_MAX_PARTS; k++) {
+	    if (lazy[i].reg[k] != eager[i].reg[k]
+		|| !NEAR_EQUAL(lazy[i].in[k], eager[i].in[k], LP_TOL)
+		|| !NEAR_EQUAL(lazy[i].out[k], eager[i].out[k], LP_TOL))
+		bu_exit(1, "ray %zu partition %d: region %ld %g,%g prepped lazily but region %ld %g,%g prepped up front [FAIL]\n",
+			i, k, lazy[i].reg[k], lazy[i].in[k], lazy[i].out[k],
+			eager[i].reg[k], eager[i].in[k], eager[i].out[k]);
+	}
+	if (!VNEAR_EQUAL(lazy[i].normal, eager[i].normal, LP_TOL))
+	    bu_exit(1, "ray %zu: normal %g %g %g prepped lazily but %g %g %g prepped up front [FAIL]\n",
+		    i, V3ARGS(lazy[i].normal), V3ARGS(eager[i].normal));
+	hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit the lumps [FAIL]\n");
+
+    bu_free(lazy, "lazy prep rays");
+    bu_free(eager, "lazy prep rays");
+    db_close(dbip);
+
+    bu_log("%zu solids, %zu of %zu rays hit: prep and shoot lazily %.4f sec, up front %.4f sec [PASS]\n",
+	   ngrid * ngrid, hits, nrays, t_lazy, t_eager);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,250 @@
+/*                  M E T A B A L L _ I N D E X . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/metaball_index.c
+ *
+ * Prep a blob and an isopotential metaball with many points twice,
+ * once with rti_metaball_minindex set so high that every point is
+ * summed at every step and once with the point index, and check that
+ * a set of rays through them gets the same partitions from both.
+ *
+ * Usage: rt_metaball_index [-n points] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define MB_MAX_PARTS 32	/* partitions recorded per ray */
+#define MB_TOL 1.0e-6
+
+struct mb_ray {
+    int nparts;
+    fastf_t in[MB_MAX_PARTS];
+    fastf_t out[MB_MAX_PARTS];
+};
+
+
+static int
+mb_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct mb_ray *r = (struct mb_ray *)ap->a_uptr;
+    struct partition *pp;
+
+    r->nparts = 0;
+    for (pp = part_head->pt_forw; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < MB_MAX_PARTS) {
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+mb_miss(struct application *ap)
+{
+    struct mb_ray *r = (struct mb_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Prep name with the given rti_metaball_minindex and shoot nrays
+ * rays from a fixed sequence across its bounding box.
+ */
+static struct mb_ray *
+mb_prep_and_shoot(struct db_i *dbip, const char *name, size_t minindex, size_t nrays, double *secs)
+{
+    struct mb_ray *rays;
+    struct application ap;
+    struct resource res;
+    struct rt_i *rtip;
+    int64_t start;
+    size_t i;
+
+    rtip = rt_i_create(dbip);
+    rtip->rti_metaball_minindex = minindex;
+    if (rt_gettree(rtip, name) < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(rtip);
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_hit = mb_hit;
+    ap.a_miss = mb_miss;
+    ap.a_onehit = 0;
+
+    rays = (struct mb_ray *)bu_calloc(nrays, sizeof(struct mb_ray), "metaball rays");
+    start = bu_gettime();
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+	fastf_t u = (fastf_t)((i * 7919) % nrays) / (fastf_t)nrays;
+	fastf_t v = (fastf_t)((i * 104729) % nrays) / (fastf_t)nrays;
+	fastf_t w = (fastf_t)((i * 1299709) % nrays) / (fastf_t)nrays;
+
+	/* aim at the middle half of the box, where the points are */
+	VSET(target,
+	     rtip->mdl_min[X] + (0.25 + 0.5 * u) * (rtip->mdl_max[X] - rtip->mdl_min[X]),
+	     rtip->mdl_min[Y] + (0.25 + 0.5 * v) * (rtip->mdl_max[Y] - rtip->mdl_min[Y]),
+	     rtip->mdl_min[Z] + (0.25 + 0.5 * w) * (rtip->mdl_max[Z] - rtip->mdl_min[Z]));
+	if (i % 2) {
+	    VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+	} else {
+	    VSET(ap.a_ray.r_dir, u - 0.5, v - 0.5, w - 0.5);
+	    if (VNEAR_ZERO(ap.a_ray.r_dir, SMALL_FASTF))
+		VSET(ap.a_ray.r_dir, 1.0, 1.0, 1.0);
+	    VUNITIZE(ap.a_ray.r_dir);
+	}
+	VJOIN1(ap.a_ray.r_pt, target, -2.0 * rtip->rti_radius, ap.a_ray.r_dir);
+	ap.a_uptr = (void *)&rays[i];
+	(void)rt_shootray(&ap);
+    }
+    *secs = (double)(bu_gettime() - start) / 1.0e6;
+
+    rt_i_destroy(rtip);
+    return rays;
+}
+
+
+static size_t
+mb_compare(struct db_i *dbip, const char *name, size_t nrays)
+{
+    struct mb_ray *summed, *indexed;
+    double t_summed, t_indexed;
+    size_t i, hits = 0;
+    int j;
+
+    summed = mb_prep_and_shoot(dbip, name, (size_t)1000000000, nrays, &t_summed);
+    indexed = mb_prep_and_shoot(dbip, name, 0, nrays, &t_indexed);
+
+    for (i = 0; i < nrays; i++) {
+	if (summed[i].nparts != indexed[i].nparts)
+	    bu_exit(1, "%s ray %zu: %d partitions summed but %d indexed [FAIL]\n",
+		    name, i, summed[i].nparts, indexed[i].nparts);
+	for (j = 0; j < summed[i].nparts && j < MB_MAX_PARTS; j++) {
+	    if (!NEAR_EQUAL(summed[i].in[j], indexed[i].in[j], MB_TOL)
+		|| !NEAR_EQUAL(summed[i].out[j], indexed[i].out[j], MB_TOL))
+		bu_exit(1, "%s ray %zu partition %d: %g,%g summed but %g,%g indexed [FAIL]\n", name, i, j,
+			summed[i].in[j], summed[i].out[j], indexed[i].in[j], indexed[i].out[j]);
+	}
+	if (summed[i].nparts)
+	    hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit %s [FAIL]\n", name);
+
+    bu_free(summed, "metaball rays");
+    bu_free(indexed, "metaball rays");
+
+    bu_log("%s: %zu of %zu rays hit: summed %.4f sec, indexed %.4f sec\n",
+	   name, hits, nrays, t_summed, t_indexed);
+    return hits;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n points] [-r rays]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    fastf_t *pts;
+    const fastf_t **ptp;
+    size_t npts = 300;
+    size_t nrays = 2000;
+    size_t i;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:")) != -1) {
+	switch (c) {
+	    case 'n':
+		npts = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (npts < 2)
+	npts = 2;
+    if (nrays < 1)
+	nrays = 1;
+
+    /* points scattered through a flattened box: x, y, z, field
+     * strength and blobbiness */
+    pts = (fastf_t *)bu_calloc(npts * 5, sizeof(fastf_t), "metaball points");
+    ptp = (const fastf_t **)bu_calloc(npts, sizeof(fastf_t *), "metaball point pointers");
+    for (i = 0; i < npts; i++) {
+	fastf_t *p = &pts[i * 5];
+
+	VSET(p, 200.0 * ((fastf_t)((i * 7919) % 1000) / 1000.0 - 0.5),
+	     200.0 * ((fastf_t)((i * 104729) % 1000) / 1000.0 - 0.5),
+	     50.0 * ((fastf_t)((i * 1299709) % 1000) / 1000.0 - 0.5));
+	p[3] = 3.0 + (fastf_t)(i % 7) * 0.5;
+	p[4] = 0.5 + (fastf_t)(i % 5) * 0.4;
+	ptp[i] = p;
+    }
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+    if (mk_metaball(wdbp, "blob.s", npts, METABALL_BLOB, 1.0, ptp))
+	bu_exit(1, "mk_metaball failed [FAIL]\n");
+    if (mk_metaball(wdbp, "iso.s", npts, METABALL_ISOPOTENTIAL, 1.0, ptp))
+	bu_exit(1, "mk_metaball failed [FAIL]\n");
+    bu_free(ptp, "metaball point pointers");
+    bu_free(pts, "metaball points");
+
+    (void)mb_compare(dbip, "blob.s", nrays);
+    (void)mb_compare(dbip, "iso.s", nrays);
+    db_close(dbip);
+
+    bu_log("%zu points, same partitions summed and indexed [PASS]\n", npts);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,321 @@
+/*                       N M G _ B V H . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/nmg_bvh.c
+ *
+ * Prep an NMG cube whose sides are split into a grid of quads and
+ * check, ray by ray, the faces its shell face BVH hands to
+ * nmg_isect_ray_shell() against an exhaustive walk of the shell that
+ * applies the bounding box test of isect_ray_faceuse().  Every face
+ * the walk accepts must be a candidate, and the candidates must come
+ * back in fu_hd order.
+ *
+ * The face boxes are flat and share their edges, so BVH node bounds
+ * fall exactly on face edges.  Rays are shot along the grid lines,
+ * through the shared vertices, and just inside and outside the
+ * distance tolerance around them, as well as in random directions.
+ *
+ * Usage: rt_nmg_bvh [-n grid size] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/getopt.h"
+#include "bu/ptbl.h"
+#include "bg/plane.h"
+#include "nmg.h"
+#include "raytrace.h"
+#include "rt/primitives/nmg.h"
+
+
+#define NB_SIZE 100.0	/* cube edge length */
+
+#define NB_IDX(n, i, j, k) (((i) * ((n) + 1) + (j)) * ((n) + 1) + (k))
+
+
+/* the bounding box test of isect_ray_faceuse() */
+static int
+face_accepts(const struct faceuse *fu, const struct xray *rp, const struct bn_tol *tol)
+{
+    const struct face *fp = fu->f_p;
+    fastf_t dist;
+    point_t hit_pt;
+    vect_t dir;
+
+    if (bg_isect_line3_plane(&dist, rp->r_pt, rp->r_dir, fp->g.plane_p->N, tol) < 1)
+	return 0;
+    VMOVE(dir, rp->r_dir);
+    VUNITIZE(dir);
+    dist *= MAGNITUDE(rp->r_dir);
+    VJOIN1(hit_pt, rp->r_pt, dist, dir);
+    return !V3PNT_OUT_RPP_TOL(hit_pt, fp->min_pt, fp->max_pt, tol->dist);
+}
+
+
+/* Build the n x n x n grid cube as a single shell of m */
+static struct shell *
+cube_shell(struct model *m, size_t n, const struct bn_tol *tol)
+{
+    struct vertex **lattice;
+    struct nmgregion *r;
+    struct shell *s;
+    struct faceuse *fu;
+    size_t nlat = (n + 1) * (n + 1) * (n + 1);
+    size_t a, side, u, v, i;
+    fastf_t step = NB_SIZE / (fastf_t)n;
+
+    lattice = (struct vertex **)bu_calloc(nlat, sizeof(struct vertex *), "nmg bvh lattice");
+    r = nmg_mrsv(m);
+    s = BU_LIST_FIRST(shell, &r->s_hd);
+
+    for (a = 0; a < 3; a++) {
+	size_t b = (a + 1) % 3, d = (a + 2) % 3;
+	for (side = 0; side < 2; side++) {
+	    for (u = 0; u < n; u++) {
+		for (v = 0; v < n; v++) {
+		    struct vertex **vt[4];
+		    size_t c[4][3];
+		    size_t q;
+
+		    for (q = 0; q < 4; q++) {
+			c[q][a] = side * n;
+			c[q][b] = u + ((q == 1 || q == 2) ? 1 : 0);
+			c[q][d] = v + ((q >= 2) ? 1 : 0);
+		    }
+		    for (q = 0; q < 4; q++) {
+			/* wind the low side the other way round */
+			size_t o = side ? q : 3 - q;
+			vt[q] = &lattice[NB_IDX(n, c[o][X], c[o][Y], c[o][Z])];
+		    }
+		    (void)nmg_cmface(s, vt, 4);
+		}
+	    }
+	}
+    }
+
+    for (i = 0; i < nlat; i++) {
+	point_t pt;
+	if (!lattice[i] || lattice[i]->vg_p)
+	    continue;
+	VSET(pt,
+	     (fastf_t)(i / ((n + 1) * (n + 1))) * step,
+	     (fastf_t)((i / (n + 1)) % (n + 1)) * step,
+	     (fastf_t)(i % (n + 1)) * step);
+	nmg_vertex_gv(lattice[i], pt);
+    }
+    for (BU_LIST_FOR(fu, faceuse, &s->fu_hd)) {
+	if (fu->orientation != OT_SAME)
+	    continue;
+	if (nmg_fu_planeeqn(fu, tol))
+	    bu_exit(1, "nmg_fu_planeeqn failed [FAIL]\n");
+    }
+    nmg_region_a(r, tol);
+
+    bu_free(lattice, "nmg bvh lattice");
+    return s;
+}
+
+
+static unsigned long nb_seed = 1;
+
+static fastf_t
+nb_rand(void)
+{
+    nb_seed = nb_seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (fastf_t)((nb_seed >> 11) & 0xfffff) / (fastf_t)0x100000;
+}
+
+
+/* Compare the BVH candidates for one ray with the exhaustive walk.
+ * Returns the number of candidates. */
+static size_t
+check_ray(struct soltab *stp, const struct shell *s, struct faceuse **all, size_t nall,
+	  struct xray *rp, const struct bn_tol *tol, size_t rayno)
+{
+    struct bu_ptbl faces;
+    size_t i, j, ncand;
+
+    bu_ptbl_init(&faces, 64, "nmg bvh candidates");
+    if (!rt_nmg_shell_faces(stp, s, rp, &faces))
+	bu_exit(1, "ray %zu: shell has no face index [FAIL]\n", rayno);
+    ncand = BU_PTBL_LEN(&faces);
+
+    /* candidates are faces of s, in fu_hd order, each once */
+    for (i = j = 0; i < ncand; i++, j++) {
+	const struct faceuse *fu = (const struct faceuse *)BU_PTBL_GET(&faces, i);
+	while (j < nall && all[j] != fu)
+	    j++;
+	if (j == nall)
+	    bu_exit(1, "ray %zu: candidate %zu is not a face of the shell or is out of fu_hd order [FAIL]\n",
+		    rayno, i);
+    }
+
+    /* and include every face the exhaustive walk accepts */
+    for (i = 0; i < nall; i++) {
+	if (!face_accepts(all[i], rp, tol))
+	    continue;
+	if (bu_ptbl_locate(&faces, (long *)all[i]) < 0)
+	    bu_exit(1, "ray %zu (%g %g %g -> %g %g %g): face %ld with box %g %g %g, %g %g %g missed by the bvh [FAIL]\n",
+		    rayno, V3ARGS(rp->r_pt), V3ARGS(rp->r_dir), all[i]->f_p->index,
+		    V3ARGS(all[i]->f_p->min_pt), V3ARGS(all[i]->f_p->max_pt));
+    }
+
+    bu_ptbl_free(&faces);
+    return ncand;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    static const char *usage = "Usage: %s [-n grid size] [-r rays]\n";
+    struct db_i *dbip;
+    struct rt_i *rtip;
+    struct soltab *stp;
+    struct rt_db_internal intern;
+    struct model *m;
+    struct shell *s;
+    struct faceuse *fu;
+    struct faceuse **all;
+    struct xray ray;
+    size_t n = 8, nrandom = 2000, nall = 0, nrays = 0, ncand = 0;
+    size_t a, u, v, i;
+    fastf_t step;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:")) != -1) {
+	switch (c) {
+	    case 'n':
+		n = (size_t)strtol(bu_optarg, NULL, 10);
+		break;
+	    case 'r':
+		nrandom = (size_t)strtol(bu_optarg, NULL, 10);
+		break;
+	    default:
+		bu_exit(1, usage, argv[0]);
+	}
+    }
+    if (n < 2)
+	bu_exit(1, usage, argv[0]);
+    step = NB_SIZE / (fastf_t)n;
+
+    dbip = db_create_inmem();
+    rtip = rt_i_create(dbip);
+
+    m = nmg_mm();
+    s = cube_shell(m, n, &rtip->rti_tol);
+
+    all = (struct faceuse **)bu_calloc(6 * n * n, sizeof(struct faceuse *), "nmg bvh faces");
+    for (BU_LIST_FOR(fu, faceuse, &s->fu_hd)) {
+	if (fu->orientation != OT_OPPOSITE)
+	    all[nall++] = fu;
+    }
+    if (nall != 6 * n * n)
+	bu_exit(1, "%zu faceuses in the cube, not %zu [FAIL]\n", nall, 6 * n * n);
+
+    /* prep takes over the model; s and all[] stay valid until the free */
+    BU_ALLOC(stp, struct soltab);
+    stp->l.magic = RT_SOLTAB_MAGIC;
+    stp->st_id = ID_NMG;
+    stp->st_meth = &OBJ[ID_NMG];
+    stp->st_rtip = rtip;
+    RT_DB_INTERNAL_INIT(&intern);
+    intern.idb_major_type = DB5_MAJORTYPE_BRLCAD;
+    intern.idb_type = ID_NMG;
+    intern.idb_meth = &OBJ[ID_NMG];
+    intern.idb_ptr = (void *)m;
+    if (rt_obj_prep(stp, &intern, rtip))
+	bu_exit(1, "NMG prep failed [FAIL]\n");
+
+    /* along the grid lines, through the shared face vertices and edges
+     * and just either side of the tolerance around them */
+    for (a = 0; a < 3; a++) {
+	size_t b = (a + 1) % 3, d = (a + 2) % 3;
+	static const fastf_t offsets[] = {0.0, 0.5, -0.5, 0.999, -0.999, 1.5, -1.5};
+	for (u = 0; u <= n; u++) {
+	    for (v = 0; v <= n; v++) {
+		for (i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+		    VSETALL(ray.r_dir, 0.0);
+		    ray.r_dir[a] = (u + v) % 2 ? 1.0 : -1.0;
+		    ray.r_pt[a] = NB_SIZE * 0.5 - ray.r_dir[a] * NB_SIZE;
+		    ray.r_pt[b] = (fastf_t)u * step + offsets[i] * rtip->rti_tol.dist;
+		    ray.r_pt[d] = (fastf_t)v * step - offsets[i] * rtip->rti_tol.dist;
+		    ncand += check_ray(stp, s, all, nall, &ray, &rtip->rti_tol, nrays++);
+		}
+	    }
+	}
+    }
+
+    /* diagonally through lattice points on the surface */
+    for (u = 0; u <= n; u++) {
+	for (v = 0; v <= n; v++) {
+	    VSET(ray.r_pt, 0.0, (fastf_t)u * step, (fastf_t)v * step);
+	    VSET(ray.r_dir, 1.0, 1.0, 1.0);
+	    VUNITIZE(ray.r_dir);
+	    ncand += check_ray(stp, s, all, nall, &ray, &rtip->rti_tol, nrays++);
+	    VSET(ray.r_dir, 1.0, -1.0, 0.0);
+	    VUNITIZE(ray.r_dir);
+	    ncand += check_ray(stp, s, all, nall, &ray, &rtip->rti_tol, nrays++);
+	}
+    }
+
+    for (i = 0; i < nrandom; i++) {
+	VSET(ray.r_pt,
+	     (nb_rand() * 3.0 - 1.0) * NB_SIZE,
+	     (nb_rand() * 3.0 - 1.0) * NB_SIZE,
+	     (nb_rand() * 3.0 - 1.0) * NB_SIZE);
+	VSET(ray.r_dir, nb_rand() - 0.5, nb_rand() - 0.5, nb_rand() - 0.5);
+	if (VNEAR_ZERO(ray.r_dir, SMALL_FASTF))
+	    VSET(ray.r_dir, 0.0, 0.0, 1.0);
+	VUNITIZE(ray.r_dir);
+	ncand += check_ray(stp, s, all, nall, &ray, &rtip->rti_tol, nrays++);
+    }
+
+    /* the index must actually cull */
+    if (ncand * 4 > nall * nrays)
+	bu_exit(1, "%zu candidates for %zu rays over %zu faces [FAIL]\n", ncand, nrays, nall);
+
+    stp->st_meth->ft_free(stp);
+    bu_free(stp, "soltab");
+    bu_free(all, "nmg bvh faces");
+    rt_i_destroy(rtip);
+    db_close(dbip);
+
+    bu_log("%zu faces, %zu rays, %.1f candidates per ray [PASS]\n",
+	   nall, nrays, (double)ncand / (double)nrays);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
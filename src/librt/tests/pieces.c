@@ -0,0 +1,338 @@
+/*                        P I E C E S . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/pieces.c
+ *
+ * Prep a BoT, an ARS and a coiled pipe twice, once whole and once
+ * split into pieces that the space partitioning lists per cell, and
+ * check that a set of rays gets the same partitions from both, with
+ * and without a_onehit, and that the split solids are mostly shot
+ * piece by piece rather than whole.
+ *
+ * Usage: rt_pieces [-n sphere_segments] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+#include "../librt_private.h"
+
+
+#define PIECES_MAX_PARTS 32	/* partitions recorded per ray */
+#define PIECES_TOL 1.0e-6
+
+struct pieces_ray {
+    int nparts;
+    fastf_t in[PIECES_MAX_PARTS];
+    fastf_t out[PIECES_MAX_PARTS];
+};
+
+
+static int
+pieces_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct pieces_ray *r = (struct pieces_ray *)ap->a_uptr;
+    struct partition *pp;
+
+    r->nparts = 0;
+    for (pp = part_head->pt_forw; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < PIECES_MAX_PARTS) {
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+pieces_miss(struct application *ap)
+{
+    struct pieces_ray *r = (struct pieces_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Prep all.g with the given piece sizes and shoot nrays rays from a
+ * fixed sequence across the model, all hits and then first hits.
+ * The whole solid and piece shot counts go in *shots and *piece_shots.
+ */
+static struct pieces_ray *
+pieces_prep_and_shoot(struct db_i *dbip, size_t tris, size_t segs, size_t nrays, size_t *nwith, long *shots, long *piece_shots)
+{
+    struct pieces_ray *rays;
+    struct application ap;
+    struct resource res;
+    struct rt_i *rtip;
+    size_t i;
+
+    rtip = rt_i_create(dbip);
+    rtip->rti_bot_piece_tris = tris;
+    rtip->rti_pipe_piece_segs = segs;
+    if (rt_gettree(rtip, "all.g") < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(rtip);
+    *nwith = rtip->i->rti_nsolids_with_pieces;
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_hit = pieces_hit;
+    ap.a_miss = pieces_miss;
+    ap.a_logoverlap = rt_silent_logoverlap;	/* the coil runs through the BoT */
+
+    rays = (struct pieces_ray *)bu_calloc(2 * nrays, sizeof(struct pieces_ray), "pieces rays");
+    for (i = 0; i < 2 * nrays; i++) {
+	size_t n = i % nrays;
+	point_t target;
+	fastf_t u = (fastf_t)((n * 7919) % nrays) / (fastf_t)nrays;
+	fastf_t v = (fastf_t)((n * 104729) % nrays) / (fastf_t)nrays;
+	fastf_t w = (fastf_t)((n * 1299709) % nrays) / (fastf_t)nrays;
+
+	VSET(target,
+	     rtip->mdl_min[X] + u * (rtip->mdl_max[X] - rtip->mdl_min[X]),
+	     rtip->mdl_min[Y] + v * (rtip->mdl_max[Y] - rtip->mdl_min[Y]),
+	     rtip->mdl_min[Z] + w * (rtip->mdl_max[Z] - rtip->mdl_min[Z]));
+	switch (n % 3) {
+	    case 0:
+		VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+		break;
+	    case 1:
+		VSET(ap.a_ray.r_dir, -1.0, 0.0, 0.0);
+		break;
+	    default:
+		VSET(ap.a_ray.r_dir, u - 0.5, v - 0.5, w - 0.5);
+		if (VNEAR_ZERO(ap.a_ray.r_dir, SMALL_FASTF))
+		    VSET(ap.a_ray.r_dir, 1.0, 1.0, 1.0);
+		VUNITIZE(ap.a_ray.r_dir);
+	}
+	/* every fourth ray starts inside the model */
+	if (n % 4 == 3)
+	    VMOVE(ap.a_ray.r_pt, target);
+	else
+	    VJOIN1(ap.a_ray.r_pt, target, -2.0 * rtip->rti_radius, ap.a_ray.r_dir);
+	ap.a_onehit = (i >= nrays);
+	ap.a_uptr = (void *)&rays[i];
+	(void)rt_shootray(&ap);
+    }
+    *shots = res.re_shots;
+    *piece_shots = res.re_piece_shots;
+
+    rt_i_destroy(rtip);
+    return rays;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n sphere_segments] [-r rays]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct bu_list head;
+    struct wmember wm;
+    struct pieces_ray *whole, *split;
+    fastf_t *verts;
+    fastf_t **curves;
+    int *faces;
+    size_t nseg = 64;
+    size_t nrays = 20000;
+    size_t nverts, nfaces, i, j, f, hits = 0;
+    size_t nwhole, nsplit;
+    long whole_shots, split_shots, whole_piece_shots, split_piece_shots;
+    int k, c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:")) != -1) {
+	switch (c) {
+	    case 'n':
+		nseg = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (nseg < 8)
+	nseg = 8;
+    if (nrays < 1)
+	nrays = 1;
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+
+    /* a latitude/longitude sphere of radius 100 with a wavy equator */
+    nverts = 2 + (nseg - 1) * nseg;
+    nfaces = 2 * nseg * (nseg - 1);
+    verts = (fastf_t *)bu_calloc(nverts * 3, sizeof(fastf_t), "verts");
+    faces = (int *)bu_calloc(nfaces * 3, sizeof(int), "faces");
+    VSET(&verts[0], 0.0, 0.0, 100.0);
+    VSET(&verts[3], 0.0, 0.0, -100.0);
+    for (i = 1; i < nseg; i++) {
+	fastf_t phi = M_PI * (fastf_t)i / (fastf_t)nseg;
+	for (j = 0; j < nseg; j++) {
+	    fastf_t theta = 2.0 * M_PI * (fastf_t)j / (fastf_t)nseg;
+	    fastf_t rad = 100.0 * (1.0 + 0.3 * sin(5.0 * theta));
+	    size_t v = 2 + (i - 1) * nseg + j;
+	    VSET(&verts[v*3], rad * sin(phi) * cos(theta), 100.0 * sin(phi) * sin(theta), 100.0 * cos(phi));
+	}
+    }
+    f = 0;
+    for (j = 0; j < nseg; j++) {
+	size_t jn = (j + 1) % nseg;
+	faces[f*3+0] = 0;
+	faces[f*3+1] = (int)(2 + j);
+	faces[f*3+2] = (int)(2 + jn);
+	f++;
+	faces[f*3+0] = 1;
+	faces[f*3+1] = (int)(2 + (nseg - 2) * nseg + jn);
+	faces[f*3+2] = (int)(2 + (nseg - 2) * nseg + j);
+	f++;
+	for (i = 1; i + 1 < nseg; i++) {
+	    int a = (int)(2 + (i - 1) * nseg + j);
+	    int b = (int)(2 + (i - 1) * nseg + jn);
+	    int d = (int)(2 + i * nseg + j);
+	    int e = (int)(2 + i * nseg + jn);
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = d;
+	    faces[f*3+2] = e;
+	    f++;
+	    faces[f*3+0] = a;
+	    faces[f*3+1] = e;
+	    faces[f*3+2] = b;
+	    f++;
+	}
+    }
+    if (mk_bot(wdbp, "bot.s", RT_BOT_SOLID, RT_BOT_CCW, 0, nverts, f, verts, faces, NULL, NULL))
+	bu_exit(1, "mk_bot failed [FAIL]\n");
+    bu_free(verts, "verts");
+    bu_free(faces, "faces");
+
+    /* the same sphere as an ARS beside it, one curve per latitude,
+     * each closed by a copy of its first point
+     */
+    curves = (fastf_t **)bu_calloc(nseg + 1, sizeof(fastf_t *), "ars curves");
+    for (i = 0; i <= nseg; i++) {
+	fastf_t phi = M_PI * (fastf_t)i / (fastf_t)nseg;
+	curves[i] = (fastf_t *)bu_calloc((nseg + 1) * 3, sizeof(fastf_t), "ars curve");
+	for (j = 0; j < nseg; j++) {
+	    fastf_t theta = 2.0 * M_PI * (fastf_t)j / (fastf_t)nseg;
+	    VSET(&curves[i][j*3], 300.0 + 100.0 * sin(phi) * cos(theta), 100.0 * sin(phi) * sin(theta), 100.0 * cos(phi));
+	}
+	VMOVE(&curves[i][nseg*3], &curves[i][0]);
+    }
+    /* the export frees the curves */
+    if (mk_ars(wdbp, "ars.s", nseg + 1, nseg + 1, curves))
+	bu_exit(1, "mk_ars failed [FAIL]\n");
+
+    /* a coil around both */
+    mk_pipe_init(&head);
+    for (i = 0; i < 200; i++) {
+	point_t pt;
+	double id = (i % 4 == 1) ? 0.0 : 6.0;
+
+	VSET(pt, 150.0 + 250.0 * cos(i * 0.7), 250.0 * sin(i * 0.7), -150.0 + i * 1.5);
+	mk_add_pipe_pnt(&head, pt, 10.0, id, 25.0);
+    }
+    if (mk_pipe(wdbp, "pipe.s", &head))
+	bu_exit(1, "mk_pipe failed [FAIL]\n");
+    mk_pipe_free(&head);
+
+    BU_LIST_INIT(&wm.l);
+    (void)mk_addmember("bot.s", &wm.l, NULL, WMOP_UNION);
+    (void)mk_addmember("ars.s", &wm.l, NULL, WMOP_UNION);
+    (void)mk_addmember("pipe.s", &wm.l, NULL, WMOP_UNION);
+    if (mk_lcomb(wdbp, "all.g", &wm, 0, NULL, NULL, NULL, 0))
+	bu_exit(1, "mk_lcomb failed [FAIL]\n");
+
+    whole = pieces_prep_and_shoot(dbip, 0, 0, nrays, &nwhole, &whole_shots, &whole_piece_shots);
+    split = pieces_prep_and_shoot(dbip, 16, 2, nrays, &nsplit, &split_shots, &split_piece_shots);
+
+    if (nwhole != 0)
+	bu_exit(1, "%zu solids in pieces with pieces turned off [FAIL]\n", nwhole);
+    if (nsplit != 3)
+	bu_exit(1, "%zu solids in pieces, expected 3 [FAIL]\n", nsplit);
+    bu_log("whole: %ld shots, %ld piece shots; pieces: %ld shots, %ld piece shots\n",
+	   whole_shots, whole_piece_shots, split_shots, split_piece_shots);
+    if (whole_piece_shots != 0)
+	bu_exit(1, "%ld piece shots with pieces turned off [FAIL]\n", whole_piece_shots);
+    if (split_piece_shots == 0)
+	bu_exit(1, "no piece shots with every solid in pieces [FAIL]\n");
+    /* only rays starting inside a solid's box fall back to shooting
+     * it whole, and a quarter of the rays start inside the model
+     */
+    if (split_shots > whole_shots / 4)
+	bu_exit(1, "%ld whole shots of solids in pieces, more than %ld [FAIL]\n", split_shots, whole_shots / 4);
+
+    for (i = 0; i < 2 * nrays; i++) {
+	/* a first hit ray only promises where its first partition
+	 * starts, since overlaps not yet woven in can move its end
+	 */
+	int onehit = (i >= nrays);
+	int nparts = (onehit && whole[i].nparts) ? 1 : whole[i].nparts;
+
+	if ((!onehit && whole[i].nparts != split[i].nparts) || (!whole[i].nparts != !split[i].nparts))
+	    bu_exit(1, "ray %zu: %d partitions whole but %d in pieces [FAIL]\n",
+		    i, whole[i].nparts, split[i].nparts);
+	for (k = 0; k < nparts && k < PIECES_MAX_PARTS; k++) {
+	    if (!NEAR_EQUAL(whole[i].in[k], split[i].in[k], PIECES_TOL)
+		|| (!onehit && !NEAR_EQUAL(whole[i].out[k], split[i].out[k], PIECES_TOL)))
+		bu_exit(1, "ray %zu partition %d: %g,%g whole but %g,%g in pieces [FAIL]\n", i, k,
+			whole[i].in[k], whole[i].out[k], split[i].in[k], split[i].out[k]);
+	}
+	if (whole[i].nparts)
+	    hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit the model [FAIL]\n");
+
+    bu_free(whole, "pieces rays");
+    bu_free(split, "pieces rays");
+    db_close(dbip);
+
+    bu_log("%zu of %zu rays hit, same partitions whole and in pieces [PASS]\n", hits, 2 * nrays);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,231 @@
+/*                      P I P E _ B V H . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/pipe_bvh.c
+ *
+ * Prep a long coiled pipe twice, once with rti_pipe_minbvh set so
+ * high that its segments are walked and once with the segment BVH,
+ * and check that a set of rays through it gets the same partitions
+ * from both.  Some points change the outer diameter or make the pipe
+ * solid, so the discontinuous radius surfaces are shot too.
+ *
+ * Usage: rt_pipe_bvh [-n points] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define PIPE_MAX_PARTS 64	/* partitions recorded per ray */
+
+struct pipe_ray {
+    int nparts;
+    fastf_t in[PIPE_MAX_PARTS];
+    fastf_t out[PIPE_MAX_PARTS];
+};
+
+
+static int
+pipe_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct pipe_ray *r = (struct pipe_ray *)ap->a_uptr;
+    struct partition *pp;
+
+    r->nparts = 0;
+    for (pp = part_head->pt_forw; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < PIPE_MAX_PARTS) {
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+pipe_miss(struct application *ap)
+{
+    struct pipe_ray *r = (struct pipe_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Prep pipe.s with the given rti_pipe_minbvh and shoot nrays rays
+ * from a fixed sequence across its bounding box.
+ */
+static struct pipe_ray *
+pipe_prep_and_shoot(struct db_i *dbip, size_t minbvh, size_t nrays, double *secs)
+{
+    struct pipe_ray *rays;
+    struct application ap;
+    struct resource res;
+    struct rt_i *rtip;
+    int64_t start;
+    size_t i;
+
+    rtip = rt_i_create(dbip);
+    rtip->rti_pipe_minbvh = minbvh;
+    if (rt_gettree(rtip, "pipe.s") < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(rtip);
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_hit = pipe_hit;
+    ap.a_miss = pipe_miss;
+    ap.a_onehit = 0;
+
+    rays = (struct pipe_ray *)bu_calloc(nrays, sizeof(struct pipe_ray), "pipe rays");
+    start = bu_gettime();
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+	fastf_t u = (fastf_t)((i * 7919) % nrays) / (fastf_t)nrays;
+	fastf_t v = (fastf_t)((i * 104729) % nrays) / (fastf_t)nrays;
+	fastf_t w = (fastf_t)((i * 1299709) % nrays) / (fastf_t)nrays;
+
+	VSET(target,
+	     rtip->mdl_min[X] + u * (rtip->mdl_max[X] - rtip->mdl_min[X]),
+	     rtip->mdl_min[Y] + v * (rtip->mdl_max[Y] - rtip->mdl_min[Y]),
+	     rtip->mdl_min[Z] + w * (rtip->mdl_max[Z] - rtip->mdl_min[Z]));
+	switch (i % 3) {
+	    case 0:
+		VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+		break;
+	    case 1:
+		VSET(ap.a_ray.r_dir, -1.0, 0.0, 0.0);
+		break;
+	    default:
+		VSET(ap.a_ray.r_dir, u - 0.5, v - 0.5, w - 0.5);
+		if (VNEAR_ZERO(ap.a_ray.r_dir, SMALL_FASTF))
+		    VSET(ap.a_ray.r_dir, 1.0, 1.0, 1.0);
+		VUNITIZE(ap.a_ray.r_dir);
+	}
+	VJOIN1(ap.a_ray.r_pt, target, -2.0 * rtip->rti_radius, ap.a_ray.r_dir);
+	ap.a_uptr = (void *)&rays[i];
+	(void)rt_shootray(&ap);
+    }
+    *secs = (double)(bu_gettime() - start) / 1.0e6;
+
+    rt_i_destroy(rtip);
+    return rays;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n points] [-r rays]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct bu_list head;
+    struct pipe_ray *walked, *culled;
+    double t_walked, t_culled;
+    size_t npts = 400;
+    size_t nrays = 20000;
+    size_t i, hits = 0;
+    int j, c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:")) != -1) {
+	switch (c) {
+	    case 'n':
+		npts = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (npts < 3)
+	npts = 3;
+    if (nrays < 1)
+	nrays = 1;
+
+    /* a coil rising through z, bending at every point */
+    mk_pipe_init(&head);
+    for (i = 0; i < npts; i++) {
+	point_t pt;
+	double od = (i % 5 == 2) ? 14.0 : 10.0;
+	double id = (i % 4 == 1) ? 0.0 : 6.0;
+
+	VSET(pt, 100.0 * cos(i * 0.7) + i * 3.0, 100.0 * sin(i * 0.7), i * 10.0 + (i % 3) * 20.0);
+	mk_add_pipe_pnt(&head, pt, od, id, 25.0);
+    }
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+    if (mk_pipe(wdbp, "pipe.s", &head))
+	bu_exit(1, "mk_pipe failed [FAIL]\n");
+    mk_pipe_free(&head);
+
+    walked = pipe_prep_and_shoot(dbip, (size_t)1000000000, nrays, &t_walked);
+    culled = pipe_prep_and_shoot(dbip, 0, nrays, &t_culled);
+
+    for (i = 0; i < nrays; i++) {
+	if (walked[i].nparts != culled[i].nparts)
+	    bu_exit(1, "ray %zu: %d partitions walked but %d with the bvh [FAIL]\n",
+		    i, walked[i].nparts, culled[i].nparts);
+	for (j = 0; j < walked[i].nparts && j < PIPE_MAX_PARTS; j++) {
+	    if (!EQUAL(walked[i].in[j], culled[i].in[j]) || !EQUAL(walked[i].out[j], culled[i].out[j]))
+		bu_exit(1, "ray %zu partition %d: %g,%g walked but %g,%g with the bvh [FAIL]\n", i, j,
+			walked[i].in[j], walked[i].out[j], culled[i].in[j], culled[i].out[j]);
+	}
+	if (walked[i].nparts)
+	    hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit the pipe [FAIL]\n");
+
+    bu_free(walked, "pipe rays");
+    bu_free(culled, "pipe rays");
+    db_close(dbip);
+
+    bu_log("%zu points, %zu of %zu rays hit: walked %.4f sec, bvh %.4f sec [PASS]\n",
+	   npts, hits, nrays, t_walked, t_culled);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
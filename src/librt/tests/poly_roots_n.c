@@ -0,0 +1,253 @@
+/*                   P O L Y _ R O O T S _ N . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/poly_roots_n.c
+ *
+ * Build cubics and quartics from known roots, a mix of real roots and
+ * complex pairs, with a few other degrees and zero roots thrown in,
+ * and check that rt_poly_roots_n() finds the roots that were put in
+ * and returns the same root counts as rt_poly_roots().  Each
+ * polynomial solved on its own must get exactly the roots it got in
+ * the batch, as rt_eto_shot() and rt_eto_vshot() rely on.
+ *
+ * Usage: rt_poly_roots_n [-n polynomials]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "bu/malloc.h"
+#include "bn/poly.h"
+#include "raytrace.h"
+
+
+#define PR_TOL 1.0e-6
+
+
+static uint64_t pr_seed = 12345;
+
+/* uniform in [lo, hi) from a fixed sequence */
+static double
+pr_rand(double lo, double hi)
+{
+    pr_seed = pr_seed * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+    return lo + (hi - lo) * (double)(pr_seed >> 11) / 9007199254740992.0;
+}
+
+
+/* multiply p by (t - r) for a real root, or by the quadratic of the
+ * pair r +/- i*im */
+static void
+pr_mul_root(bn_poly_t *p, double r, double im)
+{
+    bn_poly_t f, q;
+
+    f.magic = BN_POLY_MAGIC;
+    if (ZERO(im)) {
+	f.dgr = 1;
+	f.cf[0] = 1.0;
+	f.cf[1] = -r;
+    } else {
+	f.dgr = 2;
+	f.cf[0] = 1.0;
+	f.cf[1] = -2.0 * r;
+	f.cf[2] = r * r + im * im;
+    }
+    bn_poly_mul(&q, p, &f);
+    *p = q;
+}
+
+
+/* a root in re/im that no root in found[] is close to, or -1 */
+static int
+pr_missing(const bn_complex_t *want, int nwant, const bn_complex_t *found, int nfound)
+{
+    int i, j;
+
+    for (i = 0; i < nwant; i++) {
+	double scale = 1.0 + bn_cx_ampl(&want[i]);
+
+	for (j = 0; j < nfound; j++) {
+	    double dr = want[i].re - found[j].re;
+	    double di = want[i].im - found[j].im;
+
+	    if (sqrt(dr * dr + di * di) <= PR_TOL * scale)
+		break;
+	}
+	if (j == nfound)
+	    return i;
+    }
+    return -1;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n polynomials]\n";
+    bn_poly_t *eqns, *batch, *single;
+    bn_complex_t (*want)[4];
+    bn_complex_t (*roots)[4];
+    bn_complex_t (*scalar)[4];
+    int *nwant, *nroots, *nscalar;
+    int64_t start;
+    double t_batch, t_single;
+    size_t n = 20000;
+    size_t i, mult = 0;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		n = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (n < 16)
+	n = 16;
+
+    eqns = (bn_poly_t *)bu_calloc(n, sizeof(bn_poly_t), "eqns");
+    batch = (bn_poly_t *)bu_calloc(n, sizeof(bn_poly_t), "batch eqns");
+    single = (bn_poly_t *)bu_calloc(n, sizeof(bn_poly_t), "single eqns");
+    want = (bn_complex_t (*)[4])bu_calloc(n, sizeof(bn_complex_t) * 4, "wanted roots");
+    roots = (bn_complex_t (*)[4])bu_calloc(n, sizeof(bn_complex_t) * 4, "batch roots");
+    scalar = (bn_complex_t (*)[4])bu_calloc(n, sizeof(bn_complex_t) * 4, "single roots");
+    nwant = (int *)bu_calloc(n, sizeof(int), "wanted counts");
+    nroots = (int *)bu_calloc(n, sizeof(int), "batch counts");
+    nscalar = (int *)bu_calloc(n, sizeof(int), "single counts");
+
+    for (i = 0; i < n; i++) {
+	bn_poly_t *p = &eqns[i];
+	int kind = (int)(i % 16);
+	int dgr = (kind < 9) ? 4 : (kind < 14) ? 3 : (kind == 14) ? 2 : 4;
+	double lead = pr_rand(0.5, 4.0) * ((i & 1) ? -1.0 : 1.0);
+	int k = 0;
+
+	p->magic = BN_POLY_MAGIC;
+	p->dgr = 0;
+	p->cf[0] = 1.0;
+
+	/* roots kept 0.1 apart so none are close to double */
+	while (k < dgr) {
+	    double r = pr_rand(-3.0, 3.0);
+	    double im = 0.0;
+	    int j;
+
+	    if (kind == 15 && k == 0)
+		r = 0.0;
+	    else if (dgr - k >= 2 && (kind % 3) != 0 && k == 0)
+		im = pr_rand(0.1, 2.0);
+	    else if (dgr - k >= 2 && kind == 4)
+		im = pr_rand(0.1, 2.0);
+
+	    for (j = 0; j < k; j++) {
+		if (fabs(want[i][j].re - r) < 0.1 && fabs(fabs(want[i][j].im) - im) < 0.1)
+		    break;
+	    }
+	    if (j < k)
+		continue;
+
+	    pr_mul_root(p, r, im);
+	    want[i][k].re = r;
+	    want[i][k++].im = im;
+	    if (!ZERO(im)) {
+		want[i][k].re = r;
+		want[i][k++].im = -im;
+	    }
+	}
+	nwant[i] = k;
+	bn_poly_scale(p, lead);
+    }
+
+    memcpy(batch, eqns, n * sizeof(bn_poly_t));
+    start = bu_gettime();
+    rt_poly_roots_n(n, batch, roots, nroots, "rt_poly_roots_n");
+    t_batch = (double)(bu_gettime() - start) / 1.0e6;
+
+    memcpy(single, eqns, n * sizeof(bn_poly_t));
+    start = bu_gettime();
+    for (i = 0; i < n; i++)
+	nscalar[i] = rt_poly_roots(&single[i], scalar[i], "rt_poly_roots");
+    t_single = (double)(bu_gettime() - start) / 1.0e6;
+
+    for (i = 0; i < n; i++) {
+	bn_poly_t alone = eqns[i];
+	bn_complex_t lone[4];
+	int nlone, m;
+
+	if (nroots[i] != nscalar[i])
+	    bu_exit(1, "poly %zu (degree %d): %d roots from rt_poly_roots_n but %d from rt_poly_roots [FAIL]\n",
+		    i, eqns[i].dgr, nroots[i], nscalar[i]);
+	if (nroots[i] != nwant[i])
+	    bu_exit(1, "poly %zu (degree %d): %d roots found, %d put in [FAIL]\n",
+		    i, eqns[i].dgr, nroots[i], nwant[i]);
+	m = pr_missing(want[i], nwant[i], roots[i], nroots[i]);
+	if (m >= 0)
+	    bu_exit(1, "poly %zu (degree %d): root %g%+gi not found [FAIL]\n",
+		    i, eqns[i].dgr, want[i][m].re, want[i][m].im);
+	rt_poly_roots_n(1, &alone, &lone, &nlone, "rt_poly_roots_n");
+	if (nlone != nroots[i])
+	    bu_exit(1, "poly %zu (degree %d): %d roots alone but %d in the batch [FAIL]\n",
+		    i, eqns[i].dgr, nlone, nroots[i]);
+	for (m = 0; m < nlone; m++) {
+	    if (!EQUAL(lone[m].re, roots[i][m].re) || !EQUAL(lone[m].im, roots[i][m].im))
+		bu_exit(1, "poly %zu (degree %d): root %g%+gi alone but %g%+gi in the batch [FAIL]\n",
+			i, eqns[i].dgr, lone[m].re, lone[m].im, roots[i][m].re, roots[i][m].im);
+	}
+	if (nwant[i] > 2)
+	    mult++;
+    }
+    if (!mult)
+	bu_exit(1, "no cubics or quartics were solved [FAIL]\n");
+
+    bu_free(eqns, "eqns");
+    bu_free(batch, "batch eqns");
+    bu_free(single, "single eqns");
+    bu_free(want, "wanted roots");
+    bu_free(roots, "batch roots");
+    bu_free(scalar, "single roots");
+    bu_free(nwant, "wanted counts");
+    bu_free(nroots, "batch counts");
+    bu_free(nscalar, "single counts");
+
+    bu_log("%zu polynomials, %zu cubics and quartics: batched %.4f sec, one at a time %.4f sec [PASS]\n",
+	   n, mult, t_batch, t_single);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,265 @@
+/*                     T E S S _ P R E P . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/tess_prep.c
+ *
+ * Extrude a star shaped sketch, which every tessellation gets exactly,
+ * and mark it "tess_prep=always".  Prep it with rti_tess_prep set to
+ * RT_TESS_PREP_EXACT, where the extrude must be shot, and left at the
+ * default, where its BoT must be, and check that a set of rays gets
+ * the same partitions from both.
+ *
+ * Usage: rt_tess_prep [-n points] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/env.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define TP_MAX_PARTS 8	/* partitions recorded per ray */
+#define TP_TOL 1.0e-5
+
+struct tp_ray {
+    int nparts;
+    int id;	/* st_id of the first partition's solid */
+    fastf_t in[TP_MAX_PARTS];
+    fastf_t out[TP_MAX_PARTS];
+};
+
+
+static int
+tp_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct tp_ray *r = (struct tp_ray *)ap->a_uptr;
+    struct partition *pp;
+
+    r->nparts = 0;
+    r->id = part_head->pt_forw->pt_inseg->seg_stp->st_id;
+    for (pp = part_head->pt_forw; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < TP_MAX_PARTS) {
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+tp_miss(struct application *ap)
+{
+    struct tp_ray *r = (struct tp_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Prep name with rti_tess_prep set to mode (or left as it is when
+ * mode is negative), shoot nrays rays from a fixed sequence across its
+ * bounding box, and check that every hit was on a solid of type id.
+ */
+static struct tp_ray *
+tp_prep_and_shoot(struct db_i *dbip, const char *name, int mode, int id, size_t nrays, double *secs)
+{
+    struct tp_ray *rays;
+    struct application ap;
+    struct resource res;
+    struct rt_i *rtip;
+    int64_t start;
+    size_t i;
+
+    rtip = rt_i_create(dbip);
+    if (mode >= 0)
+	rtip->rti_tess_prep = mode;
+    if (rt_gettree(rtip, name) < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(rtip);
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_hit = tp_hit;
+    ap.a_miss = tp_miss;
+    ap.a_onehit = 0;
+
+    rays = (struct tp_ray *)bu_calloc(nrays, sizeof(struct tp_ray), "tess_prep rays");
+    start = bu_gettime();
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+	fastf_t u = (fastf_t)((i * 7919) % nrays) / (fastf_t)nrays;
+	fastf_t v = (fastf_t)((i * 104729) % nrays) / (fastf_t)nrays;
+	fastf_t w = (fastf_t)((i * 1299709) % nrays) / (fastf_t)nrays;
+
+	VSET(target,
+	     rtip->mdl_min[X] + (0.0123 + 0.97 * u) * (rtip->mdl_max[X] - rtip->mdl_min[X]),
+	     rtip->mdl_min[Y] + (0.0371 + 0.93 * v) * (rtip->mdl_max[Y] - rtip->mdl_min[Y]),
+	     rtip->mdl_min[Z] + (0.0457 + 0.91 * w) * (rtip->mdl_max[Z] - rtip->mdl_min[Z]));
+	if (i % 2) {
+	    VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+	} else {
+	    VSET(ap.a_ray.r_dir, u - 0.5, v - 0.5 + 0.0017, w - 0.5 + 0.0029);
+	    VUNITIZE(ap.a_ray.r_dir);
+	}
+	VJOIN1(ap.a_ray.r_pt, target, -2.0 * rtip->rti_radius, ap.a_ray.r_dir);
+	ap.a_uptr = (void *)&rays[i];
+	(void)rt_shootray(&ap);
+
+	if (rays[i].nparts && rays[i].id != id)
+	    bu_exit(1, "%s ray %zu hit a solid of type %d, not %d [FAIL]\n", name, i, rays[i].id, id);
+    }
+    *secs = (double)(bu_gettime() - start) / 1.0e6;
+
+    rt_i_destroy(rtip);
+    return rays;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n points] [-r rays]\n";
+    struct rt_sketch_internal skt;
+    struct line_seg *lsegs;
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    struct tp_ray *exact, *tess;
+    point_t V;
+    vect_t h, u_vec, v_vec;
+    double t_exact, t_tess;
+    size_t npts = 96;
+    size_t nrays = 6000;
+    size_t i, hits = 0;
+    int j, c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:")) != -1) {
+	switch (c) {
+	    case 'n':
+		npts = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (npts < 6)
+	npts = 6;
+    npts &= ~(size_t)1;
+    if (nrays < 1)
+	nrays = 1;
+
+    /* the environment must not pick the mode for us */
+    bu_setenv("LIBRT_TESS_PREP", "", 1);
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+
+    /* a star with npts/2 points, all straight sides */
+    memset(&skt, 0, sizeof(skt));
+    skt.magic = RT_SKETCH_INTERNAL_MAGIC;
+    VSET(skt.V, 0.0, 0.0, 0.0);
+    VSET(skt.u_vec, 1.0, 0.0, 0.0);
+    VSET(skt.v_vec, 0.0, 1.0, 0.0);
+    skt.vert_count = npts;
+    skt.verts = (point2d_t *)bu_calloc(npts, sizeof(point2d_t), "star verts");
+    skt.curve.count = npts;
+    skt.curve.reverse = (int *)bu_calloc(npts, sizeof(int), "star reverse");
+    skt.curve.segment = (void **)bu_calloc(npts, sizeof(void *), "star segments");
+    lsegs = (struct line_seg *)bu_calloc(npts, sizeof(struct line_seg), "star sides");
+    for (i = 0; i < npts; i++) {
+	double a = M_2PI * (double)i / (double)npts;
+	double r = (i & 1) ? 60.0 : 100.0;
+
+	V2SET(skt.verts[i], r * cos(a), r * sin(a));
+	lsegs[i].magic = CURVE_LSEG_MAGIC;
+	lsegs[i].start = (int)i;
+	lsegs[i].end = (int)((i + 1) % npts);
+	skt.curve.segment[i] = (void *)&lsegs[i];
+    }
+    if (mk_sketch(wdbp, "star.sk", &skt))
+	bu_exit(1, "mk_sketch failed [FAIL]\n");
+    bu_free(skt.verts, "star verts");
+    bu_free(skt.curve.reverse, "star reverse");
+    bu_free(skt.curve.segment, "star segments");
+    bu_free(lsegs, "star sides");
+
+    VSET(V, 0.0, 0.0, 0.0);
+    VSET(h, 0.0, 0.0, 60.0);
+    VSET(u_vec, 1.0, 0.0, 0.0);
+    VSET(v_vec, 0.0, 1.0, 0.0);
+    if (mk_extrusion(wdbp, "star.s", "star.sk", V, h, u_vec, v_vec, 0))
+	bu_exit(1, "mk_extrusion failed [FAIL]\n");
+    if (db5_update_attribute("star.s", "tess_prep", "always", dbip) < 0)
+	bu_exit(1, "db5_update_attribute failed [FAIL]\n");
+
+    exact = tp_prep_and_shoot(dbip, "star.s", RT_TESS_PREP_EXACT, ID_EXTRUDE, nrays, &t_exact);
+    tess = tp_prep_and_shoot(dbip, "star.s", -1, ID_BOT, nrays, &t_tess);
+
+    for (i = 0; i < nrays; i++) {
+	if (exact[i].nparts != tess[i].nparts)
+	    bu_exit(1, "ray %zu: %d partitions from the extrude but %d from its BoT [FAIL]\n",
+		    i, exact[i].nparts, tess[i].nparts);
+	for (j = 0; j < exact[i].nparts && j < TP_MAX_PARTS; j++) {
+	    if (!NEAR_EQUAL(exact[i].in[j], tess[i].in[j], TP_TOL)
+		|| !NEAR_EQUAL(exact[i].out[j], tess[i].out[j], TP_TOL))
+		bu_exit(1, "ray %zu partition %d: %g,%g from the extrude but %g,%g from its BoT [FAIL]\n", i, j,
+			exact[i].in[j], exact[i].out[j], tess[i].in[j], tess[i].out[j]);
+	}
+	if (exact[i].nparts)
+	    hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit star.s [FAIL]\n");
+
+    bu_free(exact, "tess_prep rays");
+    bu_free(tess, "tess_prep rays");
+    db_close(dbip);
+
+    bu_log("%zu point star, %zu of %zu rays hit: extrude %.4f sec, BoT %.4f sec [PASS]\n",
+	   npts, hits, nrays, t_exact, t_tess);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -0,0 +1,285 @@
+/*                  V O X E L _ P Y R A M I D . C
+ * BRL-CAD
+ *
+ * Copyright (c) 2026 United States Government as represented by
+ * the U.S. Army Research Laboratory.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this file; see the file named COPYING for more
+ * information.
+ */
+/** @file librt/tests/voxel_pyramid.c
+ *
+ * Prep a VOL and an EBM holding a few large balls twice, once with
+ * rti_voxel_minpyramid set so high that every cell is stepped through
+ * and once with the brick occupancy pyramid, and check that a set of rays
+ * through them gets the same partitions from both.
+ *
+ * Usage: rt_voxel_pyramid [-n cells] [-r rays]
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bu/app.h"
+#include "bu/datetime.h"
+#include "bu/getopt.h"
+#include "raytrace.h"
+#include "wdb.h"
+
+
+#define VP_MAX_PARTS 32	/* partitions recorded per ray */
+#define VP_TOL 1.0e-6
+#define VP_BALLS 5
+
+struct vp_ray {
+    int nparts;
+    fastf_t in[VP_MAX_PARTS];
+    fastf_t out[VP_MAX_PARTS];
+};
+
+
+static int
+vp_hit(struct application *ap, struct partition *part_head, struct seg *UNUSED(segs))
+{
+    struct vp_ray *r = (struct vp_ray *)ap->a_uptr;
+    struct partition *pp;
+
+    r->nparts = 0;
+    for (pp = part_head->pt_forw; pp != part_head; pp = pp->pt_forw) {
+	if (r->nparts < VP_MAX_PARTS) {
+	    r->in[r->nparts] = pp->pt_inhit->hit_dist;
+	    r->out[r->nparts] = pp->pt_outhit->hit_dist;
+	}
+	r->nparts++;
+    }
+    return 1;
+}
+
+
+static int
+vp_miss(struct application *ap)
+{
+    struct vp_ray *r = (struct vp_ray *)ap->a_uptr;
+
+    r->nparts = 0;
+    return 0;
+}
+
+
+/* Prep name with the given rti_voxel_minpyramid and shoot nrays rays
+ * from a fixed sequence across its bounding box.
+ */
+static struct vp_ray *
+vp_prep_and_shoot(struct db_i *dbip, const char *name, size_t minpyramid, size_t nrays, double *secs)
+{
+    struct vp_ray *rays;
+    struct application ap;
+    struct resource res;
+    struct rt_i *rtip;
+    int64_t start;
+    size_t i;
+
+    rtip = rt_i_create(dbip);
+    rtip->rti_voxel_minpyramid = minpyramid;
+    if (rt_gettree(rtip, name) < 0)
+	bu_exit(1, "rt_gettree failed [FAIL]\n");
+    rt_prep(rtip);
+    memset(&res, 0, sizeof(res));
+    rt_init_resource(&res, 0, rtip);
+
+    RT_APPLICATION_INIT(&ap);
+    ap.a_rt_i = rtip;
+    ap.a_resource = &res;
+    ap.a_hit = vp_hit;
+    ap.a_miss = vp_miss;
+    ap.a_onehit = 0;
+
+    rays = (struct vp_ray *)bu_calloc(nrays, sizeof(struct vp_ray), "voxel rays");
+    start = bu_gettime();
+    for (i = 0; i < nrays; i++) {
+	point_t target;
+	fastf_t u = (fastf_t)((i * 7919) % nrays) / (fastf_t)nrays;
+	fastf_t v = (fastf_t)((i * 104729) % nrays) / (fastf_t)nrays;
+	fastf_t w = (fastf_t)((i * 1299709) % nrays) / (fastf_t)nrays;
+
+	/* kept off the cell corners, where a ray crosses two cell
+	 * boundaries at once and either order is right */
+	VSET(target,
+	     rtip->mdl_min[X] + (0.0123 + 0.97 * u) * (rtip->mdl_max[X] - rtip->mdl_min[X]),
+	     rtip->mdl_min[Y] + (0.0371 + 0.93 * v) * (rtip->mdl_max[Y] - rtip->mdl_min[Y]),
+	     rtip->mdl_min[Z] + (0.0457 + 0.91 * w) * (rtip->mdl_max[Z] - rtip->mdl_min[Z]));
+	switch (i % 3) {
+	    case 0:
+		VSET(ap.a_ray.r_dir, 0.0, 0.0, -1.0);
+		break;
+	    case 1:
+		VSET(ap.a_ray.r_dir, -1.0, 0.0, 0.0);
+		break;
+	    default:
+		VSET(ap.a_ray.r_dir, u - 0.5, v - 0.5 + 0.0017, w - 0.5 + 0.0029);
+		VUNITIZE(ap.a_ray.r_dir);
+	}
+	VJOIN1(ap.a_ray.r_pt, target, -2.0 * rtip->rti_radius, ap.a_ray.r_dir);
+	ap.a_uptr = (void *)&rays[i];
+	(void)rt_shootray(&ap);
+    }
+    *secs = (double)(bu_gettime() - start) / 1.0e6;
+
+    rt_i_destroy(rtip);
+    return rays;
+}
+
+
+static void
+vp_compare(struct db_i *dbip, const char *name, size_t nrays)
+{
+    struct vp_ray *walked, *skipped;
+    double t_walked, t_skipped;
+    size_t i, hits = 0;
+    int j;
+
+    walked = vp_prep_and_shoot(dbip, name, (size_t)-1, nrays, &t_walked);
+    skipped = vp_prep_and_shoot(dbip, name, 0, nrays, &t_skipped);
+
+    for (i = 0; i < nrays; i++) {
+	if (walked[i].nparts != skipped[i].nparts)
+	    bu_exit(1, "%s ray %zu: %d partitions walked but %d with the pyramid [FAIL]\n",
+		    name, i, walked[i].nparts, skipped[i].nparts);
+	for (j = 0; j < walked[i].nparts && j < VP_MAX_PARTS; j++) {
+	    if (!NEAR_EQUAL(walked[i].in[j], skipped[i].in[j], VP_TOL)
+		|| !NEAR_EQUAL(walked[i].out[j], skipped[i].out[j], VP_TOL))
+		bu_exit(1, "%s ray %zu partition %d: %g,%g walked but %g,%g with the pyramid [FAIL]\n", name, i, j,
+			walked[i].in[j], walked[i].out[j], skipped[i].in[j], skipped[i].out[j]);
+	}
+	if (walked[i].nparts)
+	    hits++;
+    }
+    if (!hits)
+	bu_exit(1, "no ray hit %s [FAIL]\n", name);
+
+    bu_free(walked, "voxel rays");
+    bu_free(skipped, "voxel rays");
+
+    bu_log("%s: %zu of %zu rays hit: walked %.4f sec, pyramid %.4f sec\n",
+	   name, hits, nrays, t_walked, t_skipped);
+}
+
+
+/* 1 if cell (x, y, z) of an n-cell grid is inside one of the balls */
+static int
+vp_inside(size_t n, size_t x, size_t y, size_t z)
+{
+    static const double ball[VP_BALLS][4] = {
+	{0.30, 0.30, 0.40, 0.20},
+	{0.70, 0.35, 0.60, 0.15},
+	{0.50, 0.75, 0.50, 0.22},
+	{0.15, 0.80, 0.20, 0.08},
+	{0.85, 0.85, 0.85, 0.10}
+    };
+    int b;
+
+    for (b = 0; b < VP_BALLS; b++) {
+	double dx = (x + 0.5) / n - ball[b][0];
+	double dy = (y + 0.5) / n - ball[b][1];
+	double dz = (z + 0.5) / n - ball[b][2];
+
+	if (dx * dx + dy * dy + dz * dz < ball[b][3] * ball[b][3])
+	    return 1;
+    }
+    return 0;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    const char * const USAGE = "Usage: %s [-n cells] [-r rays]\n";
+    struct db_i *dbip;
+    struct rt_wdb *wdbp;
+    unsigned char *cells;
+    vect_t cellsize;
+    mat_t mat;
+    size_t n = 96;
+    size_t nrays = 6000;
+    size_t x, y, z;
+    int c;
+
+    bu_setprogname(argv[0]);
+
+    while ((c = bu_getopt(argc, argv, "n:r:")) != -1) {
+	switch (c) {
+	    case 'n':
+		n = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    case 'r':
+		nrays = (size_t)strtoul(bu_optarg, NULL, 0);
+		break;
+	    default:
+		bu_exit(1, USAGE, argv[0]);
+	}
+    }
+    if (n < 16)
+	n = 16;
+    if (nrays < 1)
+	nrays = 1;
+
+    dbip = db_create_inmem();
+    wdbp = wdb_dbopen(dbip, RT_WDB_TYPE_DB_INMEM);
+
+    /* n^3 volume: the balls set to 200, a faint 20 haze elsewhere
+     * that is below the threshold */
+    cells = (unsigned char *)bu_malloc(n * n * n, "voxel cells");
+    for (z = 0; z < n; z++)
+	for (y = 0; y < n; y++)
+	    for (x = 0; x < n; x++)
+		cells[(z * n + y) * n + x] = vp_inside(n, x, y, z) ? 200 : 20;
+    if (mk_binunif(wdbp, "vol.data", cells, WDB_BINUNIF_UINT8, (long)(n * n * n)))
+	bu_exit(1, "mk_binunif failed [FAIL]\n");
+    VSET(cellsize, 1.0, 1.5, 0.75);
+    MAT_IDN(mat);
+    if (mk_vol(wdbp, "vol.s", RT_VOL_SRC_OBJ, "vol.data", n, n, n, 100, 255, cellsize, mat))
+	bu_exit(1, "mk_vol failed [FAIL]\n");
+    bu_free(cells, "voxel cells");
+
+    /* 4n x 4n bitmap: the balls' middle slice */
+    cells = (unsigned char *)bu_malloc(16 * n * n, "voxel cells");
+    for (y = 0; y < 4 * n; y++)
+	for (x = 0; x < 4 * n; x++)
+	    cells[y * 4 * n + x] = (unsigned char)vp_inside(4 * n, x, y, 2 * n);
+    if (mk_binunif(wdbp, "ebm.data", cells, WDB_BINUNIF_UINT8, (long)(16 * n * n)))
+	bu_exit(1, "mk_binunif failed [FAIL]\n");
+    if (mk_ebm_obj(wdbp, "ebm.s", "ebm.data", 4 * n, 4 * n, 40.0, mat))
+	bu_exit(1, "mk_ebm_obj failed [FAIL]\n");
+    bu_free(cells, "voxel cells");
+
+    vp_compare(dbip, "vol.s", nrays);
+    vp_compare(dbip, "ebm.s", nrays);
+    db_close(dbip);
+
+    bu_log("%zu cell grids, same partitions walked and with the pyramid [PASS]\n", n);
+    return 0;
+}
+
+
+/*
+ * Local Variables:
+ * mode: C
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * c-file-style: "stroustrup"
+ * End:
+ * ex: shiftwidth=4 tabstop=8
+ */
@@ -201,6 +201,55 @@ build_arbn(struct rt_db_internal *ip)
 }
 
 
+static void
+build_arbn32(struct rt_db_internal *ip)
+{
+    struct rt_arbn_internal *arbn;
+    static const fastf_t d = 100.0;	/* inscribed radius, mm */
+    int i;
+
+    BU_ALLOC(arbn, struct rt_arbn_internal);
+    arbn->magic = RT_ARBN_INTERNAL_MAGIC;
+
+    /* 32 faces tangent to a sphere, their normals spread over it on a
+     * golden-angle spiral */
+    arbn->neqn = 32;
+    arbn->eqn = (plane_t *)bu_malloc(arbn->neqn * sizeof(plane_t), "arbn eqn[]");
+
+    for (i = 0; i < 32; i++) {
+	fastf_t z = 1.0 - (2.0 * i + 1.0) / 32.0;
+	fastf_t r = sqrt(1.0 - z * z);
+	fastf_t a = 2.399963229728653 * i;
+
+	VSET(arbn->eqn[i], r * cos(a), r * sin(a), z);
+	arbn->eqn[i][3] = d;
+    }
+
+    init_internal(ip, ID_ARBN, arbn);
+}
+
+
+static void
+build_arb8(struct rt_db_internal *ip)
+{
+    struct rt_arb_internal *arb;
+    int i;
+
+    BU_ALLOC(arb, struct rt_arb_internal);
+    arb->magic = RT_ARB_INTERNAL_MAGIC;
+
+    /* a frustum: 200mm square base, 120mm square top, 150mm tall */
+    for (i = 0; i < 4; i++) {
+	fastf_t x = (i == 1 || i == 2) ? 1.0 : -1.0;
+	fastf_t y = (i >= 2) ? 1.0 : -1.0;
+	VSET(arb->pt[i], 100.0 * x, 100.0 * y, -75.0);
+	VSET(arb->pt[i + 4], 60.0 * x, 60.0 * y, 75.0);
+    }
+
+    init_internal(ip, ID_ARB8, arb);
+}
+
+
 static void
 build_hyp(struct rt_db_internal *ip)
 {
@@ -336,6 +385,8 @@ static const struct prim_case prim_cases[] = {
     { "ehy",      ID_EHY,      build_ehy },
     { "part",     ID_PARTICLE, build_part },
     { "arbn",     ID_ARBN,     build_arbn },
+    { "arbn32",   ID_ARBN,     build_arbn32 },
+    { "arb8",     ID_ARB8,     build_arb8 },
     { "hyp",      ID_HYP,      build_hyp },
     { "eto",      ID_ETO,      build_eto },
     { "superell", ID_SUPERELL, build_superell },
@@ -507,6 +507,16 @@ _rt_gettree_leaf(struct db_tree_state *tsp, const struct db_full_path *pathp, st
 
     RT_CK_DB_INTERNAL(ip);
 
+    /* A rigidly moved copy of a solid prepped already shoots that
+     * one's geometry, and needs no prep of its own.
+     */
+    if (rt_instance_prep(stp, ip, rtip) == 0)
+	goto prepped;
+
+    /* Or one whose full prep can wait for the first ray to reach it */
+    if (rt_lazy_prep(stp, ip, rtip) == 0)
+	goto prepped;
+
     /* init solid's maxima and minima */
     VSETALL(stp->st_max, -INFINITY);
     VSETALL(stp->st_min,  INFINITY);
@@ -534,6 +544,14 @@ _rt_gettree_leaf(struct db_tree_state *tsp, const struct db_full_path *pathp, st
 	return TREE_NULL;		/* BAD */
     }
 
+    /* Maybe shoot a tessellation of it instead; it keeps the
+     * analytic solid whenever that does not work out.
+     */
+    (void)rt_tess_prep(stp, ip, rtip, 1);
+
+    rt_instance_register(stp, ip, rtip);
+
+prepped:
     if (rtip->rti_dont_instance) {
 	/*
 	 * If instanced solid refs are not being compressed, then
@@ -631,7 +649,8 @@ rt_free_soltab(struct soltab *stp)
     RELEASE_SEMAPHORE_TREE(hash);	/* end critical section */
 
     if (stp->st_aradius > 0) {
-	if (stp->st_meth->ft_free)
+	/* a prototype's geometry is freed by the last of its instances */
+	if (!rt_instance_unshare(stp) && stp->st_meth->ft_free)
 	    stp->st_meth->ft_free(stp);
 	stp->st_aradius = 0;
     }
@@ -104,8 +104,8 @@ vshot_stub(struct soltab **stp, struct xray **rp, struct seg *segp, int n, struc
 	    /* skip call if solid table pointer is NULL */
 	    /* do scalar call, place results in segp array */
 	    ret = -1;
-	    if (OBJ[stp[i]->st_id].ft_shot) {
-		ret = OBJ[stp[i]->st_id].ft_shot(stp[i], rp[i], ap, &seghead);
+	    if (stp[i]->st_meth->ft_shot) {
+		ret = stp[i]->st_meth->ft_shot(stp[i], rp[i], ap, &seghead);
 	    }
 	    if (ret <= 0) {
 		segp[i].seg_stp=(struct soltab *) 0;
@@ -246,7 +246,7 @@ rt_vshootray(struct application *ap)
     BU_LIST_INIT(&finished_segs.l);
     ap->a_finished_segs_hdp = &finished_segs;
 
-    if (!BU_LIST_IS_INITIALIZED(&resp->re_parthead))
+    if (!BU_LIST_IS_INITIALIZED(&resp->re_solid_bitv))
 	rt_init_resource(resp, resp->re_cpu, rtip);
 
     resp->re_nshootray++;
@@ -306,23 +306,32 @@ rt_vshootray(struct application *ap)
     /* For each solid type present, batch-shoot all instances. */
     for (id = 1; id <= ID_MAX_SOLID; id++) {
 	int nsol = (int)rtip->i->rti_nsol_by_type[id];
+	int nvec, nother;
 	if (nsol <= 0)
 	    continue;
 	if (!OBJ[id].ft_vshot && !OBJ[id].ft_shot)
 	    continue;
 
+	/* Solids shot through other methods, instances of a prepped
+	 * prototype, go at the end and are shot one by one.
+	 */
+	nvec = 0;
+	nother = nsol;
 	for (i = 0; i < nsol; i++) {
 	    struct soltab *stp = rtip->i->rti_sol_by_type[id][i];
-	    ary_stp[i] = stp;
-	    ary_rp[i] = &ap->a_ray;
-	    ary_seg[i].seg_stp = SOLTAB_NULL;
+	    int j = (stp->st_meth == &OBJ[id]) ? nvec++ : --nother;
+	    ary_stp[j] = stp;
+	    ary_rp[j] = &ap->a_ray;
+	    ary_seg[j].seg_stp = SOLTAB_NULL;
 	    BU_BITSET(solidbits, stp->st_bit);	/* mark as shot */
 	}
 
 	resp->re_shots += nsol;
 
 	if (OBJ[id].ft_vshot && !vshoot_force_scalar()) {
-	    OBJ[id].ft_vshot(ary_stp, ary_rp, ary_seg, nsol, ap);
+	    if (nvec)
+		OBJ[id].ft_vshot(ary_stp, ary_rp, ary_seg, nvec, ap);
+	    vshot_stub(ary_stp + nvec, ary_rp + nvec, ary_seg + nvec, nsol - nvec, ap);
 	} else {
 	    vshot_stub(ary_stp, ary_rp, ary_seg, nsol, ap);
 	}
@@ -41,9 +41,12 @@
 #include "bio.h"
 
 #include "bu/app.h"
+#include "bu/datetime.h"
 #include "bu/debug.h"
 #include "bu/getopt.h"
 #include "bu/mime.h"
+#include "bu/ptbl.h"
+#include "bu/str.h"
 #include "bu/vls.h"
 #include "vmath.h"
 #include "raytrace.h"
@@ -72,6 +75,7 @@ extern int finalframe;		/* frame to halt at */
 /***** end variables shared with rt.c *****/
 
 int def_tree(register struct rt_i *rtip, const char **first_obj);
+static int rtuif_tree_list(register struct rt_i *rtip, int *treec, const char ***treev, const char **first_obj);
 void do_ae(double azim, double elev);
 void do_view_finalize(double azim, double elev);
 void res_pr(void);
@@ -312,13 +316,315 @@ int cm_orientation(const int argc, const char **argv)
 }
 
 
+/*
+ * Animation frames.  A script usually says "clean" and then repeats
+ * every "anim" command for each frame, so most of the animation table
+ * is the same from one frame to the next.  Rather than throwing the
+ * whole prep away, "clean" only marks the table for replacement and
+ * the "anim" commands after it are collected.  When the frame is
+ * rendered, anim_frame_prep() compares them with the commands the
+ * current prep was built from and unpreps and repreps just the
+ * regions under the objects whose animation changed.  Only those
+ * objects' entries in the animation table are replaced; the rest are
+ * left as the current prep was built from them.  "set anim_reprep=0"
+ * goes back to a full clean every frame.
+ */
+static int anim_reprep = 1;
+static int anim_clean_pending = 0;
+static int anim_full_only = 0;		/* the view drops regions at setup */
+static size_t anim_reprepped = 0;	/* solids reprepped since the last full prep */
+static struct bu_ptbl anim_applied = BU_PTBL_INIT_ZERO;	/* commands the prep was built from */
+static struct bu_ptbl anim_pending = BU_PTBL_INIT_ZERO;	/* commands since the deferred clean */
+static struct bu_ptbl anim_late = BU_PTBL_INIT_ZERO;	/* objects animated after their tree was loaded */
+static int anim_late_rooted = 0;	/* a rooted animation was, too */
+static const char *frame_prep_how = NULL;
+static int64_t frame_prep_usec = 0;
+
+
+static void
+anim_cmds_free(struct bu_ptbl *cmds)
+{
+    size_t i;
+
+    if (!BU_PTBL_IS_INITIALIZED(cmds))
+	return;
+    for (i = 0; i < BU_PTBL_LEN(cmds); i++)
+	bu_free((void *)BU_PTBL_GET(cmds, i), "anim cmd");
+    bu_ptbl_reset(cmds);
+}
+
+
+/* Add a copy of name to names unless it is there already */
+static void
+anim_names_add(struct bu_ptbl *names, const char *name)
+{
+    size_t i;
+
+    if (!BU_PTBL_IS_INITIALIZED(names))
+	bu_ptbl_init(names, 8, "anim names");
+    for (i = 0; i < BU_PTBL_LEN(names); i++) {
+	if (BU_STR_EQUAL((const char *)BU_PTBL_GET(names, i), name))
+	    return;
+    }
+    bu_ptbl_ins(names, (long *)bu_strdup(name));
+}
+
+
+static int
+anim_names_find(const struct bu_ptbl *names, const char *name)
+{
+    size_t i;
+
+    for (i = 0; BU_PTBL_IS_INITIALIZED(names) && i < BU_PTBL_LEN(names); i++) {
+	if (BU_STR_EQUAL((const char *)BU_PTBL_GET(names, i), name))
+	    return 1;
+    }
+    return 0;
+}
+
+
+static void
+anim_cmds_add(struct bu_ptbl *cmds, const int argc, const char **argv)
+{
+    struct bu_vls cmd = BU_VLS_INIT_ZERO;
+
+    if (!BU_PTBL_IS_INITIALIZED(cmds))
+	bu_ptbl_init(cmds, 64, "anim cmds");
+    bu_vls_from_argv(&cmd, argc, argv);
+    bu_ptbl_ins(cmds, (long *)bu_vls_strdup(&cmd));
+    bu_vls_free(&cmd);
+}
+
+
+/* Parse a saved "anim" command and add it to the database's table */
+static int
+anim_cmd_apply(struct db_i *dbip, const char *cmd)
+{
+    char *buf = bu_strdup(cmd);
+    char *argv[256];
+    size_t argc = bu_argv_from_string(argv, 255, buf);
+    int ret = db_parse_anim(dbip, (int)argc, (const char **)argv);
+
+    bu_free(buf, "anim cmd");
+    return ret;
+}
+
+
+/* Name of the object an "anim" command animates, or NULL if it is
+ * rooted and so moves everything */
+static const char *
+anim_cmd_object(const char *cmd, struct bu_vls *name)
+{
+    char *buf = bu_strdup(cmd);
+    char *argv[256];
+    size_t argc = bu_argv_from_string(argv, 255, buf);
+
+    bu_vls_trunc(name, 0);
+    if (argc > 1) {
+	const char *path = argv[1];
+	const char *last = strrchr(path, '/');
+
+	/* "/obj" on its own is a rooted animation */
+	if (!(path[0] == '/' && last == path))
+	    bu_vls_strcpy(name, last ? last + 1 : path);
+    }
+    bu_free(buf, "anim cmd");
+    return bu_vls_strlen(name) ? bu_vls_cstr(name) : NULL;
+}
+
+
+/* Number of times cmd is in cmds */
+static size_t
+anim_cmds_count(const struct bu_ptbl *cmds, const char *cmd)
+{
+    size_t i, n = 0;
+
+    if (!BU_PTBL_IS_INITIALIZED(cmds))
+	return 0;
+    for (i = 0; i < BU_PTBL_LEN(cmds); i++) {
+	if (BU_STR_EQUAL((const char *)BU_PTBL_GET(cmds, i), cmd))
+	    n++;
+    }
+    return n;
+}
+
+
+/* Make the collected commands the ones in effect */
+static void
+anim_cmds_commit(void)
+{
+    struct bu_ptbl tmp = anim_applied;
+
+    anim_applied = anim_pending;
+    anim_pending = tmp;
+    anim_cmds_free(&anim_pending);
+    anim_cmds_free(&anim_late);
+    anim_late_rooted = 0;
+    anim_clean_pending = 0;
+}
+
+
+/* Drop the animation table entries of one object */
+static void
+anim_free_object(struct db_i *dbip, const char *obj)
+{
+    struct directory *dp = db_lookup(dbip, obj, LOOKUP_QUIET);
+    struct animate *anp;
+
+    if (dp == RT_DIR_NULL)
+	return;
+    while ((anp = dp->d_animate) != ANIM_NULL) {
+	dp->d_animate = anp->an_forw;
+	db_free_1anim(anp);
+    }
+}
+
+
+/* Do the clean the script asked for in full and apply the collected
+ * commands, leaving the tree for def_tree() to load again */
+static void
+anim_flush_clean(struct rt_i *rtip, int view_clean)
+{
+    size_t i;
+
+    if (view_clean)
+	view_cleanup(rtip);
+    rt_clean(rtip);
+
+    for (i = 0; BU_PTBL_IS_INITIALIZED(&anim_pending) && i < BU_PTBL_LEN(&anim_pending); i++) {
+	if (anim_cmd_apply(rtip->rti_dbip, (const char *)BU_PTBL_GET(&anim_pending, i)) < 0)
+	    bu_log("anim:  %s failed\n", (const char *)BU_PTBL_GET(&anim_pending, i));
+    }
+    anim_cmds_commit();
+    anim_reprepped = 0;
+}
+
+
+/**
+ * Bring the prep up to date with a deferred "clean" and the "anim"
+ * commands that followed it.  Returns how it was done, for the
+ * per-frame report, or NULL if there was nothing to do.
+ */
+static const char *
+anim_frame_prep(struct rt_i *rtip)
+{
+    struct rt_reprep_obj_list objs;
+    struct bu_ptbl changed = BU_PTBL_INIT_ZERO;
+    struct bu_vls name = BU_VLS_INIT_ZERO;
+    const char **treev = NULL;
+    int treec = 0;
+    int full = anim_late_rooted;
+    size_t i, j;
+
+    if (!anim_clean_pending)
+	return NULL;
+
+    /* the prep after a full clean starts every CPU's random numbers
+     * over (see rt_init_resource()), so the frame is the same either
+     * way */
+    for (i = 0; i < BU_PTBL_LEN(&rtip->rti_resources); i++) {
+	struct resource *resp = (struct resource *)BU_PTBL_GET(&rtip->rti_resources, i);
+	if (resp)
+	    bn_rand_init(resp->re_randptr, MAX_PSW * resp->re_cpu);
+    }
+
+    /* objects whose table entries no longer match their prepped
+     * solids, and objects under commands that were added, dropped or
+     * changed */
+    bu_ptbl_init(&changed, 8, "anim changed");
+    for (i = 0; BU_PTBL_IS_INITIALIZED(&anim_late) && i < BU_PTBL_LEN(&anim_late); i++)
+	anim_names_add(&changed, (const char *)BU_PTBL_GET(&anim_late, i));
+    for (j = 0; j < 2 && !full; j++) {
+	struct bu_ptbl *a = j ? &anim_applied : &anim_pending;
+	struct bu_ptbl *b = j ? &anim_pending : &anim_applied;
+	for (i = 0; BU_PTBL_IS_INITIALIZED(a) && i < BU_PTBL_LEN(a) && !full; i++) {
+	    const char *cmd = (const char *)BU_PTBL_GET(a, i);
+	    const char *obj;
+	    if (anim_cmds_count(a, cmd) == anim_cmds_count(b, cmd))
+		continue;
+	    obj = anim_cmd_object(cmd, &name);
+	    if (!obj || db_lookup(rtip->rti_dbip, obj, LOOKUP_QUIET) == RT_DIR_NULL) {
+		full = 1;
+		break;
+	    }
+	    anim_names_add(&changed, obj);
+	}
+    }
+
+    if (!full && !BU_PTBL_LEN(&changed)) {
+	bu_vls_free(&name);
+	anim_cmds_commit();
+	bu_ptbl_free(&changed);
+	return "reused";
+    }
+
+    /* moved parts are only added to the existing cut tree, so build
+     * it afresh once as many solids as it holds have been moved */
+    if (full || anim_reprepped > rtip->stats.nsolids || !rtuif_tree_list(rtip, &treec, &treev, NULL)) {
+	bu_vls_free(&name);
+	anim_cmds_free(&changed);
+	bu_ptbl_free(&changed);
+	anim_flush_clean(rtip, 1);
+	return "full";
+    }
+
+    /* the whole view is set up again below; only the geometry is kept.
+     * Objects that did not change keep their animation table entries,
+     * which are the ones their prepped solids were built from. */
+    view_cleanup(rtip);
+    for (i = 0; i < BU_PTBL_LEN(&changed); i++)
+	anim_free_object(rtip->rti_dbip, (const char *)BU_PTBL_GET(&changed, i));
+    for (i = 0; BU_PTBL_IS_INITIALIZED(&anim_pending) && i < BU_PTBL_LEN(&anim_pending); i++) {
+	const char *cmd = (const char *)BU_PTBL_GET(&anim_pending, i);
+	const char *obj = anim_cmd_object(cmd, &name);
+	if (!obj || !anim_names_find(&changed, obj))
+	    continue;
+	if (anim_cmd_apply(rtip->rti_dbip, cmd) < 0)
+	    bu_log("anim:  %s failed\n", cmd);
+    }
+    bu_vls_free(&name);
+
+    memset(&objs, 0, sizeof(objs));
+    objs.ntopobjs = (size_t)treec;
+    objs.topobjs = (char **)treev;
+    objs.nunprepped = BU_PTBL_LEN(&changed);
+    objs.unprepped = (char **)changed.buffer;
+    if (rt_unprep(rtip, &objs) || rt_reprep(rtip, &objs)) {
+	anim_cmds_free(&changed);
+	bu_ptbl_free(&changed);
+	anim_flush_clean(rtip, 0);
+	return "full";
+    }
+    anim_cmds_commit();
+    anim_reprepped += objs.nsolids_unprepped;
+
+    view_setup(rtip);
+
+    if (rt_verbosity & VERBOSE_STATS)
+	bu_log("ANIMPREP: %zu object(s) changed, %zu of %zu regions reprepped\n",
+	       BU_PTBL_LEN(&changed), objs.nregions_unprepped, rtip->stats.nregions);
+
+    anim_cmds_free(&changed);
+    bu_ptbl_free(&changed);
+    return "delta";
+}
+
+
 int cm_end(const int UNUSED(argc), const char **UNUSED(argv))
 {
     struct rt_i *rtip = APP.a_rt_i;
+    int64_t start = bu_gettime();
+
+    if (rtip) {
+	frame_prep_how = anim_frame_prep(rtip);
+	if (!frame_prep_how && BU_LIST_IS_EMPTY(&rtip->HeadRegion))
+	    frame_prep_how = "full";
+    }
 
     if (rtip && BU_LIST_IS_EMPTY(&rtip->HeadRegion) && !def_tree(rtip, NULL)) {
 	return -1;
     }
+    frame_prep_usec = bu_gettime() - start;
 
     do_view_finalize(azimuth, elevation);
 
@@ -389,6 +695,9 @@ int cm_prep(const int UNUSED(argc), const char **UNUSED(argv))
     }
     objargv = (const char **)cmd_objs->buffer;
 
+    if (anim_clean_pending)
+	anim_flush_clean(rtip, 1);
+
     rt_prep_timer();
     if (rt_gettrees(rtip, objcnt, objargv, (size_t)npsw) < 0)
 	bu_log("rt_gettrees() FAILED\n");
@@ -487,24 +796,78 @@ int cm_multiview(const int UNUSED(argc), const char **UNUSED(argv))
  */
 int cm_anim(const int argc, const char **argv)
 {
+    struct rt_i *rtip = APP.a_rt_i;
+
+    if (anim_clean_pending) {
+	/* checked now, applied by anim_frame_prep() */
+	struct animate *anp = db_parse_1anim(rtip->rti_dbip, argc, argv);
+	if (!anp) {
+	    bu_log("cm_anim:  %s %s failed\n", argv[1], argv[2]);
+	    return -1;		/* BAD */
+	}
+	db_free_1anim(anp);
+	anim_cmds_add(&anim_pending, argc, argv);
+	return 0;
+    }
 
-    if (db_parse_anim(APP.a_rt_i->rti_dbip, argc, argv) < 0) {
+    if (db_parse_anim(rtip->rti_dbip, argc, argv) < 0) {
 	bu_log("cm_anim:  %s %s failed\n", argv[1], argv[2]);
 	return -1;		/* BAD */
     }
+
+    /* only the next tree load sees it; with a tree loaded, what it
+     * moves has to be reprepped when the frame is */
+    if (BU_LIST_IS_EMPTY(&rtip->HeadRegion)) {
+	anim_cmds_add(&anim_applied, argc, argv);
+    } else {
+	struct bu_vls cmd = BU_VLS_INIT_ZERO;
+	struct bu_vls name = BU_VLS_INIT_ZERO;
+	const char *obj;
+
+	bu_vls_from_argv(&cmd, argc, argv);
+	obj = anim_cmd_object(bu_vls_cstr(&cmd), &name);
+	if (obj)
+	    anim_names_add(&anim_late, obj);
+	else
+	    anim_late_rooted = 1;
+	bu_vls_free(&name);
+	bu_vls_free(&cmd);
+    }
     return 0;
 }
 
 
 /**
  * Clean out results of last rt_prep(), and start anew.
+ *
+ * With a tree loaded from the command line the clean is deferred to
+ * the next frame, where only what the animation changed is reprepped
+ * (see anim_frame_prep()).
  */
 int cm_clean(const int UNUSED(argc), const char **UNUSED(argv))
 {
+    struct rt_i *rtip = APP.a_rt_i;
+
+    if (anim_reprep && !anim_full_only && rtip && !rtip->needprep
+	&& !BU_LIST_IS_EMPTY(&rtip->HeadRegion)
+	&& (!cmd_objs || !BU_PTBL_LEN(cmd_objs)))
+    {
+	anim_cmds_free(&anim_pending);
+	anim_clean_pending = 1;
+	return 0;
+    }
+
+    anim_cmds_free(&anim_pending);
+    anim_cmds_free(&anim_applied);
+    anim_cmds_free(&anim_late);
+    anim_late_rooted = 0;
+    anim_clean_pending = 0;
+    anim_reprepped = 0;
+
     /* Allow lighting model clean up (e.g. lights, materials, etc.) */
-    view_cleanup(APP.a_rt_i);
+    view_cleanup(rtip);
 
-    rt_clean(APP.a_rt_i);
+    rt_clean(rtip);
 
     return 0;
 }
@@ -518,6 +881,9 @@ int cm_clean(const int UNUSED(argc), const char **UNUSED(argv))
  */
 int cm_closedb(const int UNUSED(argc), const char **UNUSED(argv))
 {
+    anim_cmds_free(&anim_pending);
+    anim_cmds_free(&anim_applied);
+    anim_cmds_free(&anim_late);
     rt_i_destroy(APP.a_rt_i);
     APP.a_rt_i = RTI_NULL;
 
@@ -551,6 +917,7 @@ struct bu_structparse set_parse[] = {
     {"%f",	1, "angle",			bu_byteoffset(rt_perspective),			BU_STRUCTPARSE_FUNC_NULL, NULL, NULL },
     {"%d",	1, "rt_bot_minpieces",		bu_byteoffset(rt_bot_minpieces_deprecated),	parse_deprecated, NULL, NULL },
     {"%f",	1, "rt_cline_radius",		bu_byteoffset(rt_app_cline_radius),		BU_STRUCTPARSE_FUNC_NULL, NULL, NULL },
+    {"%d",	1, "anim_reprep",		bu_byteoffset(anim_reprep),			BU_STRUCTPARSE_FUNC_NULL, NULL, NULL },
     /* daisy-chain to additional app-specific parameters */
     {"%p",	1, "Application-Specific Parameters", bu_byteoffset(view_parse[0]),		BU_STRUCTPARSE_FUNC_NULL, NULL, NULL },
     {"",	0, (char *)0,			0,						BU_STRUCTPARSE_FUNC_NULL, NULL, NULL }
@@ -842,6 +1209,12 @@ do_prep(struct rt_i *rtip)
 
     RT_CHECK_RTI(rtip);
     if (rtip->needprep) {
+	struct region *regp;
+	size_t nregions = 0;
+
+	for (BU_LIST_FOR(regp, region, &(rtip->HeadRegion)))
+	    nregions++;
+
 	/* Allow lighting model to set up (e.g. lights, materials, etc.) */
 	view_setup(rtip);
 
@@ -849,6 +1222,12 @@ do_prep(struct rt_i *rtip)
 	rt_prep_timer();
 	rt_prep_parallel(rtip, (size_t)npsw);
 
+	/* Regions the view dropped (light sources, mostly) would be
+	 * lost if it were set up again over a partial reprep, so
+	 * animation frames are then cleaned in full. */
+	if (rtip->stats.nregions < nregions)
+	    anim_full_only = 1;
+
 	(void)rt_get_timer(&times, NULL);
 	if (rt_verbosity & VERBOSE_STATS)
 	    bu_log("PREP: %s\n", bu_vls_addr(&times));
@@ -922,7 +1301,17 @@ do_frame(int framenumber)
 	       framenumber);
 
     /* Compute model RPP, etc. */
-    do_prep(rtip);
+    {
+	int64_t start = bu_gettime();
+	do_prep(rtip);
+	if (frame_prep_how) {
+	    if (rt_verbosity & VERBOSE_STATS)
+		bu_log("FRAMEPREP: frame %d, %s prep, %.3f sec\n", framenumber, frame_prep_how,
+		       (double)(frame_prep_usec + bu_gettime() - start) / 1.0e6);
+	    frame_prep_how = NULL;
+	    frame_prep_usec = 0;
+	}
+    }
 
     if (rt_verbosity & VERBOSE_VIEWDETAIL)
 	bu_log("Tree: %zu solids in %zu regions\n", rtip->stats.nsolids, rtip->stats.nregions);
@@ -1168,6 +1557,11 @@ do_frame(int framenumber)
     rtip->stats.nmiss = 0;
     rtip->stats.nhits = 0;
     rtip->stats.rti_nrays = 0;
+    rtip->stats.nseg_get = 0;
+    rtip->stats.npart_get = 0;
+    rtip->stats.nseg_peak = 0;
+    rtip->stats.npart_peak = 0;
+    rtip->stats.res_slab_bytes = 0;
 
     if (rt_verbosity & (VERBOSE_LIGHTINFO|VERBOSE_STATS))
 	bu_log("\n");
@@ -1263,6 +1657,10 @@ do_frame(int framenumber)
 	bu_log("pruned %.1f%%:  %zu model RPP, %zu dups skipped, %zu solid RPP\n",
 	       rtip->stats.nshots > 0 ? ((double)rtip->stats.nhits*100.0)/rtip->stats.nshots : 100.0,
 	       rtip->stats.nmiss_model, rtip->stats.ndup, rtip->stats.nmiss_solid);
+	bu_log("%zu segs (peak %zu/cpu), %zu partitions (peak %zu/cpu), %zu bytes held by resources\n",
+	       rtip->stats.nseg_get, rtip->stats.nseg_peak,
+	       rtip->stats.npart_get, rtip->stats.npart_peak,
+	       rtip->stats.res_slab_bytes);
 	bu_log("Frame %2d: %10zu pixels in %9.2f sec = %12.2f pixels/sec\n",
 	       framenumber,
 	       width*height, nutime, ((double)(width*height))/nutime);
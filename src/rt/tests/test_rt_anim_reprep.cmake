@@ -0,0 +1,92 @@
+if(NOT DEFINED RT OR NOT DEFINED DB OR NOT DEFINED TEST_DIR)
+  message(FATAL_ERROR "RT, DB, and TEST_DIR are required")
+endif()
+
+# A four frame animation script.  Frame 1 moves box.r while tor.r keeps
+# the animation it had in frame 0, frame 2 moves the box back, and
+# frame 3 animates cone.r before its "clean", which must drop it again.
+# Rendered with the per-frame reprep and with a full clean every frame,
+# each frame must come out the same.
+set(view "viewsize 157.203;\neye_pt 63.7999 32.7177 33.6666;\nlookat_pt 0 0 0 1;\n")
+set(ident "1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1")
+set(tor_up "1 0 0 0 0 1 0 0 0 0 1 5 0 0 0 1")
+set(box_over "1 0 0 15 0 1 0 0 0 0 1 0 0 0 0 1")
+set(cone_over "1 0 0 -20 0 1 0 0 0 0 1 0 0 0 0 1")
+
+set(script_file "${TEST_DIR}/rt-anim-reprep.script")
+file(WRITE "${script_file}" "")
+foreach(frame 0 1 2 3)
+  if(frame EQUAL 1)
+    set(box "${box_over}")
+  else()
+    set(box "${ident}")
+  endif()
+  file(APPEND "${script_file}" "start ${frame};\n${view}")
+  if(frame EQUAL 3)
+    file(APPEND "${script_file}" "anim all.g/cone.r matrix lmul ${cone_over};\n")
+  endif()
+  file(APPEND "${script_file}" "clean;\n")
+  file(APPEND "${script_file}" "anim all.g/tor.r matrix lmul ${tor_up};\n")
+  file(APPEND "${script_file}" "anim all.g/box.r matrix lmul ${box};\n")
+  file(APPEND "${script_file}" "end;\n")
+endforeach()
+
+function(render_frames prefix log_var)
+  file(GLOB old_frames "${TEST_DIR}/${prefix}.pix*")
+  if(old_frames)
+    file(REMOVE ${old_frames})
+  endif()
+  execute_process(
+    COMMAND "${RT}" -P 1 -s 32 -M ${ARGN} -o "${TEST_DIR}/${prefix}.pix" "${DB}" all.g
+    INPUT_FILE "${script_file}"
+    OUTPUT_VARIABLE render_stdout
+    ERROR_VARIABLE render_stderr
+    RESULT_VARIABLE render_result
+    TIMEOUT 60
+  )
+  if(NOT render_result EQUAL 0)
+    message(FATAL_ERROR "${prefix} render failed:\n${render_stdout}${render_stderr}")
+  endif()
+  set(${log_var} "${render_stdout}${render_stderr}" PARENT_SCOPE)
+endfunction()
+
+render_frames(rt-anim-delta delta_log)
+render_frames(rt-anim-full full_log -c "set anim_reprep=0")
+
+string(FIND "${delta_log}" "FRAMEPREP: frame 1, delta prep" delta_offset)
+if(delta_offset EQUAL -1)
+  message(FATAL_ERROR "frame 1 was not reprepped by delta:\n${delta_log}")
+endif()
+
+set(delta_frames "${TEST_DIR}/rt-anim-delta.pix")
+set(full_frames "${TEST_DIR}/rt-anim-full.pix")
+foreach(frame 1 2 3)
+  list(APPEND delta_frames "${TEST_DIR}/rt-anim-delta.pix.${frame}")
+  list(APPEND full_frames "${TEST_DIR}/rt-anim-full.pix.${frame}")
+endforeach()
+
+foreach(frame 0 1 2 3)
+  list(GET delta_frames ${frame} delta_file)
+  list(GET full_frames ${frame} full_file)
+  if(NOT EXISTS "${delta_file}" OR NOT EXISTS "${full_file}")
+    message(FATAL_ERROR "frame ${frame} was not written")
+  endif()
+  file(SHA256 "${delta_file}" delta_hash)
+  file(SHA256 "${full_file}" full_hash)
+  if(NOT delta_hash STREQUAL full_hash)
+    message(FATAL_ERROR "frame ${frame} differs between the delta reprep and a full clean")
+  endif()
+  set(hash_${frame} "${delta_hash}")
+endforeach()
+
+if(hash_0 STREQUAL hash_1)
+  message(FATAL_ERROR "the box.r matrix of frame 1 did not move it")
+endif()
+if(NOT hash_0 STREQUAL hash_2)
+  message(FATAL_ERROR "frame 2 did not put box.r back where frame 0 had it")
+endif()
+if(NOT hash_0 STREQUAL hash_3)
+  message(FATAL_ERROR "the cone.r animation given before the frame 3 clean was kept")
+endif()
+
+file(REMOVE ${delta_frames} ${full_frames} "${script_file}")
@@ -37,15 +37,13 @@
 
 #include "bio.h"
 
-#include "png.h"
-
 #include "vmath.h"
 #include "bu/app.h"
 #include "bu/getopt.h"
 #include "bu/log.h"
 #include "bu/malloc.h"
-#include "bn.h"
 #include "dm.h"
+#include "icv.h"
 
 
 #define BYTESPERPIXEL 3
@@ -180,62 +178,29 @@ get_args(int argc, char **argv, size_t *width, size_t *height, FILE **infp, FILE
 }
 
 
-void
-write_png(FILE *outfp, unsigned char **scanlines, long int width, long int height)
+/* Copy the PNG just written to fp onto stdout as well. */
+static void
+copy_png(FILE *fp)
 {
-    png_structp png_p;
-    png_infop info_p;
-
-    png_p = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!png_p)
-	bu_exit(1, "Could not create PNG write structure\n");
-
-    info_p = png_create_info_struct(png_p);
-    if (!info_p)
-	bu_exit(1, "Could not create PNG info structure\n");
-
-    png_init_io(png_p, outfp);
-    png_set_filter(png_p, 0, PNG_FILTER_NONE);
-    png_set_compression_level(png_p, 9);
-    png_set_IHDR(png_p, info_p, width, height, 8,
-		 PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
-		 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-
-    /*
-     * From the PNG 1.0 Specification: the gAMA chunk specifies the
-     * gamma characteristic of the source device.
-     *
-     * In this interpretation, we set the value to 1.0; indicating we
-     * hadn't done any gamma correction.
-     *
-     * From the PNG 1.1 Specification:
-     *
-     * PNG images can specify, via the gAMA chunk, the power function
-     * relating the desired display output with the image samples.
-     *
-     * In this interpretation, we could set the value to 0.6,
-     * representing the value needed to un-do the 2.2 correction
-     * auto-applied by PowerPoint for PC monitors.
-     */
-    if (out_gamma > 0.0)
-	png_set_gAMA(png_p, info_p, out_gamma);
-
-    png_write_info(png_p, info_p);
-    png_write_image(png_p, scanlines);
-    png_write_end(png_p, NULL);
-    png_write_flush(png_p);
-    png_destroy_write_struct(&png_p, &info_p);
+    unsigned char buf[BU_PAGE_SIZE];
+    size_t n;
+
+    rewind(fp);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+	if (fwrite(buf, 1, n, stdout) != n) {
+	    perror("fwrite");
+	    break;
+	}
+    }
 }
 
 
 int
 main(int argc, char *argv[])
 {
-    size_t i;
     size_t w, h;
-    unsigned char *scanbuf;
-    unsigned char **rows;
     struct stat sb;
+    icv_stream_t *stream;
 
     FILE *infp = (FILE *)NULL;
     FILE *outfp = (FILE *)NULL;
@@ -270,19 +235,7 @@ main(int argc, char *argv[])
 	}
     }
 
-    /* allocate space for the image */
-    scanbuf = (unsigned char *)bu_calloc(SIZE, sizeof(unsigned char), "scanbuf");
-
-    /* create array of pointers to rows for libpng */
-    rows = (unsigned char **)bu_calloc(file_height, sizeof(unsigned char *), "rows");
-    for (i=0; i<file_height; i++)
-	rows[i] = scanbuf + ((file_height-i-1)*ROWSIZE);
-
-    /* read the pix file */
-    if (fread(scanbuf, SIZE, 1, infp) != 1)
-	bu_exit(1, "%s: Short read\n", bu_getprogname());
-
-    /* warn if we only read part of the input */
+    /* warn if we will only read part of the input */
     if (fstat(fileno(infp), &sb) < 0) {
 	perror("unable to stat file:");
 	bu_exit(1, "ERROR: %s cannot proceed.", bu_getprogname());
@@ -300,19 +253,24 @@ main(int argc, char *argv[])
 	}
     }
 
-    /* write out the data */
-    write_png(outfp, rows, file_width, file_height);
+    /* Convert a scanline at a time.  PIX rows are stored bottom up and
+     * PNG rows top down, so a piped input is spooled to a temporary
+     * file rather than held in memory. */
+    stream = icv_stream_open(infp, BU_MIME_IMAGE_PIX, file_width, file_height);
+    if (!stream)
+	bu_exit(1, "%s: unable to read pix input\n", bu_getprogname());
+    if (icv_stream_write_png(stream, outfp, 9, out_gamma) != BRLCAD_OK)
+	bu_exit(1, "%s: Short read\n", bu_getprogname());
+    icv_stream_destroy(stream);
 
     /* user requested separate file and redirected output */
     if (!isatty(fileno(stdout)) && outfp != stdout) {
-	write_png(stdout, rows, file_width, file_height);
+	fflush(outfp);
+	copy_png(outfp);
     }
 
     /* release resources */
 
-    bu_free(scanbuf, "scanbuf");
-    bu_free(rows, "rows");
-
     if (infp != stdin)
 	fclose(infp);
     if (outfp != stdout)
@@ -25,9 +25,9 @@
  * file of the requested size consisting of the nearest pixels.  No
  * filtering/interpolating is done.
  *
- * This can handle arbitrarily large files.  We keep a buffer of scan
- * lines centered around the last point that fell outside of the
- * buffer.  Note: this buffer code is shared with bwscale.c
+ * This can handle arbitrarily large files: the input is streamed
+ * through libicv, which only keeps the scan lines an output line
+ * crosses in memory.
  *
  */
 
@@ -36,23 +36,18 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <limits.h> /* for INT_MAX */
-#include "vmath.h"
+#ifdef HAVE_SYS_STAT_H
+#  include <sys/stat.h>
+#endif
 
-#include "bio.h" /* for b_off_t */
+#include "bio.h"
 
 #include "bu/app.h"
-#include "bu/file.h"
-#include "bu/malloc.h"
 #include "bu/exit.h"
+#include "icv.h"
 
 
-#define round(x) ((int)(x+0.5))
-#define MAXBUFBYTES BU_PAGE_SIZE*BU_PAGE_SIZE	/* max bytes to malloc in buffer space */
-
-unsigned char *buffer;
 ssize_t scanlen;			/* length of infile scanlines */
-ssize_t buflines;		/* Number of lines held in buffer */
-b_off_t buf_start = -1000;	/* First line in buffer */
 
 unsigned long xnum, ynum;	/* Number of pixels in new file */
 float ulx, uly, urx, ury, lrx, lry, llx, lly;	/* Corners of original file */
@@ -117,63 +112,13 @@ parse_float_arg(const char *arg, float *out_value, const char *label)
     return 1;
 }
 
-/*
- * Determine max number of lines to buffer.
- * and malloc space for it.
- * XXX - CHECK FILE SIZE
- */
-void
-init_buffer(void)
-{
-    ssize_t max;
-
-    /* See how many we could buffer */
-    max = MAXBUFBYTES / scanlen;
-
-    /*
-     * Do a max of page size.  We really should see how big the input
-     * file is to decide if we should buffer less than our max.
-     */
-    if (max > BU_PAGE_SIZE)
-	max = BU_PAGE_SIZE;
-
-    if (max < scanlen)
-	buflines = max;
-    else
-	buflines = scanlen;
-
-    buffer = (unsigned char *)bu_malloc(buflines * scanlen * 3, "buffer");
-}
-
-
-/*
- * Load the buffer with scan lines centered around
- * the given y coordinate.
- */
-void
-fill_buffer(int y)
-{
-    size_t ret;
-
-    buf_start = y - buflines/2;
-    if (buf_start < 0) buf_start = 0;
-
-    bu_fseek(ifp, 0, 0);
-    ret = fread(buffer, scanlen, 3*buflines, ifp);
-    if (ret == 0)
-	perror("fread");
-}
-
-
 int
 main(int argc, char **argv)
 {
-    float px1, py1, px2, py2, px, py;
-    size_t row, col;
-    ssize_t yindex;
-    char value;
+    icv_stream_t *stream;
+    struct stat sb;
+    size_t scanlines;
     size_t ret;
-    long int subsc;
 
     bu_setprogname(argv[0]);
 
@@ -253,56 +198,22 @@ main(int argc, char **argv)
 	    perror("scanf");
     }
 
-    /* See how many lines we can buffer */
-    init_buffer();
-
-    /* Check for silly buffer syndrome */
-    if ((ssize_t)abs((int)(ury - uly)) > buflines/2 || (ssize_t)abs((int)(lry - lly)) > buflines/2) {
-	fprintf(stderr, "bwcrop: Warning: You are skewing enough in the y direction\n");
-	fprintf(stderr, "bwcrop: relative to my buffer size that I will exhibit silly\n");
-	fprintf(stderr, "bwcrop: buffer syndrome (two replacements per scanline).\n");
-	fprintf(stderr, "bwcrop: Recompile me or use a smarter algorithm.\n");
+    /* the number of scan lines comes from the file size */
+    if (fstat(fileno(ifp), &sb) < 0 || (size_t)sb.st_size < (size_t)scanlen * 3) {
+	bu_exit(4, "bwcrop: unable to determine the size of %s\n", argv[1]);
     }
+    scanlines = (size_t)sb.st_size / ((size_t)scanlen * 3);
 
     /* Move all points */
-    for (row = 0; row < ynum; row++) {
-	/* calculate left point of row */
-	px1 = ((ulx-llx)/(fastf_t)(ynum-1)) * (fastf_t)row + llx;
-	py1 = ((uly-lly)/(fastf_t)(ynum-1)) * (fastf_t)row + lly;
-	/* calculate right point of row */
-	px2 = ((urx-lrx)/(fastf_t)(ynum-1)) * (fastf_t)row + lrx;
-	py2 = ((ury-lry)/(fastf_t)(ynum-1)) * (fastf_t)row + lry;
-
-	for (col = 0; col < xnum; col++) {
-	    /* calculate point along row */
-	    px = ((px2-px1)/(fastf_t)(xnum-1)) * (fastf_t)col + px1;
-	    py = ((py2-py1)/(fastf_t)(xnum-1)) * (fastf_t)col + py1;
-
-	    /* Make sure we are in the buffer */
-	    yindex = round(py) - buf_start;
-	    if (yindex >= buflines) {
-		fill_buffer(round(py));
-		yindex = round(py) - buf_start;
-	    }
-	    yindex = yindex + buf_start;
-
-	    subsc = 3* (yindex * scanlen + round(px) );
-	    value = buffer[ subsc ];
-	    ret = fwrite(&value, sizeof(value), 1, ofp);
-	    if (ret == 0)
-		perror("fwrite");
-	    value = buffer[ subsc+1 ];
-	    ret = fwrite(&value, sizeof(value), 1, ofp);
-	    if (ret == 0)
-		perror("fwrite");
-	    value = buffer[ subsc+2 ];
-	    ret = fwrite(&value, sizeof(value), 1, ofp);
-	    if (ret == 0)
-		perror("fwrite");
-	}
+    stream = icv_stream_open(ifp, BU_MIME_IMAGE_PIX, (size_t)scanlen, scanlines);
+    stream = icv_stream_crop_quad(stream, ulx, uly, urx, ury, lrx, lry, llx, lly, xnum, ynum);
+    if (!stream || icv_stream_write(stream, ofp, BU_MIME_IMAGE_PIX) != BRLCAD_OK) {
+	bu_exit(5, "bwcrop: unable to crop %s\n", argv[1]);
     }
+    icv_stream_destroy(stream);
 
-    bu_free(buffer, "buffer");
+    fclose(ifp);
+    fclose(ofp);
     return 0;
 }
 
@@ -25,11 +25,8 @@
  * To scale down, we assume "square pixels" and preserve the
  * amount of light energy per unit area.
  *
- * This is a buffered version that can handle files of
- * almost arbitrary size.
- *
- * Note: This is a simple extension to bwcrop.  Improvements made
- * there should be incorporated here.
+ * The image is streamed through libicv a few scanlines at a time,
+ * so files of almost arbitrary size can be handled.
  *
  */
 
@@ -41,21 +38,11 @@
 
 #include "bu/app.h"
 #include "bu/getopt.h"
-#include "bu/malloc.h"
 #include "bu/log.h"
-#include "bu/file.h"
-
-
-#define MAXBUFBYTES 3*1024*1024	/* max bytes to malloc in buffer space */
+#include "icv.h"
 
-unsigned char *outbuf;
-unsigned char *buffer;
-ssize_t scanlen;		/* length of infile (and buffer) scanlines */
-ssize_t buflines;		/* Number of lines held in buffer */
-b_off_t buf_start = -1000;	/* First line in buffer */
 
-ssize_t bufy;				/* y coordinate in buffer */
-FILE *buffp;
+static FILE *buffp;
 static char *file_name;
 static char hyphen[] = "-";
 
@@ -87,160 +74,6 @@ parse_positive_int_arg(const char *arg, int *value, const char *label)
     return 1;
 }
 
-/****** THIS PROBABLY SHOULD BE ELSEWHERE *******/
-
-/* ceiling and floor functions for positive numbers */
-#define CEILING(x)	(((x) > (int)(x)) ? (int)(x)+1 : (int)(x))
-#define FLOOR(x)	((int)(x))
-#define MIN(x, y)	(((x) > (y)) ? (y) : (x))
-
-
-/*
- * Load the buffer with scan lines centered around
- * the given y coordinate.
- */
-void
-fill_buffer(int y)
-{
-    static b_off_t file_pos = 0;
-    size_t ret;
-
-    buf_start = y - buflines/2;
-    if (buf_start < 0)
-	buf_start = 0;
-
-    /* bu_log("filepos is %zu, buf_start is %zu, scanlen is %zu\n", (size_t)file_pos, (size_t)buf_start, (size_t)scanlen); */
-
-    if (file_pos != buf_start * scanlen) {
-	if (bu_fseek(buffp, buf_start * scanlen, 0) < 0) {
-	    bu_exit(3, "pixscale: Can't seek to input pixel! y=%d\n", y);
-	}
-	file_pos = buf_start * scanlen;
-    }
-    ret = fread(buffer, scanlen, buflines, buffp);
-    if (ret < (size_t)buflines && ferror(buffp))
-	perror("fread");
-    else if (feof(buffp))
-	bu_log("WARNING: Short read (%zu < %zu)", ret, buflines);
-
-    file_pos += buflines * scanlen;
-}
-
-
-/*
- * Nearest Neighbor Interpolate a file of pixels.
- *
- * This version preserves the outside pixels and interps inside only.
- */
-void
-ninterp(FILE *ofp, int ix, int iy, int ox, int oy)
-{
-    int i, j;
-    double x, y;
-    double xstep, ystep;
-    unsigned char *op, *lp;
-    size_t ret;
-
-    xstep = (double)(ix - 1) / (double)ox - 1.0e-6;
-    ystep = (double)(iy - 1) / (double)oy - 1.0e-6;
-
-    /* For each output pixel */
-    for (j = 0; j < oy; j++) {
-	y = j * ystep;
-	/*
-	 * Make sure we have this row (and the one after it)
-	 * in the buffer
-	 */
-	bufy = (int)y - buf_start;
-	if (bufy < 0 || bufy >= buflines-1) {
-	    fill_buffer((int)y);
-	    bufy = (int)y - buf_start;
-	}
-
-	op = outbuf;
-
-	for (i = 0; i < ox; i++) {
-	    x = i * xstep;
-	    lp = &buffer[bufy*scanlen+(int)x*3];
-	    *op++ = lp[0];
-	    *op++ = lp[1];
-	    *op++ = lp[2];
-	}
-
-	ret = fwrite(outbuf, 3, ox, ofp);
-	if (ret < (size_t)ox)
-	    perror("fwrite");
-    }
-}
-
-
-/*
- * Bilinear Interpolate a file of pixels.
- *
- * This version preserves the outside pixels and interps inside only.
- */
-void
-binterp(FILE *ofp, int ix, int iy, int ox, int oy)
-{
-    int i, j;
-    double x, y, dx, dy, mid1, mid2;
-    double xstep, ystep;
-    unsigned char *op, *up, *lp;
-    size_t ret;
-
-    xstep = (double)(ix - 1) / (double)ox - 1.0e-6;
-    ystep = (double)(iy - 1) / (double)oy - 1.0e-6;
-
-    /* For each output pixel */
-    for (j = 0; j < oy; j++) {
-	y = j * ystep;
-	/*
-	 * Make sure we have this row (and the one after it)
-	 * in the buffer
-	 */
-	bufy = (int)y - buf_start;
-	if (bufy < 0 || bufy >= buflines-1) {
-	    fill_buffer((int)y);
-	    bufy = (int)y - buf_start;
-	}
-
-	op = outbuf;
-
-	for (i = 0; i < ox; i++) {
-	    x = i * xstep;
-	    dx = x - (int)x;
-	    dy = y - (int)y;
-
-	    /* Note: (1-a)*foo + a*bar = foo + a*(bar-foo) */
-
-	    lp = &buffer[bufy*scanlen+(int)x*3];
-	    up = &buffer[(bufy+1)*scanlen+(int)x*3];
-
-	    /* Red */
-	    mid1 = lp[0] + dx * ((double)lp[3] - (double)lp[0]);
-	    mid2 = up[0] + dx * ((double)up[3] - (double)up[0]);
-	    *op++ = mid1 + dy * (mid2 - mid1);
-	    lp++; up++;
-
-	    /* Green */
-	    mid1 = lp[0] + dx * ((double)lp[3] - (double)lp[0]);
-	    mid2 = up[0] + dx * ((double)up[3] - (double)up[0]);
-	    *op++ = mid1 + dy * (mid2 - mid1);
-	    lp++; up++;
-
-	    /* Blue */
-	    mid1 = lp[0] + dx * ((double)lp[3] - (double)lp[0]);
-	    mid2 = up[0] + dx * ((double)up[3] - (double)up[0]);
-	    *op++ = mid1 + dy * (mid2 - mid1);
-	}
-
-	ret = fwrite(outbuf, 3, ox, ofp);
-	if (ret < (size_t)ox)
-	    perror("fwrite");
-    }
-}
-
-
 /*
  * Scale a file of pixels to a different size.
  *
@@ -251,118 +84,32 @@ binterp(FILE *ofp, int ix, int iy, int ox, int oy)
 int
 scale(FILE *ofp, int ix, int iy, int ox, int oy)
 {
-    int i, j, k, l;
+    icv_stream_t *stream;
+    ICV_RESIZE_METHOD method;
     double pxlen, pylen;			/* # old pixels per new pixel */
-    double xstart, xend, ystart, yend;	/* edges of new pixel in old coordinates */
-    double xdist, ydist;			/* length of new pixel sides in old coord */
-    double sumr, sumg, sumb;
-    unsigned char *op;
-    size_t ret;
+    int ret;
 
-    if (ix == ox)
-	pxlen = 1.0;
-    else
-	pxlen = (double)ix / (double)ox;
-    if (iy == oy)
-	pylen = 1.0;
-    else
-	pylen = (double)iy / (double)oy;
+    pxlen = (double)ix / (double)ox;
+    pylen = (double)iy / (double)oy;
     if ((pxlen < 1.0 && pylen > 1.0) || (pxlen > 1.0 && pylen < 1.0)) {
 	bu_log("pixscale: can't stretch one way and compress another!\n");
 	return -1;
     }
     if (pxlen < 1.0 || pylen < 1.0) {
-	if (rflag) {
-	    /* nearest neighbor interpolate */
-	    ninterp(ofp, ix, iy, ox, oy);
-	} else {
-	    /* bilinear interpolate */
-	    binterp(ofp, ix, iy, ox, oy);
-	}
-	return 0;
-    }
-
-    /* for each output pixel */
-    for (j = 0; j < oy; j++) {
-	ystart = j * pylen;
-	yend = ystart + pylen;
-	op = outbuf;
-	for (i = 0; i < ox; i++) {
-	    xstart = i * pxlen;
-	    xend = xstart + pxlen;
-	    sumr = sumg = sumb = 0.0;
-	    /*
-	     * For each pixel of the original falling
-	     * inside this new pixel.
-	     */
-	    for (l = FLOOR(ystart); l < CEILING(yend); l++) {
-
-		/* Make sure we have this row in the buffer */
-		bufy = l - buf_start;
-		if (bufy < 0 || bufy >= buflines) {
-		    fill_buffer(l);
-		    bufy = l - buf_start;
-		}
-
-		/* Compute height of this row */
-		if ((double)l < ystart)
-		    ydist = CEILING(ystart) - ystart;
-		else
-		    ydist = MIN(1.0, yend - (double)l);
-
-		for (k = FLOOR(xstart); k < CEILING(xend); k++) {
-		    /* Compute width of column */
-		    if ((double)k < xstart)
-			xdist = CEILING(xstart) - xstart;
-		    else
-			xdist = MIN(1.0, xend - (double)k);
-
-		    /* Add this pixels contribution */
-		    /* sum += old[l][k] * xdist * ydist; */
-		    sumr += buffer[bufy * scanlen + 3*k] * xdist * ydist;
-		    sumg += buffer[bufy * scanlen + 3*k+1] * xdist * ydist;
-		    sumb += buffer[bufy * scanlen + 3*k+2] * xdist * ydist;
-		}
-	    }
-	    *op++ = (int)(sumr / (pxlen * pylen));
-	    *op++ = (int)(sumg / (pxlen * pylen));
-	    *op++ = (int)(sumb / (pxlen * pylen));
-	}
-	ret = fwrite(outbuf, 3, ox, ofp);
-	if (ret < (size_t)ox)
-	    perror("fwrite");
+	/* nearest neighbor or bilinear interpolate */
+	method = rflag ? ICV_RESIZE_NINTERP : ICV_RESIZE_BINTERP;
+    } else {
+	method = ICV_RESIZE_SHRINK;
     }
-    return 1;
-}
 
+    stream = icv_stream_open(buffp, BU_MIME_IMAGE_PIX, (size_t)ix, (size_t)iy);
+    stream = icv_stream_resize(stream, method, (size_t)ox, (size_t)oy);
+    if (!stream)
+	return -1;
+    ret = icv_stream_write(stream, ofp, BU_MIME_IMAGE_PIX);
+    icv_stream_destroy(stream);
 
-/*
- * Determine max number of lines to buffer.
- * and malloc space for it.
- * XXX - CHECK FILE SIZE
- */
-void
-init_buffer(void)
-{
-    ssize_t max;
-
-    /* See how many we could buffer */
-    max = MAXBUFBYTES / scanlen;
-
-    /*
-     * Do a max of page size.  We really should see how big the input
-     * file is to decide if we should buffer less than our max.
-     */
-    if (max > BU_PAGE_SIZE)
-	max = BU_PAGE_SIZE;
-
-    if (max < iny)
-	buflines = max;
-    else
-	buflines = iny;
-
-    buf_start = (-buflines);
-    buffer = (unsigned char *)bu_malloc(buflines * scanlen, "buffer");
+    return (ret == BRLCAD_OK) ? 1 : -1;
 }
 
 
@@ -458,8 +205,6 @@ get_args(int argc, char **argv)
 int
 main(int argc, char **argv)
 {
-    int i;
-
     bu_setprogname(argv[0]);
 
     setmode(fileno(stdin), O_BINARY);
@@ -474,18 +219,9 @@ main(int argc, char **argv)
 	bu_exit(2, "pixscale: bad size\n");
     }
 
-    /* See how many lines we can buffer */
-    scanlen = 3 * inx;
-    init_buffer();
-    if (inx < outx) i = outx * 3;
-    else i = inx * 3;
-
-    outbuf = (unsigned char *)bu_malloc(i, "outbuf");
-
     /* Here we go */
-    scale(stdout, inx, iny, outx, outy);
-    bu_free(outbuf, "outbuf");
-    bu_free(buffer, "buffer");
+    if (scale(stdout, inx, iny, outx, outy) < 0)
+	bu_exit(3, "pixscale: unable to scale \"%s\"\n", file_name);
     return 0;
 }
 
@@ -26,19 +26,15 @@
 #include "common.h"
 
 #include <stdlib.h>
-#include <math.h>
-#include "png.h"
 #include "bio.h"
 
 #include "vmath.h"
 #include "bu/app.h"
 #include "bu/getopt.h"
 #include "bu/log.h"
-#include "bu/malloc.h"
-#include "bn.h"
+#include "icv.h"
 
 
-static png_color_16 def_backgrd={ 0, 0, 0, 0, 0 };
 static int verbose=0;
 
 static const char *usage = "Usage: %s [-v] [png_input_file] > pix_output_file\n";
@@ -46,20 +42,11 @@ static const char *usage = "Usage: %s [-v] [png_input_file] > pix_output_file\n"
 int
 main(int argc, char **argv)
 {
-    int i;
     int c;
     FILE *fp_in;
-    png_structp png_p;
-    png_infop info_p;
-    char header[8];
-    int bit_depth;
-    int color_type;
-    png_color_16p input_backgrd;
-    double gammaval;
-    int file_width, file_height;
-    unsigned char *image;
-    unsigned char **rows;
-    size_t ret;
+    icv_stream_t *stream;
+    size_t file_width, file_height;
+    ICV_COLOR_SPACE color_space;
 
     bu_setprogname(argv[0]);
 
@@ -99,116 +86,28 @@ main(int argc, char **argv)
     setmode(fileno(fp_in), O_BINARY);
     setmode(fileno(stdout), O_BINARY);
 
-    if (fread(header, 8, 1, fp_in) != 1)
-	bu_exit(EXIT_FAILURE, "png-pix: ERROR: Failed while reading file header!!!\n");
+    /* The PNG is decoded a scanline at a time (with any alpha channel
+     * composited onto the bKGD color, or black).  PNG rows are stored
+     * top down and pix rows bottom up: a seekable output is written in
+     * place, a pipe gets the rows from a temporary spool file. */
+    stream = icv_stream_open(fp_in, BU_MIME_IMAGE_PNG, 0, 0);
+    if (!stream)
+	bu_exit(EXIT_FAILURE, "png-pix: unable to read PNG input\n");
 
-    if (png_sig_cmp((png_bytep)header, 0, 8))
-	bu_exit(EXIT_FAILURE, "png-pix: This is not a PNG file!!!\n");
-
-    png_p = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!png_p)
-	bu_exit(EXIT_FAILURE, "png-pix: png_create_read_struct() failed!!\n");
-
-    info_p = png_create_info_struct(png_p);
-    if (!info_p)
-	bu_exit(EXIT_FAILURE, "png-pix: png_create_info_struct() failed!!\n");
-
-    png_init_io(png_p, fp_in);
-
-    png_set_sig_bytes(png_p, 8);
-
-    png_read_info(png_p, info_p);
-
-    color_type = png_get_color_type(png_p, info_p);
-
-    if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+    icv_stream_info(stream, &file_width, &file_height, &color_space, NULL);
+    if (color_space == ICV_COLOR_SPACE_GRAY)
 	bu_log("Warning: bw image being converted to RGB!!!\n");
-	png_set_gray_to_rgb(png_p);
-    }
-
-    png_set_expand(png_p);
-    bit_depth = png_get_bit_depth(png_p, info_p);
-    if (bit_depth == 16)
-	png_set_strip_16(png_p);
-
-    file_width = png_get_image_width(png_p, info_p);
-    file_height = png_get_image_height(png_p, info_p);
-
-    if (verbose) {
-	switch (color_type) {
-	    case PNG_COLOR_TYPE_GRAY:
-		bu_log("color type: b/w (bit depth=%d)\n", bit_depth);
-		break;
-	    case PNG_COLOR_TYPE_GRAY_ALPHA:
-		bu_log("color type: b/w with alpha channel (bit depth=%d)\n", bit_depth);
-		break;
-	    case PNG_COLOR_TYPE_PALETTE:
-		bu_log("color type: color palette (bit depth=%d)\n", bit_depth);
-		break;
-	    case PNG_COLOR_TYPE_RGB:
-		bu_log("color type: RGB (bit depth=%d)\n", bit_depth);
-		break;
-	    case PNG_COLOR_TYPE_RGB_ALPHA:
-		bu_log("color type: RGB with alpha channel (bit depth=%d)\n", bit_depth);
-		break;
-	    default:
-		bu_log("Unrecognized color type (bit depth=%d)\n", bit_depth);
-		break;
-	}
-	bu_log("Image size: %d X %d\n", file_width, file_height);
-    }
-
-    if (png_get_bKGD(png_p, info_p, &input_backgrd)) {
-	if (verbose && (color_type == PNG_COLOR_TYPE_GRAY_ALPHA ||
-			color_type == PNG_COLOR_TYPE_RGB_ALPHA))
-	    bu_log("background color: %d %d %d\n", input_backgrd->red, input_backgrd->green, input_backgrd->blue);
-	png_set_background(png_p, input_backgrd, PNG_BACKGROUND_GAMMA_FILE, 1, 1.0);
-    } else
-	png_set_background(png_p, &def_backgrd, PNG_BACKGROUND_GAMMA_FILE, 0, 1.0);
-
-    if (png_get_gAMA(png_p, info_p, &gammaval)) {
-	if (verbose)
-	    bu_log("gamma: %g\n", gammaval);
-	png_set_gAMA(png_p, info_p, gammaval);
-    }
+    if (verbose)
+	bu_log("Image size: %zu X %zu\n", file_width, file_height);
 
-    if (verbose) {
-	if (png_get_interlace_type(png_p, info_p) == PNG_INTERLACE_NONE)
-	    bu_log("not interlaced\n");
-	else
-	    bu_log("interlaced\n");
-    }
+    stream = icv_stream_gray2rgb(stream);
+    if (!stream || icv_stream_write(stream, stdout, BU_MIME_IMAGE_PIX) != BRLCAD_OK)
+	bu_exit(EXIT_FAILURE, "png-pix: failed to convert PNG data\n");
+    icv_stream_destroy(stream);
 
-    png_read_update_info(png_p, info_p);
+    if (fp_in != stdin)
+	fclose(fp_in);
 
-    /* allocate memory for image */
-    image = (unsigned char *)bu_calloc(1, file_width*file_height*3, "image");
-
-    /* create rows array */
-    rows = (unsigned char **)bu_calloc(file_height, sizeof(unsigned char *), "rows");
-    for (i=0; i<file_height; i++)
-	rows[file_height-1-i] = image+(i*file_width*3);
-
-    png_read_image(png_p, rows);
-
-    ret = fwrite(image, file_width*file_height*3, 1, stdout);
-    if (ret < 1)
-	perror("fwrite");
-
-    if (verbose) {
-	png_timep mod_time;
-	png_textp text;
-	int num_text;
-
-	png_read_end(png_p, info_p);
-	if (png_get_text(png_p, info_p, &text, &num_text)) {
-	    for (i=0; i<num_text; i++)
-		bu_log("%s: %s\n", text[i].key, text[i].text);
-	}
-	if (png_get_tIME(png_p, info_p, &mod_time))
-	    bu_log("Last modified: %d/%d/%d %d:%d:%d\n", mod_time->month, mod_time->day,
-		   mod_time->year, mod_time->hour, mod_time->minute, mod_time->second);
-    }
     return 0;
 }
 